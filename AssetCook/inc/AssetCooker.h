@@ -0,0 +1,149 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file AssetCooker.h
+ *  @date October 18, 2026
+ *
+ *  @brief Incremental cooking of the assets of a content root in the order of their
+ *  dependencies.
+ */
+
+#include <Graphics/DX12/TextureCookerDX12.h>
+
+// Settings that determine how the assets are cooked. The settings must
+// match the settings of the Game or the assets are cooked again when they are loaded.
+struct CookSettings
+{
+    Graphics::Mesh::VertexFormat VertexFormat = Graphics::Mesh::VertexFormat::Standard;
+    bool OptimizeOverdraw = false;
+    Graphics::TextureCompression TextureCompression = Graphics::TextureCompression::Default;
+    // Cook all assets, even if they are up to date.
+    bool Force = false;
+    // Only check which assets are stale.
+    bool DryRun = false;
+};
+
+/**
+ * Cooks the assets below a content root without running the Game.
+ * The dependency graph of the assets is built from the DependencyDatabase and
+ * the dependency files (.dep) that were written by hand below the content root.
+ * An asset depends on another asset if one of its files is the base file of
+ * another asset.
+ *
+ * Only stale assets are cooked. The assets are cooked in topological order:
+ * the assets of a level only depend on the assets of previous levels so the
+ * assets of a level are cooked in parallel on the thread pool.
+ *
+ * Scenes cook the textures of their materials when they are loaded, so scenes
+ * are never cooked in the same level as textures and scenes are cooked one at a
+ * time (the loading of a scene is parallelized by the SceneDX12 class).
+ * Shaders are compiled when they are loaded (with the macros of each pipeline
+ * state) so there is no cooked file for shaders: shaders are only counted.
+ */
+class AssetCooker
+{
+public:
+    enum class AssetType
+    {
+        Scene,
+        Texture,
+        Shader,
+    };
+
+    enum class AssetStatus
+    {
+        UpToDate,
+        Stale,
+        Cooked,
+        Failed,
+        Skipped,        // Assets that can't be cooked by the AssetCooker.
+    };
+
+    struct Asset
+    {
+        // The base file of the asset.
+        fs::path FilePath;
+        fs::path CookedFilePath;
+        AssetType Type;
+        AssetStatus Status;
+        // The indices of the assets that this asset depends on.
+        std::vector<size_t> Dependencies;
+        // The base file and the dependencies of the asset.
+        std::vector<fs::path> DependencyPaths;
+        // The usage of a texture when it was cooked the last time.
+        Graphics::TextureUsage TextureUsage;
+        uint32_t Level;
+        // The time in milliseconds that it took to cook the asset.
+        double CookTime;
+    };
+
+    AssetCooker( std::shared_ptr<Graphics::Device> device, const CookSettings& settings );
+    virtual ~AssetCooker();
+
+    /**
+     * Find the assets below the content root in the dependency database and the dependency
+     * files and build the dependency graph.
+     * @returns false if the dependency graph contains a cycle. The assets in the cycle
+     * are marked as failed.
+     */
+    bool Scan( const fs::path& contentRoot );
+
+    /**
+     * Check which assets are stale and cook the stale assets level by level.
+     * @returns false if any of the assets could not be cooked.
+     */
+    bool Cook();
+
+    /**
+     * Print the number of assets that were cooked and the time spent in each phase.
+     */
+    void PrintReport( std::wostream& stream ) const;
+
+    const std::vector<Asset>& GetAssets() const;
+
+private:
+    // Sort the assets in levels (see Scan).
+    bool BuildLevels();
+    // Check if an asset must be cooked (only the files on disk are checked).
+    AssetStatus CheckAsset( Asset& asset ) const;
+    bool CookScene( const Asset& asset );
+    bool CookTexture( const Asset& asset );
+
+    std::shared_ptr<Graphics::Device> m_Device;
+    CookSettings m_Settings;
+
+    std::vector<Asset> m_Assets;
+    // The indices of the assets in each level.
+    std::vector<std::vector<size_t>> m_Levels;
+    std::vector<double> m_LevelTimes;
+
+    // Scenes are cooked one at a time.
+    std::mutex m_SceneMutex;
+
+    // Time in milliseconds spent in each phase.
+    double m_ScanTime;
+    double m_CheckTime;
+    double m_CookTime;
+};
@@ -0,0 +1,570 @@
+#include <GamePCH.h>
+#include <EngineIncludes.h>
+#include <DependencyDatabase.h>
+#include <DependencyTracker.h>
+#include <Graphics/SceneFile.h>
+#include <Graphics/DX12/SceneDX12.h>
+#include <Graphics/DX12/TextureDX12.h>
+
+#include <AssetCooker.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <queue>
+#include <set>
+
+using namespace Core;
+using namespace Graphics;
+
+namespace
+{
+    // The extension of cooked scene files (see SceneDX12.cpp).
+    const wchar_t* SceneFileExtension = L"scene";
+    // The extension that is appended to the file name of cooked textures (see TextureCookerDX12.cpp).
+    const wchar_t* CookedTextureExtension = L".dds";
+
+    const wchar_t* DependencyFileExtension = L".dep";
+
+    // The number of assets that are listed in the report.
+    const size_t NumSlowestAssets = 10;
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    double GetElapsedTime( Clock::time_point start )
+    {
+        return std::chrono::duration<double, std::milli>( Clock::now() - start ).count();
+    }
+
+    AssetCooker::AssetType GetAssetType( const fs::path& filePath )
+    {
+        static const std::set<std::wstring> textureExtensions = {
+            L".bmp", L".dds", L".exr", L".gif", L".hdr", L".jpeg", L".jpg", L".png", L".psd", L".tga", L".tif", L".tiff"
+        };
+        static const std::set<std::wstring> shaderExtensions = {
+            L".hlsl", L".hlsli"
+        };
+
+        std::wstring extension = filePath.extension().wstring();
+        std::transform( extension.begin(), extension.end(), extension.begin(), ::towlower );
+
+        if ( textureExtensions.count( extension ) > 0 )
+        {
+            return AssetCooker::AssetType::Texture;
+        }
+        if ( shaderExtensions.count( extension ) > 0 )
+        {
+            return AssetCooker::AssetType::Shader;
+        }
+
+        // Any other file with a dependency file is a scene that was imported with Assimp.
+        return AssetCooker::AssetType::Scene;
+    }
+
+    // The usage of a texture that produced the format of a cooked texture (see TextureCookerDX12).
+    TextureUsage GetTextureUsage( DXGI_FORMAT cookedFormat )
+    {
+        switch ( cookedFormat )
+        {
+        case DXGI_FORMAT_BC5_UNORM:
+            return TextureUsage::NormalMap;
+        case DXGI_FORMAT_BC4_UNORM:
+            return TextureUsage::Grayscale;
+        default:
+            return TextureUsage::Color;
+        }
+    }
+
+    fs::path GetCanonicalPath( const fs::path& filePath )
+    {
+        std::error_code error;
+        fs::path canonicalPath = fs::canonical( filePath, error );
+
+        return error ? filePath : canonicalPath;
+    }
+
+    const wchar_t* GetAssetTypeName( AssetCooker::AssetType type )
+    {
+        switch ( type )
+        {
+        case AssetCooker::AssetType::Scene:
+            return L"Scenes";
+        case AssetCooker::AssetType::Texture:
+            return L"Textures";
+        default:
+            return L"Shaders";
+        }
+    }
+}
+
+AssetCooker::AssetCooker( std::shared_ptr<Device> device, const CookSettings& settings )
+    : m_Device( device )
+    , m_Settings( settings )
+    , m_ScanTime( 0.0 )
+    , m_CheckTime( 0.0 )
+    , m_CookTime( 0.0 )
+{}
+
+AssetCooker::~AssetCooker()
+{}
+
+bool AssetCooker::Scan( const fs::path& contentRoot )
+{
+    auto start = Clock::now();
+
+    m_Assets.clear();
+    m_Levels.clear();
+
+    DependencyDatabase& dependencyDatabase = DependencyDatabase::Get();
+
+    // Check the files of all assets in the database at once.
+    dependencyDatabase.Refresh();
+
+    fs::path rootPath = fs::absolute( contentRoot ).lexically_normal();
+
+    std::set<fs::path> baseFiles;
+    for ( const fs::path& filePath : dependencyDatabase.GetAssets() )
+    {
+        // Only the assets below the content root are cooked.
+        fs::path relativePath = filePath.lexically_relative( rootPath );
+        if ( !relativePath.empty() && *relativePath.begin() != L".." && fs::exists( filePath ) )
+        {
+            baseFiles.insert( filePath );
+        }
+    }
+
+    // Assets with a dependency file that was written by hand may not be in the database yet.
+    for ( const auto& entry : fs::recursive_directory_iterator( rootPath ) )
+    {
+        if ( fs::is_regular_file( entry.status() ) && entry.path().extension() == DependencyFileExtension )
+        {
+            fs::path filePath = entry.path();
+            // Remove the ".dep" extension to get the base file.
+            filePath.replace_extension();
+
+            // Dependency files of assets that were removed are ignored.
+            if ( fs::exists( filePath ) && fs::is_regular_file( filePath ) )
+            {
+                baseFiles.insert( filePath.lexically_normal() );
+            }
+        }
+    }
+
+    std::vector<fs::path> assetFiles( baseFiles.begin(), baseFiles.end() );
+    m_Assets.resize( assetFiles.size() );
+
+    ThreadPool::Get().ParallelFor( 0, static_cast<uint32_t>( m_Assets.size() ), 16, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            Asset& asset = m_Assets[i];
+            asset.FilePath = assetFiles[i];
+            asset.Type = GetAssetType( asset.FilePath );
+            asset.Status = AssetStatus::UpToDate;
+            asset.TextureUsage = TextureUsage::Color;
+            asset.Level = 0;
+            asset.CookTime = 0.0;
+
+            switch ( asset.Type )
+            {
+            case AssetType::Scene:
+                asset.CookedFilePath = asset.FilePath;
+                asset.CookedFilePath.replace_extension( SceneFileExtension );
+                break;
+            case AssetType::Texture:
+                asset.CookedFilePath = asset.FilePath;
+                asset.CookedFilePath += CookedTextureExtension;
+                break;
+            default:
+                break;
+            }
+
+            DependencyTracker dependencyTracker( asset.FilePath.wstring() );
+            if ( !dependencyTracker.Load() )
+            {
+                LOG_WARNING( "Failed to load dependencies of ", asset.FilePath );
+            }
+            asset.DependencyPaths = dependencyTracker.GetDependencyPaths();
+        }
+    } );
+
+    std::map<fs::path, size_t> assetIndices;
+    for ( size_t i = 0; i < m_Assets.size(); ++i )
+    {
+        assetIndices[GetCanonicalPath( m_Assets[i].FilePath )] = i;
+    }
+
+    for ( size_t i = 0; i < m_Assets.size(); ++i )
+    {
+        for ( const fs::path& dependencyPath : m_Assets[i].DependencyPaths )
+        {
+            auto iter = assetIndices.find( GetCanonicalPath( dependencyPath ) );
+            if ( iter != assetIndices.end() && iter->second != i )
+            {
+                m_Assets[i].Dependencies.push_back( iter->second );
+            }
+        }
+    }
+
+    bool result = BuildLevels();
+
+    m_ScanTime = GetElapsedTime( start );
+
+    return result;
+}
+
+bool AssetCooker::BuildLevels()
+{
+    const size_t numAssets = m_Assets.size();
+
+    // Kahn's algorithm: an asset is added to a level after all of its dependencies are in a level.
+    std::vector<uint32_t> numDependencies( numAssets );
+    std::vector<std::vector<size_t>> dependents( numAssets );
+    std::queue<size_t> readyAssets;
+
+    bool hasTextures = false;
+    for ( size_t i = 0; i < numAssets; ++i )
+    {
+        numDependencies[i] = static_cast<uint32_t>( m_Assets[i].Dependencies.size() );
+        for ( size_t dependency : m_Assets[i].Dependencies )
+        {
+            dependents[dependency].push_back( i );
+        }
+
+        if ( numDependencies[i] == 0 )
+        {
+            readyAssets.push( i );
+        }
+
+        hasTextures = hasTextures || m_Assets[i].Type == AssetType::Texture;
+    }
+
+    size_t numSortedAssets = 0;
+    while ( !readyAssets.empty() )
+    {
+        size_t i = readyAssets.front();
+        readyAssets.pop();
+        ++numSortedAssets;
+
+        Asset& asset = m_Assets[i];
+        // Scenes write the cooked files of their textures, so they must not be cooked at the same time as the textures.
+        if ( asset.Type == AssetType::Scene && hasTextures )
+        {
+            asset.Level = std::max( asset.Level, 1u );
+        }
+
+        if ( m_Levels.size() <= asset.Level )
+        {
+            m_Levels.resize( asset.Level + 1 );
+        }
+        m_Levels[asset.Level].push_back( i );
+
+        for ( size_t dependent : dependents[i] )
+        {
+            m_Assets[dependent].Level = std::max( m_Assets[dependent].Level, asset.Level + 1 );
+            if ( --numDependencies[dependent] == 0 )
+            {
+                readyAssets.push( dependent );
+            }
+        }
+    }
+
+    if ( numSortedAssets < numAssets )
+    {
+        for ( size_t i = 0; i < numAssets; ++i )
+        {
+            if ( numDependencies[i] > 0 )
+            {
+                LOG_ERROR( "Dependency cycle: ", m_Assets[i].FilePath );
+                m_Assets[i].Status = AssetStatus::Failed;
+            }
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+AssetCooker::AssetStatus AssetCooker::CheckAsset( Asset& asset ) const
+{
+    if ( asset.Type == AssetType::Shader )
+    {
+        return AssetStatus::Skipped;
+    }
+
+    if ( asset.Type == AssetType::Texture && m_Settings.TextureCompression == TextureCompression::None )
+    {
+        return AssetStatus::Skipped;
+    }
+
+    if ( !fs::exists( asset.CookedFilePath ) || !fs::is_regular_file( asset.CookedFilePath ) )
+    {
+        // The usage of a texture is determined by the materials that use it,
+        // so textures are only cooked if they were cooked by a scene before.
+        return asset.Type == AssetType::Texture ? AssetStatus::Skipped : AssetStatus::Stale;
+    }
+
+    if ( asset.Type == AssetType::Texture )
+    {
+        // Only the smallest mip levels of the cooked texture are loaded to get its format.
+        TextureImage image;
+        if ( !TextureCookerDX12::LoadDDS( asset.CookedFilePath, image, 1 ) )
+        {
+            return AssetStatus::Skipped;
+        }
+
+        asset.TextureUsage = GetTextureUsage( image.Format );
+
+        // Color textures are cooked again if the compression quality changed.
+        if ( asset.TextureUsage == TextureUsage::Color &&
+             ( image.Format == DXGI_FORMAT_BC7_UNORM ) != ( m_Settings.TextureCompression == TextureCompression::HighQuality ) )
+        {
+            return AssetStatus::Stale;
+        }
+    }
+    else
+    {
+        // The scene must be imported again if the vertex format or the index optimizations of the scene changed.
+        SceneFile sceneFile;
+        if ( !sceneFile.Open( asset.CookedFilePath.wstring() ) ||
+             sceneFile.GetHeader().VertexFormat != static_cast<uint32_t>( m_Settings.VertexFormat ) ||
+             ( sceneFile.GetHeader().OverdrawOptimized != 0 ) != m_Settings.OptimizeOverdraw )
+        {
+            return AssetStatus::Stale;
+        }
+    }
+
+    if ( m_Settings.Force )
+    {
+        return AssetStatus::Stale;
+    }
+
+    // The same check that is done when the asset is loaded (the build parameters are checked above).
+    DependencyTracker dependencyTracker( asset.FilePath.wstring() );
+    dependencyTracker.Load();
+    dependencyTracker.SetLastLoadTime( fs::last_write_time( asset.CookedFilePath ) );
+
+    return dependencyTracker.IsStale() ? AssetStatus::Stale : AssetStatus::UpToDate;
+}
+
+bool AssetCooker::Cook()
+{
+    auto start = Clock::now();
+
+    ThreadPool& threadPool = ThreadPool::Get();
+
+    // Checking the assets only compares the hashes in the dependency database and reads file headers.
+    threadPool.ParallelFor( 0, static_cast<uint32_t>( m_Assets.size() ), 16, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            if ( m_Assets[i].Status != AssetStatus::Failed )
+            {
+                m_Assets[i].Status = CheckAsset( m_Assets[i] );
+            }
+        }
+    } );
+
+    m_CheckTime = GetElapsedTime( start );
+    start = Clock::now();
+
+    m_LevelTimes.clear();
+
+    bool result = true;
+    for ( const auto& level : m_Levels )
+    {
+        auto levelStart = Clock::now();
+
+        // Assets that depend on an asset that was cooked must be cooked again.
+        std::vector<size_t> staleAssets;
+        for ( size_t i : level )
+        {
+            Asset& asset = m_Assets[i];
+            if ( asset.Status == AssetStatus::UpToDate )
+            {
+                for ( size_t dependency : asset.Dependencies )
+                {
+                    if ( m_Assets[dependency].Status == AssetStatus::Cooked || m_Assets[dependency].Status == AssetStatus::Stale )
+                    {
+                        asset.Status = AssetStatus::Stale;
+                        break;
+                    }
+                }
+            }
+
+            if ( asset.Status == AssetStatus::Stale )
+            {
+                staleAssets.push_back( i );
+            }
+        }
+
+        if ( !m_Settings.DryRun )
+        {
+            std::atomic<bool> failed( false );
+
+            threadPool.ParallelFor( 0, static_cast<uint32_t>( staleAssets.size() ), 1, [&]( uint32_t begin, uint32_t end )
+            {
+                for ( uint32_t i = begin; i < end; ++i )
+                {
+                    Asset& asset = m_Assets[staleAssets[i]];
+                    auto assetStart = Clock::now();
+
+                    bool cooked = asset.Type == AssetType::Scene ? CookScene( asset ) : CookTexture( asset );
+
+                    asset.CookTime = GetElapsedTime( assetStart );
+                    asset.Status = cooked ? AssetStatus::Cooked : AssetStatus::Failed;
+
+                    if ( !cooked )
+                    {
+                        LOG_ERROR( "Failed to cook ", asset.FilePath );
+                        failed = true;
+                    }
+                }
+            } );
+
+            result = result && !failed;
+        }
+
+        m_LevelTimes.push_back( GetElapsedTime( levelStart ) );
+    }
+
+    m_CookTime = GetElapsedTime( start );
+
+    return result;
+}
+
+bool AssetCooker::CookScene( const Asset& asset )
+{
+    scoped_lock lock( m_SceneMutex );
+
+    LOG_INFO( "Cooking scene ", asset.FilePath );
+
+    // The cooked scene file is only written if the scene is imported.
+    if ( fs::exists( asset.CookedFilePath ) )
+    {
+        fs::remove( asset.CookedFilePath );
+    }
+
+    auto scene = m_Device->CreateScene();
+    scene->SetVertexFormat( m_Settings.VertexFormat );
+    scene->SetOptimizeOverdraw( m_Settings.OptimizeOverdraw );
+    scene->SetTextureCompression( m_Settings.TextureCompression );
+
+    auto commandQueue = m_Device->GetComputeQueue();
+    auto commandBuffer = commandQueue->GetComputeCommandBuffer();
+
+    bool result = scene->LoadFromFile( commandBuffer, asset.FilePath.wstring() );
+
+    // The textures of the scene are uploaded to the GPU even though they are not used.
+    commandQueue->Submit( commandBuffer )->WaitFor();
+
+    return result && fs::exists( asset.CookedFilePath );
+}
+
+bool AssetCooker::CookTexture( const Asset& asset )
+{
+    LOG_INFO( "Cooking texture ", asset.FilePath );
+
+    // The cooked texture is only cooked again by the texture cooker if it's out of date.
+    if ( m_Settings.Force && fs::exists( asset.CookedFilePath ) )
+    {
+        fs::remove( asset.CookedFilePath );
+    }
+
+    // Only the smallest mip levels of the cooked texture are returned.
+    TextureImage image;
+    bool result = TextureCookerDX12::LoadTexture2D( asset.FilePath.wstring(), asset.TextureUsage, m_Settings.TextureCompression, image, 1 );
+
+    return result && fs::exists( asset.CookedFilePath );
+}
+
+void AssetCooker::PrintReport( std::wostream& stream ) const
+{
+    const AssetType assetTypes[] = { AssetType::Scene, AssetType::Texture, AssetType::Shader };
+
+    size_t numCooked = 0;
+    size_t numStale = 0;
+    size_t numFailed = 0;
+    for ( const Asset& asset : m_Assets )
+    {
+        numCooked += asset.Status == AssetStatus::Cooked ? 1 : 0;
+        numStale += asset.Status == AssetStatus::Stale ? 1 : 0;
+        numFailed += asset.Status == AssetStatus::Failed ? 1 : 0;
+    }
+
+    stream << std::fixed << std::setprecision( 3 );
+
+    if ( m_Settings.DryRun )
+    {
+        stream << numStale << L" of " << m_Assets.size() << L" assets are stale." << std::endl;
+    }
+    else
+    {
+        stream << L"Cooked " << numCooked << L" of " << m_Assets.size() << L" assets (" << numFailed << L" failed) on "
+               << ThreadPool::Get().GetConcurrency() << L" threads." << std::endl;
+    }
+
+    stream << L"  " << std::left << std::setw( 12 ) << L"Type" << std::right
+           << std::setw( 10 ) << L"Assets" << std::setw( 12 ) << L"Up to date" << std::setw( 10 ) << L"Stale"
+           << std::setw( 10 ) << L"Cooked" << std::setw( 10 ) << L"Failed" << std::setw( 10 ) << L"Skipped" << std::endl;
+
+    for ( AssetType type : assetTypes )
+    {
+        size_t counts[5] = {};
+        size_t numAssets = 0;
+        for ( const Asset& asset : m_Assets )
+        {
+            if ( asset.Type == type )
+            {
+                ++counts[static_cast<int>( asset.Status )];
+                ++numAssets;
+            }
+        }
+
+        stream << L"  " << std::left << std::setw( 12 ) << GetAssetTypeName( type ) << std::right << std::setw( 10 ) << numAssets;
+        for ( size_t i = 0; i < 5; ++i )
+        {
+            stream << std::setw( i == 0 ? 12 : 10 ) << counts[i];
+        }
+        stream << std::endl;
+    }
+
+    stream << L"Scan:  " << std::setw( 12 ) << m_ScanTime << L" ms" << std::endl
+           << L"Check: " << std::setw( 12 ) << m_CheckTime << L" ms" << std::endl
+           << L"Cook:  " << std::setw( 12 ) << m_CookTime << L" ms" << std::endl;
+
+    for ( size_t i = 0; i < m_LevelTimes.size(); ++i )
+    {
+        stream << L"  Level " << std::left << std::setw( 4 ) << i << std::right << std::setw( 12 ) << m_LevelTimes[i] << L" ms ("
+               << m_Levels[i].size() << L" assets)" << std::endl;
+    }
+
+    std::vector<const Asset*> cookedAssets;
+    for ( const Asset& asset : m_Assets )
+    {
+        if ( asset.Status == AssetStatus::Cooked || asset.Status == AssetStatus::Failed )
+        {
+            cookedAssets.push_back( &asset );
+        }
+    }
+
+    std::sort( cookedAssets.begin(), cookedAssets.end(), []( const Asset* a, const Asset* b )
+    {
+        return a->CookTime > b->CookTime;
+    } );
+
+    if ( !cookedAssets.empty() )
+    {
+        stream << L"Slowest assets:" << std::endl;
+        for ( size_t i = 0; i < std::min( cookedAssets.size(), NumSlowestAssets ); ++i )
+        {
+            stream << L"  " << std::setw( 12 ) << cookedAssets[i]->CookTime << L" ms  " << cookedAssets[i]->FilePath.wstring() << std::endl;
+        }
+    }
+}
+
+const std::vector<AssetCooker::Asset>& AssetCooker::GetAssets() const
+{
+    return m_Assets;
+}
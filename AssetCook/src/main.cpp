@@ -0,0 +1,139 @@
+#include <GamePCH.h>
+#include <EngineIncludes.h>
+#include <DependencyDatabase.h>
+
+#include <AssetCooker.h>
+#include <ConfigurationSettings.h>
+
+using namespace Core;
+using namespace Graphics;
+
+void PrintUsage()
+{
+    std::wcout << L"Usage: AssetCook [options]" << std::endl
+               << L"  -r, --root <directory>       Content root of the assets to cook (default: ../Assets)." << std::endl
+               << L"  -d, --database <file>        Dependency database (default: Dependencies.db in the content root)." << std::endl
+               << L"  -c, --config <file>          Configuration file with the vertex format and texture compression (default: ../Conf/DefaultConfiguration.3dgep)." << std::endl
+               << L"  -f, --force                  Cook all assets, even if they are up to date." << std::endl
+               << L"  -n, --dry-run                Only report the assets that are stale." << std::endl
+               << L"  --warp                       Use the WARP adapter." << std::endl;
+}
+
+int wmain( int argc, wchar_t* argv[] )
+{
+    ::CoInitializeEx( nullptr, COINIT_MULTITHREADED );
+
+    LogManager::Init();
+
+    std::shared_ptr<LogStreamConsole> coutLogStream = std::make_shared<LogStreamConsole>();
+    LogManager::RegisterLogStream( coutLogStream );
+
+    std::wstring contentRoot = L"../Assets";
+    std::wstring configFileName = L"../Conf/DefaultConfiguration.3dgep";
+    std::wstring databaseFileName;
+    bool force = false;
+    bool dryRun = false;
+    bool useWarpAdapter = false;
+
+    // Parse command line arguments.
+    for ( int i = 1; i < argc; i++ )
+    {
+        std::wstring arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if ( ( arg == L"-r" || arg == L"--root" ) && hasValue )
+        {
+            contentRoot = argv[++i];
+        }
+        else if ( ( arg == L"-d" || arg == L"--database" ) && hasValue )
+        {
+            databaseFileName = argv[++i];
+        }
+        else if ( ( arg == L"-c" || arg == L"--config" ) && hasValue )
+        {
+            configFileName = argv[++i];
+        }
+        else if ( arg == L"-f" || arg == L"--force" )
+        {
+            force = true;
+        }
+        else if ( arg == L"-n" || arg == L"--dry-run" )
+        {
+            dryRun = true;
+        }
+        else if ( arg == L"--warp" )
+        {
+            useWarpAdapter = true;
+        }
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // The assets must be cooked with the same settings as the Game loads them.
+    ConfigurationSettings config;
+    if ( !config.Load( configFileName ) )
+    {
+        LOG_ERROR( "Failed to load configuration file ", configFileName );
+        return -1;
+    }
+
+    CookSettings settings;
+    settings.VertexFormat = config.CompactVertices ? Mesh::VertexFormat::Compact : Mesh::VertexFormat::Standard;
+    settings.OptimizeOverdraw = config.OptimizeOverdraw;
+    settings.TextureCompression = !config.CompressTextures ? TextureCompression::None :
+                                  config.HighQualityTextureCompression ? TextureCompression::HighQuality : TextureCompression::Default;
+    settings.Force = force;
+    settings.DryRun = dryRun;
+
+    // The application is only used to create the device (scenes upload their meshes when they are loaded). No window is created.
+    ApplicationDX12 application;
+
+    const AdapterList& adapters = application.GetAdapters();
+    std::shared_ptr<Adapter> adapter;
+    if ( useWarpAdapter || adapters.empty() )
+    {
+        LogManager::LogWarning( "Using Warp Adapter." );
+        adapter = application.GetWarpAdapter();
+    }
+    else
+    {
+        adapter = adapters[0];
+    }
+
+    std::shared_ptr<Device> device = application.CreateDevice( adapter );
+
+    // The Game uses the database in the content root.
+    if ( databaseFileName.empty() )
+    {
+        databaseFileName = ( fs::path( contentRoot ) / L"Dependencies.db" ).wstring();
+    }
+
+    DependencyDatabase& dependencyDatabase = DependencyDatabase::Get();
+    dependencyDatabase.Load( databaseFileName );
+
+    int result = 0;
+    {
+        AssetCooker assetCooker( device, settings );
+
+        if ( !assetCooker.Scan( contentRoot ) || !assetCooker.Cook() )
+        {
+            result = -1;
+        }
+
+        assetCooker.PrintReport( std::wcout );
+    }
+
+    if ( !dryRun )
+    {
+        dependencyDatabase.Save();
+    }
+
+    LogManager::Shutdown();
+
+    ::CoUninitialize();
+
+    return result;
+}
@@ -26,19 +26,7 @@ groupshared uint gs_ParentIndex;        // The index of the parent node in the B
 groupshared uint gs_ClusterIndex1D;
 groupshared AABB gs_ClusterAABB;
 
-groupshared uint gs_PointLightCount;
-groupshared uint gs_SpotLightCount;
-groupshared uint gs_PointLightStartOffset;
-groupshared uint gs_SpotLightStartOffset;
-groupshared uint gs_PointLightList[MAX_LIGHTS];
-groupshared uint gs_SpotLightList[MAX_LIGHTS];
-
-#define AppendLight( lightIndex, counter, lightList ) \
-    InterlockedAdd( counter, 1, index ); \
-    if ( index < MAX_LIGHTS ) \
-    { \
-        lightList[index] = lightIndex; \
-    }
+#include "Include/ClusterLightLists.hlsli"
 
 void PushNode( uint nodeIndex )
 {
@@ -87,19 +75,19 @@ uint GetLeafIndex( uint nodeIndex, uint numLevels )
 [numthreads( NUM_THREADS, 1, 1 )]
 void main( ComputeShaderInput IN )
 {
-    uint i, index;
+    uint i;
     uint childOffset = IN.GroupIndex;
 
     if ( IN.GroupIndex == 0 )
     {
-        gs_PointLightCount = 0;
-        gs_SpotLightCount = 0;
         gs_StackPtr = 0;
         gs_ParentIndex = 0;
 
         gs_ClusterIndex1D = UniqueClusters[IN.GroupID.x];
         gs_ClusterAABB = ClusterAABBs[gs_ClusterIndex1D];
 
+        InitLightLists();
+
         // Push the root node (at index 0) on the node stack.
         PushNode( 0 );
     }
@@ -122,7 +110,7 @@ void main( ComputeShaderInput IN )
 
                 if ( pointLight.Enabled && SphereInsideAABB( sphere, gs_ClusterAABB ) )
                 {
-                    AppendLight( lightIndex, gs_PointLightCount, gs_PointLightList );
+                    AppendPointLight( lightIndex );
                 }
             }
         }
@@ -172,7 +160,7 @@ void main( ComputeShaderInput IN )
 
                 if ( spotLight.Enabled && SphereInsideAABB( sphere, gs_ClusterAABB ) )
                 {
-                    AppendLight( lightIndex, gs_SpotLightCount, gs_SpotLightList );
+                    AppendSpotLight( lightIndex );
                 }
             }
         }
@@ -193,27 +181,5 @@ void main( ComputeShaderInput IN )
     } while ( gs_ParentIndex > 0 );
 
     // Now update the global light grids with the light lists and light counts.
-    if ( IN.GroupIndex == 0 )
-    {
-        // Update light grid for point lights.
-        InterlockedAdd( RWPointLightIndexCounter_Cluster[0], gs_PointLightCount, gs_PointLightStartOffset );
-        RWPointLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_PointLightStartOffset, gs_PointLightCount );
-
-        // Update light grid for spot lights.
-        InterlockedAdd( RWSpotLightIndexCounter_Cluster[0], gs_SpotLightCount, gs_SpotLightStartOffset );
-        RWSpotLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_SpotLightStartOffset, gs_SpotLightCount );
-    }
-
-    GroupMemoryBarrierWithGroupSync();
-
-    // Now update the global light index lists with the group shared light lists.
-    for ( i = IN.GroupIndex; i < gs_PointLightCount; i += NUM_THREADS )
-    {
-        RWPointLightIndexList_Cluster[gs_PointLightStartOffset + i] = gs_PointLightList[i];
-    }
-
-    for ( i = IN.GroupIndex; i < gs_SpotLightCount; i += NUM_THREADS )
-    {
-        RWSpotLightIndexList_Cluster[gs_SpotLightStartOffset + i] = gs_SpotLightList[i];
-    }
+    WriteLightLists( IN.GroupIndex );
 }
@@ -1,37 +1,25 @@
 #include "Include/CommonInclude.hlsli"
 
 #define NUM_THREADS 1024
+#define MAX_LIGHTS 1024
 
 groupshared uint gs_ClusterIndex1D;
 groupshared AABB gs_ClusterAABB;
 
-groupshared uint gs_PointLightCount;
-groupshared uint gs_SpotLightCount;
-groupshared uint gs_PointLightStartOffset;
-groupshared uint gs_SpotLightStartOffset;
-groupshared uint gs_PointLightList[1024];
-groupshared uint gs_SpotLightList[1024];
-
-#define AppendLight( lightIndex, counter, lightList ) \
-    InterlockedAdd( counter, 1, index ); \
-    if ( index < 1024 ) \
-    { \
-        lightList[index] = lightIndex; \
-    }
+#include "Include/ClusterLightLists.hlsli"
 
 [RootSignature( AssignLightsToClusters_RS )]
 [numthreads( NUM_THREADS, 1, 1 )]
 void main( ComputeShaderInput IN )
 {
-    uint i, index;
+    uint i;
 
     if ( IN.GroupIndex == 0 )
     {
-        gs_PointLightCount = 0;
-        gs_SpotLightCount = 0;
-
         gs_ClusterIndex1D = UniqueClusters[IN.GroupID.x];
         gs_ClusterAABB = ClusterAABBs[gs_ClusterIndex1D];
+
+        InitLightLists();
     }
 
     GroupMemoryBarrierWithGroupSync();
@@ -46,7 +34,7 @@ void main( ComputeShaderInput IN )
 
             if ( SphereInsideAABB( sphere, gs_ClusterAABB ) )
             {
-                AppendLight( i, gs_PointLightCount, gs_PointLightList );
+                AppendPointLight( i );
             }
         }
     }
@@ -63,7 +51,7 @@ void main( ComputeShaderInput IN )
             // tests. For now, just treat spotlights cones as spheres.
             if ( SphereInsideAABB( sphere, gs_ClusterAABB ) )
             {
-                AppendLight( i, gs_SpotLightCount, gs_SpotLightList );
+                AppendSpotLight( i );
             }
         }
     }
@@ -71,29 +59,7 @@ void main( ComputeShaderInput IN )
     GroupMemoryBarrierWithGroupSync();
 
     // Now update the global light grids with the light lists and light counts.
-    if ( IN.GroupIndex == 0 )
-    {
-        // Update light grid for point lights.
-        InterlockedAdd( RWPointLightIndexCounter_Cluster[0], gs_PointLightCount, gs_PointLightStartOffset );
-        RWPointLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_PointLightStartOffset, gs_PointLightCount );
-
-        // Update light grid for spot lights.
-        InterlockedAdd( RWSpotLightIndexCounter_Cluster[0], gs_SpotLightCount, gs_SpotLightStartOffset );
-        RWSpotLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_SpotLightStartOffset, gs_SpotLightCount );
-    }
-
-    GroupMemoryBarrierWithGroupSync();
-
-    // Now update the global light index lists with the group shared light lists.
-    for ( i = IN.GroupIndex; i < gs_PointLightCount; i += NUM_THREADS )
-    {
-        RWPointLightIndexList_Cluster[gs_PointLightStartOffset + i] = gs_PointLightList[i];
-    }
-
-    for ( i = IN.GroupIndex; i < gs_SpotLightCount; i += NUM_THREADS )
-    {
-        RWSpotLightIndexList_Cluster[gs_SpotLightStartOffset + i] = gs_SpotLightList[i];
-    }
+    WriteLightLists( IN.GroupIndex );
 
     // TODO: Update debug texture?
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "Include/CommonInclude.hlsli"
+
+/**
+ * Build the Z-bins and the screen tile light bitmasks for Z-binned rendering.
+ *
+ * Before building the Z-bins, the lights are sorted by their view space depth
+ * (see DepthKeys in ComputeLightMortonCodes_CS.hlsl). The depth range between
+ * the near and far clipping planes is divided into ZBinCB.NumZBins Z-bins of
+ * equal depth. Each Z-bin stores the minimum and maximum index into the sorted
+ * light list of the lights that overlap the Z-bin. Since the lights are sorted
+ * by depth, the range of lights in a Z-bin is tight.
+ *
+ * For every screen tile, a bitmask stores which (sorted) lights overlap the
+ * frustum of the tile. Only the side planes of the tile frustum are tested,
+ * the depth is handled by the Z-bins.
+ *
+ * During shading, the lights of a pixel are found by iterating the bits of the
+ * tile bitmask within the range of the Z-bin of the pixel.
+ * Source: Improved Culling for Tiled and Clustered Rendering (2017), Michal Drobot.
+ */
+
+#ifndef NUM_THREADS
+#define NUM_THREADS 1024
+#endif
+
+// The number of bitmask words that are computed by a single thread group.
+#ifndef NUM_WORD_THREADS
+#define NUM_WORD_THREADS 64
+#endif
+
+// Compute the range of Z-bins that is overlapped by a sphere.
+// Returns false if the sphere is completely in front of the near clipping plane
+// or behind the far clipping plane.
+bool ComputeZBinRange( Sphere sphere, out uint2 zBinRange )
+{
+    // View space depth is along the -Z axis.
+    float minDepth = -sphere.c.z - sphere.r;
+    float maxDepth = -sphere.c.z + sphere.r;
+    float zFar = ZBinCB.ZNear + ZBinCB.NumZBins / ZBinCB.InvBinDepth;
+
+    zBinRange = uint2( ComputeZBin( minDepth ), ComputeZBin( maxDepth ) );
+
+    return maxDepth >= ZBinCB.ZNear && minDepth <= zFar;
+}
+
+// Add the light at index i in the sorted light list to the Z-bins that it overlaps.
+void AddToZBins( RWStructuredBuffer<uint2> zBins, uint i, Sphere sphere )
+{
+    uint2 zBinRange;
+    if ( ComputeZBinRange( sphere, zBinRange ) )
+    {
+        for ( uint zBin = zBinRange.x; zBin <= zBinRange.y; ++zBin )
+        {
+            InterlockedMin( zBins[zBin].x, i );
+            InterlockedMax( zBins[zBin].y, i );
+        }
+    }
+}
+
+// Check if a sphere is (partially) inside the side planes of a tile frustum.
+bool SphereInsideTile( Sphere sphere, Frustum frustum )
+{
+    bool result = true;
+
+    for ( int i = 0; i < 4 && result; i++ )
+    {
+        if ( SphereInsidePlane( sphere, frustum.planes[i] ) )
+        {
+            result = false;
+        }
+    }
+
+    return result;
+}
+
+// Reset all Z-bins to empty ( first > last ).
+[RootSignature( ZBinning_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void ClearZBins( ComputeShaderInput IN )
+{
+    uint zBin = IN.DispatchThreadID.x;
+
+    if ( zBin < ZBinCB.NumZBins )
+    {
+        RWPointLightZBins[zBin] = uint2( 0xffffffff, 0 );
+        RWSpotLightZBins[zBin] = uint2( 0xffffffff, 0 );
+    }
+}
+
+// Each thread adds a single (sorted) point and spot light to the Z-bins it overlaps.
+[RootSignature( ZBinning_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void BuildZBins( ComputeShaderInput IN )
+{
+    uint i = IN.DispatchThreadID.x;
+
+    if ( i < LightCountsCB.NumPointLights )
+    {
+        PointLight pointLight = PointLights[PointLightIndices[i]];
+        if ( pointLight.Enabled )
+        {
+            Sphere sphere = { pointLight.PositionVS.xyz, pointLight.Range };
+            AddToZBins( RWPointLightZBins, i, sphere );
+        }
+    }
+
+    if ( i < LightCountsCB.NumSpotLights )
+    {
+        SpotLight spotLight = SpotLights[SpotLightIndices[i]];
+        if ( spotLight.Enabled )
+        {
+            // Spot lights are treated as spheres for Z-binning.
+            Sphere sphere = { spotLight.PositionVS.xyz, spotLight.Range };
+            AddToZBins( RWSpotLightZBins, i, sphere );
+        }
+    }
+}
+
+// Each thread computes a single 32-bit word of the point and spot light bitmasks of a tile.
+// The X dimension of the dispatch is the word index, the Y dimension is the tile index.
+[RootSignature( ZBinning_RS )]
+[numthreads( NUM_WORD_THREADS, 1, 1 )]
+void BuildTileMasks( ComputeShaderInput IN )
+{
+    uint word = IN.DispatchThreadID.x;
+    uint tileIndex = IN.DispatchThreadID.y;
+
+    if ( tileIndex >= ZBinCB.NumTiles ) return;
+
+    Frustum frustum = Frustums[tileIndex];
+    uint i;
+
+    if ( word < ZBinCB.NumPointLightWords )
+    {
+        uint mask = 0;
+        uint firstLight = word * 32;
+        uint numLights = min( LightCountsCB.NumPointLights - firstLight, 32 );
+
+        for ( i = 0; i < numLights; ++i )
+        {
+            PointLight pointLight = PointLights[PointLightIndices[firstLight + i]];
+            Sphere sphere = { pointLight.PositionVS.xyz, pointLight.Range };
+
+            if ( pointLight.Enabled && SphereInsideTile( sphere, frustum ) )
+            {
+                mask |= 1u << i;
+            }
+        }
+
+        RWPointLightTileMasks[tileIndex * ZBinCB.NumPointLightWords + word] = mask;
+    }
+
+    if ( word < ZBinCB.NumSpotLightWords )
+    {
+        uint mask = 0;
+        uint firstLight = word * 32;
+        uint numLights = min( LightCountsCB.NumSpotLights - firstLight, 32 );
+
+        for ( i = 0; i < numLights; ++i )
+        {
+            SpotLight spotLight = SpotLights[SpotLightIndices[firstLight + i]];
+            Sphere sphere = { spotLight.PositionVS.xyz, spotLight.Range };
+
+            if ( spotLight.Enabled && SphereInsideTile( sphere, frustum ) )
+            {
+                mask |= 1u << i;
+            }
+        }
+
+        RWSpotLightTileMasks[tileIndex * ZBinCB.NumSpotLightWords + word] = mask;
+    }
+}
@@ -8,8 +8,34 @@ groupshared AABB gs_AABB;
 groupshared float4 gs_AABBRange;
 
 // Produce a 3k-bit morton code from a quantized coordinate.
-uint MortonCode( uint3 quantizedCoord, uint k )
+MortonCodeType MortonCode( uint3 quantizedCoord, uint k )
 {
+#if MORTON_CODE_64
+    // The low 32 bits of the morton code are stored in x, the high bits in y.
+    uint2 mortonCode = uint2( 0, 0 );
+
+    for ( uint i = 0; i < k; ++i )
+    {
+        // Interleave the bits of the X, Y, and Z coordinates to produce the final Morton code.
+        [unroll]
+        for ( uint j = 0; j < 3; ++j )
+        {
+            uint bit = ( quantizedCoord[j] >> i ) & 1;
+            uint bitShift = i * 3 + j;
+
+            if ( bitShift < 32 )
+            {
+                mortonCode.x |= bit << bitShift;
+            }
+            else
+            {
+                mortonCode.y |= bit << ( bitShift - 32 );
+            }
+        }
+    }
+
+    return mortonCode;
+#else
     uint mortonCode = 0;
     uint bitMask = 1;
     uint bitShift = 0;
@@ -27,6 +53,7 @@ uint MortonCode( uint3 quantizedCoord, uint k )
     }
 
     return mortonCode;
+#endif
 }
 
 [RootSignature( ComputeLightMortonCodes_RS )]
@@ -37,7 +64,8 @@ void main( ComputeShaderInput IN )
 
     // Generate 3k-bit morton codes.
     // For k = 10, morton codes will be 30-bits.
-    const uint kBitMortonCode = 10;
+    // For k = 21 (MORTON_CODE_64), morton codes will be 63-bits.
+    const uint kBitMortonCode = MORTON_CODE_BITS;
     // To quantize the light's position, the light's view space position will 
     // be normalized based on the AABB that encompases all lights.
     // The normalized value will then be scaled based on the k-bits of the morton 
@@ -77,4 +105,50 @@ void main( ComputeShaderInput IN )
         RWSpotLightIndices[threadIndex] = threadIndex;
     }
 
+}
+
+// Depth keys are quantized to 30 bits so that they can be sorted with the
+// same radix sort and merge sort passes as the 30-bit Morton codes.
+#define DEPTH_KEY_BITS 30
+#define DEPTH_KEY_MAX ( ( 1u << DEPTH_KEY_BITS ) - 1 )
+
+// Produce a sort key from the view space depth of a light.
+// Disabled lights are sorted to the end of the list.
+MortonCodeType DepthKey( float4 positionVS, bool enabled )
+{
+    // Normalize the depth of the light between the near and far clipping planes of the Z-bins.
+    float depth = saturate( ( -positionVS.z - ZBinCB.ZNear ) * ZBinCB.InvBinDepth / ZBinCB.NumZBins );
+    uint key = enabled ? (uint)( depth * DEPTH_KEY_MAX ) : DEPTH_KEY_MAX;
+
+#if MORTON_CODE_64
+    return uint2( key, 0 );
+#else
+    return key;
+#endif
+}
+
+// Compute the sort keys to sort the lights by view space depth for Z-binning.
+// The keys are written to the Morton code buffers so the lights can be sorted
+// with the same sort passes that are used to sort the Morton codes.
+[RootSignature( ComputeLightDepthKeys_RS )]
+[numthreads(NUM_THREADS, 1, 1)]
+void DepthKeys( ComputeShaderInput IN )
+{
+    uint threadIndex = IN.DispatchThreadID.x;
+
+    if ( threadIndex < LightCountsCB.NumPointLights )
+    {
+        PointLight pointLight = PointLights[threadIndex];
+
+        RWPointLightMortonCodes[threadIndex] = DepthKey( pointLight.PositionVS, pointLight.Enabled );
+        RWPointLightIndices[threadIndex] = threadIndex;
+    }
+
+    if ( threadIndex < LightCountsCB.NumSpotLights )
+    {
+        SpotLight spotLight = SpotLights[threadIndex];
+
+        RWSpotLightMortonCodes[threadIndex] = DepthKey( spotLight.PositionVS, spotLight.Enabled );
+        RWSpotLightIndices[threadIndex] = threadIndex;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "Include/CommonInclude.hlsli"
+
+/**
+ * Find the clusters whose light lists must be updated for incremental light assignment.
+ *
+ * The light lists of a cluster only depend on the bounding spheres of the lights
+ * that overlap the cluster. If the camera does not move, the light lists of the
+ * previous frame are still valid except for:
+ * 1. Clusters that are overlapped by the previous or current bounding sphere of a
+ *    light that moved, changed range or was enabled/disabled since the previous frame.
+ * 2. Clusters that did not contain samples in the previous frame (newly visible clusters).
+ *
+ * FindMovedLights compares the lights against the lights of the previous frame and
+ * stores the previous and current bounding spheres of the lights that changed.
+ * FindDirtyClusters appends the unique clusters that need to be updated to the
+ * dirty cluster list. The light assignment compute shaders are then only dispatched
+ * for the dirty clusters and all other clusters keep their light lists.
+ *
+ * Every cluster is tested against all moved light spheres. If too many lights moved,
+ * LimitMovedLights falls back to rebuilding the light lists of all visible clusters.
+ */
+
+#define NUM_THREADS 1024
+
+// Maximum number of moved lights that are tested against the clusters
+// (at most 1/MOVED_LIGHTS_FRACTION of the lights).
+#define MAX_MOVED_LIGHTS 256
+#define MOVED_LIGHTS_FRACTION 16
+
+// Stored in the moved light counter to mark all visible clusters as dirty.
+#define REBUILD_ALL_CLUSTERS 0xffffffff
+
+// Bounding sphere of a light (negative radius for disabled lights).
+float4 LightSphere( float4 positionVS, float range, bool enabled )
+{
+    return float4( positionVS.xyz, enabled ? range : -1.0f );
+}
+
+void AppendMovedLight( float4 previousSphere, float4 currentSphere )
+{
+    uint index;
+    InterlockedAdd( RWMovedLightCounter[0], 2, index );
+
+    RWMovedLightSpheres[index + 0] = previousSphere;
+    RWMovedLightSpheres[index + 1] = currentSphere;
+}
+
+// Each thread compares a single point and spot light against the lights of the previous frame.
+[RootSignature( FindMovedLights_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void FindMovedLights( ComputeShaderInput IN )
+{
+    uint i = IN.DispatchThreadID.x;
+
+    if ( i < LightCountsCB.NumPointLights )
+    {
+        PointLight pointLight = PointLights[i];
+        PointLight previousPointLight = PreviousPointLights[i];
+
+        float4 sphere = LightSphere( pointLight.PositionVS, pointLight.Range, pointLight.Enabled );
+        float4 previousSphere = LightSphere( previousPointLight.PositionVS, previousPointLight.Range, previousPointLight.Enabled );
+
+        if ( any( sphere != previousSphere ) )
+        {
+            AppendMovedLight( previousSphere, sphere );
+        }
+    }
+
+    if ( i < LightCountsCB.NumSpotLights )
+    {
+        SpotLight spotLight = SpotLights[i];
+        SpotLight previousSpotLight = PreviousSpotLights[i];
+
+        // Spot lights are treated as spheres for light assignment.
+        float4 sphere = LightSphere( spotLight.PositionVS, spotLight.Range, spotLight.Enabled );
+        float4 previousSphere = LightSphere( previousSpotLight.PositionVS, previousSpotLight.Range, previousSpotLight.Enabled );
+
+        if ( any( sphere != previousSphere ) )
+        {
+            AppendMovedLight( previousSphere, sphere );
+        }
+    }
+}
+
+// If too many lights moved, rebuild the light lists of all visible clusters instead.
+// All light lists are rebuilt so the light index lists can start from the beginning.
+[RootSignature( LimitMovedLights_RS )]
+[numthreads( 1, 1, 1 )]
+void LimitMovedLights()
+{
+    uint numLights = LightCountsCB.NumPointLights + LightCountsCB.NumSpotLights;
+    uint maxMovedLights = clamp( numLights / MOVED_LIGHTS_FRACTION, 1, MAX_MOVED_LIGHTS );
+
+    // Each moved light stores two spheres.
+    if ( RWMovedLightCounter[0] > maxMovedLights * 2 )
+    {
+        RWMovedLightCounter[0] = REBUILD_ALL_CLUSTERS;
+        RWPointLightIndexCounter_Cluster[0] = 0;
+        RWSpotLightIndexCounter_Cluster[0] = 0;
+    }
+}
+
+// Each thread checks a single cluster of the cluster grid.
+[RootSignature( FindDirtyClusters_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void FindDirtyClusters( ComputeShaderInput IN )
+{
+    uint clusterIndex1D = IN.DispatchThreadID.x;
+    uint numClusters, stride;
+    ClusterFlags.GetDimensions( numClusters, stride );
+
+    if ( clusterIndex1D >= numClusters || !ClusterFlags[clusterIndex1D] ) return;
+
+    uint numSpheres = MovedLightCounter[0];
+
+    // Newly visible clusters don't have valid light lists.
+    bool dirty = numSpheres == REBUILD_ALL_CLUSTERS || !PreviousClusterFlags[clusterIndex1D];
+
+    AABB aabb = ClusterAABBs[clusterIndex1D];
+
+    for ( uint i = 0; i < numSpheres && !dirty; ++i )
+    {
+        float4 s = MovedLightSpheres[i];
+        Sphere sphere = { s.xyz, s.w };
+
+        if ( sphere.r >= 0.0f && SphereInsideAABB( sphere, aabb ) )
+        {
+            dirty = true;
+        }
+    }
+
+    if ( dirty )
+    {
+        uint index = RWDirtyClusters.IncrementCounter();
+        RWDirtyClusters[index] = clusterIndex1D;
+    }
+}
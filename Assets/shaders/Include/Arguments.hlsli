@@ -59,6 +59,11 @@ cbuffer _BVHParamsCB : register( b9 )
     BVHParams BVHParamsCB;
 }
 
+cbuffer _ZBinParamsCB : register( b10 )
+{
+    ZBinParams ZBinCB;
+}
+
 /*******************************************************************************
  *
  * Samplers
@@ -141,7 +146,7 @@ StructuredBuffer<uint2> SpotLightGrid_Cluster : register( t24 );
 StructuredBuffer<AABB> LightAABB : register( t25 );
 
 // Input keys for the radix and merge sort compute shaders.
-StructuredBuffer<uint> InputKeys : register( t26 );
+StructuredBuffer<MortonCodeType> InputKeys : register( t26 );
 // Input values for the radix and merge sort compute shaders.
 StructuredBuffer<uint> InputValues : register( t27 );
 
@@ -158,6 +163,54 @@ StructuredBuffer<AABB> PointLightBVH : register( t31 );
 // Spot light BVH.
 StructuredBuffer<AABB> SpotLightBVH : register( t32 );
 
+/**
+ * Z-bins for Z-binned rendering.
+ * For every Z-bin, the first (x) and last (y) index into the depth sorted
+ * light indices (PointLightIndices, SpotLightIndices) of the lights that
+ * overlap the Z-bin. If x > y, the Z-bin is empty.
+ * @see BuildZBins_CS.hlsl
+ */
+StructuredBuffer<uint2> PointLightZBins : register( t33 );
+StructuredBuffer<uint2> SpotLightZBins : register( t34 );
+
+/**
+ * Per screen tile light bitmasks for Z-binned rendering.
+ * Bit i of the bitmask of a tile is set if the i-th light in the depth sorted
+ * light indices overlaps the tile. The bitmask of each tile consists of
+ * ZBinCB.NumPointLightWords (or ZBinCB.NumSpotLightWords) 32-bit words.
+ */
+StructuredBuffer<uint> PointLightTileMasks : register( t35 );
+StructuredBuffer<uint> SpotLightTileMasks : register( t36 );
+
+/**
+ * The lights of the previous frame for incremental light assignment.
+ * Lights that moved (or changed range) are found by comparing against these.
+ */
+StructuredBuffer<PointLight> PreviousPointLights : register( t37 );
+StructuredBuffer<SpotLight> PreviousSpotLights : register( t38 );
+
+// The cluster flags of the current and the previous frame.
+StructuredBuffer<bool> ClusterFlags : register( t39 );
+StructuredBuffer<bool> PreviousClusterFlags : register( t40 );
+
+/**
+ * The previous (even) and current (odd) bounding spheres of the lights
+ * that moved since the previous frame. A negative radius is used for
+ * disabled lights. The number of spheres is stored in MovedLightCounter.
+ * @see FindDirtyClusters_CS.hlsl
+ */
+StructuredBuffer<float4> MovedLightSpheres : register( t41 );
+StructuredBuffer<uint> MovedLightCounter : register( t42 );
+
+/**
+ * The world transforms of the instances of the mesh that is rendered
+ * (indexed by SV_InstanceID). The scene passes render every mesh as one
+ * or more instances, so the per object data only provides the view and
+ * projection matrices to the vertex shaders.
+ * @see BasePass::SubmitDraws
+ */
+StructuredBuffer<InstanceData> Instances : register( t43 );
+
 
 /*******************************************************************************
  *
@@ -249,13 +302,13 @@ RWStructuredBuffer<AABB> RWLightAABB : register( u25 );
  * based on their morton codes.
  * This buffer is used to store the morton codes for the lights.
  */
-RWStructuredBuffer<uint> RWPointLightMortonCodes : register( u26 );
-RWStructuredBuffer<uint> RWSpotLightMortonCodes : register( u27 );
+RWStructuredBuffer<MortonCodeType> RWPointLightMortonCodes : register( u26 );
+RWStructuredBuffer<MortonCodeType> RWSpotLightMortonCodes : register( u27 );
 RWStructuredBuffer<uint> RWPointLightIndices : register( u28 );
 RWStructuredBuffer<uint> RWSpotLightIndices : register( u29 );
 
 // Output keys for the radix/merge sort compute shaders.
-RWStructuredBuffer<uint> OutputKeys : register( u30 );
+RWStructuredBuffer<MortonCodeType> OutputKeys : register( u30 );
 // Output values for the radix/merge sort compute shaders.
 RWStructuredBuffer<uint> OutputValues : register( u31 );
 
@@ -269,3 +322,18 @@ RWStructuredBuffer<AABB> RWSpotLightBVH : register( u34 );
 
 // Used for displaying the light counts for clustered shading.
 RWTexture2D<uint2> RWLightCounts : register( u35 );
+
+// The sums of the light counts (point lights in x, spot lights in y) per thread group
+// of the light grid prefix sum. Filled by PrefixSumLightGrid_CS.hlsl.
+RWStructuredBuffer<uint2> RWLightGridGroupSums : register( u36 );
+
+// Z-bins and tile bitmasks for Z-binned rendering.
+RWStructuredBuffer<uint2> RWPointLightZBins : register( u37 );
+RWStructuredBuffer<uint2> RWSpotLightZBins : register( u38 );
+RWStructuredBuffer<uint> RWPointLightTileMasks : register( u39 );
+RWStructuredBuffer<uint> RWSpotLightTileMasks : register( u40 );
+
+// Moved lights and dirty clusters for incremental light assignment.
+RWStructuredBuffer<uint> RWMovedLightCounter : register( u41 );
+RWStructuredBuffer<float4> RWMovedLightSpheres : register( u42 );
+RWStructuredBuffer<uint> RWDirtyClusters : register( u43 );
@@ -0,0 +1,143 @@
+#ifndef __COMMON_INCLUDE_HLSL__
+#error Include CommonInclude.hlsli before including this file.
+#endif
+
+/**
+ * Light lists of a single cluster for the light assignment compute shaders.
+ * The shader that includes this file must define MAX_LIGHTS and NUM_THREADS
+ * and set gs_ClusterIndex1D before calling InitLightLists.
+ *
+ * By default, the lights of a cluster are stored in group shared memory (at most
+ * MAX_LIGHTS lights per cluster) and copied to the light index list at an offset
+ * that is allocated from the global light index counter.
+ *
+ * Light assignment can also be performed in two passes:
+ * 1. COUNT_LIGHTS: Only the number of lights of each cluster is written to the light grid.
+ *    PrefixSumLightGrid_CS.hlsl then computes the offset of each cluster in the light
+ *    index list and the total number of light indices.
+ * 2. FILL_LIGHTS: The light indices are written directly to the light index list at the
+ *    offsets that were computed by the prefix sum. The number of lights per cluster is
+ *    not limited and lights that don't fit in the light index list are dropped.
+ */
+
+groupshared uint gs_PointLightCount;
+groupshared uint gs_SpotLightCount;
+groupshared uint gs_PointLightStartOffset;
+groupshared uint gs_SpotLightStartOffset;
+
+#if defined(FILL_LIGHTS)
+groupshared uint gs_PointLightMaxCount;
+groupshared uint gs_SpotLightMaxCount;
+#elif !defined(COUNT_LIGHTS)
+groupshared uint gs_PointLightList[MAX_LIGHTS];
+groupshared uint gs_SpotLightList[MAX_LIGHTS];
+#endif
+
+// Must be called by the first thread in the group.
+void InitLightLists()
+{
+    gs_PointLightCount = 0;
+    gs_SpotLightCount = 0;
+
+#if defined(FILL_LIGHTS)
+    uint numIndices, stride;
+
+    // Clamp the number of lights so that they fit in the light index list.
+    uint2 pointLightGrid = RWPointLightGrid_Cluster[gs_ClusterIndex1D];
+    RWPointLightIndexList_Cluster.GetDimensions( numIndices, stride );
+    gs_PointLightStartOffset = pointLightGrid.x;
+    gs_PointLightMaxCount = min( pointLightGrid.y, numIndices - min( pointLightGrid.x, numIndices ) );
+
+    uint2 spotLightGrid = RWSpotLightGrid_Cluster[gs_ClusterIndex1D];
+    RWSpotLightIndexList_Cluster.GetDimensions( numIndices, stride );
+    gs_SpotLightStartOffset = spotLightGrid.x;
+    gs_SpotLightMaxCount = min( spotLightGrid.y, numIndices - min( spotLightGrid.x, numIndices ) );
+#endif
+}
+
+void AppendPointLight( uint lightIndex )
+{
+#if defined(COUNT_LIGHTS)
+    InterlockedAdd( gs_PointLightCount, 1 );
+#else
+    uint index;
+    InterlockedAdd( gs_PointLightCount, 1, index );
+#if defined(FILL_LIGHTS)
+    if ( index < gs_PointLightMaxCount )
+    {
+        RWPointLightIndexList_Cluster[gs_PointLightStartOffset + index] = lightIndex;
+    }
+#else
+    if ( index < MAX_LIGHTS )
+    {
+        gs_PointLightList[index] = lightIndex;
+    }
+#endif
+#endif
+}
+
+void AppendSpotLight( uint lightIndex )
+{
+#if defined(COUNT_LIGHTS)
+    InterlockedAdd( gs_SpotLightCount, 1 );
+#else
+    uint index;
+    InterlockedAdd( gs_SpotLightCount, 1, index );
+#if defined(FILL_LIGHTS)
+    if ( index < gs_SpotLightMaxCount )
+    {
+        RWSpotLightIndexList_Cluster[gs_SpotLightStartOffset + index] = lightIndex;
+    }
+#else
+    if ( index < MAX_LIGHTS )
+    {
+        gs_SpotLightList[index] = lightIndex;
+    }
+#endif
+#endif
+}
+
+// Update the light grid (and light index lists) of the cluster.
+// Must be called by all threads in the group after all lights have been appended.
+void WriteLightLists( uint groupIndex )
+{
+    uint i;
+
+    if ( groupIndex == 0 )
+    {
+#if defined(COUNT_LIGHTS)
+        RWPointLightGrid_Cluster[gs_ClusterIndex1D] = uint2( 0, gs_PointLightCount );
+        RWSpotLightGrid_Cluster[gs_ClusterIndex1D] = uint2( 0, gs_SpotLightCount );
+#elif defined(FILL_LIGHTS)
+        RWPointLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_PointLightStartOffset, min( gs_PointLightCount, gs_PointLightMaxCount ) );
+        RWSpotLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_SpotLightStartOffset, min( gs_SpotLightCount, gs_SpotLightMaxCount ) );
+#else
+        // Lights that didn't fit in the group shared light lists are dropped.
+        gs_PointLightCount = min( gs_PointLightCount, MAX_LIGHTS );
+        gs_SpotLightCount = min( gs_SpotLightCount, MAX_LIGHTS );
+
+        // Update light grid for point lights.
+        InterlockedAdd( RWPointLightIndexCounter_Cluster[0], gs_PointLightCount, gs_PointLightStartOffset );
+        RWPointLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_PointLightStartOffset, gs_PointLightCount );
+
+        // Update light grid for spot lights.
+        InterlockedAdd( RWSpotLightIndexCounter_Cluster[0], gs_SpotLightCount, gs_SpotLightStartOffset );
+        RWSpotLightGrid_Cluster[gs_ClusterIndex1D] = uint2( gs_SpotLightStartOffset, gs_SpotLightCount );
+#endif
+    }
+
+#if !defined(COUNT_LIGHTS) && !defined(FILL_LIGHTS)
+    GroupMemoryBarrierWithGroupSync();
+
+    // Now update the global light index lists with the group shared light lists.
+    for ( i = groupIndex; i < gs_PointLightCount; i += NUM_THREADS )
+    {
+        RWPointLightIndexList_Cluster[gs_PointLightStartOffset + i] = gs_PointLightList[i];
+    }
+
+    for ( i = groupIndex; i < gs_SpotLightCount; i += NUM_THREADS )
+    {
+        RWSpotLightIndexList_Cluster[gs_SpotLightStartOffset + i] = gs_SpotLightList[i];
+    }
+#endif
+}
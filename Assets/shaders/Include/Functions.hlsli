@@ -2,6 +2,70 @@
 #error Do not include this header directly. Only include this file via CommonInclude.hlsli.
 #endif
 
+// Decode an octahedral encoded unit vector.
+// Source: A Survey of Efficient Representations for Independent Unit Vectors (2014),
+// Cigolle, Donow, Evangelakos, Mara, McGuire and Meyer.
+float3 DecodeOctahedral( float2 e )
+{
+    float3 v = float3( e.xy, 1.0f - abs( e.x ) - abs( e.y ) );
+    float t = saturate( -v.z );
+    v.xy += v.xy >= 0.0f ? -t : t;
+    return normalize( v );
+}
+
+// Unpack two SNORM16 values.
+float2 UnpackSnorm16x2( uint packed )
+{
+    // Sign extend the low and high 16 bits.
+    int2 v = asint( uint2( packed << 16, packed ) ) >> 16;
+    return max( v / 32767.0f, -1.0f );
+}
+
+// Decode the vertex attributes. For compact vertices, the position is relative to
+// the bounds of the mesh (the model matrix includes the position transform of the mesh).
+VertexAttributes DecodeVertex( AppData IN )
+{
+    VertexAttributes OUT;
+
+#if COMPACT_VERTICES
+    float4 position = float4( IN.Position & 0xffff, IN.Position >> 16 ).xzyw / 65535.0f;
+    float bitangentSign = position.w * 2.0f - 1.0f;
+
+    OUT.Position = position.xyz;
+    OUT.Normal = DecodeOctahedral( UnpackSnorm16x2( IN.Normal ) );
+    OUT.Tangent = DecodeOctahedral( UnpackSnorm16x2( IN.Tangent ) );
+    OUT.Bitangent = cross( OUT.Normal, OUT.Tangent ) * bitangentSign;
+    OUT.TexCoord = float3( f16tof32( IN.TexCoord & 0xffff ), f16tof32( IN.TexCoord >> 16 ), 0.0f );
+#else
+    OUT.Position = IN.Position;
+    OUT.Normal = IN.Normal;
+    OUT.Tangent = IN.Tangent;
+    OUT.Bitangent = IN.Bitangent;
+    OUT.TexCoord = IN.TexCoord;
+#endif
+
+    return OUT;
+}
+
+// Transform the vertex attributes of an instance of a mesh to view space and clip space.
+VertexShaderOutput TransformVertex( VertexAttributes vertex, uint instanceID )
+{
+    InstanceData instance = Instances[instanceID];
+    float3x3 normalMatrix = mul( (float3x3)PerObjectDataCB.View, (float3x3)instance.InverseTransposeModel );
+
+    VertexShaderOutput OUT;
+
+    OUT.PositionVS = mul( PerObjectDataCB.View, mul( instance.Model, float4( vertex.Position, 1.0f ) ) );
+    OUT.Position = mul( PerObjectDataCB.Projection, OUT.PositionVS );
+    OUT.NormalVS = mul( normalMatrix, vertex.Normal );
+    OUT.TangentVS = mul( normalMatrix, vertex.Tangent );
+    OUT.BitangentVS = mul( normalMatrix, vertex.Bitangent );
+    OUT.TexCoord = vertex.TexCoord;
+    OUT.InstanceID = instanceID;
+
+    return OUT;
+}
+
 float3 ExpandNormal( float3 n )
 {
     return n * 2.0f - 1.0f;
@@ -9,8 +73,10 @@ float3 ExpandNormal( float3 n )
 
 float4 DoNormalMapping( float3x3 TBN, Texture2D tex, sampler s, float2 uv )
 {
-    float3 normal = tex.Sample( s, uv ).xyz;
-    normal = ExpandNormal( normal );
+    // The Z component of the normal is reconstructed from the X and Y components
+    // because block compressed normal maps (BC5) only store two components.
+    float2 xy = ExpandNormal( float3( tex.Sample( s, uv ).xy, 0 ) ).xy;
+    float3 normal = float3( xy, sqrt( saturate( 1.0f - dot( xy, xy ) ) ) );
 
     // Transform normal from tangent space to view space.
     normal = mul( normal, TBN );
@@ -315,6 +381,16 @@ uint3 ComputeClusterIndex3D( float2 screenPos, float viewZ )
     return uint3( i, j, k );
 }
 
+/**
+ * Compute the index of the Z-bin for a (positive) view space depth value.
+ * Depth values outside of the near and far clipping planes are clamped to
+ * the first or last Z-bin.
+ */
+uint ComputeZBin( float depth )
+{
+    return min( (uint)max( ( depth - ZBinCB.ZNear ) * ZBinCB.InvBinDepth, 0.0f ), ZBinCB.NumZBins - 1 );
+}
+
 /**
  * Find the intersection of a line segment with a plane.
  * This function will return true if an intersection point
@@ -336,4 +412,28 @@ bool IntersectLinePlane( float3 a, float3 b, Plane p, out float3 q )
     }
 
     return intersect;
+}
+
+/**
+ * Compare two Morton codes.
+ */
+bool MortonCodeLess( MortonCodeType a, MortonCodeType b )
+{
+#if MORTON_CODE_64
+    return a.y < b.y || ( a.y == b.y && a.x < b.x );
+#else
+    return a < b;
+#endif
+}
+
+/**
+ * Get a single bit of a Morton code.
+ */
+uint MortonCodeBit( MortonCodeType mortonCode, uint bit )
+{
+#if MORTON_CODE_64
+    return ( ( bit < 32 ) ? ( mortonCode.x >> bit ) : ( mortonCode.y >> ( bit - 32 ) ) ) & 1;
+#else
+    return ( mortonCode >> bit ) & 1;
+#endif
 }
\ No newline at end of file
@@ -23,6 +23,7 @@
 //    StructuredBuffer<PointLight> PointLights : register( t8 );
 //    StructuredBuffer<SpotLight> SpotLights : register( t9 );
 //    StructuredBuffer<DirectionalLight> DirectionalLights : register( t10 );
+// 4. StructuredBuffer<InstanceData> Instances : register( t43 )
 // Samplers:
 //    SamplerState LinearRepeatSampler     : register( s0 );
 //    SamplerState LinearClampSampler      : register( s1 );
@@ -33,6 +34,7 @@
     "CBV(b1, visibility = SHADER_VISIBILITY_PIXEL)," \
     "RootConstants(num32BitConstants=3, b2, visibility = SHADER_VISIBILITY_PIXEL)," \
     "DescriptorTable(SRV(t0, numDescriptors=11), visibility=SHADER_VISIBILITY_PIXEL)," \
+    "SRV(t43, visibility = SHADER_VISIBILITY_VERTEX)," \
     "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, visibility=SHADER_VISIBILITY_PIXEL)," \
     "StaticSampler(s1, filter=FILTER_MIN_MAG_MIP_LINEAR," \
                       "addressU=TEXTURE_ADDRESS_CLAMP," \
@@ -78,6 +80,7 @@
 //    StructuredBuffer<PointLight> PointLights : register( t8 );
 //    StructuredBuffer<SpotLight> SpotLights : register( t9 );
 //    StructuredBuffer<DirectionalLight> DirectionalLights : register( t10 );
+// 4. StructuredBuffer<InstanceData> Instances : register( t43 )
 // Samplers: 
 //    SamplerState LinearRepeatSampler     : register( s0 );
 //    SamplerState LinearClampSampler      : register( s1 );
@@ -88,6 +91,7 @@
     "CBV(b1, visibility = SHADER_VISIBILITY_PIXEL)," \
     "RootConstants(num32BitConstants=3, b2, visibility = SHADER_VISIBILITY_PIXEL)," \
     "DescriptorTable(SRV(t0, numDescriptors=11), visibility=SHADER_VISIBILITY_PIXEL)," \
+    "SRV(t43, visibility = SHADER_VISIBILITY_VERTEX)," \
     "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, visibility=SHADER_VISIBILITY_PIXEL)," \
     "StaticSampler(s1, filter=FILTER_MIN_MAG_MIP_LINEAR," \
                       "addressU=TEXTURE_ADDRESS_CLAMP," \
@@ -117,6 +121,7 @@
 //    StructuredBuffer<uint> SpotLightIndexList : register( t12 );
 //    Texture2D<uint2> PointLightGrid : register( t13 );
 //    Texture2D<uint2> SpotLightGrid : register( t14 );
+// 4. StructuredBuffer<InstanceData> Instances : register( t43 )
 // Samplers
 //    SamplerState LinearRepeatSampler     : register( s0 );
 //    SamplerState LinearClampSampler      : register( s1 );
@@ -127,6 +132,7 @@
     "CBV(b1, visibility = SHADER_VISIBILITY_PIXEL)," \
     "RootConstants(num32BitConstants=3, b2, visibility = SHADER_VISIBILITY_PIXEL)," \
     "DescriptorTable(SRV(t0, numDescriptors=15), visibility=SHADER_VISIBILITY_PIXEL)," \
+    "SRV(t43, visibility = SHADER_VISIBILITY_VERTEX)," \
     "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, visibility=SHADER_VISIBILITY_PIXEL)," \
     "StaticSampler(s1, filter=FILTER_MIN_MAG_MIP_LINEAR," \
                       "addressU=TEXTURE_ADDRESS_CLAMP," \
@@ -157,7 +163,8 @@
 //    StructuredBuffer<uint> SpotLightIndexList_Cluster : register( t22 );
 //    StructuredBuffer<uint2> PointLightGrid_Cluster : register( t23 );
 //    StructuredBuffer<uint2> SpotLightGrid_Cluster : register( t24 );
-// 4. cbuffer _ClusterDataCB : register( b5 )
+// 4. StructuredBuffer<InstanceData> Instances : register( t43 )
+// 5. cbuffer _ClusterDataCB : register( b5 )
 // Samplers
 //    SamplerState LinearRepeatSampler     : register( s0 );
 //    SamplerState LinearClampSampler      : register( s1 );
@@ -168,6 +175,7 @@
     "CBV(b1, visibility = SHADER_VISIBILITY_PIXEL)," \
     "RootConstants(num32BitConstants=3, b2, visibility = SHADER_VISIBILITY_PIXEL)," \
     "DescriptorTable(SRV(t0, numDescriptors=11), SRV(t21, numDescriptors=4), visibility=SHADER_VISIBILITY_PIXEL)," \
+    "SRV(t43, visibility = SHADER_VISIBILITY_VERTEX)," \
     "RootConstants(num32BitConstants=8, b5, visibility = SHADER_VISIBILITY_PIXEL)," \
     "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, visibility=SHADER_VISIBILITY_PIXEL)," \
     "StaticSampler(s1, filter=FILTER_MIN_MAG_MIP_LINEAR," \
@@ -178,18 +186,68 @@
                       "maxAnisotropy = 16," \
                       "visibility = SHADER_VISIBILITY_PIXEL)"
 
+// Z-binned Shading
+// 0. cbuffer _PerObjectCB : register( b0 )
+// 1. cbuffer _MaterialCB : register( b1 )
+// 2. cbuffer _LightCountsCB : register( b2 )
+// 3. Texture2D AmbientTexture        : register( t0 );
+//    Texture2D EmissiveTexture       : register( t1 );
+//    Texture2D DiffuseTexture        : register( t2 );
+//    Texture2D SpecularTexture       : register( t3 );
+//    Texture2D SpecularPowerTexture  : register( t4 );
+//    Texture2D NormalTexture         : register( t5 );
+//    Texture2D BumpTexture           : register( t6 );
+//    Texture2D OpacityTexture        : register( t7 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<PointLight> PointLights : register( t8 );
+//    StructuredBuffer<SpotLight> SpotLights : register( t9 );
+//    StructuredBuffer<DirectionalLight> DirectionalLights : register( t10 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<uint> PointLightIndices : register( t29 );
+//    StructuredBuffer<uint> SpotLightIndices : register( t30 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<uint2> PointLightZBins : register( t33 );
+//    StructuredBuffer<uint2> SpotLightZBins : register( t34 );
+//    StructuredBuffer<uint> PointLightTileMasks : register( t35 );
+//    StructuredBuffer<uint> SpotLightTileMasks : register( t36 );
+// 4. StructuredBuffer<InstanceData> Instances : register( t43 )
+// 5. cbuffer _ZBinParamsCB : register( b10 )
+// Samplers
+//    SamplerState LinearRepeatSampler     : register( s0 );
+//    SamplerState LinearClampSampler      : register( s1 );
+//    SamplerState AnisotropicSampler      : register( s2 );
+#define ZBinnedVS_RS \
+    "RootFlags(ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT)," \
+    "CBV(b0, visibility = SHADER_VISIBILITY_VERTEX)," \
+    "CBV(b1, visibility = SHADER_VISIBILITY_PIXEL)," \
+    "RootConstants(num32BitConstants=3, b2, visibility = SHADER_VISIBILITY_PIXEL)," \
+    "DescriptorTable(SRV(t0, numDescriptors=11), SRV(t29, numDescriptors=2), SRV(t33, numDescriptors=4), visibility=SHADER_VISIBILITY_PIXEL)," \
+    "SRV(t43, visibility = SHADER_VISIBILITY_VERTEX)," \
+    "RootConstants(num32BitConstants=8, b10, visibility = SHADER_VISIBILITY_PIXEL)," \
+    "StaticSampler(s0, filter=FILTER_MIN_MAG_MIP_LINEAR, visibility=SHADER_VISIBILITY_PIXEL)," \
+    "StaticSampler(s1, filter=FILTER_MIN_MAG_MIP_LINEAR," \
+                      "addressU=TEXTURE_ADDRESS_CLAMP," \
+                      "addressV=TEXTURE_ADDRESS_CLAMP," \
+                      "visibility = SHADER_VISIBILITY_PIXEL)," \
+    "StaticSampler(s2, filter = FILTER_ANISOTROPIC," \
+                      "maxAnisotropy = 16," \
+                      "visibility = SHADER_VISIBILITY_PIXEL)"
+
+
 
 // Cluster Samples
 // 0. cbuffer _PerObjectCB : register( b0 )
 // 1. cbuffer _ClusterDataCB : register( b5 )
 // 2. Material textures t0-t7, RWStructuredBuffer<bool> RWClusterFlags : register( u4 );
 // 3. StructuredBuffer<float4> ClusterColors
+// 4. StructuredBuffer<InstanceData> Instances : register( t43 )
 #define ClusterSamples_RS \
     "RootFlags(ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT)," \
     "CBV(b0, visibility = SHADER_VISIBILITY_VERTEX)," \
     "RootConstants(num32BitConstants=8, b5, visibility = SHADER_VISIBILITY_PIXEL)," \
     "DescriptorTable(SRV(t0, numDescriptors=8),UAV(u4), visibility=SHADER_VISIBILITY_PIXEL)," \
-    "DescriptorTable(SRV(t15), visibility=SHADER_VISIBILITY_PIXEL )"
+    "DescriptorTable(SRV(t15), visibility=SHADER_VISIBILITY_PIXEL )," \
+    "SRV(t43, visibility = SHADER_VISIBILITY_VERTEX)"
 
 // Compute Cluster AABBs
 // 0. cbuffer CameraParamsCB : register( b3 )
@@ -304,6 +362,19 @@
     "RootConstants(num32BitConstants=3,b2)," \
     "DescriptorTable( SRV( t8, numDescriptors=2), SRV( t16, numDescriptors=2 ), SRV( t29, numDescriptors=4 ), UAV( u19, numDescriptors=6 ) )"
 
+// Prefix Sum Light Grid
+// 0. cbuffer _ClusterDataCB : register( b5 )
+// 1. RWStructuredBuffer<uint> RWPointLightIndexCounter_Cluster : register( u19 );
+//    RWStructuredBuffer<uint> RWSpotLightIndexCounter_Cluster : register( u20 );
+//    RWStructuredBuffer<uint2> RWPointLightGrid_Cluster : register( u21 );
+//    RWStructuredBuffer<uint2> RWSpotLightGrid_Cluster : register( u22 );
+//------------------------------------------------------------------------------
+//    RWStructuredBuffer<uint2> RWLightGridGroupSums : register( u36 );
+#define PrefixSumLightGrid_RS \
+    "RootFlags(0)," \
+    "RootConstants(num32BitConstants=8,b5)," \
+    "DescriptorTable( UAV( u19, numDescriptors=4 ), UAV( u36, numDescriptors=1 ) )"
+
 // Debug Lights
 // 0. cbuffer _PerObjectCB : register( b0 )
 // 1. cbuffer _MaterialCB : register( b1 )
@@ -351,6 +422,22 @@
     "RootConstants(num32BitConstants=3,b2)," \
     "DescriptorTable( SRV(t8, numDescriptors=2), SRV(t25), UAV(u26, numDescriptors=4) )"
 
+// Compute depth sort keys for Z-binning.
+// 0. cbuffer _LightCountsCB : register( b2 )
+// 1. cbuffer _ZBinParamsCB : register( b10 )
+// 2. StructuredBuffer<PointLight> PointLights : register( t8 );
+//    StructuredBuffer<SpotLight> SpotLights : register( t9 );
+//------------------------------------------------------------------------------
+//    RWStructuredBuffer<uint> RWPointLightMortonCodes : register( u26 );
+//    RWStructuredBuffer<uint> RWSpotLightMortonCodes : register( u27 );
+//    RWStructuredBuffer<uint> RWPointLightIndices : register( u28 );
+//    RWStructuredBuffer<uint> RWSpotLightIndices : register( u29 )
+#define ComputeLightDepthKeys_RS \
+    "RootFlags(0)," \
+    "RootConstants(num32BitConstants=3, b2)," \
+    "RootConstants(num32BitConstants=8, b10)," \
+    "DescriptorTable( SRV(t8, numDescriptors=2), UAV(u26, numDescriptors=4) )"
+
 // Radix sort
 // 0. cbuffer _SortParamsCB : register( b8 )
 // 1. StructuredBuffer<uint> InputKeys : register( t26 );
@@ -395,6 +482,66 @@
     "RootConstants(num32BitConstants=3, b2)," \
     "DescriptorTable( SRV(t8, numDescriptors=2), SRV(t29, numDescriptors=2), UAV(u33, numDescriptors=2) )"
 
+// Build Z-bins and tile light bitmasks.
+// 0. cbuffer _ZBinParamsCB : register( b10 )
+// 1. cbuffer _LightCountsCB : register( b2 )
+// 2. StructuredBuffer<PointLight> PointLights : register( t8 );
+//    StructuredBuffer<SpotLight> SpotLights : register( t9 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<Frustum> Frustums : register( t19 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<uint> PointLightIndices : register( t29 );
+//    StructuredBuffer<uint> SpotLightIndices : register( t30 );
+//------------------------------------------------------------------------------
+//    RWStructuredBuffer<uint2> RWPointLightZBins : register( u37 );
+//    RWStructuredBuffer<uint2> RWSpotLightZBins : register( u38 );
+//    RWStructuredBuffer<uint> RWPointLightTileMasks : register( u39 );
+//    RWStructuredBuffer<uint> RWSpotLightTileMasks : register( u40 );
+#define ZBinning_RS \
+    "RootFlags(0)," \
+    "RootConstants(num32BitConstants=8, b10)," \
+    "RootConstants(num32BitConstants=3, b2)," \
+    "DescriptorTable( SRV(t8, numDescriptors=2), SRV(t19), SRV(t29, numDescriptors=2), UAV(u37, numDescriptors=4) )"
+
+// Find lights that moved since the previous frame.
+// 0. cbuffer _LightCountsCB : register( b2 )
+// 1. StructuredBuffer<PointLight> PointLights : register( t8 );
+//    StructuredBuffer<SpotLight> SpotLights : register( t9 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<PointLight> PreviousPointLights : register( t37 );
+//    StructuredBuffer<SpotLight> PreviousSpotLights : register( t38 );
+//------------------------------------------------------------------------------
+//    RWStructuredBuffer<uint> RWMovedLightCounter : register( u41 );
+//    RWStructuredBuffer<float4> RWMovedLightSpheres : register( u42 );
+#define FindMovedLights_RS \
+    "RootFlags(0)," \
+    "RootConstants(num32BitConstants=3, b2)," \
+    "DescriptorTable( SRV(t8, numDescriptors=2), SRV(t37, numDescriptors=2), UAV(u41, numDescriptors=2) )"
+
+// Limit the number of moved lights.
+// 0. cbuffer _LightCountsCB : register( b2 )
+// 1. RWStructuredBuffer<uint> RWPointLightIndexCounter_Cluster : register( u19 );
+//    RWStructuredBuffer<uint> RWSpotLightIndexCounter_Cluster : register( u20 );
+//------------------------------------------------------------------------------
+//    RWStructuredBuffer<uint> RWMovedLightCounter : register( u41 );
+#define LimitMovedLights_RS \
+    "RootFlags(0)," \
+    "RootConstants(num32BitConstants=3, b2)," \
+    "DescriptorTable( UAV(u19, numDescriptors=2), UAV(u41) )"
+
+// Find clusters whose light lists need to be updated.
+// 0. StructuredBuffer<AABB> ClusterAABBs : register( t17 );
+//------------------------------------------------------------------------------
+//    StructuredBuffer<bool> ClusterFlags : register( t39 );
+//    StructuredBuffer<bool> PreviousClusterFlags : register( t40 );
+//    StructuredBuffer<float4> MovedLightSpheres : register( t41 );
+//    StructuredBuffer<uint> MovedLightCounter : register( t42 );
+//------------------------------------------------------------------------------
+//    RWStructuredBuffer<uint> RWDirtyClusters : register( u43 );
+#define FindDirtyClusters_RS \
+    "RootFlags(0)," \
+    "DescriptorTable( SRV(t17), SRV(t39, numDescriptors=4), UAV(u43) )"
+
 
 // Count lights for clustered rendering.
 // 0. cbuffer CameraParamsCB : register( b3 )
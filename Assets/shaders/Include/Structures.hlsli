@@ -4,6 +4,20 @@
 
 // The vertex layout expected to be passed from the application to the 
 // vertex shader.
+#if COMPACT_VERTICES
+// Compressed vertex layout (Graphics::Mesh::CompactVertex).
+// The attributes are declared as integers so that the input layout that is
+// created from the shader reflection matches the packed vertex layout.
+// Use DecodeVertex to decode the vertex attributes.
+struct AppData
+{
+    uint2  Position     : POSITION;     // 4 x UNORM16 (xyz: position relative to the mesh bounds, w: bitangent sign).
+    uint   Normal       : NORMAL;       // 2 x SNORM16 octahedral encoded normal.
+    uint   Tangent      : TANGENT;      // 2 x SNORM16 octahedral encoded tangent.
+    uint   TexCoord     : TEXCOORD0;    // 2 x FP16 texture coordinate.
+    uint   InstanceID   : SV_InstanceID;
+};
+#else
 struct AppData
 {
     float3 Position     : POSITION;
@@ -13,6 +27,17 @@ struct AppData
     float3 TexCoord     : TEXCOORD0;
     uint   InstanceID   : SV_InstanceID;
 };
+#endif
+
+// The (decoded) vertex attributes of the application data.
+struct VertexAttributes
+{
+    float3 Position;
+    float3 Normal;
+    float3 Tangent;
+    float3 Bitangent;
+    float3 TexCoord;
+};
 
 // Ouput from the vertex shader.
 struct VertexShaderOutput
@@ -157,6 +182,13 @@ struct PerObjectData
     float4x4 InverseTransposeModelView;
 };
 
+// The world transforms of an instance of a mesh.
+struct InstanceData
+{
+    float4x4 Model;                 // Includes the position transform of the mesh.
+    float4x4 InverseTransposeModel;
+};
+
 struct ClusterData
 {
     uint3 GridDim;      // The 3D dimensions of the cluster grid.
@@ -194,6 +226,18 @@ struct BVHParams
     uint ChildLevel;    // The level of the child nodes in the BVH that is being computed.
 };
 
+struct ZBinParams
+{
+    float ZNear;                // The view space depth of the first Z-bin (the near clipping plane).
+    float InvBinDepth;          // 1.0f / ( view space depth of a single Z-bin ).
+    uint  NumZBins;             // The number of Z-bins between the near and far clipping planes.
+    uint  TileSize;             // The size of a screen tile (in pixels).
+    uint  NumTilesX;            // The number of screen tiles in the X direction.
+    uint  NumTiles;             // The total number of screen tiles.
+    uint  NumPointLightWords;   // The number of 32-bit words in the point light bitmask of a single tile.
+    uint  NumSpotLightWords;    // The number of 32-bit words in the spot light bitmask of a single tile.
+};
+
 struct LightCounts
 {
     uint NumPointLights;
@@ -228,6 +272,22 @@ struct AABB
     float4 Max;
 };
 
+/**
+ * Morton codes that are used to sort the lights for building the light BVH.
+ * By default, 30-bit Morton codes (10 bits per axis) are used. If MORTON_CODE_64
+ * is defined, 63-bit Morton codes (21 bits per axis) are used. 63-bit Morton
+ * codes are stored in a uint2 with the low 32 bits in x and the high bits in y.
+ */
+#if MORTON_CODE_64
+typedef uint2 MortonCodeType;
+#define MORTON_CODE_BITS 21
+#define MORTON_CODE_MAX uint2( 0xffffffff, 0xffffffff )
+#else
+typedef uint MortonCodeType;
+#define MORTON_CODE_BITS 10
+#define MORTON_CODE_MAX 0xffffffff
+#endif
+
 // Four planes of a view frustum (in view space).
 // The planes are:
 //  * Left,
@@ -22,7 +22,7 @@
 
 #define INT_MAX 0xffffffff
 
-groupshared uint gs_Keys[NUM_VALUES_PER_THREAD_GROUP];      // Intermediate keys.               (8,192 Bytes)
+groupshared MortonCodeType gs_Keys[NUM_VALUES_PER_THREAD_GROUP];    // Intermediate keys.       (8,192 Bytes, 16,384 Bytes with MORTON_CODE_64)
 groupshared uint gs_Values[NUM_VALUES_PER_THREAD_GROUP];    // Intermediate values.             (8,192 Bytes)
 
 /**
@@ -48,9 +48,9 @@ int MergePath( int a0, int aCount, int b0, int bCount, int diag, bool bUseShared
     {
         // Find the mid-point to start searching from.
         int mid = ( begin + end ) >> 1;
-        uint a = bUseSharedMem ? gs_Keys[a0 + mid] : InputKeys[a0 + mid];
-        uint b = bUseSharedMem ? gs_Keys[b0 + diag - 1 - mid] : InputKeys[b0 + diag - 1 - mid];
-        if ( a < b )
+        MortonCodeType a = bUseSharedMem ? gs_Keys[a0 + mid] : InputKeys[a0 + mid];
+        MortonCodeType b = bUseSharedMem ? gs_Keys[b0 + diag - 1 - mid] : InputKeys[b0 + diag - 1 - mid];
+        if ( MortonCodeLess( a, b ) )
         {
             begin = mid + 1;
         }
@@ -122,7 +122,8 @@ void MergePathPartitions_CS( ComputeShaderInput IN )
  */
 void SerialMerge( int a0, int a1, int b0, int b1, int diag, uint numValues, uint out0 )
 {
-    uint i, aKey, bKey, aValue, bValue;
+    uint i, aValue, bValue;
+    MortonCodeType aKey, bKey;
 
     aKey = gs_Keys[a0];
     bKey = gs_Keys[b0];
@@ -133,7 +134,7 @@ void SerialMerge( int a0, int a1, int b0, int b1, int diag, uint numValues, uint
     [unroll]
     for ( i = 0; i < NUM_VALUES_PER_THREAD && diag + i < numValues; ++i )
     {
-        if ( b0 >= b1 || ( a0 < a1 && aKey < bKey ) )
+        if ( b0 >= b1 || ( a0 < a1 && MortonCodeLess( aKey, bKey ) ) )
         {
             OutputKeys[out0 + diag + i] = aKey;
             OutputValues[out0 + diag + i] = aValue;
@@ -160,7 +161,8 @@ void SerialMerge( int a0, int a1, int b0, int b1, int diag, uint numValues, uint
 [numthreads(NUM_THREADS, 1, 1)]
 void MergeSort( ComputeShaderInput IN )
 {
-    uint i, key, value;
+    uint i, value;
+    MortonCodeType key;
 
     uint chunkSize = SortParamsCB.ChunkSize;
     // Number of chunks to sort.
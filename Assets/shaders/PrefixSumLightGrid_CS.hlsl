@@ -0,0 +1,189 @@
+#include "Include/CommonInclude.hlsli"
+
+/**
+ * Compute the offsets of the clusters in the light index lists from the
+ * number of lights per cluster that were written to the light grid by the
+ * COUNT_LIGHTS pass of the light assignment compute shaders.
+ *
+ * The light grid is scanned in three passes:
+ * 1. ScanGroups: Exclusive scan of the light counts within each thread group.
+ * 2. ScanGroupSums: Exclusive scan of the sums of all thread groups (a single thread group).
+ * 3. AddGroupOffsets: Add the scanned group sums to the offsets in the light grid.
+ *
+ * Point and spot lights are scanned at the same time (in the x and y component of
+ * the group shared counts). After the scan, the light index counters contain the
+ * total number of light indices that are required to store the light index lists.
+ * Source: GPU Gems 3, Chapter 39. Parallel Prefix Sum (Scan) with CUDA (2007), Mark Harris, Shubhabrata Sengupta, John D. Owens.
+ */
+
+#define NUM_THREADS 1024
+#define NUM_ELEMENTS ( NUM_THREADS * 2 )   // Each thread scans 2 elements.
+
+groupshared uint2 gs_Counts[NUM_ELEMENTS];  // 16,384 Bytes
+
+// Work-efficient (Blelloch) exclusive scan of the values in gs_Counts.
+// Returns the sum of all values.
+uint2 ExclusiveScan( uint groupIndex )
+{
+    uint offset = 1;
+    uint d;
+
+    // Up-sweep (reduce) phase.
+    [unroll]
+    for ( d = NUM_ELEMENTS >> 1; d > 0; d >>= 1 )
+    {
+        GroupMemoryBarrierWithGroupSync();
+
+        if ( groupIndex < d )
+        {
+            uint ai = offset * ( 2 * groupIndex + 1 ) - 1;
+            uint bi = offset * ( 2 * groupIndex + 2 ) - 1;
+
+            gs_Counts[bi] += gs_Counts[ai];
+        }
+
+        offset <<= 1;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    uint2 total = gs_Counts[NUM_ELEMENTS - 1];
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if ( groupIndex == 0 )
+    {
+        gs_Counts[NUM_ELEMENTS - 1] = uint2( 0, 0 );
+    }
+
+    // Down-sweep phase.
+    [unroll]
+    for ( d = 1; d < NUM_ELEMENTS; d <<= 1 )
+    {
+        offset >>= 1;
+
+        GroupMemoryBarrierWithGroupSync();
+
+        if ( groupIndex < d )
+        {
+            uint ai = offset * ( 2 * groupIndex + 1 ) - 1;
+            uint bi = offset * ( 2 * groupIndex + 2 ) - 1;
+
+            uint2 t = gs_Counts[ai];
+            gs_Counts[ai] = gs_Counts[bi];
+            gs_Counts[bi] += t;
+        }
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    return total;
+}
+
+uint GetNumClusters()
+{
+    return ClusterCB.GridDim.x * ClusterCB.GridDim.y * ClusterCB.GridDim.z;
+}
+
+uint2 LoadLightCounts( uint clusterIndex, uint numClusters )
+{
+    uint2 counts = uint2( 0, 0 );
+
+    if ( clusterIndex < numClusters )
+    {
+        counts = uint2( RWPointLightGrid_Cluster[clusterIndex].y, RWSpotLightGrid_Cluster[clusterIndex].y );
+    }
+
+    return counts;
+}
+
+void StoreLightOffsets( uint clusterIndex, uint numClusters, uint2 offsets )
+{
+    if ( clusterIndex < numClusters )
+    {
+        RWPointLightGrid_Cluster[clusterIndex].x = offsets.x;
+        RWSpotLightGrid_Cluster[clusterIndex].x = offsets.y;
+    }
+}
+
+[RootSignature( PrefixSumLightGrid_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void ScanGroups( ComputeShaderInput IN )
+{
+    uint numClusters = GetNumClusters();
+    uint i0 = IN.GroupID.x * NUM_ELEMENTS + IN.GroupIndex;
+    uint i1 = i0 + NUM_THREADS;
+
+    gs_Counts[IN.GroupIndex] = LoadLightCounts( i0, numClusters );
+    gs_Counts[IN.GroupIndex + NUM_THREADS] = LoadLightCounts( i1, numClusters );
+
+    uint2 total = ExclusiveScan( IN.GroupIndex );
+
+    StoreLightOffsets( i0, numClusters, gs_Counts[IN.GroupIndex] );
+    StoreLightOffsets( i1, numClusters, gs_Counts[IN.GroupIndex + NUM_THREADS] );
+
+    if ( IN.GroupIndex == 0 )
+    {
+        RWLightGridGroupSums[IN.GroupID.x] = total;
+    }
+}
+
+// Must be dispatched with a single thread group.
+[RootSignature( PrefixSumLightGrid_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void ScanGroupSums( ComputeShaderInput IN )
+{
+    uint numGroups = ( GetNumClusters() + NUM_ELEMENTS - 1 ) / NUM_ELEMENTS;
+    uint2 carry = uint2( 0, 0 );
+
+    // Scan the group sums in chunks of NUM_ELEMENTS.
+    for ( uint first = 0; first < numGroups; first += NUM_ELEMENTS )
+    {
+        uint i0 = first + IN.GroupIndex;
+        uint i1 = i0 + NUM_THREADS;
+
+        gs_Counts[IN.GroupIndex] = ( i0 < numGroups ) ? RWLightGridGroupSums[i0] : uint2( 0, 0 );
+        gs_Counts[IN.GroupIndex + NUM_THREADS] = ( i1 < numGroups ) ? RWLightGridGroupSums[i1] : uint2( 0, 0 );
+
+        uint2 total = ExclusiveScan( IN.GroupIndex );
+
+        if ( i0 < numGroups )
+        {
+            RWLightGridGroupSums[i0] = gs_Counts[IN.GroupIndex] + carry;
+        }
+        if ( i1 < numGroups )
+        {
+            RWLightGridGroupSums[i1] = gs_Counts[IN.GroupIndex + NUM_THREADS] + carry;
+        }
+
+        carry += total;
+    }
+
+    // The total number of light indices in the light index lists.
+    if ( IN.GroupIndex == 0 )
+    {
+        RWPointLightIndexCounter_Cluster[0] = carry.x;
+        RWSpotLightIndexCounter_Cluster[0] = carry.y;
+    }
+}
+
+[RootSignature( PrefixSumLightGrid_RS )]
+[numthreads( NUM_THREADS, 1, 1 )]
+void AddGroupOffsets( ComputeShaderInput IN )
+{
+    uint numClusters = GetNumClusters();
+    uint i0 = IN.GroupID.x * NUM_ELEMENTS + IN.GroupIndex;
+    uint i1 = i0 + NUM_THREADS;
+    uint2 groupOffset = RWLightGridGroupSums[IN.GroupID.x];
+
+    if ( i0 < numClusters )
+    {
+        RWPointLightGrid_Cluster[i0].x += groupOffset.x;
+        RWSpotLightGrid_Cluster[i0].x += groupOffset.y;
+    }
+    if ( i1 < numClusters )
+    {
+        RWPointLightGrid_Cluster[i1].x += groupOffset.x;
+        RWSpotLightGrid_Cluster[i1].x += groupOffset.y;
+    }
+}
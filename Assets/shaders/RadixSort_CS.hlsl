@@ -13,7 +13,7 @@
 
 #define INT_MAX 0xffffffff
 
-groupshared uint gs_Keys[NUM_THREADS];      // A temporary buffer to store the input keys.                                          (1,024 Bytes)
+groupshared MortonCodeType gs_Keys[NUM_THREADS];    // A temporary buffer to store the input keys.                                  (1,024 Bytes, 2,048 Bytes with MORTON_CODE_64)
 groupshared uint gs_Values[NUM_THREADS];    // A temporary buffer to store the input values.                                        (1,024 Bytes)
 groupshared uint gs_E[NUM_THREADS];         // Set a 1 for all false sort keys (b == 0) and a 0 for all true sort keys (b == 1)     (1,024 Bytes)
 groupshared uint gs_F[NUM_THREADS];         // Scan the splits. This results in the output index of all false sort keys (b == 0)    (1,024 Bytes)
@@ -25,14 +25,14 @@ groupshared uint gs_TotalFalses;            // The result of e[NUM_THREADS - 1]
 void main( ComputeShaderInput IN )
 {
     // The number of bits to consider sorting.
-    // In this case, the input keys are 30-bit morton codes.
-    const uint NumBits = 30;
+    // In this case, the input keys are 30-bit (or 63-bit) morton codes.
+    const uint NumBits = MORTON_CODE_BITS * 3;
 
     // Loop variables.
     uint b, i;
 
     // Store the input key and values into shared memory.
-    gs_Keys[IN.GroupIndex] = ( IN.DispatchThreadID.x < SortParamsCB.NumElements ) ? InputKeys[IN.DispatchThreadID.x] : INT_MAX;
+    gs_Keys[IN.GroupIndex] = ( IN.DispatchThreadID.x < SortParamsCB.NumElements ) ? InputKeys[IN.DispatchThreadID.x] : MORTON_CODE_MAX;
     gs_Values[IN.GroupIndex] = ( IN.DispatchThreadID.x < SortParamsCB.NumElements ) ? InputValues[IN.DispatchThreadID.x] : INT_MAX;
 
     // Loop over the bits starting at the least-significant bit.
@@ -40,7 +40,7 @@ void main( ComputeShaderInput IN )
     {
         // 1. In a temporary buffer in shared memory, we set a 1 for all false 
         //    sort keys (b = 0) and a 0 for all true sort keys.
-        gs_E[IN.GroupIndex] = ( ( gs_Keys[IN.GroupIndex] >> b ) & 1 ) == 0 ? 1 : 0;
+        gs_E[IN.GroupIndex] = MortonCodeBit( gs_Keys[IN.GroupIndex], b ) == 0 ? 1 : 0;
 
         // Sync group shared memory writes.
         GroupMemoryBarrierWithGroupSync();
@@ -100,7 +100,7 @@ void main( ComputeShaderInput IN )
         // 5. Finally, we scatter the original sort keys to destination address 
         //    d. The scatter pattern is a perfect permutation of the input, so 
         //    we see no write conflicts with this scatter.
-        uint key = gs_Keys[IN.GroupIndex];
+        MortonCodeType key = gs_Keys[IN.GroupIndex];
         uint value = gs_Values[IN.GroupIndex];
 
         // Sync group shared memory reads before writes.
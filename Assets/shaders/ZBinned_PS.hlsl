@@ -0,0 +1,218 @@
+#include "Include/CommonInclude.hlsli"
+
+// Compute the mask of the lights in a word of a tile bitmask that are also
+// in the light index range of a Z-bin.
+uint ZBinWordMask( uint word, uint2 zBinRange )
+{
+    uint firstBit = word * 32;
+    uint mask = 0xffffffff;
+
+    if ( zBinRange.x > firstBit )
+    {
+        mask &= 0xffffffff << ( zBinRange.x - firstBit );
+    }
+    if ( zBinRange.y < firstBit + 31 )
+    {
+        mask &= 0xffffffff >> ( firstBit + 31 - zBinRange.y );
+    }
+
+    return mask;
+}
+
+LightingResult DoLighting( uint tileIndex, uint zBin, Material material, float4 eyePos, float4 P, float4 N )
+{
+    // Counters
+    uint i;
+    uint word, mask;
+    uint lightIndex;
+    uint2 zBinRange;
+
+    float4 V = normalize( eyePos - P );
+
+    LightingResult totalResult = (LightingResult)0;
+
+    // Get the range of (depth sorted) point lights in the Z-bin.
+    zBinRange = PointLightZBins[zBin];
+
+    // Iterate point lights.
+    // If the Z-bin is empty ( zBinRange.x > zBinRange.y ) the loop is skipped.
+    for ( word = zBinRange.x / 32; zBinRange.x <= zBinRange.y && word <= zBinRange.y / 32; ++word )
+    {
+        // Mask out the lights of the tile that are outside of the range of the Z-bin.
+        mask = PointLightTileMasks[tileIndex * ZBinCB.NumPointLightWords + word] & ZBinWordMask( word, zBinRange );
+
+        while ( mask != 0 )
+        {
+            i = firstbitlow( mask );
+            mask &= mask - 1;
+
+            lightIndex = PointLightIndices[word * 32 + i];
+
+            LightingResult result = DoPointLight( PointLights[lightIndex], material, V, P, N );
+
+            totalResult.Diffuse += result.Diffuse;
+            totalResult.Specular += result.Specular;
+        }
+    }
+
+    // Get the range of (depth sorted) spot lights in the Z-bin.
+    zBinRange = SpotLightZBins[zBin];
+
+    // Iterate spot lights.
+    for ( word = zBinRange.x / 32; zBinRange.x <= zBinRange.y && word <= zBinRange.y / 32; ++word )
+    {
+        mask = SpotLightTileMasks[tileIndex * ZBinCB.NumSpotLightWords + word] & ZBinWordMask( word, zBinRange );
+
+        while ( mask != 0 )
+        {
+            i = firstbitlow( mask );
+            mask &= mask - 1;
+
+            lightIndex = SpotLightIndices[word * 32 + i];
+
+            LightingResult result = DoSpotLight( SpotLights[lightIndex], material, V, P, N );
+
+            totalResult.Diffuse += result.Diffuse;
+            totalResult.Specular += result.Specular;
+        }
+    }
+
+    // Iterate directional lights.
+    for ( i = 0; i < LightCountsCB.NumDirectionalLights; ++i )
+    {
+        if ( !DirectionalLights[i].Enabled ) continue;
+
+        LightingResult result = DoDirectionalLight( DirectionalLights[i], material, V, P, N );
+
+        totalResult.Diffuse += result.Diffuse;
+        totalResult.Specular += result.Specular;
+    }
+
+    return totalResult;
+}
+
+[earlydepthstencil]
+float4 main( VertexShaderOutput IN ) : SV_Target
+{
+    // Everything is in view space.
+    float4 eyePos = { 0, 0, 0, 1 };
+    Material material = MaterialCB;
+
+    float4 diffuse = material.DiffuseColor;
+    if ( material.HasDiffuseTexture == true )
+    {
+        float4 diffuseTex = DiffuseTexture.Sample( LinearRepeatSampler, IN.TexCoord.xy );
+        if ( any( diffuse.rgb ) )
+        {
+            diffuse *= diffuseTex;
+        }
+        else
+        {
+            diffuse = diffuseTex;
+        }
+    }
+
+    // By default, use the alpha from the diffuse component.
+    float alpha = diffuse.a;
+    if ( material.HasOpacityTexture == true )
+    {
+        // If the material has an opacity texture, use that to override the diffuse alpha.
+        alpha = OpacityTexture.Sample( LinearRepeatSampler, IN.TexCoord.xy ).r;
+    }
+
+    float4 ambient = material.AmbientColor;
+    if ( material.HasAmbientTexture == true )
+    {
+        float4 ambientTex = AmbientTexture.Sample( LinearRepeatSampler, IN.TexCoord.xy );
+        if ( any( ambient.rgb ) )
+        {
+            ambient *= ambientTex;
+        }
+        else
+        {
+            ambient = ambientTex;
+        }
+    }
+
+    // Combine the global ambient term.
+    ambient *= material.GlobalAmbient;
+
+    float4 emissive = material.EmissiveColor;
+    if ( material.HasEmissiveTexture == true )
+    {
+        float4 emissiveTex = EmissiveTexture.Sample( LinearRepeatSampler, IN.TexCoord.xy );
+        if ( any( emissive.rgb ) )
+        {
+            emissive *= emissiveTex;
+        }
+        else
+        {
+            emissive = emissiveTex;
+        }
+    }
+
+    if ( material.HasSpecularPowerTexture == true )
+    {
+        material.SpecularPower = SpecularPowerTexture.Sample( LinearRepeatSampler, IN.TexCoord.xy ).r * material.SpecularScale;
+    }
+
+    float4 N;
+
+    // Normal mapping
+    if ( material.HasNormalTexture == true )
+    {
+        // For scense with normal mapping, I don't have to invert the binormal.
+        float3x3 TBN = float3x3( normalize( IN.TangentVS ),
+                                 normalize( IN.BitangentVS ),
+                                 normalize( IN.NormalVS ) );
+
+        N = DoNormalMapping( TBN, NormalTexture, LinearRepeatSampler, IN.TexCoord.xy );
+    }
+    // Bump mapping
+    else if ( material.HasBumpTexture == true )
+    {
+        // For most scenes using bump mapping, I have to invert the binormal.
+        float3x3 TBN = float3x3( normalize( IN.TangentVS ),
+                                 normalize( -IN.BitangentVS ),
+                                 normalize( IN.NormalVS ) );
+
+        N = DoBumpMapping( TBN, BumpTexture, LinearRepeatSampler, IN.TexCoord.xy, material.BumpIntensity );
+    }
+    // Just use the normal from the model.
+    else
+    {
+        N = normalize( float4( IN.NormalVS, 0 ) );
+    }
+
+    // Get the index of the screen tile of the current pixel.
+    uint2 tileIndex2D = uint2( floor( IN.Position.xy / ZBinCB.TileSize ) );
+    uint tileIndex = tileIndex2D.y * ZBinCB.NumTilesX + tileIndex2D.x;
+    // Get the index of the Z-bin of the current pixel.
+    // View space depth is along the -Z axis.
+    uint zBin = ComputeZBin( -IN.PositionVS.z );
+
+    LightingResult lit = DoLighting( tileIndex, zBin, material, eyePos, IN.PositionVS, N );
+
+    diffuse *= float4( lit.Diffuse, 1.0f );
+
+    float4 specular = 0;
+    if ( material.SpecularPower > 1.0f ) // If specular power is too low, don't use it.
+    {
+        specular = material.SpecularColor;
+        if ( material.HasSpecularTexture == true )
+        {
+            float4 specularTex = SpecularTexture.Sample( LinearRepeatSampler, IN.TexCoord.xy );
+            if ( any( specular.rgb ) )
+            {
+                specular *= specularTex;
+            }
+            else
+            {
+                specular = specularTex;
+            }
+        }
+        specular *= float4( lit.Specular, 1.0f );
+    }
+    
+   return float4( ( ambient + emissive + diffuse + specular ).rgb, alpha * material.Opacity );
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+#include "Include/CommonInclude.hlsli"
+
+[RootSignature( ZBinnedVS_RS )]
+VertexShaderOutput main( AppData IN )
+{
+    VertexAttributes vertex = DecodeVertex( IN );
+
+    return TransformVertex( vertex, IN.InstanceID );
+}
\ No newline at end of file
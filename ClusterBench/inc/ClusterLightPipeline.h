@@ -0,0 +1,130 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file ClusterLightPipeline.h
+ *  @date October 18, 2026
+ *
+ *  @brief The light pipeline of the optimized clustered rendering technique without a
+ *  window.
+ */
+
+#include <ConstantBuffers.h>
+#include <LightBVHBuilder.h>
+
+namespace Graphics
+{
+    class Camera;
+}
+
+/**
+ * The light pipeline of the optimized clustered rendering technique without
+ * any rendering: update lights, reduce the lights AABB, compute Morton codes,
+ * sort the Morton codes, build the light BVH, compute the cluster AABBs and
+ * assign the lights to the clusters. The grid frustums for the Forward+ light
+ * grid are computed as well.
+ *
+ * There is no scene geometry so all of the clusters in the cluster grid are
+ * treated as unique clusters (which is the worst case for light assignment).
+ * The profiling markers use the same names as the markers of the Game so the
+ * profiling data can be compared directly.
+ */
+class ClusterLightPipeline
+{
+public:
+    ClusterLightPipeline( std::shared_ptr<Graphics::Device> device );
+    virtual ~ClusterLightPipeline();
+
+    // Use 63-bit Morton codes (21 bits per axis) instead of 30-bit Morton codes.
+    // The Morton code buffers are recreated if the lights have already been set.
+    void SetUse64BitMortonCodes( bool use64BitMortonCodes );
+    bool GetUse64BitMortonCodes() const;
+
+    // Upload the lights to the GPU and create the buffers that depend on the number of lights.
+    void SetLights( const std::vector<Graphics::PointLight>& pointLights,
+                    const std::vector<Graphics::SpotLight>& spotLights,
+                    const std::vector<Graphics::DirectionalLight>& directionalLights );
+
+    // Create the light grid and cluster grid for a screen resolution and grid block sizes.
+    // The compute shaders are (re)loaded if the light grid block size changes.
+    void SetGrid( const Graphics::Camera& camera, uint32_t screenWidth, uint32_t screenHeight,
+                  uint32_t clusterGridBlockSize, uint32_t lightGridBlockSize );
+
+    // Execute a single frame of the light pipeline and wait for it to finish on the GPU.
+    void Execute( const glm::mat4& modelMatrix, const glm::mat4& viewMatrix );
+
+    const ClusterDataCB& GetClusterData() const;
+    uint32_t GetNumClusters() const;
+
+private:
+    void LoadShaders();
+
+    void UpdateLights( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer, const glm::mat4& modelMatrix, const glm::mat4& viewMatrix );
+    void ComputeGridFrustums( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer );
+    void ComputeClusterAABBs( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer );
+    void AssignLightsToClusters( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer );
+
+    std::shared_ptr<Graphics::Device> m_Device;
+
+    LightCountsCB m_LightCounts;
+    ClusterDataCB m_ClusterData;
+    CameraParamsCB m_CameraParams;
+    DispatchParamsCB m_GridFrustumsDispatchParams;
+
+    // Lights
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLights;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLights;
+    std::shared_ptr<Graphics::StructuredBuffer> m_DirectionalLights;
+
+    // Light BVH (shared with the Game).
+    LightBVHBuilder m_LightBVHBuilder;
+
+    // Light grid
+    std::shared_ptr<Graphics::StructuredBuffer> m_GridFrustums;
+
+    // Cluster grid
+    std::shared_ptr<Graphics::StructuredBuffer> m_ClusterAABBs;
+    std::shared_ptr<Graphics::StructuredBuffer> m_ClusterFlags;
+    std::shared_ptr<Graphics::StructuredBuffer> m_UniqueClusters;
+    std::shared_ptr<Graphics::ByteAddressBuffer> m_AssignLightsToClustersArguments;
+    std::shared_ptr<Graphics::ByteAddressBuffer> m_DebugClustersDrawArguments;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightIndexCounter;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightIndexCounter;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightGrid;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightGrid;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightIndexList;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightIndexList;
+
+    std::shared_ptr<Graphics::IndirectCommandSignature> m_AssignLightsToClustersCommandSignature;
+
+    // Pipeline states
+    std::shared_ptr<Graphics::ComputePipelineState> m_UpdateLightsPSO;
+    std::shared_ptr<Graphics::ComputePipelineState> m_ComputeGridFrustumsPSO;
+    std::shared_ptr<Graphics::ComputePipelineState> m_ComputeClusterAABBsPSO;
+    std::shared_ptr<Graphics::ComputePipelineState> m_FindUniqueClustersPSO;
+    std::shared_ptr<Graphics::ComputePipelineState> m_UpdateIndirectArgumentBuffersPSO;
+    std::shared_ptr<Graphics::ComputePipelineState> m_AssignLightsToClustersBVHPSO;
+
+    uint32_t m_LightGridBlockSize;
+};
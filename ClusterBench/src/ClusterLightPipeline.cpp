@@ -0,0 +1,310 @@
+#include <GamePCH.h>
+#include <EngineIncludes.h>
+
+#include <ClusterLightPipeline.h>
+#include <ClusterGrid.h>
+#include <Graphics/CPU/LightBVHCPU.h>
+
+using namespace Graphics;
+
+ClusterLightPipeline::ClusterLightPipeline( std::shared_ptr<Device> device )
+    : m_Device( device )
+    , m_LightCounts{ 0, 0, 0 }
+    , m_ClusterData{}
+    , m_CameraParams{}
+    , m_GridFrustumsDispatchParams{}
+    , m_LightBVHBuilder( device )
+    , m_LightGridBlockSize( 32 )
+{
+    m_LightBVHBuilder.LoadShaders();
+
+    auto commandQueue = m_Device->GetCopyQueue();
+    auto commandBuffer = commandQueue->GetCopyCommandBuffer();
+
+    m_PointLightIndexCounter = m_Device->CreateStructuredBuffer( commandBuffer, 1, sizeof( uint32_t ) );
+    m_PointLightIndexCounter->SetName( L"Point Light Index Counter (Clustered)" );
+
+    m_SpotLightIndexCounter = m_Device->CreateStructuredBuffer( commandBuffer, 1, sizeof( uint32_t ) );
+    m_SpotLightIndexCounter->SetName( L"Spot Light Index Counter (Clustered)" );
+
+    m_AssignLightsToClustersArguments = m_Device->CreateByteAddressBuffer( commandBuffer, sizeof( DispatchIndirectArgument ) );
+    m_AssignLightsToClustersArguments->SetName( L"Assign Lights to Clusters Indirect Argument Buffer" );
+
+    m_DebugClustersDrawArguments = m_Device->CreateByteAddressBuffer( commandBuffer, sizeof( DrawIndirectArgument ) );
+    m_DebugClustersDrawArguments->SetName( L"Debug Clusters Draw Indirect Argument Buffer" );
+
+    auto fence = commandQueue->Submit( commandBuffer );
+    fence->WaitFor();
+
+    m_AssignLightsToClustersCommandSignature = m_Device->CreateIndirectCommandSignature();
+    m_AssignLightsToClustersCommandSignature->AppendCommandArgument( IndirectArgument( IndirectArgumentType::Dispatch ) );
+}
+
+ClusterLightPipeline::~ClusterLightPipeline()
+{}
+
+void ClusterLightPipeline::LoadShaders()
+{
+    m_UpdateLightsPSO = m_Device->CreateComputePipelineState();
+    m_ComputeGridFrustumsPSO = m_Device->CreateComputePipelineState();
+    m_ComputeClusterAABBsPSO = m_Device->CreateComputePipelineState();
+    m_FindUniqueClustersPSO = m_Device->CreateComputePipelineState();
+    m_UpdateIndirectArgumentBuffersPSO = m_Device->CreateComputePipelineState();
+    m_AssignLightsToClustersBVHPSO = m_Device->CreateComputePipelineState();
+
+    auto updateLightsCS = m_Device->CreateShader();
+    updateLightsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/UpdateLights_CS.hlsl" );
+    m_UpdateLightsPSO->SetShader( updateLightsCS );
+
+    ShaderMacros gridShaderMacros;
+    gridShaderMacros["BLOCK_SIZE"] = std::to_string( m_LightGridBlockSize );
+
+    auto computeGridFrustumsCS = m_Device->CreateShader();
+    computeGridFrustumsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeGridFrustums_CS.hlsl", "main", gridShaderMacros );
+    m_ComputeGridFrustumsPSO->SetShader( computeGridFrustumsCS );
+
+    auto computeClusterAABBsCS = m_Device->CreateShader();
+    computeClusterAABBsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeClusterAABBs_CS.hlsl" );
+    m_ComputeClusterAABBsPSO->SetShader( computeClusterAABBsCS );
+
+    auto findUniqueClustersCS = m_Device->CreateShader();
+    findUniqueClustersCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/FindUniqueClusters_CS.hlsl" );
+    m_FindUniqueClustersPSO->SetShader( findUniqueClustersCS );
+
+    auto updateIndirectArgumentBuffersCS = m_Device->CreateShader();
+    updateIndirectArgumentBuffersCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/UpdateClusterIndirectArgumentBuffers_CS.hlsl" );
+    m_UpdateIndirectArgumentBuffersPSO->SetShader( updateIndirectArgumentBuffersCS );
+
+    auto assignLightsToClustersBVHCS = m_Device->CreateShader();
+    assignLightsToClustersBVHCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClustersBVH_CS.hlsl" );
+    m_AssignLightsToClustersBVHPSO->SetShader( assignLightsToClustersBVHCS );
+}
+
+void ClusterLightPipeline::SetUse64BitMortonCodes( bool use64BitMortonCodes )
+{
+    // The Morton code buffers are recreated if the size of the Morton codes changes.
+    m_LightBVHBuilder.SetUse64BitMortonCodes( use64BitMortonCodes );
+}
+
+bool ClusterLightPipeline::GetUse64BitMortonCodes() const
+{
+    return m_LightBVHBuilder.GetUse64BitMortonCodes();
+}
+
+void ClusterLightPipeline::SetLights( const std::vector<PointLight>& pointLights,
+                                      const std::vector<SpotLight>& spotLights,
+                                      const std::vector<DirectionalLight>& directionalLights )
+{
+    m_LightCounts.NumPointLights = static_cast<uint32_t>( pointLights.size() );
+    m_LightCounts.NumSpotLights = static_cast<uint32_t>( spotLights.size() );
+    m_LightCounts.NumDirectionalLights = static_cast<uint32_t>( directionalLights.size() );
+
+    auto commandQueue = m_Device->GetCopyQueue();
+    auto commandBuffer = commandQueue->GetCopyCommandBuffer();
+
+    m_PointLights = m_Device->CreateStructuredBuffer( commandBuffer, pointLights );
+    m_PointLights->SetName( L"Point Lights Buffer" );
+
+    m_SpotLights = m_Device->CreateStructuredBuffer( commandBuffer, spotLights );
+    m_SpotLights->SetName( L"Spot Lights Buffer" );
+
+    m_DirectionalLights = m_Device->CreateStructuredBuffer( commandBuffer, directionalLights );
+    m_DirectionalLights->SetName( L"Directional Lights Buffer" );
+
+    m_LightBVHBuilder.SetNumLights( commandBuffer, m_LightCounts.NumPointLights, m_LightCounts.NumSpotLights );
+
+    auto fence = commandQueue->Submit( commandBuffer );
+    fence->WaitFor();
+}
+
+void ClusterLightPipeline::SetGrid( const Camera& camera, uint32_t screenWidth, uint32_t screenHeight,
+                                    uint32_t clusterGridBlockSize, uint32_t lightGridBlockSize )
+{
+    screenWidth = std::max( screenWidth, 1u );
+    screenHeight = std::max( screenHeight, 1u );
+
+    // The BLOCK_SIZE of the grid frustums compute shader is a compile time constant.
+    if ( lightGridBlockSize != m_LightGridBlockSize || !m_ComputeGridFrustumsPSO )
+    {
+        m_LightGridBlockSize = lightGridBlockSize;
+        LoadShaders();
+    }
+
+    m_CameraParams.Projection = camera.GetProjectionMatrix();
+    m_CameraParams.InverseProjection = glm::inverse( m_CameraParams.Projection );
+    m_CameraParams.ScreenDimensions = glm::vec2( screenWidth, screenHeight );
+
+    // Light grid (see ComputeGridFrustums in the Game).
+    glm::uvec3 numThreads = glm::ceil( glm::vec3( screenWidth / (float)lightGridBlockSize, screenHeight / (float)lightGridBlockSize, 1 ) );
+    glm::uvec3 numThreadGroups = glm::ceil( glm::vec3( numThreads.x / (float)lightGridBlockSize, numThreads.y / (float)lightGridBlockSize, 1 ) );
+
+    m_GridFrustumsDispatchParams.NumThreadGroups = numThreadGroups;
+    m_GridFrustumsDispatchParams.NumThreads = numThreads;
+
+    m_ClusterData = ComputeClusterData( camera, screenWidth, screenHeight, clusterGridBlockSize );
+
+    uint32_t numClusters = GetNumClusters();
+
+    // The light index lists are not grown at runtime (like the exact light index lists
+    // of the Game) so the light index lists are sized for the average light overlap.
+    uint32_t numLightIndices = GetNumClusterLightIndices( m_ClusterData, false );
+
+    auto commandQueue = m_Device->GetCopyQueue();
+    auto commandBuffer = commandQueue->GetCopyCommandBuffer();
+
+    m_GridFrustums = m_Device->CreateStructuredBuffer( commandBuffer, numThreads.x * numThreads.y * numThreads.z, sizeof( Frustum ) );
+    m_GridFrustums->SetName( L"Grid Frustums" );
+
+    m_ClusterFlags = m_Device->CreateStructuredBuffer( commandBuffer, numClusters, sizeof( uint32_t ) );
+    m_ClusterFlags->SetName( L"Cluster Flags" );
+
+    m_UniqueClusters = m_Device->CreateStructuredBuffer( commandBuffer, numClusters, sizeof( uint32_t ) );
+    m_UniqueClusters->SetName( L"Unique Clusters" );
+    m_UniqueClusters->GetCounterBuffer()->SetName( L"Unique Clusters (Counter)" );
+
+    m_ClusterAABBs = m_Device->CreateStructuredBuffer( commandBuffer, numClusters, sizeof( AABB ) );
+    m_ClusterAABBs->SetName( L"Cluster AABBs" );
+
+    m_PointLightGrid = m_Device->CreateStructuredBuffer( commandBuffer, numClusters, sizeof( glm::uvec2 ) );
+    m_PointLightGrid->SetName( L"Point Light Grid (Clustered)" );
+
+    m_SpotLightGrid = m_Device->CreateStructuredBuffer( commandBuffer, numClusters, sizeof( glm::uvec2 ) );
+    m_SpotLightGrid->SetName( L"Spot Light Grid (Clustered)" );
+
+    m_PointLightIndexList = m_Device->CreateStructuredBuffer( commandBuffer, numLightIndices, sizeof( uint32_t ) );
+    m_PointLightIndexList->SetName( L"Point Light Index List (Clustered)" );
+
+    m_SpotLightIndexList = m_Device->CreateStructuredBuffer( commandBuffer, numLightIndices, sizeof( uint32_t ) );
+    m_SpotLightIndexList->SetName( L"Spot Light Index List (Clustered)" );
+
+    auto fence = commandQueue->Submit( commandBuffer );
+    fence->WaitFor();
+}
+
+void ClusterLightPipeline::Execute( const glm::mat4& modelMatrix, const glm::mat4& viewMatrix )
+{
+    auto commandQueue = m_Device->GetGraphicsQueue();
+    auto commandBuffer = commandQueue->GetComputeCommandBuffer();
+
+    UpdateLights( commandBuffer, modelMatrix, viewMatrix );
+    m_LightBVHBuilder.Build( commandBuffer, m_LightCounts, m_PointLights, m_SpotLights );
+    ComputeGridFrustums( commandBuffer );
+    ComputeClusterAABBs( commandBuffer );
+    AssignLightsToClusters( commandBuffer );
+
+    auto fence = commandQueue->Submit( commandBuffer );
+    fence->WaitFor();
+
+    Profiler::Get().UpdateQueryResults( commandQueue );
+}
+
+const ClusterDataCB& ClusterLightPipeline::GetClusterData() const
+{
+    return m_ClusterData;
+}
+
+uint32_t ClusterLightPipeline::GetNumClusters() const
+{
+    return ::GetNumClusters( m_ClusterData );
+}
+
+void ClusterLightPipeline::UpdateLights( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const glm::mat4& modelMatrix, const glm::mat4& viewMatrix )
+{
+    ScopedProfileMarker updateLightsProfilingMarker( L"Update Lights", commandBuffer );
+
+    commandBuffer->BindComputePipelineState( m_UpdateLightsPSO );
+
+    UpdateLightsCB updateLightsCB;
+    updateLightsCB.ModelMatrix = modelMatrix;
+    updateLightsCB.ViewMatrix = viewMatrix;
+
+    commandBuffer->BindComputeDynamicConstantBuffer( 0, updateLightsCB );
+    commandBuffer->BindCompute32BitConstants( 1, m_LightCounts );
+    commandBuffer->BindComputeShaderArguments( 2, 0, { m_PointLights, m_SpotLights, m_DirectionalLights } );
+
+    uint32_t numGroupsX = glm::max( m_LightCounts.NumPointLights, glm::max( m_LightCounts.NumSpotLights, m_LightCounts.NumDirectionalLights ) );
+    numGroupsX = static_cast<uint32_t>( glm::ceil( numGroupsX / 1024.0f ) );
+
+    commandBuffer->Dispatch( numGroupsX );
+}
+
+void ClusterLightPipeline::ComputeGridFrustums( std::shared_ptr<ComputeCommandBuffer> commandBuffer )
+{
+    ScopedProfileMarker computeGridFrustums( L"Compute Grid Frustums", commandBuffer );
+
+    commandBuffer->BindComputePipelineState( m_ComputeGridFrustumsPSO );
+
+    commandBuffer->BindComputeDynamicConstantBuffer( 0, m_CameraParams );
+    commandBuffer->BindCompute32BitConstants( 1, m_GridFrustumsDispatchParams );
+    commandBuffer->BindComputeShaderArgument( 2, m_GridFrustums );
+
+    commandBuffer->Dispatch( m_GridFrustumsDispatchParams.NumThreadGroups );
+}
+
+void ClusterLightPipeline::ComputeClusterAABBs( std::shared_ptr<ComputeCommandBuffer> commandBuffer )
+{
+    ScopedProfileMarker computeClusterAABBs( L"Compute Cluster AABBs", commandBuffer );
+
+    commandBuffer->BindComputePipelineState( m_ComputeClusterAABBsPSO );
+    commandBuffer->BindComputeDynamicConstantBuffer( 0, m_CameraParams );
+    commandBuffer->BindCompute32BitConstants( 1, m_ClusterData );
+    commandBuffer->BindComputeShaderArgument( 2, m_ClusterAABBs );
+
+    commandBuffer->Dispatch( static_cast<uint32_t>( glm::ceil( GetNumClusters() / 1024.0f ) ) );
+}
+
+void ClusterLightPipeline::AssignLightsToClusters( std::shared_ptr<ComputeCommandBuffer> commandBuffer )
+{
+    uint32_t numClusters = GetNumClusters();
+
+    {
+        ScopedProfileMarker findUniqueClusters( L"Find Unique Clusters", commandBuffer );
+
+        // There is no geometry to mark the clusters that contain samples so mark all clusters.
+        commandBuffer->ClearResourceUInt( m_ClusterFlags, glm::uvec4( 1 ) );
+        commandBuffer->ClearResourceUInt( m_UniqueClusters );
+        commandBuffer->ClearResourceUInt( m_UniqueClusters->GetCounterBuffer() );
+
+        commandBuffer->BindComputePipelineState( m_FindUniqueClustersPSO );
+        commandBuffer->BindComputeShaderArguments( 0, 0, { m_ClusterFlags, m_UniqueClusters } );
+
+        commandBuffer->Dispatch( static_cast<uint32_t>( glm::ceil( numClusters / 1024.0f ) ) );
+    }
+    {
+        ScopedProfileMarker updateIndirectArgumentBuffers( L"Update Indirect Argument Buffers", commandBuffer );
+
+        commandBuffer->BindComputePipelineState( m_UpdateIndirectArgumentBuffersPSO );
+
+        commandBuffer->BindCompute32BitConstants( 0, 1u );
+        commandBuffer->BindComputeShaderArguments( 1, 0, { m_UniqueClusters->GetCounterBuffer(), m_AssignLightsToClustersArguments, m_DebugClustersDrawArguments } );
+
+        commandBuffer->Dispatch( 1 );
+    }
+    {
+        ScopedProfileMarker assignLightsToClusters( L"Assign Lights to Clusters", commandBuffer );
+        ScopedProfileMarker bvh( L"BVH", commandBuffer );
+
+        commandBuffer->ClearResourceUInt( m_PointLightIndexCounter );
+        commandBuffer->ClearResourceUInt( m_SpotLightIndexCounter );
+        commandBuffer->ClearResourceUInt( m_PointLightGrid );
+        commandBuffer->ClearResourceUInt( m_SpotLightGrid );
+
+        BVHParams bvhParams = {};
+        bvhParams.PointLightLevels = LightBVHCPU::GetNumLevels( m_LightCounts.NumPointLights );
+        bvhParams.SpotLightLevels = LightBVHCPU::GetNumLevels( m_LightCounts.NumSpotLights );
+
+        commandBuffer->BindComputePipelineState( m_AssignLightsToClustersBVHPSO );
+
+        commandBuffer->BindCompute32BitConstants( 0, bvhParams );
+        commandBuffer->BindCompute32BitConstants( 1, m_LightCounts );
+        commandBuffer->BindComputeShaderArguments( 2, 0, { m_PointLights, m_SpotLights } );
+        commandBuffer->BindComputeShaderArguments( 2, 2, { m_UniqueClusters, m_ClusterAABBs } );
+        commandBuffer->BindComputeShaderArguments( 2, 4, { m_LightBVHBuilder.GetPointLightIndices(), m_LightBVHBuilder.GetSpotLightIndices() } );
+        commandBuffer->BindComputeShaderArguments( 2, 6, { m_LightBVHBuilder.GetPointLightBVH(), m_LightBVHBuilder.GetSpotLightBVH() } );
+        commandBuffer->BindComputeShaderArguments( 2, 8, { m_PointLightIndexCounter, m_SpotLightIndexCounter } );
+        commandBuffer->BindComputeShaderArguments( 2, 10, { m_PointLightGrid, m_SpotLightGrid } );
+        commandBuffer->BindComputeShaderArguments( 2, 12, { m_PointLightIndexList, m_SpotLightIndexList } );
+
+        commandBuffer->ExecuteIndirect( m_AssignLightsToClustersCommandSignature, m_AssignLightsToClustersArguments );
+    }
+}
@@ -0,0 +1,462 @@
+#include <GamePCH.h>
+#include <EngineIncludes.h>
+#include <Graphics/CPU/LightGeneratorCPU.h>
+#include <Graphics/CPU/UpdateLightsCPU.h>
+#include <Graphics/CPU/SIMD.h>
+
+#include <ClusterLightPipeline.h>
+#include <ConfigurationSettings.h>
+#include <PrintProfileDataVisitor.h>
+
+#include <chrono>
+#include <iomanip>
+
+using namespace Core;
+using namespace Graphics;
+
+// A single point of the benchmark sweep.
+struct BenchmarkPoint
+{
+    uint32_t NumLights;     // Number of point lights and spot lights (0 to use the lights of the configuration file).
+    uint32_t ScreenWidth;
+    uint32_t ScreenHeight;
+    uint32_t ClusterGridBlockSize;
+    uint32_t LightGridBlockSize;
+};
+
+// Parse a comma separated list of unsigned integers (for example "32,64").
+std::vector<uint32_t> ParseList( const std::wstring& arg )
+{
+    std::vector<uint32_t> values;
+    std::wstringstream ss( arg );
+    std::wstring value;
+
+    while ( std::getline( ss, value, L',' ) )
+    {
+        if ( !value.empty() )
+        {
+            values.push_back( static_cast<uint32_t>( std::stoul( value ) ) );
+        }
+    }
+
+    return values;
+}
+
+// Parse a comma separated list of resolutions (for example "1280x720,1920x1080").
+std::vector<glm::uvec2> ParseResolutions( const std::wstring& arg )
+{
+    std::vector<glm::uvec2> resolutions;
+    std::wstringstream ss( arg );
+    std::wstring value;
+
+    while ( std::getline( ss, value, L',' ) )
+    {
+        size_t x = value.find( L'x' );
+        if ( x != std::wstring::npos )
+        {
+            uint32_t width = static_cast<uint32_t>( std::stoul( value.substr( 0, x ) ) );
+            uint32_t height = static_cast<uint32_t>( std::stoul( value.substr( x + 1 ) ) );
+            resolutions.emplace_back( width, height );
+        }
+    }
+
+    return resolutions;
+}
+
+// The light generation parameters of a configuration (same as GenerateLights in the Game).
+LightGeneratorArgs GetLightGeneratorArgs( const ConfigurationSettings& config, uint32_t seed )
+{
+    LightGeneratorArgs args;
+    args.MinBounds = config.LightsMinBounds;
+    args.MaxBounds = config.LightsMaxBounds;
+    args.MinSpotAngle = config.MinSpotAngle;
+    args.MaxSpotAngle = config.MaxSpotAngle;
+    args.MinRange = config.MinRange;
+    args.MaxRange = config.MaxRange;
+    args.Seed = seed;
+
+    return args;
+}
+
+// Average time in milliseconds of a single invocation of func.
+template<typename Func>
+double MeasureTime( uint32_t numIterations, Func func )
+{
+    // The first invocation pages in the memory.
+    func();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for ( uint32_t i = 0; i < numIterations; ++i )
+    {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    return std::chrono::duration<double, std::milli>( end - start ).count() / numIterations;
+}
+
+void PrintUpdateLightsResult( const wchar_t* name, uint32_t numLights, size_t bytesPerLight, double time )
+{
+    double lightsPerSecond = numLights / ( time / 1000.0 );
+    std::wcout << L"  " << std::left << std::setw( 32 ) << name << std::right << std::fixed << std::setprecision( 3 )
+               << std::setw( 10 ) << time << L" ms"
+               << std::setw( 10 ) << lightsPerSecond / 1e6 << L" Mlights/s"
+               << std::setw( 10 ) << lightsPerSecond * bytesPerLight / 1e9 << L" GB/s" << std::endl;
+}
+
+/**
+ * CPU microbenchmark of the view space light transform (UpdateLights_CS.hlsl).
+ * Compares the update of the PointLight and SpotLight structures (AoS) with the
+ * update of a structure of arrays copy of the lights (SoA). The bandwidth is
+ * computed from the bytes that are actually needed by each variant (the AoS
+ * variants read and write the complete light structures) so comparing the
+ * bandwidth with the bandwidth of the machine shows how memory-bound the
+ * light transform is.
+ */
+void RunUpdateLightsBenchmark( const std::vector<uint32_t>& lightCounts, uint32_t numIterations, uint32_t seed )
+{
+    ThreadPool& threadPool = ThreadPool::Get();
+    UpdateLightsCPU updateLights( threadPool );
+    LightGeneratorCPU lightGenerator( threadPool );
+
+    LightGeneratorArgs args;
+    args.MinBounds = glm::vec3( -100.0f );
+    args.MaxBounds = glm::vec3( 100.0f );
+    args.Seed = seed;
+
+    glm::mat4 worldMatrix = glm::rotate( glm::mat4( 1 ), 1.0f / 60.0f, glm::vec3( 0, 1, 0 ) );
+    glm::mat4 viewMatrix = glm::lookAt( glm::vec3( 0, 50, 200 ), glm::vec3( 0 ), glm::vec3( 0, 1, 0 ) );
+
+    std::wcout << L"Update lights benchmark (" << threadPool.GetConcurrency() << L" threads, SIMD width " << SIMD::Width << L")" << std::endl;
+
+    for ( uint32_t numLights : lightCounts )
+    {
+        // Use 1M lights if the lights of the configuration file would be used.
+        numLights = numLights > 0 ? numLights : 1000000;
+
+        std::vector<PointLight> pointLights;
+        std::vector<SpotLight> spotLights;
+        lightGenerator.Generate( args, numLights, pointLights );
+        lightGenerator.Generate( args, numLights, spotLights );
+
+        LightTransformsSoA pointLightsSoA;
+        LightTransformsSoA spotLightsSoA;
+        updateLights.Gather( pointLights.data(), numLights, pointLightsSoA );
+        updateLights.Gather( spotLights.data(), numLights, spotLightsSoA );
+
+        for ( bool applyWorldMatrix : { false, true } )
+        {
+            std::wcout << numLights << L" point lights + " << numLights << L" spot lights"
+                       << ( applyWorldMatrix ? L" (world and view matrix):" : L" (view matrix):" ) << std::endl;
+
+            double time = MeasureTime( numIterations, [&]()
+            {
+                threadPool.ParallelFor( 0, numLights, 4096, [&]( uint32_t begin, uint32_t end )
+                {
+                    for ( uint32_t i = begin; i < end; ++i )
+                    {
+                        PointLight& pointLight = pointLights[i];
+                        if ( applyWorldMatrix )
+                        {
+                            pointLight.m_PositionWS = worldMatrix * pointLight.m_PositionWS;
+                        }
+                        pointLight.m_PositionVS = viewMatrix * glm::vec4( glm::vec3( pointLight.m_PositionWS ), 1 );
+
+                        SpotLight& spotLight = spotLights[i];
+                        if ( applyWorldMatrix )
+                        {
+                            spotLight.m_PositionWS = worldMatrix * spotLight.m_PositionWS;
+                            spotLight.m_DirectionWS = worldMatrix * spotLight.m_DirectionWS;
+                        }
+                        spotLight.m_PositionVS = viewMatrix * glm::vec4( glm::vec3( spotLight.m_PositionWS ), 1 );
+                        spotLight.m_DirectionVS = glm::normalize( viewMatrix * glm::vec4( glm::vec3( spotLight.m_DirectionWS ), 0 ) );
+                    }
+                } );
+            } );
+            // The average number of bytes that are read and written per light (a point light and a spot light
+            // are both read and written).
+            size_t aosBytesPerLight = sizeof( PointLight ) + sizeof( SpotLight );
+            PrintUpdateLightsResult( L"AoS (glm)", numLights * 2, aosBytesPerLight, time );
+
+            time = MeasureTime( numIterations, [&]()
+            {
+                updateLights.Update( worldMatrix, viewMatrix, applyWorldMatrix, pointLights.data(), numLights );
+                updateLights.Update( worldMatrix, viewMatrix, applyWorldMatrix, spotLights.data(), numLights );
+            } );
+            PrintUpdateLightsResult( L"AoS (SIMD)", numLights * 2, aosBytesPerLight, time );
+
+            time = MeasureTime( numIterations, [&]()
+            {
+                updateLights.Update( worldMatrix, viewMatrix, applyWorldMatrix, pointLightsSoA );
+                updateLights.Update( worldMatrix, viewMatrix, applyWorldMatrix, spotLightsSoA );
+            } );
+            size_t soaBytesPerLight = ( pointLightsSoA.GetBytesPerLight( applyWorldMatrix ) + spotLightsSoA.GetBytesPerLight( applyWorldMatrix ) ) / 2;
+            PrintUpdateLightsResult( L"SoA (SIMD)", numLights * 2, soaBytesPerLight, time );
+
+            time = MeasureTime( numIterations, [&]()
+            {
+                updateLights.Gather( pointLights.data(), numLights, pointLightsSoA );
+                updateLights.Gather( spotLights.data(), numLights, spotLightsSoA );
+                updateLights.Update( worldMatrix, viewMatrix, applyWorldMatrix, pointLightsSoA );
+                updateLights.Update( worldMatrix, viewMatrix, applyWorldMatrix, spotLightsSoA );
+                updateLights.Scatter( pointLightsSoA, pointLights.data() );
+                updateLights.Scatter( spotLightsSoA, spotLights.data() );
+            } );
+            PrintUpdateLightsResult( L"SoA (SIMD) + gather/scatter", numLights * 2, aosBytesPerLight, time );
+        }
+    }
+}
+
+// Write the profiling data in the same format as SavePerformanceData in the Game.
+std::wstring SavePerformanceData( const std::wstring& outputDirectory, std::shared_ptr<Device> device,
+                                  const std::wstring& configName, const BenchmarkPoint& point, size_t numLights )
+{
+    char buffer[80];
+    auto time = std::time( nullptr );
+    std::tm timeInfo;
+    localtime_s( &timeInfo, &time );
+
+    std::strftime( buffer, 80, "%Y-%m-%d-%H-%M-%S", &timeInfo );
+
+    std::wstringstream fileName;
+    fileName << outputDirectory << L"/" << buffer << " (" << device->GetAdapter()->GetDescription() << ") @ " << point.ScreenWidth << "x" << point.ScreenHeight
+             << " [ClusterBench " << configName << ", " << numLights << " lights, cluster " << point.ClusterGridBlockSize << ", light grid " << point.LightGridBlockSize << "]" << ".csv";
+
+    PrintProfileDataVisitor profilerVisitor( fileName.str() );
+    Profiler::Get().Accept( profilerVisitor );
+
+    return fileName.str();
+}
+
+void PrintUsage()
+{
+    std::wcout << L"Usage: ClusterBench [options]" << std::endl
+               << L"  -c, --config <file>          Configuration file to benchmark (can be specified multiple times)." << std::endl
+               << L"  --lights <n,...>             Number of point lights and spot lights to generate (0 to use the lights of the configuration file)." << std::endl
+               << L"  --resolution <WxH,...>       Screen resolutions (default: the window size of the configuration file)." << std::endl
+               << L"  --cluster-block <n,...>      Cluster grid block sizes (default: 64)." << std::endl
+               << L"  --light-grid-block <n,...>   Light grid block sizes (default: 32)." << std::endl
+               << L"  --frames <n>                 Number of frames to profile for each benchmark point (default: 100)." << std::endl
+               << L"  --seed <n>                   Seed for the light generation (default: 0)." << std::endl
+               << L"  --morton64                   Use 64-bit Morton codes for the light BVH." << std::endl
+               << L"  --warp                       Use the WARP adapter." << std::endl
+               << L"  --update-lights-benchmark    Only run the CPU light transform microbenchmark (AoS vs SoA) for the light counts." << std::endl
+               << L"  -o, --output <directory>     Output directory for the CSV files (default: ../Perf)." << std::endl;
+}
+
+int wmain( int argc, wchar_t* argv[] )
+{
+    ::CoInitializeEx( nullptr, COINIT_MULTITHREADED );
+
+    LogManager::Init();
+
+    std::shared_ptr<LogStreamConsole> coutLogStream = std::make_shared<LogStreamConsole>();
+    LogManager::RegisterLogStream( coutLogStream );
+
+    std::vector<std::wstring> configFileNames;
+    std::vector<uint32_t> lightCounts;
+    std::vector<glm::uvec2> resolutions;
+    std::vector<uint32_t> clusterGridBlockSizes = { 64 };
+    std::vector<uint32_t> lightGridBlockSizes = { 32 };
+    std::wstring outputDirectory = L"../Perf";
+    uint32_t numFrames = 100;
+    uint32_t seed = 0;
+    bool use64BitMortonCodes = false;
+    bool useWarpAdapter = false;
+    bool updateLightsBenchmark = false;
+
+    // Parse command line arguments.
+    for ( int i = 1; i < argc; i++ )
+    {
+        std::wstring arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if ( ( arg == L"-c" || arg == L"--config" ) && hasValue )
+        {
+            configFileNames.push_back( argv[++i] );
+        }
+        else if ( arg == L"--lights" && hasValue )
+        {
+            lightCounts = ParseList( argv[++i] );
+        }
+        else if ( arg == L"--resolution" && hasValue )
+        {
+            resolutions = ParseResolutions( argv[++i] );
+        }
+        else if ( arg == L"--cluster-block" && hasValue )
+        {
+            clusterGridBlockSizes = ParseList( argv[++i] );
+        }
+        else if ( arg == L"--light-grid-block" && hasValue )
+        {
+            lightGridBlockSizes = ParseList( argv[++i] );
+        }
+        else if ( arg == L"--frames" && hasValue )
+        {
+            numFrames = std::max( 1ul, std::stoul( argv[++i] ) );
+        }
+        else if ( arg == L"--seed" && hasValue )
+        {
+            seed = static_cast<uint32_t>( std::stoul( argv[++i] ) );
+        }
+        else if ( arg == L"--morton64" )
+        {
+            use64BitMortonCodes = true;
+        }
+        else if ( arg == L"--warp" )
+        {
+            useWarpAdapter = true;
+        }
+        else if ( arg == L"--update-lights-benchmark" )
+        {
+            updateLightsBenchmark = true;
+        }
+        else if ( ( arg == L"-o" || arg == L"--output" ) && hasValue )
+        {
+            outputDirectory = argv[++i];
+        }
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    if ( configFileNames.empty() )
+    {
+        configFileNames.push_back( L"../Conf/DefaultConfiguration.3dgep" );
+    }
+
+    if ( lightCounts.empty() )
+    {
+        lightCounts.push_back( 0 );
+    }
+
+    if ( updateLightsBenchmark )
+    {
+        RunUpdateLightsBenchmark( lightCounts, numFrames, seed );
+
+        LogManager::Shutdown();
+        ::CoUninitialize();
+
+        return 0;
+    }
+
+    fs::create_directories( outputDirectory );
+
+    // The application is only used to create the device. No window is created.
+    ApplicationDX12 application;
+
+    const AdapterList& adapters = application.GetAdapters();
+    std::shared_ptr<Adapter> adapter;
+    if ( useWarpAdapter || adapters.empty() )
+    {
+        LogManager::LogWarning( "Using Warp Adapter." );
+        adapter = application.GetWarpAdapter();
+    }
+    else
+    {
+        adapter = adapters[0];
+    }
+
+    std::shared_ptr<Device> device = application.CreateDevice( adapter );
+
+    Profiler::Init( device, 2048 );
+
+    uint64_t frame = 0;
+
+    {
+        ClusterLightPipeline pipeline( device );
+        pipeline.SetUse64BitMortonCodes( use64BitMortonCodes );
+
+        for ( const auto& configFileName : configFileNames )
+        {
+            ConfigurationSettings config;
+            if ( !config.Load( configFileName ) )
+            {
+                LOG_ERROR( "Failed to load configuration file ", configFileName );
+                continue;
+            }
+
+            std::wstring configName = fs::path( configFileName ).stem().wstring();
+
+            // Recreate the camera of the configuration file.
+            Camera camera;
+            camera.SetTranslate( config.CameraPosition );
+            camera.SetRotate( config.CameraRotation );
+
+            std::vector<glm::uvec2> configResolutions = resolutions;
+            if ( configResolutions.empty() )
+            {
+                configResolutions.emplace_back( config.WindowWidth, config.WindowHeight );
+            }
+
+            for ( uint32_t numLights : lightCounts )
+            {
+                std::vector<PointLight> pointLights = config.PointLights;
+                std::vector<SpotLight> spotLights = config.SpotLights;
+
+                if ( numLights > 0 )
+                {
+                    // Use the same lights for every configuration to make the results comparable.
+                    // The light generator produces the same lights for the same seed on every machine.
+                    LightGeneratorCPU lightGenerator;
+                    LightGeneratorArgs args = GetLightGeneratorArgs( config, seed );
+
+                    lightGenerator.Generate( args, numLights, pointLights );
+                    lightGenerator.Generate( args, numLights, spotLights );
+                }
+
+                pipeline.SetLights( pointLights, spotLights, config.DirectionalLights );
+
+                for ( const auto& resolution : configResolutions )
+                {
+                    Viewport viewport( 0.0f, 0.0f, static_cast<float>( resolution.x ), static_cast<float>( resolution.y ) );
+
+                    camera.SetViewport( viewport );
+                    camera.SetProjection( 45.0f, resolution.x / (float)resolution.y, 0.1f, 1000.0f );
+
+                    for ( uint32_t clusterGridBlockSize : clusterGridBlockSizes )
+                    {
+                        for ( uint32_t lightGridBlockSize : lightGridBlockSizes )
+                        {
+                            BenchmarkPoint point = { numLights, resolution.x, resolution.y, clusterGridBlockSize, lightGridBlockSize };
+
+                            pipeline.SetGrid( camera, point.ScreenWidth, point.ScreenHeight, point.ClusterGridBlockSize, point.LightGridBlockSize );
+
+                            Profiler::Get().ClearAllProfilingData();
+
+                            glm::mat4 viewMatrix = camera.GetViewMatrix();
+
+                            for ( uint32_t i = 0; i < numFrames; ++i )
+                            {
+                                Profiler::Get().SetCurrentFrame( ++frame );
+
+                                // Rotate the lights like the Game does when animating lights
+                                // so that the light BVH is different every frame.
+                                glm::mat4 rotationMatrix = glm::rotate( glm::mat4( 1 ), i / 60.0f, glm::vec3( 0, 1, 0 ) );
+
+                                pipeline.Execute( rotationMatrix, viewMatrix );
+                            }
+
+                            size_t totalLights = pointLights.size() + spotLights.size();
+                            std::wstring fileName = SavePerformanceData( outputDirectory, device, configName, point, totalLights );
+
+                            const ClusterDataCB& clusterData = pipeline.GetClusterData();
+                            LOG_INFO( configName, ": ", totalLights, " lights @ ", point.ScreenWidth, "x", point.ScreenHeight,
+                                      ", cluster grid ", clusterData.GridDim.x, "x", clusterData.GridDim.y, "x", clusterData.GridDim.z,
+                                      " (", pipeline.GetNumClusters(), " clusters) -> ", fileName );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    Profiler::Shutdown();
+    LogManager::Shutdown();
+
+    ::CoUninitialize();
+
+    return 0;
+}
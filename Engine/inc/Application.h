@@ -33,6 +33,7 @@
 #include "Object.h"
 #include "Common.h"
 #include "Events.h"
+#include "FileChangeQueue.h"
 #include "ReadDirectoryChanges.h"
 #include "Graphics/TextureFormat.h"
 
@@ -274,6 +275,8 @@ namespace Core
 
         // Directory change listener.
         CReadDirectoryChanges m_DirectoryChanges;
+        // Changes are only reported after a file was not changed for a while.
+        FileChangeQueue m_FileChanges;
         // Thread to run directory change listener.
         std::thread m_DirectoryChangeListenerThread;
         std::mutex m_DirectoryChangeMutex;
@@ -0,0 +1,178 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file DependencyDatabase.h
+ *  @date October 18, 2026
+ *
+ *  @brief A binary database of the dependencies and content hashes of all assets.
+ */
+
+#include "EngineDefines.h"
+#include "NonCopyable.h"
+
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+/**
+ * The dependencies of all of the assets in a single binary file.
+ * An asset is stale if the contents of its base file or any of its dependencies
+ * changed since the cooked asset was built, or if the asset is built with different
+ * build parameters (for example, the texture compression). The contents of the files
+ * are compared with a hash so copying or checking out files doesn't make an asset stale.
+ *
+ * The size, last write time and hash of each file are stored in the database. A file
+ * is only hashed again if its size or last write time changed so checking if an asset
+ * is stale normally costs one stat per file. Refresh checks all of the files in the
+ * database in parallel so the staleness checks during loading only compare hashes.
+ *
+ * All functions are thread-safe. Files are read and hashed without holding the lock.
+ */
+class ENGINE_DLL DependencyDatabase : public Core::NonCopyable
+{
+public:
+    DependencyDatabase();
+    virtual ~DependencyDatabase();
+
+    /**
+     * The database that is used by the DependencyTracker.
+     */
+    static DependencyDatabase& Get();
+
+    /**
+     * Load the database from a file. The file is also used to save the database.
+     * @returns false if the file doesn't exist or is not a dependency database.
+     * In that case the database is empty.
+     */
+    bool Load( const fs::path& filePath );
+
+    /**
+     * Save the database to the file that it was loaded from (if it was modified).
+     */
+    bool Save();
+
+    /**
+     * Check the size and last write time of all of the files in the database in parallel
+     * and hash the files that changed.
+     */
+    void Refresh();
+
+    /**
+     * The file changed at runtime and must be checked again (see DependencyTracker::OnFileChanged).
+     */
+    void InvalidateFile( const fs::path& filePath );
+
+    /**
+     * Get the files that an asset depends on (the base file is the first file).
+     * @returns false if the asset is not in the database.
+     */
+    bool GetDependencies( const fs::path& baseFile, std::vector<fs::path>& dependencies ) const;
+    void SetDependencies( const fs::path& baseFile, const std::vector<fs::path>& dependencies );
+
+    /**
+     * The hash of the file that the dependencies of the asset were imported from
+     * (0 if the dependencies were not imported from a file).
+     */
+    uint64_t GetImportHash( const fs::path& baseFile ) const;
+    void SetImportHash( const fs::path& baseFile, uint64_t importHash );
+
+    /**
+     * Get the hash of the contents of a file (0 if the file doesn't exist).
+     */
+    uint64_t GetFileHash( const fs::path& filePath );
+
+    /**
+     * Check if the asset was built with the current contents of its files.
+     * @param buildParameters If not null, the asset is also stale if it was built
+     * with different build parameters.
+     * @returns true if the asset was never built or if it is stale.
+     */
+    bool IsStale( const fs::path& baseFile, const uint64_t* buildParameters = nullptr );
+
+    /**
+     * Check if the asset was built (with any contents of its files).
+     */
+    bool IsBuilt( const fs::path& baseFile ) const;
+
+    /**
+     * Record that the asset was built with the current contents of its files.
+     */
+    void SetBuilt( const fs::path& baseFile, uint64_t buildParameters );
+
+    /**
+     * The base files of all of the assets in the database.
+     */
+    std::vector<fs::path> GetAssets() const;
+
+    /**
+     * The key of a file in the database. Different paths to the same file have
+     * the same key (symbolic links are not resolved).
+     */
+    static std::wstring GetKey( const fs::path& filePath );
+
+private:
+    struct FileState
+    {
+        fs::path FilePath;
+        uint64_t Size;
+        int64_t LastWriteTime;
+        uint64_t Hash;
+        // The file was checked since the database was loaded.
+        bool IsChecked;
+        // Incremented by InvalidateFile. CheckFiles doesn't store the result of a
+        // check if the file was invalidated while it was being checked.
+        uint32_t NumInvalidations;
+    };
+
+    struct AssetRecord
+    {
+        // The indices of the base file and its dependencies in the file table.
+        std::vector<uint32_t> Files;
+        uint64_t ImportHash;
+        uint64_t BuildParameters;
+        // The combined hash of the files when the asset was built.
+        uint64_t BuildHash;
+        bool IsBuilt;
+    };
+
+    uint32_t GetFileIndex( const fs::path& filePath );
+    // Check the files and hash the files that changed (in parallel if there are many files).
+    void CheckFiles( std::vector<uint32_t> fileIndices );
+    // The combined hash of the files of an asset (the files must be checked).
+    uint64_t GetBuildHash( const AssetRecord& assetRecord ) const;
+
+    mutable std::mutex m_Mutex;
+
+    fs::path m_FilePath;
+
+    std::vector<FileState> m_Files;
+    std::unordered_map<std::wstring, uint32_t> m_FileIndices;
+    std::unordered_map<std::wstring, AssetRecord> m_Assets;
+
+    bool m_IsModified;
+};
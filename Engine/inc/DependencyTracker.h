@@ -35,18 +35,43 @@ public:
     void AddDependency( const std::wstring& dependencyFile );
 
     /**
-     * Check to see if the base file or any of the dependencies have changed
-     * on disk.
-     * Using this function is expensive and should only be checked during load
-     * if the optimized asset needs to be reexported because the original 
-     * asset or one of its dependencies have changed.
+     * The files that are tracked by this dependency tracker (the base file
+     * and its dependencies). The paths are relative to the current working
+     * directory if the base file is.
+     */
+    std::vector<fs::path> GetDependencyPaths();
+
+    /**
+     * The hash of the parameters that the optimized asset is built with (for
+     * example, the texture compression). The asset is stale if it was built
+     * with different build parameters.
+     */
+    void SetBuildParameters( uint64_t buildParameters );
+
+    /**
+     * Check to see if the contents of the base file or any of the dependencies
+     * have changed since the optimized asset was built (see SetUpToDate).
+     * The contents of the files are compared with the hashes in the
+     * DependencyDatabase. The files are only hashed again if their size or
+     * last write time changed.
+     * This function should only be checked during load if the optimized asset
+     * needs to be reexported because the original asset or one of its
+     * dependencies have changed.
      * The asset should register for the FileChanged event and only reload the 
      * asset if that event is fired.
+     * Assets that were built before their hashes were stored in the database
+     * are checked with the last load time once.
      * @returns true if the base file or any of the dependencies have been 
-     * modified since the last load time.
+     * modified since the optimized asset was built.
      */
     bool IsStale();
 
+    /**
+     * Store the hashes of the base file and the dependencies in the dependency
+     * database after the optimized asset was built.
+     */
+    void SetUpToDate();
+
     /**
      * Update the last load time to this value.
      * @param lastLoadTime Update the last load time by this time. By default, it
@@ -58,20 +83,19 @@ public:
     /**
      * This function will not save the assets that the dependency tracks.
      * 
-     * Save the dependency file to disk.
-     * The dependency file will be saved in the same folder as the base file
-     * with the extension of the base file replaced with ".dep".
+     * Save the dependencies to the dependency database (see DependencyDatabase).
      * 
-     * @returns true if the dependency file was successfully saved to disk.
+     * @returns true if the dependencies were successfully saved.
      */
     bool Save();
 
     /**
      * This function will not load the assets that the dependency tracks.
      * 
-     * Load the dependencies from the dependency file.
-     * The dependency file will be loaded from the same folder as the base file
-     * with the extension of the base file replaced with ".dep".
+     * Load the dependencies from the dependency database.
+     * Dependencies can also be added by hand to a dependency file in the same
+     * folder as the base file with ".dep" appended to the name of the base file.
+     * The dependency file is imported into the database if it changed.
      * 
      * @returns true if the dependencies were successfully loaded.
      */
@@ -89,10 +113,15 @@ public:
 protected:
     
     // Callback function that gets invoked when a file modification has been detected.
+    // Only invoked for the base file and the dependencies (see DependencyTrackerIndex).
     virtual void OnFileChanged( Core::FileChangeEventArgs& e );
 
 private:
     friend class boost::serialization::access;
+    friend class DependencyTrackerIndex;
+
+    // Update the files that this tracker receives file changes for.
+    void UpdateIndex();
 
     template<class Archive>
     void serialize( Archive& ar, const unsigned int version );
@@ -100,7 +129,7 @@ private:
     // The base file.
     std::wstring m_BaseFile;
 
-    // The dependency file is used to serialize an asset's dependencies
+    // The dependency file is used to manually describe an asset's dependencies.
     // For some assets it is possible to automatically determine their dependencies,
     // but in most cases, we just want to manually describe an asset's 
     // dependencies (for example, for various model formats).
@@ -120,13 +149,13 @@ private:
     // assets should be reloaded.
     fs::file_time_type m_LastLoadtime;
 
+    uint64_t m_BuildParameters;
+    bool m_HasBuildParameters;
+
     // Mutex to protect modifications to dependency tracker 
     typedef std::recursive_mutex Mutex;
     typedef std::unique_lock<Mutex> MutexLock;
     Mutex m_Mutex;
-
-
-    Core::Event::ScopedConnections m_EventConnections;
 };
 
 #include "DependencyTracker.inl"
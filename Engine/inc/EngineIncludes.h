@@ -45,6 +45,7 @@
 #include "Graphics/Material.h"
 #include "Graphics/Scene.h"
 #include "Graphics/SceneNode.h"
+#include "Graphics/TransformHierarchy.h"
 #include "Graphics/Shader.h"
 #include "Graphics/ShaderParameter.h"
 #include "Graphics/ShaderSignature.h"
@@ -52,6 +53,7 @@
 #include "Graphics/Sampler.h"
 #include "Graphics/ClearColor.h"
 #include "Graphics/RenderTarget.h"
+#include "Graphics/RenderQueue.h"
 #include "Graphics/Query.h"
 #include "Graphics/PointLight.h"
 #include "Graphics/SpotLight.h"
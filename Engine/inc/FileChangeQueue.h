@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file FileChangeQueue.h
+ *  @date October 18, 2026
+ *
+ *  @brief Merge bursts of file changes to the same path.
+ */
+
+#include "EngineDefines.h"
+#include "Events.h"
+
+#include <chrono>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Core
+{
+    /**
+     * Editors write a file several times when it is saved (or replace it with
+     * a temporary file). The file change queue merges the changes to the same
+     * path until the path was not changed for a while, so the file is only
+     * reloaded once. This class is not thread safe.
+     */
+    class ENGINE_DLL FileChangeQueue
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        struct FileChange
+        {
+            FileAction Action;
+            std::wstring Path;
+        };
+
+        /**
+         * @param delay The time that a path must not be changed before its
+         * changes are popped from the queue.
+         */
+        explicit FileChangeQueue( Clock::duration delay = std::chrono::milliseconds( 100 ) );
+
+        /**
+         * Add a change to a file. Changes to the same path are merged.
+         */
+        void Push( FileAction action, const std::wstring& path, Clock::time_point time = Clock::now() );
+
+        /**
+         * Get the merged changes of the paths that were not changed for the delay
+         * (in the order that the paths were first changed). Merged changes that
+         * cancel out (a file that was added and removed again) are skipped.
+         * @returns The number of changes.
+         */
+        size_t Pop( std::vector<FileChange>& fileChanges, Clock::time_point time = Clock::now() );
+
+        /**
+         * The time until the next change can be popped (Clock::duration::max()
+         * if the queue is empty).
+         */
+        Clock::duration GetTimeout( Clock::time_point time = Clock::now() ) const;
+
+        bool IsEmpty() const;
+        void Clear();
+
+    private:
+        struct PendingChange
+        {
+            std::wstring Path;
+            FileAction FirstAction;
+            FileAction LastAction;
+            Clock::time_point LastTime;
+        };
+
+        using PendingChanges = std::list<PendingChange>;
+
+        Clock::duration m_Delay;
+
+        // The pending changes in the order that the paths were first changed.
+        PendingChanges m_PendingChanges;
+        std::unordered_map<std::wstring, PendingChanges::iterator> m_PendingChangeMap;
+    };
+}
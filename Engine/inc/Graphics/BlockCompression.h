@@ -0,0 +1,76 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file BlockCompression.h
+ *  @date October 18, 2026
+ *
+ *  @brief CPU block compression (BC1, BC3, BC4, BC5 and BC7 encoders).
+ */
+
+#include "../EngineDefines.h"
+
+namespace Graphics
+{
+    /**
+     * CPU encoders for the BC1, BC3, BC4, BC5, and BC7 block compression formats.
+     * Each function encodes a single block of 4x4 texels. The texels of a block are
+     * stored in row-major order. The encoders are thread-safe.
+     */
+    class ENGINE_DLL BlockCompression
+    {
+    public:
+        // The size of a BC1 or BC4 block in bytes.
+        static const size_t BlockSize8 = 8;
+        // The size of a BC3, BC5 or BC7 block in bytes.
+        static const size_t BlockSize16 = 16;
+
+        /**
+         * Encode a block of RGBA texels (64 bytes) to BC1 (RGB, no alpha).
+         */
+        static void EncodeBC1( const uint8_t* rgba, uint8_t* block );
+
+        /**
+         * Encode a block of RGBA texels (64 bytes) to BC3 (RGB with interpolated alpha).
+         */
+        static void EncodeBC3( const uint8_t* rgba, uint8_t* block );
+
+        /**
+         * Encode a block of single channel texels (16 bytes) to BC4.
+         * @param stride The distance in bytes between two texels.
+         */
+        static void EncodeBC4( const uint8_t* red, uint8_t* block, size_t stride = 1 );
+
+        /**
+         * Encode the red and green channels of a block of RGBA texels (64 bytes) to BC5.
+         */
+        static void EncodeBC5( const uint8_t* rgba, uint8_t* block );
+
+        /**
+         * Encode a block of RGBA texels (64 bytes) to BC7.
+         * Only mode 6 (a single subset with RGBA endpoints and 4-bit indices) is used.
+         */
+        static void EncodeBC7( const uint8_t* rgba, uint8_t* block );
+    };
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file BoundingBox.h
+ *  @date October 18, 2026
+ *
+ *  @brief Axis-aligned bounding box.
+ */
+
+#include "../EngineDefines.h"
+
+namespace Graphics
+{
+    /**
+     * Axis-aligned bounding box.
+     * The layout of this structure matches the AABB structure that is used in
+     * the shaders so that arrays of bounding boxes can be copied directly
+     * to and from structured buffers.
+     */
+    struct alignas( 16 ) BoundingBox
+    {
+        glm::vec4 m_Min;
+        glm::vec4 m_Max;
+        //--------------------------------------------------------------( 32 bytes )
+
+        BoundingBox()
+            : m_Min( std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), 1.0f )
+            , m_Max( -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), 1.0f )
+        {}
+
+        BoundingBox( const glm::vec3& min, const glm::vec3& max )
+            : m_Min( min, 1.0f )
+            , m_Max( max, 1.0f )
+        {}
+
+        // Grow the bounding box to include a point.
+        void Grow( const glm::vec3& point )
+        {
+            m_Min = glm::vec4( glm::min( glm::vec3( m_Min ), point ), 1.0f );
+            m_Max = glm::vec4( glm::max( glm::vec3( m_Max ), point ), 1.0f );
+        }
+
+        // Grow the bounding box to include another bounding box.
+        void Grow( const BoundingBox& other )
+        {
+            m_Min = glm::vec4( glm::min( glm::vec3( m_Min ), glm::vec3( other.m_Min ) ), 1.0f );
+            m_Max = glm::vec4( glm::max( glm::vec3( m_Max ), glm::vec3( other.m_Max ) ), 1.0f );
+        }
+
+        bool IsValid() const
+        {
+            return m_Min.x <= m_Max.x && m_Min.y <= m_Max.y && m_Min.z <= m_Max.z;
+        }
+
+        glm::vec3 GetCenter() const
+        {
+            return ( glm::vec3( m_Min ) + glm::vec3( m_Max ) ) * 0.5f;
+        }
+
+        glm::vec3 GetExtents() const
+        {
+            return ( glm::vec3( m_Max ) - glm::vec3( m_Min ) ) * 0.5f;
+        }
+
+        // Surface area of the bounding box (used as a quality metric for bounding volume hierarchies).
+        float GetSurfaceArea() const
+        {
+            if ( !IsValid() ) return 0.0f;
+
+            glm::vec3 d = glm::vec3( m_Max ) - glm::vec3( m_Min );
+            return 2.0f * ( d.x * d.y + d.y * d.z + d.z * d.x );
+        }
+
+        /**
+         * Compute the axis-aligned bounding box of the transformed bounding box.
+         * The transform must be affine.
+         * Source: Transforming Axis-Aligned Bounding Boxes, James Arvo (Graphics Gems, 1990)
+         */
+        BoundingBox Transform( const glm::mat4& transform ) const
+        {
+            if ( !IsValid() ) return *this;
+
+            glm::vec3 center = glm::vec3( transform * glm::vec4( GetCenter(), 1.0f ) );
+            glm::vec3 extents = GetExtents();
+            extents = glm::abs( glm::vec3( transform[0] ) ) * extents.x +
+                      glm::abs( glm::vec3( transform[1] ) ) * extents.y +
+                      glm::abs( glm::vec3( transform[2] ) ) * extents.z;
+
+            return BoundingBox( center - extents, center + extents );
+        }
+
+        // Check to see if this bounding box intersects another bounding box.
+        // Source: Real-time collision detection, Christer Ericson (2005)
+        bool Intersects( const BoundingBox& other ) const
+        {
+            return m_Max.x >= other.m_Min.x && m_Min.x <= other.m_Max.x &&
+                   m_Max.y >= other.m_Min.y && m_Min.y <= other.m_Max.y &&
+                   m_Max.z >= other.m_Min.z && m_Min.z <= other.m_Max.z;
+        }
+    };
+}
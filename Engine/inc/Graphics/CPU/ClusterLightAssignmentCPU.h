@@ -0,0 +1,210 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file ClusterLightAssignmentCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief CPU implementation of the cluster light assignment compute shaders.
+ */
+
+#include "../../EngineDefines.h"
+#include "../BoundingBox.h"
+
+namespace Core
+{
+    class ThreadPool;
+}
+
+namespace Graphics
+{
+    struct PointLight;
+    struct SpotLight;
+
+    /**
+     * The lights and clusters that are used as input for light assignment.
+     * The arrays are not owned by this structure.
+     */
+    struct ClusterLightAssignmentArgs
+    {
+        const PointLight*   PointLights = nullptr;
+        uint32_t            NumPointLights = 0;
+        const SpotLight*    SpotLights = nullptr;
+        uint32_t            NumSpotLights = 0;
+
+        // The view space AABBs of all clusters in the cluster grid.
+        const BoundingBox*  ClusterAABBs = nullptr;
+        uint32_t            NumClusters = 0;
+
+        // The (1D) indices of the clusters that contain samples.
+        const uint32_t*     UniqueClusters = nullptr;
+        uint32_t            NumUniqueClusters = 0;
+    };
+
+    /**
+     * The light BVHs as they are built by BuildBVH_CS.hlsl.
+     * Leaf i of the BVH refers to light LightIndices[i].
+     */
+    struct LightBVHArgs
+    {
+        const BoundingBox*  PointLightBVH = nullptr;
+        const uint32_t*     PointLightIndices = nullptr;
+        uint32_t            PointLightLevels = 0;
+        const BoundingBox*  SpotLightBVH = nullptr;
+        const uint32_t*     SpotLightIndices = nullptr;
+        uint32_t            SpotLightLevels = 0;
+    };
+
+    /**
+     * The light grid and light index lists for a single light type.
+     * This has the same layout as the PointLightGrid_Cluster and
+     * PointLightIndexList_Cluster (or SpotLight*) structured buffers.
+     */
+    struct ClusterLightList
+    {
+        // ( offset, count ) into the index list for every cluster in the grid.
+        std::vector<glm::uvec2> Grid;
+        // Light indices for all unique clusters.
+        std::vector<uint32_t> IndexList;
+        // Equivalent of the LightIndexCounter_Cluster buffer.
+        uint32_t IndexCount = 0;
+        // The number of clusters that had more lights than fit in the light list.
+        uint32_t NumTruncatedClusters = 0;
+        // The number of BVH nodes and lights that were tested against the clusters.
+        // This is a measure of the traversal cost of the light assignment.
+        uint64_t NodeTests = 0;
+        uint64_t LightTests = 0;
+    };
+
+    /**
+     * Multithreaded CPU implementation of AssignLightsToClusters_CS.hlsl and
+     * AssignLightsToClustersBVH_CS.hlsl.
+     * Unique clusters are distributed over the threads of the thread pool and
+     * sphere vs AABB tests are performed on 8 (AVX) or 4 (SSE) lights at a time.
+     * The set of lights in each cluster matches the compute shaders. Offsets
+     * into the index lists are assigned in unique cluster order (instead of the
+     * order of an atomic counter) so the result is deterministic.
+     * With exact light lists, the number of lights per cluster is not limited and
+     * the offsets are computed with a prefix sum over the light grid in cluster
+     * order. This matches the result of the two pass (COUNT_LIGHTS, FILL_LIGHTS)
+     * light assignment exactly (except for the order of the lights within a cluster).
+     */
+    class ENGINE_DLL ClusterLightAssignmentCPU
+    {
+    public:
+        // Maximum number of lights per cluster in AssignLightsToClusters_CS.hlsl
+        static const uint32_t MaxLightsPerCluster = 1024;
+        // Maximum number of lights per cluster in AssignLightsToClustersBVH_CS.hlsl
+        static const uint32_t MaxLightsPerClusterBVH = 2048;
+
+        ClusterLightAssignmentCPU();
+        explicit ClusterLightAssignmentCPU( Core::ThreadPool& threadPool );
+        virtual ~ClusterLightAssignmentCPU();
+
+        /**
+         * Test every light against every unique cluster.
+         * CPU version of AssignLightsToClusters_CS.hlsl
+         */
+        void AssignLights( const ClusterLightAssignmentArgs& args, ClusterLightList& pointLights, ClusterLightList& spotLights );
+
+        /**
+         * Traverse the light BVHs for every unique cluster.
+         * CPU version of AssignLightsToClustersBVH_CS.hlsl
+         */
+        void AssignLightsBVH( const ClusterLightAssignmentArgs& args, const LightBVHArgs& bvh, ClusterLightList& pointLights, ClusterLightList& spotLights );
+
+        /**
+         * Check if two light lists contain the same set of lights for all unique clusters.
+         * The order of the lights within a cluster and the offsets into the index list are
+         * not compared because they depend on the order in which the GPU executes thread groups.
+         * This can be used to validate GPU results that have been read back from the light grid
+         * and light index list buffers.
+         */
+        static bool Compare( const glm::uvec2* gridA, const uint32_t* indexListA,
+                             const glm::uvec2* gridB, const uint32_t* indexListB,
+                             const uint32_t* uniqueClusters, uint32_t numUniqueClusters );
+
+        static bool Compare( const ClusterLightList& a, const ClusterLightList& b, const uint32_t* uniqueClusters, uint32_t numUniqueClusters );
+
+        /**
+         * Compute the offsets (x) into the light index list from the light counts (y)
+         * of all clusters in the light grid with an exclusive prefix sum.
+         * CPU version of PrefixSumLightGrid_CS.hlsl
+         * @returns The total number of light indices.
+         */
+        static uint32_t PrefixSumLightGrid( glm::uvec2* grid, uint32_t numClusters );
+
+        // Don't limit the number of lights per cluster and compute the offsets into the light index lists in cluster order.
+        void SetExactLightLists( bool exactLightLists );
+        bool GetExactLightLists() const;
+
+    private:
+        // Light spheres in structure of arrays layout.
+        struct LightSpheres
+        {
+            std::vector<float> X;
+            std::vector<float> Y;
+            std::vector<float> Z;
+            // Squared range of the light (negative for disabled lights).
+            std::vector<float> RangeSq;
+            // The index of the light in the original light array.
+            std::vector<uint32_t> LightIndex;
+            uint32_t NumLights = 0;
+
+            void Resize( uint32_t numLights );
+        };
+
+        // Light indices for a range of unique clusters.
+        struct ClusterChunk
+        {
+            std::vector<uint32_t> Counts;
+            std::vector<uint32_t> Indices;
+            uint32_t Offset = 0;
+            uint32_t NumTruncated = 0;
+            uint64_t NodeTests = 0;
+            uint64_t LightTests = 0;
+        };
+
+        template<typename LightType>
+        void BuildLightSpheres( const LightType* lights, uint32_t numLights, const uint32_t* lightIndices, LightSpheres& spheres );
+
+        template<typename ClusterFunc>
+        void AssignClusters( const ClusterLightAssignmentArgs& args, ClusterFunc clusterFunc, ClusterLightList& pointLights, ClusterLightList& spotLights );
+
+        void GatherLightList( const ClusterLightAssignmentArgs& args, std::vector<ClusterChunk>& chunks, ClusterLightList& lightList );
+
+        // The maximum number of lights per cluster (unlimited with exact light lists).
+        uint32_t GetMaxLights( uint32_t maxLights ) const;
+
+        Core::ThreadPool& m_ThreadPool;
+
+        LightSpheres m_PointLightSpheres;
+        LightSpheres m_SpotLightSpheres;
+
+        std::vector<ClusterChunk> m_PointLightChunks;
+        std::vector<ClusterChunk> m_SpotLightChunks;
+
+        bool m_ExactLightLists;
+    };
+}
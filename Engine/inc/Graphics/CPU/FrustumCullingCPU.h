@@ -0,0 +1,88 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file FrustumCullingCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief SIMD frustum culling of axis-aligned bounding boxes.
+ */
+
+#include "../../EngineDefines.h"
+#include "../BoundingBox.h"
+#include "../Frustum.h"
+
+namespace Graphics
+{
+    /**
+     * Culls axis-aligned bounding boxes against the planes of a view frustum.
+     * The boxes are stored in structure of arrays layout (center and extents)
+     * so that 8 (AVX) or 4 (SSE) boxes are tested against a plane at a time.
+     * A box is culled if it is completely in the negative halfspace of any of
+     * the frustum planes. Boxes that intersect the corners of the frustum
+     * outside of the frustum are conservatively reported as visible.
+     */
+    class ENGINE_DLL FrustumCullingCPU
+    {
+    public:
+        FrustumCullingCPU();
+        virtual ~FrustumCullingCPU();
+
+        // Remove all of the boxes.
+        void Clear();
+
+        /**
+         * Add a bounding box.
+         * Invalid (empty) bounding boxes are never culled.
+         * @returns The index of the box.
+         */
+        uint32_t AddBoundingBox( const BoundingBox& boundingBox );
+
+        uint32_t GetNumBoundingBoxes() const;
+
+        /**
+         * Test the boxes against the planes of the frustum.
+         * @param frustum The frustum (in the same space as the boxes).
+         * @param visibilityMasks One bit per box (32 boxes per word). The bit is set if the box is (partially) inside the frustum.
+         * @returns The number of boxes that are visible.
+         */
+        uint32_t Cull( const Frustum& frustum, std::vector<uint32_t>& visibilityMasks ) const;
+
+        // Check the bit of a box in the visibility masks.
+        static bool IsVisible( const std::vector<uint32_t>& visibilityMasks, uint32_t index )
+        {
+            return ( visibilityMasks[index / 32] & ( 1u << ( index % 32 ) ) ) != 0;
+        }
+
+    private:
+        std::vector<float> m_CenterX;
+        std::vector<float> m_CenterY;
+        std::vector<float> m_CenterZ;
+        std::vector<float> m_ExtentX;
+        std::vector<float> m_ExtentY;
+        std::vector<float> m_ExtentZ;
+
+        uint32_t m_NumBoundingBoxes;
+    };
+}
@@ -0,0 +1,224 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file LightBVHCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief CPU builder for the light BVH with support for incremental refits.
+ */
+
+#include "../../EngineDefines.h"
+#include "../BoundingBox.h"
+
+namespace Core
+{
+    class ThreadPool;
+}
+
+namespace Graphics
+{
+    struct PointLight;
+    struct SpotLight;
+
+    /**
+     * CPU builder for the light BVH.
+     * The BVH has the same layout as the BVH that is built by BuildBVH_CS.hlsl:
+     * every node has 32 children and the nodes of each level are stored
+     * consecutively starting with the root node at index 0. The leaves of the BVH
+     * are not stored explicitly, leaf i refers to light GetLightIndices()[i].
+     *
+     * Besides a full rebuild (Morton codes, sort, build) the BVH supports a refit
+     * which only recomputes the node bounds using the existing leaf order. In
+     * automatic mode the BVH is refitted as long as the quality of the tree is
+     * acceptable. The quality is measured as the summed surface area of the
+     * nodes relative to the summed surface area directly after the last rebuild.
+     *
+     * The lights are sorted by 30-bit Morton codes (10 bits per axis) by default.
+     * For dense light fields with millions of lights many lights end up with the
+     * same Morton code which results in loose BVH nodes. In that case 63-bit
+     * Morton codes (21 bits per axis) can be used.
+     */
+    class ENGINE_DLL LightBVHCPU
+    {
+    public:
+        // Each node of the BVH has 32 children.
+        static const uint32_t BranchingFactor = 32;
+        // The maximum number of levels of the BVH (excluding the leaves).
+        static const uint32_t MaxLevels = 6;
+
+        // The number of bits per axis of 30-bit Morton codes (ComputeLightMortonCodes_CS.hlsl).
+        static const uint32_t MortonCodeBits32 = 10;
+        // The number of bits per axis of 63-bit Morton codes (ComputeLightMortonCodes_CS.hlsl with MORTON_CODE_64).
+        static const uint32_t MortonCodeBits64 = 21;
+
+        /**
+         * Statistics that describe the quality of the BVH.
+         */
+        struct Statistics
+        {
+            uint32_t NumLeaves = 0;
+            uint32_t NumLevels = 0;
+            uint32_t NumNodes = 0;
+            // The number of leaves that have the same Morton code as the previous leaf.
+            uint32_t NumDuplicateMortonCodes = 0;
+            // The sum of the surface areas of all nodes.
+            float SurfaceArea = 0.0f;
+            // The summed volume of the pairwise intersections of sibling nodes
+            // relative to the summed volume of the nodes for each level of the BVH.
+            std::vector<float> LevelOverlap;
+            // The overlap of the sibling nodes of all levels of the BVH.
+            float NodeOverlap = 0.0f;
+        };
+
+        enum class BuildMode
+        {
+            Rebuild,    // Always rebuild the BVH.
+            Refit,      // Only refit the BVH (unless the number of lights changed).
+            Automatic,  // Refit if the quality of the tree is good enough, otherwise rebuild.
+        };
+
+        // Compute the number of levels needed for a BVH that consists of a number of leaf nodes.
+        static uint32_t GetNumLevels( uint32_t numLeaves );
+        // Compute the number of (child) nodes needed to represent a BVH that consists of a number of leaf nodes.
+        static uint32_t GetNumNodes( uint32_t numLeaves );
+        // The number of nodes at a level of the BVH.
+        static uint32_t GetNumLevelNodes( uint32_t level );
+        // The index of the first node at a level of the BVH.
+        static uint32_t GetFirstNodeIndex( uint32_t level );
+
+        /**
+         * Compute the view space AABB of all lights.
+         * CPU version of ReduceLightsAABB_CS.hlsl
+         */
+        static BoundingBox ComputeLightsAABB( const PointLight* pointLights, uint32_t numPointLights,
+                                              const SpotLight* spotLights, uint32_t numSpotLights,
+                                              Core::ThreadPool& threadPool );
+
+        LightBVHCPU();
+        explicit LightBVHCPU( Core::ThreadPool& threadPool );
+        virtual ~LightBVHCPU();
+
+        /**
+         * Build or refit the BVH for a set of lights.
+         * @param lightsAABB The AABB of all of the lights that is used to quantize the light positions.
+         * @returns true if the BVH was rebuilt, false if it was only refitted.
+         */
+        bool Build( const PointLight* lights, uint32_t numLights, const BoundingBox& lightsAABB, BuildMode buildMode = BuildMode::Automatic );
+        bool Build( const SpotLight* lights, uint32_t numLights, const BoundingBox& lightsAABB, BuildMode buildMode = BuildMode::Automatic );
+
+        /**
+         * Build the nodes of the BVH from an existing leaf order.
+         * This can be used to validate the BVH that was built on the GPU
+         * using the sorted light indices that were computed on the GPU.
+         */
+        void Build( const PointLight* lights, uint32_t numLights, const uint32_t* lightIndices );
+        void Build( const SpotLight* lights, uint32_t numLights, const uint32_t* lightIndices );
+
+        /**
+         * Set the number of bits per axis that are used to compute the Morton codes.
+         * This should be either MortonCodeBits32 or MortonCodeBits64 to match the
+         * Morton codes that are computed on the GPU.
+         * Changing the number of bits causes the next build to be a full rebuild.
+         */
+        void SetMortonCodeBits( uint32_t bitsPerAxis );
+        uint32_t GetMortonCodeBits() const;
+
+        /**
+         * The BVH is rebuilt in automatic build mode if the surface area of the
+         * refitted tree is larger than threshold times the surface area of the
+         * tree after the last rebuild. The surface area of the refitted tree is
+         * estimated before the tree is refitted so that the refit is skipped
+         * if the tree is going to be rebuilt anyways.
+         */
+        void SetRebuildThreshold( float threshold );
+        float GetRebuildThreshold() const;
+
+        // Discard the current tree. The next call to Build will perform a full rebuild.
+        void Invalidate();
+
+        const std::vector<BoundingBox>& GetNodes() const;
+        const std::vector<uint32_t>& GetLightIndices() const;
+        // The sorted Morton codes of the leaves (empty if the BVH was built from an existing leaf order).
+        const std::vector<uint64_t>& GetMortonCodes() const;
+
+        uint32_t GetNumLevels() const;
+        uint32_t GetNumLeaves() const;
+
+        // The surface area of the current tree relative to the tree after the last rebuild.
+        float GetCostRatio() const;
+
+        // The number of full rebuilds and refits since the BVH was created.
+        uint32_t GetNumRebuilds() const;
+        uint32_t GetNumRefits() const;
+
+        // Measure the quality of the current BVH.
+        Statistics ComputeStatistics() const;
+
+    private:
+        template<typename LightType>
+        bool BuildImpl( const LightType* lights, uint32_t numLights, const BoundingBox& lightsAABB, BuildMode buildMode );
+
+        template<typename LightType>
+        void BuildImpl( const LightType* lights, uint32_t numLights, const uint32_t* lightIndices );
+
+        template<typename LightType>
+        void ComputeMortonCodes( const LightType* lights, const BoundingBox& lightsAABB );
+
+        template<typename LightType>
+        void BuildNodes( const LightType* lights );
+
+        // Sum of the surface areas of all nodes.
+        float ComputeCost() const;
+
+        // Estimate the cost of the tree from a subset of the bottom level nodes
+        // using the current leaf order (without refitting the tree).
+        template<typename LightType>
+        float EstimateCost( const LightType* lights ) const;
+
+        Core::ThreadPool& m_ThreadPool;
+
+        std::vector<BoundingBox> m_Nodes;
+        std::vector<uint64_t> m_MortonCodes;
+        std::vector<uint32_t> m_LightIndices;
+
+        // Temporary buffers for sorting.
+        std::vector<uint64_t> m_TmpMortonCodes;
+        std::vector<uint32_t> m_TmpLightIndices;
+
+        uint32_t m_NumLeaves;
+        uint32_t m_NumLevels;
+        uint32_t m_MortonCodeBits;
+
+        float m_RebuildCost;
+        float m_RebuildEstimatedCost;
+        float m_Cost;
+        float m_RebuildThreshold;
+
+        uint32_t m_NumRebuilds;
+        uint32_t m_NumRefits;
+
+        bool m_IsValid;
+    };
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file LightGeneratorCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief Multithreaded, deterministic generation of random lights.
+ */
+
+#include "../../EngineDefines.h"
+
+namespace Core
+{
+    class ThreadPool;
+}
+
+namespace Graphics
+{
+    struct PointLight;
+    struct SpotLight;
+    struct DirectionalLight;
+
+    /**
+     * The parameters that are used to generate random lights.
+     */
+    struct LightGeneratorArgs
+    {
+        // The light positions are uniformly distributed within these bounds.
+        glm::vec3   MinBounds = glm::vec3( -1.0f );
+        glm::vec3   MaxBounds = glm::vec3( 1.0f );
+
+        // Spot light angle in degrees.
+        float       MinSpotAngle = 1.0f;
+        float       MaxSpotAngle = 60.0f;
+
+        float       MinRange = 1.0f;
+        float       MaxRange = 10.0f;
+
+        // Lights that are generated with the same seed are identical.
+        uint32_t    Seed = 0;
+    };
+
+    /**
+     * Multithreaded generator for random lights.
+     * Every random value is computed by hashing the seed, the light index and
+     * the light attribute (counter-based random numbers) so there is no RNG
+     * state that must be shared between threads. The lights are generated in
+     * batches of SIMD::Width and every light of a batch is computed with the
+     * same instructions, so the same seed produces bit-identical lights
+     * regardless of the number of threads (or the SIMD width) that is used.
+     */
+    class ENGINE_DLL LightGeneratorCPU
+    {
+    public:
+        LightGeneratorCPU();
+        explicit LightGeneratorCPU( Core::ThreadPool& threadPool );
+        virtual ~LightGeneratorCPU();
+
+        /**
+         * Generate numLights random lights.
+         * Point lights, spot lights and directional lights use different random
+         * numbers even if they are generated with the same seed.
+         */
+        void Generate( const LightGeneratorArgs& args, uint32_t numLights, std::vector<PointLight>& lights ) const;
+        void Generate( const LightGeneratorArgs& args, uint32_t numLights, std::vector<SpotLight>& lights ) const;
+        void Generate( const LightGeneratorArgs& args, uint32_t numLights, std::vector<DirectionalLight>& lights ) const;
+
+    private:
+        Core::ThreadPool& m_ThreadPool;
+    };
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file RadixSortCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief Parallel radix sort for the CPU implementations.
+ */
+
+#include "../../ThreadPool.h"
+
+namespace Graphics
+{
+    namespace RadixSortCPU
+    {
+        // The number of bits that are sorted in each pass of the radix sort.
+        constexpr uint32_t RadixBits = 8;
+        constexpr uint32_t RadixSize = 1 << RadixBits;
+        constexpr uint32_t RadixMask = RadixSize - 1;
+
+        // Don't split the sort into chunks smaller than this.
+        constexpr uint32_t MinElementsPerChunk = 16 * 1024;
+
+        /**
+         * Parallel least significant digit radix sort of key/value pairs.
+         * CPU counterpart of RadixSort_CS.hlsl and MergeSort_CS.hlsl.
+         * The sort is stable so sorting the same keys always produces the same order.
+         * @param keys The keys to sort. After sorting, contains the sorted keys.
+         * @param values The values to sort. After sorting, contains the sorted values.
+         * @param tmpKeys Temporary storage of at least numElements keys.
+         * @param tmpValues Temporary storage of at least numElements values.
+         * @param numKeyBits Only the lowest numKeyBits of the keys are sorted.
+         */
+        template<typename KeyType, typename ValueType>
+        void Sort( KeyType* keys, ValueType* values, KeyType* tmpKeys, ValueType* tmpValues, uint32_t numElements,
+                   uint32_t numKeyBits = sizeof( KeyType ) * 8, Core::ThreadPool& threadPool = Core::ThreadPool::Get() )
+        {
+            if ( numElements < 2 ) return;
+
+            uint32_t numPasses = ( numKeyBits + RadixBits - 1 ) / RadixBits;
+            uint32_t numChunks = std::max( 1u, std::min( threadPool.GetConcurrency() * 4, numElements / MinElementsPerChunk ) );
+            uint32_t chunkSize = ( numElements + numChunks - 1 ) / numChunks;
+
+            // Histogram of each chunk.
+            std::vector<uint32_t> histograms( numChunks * RadixSize );
+
+            KeyType* srcKeys = keys;
+            ValueType* srcValues = values;
+            KeyType* dstKeys = tmpKeys;
+            ValueType* dstValues = tmpValues;
+
+            for ( uint32_t pass = 0; pass < numPasses; ++pass )
+            {
+                uint32_t shift = pass * RadixBits;
+
+                threadPool.ParallelFor( 0, numChunks, 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+                {
+                    for ( uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk )
+                    {
+                        uint32_t* histogram = &histograms[chunk * RadixSize];
+                        std::fill( histogram, histogram + RadixSize, 0 );
+
+                        uint32_t first = chunk * chunkSize;
+                        uint32_t last = std::min( first + chunkSize, numElements );
+                        for ( uint32_t i = first; i < last; ++i )
+                        {
+                            ++histogram[( srcKeys[i] >> shift ) & RadixMask];
+                        }
+                    }
+                } );
+
+                // Compute the output offset of each digit in each chunk.
+                // Offsets are assigned in digit-major, chunk-minor order to make the sort stable.
+                uint32_t offset = 0;
+                bool allKeysEqual = false;
+                for ( uint32_t digit = 0; digit < RadixSize; ++digit )
+                {
+                    uint32_t digitStart = offset;
+                    for ( uint32_t chunk = 0; chunk < numChunks; ++chunk )
+                    {
+                        uint32_t count = histograms[chunk * RadixSize + digit];
+                        histograms[chunk * RadixSize + digit] = offset;
+                        offset += count;
+                    }
+                    allKeysEqual = allKeysEqual || ( offset - digitStart == numElements );
+                }
+
+                // If all keys have the same digit, this pass would not change the order.
+                if ( allKeysEqual ) continue;
+
+                threadPool.ParallelFor( 0, numChunks, 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+                {
+                    for ( uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk )
+                    {
+                        uint32_t* histogram = &histograms[chunk * RadixSize];
+
+                        uint32_t first = chunk * chunkSize;
+                        uint32_t last = std::min( first + chunkSize, numElements );
+                        for ( uint32_t i = first; i < last; ++i )
+                        {
+                            uint32_t index = histogram[( srcKeys[i] >> shift ) & RadixMask]++;
+                            dstKeys[index] = srcKeys[i];
+                            dstValues[index] = srcValues[i];
+                        }
+                    }
+                } );
+
+                std::swap( srcKeys, dstKeys );
+                std::swap( srcValues, dstValues );
+            }
+
+            // Make sure the final result ends up in the original buffers.
+            if ( srcKeys != keys )
+            {
+                std::copy( srcKeys, srcKeys + numElements, keys );
+                std::copy( srcValues, srcValues + numElements, values );
+            }
+        }
+
+        /**
+         * Sort key/value pairs stored in vectors.
+         * The temporary buffers are resized if needed.
+         */
+        template<typename KeyType, typename ValueType>
+        void Sort( std::vector<KeyType>& keys, std::vector<ValueType>& values, std::vector<KeyType>& tmpKeys, std::vector<ValueType>& tmpValues,
+                   uint32_t numKeyBits = sizeof( KeyType ) * 8, Core::ThreadPool& threadPool = Core::ThreadPool::Get() )
+        {
+            tmpKeys.resize( keys.size() );
+            tmpValues.resize( values.size() );
+
+            Sort( keys.data(), values.data(), tmpKeys.data(), tmpValues.data(), static_cast<uint32_t>( keys.size() ), numKeyBits, threadPool );
+        }
+    }
+}
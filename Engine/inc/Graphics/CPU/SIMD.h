@@ -0,0 +1,168 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file SIMD.h
+ *  @date October 18, 2026
+ *
+ *  @brief Helpers for the SSE/AVX code paths of the CPU implementations.
+ */
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#   define ENGINE_SIMD_AVX2 1
+#endif
+
+#if defined(__AVX__)
+#   define ENGINE_SIMD_AVX 1
+#endif
+
+// SSE2 is always available on x64. MSVC does not define __SSE4_1__ but
+// it is implied by /arch:AVX.
+#if defined(__SSE4_1__) || defined(__AVX__)
+#   define ENGINE_SIMD_SSE4 1
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#   define ENGINE_SIMD_SSE2 1
+#endif
+
+#if defined(ENGINE_SIMD_AVX)
+#   include <immintrin.h>
+#elif defined(ENGINE_SIMD_SSE4)
+#   include <smmintrin.h>
+#elif defined(ENGINE_SIMD_SSE2)
+#   include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+namespace Graphics
+{
+    namespace SIMD
+    {
+        // The number of floats that are processed by a single (widest) SIMD instruction.
+#if defined(ENGINE_SIMD_AVX)
+        constexpr uint32_t Width = 8;
+#elif defined(ENGINE_SIMD_SSE2)
+        constexpr uint32_t Width = 4;
+#else
+        constexpr uint32_t Width = 1;
+#endif
+
+        // Returns the index of the least significant set bit. Mask must not be 0.
+        inline uint32_t CountTrailingZeros( uint32_t mask )
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward( &index, mask );
+            return static_cast<uint32_t>( index );
+#else
+            return static_cast<uint32_t>( __builtin_ctz( mask ) );
+#endif
+        }
+
+        // Returns the number of set bits.
+        inline uint32_t CountBits( uint32_t mask )
+        {
+#if defined(_MSC_VER)
+            // __popcnt requires the POPCNT instruction which is not implied by SSE2.
+            mask = mask - ( ( mask >> 1 ) & 0x55555555u );
+            mask = ( mask & 0x33333333u ) + ( ( mask >> 2 ) & 0x33333333u );
+            return ( ( ( mask + ( mask >> 4 ) ) & 0x0f0f0f0fu ) * 0x01010101u ) >> 24;
+#else
+            return static_cast<uint32_t>( __builtin_popcount( mask ) );
+#endif
+        }
+
+        // Call func for the index of every set bit in mask.
+        template<typename Func>
+        inline void ForEachBit( uint32_t mask, Func func )
+        {
+            while ( mask )
+            {
+                func( CountTrailingZeros( mask ) );
+                mask &= mask - 1;
+            }
+        }
+
+        // Minimal wrapper around the widest SIMD float type so that kernels that
+        // process SIMD::Width floats at a time only have to be written once.
+        // Only exactly rounded (IEEE 754) operations are provided so that every
+        // SIMD width produces the same results.
+#if defined(ENGINE_SIMD_AVX)
+        using Floats = __m256;
+
+        inline Floats Set( float f ) { return _mm256_set1_ps( f ); }
+        inline Floats Load( const float* src ) { return _mm256_loadu_ps( src ); }
+        inline void Store( float* dst, Floats a ) { _mm256_storeu_ps( dst, a ); }
+        inline Floats Add( Floats a, Floats b ) { return _mm256_add_ps( a, b ); }
+        inline Floats Sub( Floats a, Floats b ) { return _mm256_sub_ps( a, b ); }
+        inline Floats Mul( Floats a, Floats b ) { return _mm256_mul_ps( a, b ); }
+        inline Floats Div( Floats a, Floats b ) { return _mm256_div_ps( a, b ); }
+        inline Floats Min( Floats a, Floats b ) { return _mm256_min_ps( a, b ); }
+        inline Floats Max( Floats a, Floats b ) { return _mm256_max_ps( a, b ); }
+        inline Floats Sqrt( Floats a ) { return _mm256_sqrt_ps( a ); }
+        // Floor of non-negative values.
+        inline Floats Floor( Floats a ) { return _mm256_floor_ps( a ); }
+#elif defined(ENGINE_SIMD_SSE2)
+        using Floats = __m128;
+
+        inline Floats Set( float f ) { return _mm_set1_ps( f ); }
+        inline Floats Load( const float* src ) { return _mm_loadu_ps( src ); }
+        inline void Store( float* dst, Floats a ) { _mm_storeu_ps( dst, a ); }
+        inline Floats Add( Floats a, Floats b ) { return _mm_add_ps( a, b ); }
+        inline Floats Sub( Floats a, Floats b ) { return _mm_sub_ps( a, b ); }
+        inline Floats Mul( Floats a, Floats b ) { return _mm_mul_ps( a, b ); }
+        inline Floats Div( Floats a, Floats b ) { return _mm_div_ps( a, b ); }
+        inline Floats Min( Floats a, Floats b ) { return _mm_min_ps( a, b ); }
+        inline Floats Max( Floats a, Floats b ) { return _mm_max_ps( a, b ); }
+        inline Floats Sqrt( Floats a ) { return _mm_sqrt_ps( a ); }
+        // Floor of non-negative values (truncation is the same as floor for positive numbers).
+#   if defined(ENGINE_SIMD_SSE4)
+        inline Floats Floor( Floats a ) { return _mm_floor_ps( a ); }
+#   else
+        inline Floats Floor( Floats a ) { return _mm_cvtepi32_ps( _mm_cvttps_epi32( a ) ); }
+#   endif
+#else
+        using Floats = float;
+
+        inline Floats Set( float f ) { return f; }
+        inline Floats Load( const float* src ) { return *src; }
+        inline void Store( float* dst, Floats a ) { *dst = a; }
+        inline Floats Add( Floats a, Floats b ) { return a + b; }
+        inline Floats Sub( Floats a, Floats b ) { return a - b; }
+        inline Floats Mul( Floats a, Floats b ) { return a * b; }
+        inline Floats Div( Floats a, Floats b ) { return a / b; }
+        inline Floats Min( Floats a, Floats b ) { return a < b ? a : b; }
+        inline Floats Max( Floats a, Floats b ) { return a > b ? a : b; }
+        inline Floats Sqrt( Floats a ) { return std::sqrt( a ); }
+        inline Floats Floor( Floats a ) { return std::floor( a ); }
+#endif
+    }
+}
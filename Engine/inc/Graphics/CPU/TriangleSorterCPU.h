@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file TriangleSorterCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief Back-to-front sorting of the triangles of transparent meshes.
+ */
+
+#include "../../EngineDefines.h"
+
+namespace Graphics
+{
+    /**
+     * Sorts the triangles of a mesh back-to-front by the distance of the centers
+     * of the triangles to the camera. Used for large transparent meshes (such as
+     * merged foliage cards) that can't be sorted per mesh.
+     * The distances are quantized to the range of the bounding sphere of the mesh
+     * and sorted with a radix sort. The sorted indices are cached and only sorted
+     * again if the camera moved more than a threshold since the last sort. The
+     * order of the previous sort is used as the starting point of the next sort
+     * which is usually almost sorted, so an insertion sort is tried first.
+     */
+    class ENGINE_DLL TriangleSorterCPU
+    {
+    public:
+        // The number of bits of the quantized distances.
+        static const uint32_t DistanceBits = 16;
+        // The insertion sort is only tried if at most 1 in MaxDescentsRatio triangles is
+        // out of order, and is abandoned for the radix sort after MaxMovesPerTriangle moves per triangle.
+        static const uint32_t MaxDescentsRatio = 16;
+        static const uint32_t MaxMovesPerTriangle = 4;
+
+        TriangleSorterCPU();
+        virtual ~TriangleSorterCPU();
+
+        /**
+         * Sort the triangles back-to-front.
+         * @param indices The indices of the triangles (3 per triangle).
+         * @param triangleCenters The object space centers of the triangles.
+         * @param numTriangles The number of triangles.
+         * @param boundingSphere The object space bounding sphere of the triangles (see Mesh::GetBoundingSphere).
+         * @param cameraPosition The object space position of the camera.
+         * @param threshold The triangles are not sorted again until the camera moved more
+         * than threshold times the radius of the bounding sphere.
+         * @returns true if the triangles were sorted again.
+         */
+        bool Sort( const uint32_t* indices, const glm::vec3* triangleCenters, uint32_t numTriangles,
+                   const glm::vec4& boundingSphere, const glm::vec3& cameraPosition, float threshold );
+
+        // Sort the triangles again on the next call to Sort.
+        void Invalidate();
+
+        /**
+         * The indices of the sorted triangles.
+         * 16-bit indices are used if all of the indices fit in 16 bits.
+         */
+        const void* GetIndices() const;
+        uint32_t GetNumIndices() const;
+        uint32_t GetIndexSize() const;
+
+        // Returns true if the last sort used the insertion sort instead of the radix sort.
+        bool WasIncremental() const;
+        /**
+         * Returns true if the last call to Sort changed the order of the triangles.
+         * Small camera movements often don't change the order, so the indices
+         * don't need to be copied to the GPU again.
+         */
+        bool WasOrderChanged() const;
+
+    private:
+        // Sort the keys by moving the triangles that are out of order.
+        // Returns false if the keys are not sorted after the maximum number of moves.
+        bool InsertionSort( uint64_t& numMoves );
+
+        // The triangles in sorted order and the quantized distances of the triangles.
+        std::vector<uint32_t> m_Order;
+        std::vector<uint32_t> m_Keys;
+        std::vector<uint32_t> m_TmpOrder;
+        std::vector<uint32_t> m_TmpKeys;
+
+        std::vector<uint32_t> m_Indices;
+        std::vector<uint16_t> m_ShortIndices;
+        bool m_UseShortIndices;
+
+        // The camera position of the last sort.
+        glm::vec3 m_CameraPosition;
+        bool m_IsSorted;
+        bool m_WasIncremental;
+        bool m_WasOrderChanged;
+    };
+}
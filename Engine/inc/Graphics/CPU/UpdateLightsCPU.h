@@ -0,0 +1,106 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file UpdateLightsCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief CPU implementation of the light update compute shader.
+ */
+
+#include "../../EngineDefines.h"
+
+namespace Core
+{
+    class ThreadPool;
+}
+
+namespace Graphics
+{
+    struct PointLight;
+    struct SpotLight;
+
+    /**
+     * Structure of arrays copy of the positions (and directions) of a set of lights.
+     * Positions are implicitly w = 1 and directions w = 0.
+     * The arrays are padded to a multiple of SIMD::Width lights.
+     */
+    struct LightTransformsSoA
+    {
+        // X, Y, and Z components.
+        std::vector<float> PositionWS[3];
+        std::vector<float> PositionVS[3];
+        // Only used for spot lights.
+        std::vector<float> DirectionWS[3];
+        std::vector<float> DirectionVS[3];
+
+        uint32_t NumLights = 0;
+        bool HasDirections = false;
+
+        void Resize( uint32_t numLights, bool hasDirections );
+
+        // The number of bytes that are read and written for every light by UpdateLightsCPU::Update.
+        size_t GetBytesPerLight( bool applyWorldMatrix ) const;
+    };
+
+    /**
+     * Multithreaded CPU implementation of UpdateLights_CS.hlsl.
+     * The lights can either be updated in place (AoS) with a single SSE 4x4
+     * matrix-vector product per light, or 8 (AVX) or 4 (SSE) lights at a time
+     * on a structure of arrays copy of the lights (SoA). The SoA results can be
+     * used directly by a CPU light culling pipeline or scattered back into the
+     * PointLight and SpotLight structures.
+     */
+    class ENGINE_DLL UpdateLightsCPU
+    {
+    public:
+        UpdateLightsCPU();
+        explicit UpdateLightsCPU( Core::ThreadPool& threadPool );
+        virtual ~UpdateLightsCPU();
+
+        /**
+         * Update the view space position (and direction) of the lights.
+         * @param applyWorldMatrix Transform the world space position (and direction)
+         * by the world matrix first (only used to animate the lights).
+         */
+        void Update( const glm::mat4& worldMatrix, const glm::mat4& viewMatrix, bool applyWorldMatrix, PointLight* lights, uint32_t numLights ) const;
+        void Update( const glm::mat4& worldMatrix, const glm::mat4& viewMatrix, bool applyWorldMatrix, SpotLight* lights, uint32_t numLights ) const;
+        void Update( const glm::mat4& worldMatrix, const glm::mat4& viewMatrix, bool applyWorldMatrix, LightTransformsSoA& lights ) const;
+
+        /**
+         * Copy the world space positions (and directions) of the lights into a structure of arrays.
+         */
+        void Gather( const PointLight* lights, uint32_t numLights, LightTransformsSoA& soa ) const;
+        void Gather( const SpotLight* lights, uint32_t numLights, LightTransformsSoA& soa ) const;
+
+        /**
+         * Copy the world space and view space positions (and directions) back into the lights.
+         */
+        void Scatter( const LightTransformsSoA& soa, PointLight* lights ) const;
+        void Scatter( const LightTransformsSoA& soa, SpotLight* lights ) const;
+
+    private:
+        Core::ThreadPool& m_ThreadPool;
+    };
+}
@@ -0,0 +1,184 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file ZBinningCPU.h
+ *  @date October 18, 2026
+ *
+ *  @brief CPU implementation of the Z-binning compute shaders.
+ */
+
+#include "../../EngineDefines.h"
+
+namespace Core
+{
+    class ThreadPool;
+}
+
+namespace Graphics
+{
+    struct PointLight;
+    struct SpotLight;
+
+    /**
+     * The view space side planes (left, right, top, bottom) of a screen tile.
+     * The plane normal is stored in xyz and the distance to the origin in w.
+     * This has the same layout as the Frustum structure in Structures.hlsli.
+     */
+    struct alignas( 16 ) TileFrustum
+    {
+        glm::vec4 Planes[4];
+    };
+
+    /**
+     * The lights and screen tiles that are used as input for Z-binning.
+     * The arrays are not owned by this structure.
+     */
+    struct ZBinningArgs
+    {
+        const PointLight*   PointLights = nullptr;
+        uint32_t            NumPointLights = 0;
+        const SpotLight*    SpotLights = nullptr;
+        uint32_t            NumSpotLights = 0;
+
+        // The frustums of the screen tiles.
+        const TileFrustum*  TileFrustums = nullptr;
+        uint32_t            NumTiles = 0;
+
+        // The Z-bins are distributed linearly between the near and far clipping planes.
+        float               ZNear = 0.1f;
+        float               ZFar = 1000.0f;
+        uint32_t            NumZBins = 4096;
+    };
+
+    /**
+     * The Z-bins and tile bitmasks for a single light type.
+     * This has the same layout as the PointLightZBins and PointLightTileMasks
+     * (or SpotLight*) structured buffers.
+     */
+    struct ZBinLightList
+    {
+        // The light indices sorted by view space depth.
+        std::vector<uint32_t> LightIndices;
+        // ( first, last ) index into LightIndices of the lights that overlap each Z-bin.
+        // If first > last, the Z-bin is empty.
+        std::vector<glm::uvec2> ZBins;
+        // NumWords 32-bit words per tile. Bit i is set if the i-th sorted light overlaps the tile.
+        std::vector<uint32_t> TileMasks;
+        uint32_t NumWords = 0;
+
+        // The number of bytes that are needed to store the light list.
+        size_t GetMemoryFootprint() const
+        {
+            return LightIndices.size() * sizeof( uint32_t ) + ZBins.size() * sizeof( glm::uvec2 ) + TileMasks.size() * sizeof( uint32_t );
+        }
+    };
+
+    /**
+     * Multithreaded CPU implementation of Z-binned light culling.
+     * The lights are sorted by view space depth, for every Z-bin the range of
+     * sorted lights that overlap the Z-bin is stored and for every screen tile
+     * a bitmask stores the sorted lights that overlap the tile.
+     * Unlike a cluster grid, the memory that is needed does not depend on the
+     * product of the number of tiles and the number of depth slices.
+     *
+     * The tile bitmasks do depend on the product of the number of tiles and the
+     * number of lights: every tile stores NumWords = ceil( lights / 32 ) words.
+     * Z-binning as it is used in games caps the number of lights per view to a
+     * few hundred so the bitmasks of a tile are only a few words. The light counts
+     * of this project are much larger (1080p with 32x32 tiles is 2,040 tiles, or
+     * 255 bytes per light) but the bitmasks are not compacted so that the pixel
+     * shader can find the words of a Z-bin by indexing the bitmask of its tile
+     * directly. Only the words in the range of the Z-bin are read (see GetLights)
+     * so shading cost is bounded by the Z-bin even though the memory is not.
+     * Lights are tested against the tiles 8 (AVX) or 4 (SSE) at a time.
+     * This is the CPU reference for DepthKeys in ComputeLightMortonCodes_CS.hlsl
+     * and BuildZBins_CS.hlsl.
+     */
+    class ENGINE_DLL ZBinningCPU
+    {
+    public:
+        // The number of bits of the depth sort keys (same as the compute shader).
+        static const uint32_t DepthKeyBits = 30;
+
+        ZBinningCPU();
+        explicit ZBinningCPU( Core::ThreadPool& threadPool );
+        virtual ~ZBinningCPU();
+
+        /**
+         * Compute the view space frustums of the screen tiles.
+         * CPU version of ComputeGridFrustums_CS.hlsl
+         */
+        static void ComputeTileFrustums( const glm::mat4& inverseProjection, uint32_t screenWidth, uint32_t screenHeight,
+                                         uint32_t tileSize, std::vector<TileFrustum>& tileFrustums );
+
+        // Compute the index of the Z-bin for a (positive) view space depth value.
+        static uint32_t ComputeZBin( const ZBinningArgs& args, float depth );
+
+        /**
+         * Sort the lights by depth and build the Z-bins and tile bitmasks.
+         */
+        void Build( const ZBinningArgs& args, ZBinLightList& pointLights, ZBinLightList& spotLights );
+
+        /**
+         * Get the (unsorted) indices of the lights that affect a Z-bin of a screen tile.
+         * This performs the same lookup as the Z-binned pixel shader.
+         */
+        static void GetLights( const ZBinLightList& lightList, uint32_t tileIndex, uint32_t zBin, std::vector<uint32_t>& lightIndices );
+
+    private:
+        // Sorted light spheres in structure of arrays layout.
+        struct LightSpheres
+        {
+            std::vector<float> X;
+            std::vector<float> Y;
+            std::vector<float> Z;
+            // The radius of the light (negative for disabled lights).
+            std::vector<float> Radius;
+
+            void Resize( uint32_t numLights );
+        };
+
+        template<typename LightType>
+        void BuildImpl( const LightType* lights, uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList );
+
+        template<typename LightType>
+        void SortLights( const LightType* lights, uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList );
+
+        void BuildZBins( uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList );
+        void BuildTileMasks( uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList );
+
+        Core::ThreadPool& m_ThreadPool;
+
+        LightSpheres m_Spheres;
+
+        // Temporary buffers for sorting.
+        std::vector<uint32_t> m_Keys;
+        std::vector<uint32_t> m_TmpKeys;
+        std::vector<uint32_t> m_TmpIndices;
+
+        // Z-bins of each chunk of lights (merged after all chunks are processed).
+        std::vector<glm::uvec2> m_ChunkZBins;
+    };
+}
@@ -4,6 +4,7 @@
 #include "../Events.h"
 #include "Viewport.h"
 #include "Ray.h"
+#include "Frustum.h"
 
 namespace Graphics
 {
@@ -92,6 +93,9 @@ namespace Graphics
         // Get the view projection inverse matrix (useful for picking)
         glm::mat4   GetViewProjectionInverseMatrix() const;
 
+        // Get the view frustum in world space.
+        Graphics::Frustum GetFrustum() const;
+
         // Converts a screen point to a ray in world space.
         Graphics::Ray   ScreenPointToRay( const glm::vec2& screenPoint ) const;
 
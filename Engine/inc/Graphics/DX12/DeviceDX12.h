@@ -166,9 +166,24 @@ namespace Graphics
 
         /**
          * Create texture from a file.
+         * Textures are cached by file name so a file is only loaded once.
          */
         std::shared_ptr<TextureDX12> CreateTexture( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const std::wstring& fileName );
 
+        /**
+         * Create a texture from an image that was decoded with TextureDX12::DecodeTexture2D
+         * (or cooked with TextureCookerDX12). Mipmaps are only generated for images with a single mip level.
+         * If a texture with the same file name was already created, the cached texture is returned.
+         */
+        std::shared_ptr<TextureDX12> CreateTexture( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const TextureImage& image );
+
+        /**
+         * Find a texture that was previously loaded from a file.
+         * Returns nullptr if the texture is not in the texture cache.
+         * This function is thread-safe.
+         */
+        std::shared_ptr<TextureDX12> FindTexture( const std::wstring& fileName ) const;
+
 
         /**
          * Create an empty 2D Texture
@@ -247,6 +262,9 @@ namespace Graphics
 
         std::unique_ptr<DescriptorAllocatorDX12> m_DescriptorAllocators[D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES];
         
+        // Textures that were loaded from a file.
+        // Scenes are imported on multiple threads so access to the texture map must be synchronized.
         TextureMap m_TextureMap;
+        mutable std::mutex m_TextureMapMutex;
     };
 }
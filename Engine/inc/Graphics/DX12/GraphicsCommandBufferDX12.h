@@ -209,6 +209,24 @@ namespace Graphics
          */
         void BindGraphicsDynamicStructuredBuffer( uint32_t slotID, size_t numElements, size_t elementSize, const void* bufferData );
 
+        /**
+         * Copy structured buffer data to the upload heap without binding it. Ranges of the
+         * elements can be bound with BindGraphicsShaderResourceView so the data of many
+         * draw calls is uploaded at once. The data must fit in a single page of the upload heap.
+         * @param numElements The number of structured elements in the structured buffer.
+         * @param elementSize The size of each element in the structured buffer.
+         * @param bufferData A pointer to the structured buffer data.
+         * @returns The GPU address of the first element (valid until the command buffer is executed).
+         */
+        D3D12_GPU_VIRTUAL_ADDRESS UploadDynamicStructuredBuffer( size_t numElements, size_t elementSize, const void* bufferData );
+
+        /**
+         * Bind a buffer by its GPU address to a root shader resource view of the graphics pipeline.
+         * @param slotID The slot or register to bind the buffer to.
+         * @param gpuAddress The GPU address of the first element of the buffer.
+         */
+        void BindGraphicsShaderResourceView( uint32_t slotID, D3D12_GPU_VIRTUAL_ADDRESS gpuAddress );
+
         /**
         * Bind an index buffer to the rendering pipeline.
         * @indexBuffer The index buffer object to bind to the rendering pipeline.
@@ -289,6 +307,15 @@ namespace Graphics
          */
         void SetStructuredBuffer( std::shared_ptr<StructuredBufferDX12> structuredBuffer, size_t numElements, size_t elementSize, const void* bufferData );
 
+        /**
+         * Update the contents of a structured buffer in place.
+         * Unlike SetStructuredBuffer, the buffer resource is not recreated. The data
+         * is staged in the upload heap of the command buffer and copied into the
+         * existing buffer. If the number of elements or the element size changed,
+         * the buffer is recreated with SetStructuredBuffer.
+         */
+        void UpdateStructuredBuffer( std::shared_ptr<StructuredBufferDX12> structuredBuffer, size_t numElements, size_t elementSize, const void* bufferData );
+
         /**
          * Set the contents of a texture (sub) resource.
          */
@@ -41,6 +41,10 @@ namespace Graphics
     {
         void* CpuPtr;
         D3D12_GPU_VIRTUAL_ADDRESS GpuAddress;
+        // The upload page that contains the allocation and the offset of the
+        // allocation in the page (used as the source of buffer copies).
+        ID3D12Resource* d3d12Resource;
+        size_t Offset;
     };
 
     class HeapAllocatorDX12
@@ -55,6 +59,12 @@ namespace Graphics
 
         HeapAllocation Allocate( size_t sizeInBytes, size_t alignment );
 
+        // The size of a single page. No more than a single page can be allocated at once.
+        uint64_t GetPageSize() const
+        {
+            return m_PageSize;
+        }
+
         /**
          * Release allocated buffers.
          * Should only be done if the CommandBuffer is finished with them.
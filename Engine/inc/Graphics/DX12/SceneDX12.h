@@ -34,7 +34,10 @@
 #include "../Mesh.h"
 #include "../SceneNode.h"
 #include "../Material.h"
+#include "../IndexOptimizer.h"
+#include "TextureCookerDX12.h"
 
+class DependencyTracker;
 class ProgressHandler;
 
 namespace Core
@@ -45,6 +48,9 @@ namespace Core
 namespace Graphics
 {
     class DeviceDX12;
+    class SceneFile;
+    class TextureStreamerDX12;
+    class TransformHierarchy;
 
     class SceneDX12
     {
@@ -70,12 +76,113 @@ namespace Graphics
 
         std::shared_ptr<SceneNode> GetRootNode() const;
 
+        /**
+         * The vertex format of the meshes of the scene.
+         * The vertex format must be set before the scene is loaded and
+         * the vertex shaders that are used to render the scene must be compiled
+         * for the same vertex format (COMPACT_VERTICES).
+         */
+        void SetVertexFormat( Mesh::VertexFormat vertexFormat );
+        Mesh::VertexFormat GetVertexFormat() const;
+
+        /**
+         * Reorder the triangles of the meshes to reduce overdraw when the scene is imported
+         * (see IndexOptimizer::OptimizeOverdraw). The triangles are always reordered for
+         * the post-transform vertex cache.
+         */
+        void SetOptimizeOverdraw( bool optimizeOverdraw );
+        bool GetOptimizeOverdraw() const;
+
+        /**
+         * The block compression of the textures of the scene (see TextureCookerDX12).
+         * The compression of the textures must be set before the scene is loaded.
+         */
+        void SetTextureCompression( TextureCompression textureCompression );
+        TextureCompression GetTextureCompression() const;
+
+        /**
+         * Stream the mip levels of the cooked textures of the scene. If a texture streamer
+         * is set before the scene is loaded, only the smallest mip levels of the textures
+         * are loaded and the textures are added to the texture streamer.
+         */
+        void SetTextureStreamer( std::shared_ptr<TextureStreamerDX12> textureStreamer );
+        std::shared_ptr<TextureStreamerDX12> GetTextureStreamer() const;
+
+        /**
+         * Keep a copy of the triangles of large transparent meshes on the CPU (see Mesh::SetTriangles)
+         * so the triangles can be sorted back-to-front. Must be set before the scene is loaded.
+         */
+        void SetSortTransparentTriangles( bool sortTransparentTriangles );
+        bool GetSortTransparentTriangles() const;
+
         void Accept( Core::SceneVisitor& visitor );
 
         friend class ProgressHandler;
 
-        void ImportMaterial( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const aiMaterial& material, fs::path parentPath );
-        void ImportMesh( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const aiMesh& mesh );
+        // A texture of a material that is loaded when the scene is imported.
+        struct MaterialTexture
+        {
+            std::shared_ptr<Material> TargetMaterial;
+            Material::TextureType TextureType;
+            std::wstring FileName;
+            // Textures in the bump map slot can also be normal maps (see ImportScene).
+            bool IsBumpMap;
+        };
+
+        // The vertex and index data of a mesh in the layout of the vertex and index buffers.
+        struct MeshData
+        {
+            // Only used for the standard vertex format.
+            std::vector<Mesh::Vertex> Vertices;
+            // Only used for the compact vertex format.
+            std::vector<Mesh::CompactVertex> CompactVertices;
+            glm::mat4 PositionTransform;
+            // Object space bounds of the vertices (see Mesh::SetBounds).
+            BoundingBox Bounds;
+            glm::vec4 BoundingSphere;
+            // Only used if the mesh has more than 65536 vertices.
+            std::vector<unsigned int> Indices;
+            // Only used if the mesh has at most 65536 vertices.
+            std::vector<uint16_t> ShortIndices;
+            std::vector<Meshlet> Meshlets;
+            // The vertex cache statistics before and after the indices were optimized.
+            VertexCacheStatistics OriginalStatistics;
+            VertexCacheStatistics OptimizedStatistics;
+        };
+
+        /**
+         * Import the materials, meshes and nodes of an assimp scene.
+         * The textures are decoded and the meshes are converted in parallel on
+         * the thread pool. The textures and meshes are uploaded and the scene
+         * nodes are created on the calling thread afterwards.
+         * If sceneFilePath is not empty, the imported scene is also written to a cooked scene file
+         * and the dependency tracker (if not null) records that the cooked scene file is up to date.
+         * Returns false if loading was canceled.
+         */
+        bool ImportScene( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const aiScene& scene, const fs::path& parentPath, const std::wstring& fileName, const fs::path& sceneFilePath,
+                          DependencyTracker* dependencyTracker = nullptr );
+        /**
+         * Cook (or load the cooked version of) the textures of the materials on the thread pool,
+         * upload them and assign them to the materials.
+         * The conversion of the meshes (convertMesh is invoked for the mesh indices [0, numMeshes)) is
+         * done in the same parallel pass.
+         * Returns false if loading was canceled.
+         */
+        bool LoadTextures( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const std::vector<MaterialTexture>& materialTextures, const std::wstring& fileName,
+                           uint32_t numMeshes = 0, const std::function<void( uint32_t )>& convertMesh = nullptr );
+        /**
+         * Load a cooked scene file. The vertices and indices are uploaded
+         * directly from the memory mapped scene file.
+         * Returns false if loading was canceled.
+         */
+        bool LoadSceneFile( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const SceneFile& sceneFile, const fs::path& parentPath, const std::wstring& fileName );
+        // Write the imported scene to a cooked scene file.
+        bool SaveSceneFile( const fs::path& sceneFilePath, const aiScene& scene, const fs::path& parentPath, const std::vector<MaterialTexture>& materialTextures, const std::vector<MeshData>& meshData ) const;
+        // Import the material parameters and add the textures of the material to the list of textures to load.
+        std::shared_ptr<Material> ImportMaterial( const aiMaterial& material, const fs::path& parentPath, std::vector<MaterialTexture>& textures );
+        // Convert the vertices and indices of a mesh. This function is thread-safe.
+        static void ConvertMesh( const aiMesh& mesh, Mesh::VertexFormat vertexFormat, bool optimizeOverdraw, MeshData& meshData );
+        void ImportMesh( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const aiMesh& mesh, const MeshData& meshData );
         std::shared_ptr<SceneNode> ImportSceneNode( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, std::shared_ptr<SceneNode> parent, aiNode* aiNode );
 
         using MaterialMap = std::map<std::string, std::shared_ptr<Material> >;
@@ -89,6 +196,14 @@ namespace Graphics
         MeshList m_Meshes;
 
         std::shared_ptr<SceneNode> m_RootNode;
+        // The cached transforms of the nodes.
+        std::shared_ptr<TransformHierarchy> m_TransformHierarchy;
+
+        Mesh::VertexFormat m_VertexFormat;
+        bool m_OptimizeOverdraw;
+        TextureCompression m_TextureCompression;
+        std::shared_ptr<TextureStreamerDX12> m_TextureStreamer;
+        bool m_SortTransparentTriangles;
 
         std::wstring m_SceneFile;
     };
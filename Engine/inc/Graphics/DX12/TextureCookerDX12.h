@@ -0,0 +1,112 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file TextureCookerDX12.h
+ *  @date October 18, 2026
+ *
+ *  @brief Offline texture cooking: CPU mip chains, block compression and cached DDS
+ *  files.
+ */
+
+#include "../../EngineDefines.h"
+
+namespace Graphics
+{
+    struct TextureImage;
+
+    /**
+     * How a texture is used by a material. The usage determines how the
+     * mip chain is filtered and which block compression format is used.
+     */
+    enum class TextureUsage
+    {
+        Color,          // Colors are filtered in linear space and compressed to BC1 (or BC3 with alpha).
+        NormalMap,      // Normals are renormalized and the X and Y components are compressed to BC5.
+        Grayscale,      // Single channel data (specular power, opacity) is compressed to BC4.
+        Bump,           // Normal map if the image has at least 24 bits per pixel, grayscale otherwise.
+    };
+
+    enum class TextureCompression
+    {
+        None,           // Textures are not cooked and the mip chain is generated on the GPU.
+        Default,        // Color textures are compressed to BC1 or BC3.
+        HighQuality,    // Color textures are compressed to BC7.
+    };
+
+    /**
+     * Cooks textures offline: the mip chain is built on the CPU and the mip levels
+     * are block compressed. Cooked textures are cached in a DDS file next to the
+     * source image and are cooked again if the source image changes.
+     */
+    class ENGINE_DLL TextureCookerDX12
+    {
+    public:
+        /**
+         * Load the cooked version of a texture file. The texture is cooked if the
+         * cached DDS file is missing or out of date. If the texture can't be cooked,
+         * the decoded image is returned (with a single mip level).
+         * This function is thread-safe. The blocks of a texture are compressed on
+         * the thread pool.
+         * @param maxDimension If not 0, only the mip levels of the cooked texture that
+         * are not larger than maxDimension are returned (see LoadDDS).
+         * @param cancel If not null, cooking stops (and false is returned) when
+         * the flag is set. The flag is checked for every mip level.
+         */
+        static bool LoadTexture2D( const std::wstring& fileName, TextureUsage usage, TextureCompression compression, TextureImage& image, uint32_t maxDimension = 0, const std::atomic<bool>* cancel = nullptr );
+
+        /**
+         * Build the mip chain of an image that was decoded with TextureDX12::DecodeTexture2D
+         * and compress all mip levels. Returns false if the format or the dimensions of
+         * the image are not supported by the block compression formats or if cooking
+         * was canceled with the cancel flag (see LoadTexture2D).
+         */
+        static bool CookTexture2D( const TextureImage& source, TextureUsage usage, TextureCompression compression, TextureImage& cooked, const std::atomic<bool>* cancel = nullptr );
+
+        /**
+         * Save a (cooked) image to a DDS file.
+         */
+        static bool SaveDDS( const fs::path& filePath, const TextureImage& image );
+
+        /**
+         * Load an image from a DDS file that was saved with SaveDDS.
+         * @param maxDimension If not 0, the mip levels that are larger than maxDimension
+         * are skipped. The first mip level that is loaded must be a multiple of the block
+         * size so more mip levels may be loaded. The index of the first mip level that is
+         * loaded is stored in image.MostDetailedMip.
+         */
+        static bool LoadDDS( const fs::path& filePath, TextureImage& image, uint32_t maxDimension = 0 );
+
+        /**
+         * Get the index of the first mip level that is loaded by LoadDDS for a texture
+         * with the given dimensions and number of mip levels.
+         */
+        static uint32_t GetMostDetailedMip( uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t maxDimension );
+
+        /**
+         * Get the size in bytes of the first mipLevels mip levels of an image.
+         */
+        static size_t GetImageSize( uint32_t width, uint32_t height, uint32_t mipLevels, DXGI_FORMAT format );
+    };
+}
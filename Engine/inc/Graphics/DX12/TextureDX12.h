@@ -38,6 +38,34 @@ namespace Graphics
     class DeviceDX12;
     class ResourceDX12;
 
+    /**
+     * The decoded pixels of a texture file.
+     * Decoding an image does not access the device so it can be done on any
+     * thread (see TextureDX12::DecodeTexture2D).
+     */
+    struct TextureImage
+    {
+        // The file name that was used to load the image.
+        std::wstring FileName;
+        // The path of the file that was found in the asset search paths.
+        fs::path FilePath;
+
+        DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        uint64_t Pitch = 0;
+        uint8_t BPP = 0;
+        bool IsTransparent = false;
+        // The number of mip levels in Pixels. The mip levels are stored one after another.
+        // The mip chain of images with a single mip level is generated on the GPU.
+        uint32_t MipLevels = 1;
+        // The mip level of the source image that is stored in the first mip level of Pixels.
+        // Streamed textures only load the smaller mip levels (see TextureStreamerDX12).
+        uint32_t MostDetailedMip = 0;
+
+        std::vector<uint8_t> Pixels;
+    };
+
     class TextureDX12 : public ResourceDX12, public std::enable_shared_from_this<TextureDX12>
     {
     public:
@@ -70,6 +98,23 @@ namespace Graphics
         */
         bool LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const std::wstring& fileName );
 
+        /**
+         * Load a 2D texture from an image that was decoded with DecodeTexture2D.
+         */
+        bool LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const TextureImage& image );
+
+        /**
+         * Decode a 2D texture file without creating the texture resource.
+         * This function is thread-safe.
+         */
+        static bool DecodeTexture2D( const std::wstring& fileName, TextureImage& image );
+
+        /**
+         * Find a texture file in the asset search paths.
+         * This function is thread-safe.
+         */
+        static bool FindTextureFile( const std::wstring& fileName, fs::path& filePath );
+
         /**
         * Get the filename that was used to load this texture.
         * If this texture was not loaded from a file, this function will return an empty string.
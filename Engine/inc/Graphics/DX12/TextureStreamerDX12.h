@@ -0,0 +1,152 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file TextureStreamerDX12.h
+ *  @date October 18, 2026
+ *
+ *  @brief Streams the mip levels of cooked textures within a memory budget.
+ */
+
+#include "../../EngineDefines.h"
+
+#include <future>
+
+namespace Graphics
+{
+    class Camera;
+    class CopyCommandBuffer;
+    class Mesh;
+    class SceneDX12;
+    class Texture;
+    class TextureDX12;
+    struct TextureImage;
+
+    /**
+     * Streams the mip levels of cooked textures. Streamed textures are created with only
+     * their smallest mip levels (see SceneDX12::SetTextureStreamer). The more detailed
+     * mip levels are loaded on the thread pool in the order of the screen-space size of
+     * the meshes that use the textures. If the streamed textures don't fit in the memory
+     * budget, the mip levels of the least useful textures are evicted.
+     * The mip levels are changed by recreating the texture resource with a different
+     * number of mip levels. The materials keep referencing the same texture.
+     */
+    class ENGINE_DLL TextureStreamerDX12
+    {
+    public:
+        // The largest dimension of the mip levels that are loaded when a streamed texture is created.
+        static const uint32_t MinResidentSize = 64;
+        // The maximum number of mip level loads that are in flight.
+        static const uint32_t MaxPendingLoads = 4;
+
+        TextureStreamerDX12();
+        ~TextureStreamerDX12();
+
+        /**
+         * The maximum size in bytes of the mip levels of the streamed textures.
+         * The smallest mip levels of the textures are always resident.
+         */
+        void SetMemoryBudget( size_t memoryBudget );
+        size_t GetMemoryBudget() const;
+
+        /**
+         * The size in bytes of the mip levels of the streamed textures that are resident.
+         */
+        size_t GetResidentSize() const;
+
+        /**
+         * The number of streamed textures.
+         */
+        size_t GetNumTextures() const;
+
+        /**
+         * Stream the mip levels of a texture that was created from a cooked image.
+         * Textures that were not cooked are ignored.
+         * This function is thread-safe.
+         */
+        void AddTexture( std::shared_ptr<TextureDX12> texture, const TextureImage& image );
+
+        /**
+         * The meshes of the scene determine the mip levels that are needed.
+         */
+        void AddScene( std::shared_ptr<SceneDX12> scene );
+
+        /**
+         * Upload the mip levels that finished loading, update the mip levels that are
+         * needed for the camera and start loading the mip levels with the highest priority.
+         * This function must be called once per frame before the scene is rendered.
+         */
+        void Update( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const Camera& camera );
+
+    private:
+        struct StreamedTexture
+        {
+            std::shared_ptr<TextureDX12> Texture;
+            // The cooked texture file.
+            fs::path FilePath;
+            // The dimensions of the most detailed mip level.
+            uint32_t Width;
+            uint32_t Height;
+            uint32_t MipLevels;
+            // The size in bytes of the mip chain starting at each mip level.
+            std::vector<size_t> MipChainSizes;
+            // The smallest mip levels that are always resident.
+            uint32_t TailMip;
+            // The most detailed mip level that is resident.
+            uint32_t ResidentMip;
+            // The most detailed mip level that is being loaded (or ResidentMip).
+            uint32_t PendingMip;
+            // The most detailed mip level that is needed for the current camera.
+            uint32_t DesiredMip;
+            // The largest size in pixels of the meshes that use the texture.
+            float ScreenSize;
+            // Streaming stops if a mip level can't be loaded.
+            bool Failed;
+        };
+
+        struct PendingLoad
+        {
+            size_t TextureIndex;
+            std::shared_ptr<TextureImage> Image;
+            std::future<void> Future;
+        };
+
+        // Update the desired mip level and screen size of the textures of the meshes in the scenes.
+        void UpdateDesiredMips( const Camera& camera );
+        // Start loading the mip chain of a texture starting at the given mip level.
+        void LoadMips( size_t textureIndex, uint32_t mip );
+        // The number of screen pixels per texel of a mip level of a texture.
+        float GetPriority( const StreamedTexture& texture, uint32_t mip ) const;
+
+        mutable std::mutex m_Mutex;
+
+        std::vector<StreamedTexture> m_Textures;
+        std::map<const Texture*, size_t> m_TextureIndices;
+        std::vector<std::shared_ptr<SceneDX12>> m_Scenes;
+
+        std::list<PendingLoad> m_PendingLoads;
+
+        size_t m_MemoryBudget;
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file Frustum.h
+ *  @date October 18, 2026
+ *
+ *  @brief View frustum planes.
+ */
+
+#include "../EngineDefines.h"
+
+namespace Graphics
+{
+    /**
+     * The six planes of a view frustum.
+     * The plane normals point to the inside of the frustum.
+     */
+    struct Frustum
+    {
+        enum Plane
+        {
+            Left,
+            Right,
+            Bottom,
+            Top,
+            Near,
+            Far,
+            NumPlanes
+        };
+
+        glm::vec4 Planes[NumPlanes];
+
+        Frustum()
+        {}
+
+        /**
+         * Extract the frustum planes from a (model) view projection matrix (with NDC z in the range [0..1]).
+         * The planes are in the space that is transformed by the matrix (object space for a model view projection matrix).
+         * Source: Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix (2001),
+         * Gil Gribb and Klaus Hartmann.
+         */
+        explicit Frustum( const glm::mat4& viewProjection )
+        {
+            glm::vec4 row0( viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0] );
+            glm::vec4 row1( viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1] );
+            glm::vec4 row2( viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2] );
+            glm::vec4 row3( viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3] );
+
+            Planes[Left] = row3 + row0;
+            Planes[Right] = row3 - row0;
+            Planes[Bottom] = row3 + row1;
+            Planes[Top] = row3 - row1;
+            Planes[Near] = row2;
+            Planes[Far] = row3 - row2;
+
+            // Normalize the planes so that the distance to the planes can be computed.
+            for ( uint32_t i = 0; i < NumPlanes; ++i )
+            {
+                Planes[i] /= glm::length( glm::vec3( Planes[i] ) );
+            }
+        }
+
+        // Check to see if a sphere is (partially) inside the frustum.
+        bool Intersects( const glm::vec3& center, float radius ) const
+        {
+            for ( uint32_t i = 0; i < NumPlanes; ++i )
+            {
+                if ( glm::dot( glm::vec3( Planes[i] ), center ) + Planes[i].w < -radius )
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file LightSetFile.h
+ *  @date October 18, 2026
+ *
+ *  @brief Binary light set file that can be memory mapped.
+ */
+
+#include "../EngineDefines.h"
+#include "../MemoryMappedFile.h"
+#include "../NonCopyable.h"
+
+namespace Graphics
+{
+    struct PointLight;
+    struct SpotLight;
+    struct DirectionalLight;
+
+    /**
+     * A binary file that stores a set of lights.
+     * The lights are stored with exactly the same layout as the PointLight, SpotLight
+     * and DirectionalLight structures (which match the GPU light buffers). The file
+     * is memory mapped so the light arrays can be copied to the GPU (or to a std::vector)
+     * without parsing the individual lights.
+     *
+     * File layout (all offsets are 16-byte aligned):
+     *   LightSetFile::Header
+     *   PointLight[NumPointLights]
+     *   SpotLight[NumSpotLights]
+     *   DirectionalLight[NumDirectionalLights]
+     */
+    class ENGINE_DLL LightSetFile : public Core::NonCopyable
+    {
+    public:
+        // Increment the version if the file layout or any of the light structures change.
+        static const uint32_t FileVersion = 1;
+
+        struct Header
+        {
+            char        Magic[4];           // "LSET"
+            uint32_t    Version;
+            // The size of the light structures that were used to write the file.
+            uint32_t    PointLightSize;
+            uint32_t    SpotLightSize;
+            uint32_t    DirectionalLightSize;
+            uint32_t    NumPointLights;
+            uint32_t    NumSpotLights;
+            uint32_t    NumDirectionalLights;
+            // Offsets (in bytes) from the start of the file.
+            uint64_t    PointLightsOffset;
+            uint64_t    SpotLightsOffset;
+            uint64_t    DirectionalLightsOffset;
+            uint64_t    Padding;
+        };
+
+        LightSetFile();
+        virtual ~LightSetFile();
+
+        /**
+         * Memory map a light set file.
+         * @returns false if the file could not be opened or is not a valid light set file.
+         */
+        bool Open( const std::wstring& fileName );
+        void Close();
+
+        bool IsOpen() const;
+
+        const PointLight* GetPointLights() const;
+        uint32_t GetNumPointLights() const;
+
+        const SpotLight* GetSpotLights() const;
+        uint32_t GetNumSpotLights() const;
+
+        const DirectionalLight* GetDirectionalLights() const;
+        uint32_t GetNumDirectionalLights() const;
+
+        /**
+         * Write a light set file.
+         * @returns false if the file could not be written.
+         */
+        static bool Save( const std::wstring& fileName, const PointLight* pointLights, uint32_t numPointLights,
+                          const SpotLight* spotLights, uint32_t numSpotLights,
+                          const DirectionalLight* directionalLights, uint32_t numDirectionalLights );
+
+    private:
+        // Check the header of the mapped file.
+        bool Validate() const;
+
+        const Header& GetHeader() const;
+
+        Core::MemoryMappedFile m_File;
+    };
+}
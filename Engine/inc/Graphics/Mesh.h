@@ -30,6 +30,8 @@
  */
 
 #include "../EngineDefines.h"
+#include "BoundingBox.h"
+#include "Meshlet.h"
 
 namespace Core
 {
@@ -56,6 +58,27 @@ namespace Graphics
             glm::vec3 TexCoord;
         };
 
+        /**
+         * Compressed vertex layout (20 bytes instead of 64 bytes).
+         * Positions are quantized to the bounds of the mesh, normals and tangents are
+         * octahedral encoded and the bitangent is reconstructed from the normal and tangent.
+         * See VertexCompression for the encoding.
+         */
+        struct CompactVertex
+        {
+            uint16_t Position[4];   // UNORM16 position relative to the mesh bounds (w stores the sign of the bitangent).
+            int16_t  Normal[2];     // SNORM16 octahedral encoded normal.
+            int16_t  Tangent[2];    // SNORM16 octahedral encoded tangent.
+            uint16_t TexCoord[2];   // Half float texture coordinate.
+        };
+
+        // The layout of the vertices in the vertex buffer of the mesh.
+        enum class VertexFormat : uint32_t
+        {
+            Standard,   // Vertex
+            Compact,    // CompactVertex
+        };
+
         Mesh( std::shared_ptr<Device> device );
         virtual ~Mesh();
 
@@ -65,8 +88,84 @@ namespace Graphics
         void SetMaterial( std::shared_ptr<Material> material );
         std::shared_ptr<Material> GetMaterial() const;
 
+        void SetVertexFormat( VertexFormat vertexFormat );
+        VertexFormat GetVertexFormat() const;
+
+        /**
+         * Compact vertices store the positions relative to the bounds of the mesh.
+         * The position transform transforms the decoded vertex positions to object space
+         * and must be applied to the model matrix of the mesh before rendering.
+         */
+        void SetPositionTransform( const glm::mat4& positionTransform );
+        const glm::mat4& GetPositionTransform() const;
+
+        /**
+         * The meshlets of the mesh (see MeshletBuilder).
+         * Meshes without meshlets can only be rendered as a whole.
+         */
+        void SetMeshlets( std::vector<Meshlet> meshlets );
+        const std::vector<Meshlet>& GetMeshlets() const;
+
+        /**
+         * The object space bounds of the mesh (before the position transform is applied).
+         * The bounds are computed from the vertex positions when the mesh is imported.
+         * Meshes without (valid) bounds are never culled.
+         * @param bounds The axis-aligned bounding box of the vertices.
+         * @param boundingSphere The center (xyz) and radius (w) of the bounding sphere of the vertices.
+         */
+        void SetBounds( const BoundingBox& bounds, const glm::vec4& boundingSphere );
+        const BoundingBox& GetBounds() const;
+        const glm::vec4& GetBoundingSphere() const;
+
+        /**
+         * Compute the bounding box and the bounding sphere of the positions of the vertices.
+         * The sphere is centered on the bounding box, which is tighter than the sphere
+         * around the bounding box for elongated meshes.
+         */
+        static void ComputeBounds( const Vertex* vertices, size_t numVertices, BoundingBox& bounds, glm::vec4& boundingSphere );
+
+        /**
+         * A copy of the triangles of the mesh on the CPU.
+         * Only large transparent meshes keep their triangles so the triangles
+         * can be sorted back-to-front (see TriangleSorterCPU).
+         * @param indices The indices of the triangles (3 per triangle).
+         * @param triangleCenters The object space center of each triangle.
+         */
+        void SetTriangles( std::vector<uint32_t> indices, std::vector<glm::vec3> triangleCenters );
+        const std::vector<uint32_t>& GetTriangleIndices() const;
+        const std::vector<glm::vec3>& GetTriangleCenters() const;
+        bool HasTriangles() const;
+
         virtual void Render( Core::RenderEventArgs& renderArgs, uint32_t instanceCount = 1, uint32_t firstInstance = 0 );
 
+        /**
+         * Render a subset of the meshlets of the mesh.
+         * Adjacent meshlets in the index buffer are rendered with a single draw call.
+         * @param meshletIndices The indices of the meshlets to render in ascending order.
+         */
+        virtual void RenderMeshlets( Core::RenderEventArgs& renderArgs, const uint32_t* meshletIndices, size_t numMeshlets, uint32_t instanceCount = 1, uint32_t firstInstance = 0 );
+
+        /**
+         * Render the mesh with indices that are uploaded from the CPU instead of the index buffer of the mesh.
+         * Used to render the triangles of the mesh in a different order (see TriangleSorterCPU).
+         * @param indexSize The size of an index in bytes (2 or 4).
+         */
+        virtual void RenderIndices( Core::RenderEventArgs& renderArgs, const void* indices, size_t numIndices, size_t indexSize, uint32_t instanceCount = 1, uint32_t firstInstance = 0 );
+
+        /**
+         * Render the mesh with an index buffer other than the index buffer of the mesh.
+         * Used to render indices that don't change every frame without uploading them again (see CreateIndexBuffer).
+         */
+        virtual void RenderIndices( Core::RenderEventArgs& renderArgs, std::shared_ptr<IndexBuffer> indexBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0 );
+
+        /**
+         * Copy indices from the CPU to a new index buffer with the command buffer of the render arguments.
+         * The index buffer can be used before the command buffer is executed.
+         * @param indexSize The size of an index in bytes (2 or 4).
+         * @returns nullptr if there is no command buffer to copy the indices with.
+         */
+        std::shared_ptr<IndexBuffer> CreateIndexBuffer( Core::RenderEventArgs& renderArgs, const void* indices, size_t numIndices, size_t indexSize ) const;
+
         virtual void Accept( Core::SceneVisitor& visitor );
 
     protected:
@@ -79,5 +178,16 @@ namespace Graphics
         BufferMap m_VertexBuffers;
         std::shared_ptr<IndexBuffer> m_IndexBuffer;
         std::shared_ptr<Material> m_Material;
+
+        VertexFormat m_VertexFormat;
+        glm::mat4 m_PositionTransform;
+
+        std::vector<Meshlet> m_Meshlets;
+
+        BoundingBox m_Bounds;
+        glm::vec4 m_BoundingSphere;
+
+        std::vector<uint32_t> m_TriangleIndices;
+        std::vector<glm::vec3> m_TriangleCenters;
     };
 }
\ No newline at end of file
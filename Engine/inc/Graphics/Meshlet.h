@@ -0,0 +1,58 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file Meshlet.h
+ *  @date October 18, 2026
+ *
+ *  @brief A cluster of triangles of a mesh.
+ */
+
+#include "../EngineDefines.h"
+
+namespace Graphics
+{
+    /**
+     * A small cluster of triangles of a mesh.
+     * Every meshlet is a contiguous range of the index buffer of the mesh so that the
+     * meshlets that pass the culling tests can be rendered with regular draw calls.
+     * The bounds of the meshlet are in object space (before the position transform of
+     * meshes with compact vertices is applied).
+     * See MeshletBuilder for the construction and culling of meshlets.
+     */
+    struct alignas( 16 ) Meshlet
+    {
+        // xyz: The center of the bounding sphere, w: The radius of the bounding sphere.
+        glm::vec4   BoundingSphere;
+        // xyz: The axis of the normal cone, w: The sine of the angle of the normal cone
+        // (1 if the meshlet can't be back-face culled).
+        glm::vec4   NormalCone;
+        //--------------------------------------------------------------( 32 bytes )
+        uint32_t    FirstIndex;
+        uint32_t    NumIndices;
+        uint32_t    NumVertices;        // The number of unique vertices that are referenced by the meshlet.
+        uint32_t    Padding;
+        //--------------------------------------------------------------( 48 bytes )
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file MeshletBuilder.h
+ *  @date October 18, 2026
+ *
+ *  @brief Meshlet generation and culling.
+ */
+
+#include "../EngineDefines.h"
+#include "Mesh.h"
+#include "Meshlet.h"
+#include "Frustum.h"
+
+namespace Graphics
+{
+    /**
+     * Split meshes into meshlets and cull meshlets on the CPU.
+     */
+    class ENGINE_DLL MeshletBuilder
+    {
+    public:
+        // The default size of the meshlets.
+        static const uint32_t DefaultMaxVertices = 64;
+        static const uint32_t DefaultMaxTriangles = 124;
+
+        /**
+         * Split the triangles of a mesh into meshlets.
+         * The triangles are assigned to the meshlets in the order of the index buffer so the
+         * index buffer should already be optimized (see IndexOptimizer). The index buffer is not modified.
+         * @param maxVertices The maximum number of unique vertices of a meshlet.
+         * @param maxTriangles The maximum number of triangles of a meshlet.
+         */
+        static void Build( const uint32_t* indices, size_t numIndices, const Mesh::Vertex* vertices, size_t numVertices, std::vector<Meshlet>& meshlets,
+                           uint32_t maxVertices = DefaultMaxVertices, uint32_t maxTriangles = DefaultMaxTriangles );
+
+        /**
+         * Check to see if all of the triangles of a meshlet are facing away from the camera.
+         * This is only valid for meshes that are rendered with back-face culling
+         * (and counter-clockwise front faces).
+         * @param cameraPosition The position of the camera in object space.
+         */
+        static bool IsBackFacing( const Meshlet& meshlet, const glm::vec3& cameraPosition );
+
+        /**
+         * Find the meshlets of a mesh that are (potentially) visible.
+         * @param frustum The view frustum in object space.
+         * @param cameraPosition The position of the camera in object space (only used if cullBackFacing is true).
+         * @param cullBackFacing Also cull meshlets that are facing away from the camera.
+         * @param visibleMeshlets The indices of the visible meshlets in ascending order.
+         */
+        static void Cull( const Meshlet* meshlets, size_t numMeshlets, const Frustum& frustum, const glm::vec3& cameraPosition, bool cullBackFacing,
+                          std::vector<uint32_t>& visibleMeshlets );
+    };
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file RenderQueue.h
+ *  @date October 18, 2026
+ *
+ *  @brief Sorted draw keys of a render pass.
+ */
+
+#include "../EngineDefines.h"
+
+#include <unordered_map>
+
+namespace Core
+{
+    class ThreadPool;
+}
+
+namespace Graphics
+{
+    /**
+     * A list of draws that is sorted by 64-bit draw keys before it is submitted.
+     * The keys encode the pipeline, material, mesh and view depth of the draws so
+     * that sorting the keys groups the draws that share state and orders them by depth.
+     * The queue only stores the keys and the indices of the draws. The passes that
+     * fill the queue store the draws themselves, so generating and sorting the keys
+     * does not depend on the device.
+     *
+     * Key layout (most significant bits first):
+     *   FrontToBack: pipeline (8) | depth slice (4) | material (16) | mesh (16) | depth (20)
+     *   BackToFront: pipeline (8) | inverted depth (24) | material (16) | mesh (16)
+     */
+    class ENGINE_DLL RenderQueue
+    {
+    public:
+        enum class SortOrder
+        {
+            // Opaque geometry. The draws are grouped by material and mesh within a few
+            // logarithmic depth slices and sorted front-to-back within each group.
+            // This keeps most of the benefit of early-Z while minimizing state changes.
+            FrontToBack,
+            // Transparent geometry. The draws are sorted strictly back-to-front.
+            // Only draws at the same (quantized) depth are grouped by material and mesh.
+            BackToFront,
+        };
+
+        static const uint32_t PipelineBits = 8;
+        static const uint32_t MaterialBits = 16;
+        static const uint32_t MeshBits = 16;
+        // The number of logarithmic depth slices of the FrontToBack sort order.
+        static const uint32_t NumDepthSlices = 16;
+
+        explicit RenderQueue( SortOrder sortOrder = SortOrder::FrontToBack );
+        virtual ~RenderQueue();
+
+        void SetSortOrder( SortOrder sortOrder );
+        SortOrder GetSortOrder() const;
+
+        /**
+         * The view space depth of the draws is quantized between the near and far clipping planes.
+         * Draws outside of the depth range are clamped to the range.
+         */
+        void SetDepthRange( float zNear, float zFar );
+
+        // Remove all of the draws and forget the ids of the pipelines, materials and meshes.
+        void Clear();
+
+        /**
+         * Add a draw to the queue.
+         * The pipeline, material and mesh are only used to assign ids (in the order they are first seen)
+         * and are never dereferenced. If there are more materials or meshes than fit in the key, the ids
+         * wrap around which only affects how well the draws are grouped.
+         * @param depth The (positive) view space depth of the draw.
+         * @param drawIndex The index of the draw in the pass. The draw indices are returned in sorted order.
+         */
+        void Push( const void* pipeline, const void* material, const void* mesh, float depth, uint32_t drawIndex );
+
+        // Sort the draws by their keys. The sort is stable.
+        void Sort( Core::ThreadPool& threadPool );
+        void Sort();
+
+        uint32_t GetNumDraws() const;
+        // The (sorted) keys and draw indices.
+        const uint64_t* GetKeys() const;
+        const uint32_t* GetDrawIndices() const;
+
+        // Compute the key of a draw.
+        uint64_t MakeKey( uint32_t pipelineID, uint32_t materialID, uint32_t meshID, float depth ) const;
+
+        // Decode the fields of a key.
+        uint32_t GetPipelineID( uint64_t key ) const;
+        uint32_t GetMaterialID( uint64_t key ) const;
+        uint32_t GetMeshID( uint64_t key ) const;
+
+    private:
+        // Quantize the depth between the near and far clipping planes to numBits bits.
+        uint32_t QuantizeDepth( float depth, uint32_t numBits ) const;
+        uint32_t GetDepthSlice( float depth ) const;
+
+        uint32_t GetID( std::unordered_map<const void*, uint32_t>& ids, const void* object );
+
+        SortOrder m_SortOrder;
+        float m_ZNear;
+        float m_ZFar;
+        // 1 / log( zFar / zNear )
+        float m_InvLogDepthRatio;
+
+        std::unordered_map<const void*, uint32_t> m_PipelineIDs;
+        std::unordered_map<const void*, uint32_t> m_MaterialIDs;
+        std::unordered_map<const void*, uint32_t> m_MeshIDs;
+
+        std::vector<uint64_t> m_Keys;
+        std::vector<uint32_t> m_DrawIndices;
+
+        // Temporary buffers for sorting.
+        std::vector<uint64_t> m_TmpKeys;
+        std::vector<uint32_t> m_TmpDrawIndices;
+    };
+}
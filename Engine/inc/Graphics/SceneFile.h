@@ -0,0 +1,215 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file SceneFile.h
+ *  @date October 18, 2026
+ *
+ *  @brief Binary cooked scene file that can be memory mapped.
+ */
+
+#include "../EngineDefines.h"
+#include "../MemoryMappedFile.h"
+#include "../NonCopyable.h"
+#include "Mesh.h"
+#include "Meshlet.h"
+
+namespace Graphics
+{
+    /**
+     * A binary file that stores a preprocessed (cooked) scene.
+     * The vertices and indices are stored in exactly the same layout as the vertex and
+     * index buffers of the meshes so they can be copied to the GPU directly from the
+     * memory mapped file. Materials reference their textures by file name and the scene
+     * node hierarchy is stored as a flat array of nodes (parents before children).
+     *
+     * File layout (all offsets are 16-byte aligned):
+     *   SceneFile::Header
+     *   SceneFile::MaterialRecord[NumMaterials]
+     *   SceneFile::TextureRecord[NumTextures]
+     *   SceneFile::MeshRecord[NumMeshes]
+     *   Meshlet[NumMeshlets]
+     *   SceneFile::NodeRecord[NumNodes]
+     *   uint32_t[NumNodeMeshes]          (mesh indices of the nodes)
+     *   Mesh::Vertex[NumVertices] or Mesh::CompactVertex[NumVertices] (depending on the vertex format)
+     *   uint8_t[IndicesSize]             (16-bit or 32-bit indices, depending on the mesh)
+     *   char[StringsSize]                (null-terminated UTF-8 strings)
+     */
+    class ENGINE_DLL SceneFile : public Core::NonCopyable
+    {
+    public:
+        // Increment the version if the file layout or any of the record structures change.
+        static const uint32_t FileVersion = 5;
+
+        // Parent index of the root node.
+        static const uint32_t InvalidIndex = 0xffffffff;
+
+        struct Header
+        {
+            char        Magic[4];           // "SCNE"
+            uint32_t    Version;
+            // The size of the vertex structure that was used to write the file.
+            uint32_t    VertexSize;
+            // Non-zero if the triangles were reordered to reduce overdraw (see SceneDX12::SetOptimizeOverdraw).
+            uint32_t    OverdrawOptimized;
+            uint32_t    NumMaterials;
+            uint32_t    NumTextures;
+            uint32_t    NumMeshes;
+            uint32_t    NumMeshlets;
+            uint32_t    NumNodes;
+            uint32_t    NumNodeMeshes;
+            uint32_t    VertexFormat;       // Mesh::VertexFormat
+            uint32_t    Padding;
+            uint64_t    NumVertices;
+            uint64_t    IndicesSize;        // In bytes.
+            uint64_t    StringsSize;
+            // Offsets (in bytes) from the start of the file.
+            uint64_t    MaterialsOffset;
+            uint64_t    TexturesOffset;
+            uint64_t    MeshesOffset;
+            uint64_t    MeshletsOffset;
+            uint64_t    NodesOffset;
+            uint64_t    NodeMeshesOffset;
+            uint64_t    VerticesOffset;
+            uint64_t    IndicesOffset;
+            uint64_t    StringsOffset;
+        };
+
+        struct MaterialRecord
+        {
+            glm::vec4   AmbientColor;
+            glm::vec4   EmissiveColor;
+            glm::vec4   DiffuseColor;
+            glm::vec4   SpecularColor;
+            glm::vec4   Reflectance;
+            float       SpecularPower;
+            float       Opacity;
+            float       IndexOfRefraction;
+            float       BumpIntensity;
+        };
+
+        struct TextureRecord
+        {
+            uint32_t    MaterialIndex;
+            uint32_t    TextureType;        // Material::TextureType
+            uint32_t    IsBumpMap;          // Textures in the bump map slot can also be normal maps.
+            uint32_t    FileName;           // Offset in the string table (relative to the scene file).
+        };
+
+        struct MeshRecord
+        {
+            uint32_t    MaterialIndex;
+            uint32_t    NumVertices;
+            uint32_t    NumIndices;
+            uint32_t    IndexSize;          // 2 or 4 bytes.
+            uint64_t    FirstVertex;
+            uint64_t    FirstIndex;         // Offset (in bytes) of the first index in the index data.
+            uint32_t    FirstMeshlet;
+            uint32_t    NumMeshlets;
+            // See Mesh::SetPositionTransform.
+            glm::mat4   PositionTransform;
+            // See Mesh::SetBounds.
+            BoundingBox Bounds;
+            glm::vec4   BoundingSphere;
+        };
+
+        struct NodeRecord
+        {
+            glm::mat4   LocalTransform;
+            uint32_t    ParentIndex;        // InvalidIndex for the root node.
+            uint32_t    Name;               // Offset in the string table.
+            uint32_t    FirstMesh;          // Index of the first mesh index of the node.
+            uint32_t    NumMeshes;
+        };
+
+        /**
+         * The contents of a scene file that is being written.
+         */
+        struct Contents
+        {
+            Mesh::VertexFormat VertexFormat = Mesh::VertexFormat::Standard;
+            bool OverdrawOptimized = false;
+            std::vector<MaterialRecord> Materials;
+            std::vector<TextureRecord> Textures;
+            std::vector<MeshRecord> Meshes;
+            std::vector<Meshlet> Meshlets;
+            std::vector<NodeRecord> Nodes;
+            std::vector<uint32_t> NodeMeshes;
+            std::vector<uint8_t> Vertices;
+            std::vector<uint8_t> Indices;
+            std::string Strings;
+
+            // Add a string to the string table and return its offset.
+            uint32_t AddString( const std::string& string );
+            // Add the indices of a mesh to the index data and return their offset.
+            uint64_t AddIndices( const void* indices, uint32_t numIndices, uint32_t indexSize );
+        };
+
+        SceneFile();
+        virtual ~SceneFile();
+
+        /**
+         * Memory map a scene file.
+         * @returns false if the file could not be opened or is not a valid scene file.
+         */
+        bool Open( const std::wstring& fileName );
+        void Close();
+
+        bool IsOpen() const;
+
+        const Header& GetHeader() const;
+
+        const MaterialRecord* GetMaterials() const;
+        const TextureRecord* GetTextures() const;
+        const MeshRecord* GetMeshes() const;
+        const Meshlet* GetMeshlets() const;
+        const NodeRecord* GetNodes() const;
+        const uint32_t* GetNodeMeshes() const;
+        // The vertices in the vertex format of the scene file.
+        const uint8_t* GetVertices() const;
+        // The indices of all meshes (see MeshRecord::IndexSize).
+        const uint8_t* GetIndices() const;
+
+        // Get a string from the string table.
+        const char* GetString( uint32_t offset ) const;
+
+        /**
+         * Write a scene file.
+         * @returns false if the file could not be written.
+         */
+        static bool Save( const std::wstring& fileName, const Contents& contents );
+
+        // The size of a single vertex in the specified vertex format.
+        static uint32_t GetVertexSize( Mesh::VertexFormat vertexFormat );
+
+    private:
+        // Check the header and the records of the mapped file.
+        bool Validate() const;
+
+        template<typename T>
+        const T* GetArray( uint64_t offset ) const;
+
+        Core::MemoryMappedFile m_File;
+    };
+}
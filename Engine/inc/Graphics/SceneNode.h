@@ -11,6 +11,7 @@ namespace Core
 namespace Graphics
 {
     class Mesh;
+    class TransformHierarchy;
 
     class ENGINE_DLL SceneNode : public std::enable_shared_from_this<SceneNode>
     {
@@ -37,8 +38,9 @@ namespace Graphics
 
         /**
          * Gets the scene node's world transform (concatenated with parents world transform)
-         * This function should be used sparingly as it is computed every time
-         * it is requested.
+         * The world transform is cached if the node is in a transform hierarchy
+         * (see TransformHierarchy). Otherwise this function should be used
+         * sparingly as it is computed every time it is requested.
          */
         glm::mat4 GetWorldTransform() const;
         void SetWorldTransform( const glm::mat4& worldTransform );
@@ -49,6 +51,17 @@ namespace Graphics
          */
         glm::mat4 GetInverseWorldTransform() const;
 
+        /**
+         * Gets the inverse transpose of the world transform (used to transform normals).
+         * This transform is cached if the node is in a transform hierarchy.
+         */
+        glm::mat4 GetInverseTransposeWorldTransform() const;
+
+        /**
+         * Get the transform hierarchy that this node is in (or null).
+         */
+        std::shared_ptr<TransformHierarchy> GetTransformHierarchy() const;
+
         /**
          * Add a child node to this node.
          * NOTE: Circular references are not checked!
@@ -84,6 +97,13 @@ namespace Graphics
         glm::mat4 GetParentWorldTransform() const;
 
     private:
+        friend class TransformHierarchy;
+
+        // The hierarchy must be flattened again.
+        void InvalidateTransformHierarchy();
+        // Remove this node and its children from the transform hierarchy.
+        void DetachTransformHierarchy();
+
         typedef std::vector< std::shared_ptr<SceneNode> > NodeList;
         typedef std::multimap< std::string, std::shared_ptr<SceneNode> > NodeNameMap;
         typedef std::vector< std::shared_ptr<Mesh> > MeshList;
@@ -92,8 +112,10 @@ namespace Graphics
 
         // Transforms node from parent's space to world space for rendering.
         glm::mat4 m_LocalTransform;
-        // This is the inverse of the local -> world transform.
-        glm::mat4 m_InverseTransform;
+
+        // The transforms are cached in the transform hierarchy of the scene.
+        std::shared_ptr<TransformHierarchy> m_TransformHierarchy;
+        uint32_t m_TransformIndex;
 
         std::weak_ptr<SceneNode> m_pParentNode;
         NodeList m_Children;
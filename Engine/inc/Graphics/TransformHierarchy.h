@@ -0,0 +1,125 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file TransformHierarchy.h
+ *  @date October 18, 2026
+ *
+ *  @brief Flattened transforms of a scene node hierarchy.
+ */
+
+#include "../EngineDefines.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Core
+{
+    class SceneVisitor;
+}
+
+namespace Graphics
+{
+    class SceneNode;
+
+    /**
+     * The transforms of a scene node hierarchy stored in flat arrays with the
+     * parent nodes before their children (in the order that the nodes are
+     * visited by SceneNode::Accept). The world and inverse transpose world
+     * transforms are cached. If the local transform of a node changes, only the
+     * transforms of the node and its children are computed again in a single
+     * sweep over the arrays the next time a world transform is requested.
+     * The hierarchy is flattened again if nodes are added to or removed from it.
+     *
+     * The transforms can be set, updated and read from multiple threads. The
+     * transforms are returned by value because Update can reallocate the arrays.
+     * Accept must not be called while nodes are added or removed on other threads.
+     */
+    class ENGINE_DLL TransformHierarchy : public std::enable_shared_from_this<TransformHierarchy>
+    {
+    public:
+        // Parent index of the root node.
+        static const uint32_t InvalidIndex = 0xffffffff;
+
+        /**
+         * Flatten the hierarchy of a root node. The nodes in the hierarchy
+         * store their transforms in the transform hierarchy.
+         */
+        static std::shared_ptr<TransformHierarchy> Create( std::shared_ptr<SceneNode> rootNode );
+
+        ~TransformHierarchy();
+
+        /**
+         * Compute the world transforms of the nodes that changed (and flatten
+         * the hierarchy again if nodes were added or removed).
+         * This function is called when a world transform is requested.
+         */
+        void Update();
+
+        uint32_t GetNumNodes() const;
+
+        void SetLocalTransform( uint32_t index, const glm::mat4& localTransform );
+        glm::mat4 GetWorldTransform( uint32_t index ) const;
+        glm::mat4 GetInverseTransposeWorldTransform( uint32_t index ) const;
+
+        /**
+         * The hierarchy must be flattened again (a node was added or removed).
+         */
+        void Invalidate();
+
+        /**
+         * Visit the nodes and meshes in the same order as SceneNode::Accept
+         * without recursing through the children of the nodes.
+         */
+        void Accept( Core::SceneVisitor& visitor );
+
+    private:
+        friend class SceneNode;
+
+        TransformHierarchy( std::shared_ptr<SceneNode> rootNode );
+
+        // A node is destroyed.
+        void RemoveNode( uint32_t index );
+        void Flatten();
+
+        std::weak_ptr<SceneNode> m_RootNode;
+
+        std::vector<SceneNode*> m_Nodes;
+        std::vector<uint32_t> m_ParentIndices;
+        std::vector<glm::mat4> m_LocalTransforms;
+        std::vector<glm::mat4> m_WorldTransforms;
+        std::vector<glm::mat4> m_InverseTransposeWorldTransforms;
+        std::vector<uint8_t> m_IsDirty;
+
+        // The index of the first node with a dirty transform.
+        uint32_t m_FirstDirtyIndex;
+
+        std::atomic<bool> m_IsDirtyHierarchy;
+        std::atomic<bool> m_IsDirtyTransform;
+
+        mutable std::mutex m_Mutex;
+    };
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file VertexCompression.h
+ *  @date October 18, 2026
+ *
+ *  @brief Encoding of the compact vertex format.
+ */
+
+#include "../EngineDefines.h"
+#include "Mesh.h"
+
+namespace Graphics
+{
+    /**
+     * Encode and decode the compact vertex format (Mesh::CompactVertex).
+     * The vertex shaders decode the compact vertices with the DecodeVertex
+     * function in Functions.hlsli (if COMPACT_VERTICES is defined).
+     */
+    class ENGINE_DLL VertexCompression
+    {
+    public:
+        /**
+         * Encode the vertices of a mesh.
+         * @param vertices The vertices of the mesh.
+         * @param numVertices The number of vertices of the mesh.
+         * @param compactVertices The encoded vertices (must have room for numVertices vertices).
+         * @param positionTransform Transforms the quantized positions to object space (see Mesh::SetPositionTransform).
+         */
+        static void Encode( const Mesh::Vertex* vertices, size_t numVertices, Mesh::CompactVertex* compactVertices, glm::mat4& positionTransform );
+
+        /**
+         * Decode a single vertex (the same as the DecodeVertex function in the shaders).
+         */
+        static Mesh::Vertex Decode( const Mesh::CompactVertex& compactVertex, const glm::mat4& positionTransform );
+
+        /**
+         * Octahedral encoding of unit vectors.
+         * Source: A Survey of Efficient Representations for Independent Unit Vectors (2014),
+         * Cigolle, Donow, Evangelakos, Mara, McGuire and Meyer.
+         */
+        static glm::vec2 EncodeOctahedral( const glm::vec3& v );
+        static glm::vec3 DecodeOctahedral( const glm::vec2& e );
+    };
+}
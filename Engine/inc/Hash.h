@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file Hash.h
+ *  @date October 18, 2026
+ *
+ *  @brief Hashing of memory and files for content based dependency tracking.
+ */
+
+#include "EngineDefines.h"
+
+#include <filesystem>
+
+namespace Core
+{
+    /**
+     * 64-bit non-cryptographic hash of a stream of bytes (XXH64 by Yann Collet).
+     * The hash of the same bytes is the same on every platform, so hashes can be
+     * stored on disk (see DependencyDatabase).
+     */
+    class ENGINE_DLL Hasher
+    {
+    public:
+        explicit Hasher( uint64_t seed = 0 );
+
+        void Update( const void* data, size_t size );
+
+        template<typename T>
+        void Update( const T& value )
+        {
+            static_assert( std::is_trivially_copyable<T>::value, "Only trivially copyable types can be hashed." );
+            Update( &value, sizeof( T ) );
+        }
+
+        // The hash of the bytes that were passed to Update.
+        uint64_t GetHash() const;
+
+        static uint64_t Hash( const void* data, size_t size, uint64_t seed = 0 );
+
+        /**
+         * Hash the contents of a file.
+         * @returns false if the file could not be read.
+         */
+        static bool HashFile( const std::filesystem::path& filePath, uint64_t& hash );
+
+    private:
+        void ProcessStripe( const uint8_t* stripe );
+
+        // The accumulators of the 32-byte stripes.
+        uint64_t m_Accumulators[4];
+        uint64_t m_Seed;
+        uint64_t m_TotalSize;
+        // Bytes that don't fill a stripe yet.
+        uint8_t m_Buffer[32];
+        size_t m_BufferSize;
+    };
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file MemoryMappedFile.h
+ *  @date October 18, 2026
+ *
+ *  @brief Read-only memory-mapped files for binary file formats.
+ */
+
+#include "EngineDefines.h"
+#include "NonCopyable.h"
+
+#include <iosfwd>
+
+namespace Core
+{
+    /**
+     * A file that is mapped into memory for reading.
+     * Binary files (like scene files and light set files) store their arrays aligned to
+     * MemoryMappedFile::Alignment bytes so the arrays can be used directly from the mapped memory.
+     */
+    class ENGINE_DLL MemoryMappedFile : public NonCopyable
+    {
+    public:
+        // The arrays in the file are aligned to 16 bytes (the alignment of the vertex, node and light structures).
+        static const uint64_t Alignment = 16;
+
+        MemoryMappedFile();
+        virtual ~MemoryMappedFile();
+
+        /**
+         * Map a file into memory.
+         * @returns false if the file could not be opened, is smaller than minSize, or could not be mapped.
+         */
+        bool Open( const std::wstring& fileName, uint64_t minSize );
+        void Close();
+
+        bool IsOpen() const;
+
+        const uint8_t* GetData() const;
+        uint64_t GetSize() const;
+
+        // Check that an array is aligned and fits in the file.
+        bool ValidateArray( uint64_t offset, uint64_t numElements, uint64_t elementSize ) const;
+
+        static uint64_t AlignUp( uint64_t offset );
+
+        // Pad the file with zeros up to the (aligned) offset of the next array.
+        static void WritePadding( std::ofstream& file, uint64_t offset );
+
+    private:
+        void* m_File;
+        void* m_FileMapping;
+        const uint8_t* m_Data;
+        uint64_t m_Size;
+    };
+}
@@ -29,13 +29,42 @@
 
 #pragma once
 
+#if defined(_WIN32)
 #include "CThreadSafeQueue.h"
+#else
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// On Linux, the changes are read with inotify. The Win32 types and
+// constants are used so the interface is the same on all platforms.
+typedef uint32_t DWORD;
+typedef int BOOL;
+
+#define FILE_NOTIFY_CHANGE_FILE_NAME	0x00000001
+#define FILE_NOTIFY_CHANGE_DIR_NAME		0x00000002
+#define FILE_NOTIFY_CHANGE_LAST_WRITE	0x00000010
+#define FILE_NOTIFY_CHANGE_CREATION		0x00000040
+
+#define FILE_ACTION_ADDED				0x00000001
+#define FILE_ACTION_REMOVED				0x00000002
+#define FILE_ACTION_MODIFIED			0x00000003
+#define FILE_ACTION_RENAMED_OLD_NAME	0x00000004
+#define FILE_ACTION_RENAMED_NEW_NAME	0x00000005
+#endif
 
 typedef std::pair<DWORD,std::wstring> TDirectoryChangeNotification;
 
 namespace ReadDirectoryChangesPrivate
 {
+#if defined(_WIN32)
 	class CReadChangesServer;
+#else
+	class CInotifyServer;
+#endif
 }
 
 ///////////////////////////////////////////////////////////////////////////
@@ -115,11 +144,19 @@ public:
 	/// </remarks>
 	void AddDirectory( const std::wstring& wszDirectory, BOOL bWatchSubtree, DWORD dwNotifyFilter, DWORD dwBufferSize=16384 );
 
+#if defined(_WIN32)
 	/// <summary>
 	/// Return a handle for the Win32 Wait... functions that will be
 	/// signaled when there is a queue entry.
 	/// </summary>
 	HANDLE GetWaitHandle() { return m_Notifications.GetWaitHandle(); }
+#endif
+
+	/// <summary>
+	/// Wait until there is a queue entry or the timeout expires.
+	/// </summary>
+	/// <returns>True if there is a queue entry.</returns>
+	bool Wait(DWORD dwMilliseconds);
 
 	bool Pop(DWORD& dwAction, std::wstring& wstrFilename);
 
@@ -129,6 +166,7 @@ public:
 	// Check if the queue overflowed. If so, clear it and return true.
 	bool CheckOverflow();
 
+#if defined(_WIN32)
 	unsigned int GetThreadId() { return m_dwThreadId; }
 
 protected:
@@ -139,4 +177,19 @@ protected:
 	unsigned int m_dwThreadId;
 
 	CThreadSafeQueue<TDirectoryChangeNotification> m_Notifications;
+#else
+protected:
+	friend class ReadDirectoryChangesPrivate::CInotifyServer;
+
+	ReadDirectoryChangesPrivate::CInotifyServer* m_pServer;
+
+	std::thread m_Thread;
+
+	std::deque<TDirectoryChangeNotification> m_Notifications;
+	std::mutex m_NotificationsMutex;
+	std::condition_variable m_NotificationsCondition;
+
+	size_t m_nMaxChanges;
+	bool m_bOverflow;
+#endif
 };
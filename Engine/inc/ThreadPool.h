@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file ThreadPool.h
+ *  @date October 18, 2026
+ *
+ *  @brief A pool of worker threads with support for parallel loops.
+ */
+
+#include "EngineDefines.h"
+#include "NonCopyable.h"
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Core
+{
+    class ENGINE_DLL ThreadPool : public NonCopyable
+    {
+    public:
+        using Task = std::function<void()>;
+        // Function that is invoked for a range [begin, end) of a parallel loop.
+        using RangeFunction = std::function<void( uint32_t begin, uint32_t end )>;
+
+        /**
+         * Create a thread pool.
+         * @param numThreads The number of worker threads to create. If 0, one
+         * worker is created for each hardware thread (minus the calling thread).
+         */
+        explicit ThreadPool( uint32_t numThreads = 0 );
+        virtual ~ThreadPool();
+
+        /**
+         * The shared thread pool used by the engine.
+         * The pool is created the first time it is used.
+         */
+        static ThreadPool& Get();
+
+        /**
+         * Join the worker threads of the shared thread pool.
+         * The shared pool is not destroyed by a static destructor (joining threads
+         * while the DLL is unloaded can deadlock on the loader lock), so it must be
+         * shut down explicitly. The Application does this when it is destroyed.
+         */
+        static void Shutdown();
+
+        /**
+         * The number of threads that can execute work at the same time.
+         * This includes the calling thread of ParallelFor.
+         */
+        uint32_t GetConcurrency() const;
+
+        /**
+         * Push a task onto the work queue.
+         */
+        std::future<void> Enqueue( Task task );
+
+        /**
+         * Split the range [begin, end) into chunks of grainSize elements and
+         * execute func for each chunk on the worker threads. The calling thread
+         * also executes chunks and this function only returns after all
+         * chunks have been processed, so it is safe to call ParallelFor from
+         * within a task that is running on the thread pool.
+         * If func throws, the remaining chunks are skipped and the first exception
+         * is rethrown on the calling thread after all running chunks have finished.
+         */
+        void ParallelFor( uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunction& func );
+
+    private:
+        void WorkerThread();
+
+        std::vector<std::thread> m_Workers;
+        std::queue<std::packaged_task<void()>> m_Tasks;
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        bool m_Stop;
+    };
+}
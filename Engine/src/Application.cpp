@@ -3,6 +3,7 @@
 #include <Application.h>
 #include <LogManager.h>
 #include <Events.h>
+#include <ThreadPool.h>
 #include <Graphics/Profiler.h>
 
 using namespace Core;
@@ -10,6 +11,28 @@ using namespace Core;
 // Globals
 static Application* gs_ApplicationInstance = nullptr;
 
+// The directory change listener thread checks if it should terminate at this interval.
+static const std::chrono::milliseconds gs_DirectoryChangeWaitTime( 50 );
+
+static FileAction GetFileAction( DWORD action )
+{
+    switch ( action )
+    {
+    case FILE_ACTION_ADDED:
+        return FileAction::Added;
+    case FILE_ACTION_REMOVED:
+        return FileAction::Removed;
+    case FILE_ACTION_MODIFIED:
+        return FileAction::Modified;
+    case FILE_ACTION_RENAMED_OLD_NAME:
+        return FileAction::RenameOld;
+    case FILE_ACTION_RENAMED_NEW_NAME:
+        return FileAction::RenameNew;
+    default:
+        return FileAction::Unknown;
+    }
+}
+
 
 Application::Application()
     : m_FixedTimestep( 1.0f / 60.0 )
@@ -28,6 +51,10 @@ Application::Application()
 Application::~Application()
 {
     OnTerminate( EventArgs( *this ) );
+
+    // Join the worker threads before the engine DLL is unloaded.
+    ThreadPool::Shutdown();
+
     gs_ApplicationInstance = nullptr;
 }
 
@@ -45,20 +72,25 @@ void Application::OnInitialize( EventArgs& e )
 void Application::RegisterDirectoryChangeListener( const std::wstring& dir, bool recursive )
 {
     scoped_lock lock( m_DirectoryChangeMutex );
-    m_DirectoryChanges.AddDirectory( dir, recursive, FILE_NOTIFY_CHANGE_LAST_WRITE );
+    // Saving a file can also replace it (the Windows implementation always reports these).
+    m_DirectoryChanges.AddDirectory( dir, recursive, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_FILE_NAME );
 }
 
 // This is the directory change listener thread entry point.
 void Application::CheckFileChanges()
 {
+    std::vector<FileChangeQueue::FileChange> fileChanges;
+
     while ( !m_bTerminateDirectoryChangeThread )
     {
-        scoped_lock lock( m_DirectoryChangeMutex );
+        // Wait until a file is modified or the next batched change is ready.
+        FileChangeQueue::Clock::duration timeout = std::min<FileChangeQueue::Clock::duration>( m_FileChanges.GetTimeout(), gs_DirectoryChangeWaitTime );
+        DWORD waitTime = static_cast<DWORD>( std::chrono::duration_cast<std::chrono::milliseconds>( timeout ).count() );
 
-        DWORD waitSignal = ::WaitForSingleObject( m_DirectoryChanges.GetWaitHandle(), 0 );
-        switch ( waitSignal )
+        if ( m_DirectoryChanges.Wait( waitTime ) )
         {
-        case WAIT_OBJECT_0:
+            scoped_lock lock( m_DirectoryChangeMutex );
+
             // A file has been modified
             if ( m_DirectoryChanges.CheckOverflow() )
             {
@@ -69,38 +101,20 @@ void Application::CheckFileChanges()
             {
                 DWORD action;
                 std::wstring fileName;
-                m_DirectoryChanges.Pop( action, fileName );
-
-                FileAction fileAction = FileAction::Unknown;
-                switch ( action )
+                while ( m_DirectoryChanges.Pop( action, fileName ) )
                 {
-                case FILE_ACTION_ADDED:
-                    fileAction = FileAction::Added;
-                    break;
-                case FILE_ACTION_REMOVED:
-                    fileAction = FileAction::Removed;
-                    break;
-                case FILE_ACTION_MODIFIED:
-                    fileAction = FileAction::Modified;
-                    break;
-                case FILE_ACTION_RENAMED_OLD_NAME:
-                    fileAction = FileAction::RenameOld;
-                    break;
-                case FILE_ACTION_RENAMED_NEW_NAME:
-                    fileAction = FileAction::RenameNew;
-                    break;
-                default:
-                    break;
+                    m_FileChanges.Push( GetFileAction( action ), fileName );
                 }
-
-                FileChangeEventArgs fileChangedEventArgs( *this, fileAction, fileName );
-                OnFileChange( fileChangedEventArgs );
             }
-        default:
-            break;
         }
 
-        std::this_thread::yield();
+        // Notify the application once for each burst of changes to a file.
+        m_FileChanges.Pop( fileChanges );
+        for ( FileChangeQueue::FileChange& fileChange : fileChanges )
+        {
+            FileChangeEventArgs fileChangedEventArgs( *this, fileChange.Action, fileChange.Path );
+            OnFileChange( fileChangedEventArgs );
+        }
     }
 }
 
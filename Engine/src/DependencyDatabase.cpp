@@ -0,0 +1,598 @@
+#include <EnginePCH.h>
+
+#include <DependencyDatabase.h>
+#include <Hash.h>
+#include <LogManager.h>
+#include <ThreadPool.h>
+
+using namespace Core;
+
+namespace
+{
+    const uint32_t DatabaseMagic = 0x44504544; // "DEPD"
+    const uint32_t DatabaseVersion = 1;
+
+    struct DatabaseHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t NumFiles;
+        uint32_t NumAssets;
+    };
+
+    // The smallest size of a file and an asset record in the database file
+    // (used to validate the counts in the database file before allocating the records).
+    const size_t MinFileRecordSize = sizeof( uint32_t ) + 3 * sizeof( uint64_t );
+    const size_t MinAssetRecordSize = 2 * sizeof( uint32_t ) + 3 * sizeof( uint64_t ) + sizeof( uint32_t );
+
+    // The number of files that are checked by a task in CheckFiles.
+    const uint32_t FilesPerTask = 16;
+
+    // Write the database to a memory buffer so the file is written at once.
+    class Writer
+    {
+    public:
+        template<typename T>
+        void Write( const T& value )
+        {
+            Write( &value, sizeof( T ) );
+        }
+
+        void Write( const void* data, size_t size )
+        {
+            const char* bytes = static_cast<const char*>( data );
+            m_Buffer.insert( m_Buffer.end(), bytes, bytes + size );
+        }
+
+        const std::vector<char>& GetBuffer() const
+        {
+            return m_Buffer;
+        }
+
+    private:
+        std::vector<char> m_Buffer;
+    };
+
+    // Read the database from a memory buffer.
+    class Reader
+    {
+    public:
+        explicit Reader( const std::vector<char>& buffer )
+            : m_Buffer( buffer )
+            , m_Offset( 0 )
+        {}
+
+        template<typename T>
+        bool Read( T& value )
+        {
+            return Read( &value, sizeof( T ) );
+        }
+
+        bool Read( void* data, size_t size )
+        {
+            if ( m_Offset + size > m_Buffer.size() )
+            {
+                return false;
+            }
+
+            memcpy( data, m_Buffer.data() + m_Offset, size );
+            m_Offset += size;
+
+            return true;
+        }
+
+        // The number of bytes that have not been read yet.
+        size_t GetRemainingSize() const
+        {
+            return m_Buffer.size() - m_Offset;
+        }
+
+    private:
+        const std::vector<char>& m_Buffer;
+        size_t m_Offset;
+    };
+}
+
+DependencyDatabase::DependencyDatabase()
+    : m_IsModified( false )
+{}
+
+DependencyDatabase::~DependencyDatabase()
+{}
+
+DependencyDatabase& DependencyDatabase::Get()
+{
+    static DependencyDatabase s_DependencyDatabase;
+    return s_DependencyDatabase;
+}
+
+std::wstring DependencyDatabase::GetKey( const fs::path& filePath )
+{
+    // Only the path is normalized. Resolving symbolic links would require file system access.
+    std::wstring key = fs::absolute( filePath ).lexically_normal().make_preferred().wstring();
+#if defined(_WIN32)
+    // Paths are not case sensitive on Windows.
+    std::transform( key.begin(), key.end(), key.begin(), ::towlower );
+#endif
+
+    return key;
+}
+
+bool DependencyDatabase::Load( const fs::path& filePath )
+{
+    scoped_lock lock( m_Mutex );
+
+    m_FilePath = fs::absolute( filePath );
+    m_Files.clear();
+    m_FileIndices.clear();
+    m_Assets.clear();
+    m_IsModified = false;
+
+    std::ifstream file( m_FilePath, std::ios::in | std::ios::binary );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    std::vector<char> buffer( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+    Reader reader( buffer );
+
+    DatabaseHeader header;
+    if ( !reader.Read( header ) || header.Magic != DatabaseMagic || header.Version != DatabaseVersion )
+    {
+        LOG_WARNING( "Invalid dependency database: ", m_FilePath );
+        return false;
+    }
+
+    // The paths are stored relative to the database.
+    fs::path parentPath = m_FilePath.parent_path();
+
+    // The counts are checked against the size of the file so a corrupt
+    // header can't allocate more records than the file could contain.
+    bool isValid = header.NumFiles <= reader.GetRemainingSize() / MinFileRecordSize;
+
+    m_Files.resize( isValid ? header.NumFiles : 0 );
+    for ( uint32_t i = 0; i < header.NumFiles && isValid; ++i )
+    {
+        FileState& fileState = m_Files[i];
+
+        uint32_t pathLength = 0;
+        std::string path;
+        isValid = reader.Read( pathLength ) && pathLength <= reader.GetRemainingSize();
+        if ( isValid )
+        {
+            path.resize( pathLength );
+            isValid = reader.Read( &path[0], pathLength ) &&
+                      reader.Read( fileState.Size ) &&
+                      reader.Read( fileState.LastWriteTime ) &&
+                      reader.Read( fileState.Hash );
+        }
+
+        if ( isValid )
+        {
+            fs::path relativePath = fs::u8path( path );
+            fileState.FilePath = relativePath.is_absolute() ? relativePath : ( parentPath / relativePath ).lexically_normal();
+            fileState.IsChecked = false;
+            fileState.NumInvalidations = 0;
+            m_FileIndices[GetKey( fileState.FilePath )] = i;
+        }
+    }
+
+    isValid = isValid && header.NumAssets <= reader.GetRemainingSize() / MinAssetRecordSize;
+
+    for ( uint32_t i = 0; i < header.NumAssets && isValid; ++i )
+    {
+        AssetRecord assetRecord;
+        uint32_t numFiles = 0;
+        uint32_t isBuilt = 0;
+
+        isValid = reader.Read( numFiles ) && numFiles > 0 && numFiles <= header.NumFiles &&
+                  numFiles <= reader.GetRemainingSize() / sizeof( uint32_t );
+        if ( isValid )
+        {
+            assetRecord.Files.resize( numFiles );
+            isValid = reader.Read( assetRecord.Files.data(), numFiles * sizeof( uint32_t ) ) &&
+                      reader.Read( assetRecord.ImportHash ) &&
+                      reader.Read( assetRecord.BuildParameters ) &&
+                      reader.Read( assetRecord.BuildHash ) &&
+                      reader.Read( isBuilt );
+        }
+
+        for ( uint32_t j = 0; j < numFiles && isValid; ++j )
+        {
+            isValid = assetRecord.Files[j] < header.NumFiles;
+        }
+
+        if ( isValid )
+        {
+            assetRecord.IsBuilt = isBuilt != 0;
+            // The base file is the first file of the asset.
+            m_Assets[GetKey( m_Files[assetRecord.Files[0]].FilePath )] = std::move( assetRecord );
+        }
+    }
+
+    if ( !isValid )
+    {
+        LOG_WARNING( "Corrupt dependency database: ", m_FilePath );
+        m_Files.clear();
+        m_FileIndices.clear();
+        m_Assets.clear();
+    }
+
+    return isValid;
+}
+
+bool DependencyDatabase::Save()
+{
+    scoped_lock lock( m_Mutex );
+
+    if ( m_FilePath.empty() )
+    {
+        return false;
+    }
+
+    if ( !m_IsModified && fs::exists( m_FilePath ) )
+    {
+        return true;
+    }
+
+    fs::path parentPath = m_FilePath.parent_path();
+
+    Writer writer;
+
+    DatabaseHeader header = { DatabaseMagic, DatabaseVersion, static_cast<uint32_t>( m_Files.size() ), static_cast<uint32_t>( m_Assets.size() ) };
+    writer.Write( header );
+
+    for ( const FileState& fileState : m_Files )
+    {
+        // Paths relative to the database make it possible to move the content root.
+        fs::path relativePath = fileState.FilePath.lexically_relative( parentPath );
+        std::string path = ( relativePath.empty() ? fileState.FilePath : relativePath ).generic_u8string();
+
+        writer.Write( static_cast<uint32_t>( path.size() ) );
+        writer.Write( path.data(), path.size() );
+        writer.Write( fileState.Size );
+        writer.Write( fileState.LastWriteTime );
+        writer.Write( fileState.Hash );
+    }
+
+    for ( const auto& asset : m_Assets )
+    {
+        const AssetRecord& assetRecord = asset.second;
+
+        writer.Write( static_cast<uint32_t>( assetRecord.Files.size() ) );
+        writer.Write( assetRecord.Files.data(), assetRecord.Files.size() * sizeof( uint32_t ) );
+        writer.Write( assetRecord.ImportHash );
+        writer.Write( assetRecord.BuildParameters );
+        writer.Write( assetRecord.BuildHash );
+        writer.Write( static_cast<uint32_t>( assetRecord.IsBuilt ? 1 : 0 ) );
+    }
+
+    std::ofstream file( m_FilePath, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !file.is_open() )
+    {
+        LOG_WARNING( "Could not save dependency database: ", m_FilePath );
+        return false;
+    }
+
+    const std::vector<char>& buffer = writer.GetBuffer();
+    file.write( buffer.data(), buffer.size() );
+
+    m_IsModified = file.fail();
+
+    return !m_IsModified;
+}
+
+void DependencyDatabase::Refresh()
+{
+    std::vector<uint32_t> fileIndices;
+    {
+        scoped_lock lock( m_Mutex );
+
+        fileIndices.resize( m_Files.size() );
+        for ( uint32_t i = 0; i < fileIndices.size(); ++i )
+        {
+            fileIndices[i] = i;
+        }
+    }
+
+    CheckFiles( std::move( fileIndices ) );
+}
+
+void DependencyDatabase::InvalidateFile( const fs::path& filePath )
+{
+    std::wstring key = GetKey( filePath );
+
+    scoped_lock lock( m_Mutex );
+
+    auto iter = m_FileIndices.find( key );
+    if ( iter != m_FileIndices.end() )
+    {
+        m_Files[iter->second].IsChecked = false;
+        ++m_Files[iter->second].NumInvalidations;
+    }
+}
+
+uint32_t DependencyDatabase::GetFileIndex( const fs::path& filePath )
+{
+    std::wstring key = GetKey( filePath );
+
+    auto iter = m_FileIndices.find( key );
+    if ( iter != m_FileIndices.end() )
+    {
+        return iter->second;
+    }
+
+    uint32_t fileIndex = static_cast<uint32_t>( m_Files.size() );
+
+    FileState fileState = { fs::absolute( filePath ).lexically_normal(), 0, 0, 0, false, 0 };
+    m_Files.push_back( fileState );
+    m_FileIndices[key] = fileIndex;
+    m_IsModified = true;
+
+    return fileIndex;
+}
+
+void DependencyDatabase::CheckFiles( std::vector<uint32_t> fileIndices )
+{
+    std::vector<FileState> fileStates;
+    {
+        scoped_lock lock( m_Mutex );
+
+        // Files that were already checked are skipped.
+        fileIndices.erase( std::remove_if( fileIndices.begin(), fileIndices.end(), [&]( uint32_t i )
+        {
+            return m_Files[i].IsChecked;
+        } ), fileIndices.end() );
+
+        fileStates.reserve( fileIndices.size() );
+        for ( uint32_t i : fileIndices )
+        {
+            fileStates.push_back( m_Files[i] );
+        }
+    }
+
+    if ( fileStates.empty() )
+    {
+        return;
+    }
+
+    // The files are checked without holding the lock so other threads can
+    // check the files of other assets at the same time.
+    // Not std::vector<bool>: the elements are written by different threads.
+    std::vector<uint8_t> isModified( fileStates.size(), 0 );
+    ThreadPool::Get().ParallelFor( 0, static_cast<uint32_t>( fileStates.size() ), FilesPerTask, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            FileState& fileState = fileStates[i];
+
+            std::error_code sizeError;
+            std::error_code timeError;
+            uint64_t size = fs::file_size( fileState.FilePath, sizeError );
+            int64_t lastWriteTime = fs::last_write_time( fileState.FilePath, timeError ).time_since_epoch().count();
+
+            if ( sizeError || timeError )
+            {
+                // Missing files have a hash of 0.
+                size = 0;
+                lastWriteTime = 0;
+            }
+
+            if ( size != fileState.Size || lastWriteTime != fileState.LastWriteTime )
+            {
+                uint64_t hash = 0;
+                if ( !sizeError && !timeError && !Hasher::HashFile( fileState.FilePath, hash ) )
+                {
+                    hash = 0;
+                }
+
+                fileState.Size = size;
+                fileState.LastWriteTime = lastWriteTime;
+                fileState.Hash = hash;
+                isModified[i] = 1;
+            }
+
+            fileState.IsChecked = true;
+        }
+    } );
+
+    scoped_lock lock( m_Mutex );
+
+    for ( size_t i = 0; i < fileIndices.size(); ++i )
+    {
+        // A file that was invalidated while it was checked could have changed after it was
+        // read, so it stays unchecked and is checked again the next time it is used.
+        FileState& fileState = m_Files[fileIndices[i]];
+        if ( fileState.NumInvalidations == fileStates[i].NumInvalidations )
+        {
+            fileState = fileStates[i];
+            m_IsModified = m_IsModified || isModified[i] != 0;
+        }
+    }
+}
+
+uint64_t DependencyDatabase::GetBuildHash( const AssetRecord& assetRecord ) const
+{
+    // Only the contents of the files are hashed so the content root can be moved.
+    Hasher hasher;
+    for ( uint32_t i : assetRecord.Files )
+    {
+        hasher.Update( m_Files[i].Hash );
+    }
+
+    return hasher.GetHash();
+}
+
+bool DependencyDatabase::GetDependencies( const fs::path& baseFile, std::vector<fs::path>& dependencies ) const
+{
+    std::wstring key = GetKey( baseFile );
+
+    scoped_lock lock( m_Mutex );
+
+    auto iter = m_Assets.find( key );
+    if ( iter == m_Assets.end() )
+    {
+        return false;
+    }
+
+    dependencies.clear();
+    for ( uint32_t i : iter->second.Files )
+    {
+        dependencies.push_back( m_Files[i].FilePath );
+    }
+
+    return true;
+}
+
+void DependencyDatabase::SetDependencies( const fs::path& baseFile, const std::vector<fs::path>& dependencies )
+{
+    std::wstring key = GetKey( baseFile );
+
+    scoped_lock lock( m_Mutex );
+
+    std::vector<uint32_t> files;
+    files.push_back( GetFileIndex( baseFile ) );
+    for ( const fs::path& dependency : dependencies )
+    {
+        uint32_t fileIndex = GetFileIndex( dependency );
+        if ( std::find( files.begin(), files.end(), fileIndex ) == files.end() )
+        {
+            files.push_back( fileIndex );
+        }
+    }
+
+    auto iter = m_Assets.find( key );
+    if ( iter == m_Assets.end() )
+    {
+        AssetRecord assetRecord = { files, 0, 0, 0, false };
+        m_Assets[key] = assetRecord;
+        m_IsModified = true;
+    }
+    else if ( iter->second.Files != files )
+    {
+        // The build hash of the new files is different so the asset becomes stale.
+        iter->second.Files = files;
+        m_IsModified = true;
+    }
+}
+
+uint64_t DependencyDatabase::GetImportHash( const fs::path& baseFile ) const
+{
+    std::wstring key = GetKey( baseFile );
+
+    scoped_lock lock( m_Mutex );
+
+    auto iter = m_Assets.find( key );
+    return iter != m_Assets.end() ? iter->second.ImportHash : 0;
+}
+
+void DependencyDatabase::SetImportHash( const fs::path& baseFile, uint64_t importHash )
+{
+    std::wstring key = GetKey( baseFile );
+
+    scoped_lock lock( m_Mutex );
+
+    auto iter = m_Assets.find( key );
+    if ( iter != m_Assets.end() && iter->second.ImportHash != importHash )
+    {
+        iter->second.ImportHash = importHash;
+        m_IsModified = true;
+    }
+}
+
+uint64_t DependencyDatabase::GetFileHash( const fs::path& filePath )
+{
+    uint32_t fileIndex;
+    {
+        scoped_lock lock( m_Mutex );
+        fileIndex = GetFileIndex( filePath );
+    }
+
+    CheckFiles( { fileIndex } );
+
+    scoped_lock lock( m_Mutex );
+    return m_Files[fileIndex].Hash;
+}
+
+bool DependencyDatabase::IsStale( const fs::path& baseFile, const uint64_t* buildParameters )
+{
+    std::wstring key = GetKey( baseFile );
+
+    std::vector<uint32_t> files;
+    {
+        scoped_lock lock( m_Mutex );
+
+        auto iter = m_Assets.find( key );
+        if ( iter == m_Assets.end() || !iter->second.IsBuilt ||
+             ( buildParameters != nullptr && *buildParameters != iter->second.BuildParameters ) )
+        {
+            return true;
+        }
+
+        files = iter->second.Files;
+    }
+
+    CheckFiles( std::move( files ) );
+
+    scoped_lock lock( m_Mutex );
+
+    // The asset could have been removed while the files were checked.
+    auto iter = m_Assets.find( key );
+    return iter == m_Assets.end() || GetBuildHash( iter->second ) != iter->second.BuildHash;
+}
+
+bool DependencyDatabase::IsBuilt( const fs::path& baseFile ) const
+{
+    std::wstring key = GetKey( baseFile );
+
+    scoped_lock lock( m_Mutex );
+
+    auto iter = m_Assets.find( key );
+    return iter != m_Assets.end() && iter->second.IsBuilt;
+}
+
+void DependencyDatabase::SetBuilt( const fs::path& baseFile, uint64_t buildParameters )
+{
+    std::wstring key = GetKey( baseFile );
+
+    std::vector<uint32_t> files;
+    {
+        scoped_lock lock( m_Mutex );
+
+        auto iter = m_Assets.find( key );
+        if ( iter == m_Assets.end() )
+        {
+            AssetRecord assetRecord = { { GetFileIndex( baseFile ) }, 0, 0, 0, false };
+            iter = m_Assets.emplace( key, assetRecord ).first;
+        }
+
+        files = iter->second.Files;
+    }
+
+    CheckFiles( std::move( files ) );
+
+    scoped_lock lock( m_Mutex );
+
+    AssetRecord& assetRecord = m_Assets[key];
+    assetRecord.BuildParameters = buildParameters;
+    assetRecord.BuildHash = GetBuildHash( assetRecord );
+    assetRecord.IsBuilt = true;
+
+    m_IsModified = true;
+}
+
+std::vector<fs::path> DependencyDatabase::GetAssets() const
+{
+    scoped_lock lock( m_Mutex );
+
+    std::vector<fs::path> assets;
+    assets.reserve( m_Assets.size() );
+
+    for ( const auto& asset : m_Assets )
+    {
+        assets.push_back( m_Files[asset.second.Files[0]].FilePath );
+    }
+
+    return assets;
+}
@@ -1,14 +1,140 @@
 #include <EnginePCH.h>
 #include <Application.h>
+#include <DependencyDatabase.h>
 #include <DependencyTracker.h>
 
+#include <unordered_map>
+
 using namespace Core;
 
-DependencyTracker::DependencyTracker()
+/**
+ * Maps files to the dependency trackers that depend on them. The paths of the
+ * dependencies are normalized when they are added, so a file change is
+ * dispatched with a single lookup instead of comparing the canonical paths of
+ * the dependencies of all trackers.
+ */
+class DependencyTrackerIndex
 {
-    Application& app = Application::Get();
-    m_EventConnections.push_back( app.FileChanged += boost::bind( &DependencyTracker::OnFileChanged, this, _1 ) );
-}
+public:
+    static DependencyTrackerIndex& Get()
+    {
+        static DependencyTrackerIndex dependencyTrackerIndex;
+        return dependencyTrackerIndex;
+    }
+
+    // Replace the files of a dependency tracker.
+    void Register( DependencyTracker* dependencyTracker, std::vector<std::wstring> keys )
+    {
+        scoped_lock lock( m_Mutex );
+
+        RemoveKeys( dependencyTracker );
+
+        for ( const std::wstring& key : keys )
+        {
+            m_Trackers[key].push_back( dependencyTracker );
+        }
+        m_Keys[dependencyTracker] = std::move( keys );
+
+        // Only connect to the application while there are trackers.
+        if ( !m_Connection.connected() )
+        {
+            m_Connection = Application::Get().FileChanged += boost::bind( &DependencyTrackerIndex::OnFileChanged, this, _1 );
+        }
+    }
+
+    void Unregister( DependencyTracker* dependencyTracker )
+    {
+        // Wait for file changes that are being dispatched to the tracker.
+        std::lock_guard<std::recursive_mutex> dispatchLock( m_DispatchMutex );
+        scoped_lock lock( m_Mutex );
+
+        RemoveKeys( dependencyTracker );
+        m_Keys.erase( dependencyTracker );
+
+        if ( m_Keys.empty() )
+        {
+            m_Connection.disconnect();
+        }
+    }
+
+private:
+    void RemoveKeys( DependencyTracker* dependencyTracker )
+    {
+        auto iter = m_Keys.find( dependencyTracker );
+        if ( iter == m_Keys.end() )
+        {
+            return;
+        }
+
+        for ( const std::wstring& key : iter->second )
+        {
+            auto trackersIter = m_Trackers.find( key );
+            if ( trackersIter != m_Trackers.end() )
+            {
+                std::vector<DependencyTracker*>& trackers = trackersIter->second;
+                trackers.erase( std::remove( trackers.begin(), trackers.end(), dependencyTracker ), trackers.end() );
+                if ( trackers.empty() )
+                {
+                    m_Trackers.erase( trackersIter );
+                }
+            }
+        }
+    }
+
+    bool IsRegistered( DependencyTracker* dependencyTracker )
+    {
+        scoped_lock lock( m_Mutex );
+        return m_Keys.find( dependencyTracker ) != m_Keys.end();
+    }
+
+    void OnFileChanged( FileChangeEventArgs& e )
+    {
+        if ( e.Action == FileAction::Modified )
+        {
+            // The hash of the file must be computed again.
+            DependencyDatabase::Get().InvalidateFile( e.Path );
+        }
+
+        std::lock_guard<std::recursive_mutex> dispatchLock( m_DispatchMutex );
+
+        // The trackers are notified without holding the lock, since they can
+        // add dependencies while the lock on the tracker is held.
+        std::vector<DependencyTracker*> trackers;
+        {
+            scoped_lock lock( m_Mutex );
+
+            auto iter = m_Trackers.find( DependencyDatabase::GetKey( e.Path ) );
+            if ( iter == m_Trackers.end() )
+            {
+                return;
+            }
+            trackers = iter->second;
+        }
+
+        for ( DependencyTracker* dependencyTracker : trackers )
+        {
+            // The tracker may have been destroyed by a previous event handler.
+            if ( IsRegistered( dependencyTracker ) )
+            {
+                dependencyTracker->OnFileChanged( e );
+            }
+        }
+    }
+
+    std::mutex m_Mutex;
+    // Held while file changes are dispatched.
+    std::recursive_mutex m_DispatchMutex;
+
+    std::unordered_map<std::wstring, std::vector<DependencyTracker*>> m_Trackers;
+    std::unordered_map<DependencyTracker*, std::vector<std::wstring>> m_Keys;
+
+    boost::signals2::scoped_connection m_Connection;
+};
+
+DependencyTracker::DependencyTracker()
+    : m_BuildParameters( 0 )
+    , m_HasBuildParameters( false )
+{}
 
 DependencyTracker::DependencyTracker( const std::wstring& baseFile )
     : DependencyTracker()
@@ -28,6 +154,7 @@ DependencyTracker::DependencyTracker( const std::wstring& baseFile )
 
 DependencyTracker::~DependencyTracker()
 {
+    DependencyTrackerIndex::Get().Unregister( this );
 }
 
 const DependencyTracker& DependencyTracker::operator=( const DependencyTracker& other )
@@ -42,6 +169,10 @@ const DependencyTracker& DependencyTracker::operator=( const DependencyTracker&
         m_ParentPath = other.m_ParentPath;
         m_Dependencies = other.m_Dependencies;
         m_LastLoadtime = other.m_LastLoadtime;
+        m_BuildParameters = other.m_BuildParameters;
+        m_HasBuildParameters = other.m_HasBuildParameters;
+
+        UpdateIndex();
     }
 
     return *this;
@@ -61,6 +192,8 @@ void DependencyTracker::SetBaseFile( const std::wstring& baseFile )
     {
         m_ParentPath = fs::current_path();
     }
+
+    UpdateIndex();
 }
 
 void DependencyTracker::AddDependency( const std::wstring& dependencyFile )
@@ -71,7 +204,35 @@ void DependencyTracker::AddDependency( const std::wstring& dependencyFile )
     if ( iter == m_Dependencies.end() )
     {
         m_Dependencies.push_back( dependencyFile );
+
+        UpdateIndex();
+    }
+}
+
+std::vector<fs::path> DependencyTracker::GetDependencyPaths()
+{
+    MutexLock lock( m_Mutex );
+
+    std::vector<fs::path> dependencyPaths;
+    dependencyPaths.reserve( m_Dependencies.size() );
+
+    for ( const std::wstring& dependency : m_Dependencies )
+    {
+        dependencyPaths.push_back( m_ParentPath / dependency );
+    }
+
+    return dependencyPaths;
+}
+
+void DependencyTracker::UpdateIndex()
+{
+    std::vector<std::wstring> keys;
+    for ( const fs::path& dependencyPath : GetDependencyPaths() )
+    {
+        keys.push_back( DependencyDatabase::GetKey( dependencyPath ) );
     }
+
+    DependencyTrackerIndex::Get().Register( this, std::move( keys ) );
 }
 
 void DependencyTracker::OnFileChanged( FileChangeEventArgs& e )
@@ -79,28 +240,16 @@ void DependencyTracker::OnFileChanged( FileChangeEventArgs& e )
     MutexLock lock( m_Mutex );
     bool bFileChanged = false;
 
-    for ( std::wstring dependency : m_Dependencies )
+    if ( e.Action == FileAction::Modified )
     {
-        if ( e.Action == FileAction::Modified )
+        // The changed file is the base file or one of the dependencies.
+        std::error_code ec;
+        fs::file_time_type lastWriteTime = fs::last_write_time( e.Path, ec );
+
+        // This can fail when a change is detected of a temporary file (Photoshop creates these when saving PSD files)
+        if ( !ec && m_LastLoadtime < lastWriteTime )
         {
-            fs::path dependencyPath = m_ParentPath / dependency;
-            fs::path changedFilePath = e.Path;
-            try
-            {
-                // Make sure the canonical paths are the same.
-                if ( fs::canonical( dependencyPath ) == fs::canonical( changedFilePath ) )
-                {
-                    if ( m_LastLoadtime < fs::last_write_time( dependencyPath ) )
-                    {
-                        bFileChanged = true;
-                        break;
-                    }
-                }
-            } catch ( fs::filesystem_error& )
-            {
-                // This can happen when a change is detected of a temporary file (Photoshop creates these when saving PSD files)
-                // fs::canonical will throw an exception if the file doesn't exist.
-            }
+            bFileChanged = true;
         }
     }
 
@@ -111,10 +260,25 @@ void DependencyTracker::OnFileChanged( FileChangeEventArgs& e )
     }
 }
 
+void DependencyTracker::SetBuildParameters( uint64_t buildParameters )
+{
+    MutexLock lock( m_Mutex );
+
+    m_BuildParameters = buildParameters;
+    m_HasBuildParameters = true;
+}
+
 bool DependencyTracker::IsStale()
 {
     MutexLock lock( m_Mutex );
 
+    DependencyDatabase& dependencyDatabase = DependencyDatabase::Get();
+    if ( dependencyDatabase.IsBuilt( m_BaseFile ) )
+    {
+        return dependencyDatabase.IsStale( m_BaseFile, m_HasBuildParameters ? &m_BuildParameters : nullptr );
+    }
+
+    bool isStale = false;
     try
     {
         for ( std::wstring dependency : m_Dependencies )
@@ -122,7 +286,8 @@ bool DependencyTracker::IsStale()
             // Check to see if the asset needs to be reloaded.
             if ( fs::exists( m_ParentPath / dependency ) && m_LastLoadtime < fs::last_write_time( m_ParentPath / dependency ) )
             {
-                return true;
+                isStale = true;
+                break;
             }
         }
     } 
@@ -131,7 +296,22 @@ bool DependencyTracker::IsStale()
         OutputDebugStringA( fserror.what() );
     }
 
-    return false;
+    // The hashes of assets that were built before the dependency database
+    // existed are stored so the timestamps are only checked once.
+    if ( !isStale && m_HasBuildParameters )
+    {
+        SetUpToDate();
+    }
+
+    return isStale;
+}
+
+void DependencyTracker::SetUpToDate()
+{
+    MutexLock lock( m_Mutex );
+
+    Save();
+    DependencyDatabase::Get().SetBuilt( m_BaseFile, m_BuildParameters );
 }
 
 void DependencyTracker::SetLastLoadTime( fs::file_time_type lastLoadTime )
@@ -148,28 +328,57 @@ bool DependencyTracker::Save()
 {
     MutexLock lock( m_Mutex );
 
-    std::wofstream dependenciesOutputStream( m_DependencyPath, std::ios::out );
-    if ( dependenciesOutputStream.is_open() )
-    {
-        boost::archive::xml_woarchive woa( dependenciesOutputStream );
-        woa << boost::serialization::make_nvp( "DependencyTracker", *this );
-        return true;
-    }
+    DependencyDatabase::Get().SetDependencies( m_BaseFile, GetDependencyPaths() );
 
-    return false;
+    return true;
 }
 
 bool DependencyTracker::Load()
 {
     MutexLock lock( m_Mutex );
 
-    std::wifstream dependenciesInputStream( m_DependencyPath, std::ios::in );
-    if ( dependenciesInputStream.is_open() )
+    DependencyDatabase& dependencyDatabase = DependencyDatabase::Get();
+
+    // The dependency file is only parsed if it was changed since it was imported.
+    // The hash of a dependency file that doesn't exist is 0.
+    uint64_t importHash = dependencyDatabase.GetFileHash( m_DependencyPath );
+
+    std::vector<fs::path> dependencyPaths;
+    bool isInDatabase = dependencyDatabase.GetDependencies( m_BaseFile, dependencyPaths );
+
+    if ( importHash != 0 && ( !isInDatabase || importHash != dependencyDatabase.GetImportHash( m_BaseFile ) ) )
     {
-        boost::archive::xml_wiarchive wia( dependenciesInputStream );
-        wia >> boost::serialization::make_nvp( "DependencyTracker", *this );
+        std::wifstream dependenciesInputStream( m_DependencyPath, std::ios::in );
+        if ( dependenciesInputStream.is_open() )
+        {
+            // The base path in the dependency file is relative to the working directory of the
+            // application that saved it.
+            std::wstring baseFile = m_BaseFile;
+
+            boost::archive::xml_wiarchive wia( dependenciesInputStream );
+            wia >> boost::serialization::make_nvp( "DependencyTracker", *this );
+
+            SetBaseFile( baseFile );
+            Save();
+            dependencyDatabase.SetImportHash( m_BaseFile, importHash );
+
+            return true;
+        }
+    }
+
+    if ( isInDatabase )
+    {
+        // The paths in the database are absolute.
+        m_Dependencies.clear();
+        for ( const fs::path& dependencyPath : dependencyPaths )
+        {
+            m_Dependencies.push_back( dependencyPath.wstring() );
+        }
+
+        UpdateIndex();
 
         return true;
     }
+
     return false;
 }
@@ -0,0 +1,108 @@
+#include <EnginePCH.h>
+
+#include <FileChangeQueue.h>
+
+using namespace Core;
+
+namespace
+{
+    bool IsRemoved( FileAction action )
+    {
+        return action == FileAction::Removed || action == FileAction::RenameOld;
+    }
+
+    bool IsAdded( FileAction action )
+    {
+        return action == FileAction::Added || action == FileAction::RenameNew;
+    }
+
+    // The action of a file that was changed several times.
+    // Returns FileAction::Unknown if the changes cancel out.
+    FileAction MergeActions( FileAction firstAction, FileAction lastAction )
+    {
+        if ( IsRemoved( firstAction ) )
+        {
+            // The file was replaced (for example, by renaming a temporary file).
+            return IsRemoved( lastAction ) ? lastAction : FileAction::Modified;
+        }
+        else if ( IsAdded( firstAction ) )
+        {
+            // A new file that was modified is still a new file.
+            return IsRemoved( lastAction ) ? FileAction::Unknown : firstAction;
+        }
+
+        return IsRemoved( lastAction ) ? lastAction : FileAction::Modified;
+    }
+}
+
+FileChangeQueue::FileChangeQueue( Clock::duration delay )
+    : m_Delay( delay )
+{}
+
+void FileChangeQueue::Push( FileAction action, const std::wstring& path, Clock::time_point time )
+{
+    auto iter = m_PendingChangeMap.find( path );
+    if ( iter != m_PendingChangeMap.end() )
+    {
+        PendingChange& pendingChange = *iter->second;
+        pendingChange.LastAction = action;
+        pendingChange.LastTime = time;
+    }
+    else
+    {
+        m_PendingChanges.push_back( { path, action, action, time } );
+        m_PendingChangeMap[path] = std::prev( m_PendingChanges.end() );
+    }
+}
+
+size_t FileChangeQueue::Pop( std::vector<FileChange>& fileChanges, Clock::time_point time )
+{
+    fileChanges.clear();
+
+    PendingChanges::iterator iter = m_PendingChanges.begin();
+    while ( iter != m_PendingChanges.end() )
+    {
+        if ( time - iter->LastTime < m_Delay )
+        {
+            ++iter;
+            continue;
+        }
+
+        FileAction action = iter->FirstAction == iter->LastAction ? iter->FirstAction : MergeActions( iter->FirstAction, iter->LastAction );
+        if ( action != FileAction::Unknown || iter->FirstAction == FileAction::Unknown )
+        {
+            fileChanges.push_back( { action, std::move( iter->Path ) } );
+            m_PendingChangeMap.erase( fileChanges.back().Path );
+        }
+        else
+        {
+            m_PendingChangeMap.erase( iter->Path );
+        }
+
+        iter = m_PendingChanges.erase( iter );
+    }
+
+    return fileChanges.size();
+}
+
+FileChangeQueue::Clock::duration FileChangeQueue::GetTimeout( Clock::time_point time ) const
+{
+    Clock::duration timeout = Clock::duration::max();
+    for ( const PendingChange& pendingChange : m_PendingChanges )
+    {
+        timeout = std::min( timeout, std::max( pendingChange.LastTime + m_Delay - time, Clock::duration::zero() ) );
+    }
+
+    return timeout;
+}
+
+bool FileChangeQueue::IsEmpty() const
+{
+    return m_PendingChanges.empty();
+}
+
+void FileChangeQueue::Clear()
+{
+    m_PendingChanges.clear();
+    m_PendingChangeMap.clear();
+}
@@ -0,0 +1,506 @@
+#include <EnginePCH.h>
+
+#include <Graphics/BlockCompression.h>
+
+using namespace Graphics;
+
+namespace
+{
+    const int NumTexels = 16;
+
+    // The interpolation weights of BC7 blocks with 4-bit indices (in 64ths).
+    const int BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Compute the endpoints of the line segment that best fits the texels of a block.
+    // The texels are projected on the principal axis of the block and the endpoints are
+    // the extremes of the projected texels. N is the number of channels (3 or 4).
+    template<int N>
+    void FitEndpoints( const uint8_t* rgba, float* endpoint0, float* endpoint1 )
+    {
+        float mean[N] = {};
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            for ( int c = 0; c < N; ++c )
+            {
+                mean[c] += rgba[i * 4 + c];
+            }
+        }
+        for ( int c = 0; c < N; ++c )
+        {
+            mean[c] /= NumTexels;
+        }
+
+        float covariance[N][N] = {};
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            float d[N];
+            for ( int c = 0; c < N; ++c )
+            {
+                d[c] = rgba[i * 4 + c] - mean[c];
+            }
+            for ( int r = 0; r < N; ++r )
+            {
+                for ( int c = 0; c < N; ++c )
+                {
+                    covariance[r][c] += d[r] * d[c];
+                }
+            }
+        }
+
+        // Find the principal axis with power iteration. The iteration starts
+        // with the column of the channel with the largest variance.
+        int maxChannel = 0;
+        for ( int c = 1; c < N; ++c )
+        {
+            if ( covariance[c][c] > covariance[maxChannel][maxChannel] )
+            {
+                maxChannel = c;
+            }
+        }
+
+        float axis[N];
+        for ( int c = 0; c < N; ++c )
+        {
+            axis[c] = covariance[maxChannel][c];
+        }
+        for ( int iteration = 0; iteration < 8; ++iteration )
+        {
+            float v[N] = {};
+            float maxComponent = 0.0f;
+            for ( int r = 0; r < N; ++r )
+            {
+                for ( int c = 0; c < N; ++c )
+                {
+                    v[r] += covariance[r][c] * axis[c];
+                }
+                maxComponent = std::max( maxComponent, std::abs( v[r] ) );
+            }
+
+            if ( maxComponent == 0.0f )
+            {
+                break;
+            }
+
+            for ( int c = 0; c < N; ++c )
+            {
+                axis[c] = v[c] / maxComponent;
+            }
+        }
+
+        float axisLengthSquared = 0.0f;
+        for ( int c = 0; c < N; ++c )
+        {
+            axisLengthSquared += axis[c] * axis[c];
+        }
+
+        // All texels of the block have the same color.
+        if ( axisLengthSquared == 0.0f )
+        {
+            std::copy( mean, mean + N, endpoint0 );
+            std::copy( mean, mean + N, endpoint1 );
+            return;
+        }
+
+        float minProjection = std::numeric_limits<float>::max();
+        float maxProjection = -std::numeric_limits<float>::max();
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            float projection = 0.0f;
+            for ( int c = 0; c < N; ++c )
+            {
+                projection += ( rgba[i * 4 + c] - mean[c] ) * axis[c];
+            }
+            minProjection = std::min( minProjection, projection );
+            maxProjection = std::max( maxProjection, projection );
+        }
+
+        for ( int c = 0; c < N; ++c )
+        {
+            endpoint0[c] = glm::clamp( mean[c] + axis[c] * minProjection / axisLengthSquared, 0.0f, 255.0f );
+            endpoint1[c] = glm::clamp( mean[c] + axis[c] * maxProjection / axisLengthSquared, 0.0f, 255.0f );
+        }
+    }
+
+    // Refine the endpoints with a least-squares fit for the selected interpolation weights.
+    // Returns false if the endpoints could not be refined (all texels have the same weight).
+    template<int N>
+    bool RefineEndpoints( const uint8_t* rgba, const float* weights, float* endpoint0, float* endpoint1 )
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ap[N] = {};
+        float bp[N] = {};
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            float b = weights[i];
+            float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for ( int c = 0; c < N; ++c )
+            {
+                ap[c] += a * rgba[i * 4 + c];
+                bp[c] += b * rgba[i * 4 + c];
+            }
+        }
+
+        float determinant = aa * bb - ab * ab;
+        if ( std::abs( determinant ) < 1e-6f )
+        {
+            return false;
+        }
+
+        for ( int c = 0; c < N; ++c )
+        {
+            endpoint0[c] = glm::clamp( ( ap[c] * bb - bp[c] * ab ) / determinant, 0.0f, 255.0f );
+            endpoint1[c] = glm::clamp( ( bp[c] * aa - ap[c] * ab ) / determinant, 0.0f, 255.0f );
+        }
+
+        return true;
+    }
+
+    // Select the palette entry with the smallest squared error for each texel.
+    // Returns the total error of the block.
+    template<int N>
+    int SelectIndices( const uint8_t* rgba, const int ( *palette )[4], int paletteSize, uint8_t* indices )
+    {
+        int totalError = 0;
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            int bestError = std::numeric_limits<int>::max();
+            for ( int p = 0; p < paletteSize; ++p )
+            {
+                int error = 0;
+                for ( int c = 0; c < N; ++c )
+                {
+                    int d = rgba[i * 4 + c] - palette[p][c];
+                    error += d * d;
+                }
+                if ( error < bestError )
+                {
+                    bestError = error;
+                    indices[i] = static_cast<uint8_t>( p );
+                }
+            }
+            totalError += bestError;
+        }
+
+        return totalError;
+    }
+
+    inline uint16_t PackRGB565( const float* color )
+    {
+        uint16_t r = static_cast<uint16_t>( std::round( color[0] * 31.0f / 255.0f ) );
+        uint16_t g = static_cast<uint16_t>( std::round( color[1] * 63.0f / 255.0f ) );
+        uint16_t b = static_cast<uint16_t>( std::round( color[2] * 31.0f / 255.0f ) );
+        return static_cast<uint16_t>( ( r << 11 ) | ( g << 5 ) | b );
+    }
+
+    inline void UnpackRGB565( uint16_t color, int* rgb )
+    {
+        int r = ( color >> 11 ) & 31;
+        int g = ( color >> 5 ) & 63;
+        int b = color & 31;
+        rgb[0] = ( r << 3 ) | ( r >> 2 );
+        rgb[1] = ( g << 2 ) | ( g >> 4 );
+        rgb[2] = ( b << 3 ) | ( b >> 2 );
+    }
+
+    // Compute the four colors of a BC1 block in the order of the indices.
+    void BC1Palette( uint16_t color0, uint16_t color1, int ( *palette )[4] )
+    {
+        UnpackRGB565( color0, palette[0] );
+        UnpackRGB565( color1, palette[1] );
+        for ( int c = 0; c < 3; ++c )
+        {
+            palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+            palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+        }
+    }
+
+    // Encode the color part of a BC1 or BC3 block (always with 4 colors).
+    void EncodeColorBlock( const uint8_t* rgba, uint8_t* block )
+    {
+        // The weights of the palette entries along the line segment.
+        const float weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+        float endpoint0[3], endpoint1[3];
+        FitEndpoints<3>( rgba, endpoint0, endpoint1 );
+
+        // Note: endpoint1 is the maximum of the projected texels.
+        uint16_t color0 = PackRGB565( endpoint1 );
+        uint16_t color1 = PackRGB565( endpoint0 );
+
+        int palette[4][4];
+        uint8_t indices[NumTexels];
+        BC1Palette( color0, color1, palette );
+        int error = SelectIndices<3>( rgba, palette, 4, indices );
+
+        // Refine the endpoints as long as the error decreases.
+        for ( int iteration = 0; iteration < 2 && error > 0; ++iteration )
+        {
+            float texelWeights[NumTexels];
+            for ( int i = 0; i < NumTexels; ++i )
+            {
+                texelWeights[i] = weights[indices[i]];
+            }
+
+            float refined0[3], refined1[3];
+            if ( !RefineEndpoints<3>( rgba, texelWeights, refined0, refined1 ) )
+            {
+                break;
+            }
+
+            uint16_t refinedColor0 = PackRGB565( refined0 );
+            uint16_t refinedColor1 = PackRGB565( refined1 );
+
+            int refinedPalette[4][4];
+            uint8_t refinedIndices[NumTexels];
+            BC1Palette( refinedColor0, refinedColor1, refinedPalette );
+            int refinedError = SelectIndices<3>( rgba, refinedPalette, 4, refinedIndices );
+            if ( refinedError >= error )
+            {
+                break;
+            }
+
+            color0 = refinedColor0;
+            color1 = refinedColor1;
+            error = refinedError;
+            std::copy( refinedIndices, refinedIndices + NumTexels, indices );
+        }
+
+        // BC1 blocks only use four colors if color0 > color1.
+        if ( color0 < color1 )
+        {
+            std::swap( color0, color1 );
+            for ( auto& index : indices )
+            {
+                // Swap 0 <-> 1 and 2 <-> 3.
+                index ^= 1;
+            }
+        }
+        else if ( color0 == color1 )
+        {
+            std::fill( indices, indices + NumTexels, uint8_t( 0 ) );
+        }
+
+        uint32_t packedIndices = 0;
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            packedIndices |= static_cast<uint32_t>( indices[i] ) << ( i * 2 );
+        }
+
+        block[0] = static_cast<uint8_t>( color0 & 0xff );
+        block[1] = static_cast<uint8_t>( color0 >> 8 );
+        block[2] = static_cast<uint8_t>( color1 & 0xff );
+        block[3] = static_cast<uint8_t>( color1 >> 8 );
+        for ( int i = 0; i < 4; ++i )
+        {
+            block[4 + i] = static_cast<uint8_t>( packedIndices >> ( i * 8 ) );
+        }
+    }
+
+    // Writes bits to a BC7 block starting at the least significant bit.
+    class BitWriter
+    {
+    public:
+        explicit BitWriter( uint8_t* block )
+            : m_Block( block )
+            , m_BitPosition( 0 )
+        {
+            std::fill( m_Block, m_Block + BlockCompression::BlockSize16, uint8_t( 0 ) );
+        }
+
+        void Write( uint32_t value, uint32_t numBits )
+        {
+            for ( uint32_t i = 0; i < numBits; ++i, ++m_BitPosition )
+            {
+                m_Block[m_BitPosition / 8] |= static_cast<uint8_t>( ( ( value >> i ) & 1 ) << ( m_BitPosition % 8 ) );
+            }
+        }
+
+    private:
+        uint8_t* m_Block;
+        uint32_t m_BitPosition;
+    };
+
+    // Quantize a BC7 mode 6 endpoint to 7 bits per channel and a shared p-bit.
+    void QuantizeBC7Endpoint( const float* endpoint, uint8_t* quantized, uint8_t& pBit )
+    {
+        float bestError = std::numeric_limits<float>::max();
+        for ( uint8_t p = 0; p < 2; ++p )
+        {
+            uint8_t q[4];
+            float error = 0.0f;
+            for ( int c = 0; c < 4; ++c )
+            {
+                q[c] = static_cast<uint8_t>( glm::clamp( std::round( ( endpoint[c] - p ) / 2.0f ), 0.0f, 127.0f ) );
+                float d = endpoint[c] - ( ( q[c] << 1 ) | p );
+                error += d * d;
+            }
+
+            if ( error < bestError )
+            {
+                bestError = error;
+                pBit = p;
+                std::copy( q, q + 4, quantized );
+            }
+        }
+    }
+
+    void BC7Palette( const uint8_t* quantized0, uint8_t pBit0, const uint8_t* quantized1, uint8_t pBit1, int ( *palette )[4] )
+    {
+        for ( int c = 0; c < 4; ++c )
+        {
+            int e0 = ( quantized0[c] << 1 ) | pBit0;
+            int e1 = ( quantized1[c] << 1 ) | pBit1;
+            for ( int i = 0; i < 16; ++i )
+            {
+                palette[i][c] = ( ( 64 - BC7Weights[i] ) * e0 + BC7Weights[i] * e1 + 32 ) >> 6;
+            }
+        }
+    }
+}
+
+void BlockCompression::EncodeBC1( const uint8_t* rgba, uint8_t* block )
+{
+    EncodeColorBlock( rgba, block );
+}
+
+void BlockCompression::EncodeBC3( const uint8_t* rgba, uint8_t* block )
+{
+    EncodeBC4( rgba + 3, block, 4 );
+    EncodeColorBlock( rgba, block + BlockSize8 );
+}
+
+void BlockCompression::EncodeBC4( const uint8_t* red, uint8_t* block, size_t stride )
+{
+    uint8_t minValue = 255;
+    uint8_t maxValue = 0;
+    for ( int i = 0; i < NumTexels; ++i )
+    {
+        minValue = std::min( minValue, red[i * stride] );
+        maxValue = std::max( maxValue, red[i * stride] );
+    }
+
+    // With red0 > red1, the block interpolates 6 values between the endpoints.
+    int palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for ( int i = 1; i < 7; ++i )
+    {
+        palette[i + 1] = ( ( 7 - i ) * maxValue + i * minValue + 3 ) / 7;
+    }
+
+    uint64_t packedIndices = 0;
+    if ( maxValue > minValue )
+    {
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            uint64_t bestIndex = 0;
+            int bestError = std::numeric_limits<int>::max();
+            for ( int p = 0; p < 8; ++p )
+            {
+                int error = std::abs( red[i * stride] - palette[p] );
+                if ( error < bestError )
+                {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            packedIndices |= bestIndex << ( i * 3 );
+        }
+    }
+
+    block[0] = maxValue;
+    block[1] = minValue;
+    for ( int i = 0; i < 6; ++i )
+    {
+        block[2 + i] = static_cast<uint8_t>( packedIndices >> ( i * 8 ) );
+    }
+}
+
+void BlockCompression::EncodeBC5( const uint8_t* rgba, uint8_t* block )
+{
+    EncodeBC4( rgba, block, 4 );
+    EncodeBC4( rgba + 1, block + BlockSize8, 4 );
+}
+
+void BlockCompression::EncodeBC7( const uint8_t* rgba, uint8_t* block )
+{
+    float endpoint0[4], endpoint1[4];
+    FitEndpoints<4>( rgba, endpoint0, endpoint1 );
+
+    uint8_t quantized0[4], quantized1[4];
+    uint8_t pBit0, pBit1;
+    QuantizeBC7Endpoint( endpoint0, quantized0, pBit0 );
+    QuantizeBC7Endpoint( endpoint1, quantized1, pBit1 );
+
+    int palette[16][4];
+    uint8_t indices[NumTexels];
+    BC7Palette( quantized0, pBit0, quantized1, pBit1, palette );
+    int error = SelectIndices<4>( rgba, palette, 16, indices );
+
+    // Refine the endpoints as long as the error decreases.
+    for ( int iteration = 0; iteration < 2 && error > 0; ++iteration )
+    {
+        float texelWeights[NumTexels];
+        for ( int i = 0; i < NumTexels; ++i )
+        {
+            texelWeights[i] = BC7Weights[indices[i]] / 64.0f;
+        }
+
+        float refined0[4], refined1[4];
+        if ( !RefineEndpoints<4>( rgba, texelWeights, refined0, refined1 ) )
+        {
+            break;
+        }
+
+        uint8_t refinedQuantized0[4], refinedQuantized1[4];
+        uint8_t refinedPBit0, refinedPBit1;
+        QuantizeBC7Endpoint( refined0, refinedQuantized0, refinedPBit0 );
+        QuantizeBC7Endpoint( refined1, refinedQuantized1, refinedPBit1 );
+
+        int refinedPalette[16][4];
+        uint8_t refinedIndices[NumTexels];
+        BC7Palette( refinedQuantized0, refinedPBit0, refinedQuantized1, refinedPBit1, refinedPalette );
+        int refinedError = SelectIndices<4>( rgba, refinedPalette, 16, refinedIndices );
+        if ( refinedError >= error )
+        {
+            break;
+        }
+
+        std::copy( refinedQuantized0, refinedQuantized0 + 4, quantized0 );
+        std::copy( refinedQuantized1, refinedQuantized1 + 4, quantized1 );
+        pBit0 = refinedPBit0;
+        pBit1 = refinedPBit1;
+        error = refinedError;
+        std::copy( refinedIndices, refinedIndices + NumTexels, indices );
+    }
+
+    // The most significant bit of the index of the first texel (the anchor) is implicitly 0.
+    if ( indices[0] & 8 )
+    {
+        std::swap_ranges( quantized0, quantized0 + 4, quantized1 );
+        std::swap( pBit0, pBit1 );
+        for ( auto& index : indices )
+        {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer( block );
+    // Mode 6 is encoded as 6 zero bits followed by a one bit.
+    writer.Write( 1 << 6, 7 );
+    for ( int c = 0; c < 4; ++c )
+    {
+        writer.Write( quantized0[c], 7 );
+        writer.Write( quantized1[c], 7 );
+    }
+    writer.Write( pBit0, 1 );
+    writer.Write( pBit1, 1 );
+    writer.Write( indices[0], 3 );
+    for ( int i = 1; i < NumTexels; ++i )
+    {
+        writer.Write( indices[i], 4 );
+    }
+}
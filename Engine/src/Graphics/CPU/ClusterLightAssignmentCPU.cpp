@@ -0,0 +1,475 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/ClusterLightAssignmentCPU.h>
+#include <Graphics/CPU/LightBVHCPU.h>
+#include <Graphics/CPU/SIMD.h>
+
+#include <Graphics/PointLight.h>
+#include <Graphics/SpotLight.h>
+
+#include <Common.h>
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The number of unique clusters that are processed by a single task.
+    const uint32_t CLUSTERS_PER_CHUNK = 64;
+
+    // Maximum depth of the node stack used to traverse the BVH. Each inner node
+    // that is popped pushes at most BranchingFactor children, so the stack never
+    // holds more than the root node plus BranchingFactor nodes per level.
+    const uint32_t NODE_STACK_SIZE = 1 + LightBVHCPU::MaxLevels * LightBVHCPU::BranchingFactor;
+
+    inline uint32_t GetFirstChild( uint32_t parentIndex, uint32_t numLevels )
+    {
+        return ( numLevels > 0 ) ? parentIndex * LightBVHCPU::BranchingFactor + 1 : 0;
+    }
+
+    inline bool IsLeafNode( uint32_t childIndex, uint32_t numLevels )
+    {
+        return ( numLevels > 0 ) ? childIndex > ( LightBVHCPU::GetFirstNodeIndex( numLevels ) - 1 ) : true;
+    }
+
+    inline uint32_t GetLeafIndex( uint32_t nodeIndex, uint32_t numLevels )
+    {
+        return ( numLevels > 0 ) ? nodeIndex - LightBVHCPU::GetFirstNodeIndex( numLevels ) : nodeIndex;
+    }
+
+    /**
+     * Test SIMD::Width spheres against an AABB.
+     * The squared distance is accumulated in the same order as SqDistancePointAABB
+     * in Functions.hlsli so that the result is identical to the compute shader.
+     * @returns A bitmask with a bit set for every sphere that intersects the AABB.
+     */
+    inline uint32_t SpheresInsideAABB( const float* x, const float* y, const float* z, const float* rangeSq, const BoundingBox& aabb )
+    {
+#if defined(ENGINE_SIMD_AVX)
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 px = _mm256_loadu_ps( x );
+        __m256 py = _mm256_loadu_ps( y );
+        __m256 pz = _mm256_loadu_ps( z );
+
+        __m256 dx = _mm256_add_ps( _mm256_max_ps( _mm256_sub_ps( _mm256_set1_ps( aabb.m_Min.x ), px ), zero ), _mm256_max_ps( _mm256_sub_ps( px, _mm256_set1_ps( aabb.m_Max.x ) ), zero ) );
+        __m256 dy = _mm256_add_ps( _mm256_max_ps( _mm256_sub_ps( _mm256_set1_ps( aabb.m_Min.y ), py ), zero ), _mm256_max_ps( _mm256_sub_ps( py, _mm256_set1_ps( aabb.m_Max.y ) ), zero ) );
+        __m256 dz = _mm256_add_ps( _mm256_max_ps( _mm256_sub_ps( _mm256_set1_ps( aabb.m_Min.z ), pz ), zero ), _mm256_max_ps( _mm256_sub_ps( pz, _mm256_set1_ps( aabb.m_Max.z ) ), zero ) );
+
+        __m256 sqDistance = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( dx, dx ), _mm256_mul_ps( dy, dy ) ), _mm256_mul_ps( dz, dz ) );
+
+        return static_cast<uint32_t>( _mm256_movemask_ps( _mm256_cmp_ps( sqDistance, _mm256_loadu_ps( rangeSq ), _CMP_LE_OQ ) ) );
+#elif defined(ENGINE_SIMD_SSE2)
+        const __m128 zero = _mm_setzero_ps();
+        __m128 px = _mm_loadu_ps( x );
+        __m128 py = _mm_loadu_ps( y );
+        __m128 pz = _mm_loadu_ps( z );
+
+        __m128 dx = _mm_add_ps( _mm_max_ps( _mm_sub_ps( _mm_set1_ps( aabb.m_Min.x ), px ), zero ), _mm_max_ps( _mm_sub_ps( px, _mm_set1_ps( aabb.m_Max.x ) ), zero ) );
+        __m128 dy = _mm_add_ps( _mm_max_ps( _mm_sub_ps( _mm_set1_ps( aabb.m_Min.y ), py ), zero ), _mm_max_ps( _mm_sub_ps( py, _mm_set1_ps( aabb.m_Max.y ) ), zero ) );
+        __m128 dz = _mm_add_ps( _mm_max_ps( _mm_sub_ps( _mm_set1_ps( aabb.m_Min.z ), pz ), zero ), _mm_max_ps( _mm_sub_ps( pz, _mm_set1_ps( aabb.m_Max.z ) ), zero ) );
+
+        __m128 sqDistance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) ), _mm_mul_ps( dz, dz ) );
+
+        return static_cast<uint32_t>( _mm_movemask_ps( _mm_cmple_ps( sqDistance, _mm_loadu_ps( rangeSq ) ) ) );
+#else
+        float dx = std::max( aabb.m_Min.x - *x, 0.0f ) + std::max( *x - aabb.m_Max.x, 0.0f );
+        float dy = std::max( aabb.m_Min.y - *y, 0.0f ) + std::max( *y - aabb.m_Max.y, 0.0f );
+        float dz = std::max( aabb.m_Min.z - *z, 0.0f ) + std::max( *z - aabb.m_Max.z, 0.0f );
+
+        return ( dx * dx + dy * dy + dz * dz ) <= *rangeSq ? 1u : 0u;
+#endif
+    }
+
+    // Check to see if an AABB intersects another AABB.
+    inline bool AABBIntersectAABB( const BoundingBox& a, const BoundingBox& b )
+    {
+#if defined(ENGINE_SIMD_SSE2)
+        __m128 aMin = _mm_load_ps( &a.m_Min.x );
+        __m128 aMax = _mm_load_ps( &a.m_Max.x );
+        __m128 bMin = _mm_load_ps( &b.m_Min.x );
+        __m128 bMax = _mm_load_ps( &b.m_Max.x );
+
+        // Only the x, y, and z components are considered.
+        return ( _mm_movemask_ps( _mm_and_ps( _mm_cmpge_ps( aMax, bMin ), _mm_cmple_ps( aMin, bMax ) ) ) & 0x7 ) == 0x7;
+#else
+        return a.Intersects( b );
+#endif
+    }
+
+    // Append a light to a cluster's light list.
+    // Lights that don't fit in the light list are dropped (like in the compute shaders).
+    struct LightListAppender
+    {
+        std::vector<uint32_t>& Indices;
+        uint32_t MaxLights;
+        uint32_t Count;
+
+        LightListAppender( std::vector<uint32_t>& indices, uint32_t maxLights )
+            : Indices( indices )
+            , MaxLights( maxLights )
+            , Count( 0 )
+        {}
+
+        void Append( uint32_t lightIndex )
+        {
+            if ( Count < MaxLights )
+            {
+                Indices.push_back( lightIndex );
+            }
+            ++Count;
+        }
+
+        uint32_t GetCount() const
+        {
+            return std::min( Count, MaxLights );
+        }
+
+        bool IsTruncated() const
+        {
+            return Count > MaxLights;
+        }
+    };
+}
+
+void ClusterLightAssignmentCPU::LightSpheres::Resize( uint32_t numLights )
+{
+    // Pad the arrays so that SIMD loads never read past the end of the arrays.
+    // Padding uses a negative range so they never intersect anything.
+    uint32_t paddedSize = Math::AlignUp( numLights, LightBVHCPU::BranchingFactor ) + SIMD::Width;
+
+    X.resize( paddedSize );
+    Y.resize( paddedSize );
+    Z.resize( paddedSize );
+    RangeSq.resize( paddedSize );
+    LightIndex.resize( paddedSize );
+
+    std::fill( X.begin() + numLights, X.end(), 0.0f );
+    std::fill( Y.begin() + numLights, Y.end(), 0.0f );
+    std::fill( Z.begin() + numLights, Z.end(), 0.0f );
+    std::fill( RangeSq.begin() + numLights, RangeSq.end(), -1.0f );
+    std::fill( LightIndex.begin() + numLights, LightIndex.end(), 0 );
+
+    NumLights = numLights;
+}
+
+ClusterLightAssignmentCPU::ClusterLightAssignmentCPU()
+    : m_ThreadPool( Core::ThreadPool::Get() )
+    , m_ExactLightLists( false )
+{}
+
+ClusterLightAssignmentCPU::ClusterLightAssignmentCPU( Core::ThreadPool& threadPool )
+    : m_ThreadPool( threadPool )
+    , m_ExactLightLists( false )
+{}
+
+ClusterLightAssignmentCPU::~ClusterLightAssignmentCPU()
+{}
+
+void ClusterLightAssignmentCPU::SetExactLightLists( bool exactLightLists )
+{
+    m_ExactLightLists = exactLightLists;
+}
+
+bool ClusterLightAssignmentCPU::GetExactLightLists() const
+{
+    return m_ExactLightLists;
+}
+
+uint32_t ClusterLightAssignmentCPU::GetMaxLights( uint32_t maxLights ) const
+{
+    if ( m_ExactLightLists )
+    {
+        return std::numeric_limits<uint32_t>::max();
+    }
+    return maxLights;
+}
+
+uint32_t ClusterLightAssignmentCPU::PrefixSumLightGrid( glm::uvec2* grid, uint32_t numClusters )
+{
+    uint32_t offset = 0;
+    for ( uint32_t i = 0; i < numClusters; ++i )
+    {
+        grid[i].x = offset;
+        offset += grid[i].y;
+    }
+    return offset;
+}
+
+template<typename LightType>
+void ClusterLightAssignmentCPU::BuildLightSpheres( const LightType* lights, uint32_t numLights, const uint32_t* lightIndices, LightSpheres& spheres )
+{
+    spheres.Resize( numLights );
+
+    m_ThreadPool.ParallelFor( 0, numLights, 4096, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            uint32_t lightIndex = lightIndices ? lightIndices[i] : i;
+            const LightType& light = lights[lightIndex];
+
+            spheres.X[i] = light.m_PositionVS.x;
+            spheres.Y[i] = light.m_PositionVS.y;
+            spheres.Z[i] = light.m_PositionVS.z;
+            spheres.RangeSq[i] = light.m_Enabled ? light.m_Range * light.m_Range : -1.0f;
+            spheres.LightIndex[i] = lightIndex;
+        }
+    } );
+}
+
+template<typename ClusterFunc>
+void ClusterLightAssignmentCPU::AssignClusters( const ClusterLightAssignmentArgs& args, ClusterFunc clusterFunc, ClusterLightList& pointLights, ClusterLightList& spotLights )
+{
+    uint32_t numChunks = Math::DivideByMultiple( args.NumUniqueClusters, CLUSTERS_PER_CHUNK );
+
+    m_PointLightChunks.resize( numChunks );
+    m_SpotLightChunks.resize( numChunks );
+
+    m_ThreadPool.ParallelFor( 0, numChunks, 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+    {
+        for ( uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk )
+        {
+            ClusterChunk& pointLightChunk = m_PointLightChunks[chunk];
+            ClusterChunk& spotLightChunk = m_SpotLightChunks[chunk];
+
+            pointLightChunk.Counts.clear();
+            pointLightChunk.Indices.clear();
+            pointLightChunk.NumTruncated = 0;
+            pointLightChunk.NodeTests = 0;
+            pointLightChunk.LightTests = 0;
+            spotLightChunk.Counts.clear();
+            spotLightChunk.Indices.clear();
+            spotLightChunk.NumTruncated = 0;
+            spotLightChunk.NodeTests = 0;
+            spotLightChunk.LightTests = 0;
+
+            uint32_t first = chunk * CLUSTERS_PER_CHUNK;
+            uint32_t last = std::min( first + CLUSTERS_PER_CHUNK, args.NumUniqueClusters );
+
+            for ( uint32_t i = first; i < last; ++i )
+            {
+                const BoundingBox& clusterAABB = args.ClusterAABBs[args.UniqueClusters[i]];
+                clusterFunc( clusterAABB, pointLightChunk, spotLightChunk );
+            }
+        }
+    } );
+
+    GatherLightList( args, m_PointLightChunks, pointLights );
+    GatherLightList( args, m_SpotLightChunks, spotLights );
+}
+
+void ClusterLightAssignmentCPU::GatherLightList( const ClusterLightAssignmentArgs& args, std::vector<ClusterChunk>& chunks, ClusterLightList& lightList )
+{
+    // Clusters that are not in the unique clusters list have no lights.
+    lightList.Grid.assign( args.NumClusters, glm::uvec2( 0 ) );
+    lightList.NumTruncatedClusters = 0;
+    lightList.NodeTests = 0;
+    lightList.LightTests = 0;
+
+    // Compute the start offset of each chunk in the light index list.
+    uint32_t offset = 0;
+    for ( auto& chunk : chunks )
+    {
+        chunk.Offset = offset;
+        offset += static_cast<uint32_t>( chunk.Indices.size() );
+        lightList.NumTruncatedClusters += chunk.NumTruncated;
+        lightList.NodeTests += chunk.NodeTests;
+        lightList.LightTests += chunk.LightTests;
+    }
+
+    if ( m_ExactLightLists )
+    {
+        // Write the light counts to the light grid and compute the offsets
+        // in cluster order (like PrefixSumLightGrid_CS.hlsl).
+        m_ThreadPool.ParallelFor( 0, static_cast<uint32_t>( chunks.size() ), 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+        {
+            for ( uint32_t c = chunkBegin; c < chunkEnd; ++c )
+            {
+                const ClusterChunk& chunk = chunks[c];
+                uint32_t first = c * CLUSTERS_PER_CHUNK;
+
+                for ( uint32_t i = 0; i < chunk.Counts.size(); ++i )
+                {
+                    lightList.Grid[args.UniqueClusters[first + i]].y = chunk.Counts[i];
+                }
+            }
+        } );
+
+        lightList.IndexCount = PrefixSumLightGrid( lightList.Grid.data(), args.NumClusters );
+        lightList.IndexList.resize( lightList.IndexCount );
+
+        m_ThreadPool.ParallelFor( 0, static_cast<uint32_t>( chunks.size() ), 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+        {
+            for ( uint32_t c = chunkBegin; c < chunkEnd; ++c )
+            {
+                const ClusterChunk& chunk = chunks[c];
+                uint32_t first = c * CLUSTERS_PER_CHUNK;
+                auto src = chunk.Indices.begin();
+
+                for ( uint32_t i = 0; i < chunk.Counts.size(); ++i )
+                {
+                    const glm::uvec2& cell = lightList.Grid[args.UniqueClusters[first + i]];
+                    std::copy( src, src + cell.y, lightList.IndexList.begin() + cell.x );
+                    src += cell.y;
+                }
+            }
+        } );
+
+        return;
+    }
+
+    lightList.IndexCount = offset;
+    lightList.IndexList.resize( offset );
+
+    m_ThreadPool.ParallelFor( 0, static_cast<uint32_t>( chunks.size() ), 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+    {
+        for ( uint32_t c = chunkBegin; c < chunkEnd; ++c )
+        {
+            const ClusterChunk& chunk = chunks[c];
+            uint32_t clusterOffset = chunk.Offset;
+            uint32_t first = c * CLUSTERS_PER_CHUNK;
+
+            for ( uint32_t i = 0; i < chunk.Counts.size(); ++i )
+            {
+                lightList.Grid[args.UniqueClusters[first + i]] = glm::uvec2( clusterOffset, chunk.Counts[i] );
+                clusterOffset += chunk.Counts[i];
+            }
+
+            std::copy( chunk.Indices.begin(), chunk.Indices.end(), lightList.IndexList.begin() + chunk.Offset );
+        }
+    } );
+}
+
+void ClusterLightAssignmentCPU::AssignLights( const ClusterLightAssignmentArgs& args, ClusterLightList& pointLights, ClusterLightList& spotLights )
+{
+    BuildLightSpheres( args.PointLights, args.NumPointLights, nullptr, m_PointLightSpheres );
+    BuildLightSpheres( args.SpotLights, args.NumSpotLights, nullptr, m_SpotLightSpheres );
+
+    uint32_t maxLights = GetMaxLights( MaxLightsPerCluster );
+
+    auto intersectLights = [maxLights]( const LightSpheres& spheres, const BoundingBox& clusterAABB, ClusterChunk& chunk )
+    {
+        LightListAppender lightList( chunk.Indices, maxLights );
+
+        for ( uint32_t i = 0; i < spheres.NumLights; i += SIMD::Width )
+        {
+            uint32_t mask = SpheresInsideAABB( &spheres.X[i], &spheres.Y[i], &spheres.Z[i], &spheres.RangeSq[i], clusterAABB );
+            SIMD::ForEachBit( mask, [&]( uint32_t bit )
+            {
+                lightList.Append( i + bit );
+            } );
+        }
+
+        chunk.Counts.push_back( lightList.GetCount() );
+        chunk.NumTruncated += lightList.IsTruncated() ? 1 : 0;
+        chunk.LightTests += spheres.NumLights;
+    };
+
+    AssignClusters( args, [&]( const BoundingBox& clusterAABB, ClusterChunk& pointLightChunk, ClusterChunk& spotLightChunk )
+    {
+        intersectLights( m_PointLightSpheres, clusterAABB, pointLightChunk );
+        intersectLights( m_SpotLightSpheres, clusterAABB, spotLightChunk );
+    }, pointLights, spotLights );
+}
+
+void ClusterLightAssignmentCPU::AssignLightsBVH( const ClusterLightAssignmentArgs& args, const LightBVHArgs& bvh, ClusterLightList& pointLights, ClusterLightList& spotLights )
+{
+    // Lights are stored in BVH leaf order so that the 32 leaves of a BVH node
+    // can be tested against the cluster with contiguous SIMD loads.
+    BuildLightSpheres( args.PointLights, args.NumPointLights, bvh.PointLightIndices, m_PointLightSpheres );
+    BuildLightSpheres( args.SpotLights, args.NumSpotLights, bvh.SpotLightIndices, m_SpotLightSpheres );
+
+    uint32_t maxLights = GetMaxLights( MaxLightsPerClusterBVH );
+
+    auto traverseBVH = [maxLights]( const LightSpheres& spheres, const BoundingBox* nodes, uint32_t numLevels, const BoundingBox& clusterAABB, ClusterChunk& chunk )
+    {
+        LightListAppender lightList( chunk.Indices, maxLights );
+
+        // Same traversal order as the compute shader: The root node is
+        // pushed first and the traversal stops when it is popped again.
+        uint32_t nodeStack[NODE_STACK_SIZE];
+        uint32_t stackPtr = 0;
+        uint32_t parentIndex = 0;
+
+        nodeStack[stackPtr++] = 0;
+
+        do
+        {
+            uint32_t firstChild = GetFirstChild( parentIndex, numLevels );
+
+            if ( IsLeafNode( firstChild, numLevels ) )
+            {
+                // All children of the last level of the BVH are leaves.
+                uint32_t firstLeaf = GetLeafIndex( firstChild, numLevels );
+                uint32_t lastLeaf = std::min( firstLeaf + LightBVHCPU::BranchingFactor, spheres.NumLights );
+                chunk.LightTests += lastLeaf - std::min( firstLeaf, lastLeaf );
+                for ( uint32_t i = 0; i < LightBVHCPU::BranchingFactor && firstLeaf + i < spheres.NumLights; i += SIMD::Width )
+                {
+                    uint32_t leaf = firstLeaf + i;
+                    uint32_t mask = SpheresInsideAABB( &spheres.X[leaf], &spheres.Y[leaf], &spheres.Z[leaf], &spheres.RangeSq[leaf], clusterAABB );
+                    SIMD::ForEachBit( mask, [&]( uint32_t bit )
+                    {
+                        // Padding lights never pass the intersection test.
+                        lightList.Append( spheres.LightIndex[leaf + bit] );
+                    } );
+                }
+            }
+            else
+            {
+                chunk.NodeTests += LightBVHCPU::BranchingFactor;
+                for ( uint32_t i = 0; i < LightBVHCPU::BranchingFactor; ++i )
+                {
+                    uint32_t childIndex = firstChild + i;
+                    if ( AABBIntersectAABB( clusterAABB, nodes[childIndex] ) )
+                    {
+                        assert( stackPtr < NODE_STACK_SIZE );
+                        nodeStack[stackPtr++] = childIndex;
+                    }
+                }
+            }
+
+            parentIndex = nodeStack[--stackPtr];
+
+        } while ( parentIndex > 0 );
+
+        chunk.Counts.push_back( lightList.GetCount() );
+        chunk.NumTruncated += lightList.IsTruncated() ? 1 : 0;
+    };
+
+    AssignClusters( args, [&]( const BoundingBox& clusterAABB, ClusterChunk& pointLightChunk, ClusterChunk& spotLightChunk )
+    {
+        traverseBVH( m_PointLightSpheres, bvh.PointLightBVH, bvh.PointLightLevels, clusterAABB, pointLightChunk );
+        traverseBVH( m_SpotLightSpheres, bvh.SpotLightBVH, bvh.SpotLightLevels, clusterAABB, spotLightChunk );
+    }, pointLights, spotLights );
+}
+
+bool ClusterLightAssignmentCPU::Compare( const glm::uvec2* gridA, const uint32_t* indexListA,
+                                         const glm::uvec2* gridB, const uint32_t* indexListB,
+                                         const uint32_t* uniqueClusters, uint32_t numUniqueClusters )
+{
+    std::vector<uint32_t> lightsA;
+    std::vector<uint32_t> lightsB;
+
+    for ( uint32_t i = 0; i < numUniqueClusters; ++i )
+    {
+        uint32_t clusterIndex = uniqueClusters[i];
+        const glm::uvec2& a = gridA[clusterIndex];
+        const glm::uvec2& b = gridB[clusterIndex];
+
+        if ( a.y != b.y ) return false;
+
+        lightsA.assign( indexListA + a.x, indexListA + a.x + a.y );
+        lightsB.assign( indexListB + b.x, indexListB + b.x + b.y );
+
+        std::sort( lightsA.begin(), lightsA.end() );
+        std::sort( lightsB.begin(), lightsB.end() );
+
+        if ( lightsA != lightsB ) return false;
+    }
+
+    return true;
+}
+
+bool ClusterLightAssignmentCPU::Compare( const ClusterLightList& a, const ClusterLightList& b, const uint32_t* uniqueClusters, uint32_t numUniqueClusters )
+{
+    return Compare( a.Grid.data(), a.IndexList.data(), b.Grid.data(), b.IndexList.data(), uniqueClusters, numUniqueClusters );
+}
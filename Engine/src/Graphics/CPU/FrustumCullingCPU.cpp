@@ -0,0 +1,164 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/FrustumCullingCPU.h>
+#include <Graphics/CPU/SIMD.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The arrays are padded to a multiple of 32 boxes so that every word of the
+    // visibility masks can be computed with full SIMD loads.
+    const uint32_t BOXES_PER_WORD = 32;
+
+    // The extents of boxes that must never be culled. The distance to any
+    // plane can be computed without overflowing.
+    const float INFINITE_EXTENT = std::numeric_limits<float>::max() * 0.25f;
+
+    /**
+     * Test SIMD::Width boxes against the planes of a frustum.
+     * A box is culled if the projected extents of the box onto the plane normal
+     * don't reach the positive halfspace of the plane.
+     * Source: Optimized View Frustum Culling Algorithms for Bounding Boxes (2000),
+     * Ulf Assarsson and Tomas Möller.
+     * @returns A bitmask with a bit set for every box that is (partially) inside the frustum.
+     */
+    inline uint32_t BoxesInsideFrustum( const float* cx, const float* cy, const float* cz,
+                                        const float* ex, const float* ey, const float* ez, const Frustum& frustum )
+    {
+#if defined(ENGINE_SIMD_AVX)
+        __m256 centerX = _mm256_loadu_ps( cx );
+        __m256 centerY = _mm256_loadu_ps( cy );
+        __m256 centerZ = _mm256_loadu_ps( cz );
+        __m256 extentX = _mm256_loadu_ps( ex );
+        __m256 extentY = _mm256_loadu_ps( ey );
+        __m256 extentZ = _mm256_loadu_ps( ez );
+        __m256 inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+
+        for ( uint32_t i = 0; i < Frustum::NumPlanes; ++i )
+        {
+            const glm::vec4& plane = frustum.Planes[i];
+            __m256 distance = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( plane.x ), centerX ), _mm256_mul_ps( _mm256_set1_ps( plane.y ), centerY ) ),
+                                             _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( plane.z ), centerZ ), _mm256_set1_ps( plane.w ) ) );
+            __m256 radius = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( std::abs( plane.x ) ), extentX ), _mm256_mul_ps( _mm256_set1_ps( std::abs( plane.y ) ), extentY ) ),
+                                           _mm256_mul_ps( _mm256_set1_ps( std::abs( plane.z ) ), extentZ ) );
+            inside = _mm256_and_ps( inside, _mm256_cmp_ps( _mm256_add_ps( distance, radius ), _mm256_setzero_ps(), _CMP_GE_OQ ) );
+        }
+
+        return static_cast<uint32_t>( _mm256_movemask_ps( inside ) );
+#elif defined(ENGINE_SIMD_SSE2)
+        __m128 centerX = _mm_loadu_ps( cx );
+        __m128 centerY = _mm_loadu_ps( cy );
+        __m128 centerZ = _mm_loadu_ps( cz );
+        __m128 extentX = _mm_loadu_ps( ex );
+        __m128 extentY = _mm_loadu_ps( ey );
+        __m128 extentZ = _mm_loadu_ps( ez );
+        __m128 inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+
+        for ( uint32_t i = 0; i < Frustum::NumPlanes; ++i )
+        {
+            const glm::vec4& plane = frustum.Planes[i];
+            __m128 distance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( plane.x ), centerX ), _mm_mul_ps( _mm_set1_ps( plane.y ), centerY ) ),
+                                          _mm_add_ps( _mm_mul_ps( _mm_set1_ps( plane.z ), centerZ ), _mm_set1_ps( plane.w ) ) );
+            __m128 radius = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( std::abs( plane.x ) ), extentX ), _mm_mul_ps( _mm_set1_ps( std::abs( plane.y ) ), extentY ) ),
+                                        _mm_mul_ps( _mm_set1_ps( std::abs( plane.z ) ), extentZ ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( _mm_add_ps( distance, radius ), _mm_setzero_ps() ) );
+        }
+
+        return static_cast<uint32_t>( _mm_movemask_ps( inside ) );
+#else
+        for ( uint32_t i = 0; i < Frustum::NumPlanes; ++i )
+        {
+            const glm::vec4& plane = frustum.Planes[i];
+            float distance = plane.x * *cx + plane.y * *cy + plane.z * *cz + plane.w;
+            float radius = std::abs( plane.x ) * *ex + std::abs( plane.y ) * *ey + std::abs( plane.z ) * *ez;
+            if ( distance + radius < 0.0f )
+            {
+                return 0u;
+            }
+        }
+        return 1u;
+#endif
+    }
+}
+
+FrustumCullingCPU::FrustumCullingCPU()
+    : m_NumBoundingBoxes( 0 )
+{}
+
+FrustumCullingCPU::~FrustumCullingCPU()
+{}
+
+void FrustumCullingCPU::Clear()
+{
+    m_NumBoundingBoxes = 0;
+}
+
+uint32_t FrustumCullingCPU::AddBoundingBox( const BoundingBox& boundingBox )
+{
+    if ( m_NumBoundingBoxes == m_CenterX.size() )
+    {
+        size_t paddedSize = m_CenterX.size() + BOXES_PER_WORD;
+
+        // The padding is never visible.
+        m_CenterX.resize( paddedSize, 0.0f );
+        m_CenterY.resize( paddedSize, 0.0f );
+        m_CenterZ.resize( paddedSize, 0.0f );
+        m_ExtentX.resize( paddedSize, 0.0f );
+        m_ExtentY.resize( paddedSize, 0.0f );
+        m_ExtentZ.resize( paddedSize, 0.0f );
+    }
+
+    uint32_t index = m_NumBoundingBoxes++;
+
+    glm::vec3 center( 0.0f );
+    glm::vec3 extents( INFINITE_EXTENT );
+    if ( boundingBox.IsValid() )
+    {
+        center = boundingBox.GetCenter();
+        extents = boundingBox.GetExtents();
+    }
+
+    m_CenterX[index] = center.x;
+    m_CenterY[index] = center.y;
+    m_CenterZ[index] = center.z;
+    m_ExtentX[index] = extents.x;
+    m_ExtentY[index] = extents.y;
+    m_ExtentZ[index] = extents.z;
+
+    return index;
+}
+
+uint32_t FrustumCullingCPU::GetNumBoundingBoxes() const
+{
+    return m_NumBoundingBoxes;
+}
+
+uint32_t FrustumCullingCPU::Cull( const Frustum& frustum, std::vector<uint32_t>& visibilityMasks ) const
+{
+    const uint32_t numWords = ( m_NumBoundingBoxes + BOXES_PER_WORD - 1 ) / BOXES_PER_WORD;
+    visibilityMasks.resize( numWords );
+
+    uint32_t numVisible = 0;
+    for ( uint32_t word = 0; word < numWords; ++word )
+    {
+        uint32_t mask = 0;
+        for ( uint32_t bit = 0; bit < BOXES_PER_WORD; bit += SIMD::Width )
+        {
+            uint32_t i = word * BOXES_PER_WORD + bit;
+            mask |= BoxesInsideFrustum( &m_CenterX[i], &m_CenterY[i], &m_CenterZ[i], &m_ExtentX[i], &m_ExtentY[i], &m_ExtentZ[i], frustum ) << bit;
+        }
+
+        // Clear the bits of the padding.
+        uint32_t numBoxes = std::min( m_NumBoundingBoxes - word * BOXES_PER_WORD, BOXES_PER_WORD );
+        if ( numBoxes < BOXES_PER_WORD )
+        {
+            mask &= ( 1u << numBoxes ) - 1;
+        }
+
+        visibilityMasks[word] = mask;
+        numVisible += SIMD::CountBits( mask );
+    }
+
+    return numVisible;
+}
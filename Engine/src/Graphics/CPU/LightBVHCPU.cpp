@@ -0,0 +1,516 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/LightBVHCPU.h>
+#include <Graphics/CPU/RadixSortCPU.h>
+
+#include <Graphics/PointLight.h>
+#include <Graphics/SpotLight.h>
+
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The number of nodes at each level of the BVH.
+    const uint32_t gs_NumLevelNodes[] =
+    {
+        1,          // 1st level (32^0)
+        32,         // 2nd level (32^1)
+        1024,       // 3rd level (32^2)
+        32768,      // 4th level (32^3)
+        1048576,    // 5th level (32^4)
+        33554432,   // 6th level (32^5)
+    };
+
+    // The number of nodes required to represent a BVH given the number of levels
+    // of the BVH. This is also the index of the first node of the next level.
+    const uint32_t gs_NumBVHNodes[] =
+    {
+        1,          // 1 level  =32^0
+        33,         // 2 levels +32^1
+        1057,       // 3 levels +32^2
+        33825,      // 4 levels +32^3
+        1082401,    // 5 levels +32^4
+        34636833,   // 6 levels +32^5
+    };
+
+    // The (maximum) number of bottom level nodes that are used to estimate the
+    // cost of the tree before it is refitted.
+    const uint32_t gs_NumCostSamples = 256;
+
+    // Spread the lower 21 bits of v so that there are 2 zero bits between each bit.
+    inline uint64_t ExpandBits( uint32_t x )
+    {
+        uint64_t v = x & 0x1fffff;
+        v = ( v | ( v << 32 ) ) & 0x001f00000000ffffull;
+        v = ( v | ( v << 16 ) ) & 0x001f0000ff0000ffull;
+        v = ( v | ( v << 8 ) ) & 0x100f00f00f00f00full;
+        v = ( v | ( v << 4 ) ) & 0x10c30c30c30c30c3ull;
+        v = ( v | ( v << 2 ) ) & 0x1249249249249249ull;
+        return v;
+    }
+
+    // Produce a 3k-bit Morton code from a quantized coordinate (k <= 21).
+    // The bits are interleaved in the same order as MortonCode in ComputeLightMortonCodes_CS.hlsl.
+    inline uint64_t MortonCode( const glm::uvec3& quantizedCoord )
+    {
+        return ExpandBits( quantizedCoord.x ) | ( ExpandBits( quantizedCoord.y ) << 1 ) | ( ExpandBits( quantizedCoord.z ) << 2 );
+    }
+
+    // The volume of an AABB (0 for empty AABBs).
+    inline float GetVolume( const BoundingBox& aabb )
+    {
+        glm::vec3 d = glm::max( glm::vec3( aabb.m_Max ) - glm::vec3( aabb.m_Min ), glm::vec3( 0 ) );
+        return d.x * d.y * d.z;
+    }
+
+    // The volume of the intersection of two AABBs.
+    inline float GetIntersectionVolume( const BoundingBox& a, const BoundingBox& b )
+    {
+        glm::vec3 d = glm::min( glm::vec3( a.m_Max ), glm::vec3( b.m_Max ) ) - glm::max( glm::vec3( a.m_Min ), glm::vec3( b.m_Min ) );
+        d = glm::max( d, glm::vec3( 0 ) );
+        return d.x * d.y * d.z;
+    }
+
+    // The AABB of a light as computed in BuildBVH_CS.hlsl
+    template<typename LightType>
+    inline BoundingBox GetLightAABB( const LightType& light )
+    {
+        glm::vec3 position( light.m_PositionVS );
+        return BoundingBox( position - light.m_Range, position + light.m_Range );
+    }
+}
+
+uint32_t LightBVHCPU::GetNumLevels( uint32_t numLeaves )
+{
+    // Equivalent to ceil( log( numLeaves ) / log( 32 ) ) but without floating-point rounding errors.
+    uint32_t numLevels = 0;
+    uint64_t numLevelLeaves = 1;
+    while ( numLevelLeaves < numLeaves )
+    {
+        numLevelLeaves *= BranchingFactor;
+        ++numLevels;
+    }
+
+    return numLevels;
+}
+
+uint32_t LightBVHCPU::GetNumNodes( uint32_t numLeaves )
+{
+    uint32_t numLevels = GetNumLevels( numLeaves );
+    uint32_t numNodes = 0;
+    if ( numLevels > 0 && numLevels <= MaxLevels )
+    {
+        numNodes = gs_NumBVHNodes[numLevels - 1];
+    }
+
+    return numNodes;
+}
+
+uint32_t LightBVHCPU::GetNumLevelNodes( uint32_t level )
+{
+    return level < MaxLevels ? gs_NumLevelNodes[level] : 0;
+}
+
+uint32_t LightBVHCPU::GetFirstNodeIndex( uint32_t level )
+{
+    return ( level > 0 && level <= MaxLevels ) ? gs_NumBVHNodes[level - 1] : 0;
+}
+
+BoundingBox LightBVHCPU::ComputeLightsAABB( const PointLight* pointLights, uint32_t numPointLights,
+                                            const SpotLight* spotLights, uint32_t numSpotLights,
+                                            Core::ThreadPool& threadPool )
+{
+    const uint32_t grainSize = 16 * 1024;
+
+    std::mutex mutex;
+    BoundingBox lightsAABB;
+
+    auto reduce = [&]( auto lights, uint32_t numLights )
+    {
+        threadPool.ParallelFor( 0, numLights, grainSize, [&]( uint32_t begin, uint32_t end )
+        {
+            BoundingBox aabb;
+            for ( uint32_t i = begin; i < end; ++i )
+            {
+                aabb.Grow( GetLightAABB( lights[i] ) );
+            }
+
+            scoped_lock lock( mutex );
+            lightsAABB.Grow( aabb );
+        } );
+    };
+
+    reduce( pointLights, numPointLights );
+    reduce( spotLights, numSpotLights );
+
+    return lightsAABB;
+}
+
+LightBVHCPU::LightBVHCPU()
+    : LightBVHCPU( Core::ThreadPool::Get() )
+{}
+
+LightBVHCPU::LightBVHCPU( Core::ThreadPool& threadPool )
+    : m_ThreadPool( threadPool )
+    , m_NumLeaves( 0 )
+    , m_NumLevels( 0 )
+    , m_MortonCodeBits( MortonCodeBits32 )
+    , m_RebuildCost( 0.0f )
+    , m_RebuildEstimatedCost( 0.0f )
+    , m_Cost( 0.0f )
+    , m_RebuildThreshold( 1.5f )
+    , m_NumRebuilds( 0 )
+    , m_NumRefits( 0 )
+    , m_IsValid( false )
+{}
+
+LightBVHCPU::~LightBVHCPU()
+{}
+
+bool LightBVHCPU::Build( const PointLight* lights, uint32_t numLights, const BoundingBox& lightsAABB, BuildMode buildMode )
+{
+    return BuildImpl( lights, numLights, lightsAABB, buildMode );
+}
+
+bool LightBVHCPU::Build( const SpotLight* lights, uint32_t numLights, const BoundingBox& lightsAABB, BuildMode buildMode )
+{
+    return BuildImpl( lights, numLights, lightsAABB, buildMode );
+}
+
+void LightBVHCPU::Build( const PointLight* lights, uint32_t numLights, const uint32_t* lightIndices )
+{
+    BuildImpl( lights, numLights, lightIndices );
+}
+
+void LightBVHCPU::Build( const SpotLight* lights, uint32_t numLights, const uint32_t* lightIndices )
+{
+    BuildImpl( lights, numLights, lightIndices );
+}
+
+template<typename LightType>
+bool LightBVHCPU::BuildImpl( const LightType* lights, uint32_t numLights, const BoundingBox& lightsAABB, BuildMode buildMode )
+{
+    // The leaf order is only valid for the same set of lights.
+    bool rebuild = !m_IsValid || numLights != m_NumLeaves || buildMode == BuildMode::Rebuild;
+
+    if ( !rebuild && buildMode == BuildMode::Automatic )
+    {
+        // The tree has degraded too much, re-sort the lights without refitting the tree first.
+        rebuild = EstimateCost( lights ) > m_RebuildEstimatedCost * m_RebuildThreshold;
+    }
+
+    if ( !rebuild )
+    {
+        // Refit the existing tree.
+        BuildNodes( lights );
+        m_Cost = ComputeCost();
+        ++m_NumRefits;
+    }
+
+    if ( rebuild )
+    {
+        m_NumLeaves = numLights;
+        m_NumLevels = GetNumLevels( numLights );
+
+        ComputeMortonCodes( lights, lightsAABB );
+
+        RadixSortCPU::Sort( m_MortonCodes, m_LightIndices, m_TmpMortonCodes, m_TmpLightIndices, m_MortonCodeBits * 3, m_ThreadPool );
+
+        BuildNodes( lights );
+        m_Cost = m_RebuildCost = ComputeCost();
+        m_RebuildEstimatedCost = EstimateCost( lights );
+        ++m_NumRebuilds;
+
+        m_IsValid = true;
+    }
+
+    return rebuild;
+}
+
+template<typename LightType>
+void LightBVHCPU::BuildImpl( const LightType* lights, uint32_t numLights, const uint32_t* lightIndices )
+{
+    m_NumLeaves = numLights;
+    m_NumLevels = GetNumLevels( numLights );
+
+    m_MortonCodes.clear();
+    m_LightIndices.assign( lightIndices, lightIndices + numLights );
+
+    BuildNodes( lights );
+    m_Cost = m_RebuildCost = ComputeCost();
+    m_RebuildEstimatedCost = EstimateCost( lights );
+    ++m_NumRebuilds;
+
+    m_IsValid = true;
+}
+
+template<typename LightType>
+void LightBVHCPU::ComputeMortonCodes( const LightType* lights, const BoundingBox& lightsAABB )
+{
+    m_MortonCodes.resize( m_NumLeaves );
+    m_LightIndices.resize( m_NumLeaves );
+
+    // Same quantization as ComputeLightMortonCodes_CS.hlsl
+    const float coordinateScale = static_cast<float>( ( 1u << m_MortonCodeBits ) - 1 );
+    glm::vec3 aabbMin( lightsAABB.m_Min );
+    glm::vec3 aabbSize = glm::vec3( lightsAABB.m_Max ) - aabbMin;
+    glm::vec3 aabbRange(
+        aabbSize.x > 0.0f ? 1.0f / aabbSize.x : 0.0f,
+        aabbSize.y > 0.0f ? 1.0f / aabbSize.y : 0.0f,
+        aabbSize.z > 0.0f ? 1.0f / aabbSize.z : 0.0f
+    );
+
+    m_ThreadPool.ParallelFor( 0, m_NumLeaves, 16 * 1024, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            glm::vec3 normalized = ( glm::vec3( lights[i].m_PositionVS ) - aabbMin ) * aabbRange;
+            glm::vec3 quantized = normalized * coordinateScale;
+
+            // Lights outside of the AABB are clamped to the border of the AABB.
+            m_MortonCodes[i] = MortonCode( glm::uvec3(
+                static_cast<uint32_t>( glm::clamp( quantized.x, 0.0f, coordinateScale ) ),
+                static_cast<uint32_t>( glm::clamp( quantized.y, 0.0f, coordinateScale ) ),
+                static_cast<uint32_t>( glm::clamp( quantized.z, 0.0f, coordinateScale ) ) ) );
+            m_LightIndices[i] = i;
+        }
+    } );
+}
+
+template<typename LightType>
+void LightBVHCPU::BuildNodes( const LightType* lights )
+{
+    uint32_t numNodes = GetNumNodes( m_NumLeaves );
+    m_Nodes.resize( numNodes );
+
+    if ( m_NumLevels == 0 || m_NumLevels > MaxLevels ) return;
+
+    // Build the bottom level of the BVH from the light AABBs (BuildBVH_CS.hlsl BuildBottom).
+    uint32_t bottomLevel = m_NumLevels - 1;
+    uint32_t firstNode = GetFirstNodeIndex( bottomLevel );
+    uint32_t numLevelNodes = GetNumLevelNodes( bottomLevel );
+
+    m_ThreadPool.ParallelFor( 0, numLevelNodes, 256, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t nodeOffset = begin; nodeOffset < end; ++nodeOffset )
+        {
+            BoundingBox aabb;
+
+            uint32_t firstLeaf = nodeOffset * BranchingFactor;
+            uint32_t lastLeaf = std::min( firstLeaf + BranchingFactor, m_NumLeaves );
+            for ( uint32_t leaf = firstLeaf; leaf < lastLeaf; ++leaf )
+            {
+                aabb.Grow( GetLightAABB( lights[m_LightIndices[leaf]] ) );
+            }
+
+            m_Nodes[firstNode + nodeOffset] = aabb;
+        }
+    } );
+
+    // Build the upper levels of the BVH (BuildBVH_CS.hlsl BuildTop).
+    for ( uint32_t childLevel = bottomLevel; childLevel > 0; --childLevel )
+    {
+        uint32_t firstChild = GetFirstNodeIndex( childLevel );
+        uint32_t numChildren = GetNumLevelNodes( childLevel );
+        uint32_t firstParent = GetFirstNodeIndex( childLevel - 1 );
+        uint32_t numParents = GetNumLevelNodes( childLevel - 1 );
+
+        m_ThreadPool.ParallelFor( 0, numParents, 256, [&]( uint32_t begin, uint32_t end )
+        {
+            for ( uint32_t parentOffset = begin; parentOffset < end; ++parentOffset )
+            {
+                BoundingBox aabb;
+
+                uint32_t childBegin = parentOffset * BranchingFactor;
+                uint32_t childEnd = std::min( childBegin + BranchingFactor, numChildren );
+                for ( uint32_t child = childBegin; child < childEnd; ++child )
+                {
+                    aabb.Grow( m_Nodes[firstChild + child] );
+                }
+
+                m_Nodes[firstParent + parentOffset] = aabb;
+            }
+        } );
+    }
+}
+
+float LightBVHCPU::ComputeCost() const
+{
+    double cost = 0.0;
+    for ( const BoundingBox& node : m_Nodes )
+    {
+        cost += node.GetSurfaceArea();
+    }
+
+    return static_cast<float>( cost );
+}
+
+template<typename LightType>
+float LightBVHCPU::EstimateCost( const LightType* lights ) const
+{
+    // The bottom level contains most of the nodes of the tree. The same subset of
+    // nodes is used for the same number of leaves so the estimates can be compared.
+    uint32_t numBottomNodes = ( m_NumLeaves + BranchingFactor - 1 ) / BranchingFactor;
+    uint32_t stride = std::max( 1u, numBottomNodes / gs_NumCostSamples );
+
+    double cost = 0.0;
+    for ( uint32_t nodeOffset = 0; nodeOffset < numBottomNodes; nodeOffset += stride )
+    {
+        BoundingBox aabb;
+
+        uint32_t firstLeaf = nodeOffset * BranchingFactor;
+        uint32_t lastLeaf = std::min( firstLeaf + BranchingFactor, m_NumLeaves );
+        for ( uint32_t leaf = firstLeaf; leaf < lastLeaf; ++leaf )
+        {
+            aabb.Grow( GetLightAABB( lights[m_LightIndices[leaf]] ) );
+        }
+
+        cost += aabb.GetSurfaceArea();
+    }
+
+    return static_cast<float>( cost );
+}
+
+void LightBVHCPU::SetRebuildThreshold( float threshold )
+{
+    m_RebuildThreshold = threshold;
+}
+
+float LightBVHCPU::GetRebuildThreshold() const
+{
+    return m_RebuildThreshold;
+}
+
+void LightBVHCPU::Invalidate()
+{
+    m_IsValid = false;
+}
+
+const std::vector<BoundingBox>& LightBVHCPU::GetNodes() const
+{
+    return m_Nodes;
+}
+
+const std::vector<uint32_t>& LightBVHCPU::GetLightIndices() const
+{
+    return m_LightIndices;
+}
+
+void LightBVHCPU::SetMortonCodeBits( uint32_t bitsPerAxis )
+{
+    bitsPerAxis = glm::clamp( bitsPerAxis, 1u, MortonCodeBits64 );
+    if ( bitsPerAxis != m_MortonCodeBits )
+    {
+        m_MortonCodeBits = bitsPerAxis;
+        m_IsValid = false;
+    }
+}
+
+uint32_t LightBVHCPU::GetMortonCodeBits() const
+{
+    return m_MortonCodeBits;
+}
+
+const std::vector<uint64_t>& LightBVHCPU::GetMortonCodes() const
+{
+    return m_MortonCodes;
+}
+
+uint32_t LightBVHCPU::GetNumLevels() const
+{
+    return m_NumLevels;
+}
+
+uint32_t LightBVHCPU::GetNumLeaves() const
+{
+    return m_NumLeaves;
+}
+
+float LightBVHCPU::GetCostRatio() const
+{
+    return m_RebuildCost > 0.0f ? m_Cost / m_RebuildCost : 1.0f;
+}
+
+uint32_t LightBVHCPU::GetNumRebuilds() const
+{
+    return m_NumRebuilds;
+}
+
+uint32_t LightBVHCPU::GetNumRefits() const
+{
+    return m_NumRefits;
+}
+
+LightBVHCPU::Statistics LightBVHCPU::ComputeStatistics() const
+{
+    Statistics statistics;
+    statistics.NumLeaves = m_NumLeaves;
+    statistics.NumLevels = m_NumLevels;
+    statistics.NumNodes = static_cast<uint32_t>( m_Nodes.size() );
+    statistics.SurfaceArea = ComputeCost();
+
+    for ( size_t i = 1; i < m_MortonCodes.size(); ++i )
+    {
+        statistics.NumDuplicateMortonCodes += ( m_MortonCodes[i] == m_MortonCodes[i - 1] ) ? 1 : 0;
+    }
+
+    if ( m_NumLevels == 0 || m_NumLevels > MaxLevels ) return statistics;
+
+    // Level 0 only contains the root node which has no siblings.
+    statistics.LevelOverlap.resize( m_NumLevels, 0.0f );
+
+    double totalOverlap = 0.0;
+    double totalVolume = 0.0;
+
+    std::vector<double> overlap;
+    std::vector<double> volume;
+
+    for ( uint32_t level = 1; level < m_NumLevels; ++level )
+    {
+        uint32_t firstChild = GetFirstNodeIndex( level );
+        uint32_t numParents = GetNumLevelNodes( level - 1 );
+
+        overlap.assign( numParents, 0.0 );
+        volume.assign( numParents, 0.0 );
+
+        m_ThreadPool.ParallelFor( 0, numParents, 64, [&]( uint32_t begin, uint32_t end )
+        {
+            for ( uint32_t parent = begin; parent < end; ++parent )
+            {
+                const BoundingBox* children = &m_Nodes[firstChild + parent * BranchingFactor];
+                for ( uint32_t i = 0; i < BranchingFactor; ++i )
+                {
+                    if ( !children[i].IsValid() ) continue;
+
+                    volume[parent] += GetVolume( children[i] );
+                    for ( uint32_t j = i + 1; j < BranchingFactor; ++j )
+                    {
+                        if ( children[j].IsValid() )
+                        {
+                            overlap[parent] += GetIntersectionVolume( children[i], children[j] );
+                        }
+                    }
+                }
+            }
+        } );
+
+        double levelOverlap = 0.0;
+        double levelVolume = 0.0;
+        for ( uint32_t parent = 0; parent < numParents; ++parent )
+        {
+            levelOverlap += overlap[parent];
+            levelVolume += volume[parent];
+        }
+
+        statistics.LevelOverlap[level] = levelVolume > 0.0 ? static_cast<float>( levelOverlap / levelVolume ) : 0.0f;
+
+        totalOverlap += levelOverlap;
+        totalVolume += levelVolume;
+    }
+
+    statistics.NodeOverlap = totalVolume > 0.0 ? static_cast<float>( totalOverlap / totalVolume ) : 0.0f;
+
+    return statistics;
+}
@@ -0,0 +1,252 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/LightGeneratorCPU.h>
+#include <Graphics/CPU/SIMD.h>
+
+#include <Graphics/PointLight.h>
+#include <Graphics/SpotLight.h>
+#include <Graphics/DirectionalLight.h>
+
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The number of lights that are generated by a single task.
+    // This must be a multiple of SIMD::Width.
+    const uint32_t LIGHTS_PER_CHUNK = 4096;
+
+    // Every light attribute uses a different random number stream.
+    enum RandomStream
+    {
+        POSITION_X,
+        POSITION_Y,
+        POSITION_Z,
+        DIRECTION_Z,
+        DIRECTION_ANGLE,
+        SPOT_ANGLE,
+        RANGE,
+        HUE,
+        SATURATION,
+        NUM_STREAMS
+    };
+
+    // The first stream of every light type.
+    const uint32_t POINT_LIGHT_STREAMS = 0 * NUM_STREAMS;
+    const uint32_t SPOT_LIGHT_STREAMS = 1 * NUM_STREAMS;
+    const uint32_t DIRECTIONAL_LIGHT_STREAMS = 2 * NUM_STREAMS;
+
+    // PCG hash.
+    // Source: Hash Functions for GPU Rendering (2020), Mark Jarzynski and Marc Olano.
+    inline uint32_t Hash( uint32_t v )
+    {
+        uint32_t state = v * 747796405u + 2891336453u;
+        uint32_t word = ( ( state >> ( ( state >> 28u ) + 4u ) ) ^ state ) * 277803737u;
+        return ( word >> 22u ) ^ word;
+    }
+
+    using namespace SIMD;
+
+    // Convert 24-bit random integers to floats in the range [0, 1).
+    inline Floats UnitFloats( const int32_t* bits )
+    {
+#if defined(ENGINE_SIMD_AVX)
+        return _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_load_si256( reinterpret_cast<const __m256i*>( bits ) ) ), _mm256_set1_ps( 1.0f / 16777216.0f ) );
+#elif defined(ENGINE_SIMD_SSE2)
+        return _mm_mul_ps( _mm_cvtepi32_ps( _mm_load_si128( reinterpret_cast<const __m128i*>( bits ) ) ), _mm_set1_ps( 1.0f / 16777216.0f ) );
+#else
+        return static_cast<float>( *bits ) * ( 1.0f / 16777216.0f );
+#endif
+    }
+
+    inline Floats Lerp( Floats a, Floats b, Floats t )
+    {
+        return Add( a, Mul( Sub( b, a ), t ) );
+    }
+
+    // Polynomial approximation of sin and cos in the range [-pi/2, pi/2] (Taylor series).
+    // The standard library functions cannot be used because their results
+    // depend on the CPU that is used.
+    inline Floats Sin( Floats x )
+    {
+        Floats x2 = Mul( x, x );
+        Floats p = Set( -1.0f / 39916800.0f );
+        p = Add( Mul( p, x2 ), Set( 1.0f / 362880.0f ) );
+        p = Add( Mul( p, x2 ), Set( -1.0f / 5040.0f ) );
+        p = Add( Mul( p, x2 ), Set( 1.0f / 120.0f ) );
+        p = Add( Mul( p, x2 ), Set( -1.0f / 6.0f ) );
+        p = Add( Mul( p, x2 ), Set( 1.0f ) );
+        return Mul( p, x );
+    }
+
+    inline Floats Cos( Floats x )
+    {
+        Floats x2 = Mul( x, x );
+        Floats p = Set( 1.0f / 479001600.0f );
+        p = Add( Mul( p, x2 ), Set( -1.0f / 3628800.0f ) );
+        p = Add( Mul( p, x2 ), Set( 1.0f / 40320.0f ) );
+        p = Add( Mul( p, x2 ), Set( -1.0f / 720.0f ) );
+        p = Add( Mul( p, x2 ), Set( 1.0f / 24.0f ) );
+        p = Add( Mul( p, x2 ), Set( -1.0f / 2.0f ) );
+        return Add( Mul( p, x2 ), Set( 1.0f ) );
+    }
+
+    // Compute a single color channel of an HSV color with V = 1.
+    // Source: https://en.wikipedia.org/wiki/HSL_and_HSV#HSV_to_RGB_alternative
+    // @param n 5 for red, 3 for green and 1 for blue.
+    // @param H2 Hue / 60 in the range [0, 6).
+    inline Floats HSVChannel( float n, Floats H2, Floats S )
+    {
+        Floats k = Add( Set( n ), H2 );
+        k = Sub( k, Mul( Floor( Mul( k, Set( 1.0f / 6.0f ) ) ), Set( 6.0f ) ) );
+        Floats t = Max( Set( 0.0f ), Min( Min( k, Sub( Set( 4.0f ), k ) ), Set( 1.0f ) ) );
+        return Sub( Set( 1.0f ), Mul( S, t ) );
+    }
+
+    /**
+     * The random attributes of SIMD::Width lights (structure of arrays).
+     */
+    struct LightBatch
+    {
+        alignas( 32 ) float PositionX[SIMD::Width];
+        alignas( 32 ) float PositionY[SIMD::Width];
+        alignas( 32 ) float PositionZ[SIMD::Width];
+        alignas( 32 ) float DirectionX[SIMD::Width];
+        alignas( 32 ) float DirectionY[SIMD::Width];
+        alignas( 32 ) float DirectionZ[SIMD::Width];
+        alignas( 32 ) float SpotAngle[SIMD::Width];
+        alignas( 32 ) float Range[SIMD::Width];
+        alignas( 32 ) float R[SIMD::Width];
+        alignas( 32 ) float G[SIMD::Width];
+        alignas( 32 ) float B[SIMD::Width];
+    };
+
+    /**
+     * Compute the attributes of the lights [firstLight, firstLight + SIMD::Width).
+     * @param streamKeys The hashed seed for every random stream of the light type.
+     */
+    void GenerateBatch( const LightGeneratorArgs& args, const uint32_t* streamKeys, uint32_t firstLight, LightBatch& batch )
+    {
+        alignas( 32 ) int32_t bits[NUM_STREAMS][SIMD::Width];
+
+        for ( uint32_t i = 0; i < SIMD::Width; ++i )
+        {
+            uint32_t lightHash = Hash( firstLight + i );
+            for ( uint32_t s = 0; s < NUM_STREAMS; ++s )
+            {
+                bits[s][i] = static_cast<int32_t>( Hash( lightHash ^ streamKeys[s] ) >> 8 );
+            }
+        }
+
+        // Position.
+        Store( batch.PositionX, Lerp( Set( args.MinBounds.x ), Set( args.MaxBounds.x ), UnitFloats( bits[POSITION_X] ) ) );
+        Store( batch.PositionY, Lerp( Set( args.MinBounds.y ), Set( args.MaxBounds.y ), UnitFloats( bits[POSITION_Y] ) ) );
+        Store( batch.PositionZ, Lerp( Set( args.MinBounds.z ), Set( args.MaxBounds.z ), UnitFloats( bits[POSITION_Z] ) ) );
+
+        // Direction uniformly distributed on the unit sphere (same as glm::sphericalRand).
+        // The angle around the Z axis is split in two halves of [-pi/2, pi/2) so that
+        // sin and cos only need to be evaluated in that range.
+        Floats z = Sub( Set( 1.0f ), Mul( UnitFloats( bits[DIRECTION_Z] ), Set( 2.0f ) ) );
+        Floats r = Sqrt( Max( Set( 0.0f ), Sub( Set( 1.0f ), Mul( z, z ) ) ) );
+        Floats a = Mul( UnitFloats( bits[DIRECTION_ANGLE] ), Set( 2.0f ) );
+        Floats half = Floor( a );
+        Floats angle = Mul( Sub( Sub( a, half ), Set( 0.5f ) ), Set( glm::pi<float>() ) );
+        Floats sign = Sub( Set( 1.0f ), Mul( half, Set( 2.0f ) ) );
+        r = Mul( r, sign );
+
+        Store( batch.DirectionX, Mul( r, Cos( angle ) ) );
+        Store( batch.DirectionY, Mul( r, Sin( angle ) ) );
+        Store( batch.DirectionZ, z );
+
+        Store( batch.SpotAngle, Lerp( Set( args.MinSpotAngle ), Set( args.MaxSpotAngle ), UnitFloats( bits[SPOT_ANGLE] ) ) );
+        Store( batch.Range, Lerp( Set( args.MinRange ), Set( args.MaxRange ), UnitFloats( bits[RANGE] ) ) );
+
+        // Random hue and saturation at full brightness.
+        Floats H2 = Mul( UnitFloats( bits[HUE] ), Set( 6.0f ) );
+        Floats S = UnitFloats( bits[SATURATION] );
+
+        Store( batch.R, HSVChannel( 5.0f, H2, S ) );
+        Store( batch.G, HSVChannel( 3.0f, H2, S ) );
+        Store( batch.B, HSVChannel( 1.0f, H2, S ) );
+    }
+
+    inline void SetLight( const LightBatch& batch, uint32_t i, PointLight& light )
+    {
+        light = PointLight();
+        light.m_PositionWS = glm::vec4( batch.PositionX[i], batch.PositionY[i], batch.PositionZ[i], 1.0f );
+        light.m_Color = glm::vec3( batch.R[i], batch.G[i], batch.B[i] );
+        light.m_Range = batch.Range[i];
+    }
+
+    inline void SetLight( const LightBatch& batch, uint32_t i, SpotLight& light )
+    {
+        light = SpotLight();
+        light.m_PositionWS = glm::vec4( batch.PositionX[i], batch.PositionY[i], batch.PositionZ[i], 1.0f );
+        light.m_DirectionWS = glm::vec4( batch.DirectionX[i], batch.DirectionY[i], batch.DirectionZ[i], 0.0f );
+        light.m_Color = glm::vec3( batch.R[i], batch.G[i], batch.B[i] );
+        light.m_SpotlightAngle = batch.SpotAngle[i];
+        light.m_Range = batch.Range[i];
+    }
+
+    inline void SetLight( const LightBatch& batch, uint32_t i, DirectionalLight& light )
+    {
+        light = DirectionalLight();
+        light.m_DirectionWS = glm::vec4( batch.DirectionX[i], batch.DirectionY[i], batch.DirectionZ[i], 0.0f );
+        light.m_Color = glm::vec3( batch.R[i], batch.G[i], batch.B[i] );
+    }
+
+    template<typename LightType>
+    void GenerateLights( Core::ThreadPool& threadPool, const LightGeneratorArgs& args, uint32_t firstStream, uint32_t numLights, std::vector<LightType>& lights )
+    {
+        lights.resize( numLights );
+
+        uint32_t streamKeys[NUM_STREAMS];
+        for ( uint32_t s = 0; s < NUM_STREAMS; ++s )
+        {
+            streamKeys[s] = Hash( args.Seed ^ Hash( firstStream + s ) );
+        }
+
+        threadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+        {
+            LightBatch batch;
+
+            for ( uint32_t first = begin; first < end; first += SIMD::Width )
+            {
+                GenerateBatch( args, streamKeys, first, batch );
+
+                uint32_t count = std::min( SIMD::Width, end - first );
+                for ( uint32_t i = 0; i < count; ++i )
+                {
+                    SetLight( batch, i, lights[first + i] );
+                }
+            }
+        } );
+    }
+}
+
+LightGeneratorCPU::LightGeneratorCPU()
+    : m_ThreadPool( Core::ThreadPool::Get() )
+{}
+
+LightGeneratorCPU::LightGeneratorCPU( Core::ThreadPool& threadPool )
+    : m_ThreadPool( threadPool )
+{}
+
+LightGeneratorCPU::~LightGeneratorCPU()
+{}
+
+void LightGeneratorCPU::Generate( const LightGeneratorArgs& args, uint32_t numLights, std::vector<PointLight>& lights ) const
+{
+    GenerateLights( m_ThreadPool, args, POINT_LIGHT_STREAMS, numLights, lights );
+}
+
+void LightGeneratorCPU::Generate( const LightGeneratorArgs& args, uint32_t numLights, std::vector<SpotLight>& lights ) const
+{
+    GenerateLights( m_ThreadPool, args, SPOT_LIGHT_STREAMS, numLights, lights );
+}
+
+void LightGeneratorCPU::Generate( const LightGeneratorArgs& args, uint32_t numLights, std::vector<DirectionalLight>& lights ) const
+{
+    GenerateLights( m_ThreadPool, args, DIRECTIONAL_LIGHT_STREAMS, numLights, lights );
+}
@@ -0,0 +1,190 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/TriangleSorterCPU.h>
+#include <Graphics/CPU/RadixSortCPU.h>
+#include <Graphics/IndexOptimizer.h>
+
+using namespace Graphics;
+
+TriangleSorterCPU::TriangleSorterCPU()
+    : m_UseShortIndices( false )
+    , m_CameraPosition( 0.0f )
+    , m_IsSorted( false )
+    , m_WasIncremental( false )
+    , m_WasOrderChanged( false )
+{}
+
+TriangleSorterCPU::~TriangleSorterCPU()
+{}
+
+bool TriangleSorterCPU::Sort( const uint32_t* indices, const glm::vec3* triangleCenters, uint32_t numTriangles,
+                              const glm::vec4& boundingSphere, const glm::vec3& cameraPosition, float threshold )
+{
+    const glm::vec3 center( boundingSphere );
+    const float radius = boundingSphere.w;
+
+    m_WasOrderChanged = false;
+
+    if ( m_IsSorted && m_Order.size() == numTriangles && glm::length( cameraPosition - m_CameraPosition ) <= threshold * radius )
+    {
+        return false;
+    }
+
+    if ( m_Order.size() != numTriangles )
+    {
+        // Start with the original order of the triangles.
+        m_Order.resize( numTriangles );
+        for ( uint32_t i = 0; i < numTriangles; ++i )
+        {
+            m_Order[i] = i;
+        }
+
+        uint32_t maxIndex = 0;
+        for ( uint32_t i = 0; i < numTriangles * 3; ++i )
+        {
+            maxIndex = std::max( maxIndex, indices[i] );
+        }
+        m_UseShortIndices = IndexOptimizer::CanUse16BitIndices( static_cast<size_t>( maxIndex ) + 1 );
+
+        m_IsSorted = false;
+    }
+
+    // The distances of the triangles are in the range of the bounding sphere.
+    // The farthest triangles get the smallest keys.
+    float centerDistance = glm::length( cameraPosition - center );
+    float minDistance = std::max( centerDistance - radius, 0.0f );
+    float maxDistance = centerDistance + radius;
+    const float maxKey = static_cast<float>( ( 1u << DistanceBits ) - 1 );
+    float scale = maxDistance > minDistance ? maxKey / ( maxDistance - minDistance ) : 0.0f;
+
+    // The keys are computed in the order of the previous sort.
+    m_Keys.resize( numTriangles );
+    for ( uint32_t i = 0; i < numTriangles; ++i )
+    {
+        float distance = glm::length( triangleCenters[m_Order[i]] - cameraPosition );
+        float key = glm::clamp( ( maxDistance - distance ) * scale, 0.0f, maxKey );
+        m_Keys[i] = static_cast<uint32_t>( key );
+    }
+
+    // Small camera movements only swap a few triangles of the previous order.
+    uint64_t numMoves = 0;
+    bool wasSorted = m_IsSorted;
+    m_WasIncremental = m_IsSorted && InsertionSort( numMoves );
+    if ( !m_WasIncremental )
+    {
+        RadixSortCPU::Sort( m_Keys, m_Order, m_TmpKeys, m_TmpOrder, DistanceBits );
+    }
+
+    m_CameraPosition = cameraPosition;
+    m_IsSorted = true;
+
+    // The indices of the previous sort are still valid if the insertion sort didn't move any triangles.
+    m_WasOrderChanged = !wasSorted || !m_WasIncremental || numMoves > 0;
+    if ( !m_WasOrderChanged )
+    {
+        return true;
+    }
+
+    if ( m_UseShortIndices )
+    {
+        m_ShortIndices.resize( numTriangles * 3 );
+        for ( uint32_t i = 0; i < numTriangles; ++i )
+        {
+            const uint32_t* triangle = indices + m_Order[i] * 3;
+            m_ShortIndices[i * 3 + 0] = static_cast<uint16_t>( triangle[0] );
+            m_ShortIndices[i * 3 + 1] = static_cast<uint16_t>( triangle[1] );
+            m_ShortIndices[i * 3 + 2] = static_cast<uint16_t>( triangle[2] );
+        }
+    }
+    else
+    {
+        m_Indices.resize( numTriangles * 3 );
+        for ( uint32_t i = 0; i < numTriangles; ++i )
+        {
+            const uint32_t* triangle = indices + m_Order[i] * 3;
+            m_Indices[i * 3 + 0] = triangle[0];
+            m_Indices[i * 3 + 1] = triangle[1];
+            m_Indices[i * 3 + 2] = triangle[2];
+        }
+    }
+
+    return true;
+}
+
+bool TriangleSorterCPU::InsertionSort( uint64_t& numMoves )
+{
+    const uint32_t numTriangles = static_cast<uint32_t>( m_Keys.size() );
+
+    // Don't try the insertion sort if many triangles are out of order.
+    uint32_t numDescents = 0;
+    for ( uint32_t i = 1; i < numTriangles; ++i )
+    {
+        numDescents += m_Keys[i - 1] > m_Keys[i] ? 1 : 0;
+    }
+    if ( numDescents > numTriangles / MaxDescentsRatio )
+    {
+        return false;
+    }
+
+    uint64_t maxMoves = static_cast<uint64_t>( numTriangles ) * MaxMovesPerTriangle;
+    numMoves = 0;
+
+    for ( uint32_t i = 1; i < numTriangles; ++i )
+    {
+        uint32_t key = m_Keys[i];
+        if ( m_Keys[i - 1] <= key )
+        {
+            continue;
+        }
+
+        uint32_t triangle = m_Order[i];
+        uint32_t j = i;
+        while ( j > 0 && m_Keys[j - 1] > key )
+        {
+            m_Keys[j] = m_Keys[j - 1];
+            m_Order[j] = m_Order[j - 1];
+            --j;
+        }
+        m_Keys[j] = key;
+        m_Order[j] = triangle;
+
+        // The keys and the order are still consistent, so the radix sort can continue from here.
+        numMoves += i - j;
+        if ( numMoves > maxMoves )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void TriangleSorterCPU::Invalidate()
+{
+    m_IsSorted = false;
+}
+
+const void* TriangleSorterCPU::GetIndices() const
+{
+    return m_UseShortIndices ? static_cast<const void*>( m_ShortIndices.data() ) : static_cast<const void*>( m_Indices.data() );
+}
+
+uint32_t TriangleSorterCPU::GetNumIndices() const
+{
+    return static_cast<uint32_t>( m_Order.size() * 3 );
+}
+
+uint32_t TriangleSorterCPU::GetIndexSize() const
+{
+    return m_UseShortIndices ? sizeof( uint16_t ) : sizeof( uint32_t );
+}
+
+bool TriangleSorterCPU::WasIncremental() const
+{
+    return m_WasIncremental;
+}
+
+bool TriangleSorterCPU::WasOrderChanged() const
+{
+    return m_WasOrderChanged;
+}
@@ -0,0 +1,333 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/UpdateLightsCPU.h>
+#include <Graphics/CPU/SIMD.h>
+
+#include <Graphics/PointLight.h>
+#include <Graphics/SpotLight.h>
+
+#include <Common.h>
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The number of lights that are updated by a single task.
+    // This must be a multiple of SIMD::Width.
+    const uint32_t LIGHTS_PER_CHUNK = 4096;
+
+#if defined(ENGINE_SIMD_SSE2)
+    // The columns of a 4x4 matrix.
+    struct Matrix4
+    {
+        __m128 Columns[4];
+
+        explicit Matrix4( const glm::mat4& m )
+        {
+            for ( int i = 0; i < 4; ++i )
+            {
+                Columns[i] = _mm_loadu_ps( &m[i][0] );
+            }
+        }
+    };
+
+    template<int i>
+    inline __m128 Splat( __m128 v )
+    {
+        return _mm_shuffle_ps( v, v, _MM_SHUFFLE( i, i, i, i ) );
+    }
+
+    // m * v
+    inline __m128 Transform( const Matrix4& m, __m128 v )
+    {
+        __m128 xy = _mm_add_ps( _mm_mul_ps( m.Columns[0], Splat<0>( v ) ), _mm_mul_ps( m.Columns[1], Splat<1>( v ) ) );
+        __m128 zw = _mm_add_ps( _mm_mul_ps( m.Columns[2], Splat<2>( v ) ), _mm_mul_ps( m.Columns[3], Splat<3>( v ) ) );
+        return _mm_add_ps( xy, zw );
+    }
+
+    // m * float4( v.xyz, 1 )
+    inline __m128 TransformPoint( const Matrix4& m, __m128 v )
+    {
+        __m128 xy = _mm_add_ps( _mm_mul_ps( m.Columns[0], Splat<0>( v ) ), _mm_mul_ps( m.Columns[1], Splat<1>( v ) ) );
+        __m128 zw = _mm_add_ps( _mm_mul_ps( m.Columns[2], Splat<2>( v ) ), m.Columns[3] );
+        return _mm_add_ps( xy, zw );
+    }
+
+    // normalize( m * float4( v.xyz, 0 ) )
+    inline __m128 TransformDirection( const Matrix4& m, __m128 v )
+    {
+        __m128 xy = _mm_add_ps( _mm_mul_ps( m.Columns[0], Splat<0>( v ) ), _mm_mul_ps( m.Columns[1], Splat<1>( v ) ) );
+        __m128 d = _mm_add_ps( xy, _mm_mul_ps( m.Columns[2], Splat<2>( v ) ) );
+
+#if defined(ENGINE_SIMD_SSE4)
+        __m128 lengthSq = _mm_dp_ps( d, d, 0xFF );
+#else
+        __m128 lengthSq = _mm_mul_ps( d, d );
+        lengthSq = _mm_add_ps( lengthSq, _mm_shuffle_ps( lengthSq, lengthSq, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+        lengthSq = _mm_add_ps( lengthSq, _mm_shuffle_ps( lengthSq, lengthSq, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+#endif
+        return _mm_div_ps( d, _mm_sqrt_ps( lengthSq ) );
+    }
+#endif
+
+    // A 4x4 matrix with every element broadcast to a SIMD register.
+    struct MatrixSoA
+    {
+        SIMD::Floats M[4][4];
+
+        explicit MatrixSoA( const glm::mat4& m )
+        {
+            for ( int c = 0; c < 4; ++c )
+            {
+                for ( int r = 0; r < 4; ++r )
+                {
+                    M[c][r] = SIMD::Set( m[c][r] );
+                }
+            }
+        }
+    };
+
+    // Transform SIMD::Width points (w = 1) at index i of the X, Y, and Z arrays.
+    inline void TransformPoints( const MatrixSoA& m, const std::vector<float>* src, std::vector<float>* dst, uint32_t i )
+    {
+        using namespace SIMD;
+
+        Floats x = Load( &src[0][i] );
+        Floats y = Load( &src[1][i] );
+        Floats z = Load( &src[2][i] );
+
+        for ( int r = 0; r < 3; ++r )
+        {
+            Floats xy = Add( Mul( m.M[0][r], x ), Mul( m.M[1][r], y ) );
+            Floats zw = Add( Mul( m.M[2][r], z ), m.M[3][r] );
+            Store( &dst[r][i], Add( xy, zw ) );
+        }
+    }
+
+    // Transform SIMD::Width directions (w = 0) at index i of the X, Y, and Z arrays.
+    inline void TransformDirections( const MatrixSoA& m, const std::vector<float>* src, std::vector<float>* dst, uint32_t i, bool normalize )
+    {
+        using namespace SIMD;
+
+        Floats x = Load( &src[0][i] );
+        Floats y = Load( &src[1][i] );
+        Floats z = Load( &src[2][i] );
+
+        Floats d[3];
+        for ( int r = 0; r < 3; ++r )
+        {
+            d[r] = Add( Add( Mul( m.M[0][r], x ), Mul( m.M[1][r], y ) ), Mul( m.M[2][r], z ) );
+        }
+
+        if ( normalize )
+        {
+            Floats length = Sqrt( Add( Add( Mul( d[0], d[0] ), Mul( d[1], d[1] ) ), Mul( d[2], d[2] ) ) );
+            for ( int r = 0; r < 3; ++r )
+            {
+                d[r] = Div( d[r], length );
+            }
+        }
+
+        for ( int r = 0; r < 3; ++r )
+        {
+            Store( &dst[r][i], d[r] );
+        }
+    }
+}
+
+void LightTransformsSoA::Resize( uint32_t numLights, bool hasDirections )
+{
+    size_t paddedSize = Math::AlignUp( numLights, SIMD::Width );
+
+    NumLights = numLights;
+    HasDirections = hasDirections;
+
+    for ( int i = 0; i < 3; ++i )
+    {
+        PositionWS[i].assign( paddedSize, 0.0f );
+        PositionVS[i].resize( paddedSize );
+        DirectionWS[i].assign( hasDirections ? paddedSize : 0, 0.0f );
+        DirectionVS[i].resize( hasDirections ? paddedSize : 0 );
+    }
+}
+
+size_t LightTransformsSoA::GetBytesPerLight( bool applyWorldMatrix ) const
+{
+    // Read the world space position and write the view space position
+    // (and the world space position if the world matrix is applied).
+    size_t numVectors = applyWorldMatrix ? 3 : 2;
+    return ( HasDirections ? 2 : 1 ) * numVectors * 3 * sizeof( float );
+}
+
+UpdateLightsCPU::UpdateLightsCPU()
+    : m_ThreadPool( Core::ThreadPool::Get() )
+{}
+
+UpdateLightsCPU::UpdateLightsCPU( Core::ThreadPool& threadPool )
+    : m_ThreadPool( threadPool )
+{}
+
+UpdateLightsCPU::~UpdateLightsCPU()
+{}
+
+void UpdateLightsCPU::Update( const glm::mat4& worldMatrix, const glm::mat4& viewMatrix, bool applyWorldMatrix, PointLight* lights, uint32_t numLights ) const
+{
+#if defined(ENGINE_SIMD_SSE2)
+    Matrix4 world( worldMatrix );
+    Matrix4 view( viewMatrix );
+#endif
+
+    m_ThreadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            PointLight& light = lights[i];
+#if defined(ENGINE_SIMD_SSE2)
+            __m128 positionWS = _mm_loadu_ps( &light.m_PositionWS.x );
+            if ( applyWorldMatrix )
+            {
+                positionWS = Transform( world, positionWS );
+                _mm_storeu_ps( &light.m_PositionWS.x, positionWS );
+            }
+            _mm_storeu_ps( &light.m_PositionVS.x, TransformPoint( view, positionWS ) );
+#else
+            if ( applyWorldMatrix )
+            {
+                light.m_PositionWS = worldMatrix * light.m_PositionWS;
+            }
+            light.m_PositionVS = viewMatrix * glm::vec4( glm::vec3( light.m_PositionWS ), 1 );
+#endif
+        }
+    } );
+}
+
+void UpdateLightsCPU::Update( const glm::mat4& worldMatrix, const glm::mat4& viewMatrix, bool applyWorldMatrix, SpotLight* lights, uint32_t numLights ) const
+{
+#if defined(ENGINE_SIMD_SSE2)
+    Matrix4 world( worldMatrix );
+    Matrix4 view( viewMatrix );
+#endif
+
+    m_ThreadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            SpotLight& light = lights[i];
+#if defined(ENGINE_SIMD_SSE2)
+            __m128 positionWS = _mm_loadu_ps( &light.m_PositionWS.x );
+            __m128 directionWS = _mm_loadu_ps( &light.m_DirectionWS.x );
+            if ( applyWorldMatrix )
+            {
+                positionWS = Transform( world, positionWS );
+                directionWS = Transform( world, directionWS );
+                _mm_storeu_ps( &light.m_PositionWS.x, positionWS );
+                _mm_storeu_ps( &light.m_DirectionWS.x, directionWS );
+            }
+            _mm_storeu_ps( &light.m_PositionVS.x, TransformPoint( view, positionWS ) );
+            _mm_storeu_ps( &light.m_DirectionVS.x, TransformDirection( view, directionWS ) );
+#else
+            if ( applyWorldMatrix )
+            {
+                light.m_PositionWS = worldMatrix * light.m_PositionWS;
+                light.m_DirectionWS = worldMatrix * light.m_DirectionWS;
+            }
+            light.m_PositionVS = viewMatrix * glm::vec4( glm::vec3( light.m_PositionWS ), 1 );
+            light.m_DirectionVS = glm::normalize( viewMatrix * glm::vec4( glm::vec3( light.m_DirectionWS ), 0 ) );
+#endif
+        }
+    } );
+}
+
+void UpdateLightsCPU::Update( const glm::mat4& worldMatrix, const glm::mat4& viewMatrix, bool applyWorldMatrix, LightTransformsSoA& lights ) const
+{
+    MatrixSoA world( worldMatrix );
+    MatrixSoA view( viewMatrix );
+
+    // The arrays are padded so every chunk only contains complete SIMD vectors.
+    uint32_t paddedSize = static_cast<uint32_t>( lights.PositionWS[0].size() );
+
+    m_ThreadPool.ParallelFor( 0, paddedSize, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; i += SIMD::Width )
+        {
+            if ( applyWorldMatrix )
+            {
+                TransformPoints( world, lights.PositionWS, lights.PositionWS, i );
+            }
+            TransformPoints( view, lights.PositionWS, lights.PositionVS, i );
+
+            if ( lights.HasDirections )
+            {
+                if ( applyWorldMatrix )
+                {
+                    TransformDirections( world, lights.DirectionWS, lights.DirectionWS, i, false );
+                }
+                TransformDirections( view, lights.DirectionWS, lights.DirectionVS, i, true );
+            }
+        }
+    } );
+}
+
+void UpdateLightsCPU::Gather( const PointLight* lights, uint32_t numLights, LightTransformsSoA& soa ) const
+{
+    soa.Resize( numLights, false );
+
+    m_ThreadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            const PointLight& light = lights[i];
+            for ( int c = 0; c < 3; ++c )
+            {
+                soa.PositionWS[c][i] = light.m_PositionWS[c];
+            }
+        }
+    } );
+}
+
+void UpdateLightsCPU::Gather( const SpotLight* lights, uint32_t numLights, LightTransformsSoA& soa ) const
+{
+    soa.Resize( numLights, true );
+
+    m_ThreadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            const SpotLight& light = lights[i];
+            for ( int c = 0; c < 3; ++c )
+            {
+                soa.PositionWS[c][i] = light.m_PositionWS[c];
+                soa.DirectionWS[c][i] = light.m_DirectionWS[c];
+            }
+        }
+    } );
+}
+
+void UpdateLightsCPU::Scatter( const LightTransformsSoA& soa, PointLight* lights ) const
+{
+    m_ThreadPool.ParallelFor( 0, soa.NumLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            PointLight& light = lights[i];
+            light.m_PositionWS = glm::vec4( soa.PositionWS[0][i], soa.PositionWS[1][i], soa.PositionWS[2][i], 1.0f );
+            light.m_PositionVS = glm::vec4( soa.PositionVS[0][i], soa.PositionVS[1][i], soa.PositionVS[2][i], 1.0f );
+        }
+    } );
+}
+
+void UpdateLightsCPU::Scatter( const LightTransformsSoA& soa, SpotLight* lights ) const
+{
+    m_ThreadPool.ParallelFor( 0, soa.NumLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            SpotLight& light = lights[i];
+            light.m_PositionWS = glm::vec4( soa.PositionWS[0][i], soa.PositionWS[1][i], soa.PositionWS[2][i], 1.0f );
+            light.m_PositionVS = glm::vec4( soa.PositionVS[0][i], soa.PositionVS[1][i], soa.PositionVS[2][i], 1.0f );
+            light.m_DirectionWS = glm::vec4( soa.DirectionWS[0][i], soa.DirectionWS[1][i], soa.DirectionWS[2][i], 0.0f );
+            light.m_DirectionVS = glm::vec4( soa.DirectionVS[0][i], soa.DirectionVS[1][i], soa.DirectionVS[2][i], 0.0f );
+        }
+    } );
+}
@@ -0,0 +1,339 @@
+#include <EnginePCH.h>
+
+#include <Graphics/CPU/ZBinningCPU.h>
+#include <Graphics/CPU/RadixSortCPU.h>
+#include <Graphics/CPU/SIMD.h>
+
+#include <Graphics/PointLight.h>
+#include <Graphics/SpotLight.h>
+
+#include <Common.h>
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The number of lights that are added to the Z-bins by a single task.
+    const uint32_t LIGHTS_PER_CHUNK = 1024;
+
+    // The number of tiles that are processed by a single task.
+    const uint32_t TILES_PER_CHUNK = 16;
+
+    // The radius of padding lights and disabled lights.
+    // Spheres with this radius are outside of every plane.
+    const float DISABLED_RADIUS = -std::numeric_limits<float>::max();
+
+    // Convert screen space coordinates to view space (see ScreenToView in Functions.hlsli).
+    inline glm::vec3 ScreenToView( const glm::mat4& inverseProjection, const glm::vec2& screenDimensions, const glm::vec2& screen )
+    {
+        glm::vec2 texCoord = screen / screenDimensions;
+        glm::vec4 clip( texCoord.x * 2.0f - 1.0f, ( 1.0f - texCoord.y ) * 2.0f - 1.0f, 1.0f, 1.0f );
+        glm::vec4 view = inverseProjection * clip;
+
+        return glm::vec3( view ) / view.w;
+    }
+
+    // Compute a plane from 3 points (see ComputePlane in Functions.hlsli).
+    inline glm::vec4 ComputePlane( const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2 )
+    {
+        glm::vec3 N = glm::normalize( glm::cross( p1 - p0, p2 - p0 ) );
+        return glm::vec4( N, glm::dot( N, p0 ) );
+    }
+
+    /**
+     * Test SIMD::Width spheres against the side planes of a tile frustum.
+     * A sphere is culled if it is in the negative halfspace of any of the planes
+     * (see SphereInsidePlane in Functions.hlsli).
+     * @returns A bitmask with a bit set for every sphere that overlaps the tile.
+     */
+    inline uint32_t SpheresInsideTile( const float* x, const float* y, const float* z, const float* radius, const TileFrustum& frustum )
+    {
+#if defined(ENGINE_SIMD_AVX)
+        __m256 px = _mm256_loadu_ps( x );
+        __m256 py = _mm256_loadu_ps( y );
+        __m256 pz = _mm256_loadu_ps( z );
+        __m256 negRadius = _mm256_sub_ps( _mm256_setzero_ps(), _mm256_loadu_ps( radius ) );
+        __m256 inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+
+        for ( uint32_t i = 0; i < 4; ++i )
+        {
+            const glm::vec4& plane = frustum.Planes[i];
+            __m256 distance = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_set1_ps( plane.x ), px ), _mm256_mul_ps( _mm256_set1_ps( plane.y ), py ) ), _mm256_mul_ps( _mm256_set1_ps( plane.z ), pz ) );
+            distance = _mm256_sub_ps( distance, _mm256_set1_ps( plane.w ) );
+            inside = _mm256_and_ps( inside, _mm256_cmp_ps( distance, negRadius, _CMP_GE_OQ ) );
+        }
+
+        return static_cast<uint32_t>( _mm256_movemask_ps( inside ) );
+#elif defined(ENGINE_SIMD_SSE2)
+        __m128 px = _mm_loadu_ps( x );
+        __m128 py = _mm_loadu_ps( y );
+        __m128 pz = _mm_loadu_ps( z );
+        __m128 negRadius = _mm_sub_ps( _mm_setzero_ps(), _mm_loadu_ps( radius ) );
+        __m128 inside = _mm_castsi128_ps( _mm_set1_epi32( -1 ) );
+
+        for ( uint32_t i = 0; i < 4; ++i )
+        {
+            const glm::vec4& plane = frustum.Planes[i];
+            __m128 distance = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( plane.x ), px ), _mm_mul_ps( _mm_set1_ps( plane.y ), py ) ), _mm_mul_ps( _mm_set1_ps( plane.z ), pz ) );
+            distance = _mm_sub_ps( distance, _mm_set1_ps( plane.w ) );
+            inside = _mm_and_ps( inside, _mm_cmpge_ps( distance, negRadius ) );
+        }
+
+        return static_cast<uint32_t>( _mm_movemask_ps( inside ) );
+#else
+        for ( uint32_t i = 0; i < 4; ++i )
+        {
+            const glm::vec4& plane = frustum.Planes[i];
+            if ( plane.x * *x + plane.y * *y + plane.z * *z - plane.w < -*radius )
+            {
+                return 0u;
+            }
+        }
+        return 1u;
+#endif
+    }
+
+    inline float GetInvBinDepth( const ZBinningArgs& args )
+    {
+        return args.NumZBins / ( args.ZFar - args.ZNear );
+    }
+}
+
+void ZBinningCPU::LightSpheres::Resize( uint32_t numLights )
+{
+    // Pad the arrays to a multiple of 32 lights so that every word of the
+    // tile bitmasks can be computed with full SIMD loads.
+    uint32_t paddedSize = Math::AlignUp( numLights, 32u );
+
+    X.resize( paddedSize );
+    Y.resize( paddedSize );
+    Z.resize( paddedSize );
+    Radius.resize( paddedSize );
+
+    std::fill( X.begin() + numLights, X.end(), 0.0f );
+    std::fill( Y.begin() + numLights, Y.end(), 0.0f );
+    std::fill( Z.begin() + numLights, Z.end(), 0.0f );
+    std::fill( Radius.begin() + numLights, Radius.end(), DISABLED_RADIUS );
+}
+
+ZBinningCPU::ZBinningCPU()
+    : m_ThreadPool( Core::ThreadPool::Get() )
+{}
+
+ZBinningCPU::ZBinningCPU( Core::ThreadPool& threadPool )
+    : m_ThreadPool( threadPool )
+{}
+
+ZBinningCPU::~ZBinningCPU()
+{}
+
+void ZBinningCPU::ComputeTileFrustums( const glm::mat4& inverseProjection, uint32_t screenWidth, uint32_t screenHeight,
+                                       uint32_t tileSize, std::vector<TileFrustum>& tileFrustums )
+{
+    // View space eye position is always at the origin.
+    const glm::vec3 eyePos( 0 );
+    const glm::vec2 screenDimensions( screenWidth, screenHeight );
+
+    uint32_t numTilesX = ( screenWidth + tileSize - 1 ) / tileSize;
+    uint32_t numTilesY = ( screenHeight + tileSize - 1 ) / tileSize;
+
+    tileFrustums.resize( numTilesX * numTilesY );
+
+    for ( uint32_t y = 0; y < numTilesY; ++y )
+    {
+        for ( uint32_t x = 0; x < numTilesX; ++x )
+        {
+            // Compute 4 points on the far clipping plane to use as the frustum vertices.
+            glm::vec3 viewSpace[4] = {
+                ScreenToView( inverseProjection, screenDimensions, glm::vec2( x, y ) * (float)tileSize ),           // Top left
+                ScreenToView( inverseProjection, screenDimensions, glm::vec2( x + 1, y ) * (float)tileSize ),       // Top right
+                ScreenToView( inverseProjection, screenDimensions, glm::vec2( x, y + 1 ) * (float)tileSize ),       // Bottom left
+                ScreenToView( inverseProjection, screenDimensions, glm::vec2( x + 1, y + 1 ) * (float)tileSize ),   // Bottom right
+            };
+
+            TileFrustum& frustum = tileFrustums[y * numTilesX + x];
+            frustum.Planes[0] = ComputePlane( eyePos, viewSpace[2], viewSpace[0] ); // Left
+            frustum.Planes[1] = ComputePlane( eyePos, viewSpace[1], viewSpace[3] ); // Right
+            frustum.Planes[2] = ComputePlane( eyePos, viewSpace[0], viewSpace[1] ); // Top
+            frustum.Planes[3] = ComputePlane( eyePos, viewSpace[3], viewSpace[2] ); // Bottom
+        }
+    }
+}
+
+uint32_t ZBinningCPU::ComputeZBin( const ZBinningArgs& args, float depth )
+{
+    float zBin = std::max( ( depth - args.ZNear ) * GetInvBinDepth( args ), 0.0f );
+    return static_cast<uint32_t>( std::min( zBin, static_cast<float>( args.NumZBins - 1 ) ) );
+}
+
+void ZBinningCPU::Build( const ZBinningArgs& args, ZBinLightList& pointLights, ZBinLightList& spotLights )
+{
+    BuildImpl( args.PointLights, args.NumPointLights, args, pointLights );
+    BuildImpl( args.SpotLights, args.NumSpotLights, args, spotLights );
+}
+
+template<typename LightType>
+void ZBinningCPU::BuildImpl( const LightType* lights, uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList )
+{
+    SortLights( lights, numLights, args, lightList );
+    BuildZBins( numLights, args, lightList );
+    BuildTileMasks( numLights, args, lightList );
+}
+
+template<typename LightType>
+void ZBinningCPU::SortLights( const LightType* lights, uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList )
+{
+    const uint32_t depthKeyMax = ( 1u << DepthKeyBits ) - 1;
+    const float invDepthRange = 1.0f / ( args.ZFar - args.ZNear );
+
+    m_Keys.resize( numLights );
+    lightList.LightIndices.resize( numLights );
+
+    // Compute the depth keys (see DepthKeys in ComputeLightMortonCodes_CS.hlsl).
+    m_ThreadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            const LightType& light = lights[i];
+            float depth = glm::clamp( ( -light.m_PositionVS.z - args.ZNear ) * invDepthRange, 0.0f, 1.0f );
+
+            m_Keys[i] = light.m_Enabled ? static_cast<uint32_t>( depth * depthKeyMax ) : depthKeyMax;
+            lightList.LightIndices[i] = i;
+        }
+    } );
+
+    RadixSortCPU::Sort( m_Keys, lightList.LightIndices, m_TmpKeys, m_TmpIndices, DepthKeyBits, m_ThreadPool );
+
+    // Store the sorted light spheres in SoA layout for the tile tests.
+    m_Spheres.Resize( numLights );
+
+    m_ThreadPool.ParallelFor( 0, numLights, LIGHTS_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            const LightType& light = lights[lightList.LightIndices[i]];
+
+            m_Spheres.X[i] = light.m_PositionVS.x;
+            m_Spheres.Y[i] = light.m_PositionVS.y;
+            m_Spheres.Z[i] = light.m_PositionVS.z;
+            m_Spheres.Radius[i] = light.m_Enabled ? light.m_Range : DISABLED_RADIUS;
+        }
+    } );
+}
+
+void ZBinningCPU::BuildZBins( uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList )
+{
+    const glm::uvec2 emptyZBin( std::numeric_limits<uint32_t>::max(), 0 );
+    const float zFar = args.ZFar;
+
+    uint32_t numChunks = std::max( 1u, ( numLights + LIGHTS_PER_CHUNK - 1 ) / LIGHTS_PER_CHUNK );
+
+    // Each chunk of lights writes to its own set of Z-bins so no atomics are needed.
+    m_ChunkZBins.assign( numChunks * args.NumZBins, emptyZBin );
+
+    m_ThreadPool.ParallelFor( 0, numChunks, 1, [&]( uint32_t chunkBegin, uint32_t chunkEnd )
+    {
+        for ( uint32_t chunk = chunkBegin; chunk < chunkEnd; ++chunk )
+        {
+            glm::uvec2* zBins = &m_ChunkZBins[chunk * args.NumZBins];
+
+            uint32_t first = chunk * LIGHTS_PER_CHUNK;
+            uint32_t last = std::min( first + LIGHTS_PER_CHUNK, numLights );
+            for ( uint32_t i = first; i < last; ++i )
+            {
+                if ( m_Spheres.Radius[i] < 0.0f ) continue;
+
+                // View space depth is along the -Z axis.
+                float minDepth = -m_Spheres.Z[i] - m_Spheres.Radius[i];
+                float maxDepth = -m_Spheres.Z[i] + m_Spheres.Radius[i];
+                if ( maxDepth < args.ZNear || minDepth > zFar ) continue;
+
+                uint32_t lastZBin = ComputeZBin( args, maxDepth );
+                for ( uint32_t zBin = ComputeZBin( args, minDepth ); zBin <= lastZBin; ++zBin )
+                {
+                    // Lights are processed in sorted order so the first light is the minimum.
+                    zBins[zBin].x = std::min( zBins[zBin].x, i );
+                    zBins[zBin].y = i;
+                }
+            }
+        }
+    } );
+
+    // Merge the Z-bins of all chunks.
+    lightList.ZBins.resize( args.NumZBins );
+
+    m_ThreadPool.ParallelFor( 0, args.NumZBins, 256, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t zBin = begin; zBin < end; ++zBin )
+        {
+            glm::uvec2 range = emptyZBin;
+            for ( uint32_t chunk = 0; chunk < numChunks; ++chunk )
+            {
+                const glm::uvec2& chunkRange = m_ChunkZBins[chunk * args.NumZBins + zBin];
+                if ( chunkRange.x <= chunkRange.y )
+                {
+                    range.x = std::min( range.x, chunkRange.x );
+                    range.y = std::max( range.y, chunkRange.y );
+                }
+            }
+            lightList.ZBins[zBin] = range;
+        }
+    } );
+}
+
+void ZBinningCPU::BuildTileMasks( uint32_t numLights, const ZBinningArgs& args, ZBinLightList& lightList )
+{
+    lightList.NumWords = ( numLights + 31 ) / 32;
+    lightList.TileMasks.resize( args.NumTiles * lightList.NumWords );
+
+    m_ThreadPool.ParallelFor( 0, args.NumTiles, TILES_PER_CHUNK, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t tileIndex = begin; tileIndex < end; ++tileIndex )
+        {
+            const TileFrustum& frustum = args.TileFrustums[tileIndex];
+            uint32_t* tileMask = &lightList.TileMasks[tileIndex * lightList.NumWords];
+
+            for ( uint32_t word = 0; word < lightList.NumWords; ++word )
+            {
+                uint32_t mask = 0;
+                for ( uint32_t bit = 0; bit < 32; bit += SIMD::Width )
+                {
+                    uint32_t i = word * 32 + bit;
+                    mask |= SpheresInsideTile( &m_Spheres.X[i], &m_Spheres.Y[i], &m_Spheres.Z[i], &m_Spheres.Radius[i], frustum ) << bit;
+                }
+                tileMask[word] = mask;
+            }
+        }
+    } );
+}
+
+void ZBinningCPU::GetLights( const ZBinLightList& lightList, uint32_t tileIndex, uint32_t zBin, std::vector<uint32_t>& lightIndices )
+{
+    lightIndices.clear();
+
+    const glm::uvec2& range = lightList.ZBins[zBin];
+    if ( range.x > range.y ) return;
+
+    const uint32_t* tileMask = &lightList.TileMasks[tileIndex * lightList.NumWords];
+
+    for ( uint32_t word = range.x / 32; word <= range.y / 32; ++word )
+    {
+        // Mask out the lights of the tile that are outside of the range of the Z-bin (see ZBinWordMask in ZBinned_PS.hlsl).
+        uint32_t firstBit = word * 32;
+        uint32_t mask = tileMask[word];
+        if ( range.x > firstBit )
+        {
+            mask &= 0xffffffffu << ( range.x - firstBit );
+        }
+        if ( range.y < firstBit + 31 )
+        {
+            mask &= 0xffffffffu >> ( firstBit + 31 - range.y );
+        }
+
+        SIMD::ForEachBit( mask, [&]( uint32_t bit )
+        {
+            lightIndices.push_back( lightList.LightIndices[firstBit + bit] );
+        } );
+    }
+}
@@ -310,6 +310,11 @@ glm::mat4 Camera::GetViewProjectionInverseMatrix() const
     return m_ViewProjectionInverse;
 }
 
+Frustum Camera::GetFrustum() const
+{
+    return Frustum( GetProjectionMatrix() * GetViewMatrix() );
+}
+
 Ray Camera::ScreenPointToRay( const glm::vec2& screenPoint ) const
 {
     glm::mat4 clipToWorld = GetViewProjectionInverseMatrix();
@@ -255,24 +255,50 @@ std::shared_ptr<Sampler> DeviceDX12::CreateSampler()
 
 std::shared_ptr<Texture> DeviceDX12::CreateTexture( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const std::wstring& fileName )
 {
-    TextureMap::const_iterator iter = m_TextureMap.find( fileName );
-    if ( iter != m_TextureMap.end() )
+    std::shared_ptr<Texture> texture = FindTexture( fileName );
+    if ( texture )
     {
-        return iter->second;
+        return texture;
     }
 
     Core::Application::Get().SetLoadingMessage( fileName );
 
-    std::shared_ptr<Texture> texture = std::make_shared<TextureDX12>( shared_from_this() );
-    if ( texture->LoadTexture2D( computeCommandBuffer, fileName ) )
+    TextureImage image;
+    if ( !TextureDX12::DecodeTexture2D( fileName, image ) )
     {
-        // Generate mipmaps for textures.
-        computeCommandBuffer->GenerateMips( texture );
+        // Cache the empty texture so the file is not loaded again.
+        image.FileName = fileName;
     }
 
-    m_TextureMap.emplace( fileName, texture );
+    return CreateTexture( computeCommandBuffer, image );
+}
 
-    return texture;
+std::shared_ptr<Texture> DeviceDX12::CreateTexture( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const TextureImage& image )
+{
+    std::shared_ptr<Texture> texture = FindTexture( image.FileName );
+    if ( texture )
+    {
+        return texture;
+    }
+
+    std::shared_ptr<TextureDX12> textureDX12 = std::make_shared<TextureDX12>( shared_from_this() );
+    if ( !image.Pixels.empty() && textureDX12->LoadTexture2D( computeCommandBuffer, image ) && image.MipLevels == 1 )
+    {
+        // Generate mipmaps for textures that were not cooked.
+        computeCommandBuffer->GenerateMips( textureDX12 );
+    }
+
+    scoped_lock lock( m_TextureMapMutex );
+    // If another thread created the same texture in the meantime, the first texture is used.
+    return m_TextureMap.emplace( image.FileName, textureDX12 ).first->second;
+}
+
+std::shared_ptr<Texture> DeviceDX12::FindTexture( const std::wstring& fileName ) const
+{
+    scoped_lock lock( m_TextureMapMutex );
+
+    TextureMap::const_iterator iter = m_TextureMap.find( fileName );
+    return iter != m_TextureMap.end() ? iter->second : nullptr;
 }
 
 std::shared_ptr<Texture> DeviceDX12::CreateTexture2D( uint16_t width, uint16_t height, uint16_t slices, const TextureFormat& format )
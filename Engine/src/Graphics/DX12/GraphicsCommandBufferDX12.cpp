@@ -692,12 +692,22 @@ void GraphicsCommandBufferDX12::BindComputeDynamicStructuredBuffer( uint32_t slo
 }
 
 void GraphicsCommandBufferDX12::BindGraphicsDynamicStructuredBuffer( uint32_t slotID, size_t numElements, size_t elementSize, const void* bufferData )
+{
+    BindGraphicsShaderResourceView( slotID, UploadDynamicStructuredBuffer( numElements, elementSize, bufferData ) );
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS GraphicsCommandBufferDX12::UploadDynamicStructuredBuffer( size_t numElements, size_t elementSize, const void* bufferData )
 {
     size_t bufferSize = numElements * elementSize;
     HeapAllocation heapAllocation = m_UploadHeap->Allocate( bufferSize, elementSize );
     memcpy( heapAllocation.CpuPtr, bufferData, bufferSize );
 
-    m_d3d12CommandList->SetGraphicsRootShaderResourceView( slotID, heapAllocation.GpuAddress );
+    return heapAllocation.GpuAddress;
+}
+
+void GraphicsCommandBufferDX12::BindGraphicsShaderResourceView( uint32_t slotID, D3D12_GPU_VIRTUAL_ADDRESS gpuAddress )
+{
+    m_d3d12CommandList->SetGraphicsRootShaderResourceView( slotID, gpuAddress );
 }
 
 void Graphics::GraphicsCommandBufferDX12::SetBuffer( std::shared_ptr<ResourceDX12> resourceDX12, size_t numElements, size_t elementSize, const void* bufferData, D3D12_RESOURCE_FLAGS flags )
@@ -787,6 +797,38 @@ void GraphicsCommandBufferDX12::SetStructuredBuffer( std::shared_ptr<StructuredB
     SetBuffer( structuredBufferDX12, numElements, elementSize, bufferData, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS );
 }
 
+void GraphicsCommandBufferDX12::UpdateStructuredBuffer( std::shared_ptr<StructuredBuffer> structuredBuffer, size_t numElements, size_t elementSize, const void* bufferData )
+{
+    std::shared_ptr<StructuredBufferDX12> structuredBufferDX12 = std::dynamic_pointer_cast<StructuredBufferDX12>( structuredBuffer );
+    assert( structuredBufferDX12 );
+
+    ComPtr<ID3D12Resource> d3d12Resource = structuredBufferDX12->GetD3D12Resource();
+    if ( !d3d12Resource || structuredBufferDX12->GetNumElements() != numElements || structuredBufferDX12->GetElementSize() != elementSize )
+    {
+        SetStructuredBuffer( structuredBuffer, numElements, elementSize, bufferData );
+        return;
+    }
+
+    TransitionResoure( structuredBuffer, ResourceState::CopyDest, true );
+
+    // Copy the buffer in chunks of (at most) a single upload page.
+    const uint8_t* srcData = static_cast<const uint8_t*>( bufferData );
+    const size_t bufferSize = numElements * elementSize;
+    const size_t pageSize = static_cast<size_t>( m_UploadHeap->GetPageSize() );
+
+    for ( size_t offset = 0; offset < bufferSize; offset += pageSize )
+    {
+        size_t copySize = std::min<size_t>( pageSize, bufferSize - offset );
+
+        HeapAllocation heapAllocation = m_UploadHeap->Allocate( copySize, 4 );
+        memcpy( heapAllocation.CpuPtr, srcData + offset, copySize );
+
+        m_d3d12CommandList->CopyBufferRegion( d3d12Resource.Get(), offset, heapAllocation.d3d12Resource, heapAllocation.Offset, copySize );
+    }
+
+    m_ReferencedObjects.push_back( d3d12Resource );
+}
+
 void GraphicsCommandBufferDX12::SetTextureSubresource( std::shared_ptr<Texture> texture, uint32_t mip, uint32_t arraySlice, const void* pTextureData )
 {
     assert( pTextureData );
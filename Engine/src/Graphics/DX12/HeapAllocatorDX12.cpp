@@ -51,6 +51,8 @@ HeapAllocation HeapAllocatorDX12::Allocate( size_t sizeInBytes, size_t alignment
     HeapAllocation heapAllocation;
     heapAllocation.CpuPtr = static_cast<uint8_t*>( m_CurrentBuffer->m_DataPtr ) + m_CurrentOffset;
     heapAllocation.GpuAddress = m_CurrentBuffer->m_d3d12GPUVirtualAddress + m_CurrentOffset;
+    heapAllocation.d3d12Resource = m_CurrentBuffer->m_d3d12Resource.Get();
+    heapAllocation.Offset = m_CurrentOffset;
 
     m_CurrentOffset += alignedSize;
 
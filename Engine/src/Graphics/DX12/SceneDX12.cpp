@@ -7,21 +7,122 @@
 #include <Graphics/DX12/SceneDX12.h>
 #include <Graphics/DX12/DeviceDX12.h>
 #include <Graphics/DX12/TextureDX12.h>
+#include <Graphics/DX12/TextureStreamerDX12.h>
 #include <Graphics/DX12/VertexBufferDX12.h>
 #include <Graphics/DX12/IndexBufferDX12.h>
 #include <Graphics/ComputeCommandBuffer.h>
 #include <Graphics/Mesh.h>
 #include <Graphics/SceneNode.h>
+#include <Graphics/SceneFile.h>
+#include <Graphics/TransformHierarchy.h>
+#include <Graphics/VertexCompression.h>
+#include <Graphics/MeshletBuilder.h>
 #include <Graphics/Material.h>
 
+#include <DependencyTracker.h>
+#include <Hash.h>
 #include <LogManager.h>
 #include <SceneVisitor.h>
+#include <ThreadPool.h>
 
 using namespace Core;
 using namespace Graphics;
 
-#define EXPORT_FORMAT "assbin"
-#define EXPORT_EXTENSION "assbin"
+// The extension of the cooked scene files (see SceneFile).
+#define SCENE_FILE_EXTENSION "scene"
+
+// Assimp stores its matrices in row-major but GLM uses column-major.
+// We have to transpose the matrix before using it to construct a glm matrix.
+static glm::mat4 ConvertTransform( const aiMatrix4x4& mat )
+{
+    return glm::mat4( mat.a1, mat.b1, mat.c1, mat.d1,
+                      mat.a2, mat.b2, mat.c2, mat.d2,
+                      mat.a3, mat.b3, mat.c3, mat.d3,
+                      mat.a4, mat.b4, mat.c4, mat.d4 );
+}
+
+// Store the node hierarchy of an assimp scene as a flat array (parents before children).
+static void FlattenSceneNode( SceneFile::Contents& contents, const aiNode* aiNode, uint32_t parentIndex )
+{
+    uint32_t nodeIndex = static_cast<uint32_t>( contents.Nodes.size() );
+
+    SceneFile::NodeRecord node = {};
+    node.LocalTransform = ConvertTransform( aiNode->mTransformation );
+    node.ParentIndex = parentIndex;
+    node.Name = contents.AddString( aiNode->mName.C_Str() );
+    node.FirstMesh = static_cast<uint32_t>( contents.NodeMeshes.size() );
+    node.NumMeshes = aiNode->mNumMeshes;
+
+    contents.Nodes.push_back( node );
+    contents.NodeMeshes.insert( contents.NodeMeshes.end(), aiNode->mMeshes, aiNode->mMeshes + aiNode->mNumMeshes );
+
+    for ( unsigned int i = 0; i < aiNode->mNumChildren; ++i )
+    {
+        FlattenSceneNode( contents, aiNode->mChildren[i], nodeIndex );
+    }
+}
+
+// Smaller transparent meshes are only sorted per mesh.
+static const size_t gs_MinSortedTriangles = 256;
+
+// Keep a copy of the triangles of a mesh on the CPU (see Mesh::SetTriangles).
+// The vertices and indices are in the layout of the vertex and index buffers of the mesh.
+static void SetTriangles( Mesh& mesh, const void* vertices, const void* indices, size_t numIndices, size_t indexSize )
+{
+    size_t numTriangles = numIndices / 3;
+    if ( numTriangles < gs_MinSortedTriangles )
+    {
+        return;
+    }
+
+    std::vector<uint32_t> triangleIndices( numTriangles * 3 );
+    for ( size_t i = 0; i < triangleIndices.size(); ++i )
+    {
+        triangleIndices[i] = ( indexSize == sizeof( uint16_t ) ) ? static_cast<const uint16_t*>( indices )[i] : static_cast<const uint32_t*>( indices )[i];
+    }
+
+    std::vector<glm::vec3> triangleCenters( numTriangles );
+    for ( size_t i = 0; i < numTriangles; ++i )
+    {
+        glm::vec3 center( 0.0f );
+        for ( size_t j = 0; j < 3; ++j )
+        {
+            uint32_t index = triangleIndices[i * 3 + j];
+            if ( mesh.GetVertexFormat() == Mesh::VertexFormat::Compact )
+            {
+                center += VertexCompression::Decode( static_cast<const Mesh::CompactVertex*>( vertices )[index], mesh.GetPositionTransform() ).Position;
+            }
+            else
+            {
+                center += static_cast<const Mesh::Vertex*>( vertices )[index].Position;
+            }
+        }
+        triangleCenters[i] = center / 3.0f;
+    }
+
+    mesh.SetTriangles( std::move( triangleIndices ), std::move( triangleCenters ) );
+}
+
+// The usage of a texture determines how the texture is cooked.
+static TextureUsage GetTextureUsage( const SceneDX12::MaterialTexture& materialTexture )
+{
+    if ( materialTexture.IsBumpMap )
+    {
+        return TextureUsage::Bump;
+    }
+
+    switch ( materialTexture.TextureType )
+    {
+    case Material::TextureType::Normal:
+        return TextureUsage::NormalMap;
+    case Material::TextureType::SpecularPower:
+    case Material::TextureType::Bump:
+    case Material::TextureType::Opacity:
+        return TextureUsage::Grayscale;
+    default:
+        return TextureUsage::Color;
+    }
+}
 
 // A private class that is registered with Assimp's importer
 // Provides feedback on the loading progress of the scene files.
@@ -49,9 +150,66 @@ private:
     std::wstring m_FileName;
 };
 
+// Tracks the progress of the parallel import stages.
+// Work items complete on the worker threads but the progress event
+// is only invoked on the thread that is loading the scene.
+class ImportProgress
+{
+public:
+    ImportProgress( SceneDX12& scene, const std::wstring& fileName, uint32_t numItems )
+        : m_Scene( scene )
+        , m_FileName( fileName )
+        , m_LoadingThread( std::this_thread::get_id() )
+        , m_NumItems( std::max( numItems, 1u ) )
+        , m_CompletedItems( 0 )
+        , m_Canceled( false )
+    {}
+
+    void ItemCompleted()
+    {
+        uint32_t completedItems = ++m_CompletedItems;
+
+        if ( std::this_thread::get_id() == m_LoadingThread )
+        {
+            Core::ProgressEventArgs progressEventArgs( m_Scene, m_FileName, completedItems / static_cast<float>( m_NumItems ) );
+
+            m_Scene.OnLoadingProgress( progressEventArgs );
+
+            if ( progressEventArgs.Cancel )
+            {
+                m_Canceled = true;
+            }
+        }
+    }
+
+    bool IsCanceled() const
+    {
+        return m_Canceled;
+    }
+
+    // The cancel flag is passed to the texture cooker so a
+    // texture that is being cooked is canceled too.
+    const std::atomic<bool>* GetCancelFlag() const
+    {
+        return &m_Canceled;
+    }
+
+private:
+    SceneDX12& m_Scene;
+    std::wstring m_FileName;
+    std::thread::id m_LoadingThread;
+    uint32_t m_NumItems;
+    std::atomic<uint32_t> m_CompletedItems;
+    std::atomic<bool> m_Canceled;
+};
+
 
 SceneDX12::SceneDX12( std::shared_ptr<DeviceDX12> device )
     : m_Device( device )
+    , m_VertexFormat( Mesh::VertexFormat::Standard )
+    , m_OptimizeOverdraw( false )
+    , m_TextureCompression( TextureCompression::None )
+    , m_SortTransparentTriangles( false )
 {}
 
 SceneDX12::~SceneDX12()
@@ -75,78 +233,98 @@ bool SceneDX12::LoadFromFile( std::shared_ptr<ComputeCommandBuffer> computeComma
         parentPath = fs::current_path();
     }
 
-    const aiScene* scene;
-    Assimp::Importer importer;
+    Application::Get().SetLoadingMessage( fileName );
 
-    importer.SetProgressHandler( new ProgressHandler( *this, fileName ) );
+    fs::path sceneFilePath = filePath;
+    sceneFilePath.replace_extension( SCENE_FILE_EXTENSION );
 
-    Application::Get().SetLoadingMessage( fileName );
+    // The cooked scene file must be recreated if the original scene file or any of its
+    // dependencies changed since the scene was cooked or if the vertex format or the index
+    // optimizations of the scene changed.
+    uint32_t buildParameters[] = { static_cast<uint32_t>( m_VertexFormat ), m_OptimizeOverdraw ? 1u : 0u };
 
-    fs::path exportPath = filePath;
-    exportPath.replace_extension( EXPORT_EXTENSION );
+    DependencyTracker dependencyTracker( fileName );
+    dependencyTracker.SetBuildParameters( Hasher::Hash( buildParameters, sizeof( buildParameters ) ) );
+    if ( !dependencyTracker.Load() )
+    {
+        // Add the scene to the dependency database. Dependencies (like material libraries)
+        // can be added to a dependency file next to the scene file.
+        dependencyTracker.Save();
+    }
 
-    if ( fs::exists( exportPath ) && fs::is_regular_file( exportPath ) )
+    SceneFile sceneFile;
+    if ( fs::exists( sceneFilePath ) && fs::is_regular_file( sceneFilePath ) )
     {
-        LOG_INFO( "Loading scene ", exportPath );
-        // If a previously exported file exists, load that instead (scene has already been preprocessed).
-        scene = importer.ReadFile( exportPath.string(), 0 );
+        dependencyTracker.SetLastLoadTime( fs::last_write_time( sceneFilePath ) );
+        if ( !dependencyTracker.IsStale() )
+        {
+            LOG_INFO( "Loading scene ", sceneFilePath );
+            // If the scene file can't be opened, the original scene is imported again.
+            sceneFile.Open( sceneFilePath.wstring() );
+        }
+
+        // The scene must also be imported again if the vertex format or the index optimizations of the scene changed.
+        if ( sceneFile.IsOpen() && ( sceneFile.GetHeader().VertexFormat != static_cast<uint32_t>( m_VertexFormat ) ||
+                                     ( sceneFile.GetHeader().OverdrawOptimized != 0 ) != m_OptimizeOverdraw ) )
+        {
+            sceneFile.Close();
+        }
     }
-    else
+
+    const aiScene* scene = nullptr;
+    Assimp::Importer importer;
+
+    if ( !sceneFile.IsOpen() )
     {
         LOG_INFO( "Loading scene ", filePath );
 
-        // If no serialized version of the model file exists (or the original model is newer than the serialized version),
-        // reimport the original scene and export it as binary.
+        importer.SetProgressHandler( new ProgressHandler( *this, fileName ) );
         importer.SetPropertyFloat( AI_CONFIG_PP_GSN_MAX_SMOOTHING_ANGLE, 80.0f );
         importer.SetPropertyInteger( AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE );
 
         unsigned int preprocessFlags = aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_OptimizeGraph;
         scene = importer.ReadFile( filePath.string(), preprocessFlags );
 
-        if ( scene )
+        if ( !scene )
         {
-            // Now export the preprocessed scene so we can load it faster next time.
-            Assimp::Exporter exporter;
-            exporter.Export( scene, EXPORT_FORMAT, exportPath.string(), preprocessFlags );
+            LogManager::LogError( importer.GetErrorString() );
+            return false;
         }
     }
 
-    if ( !scene )
+    // If we have a previously loaded scene, delete it.
+    glm::mat4 localTransform( 1 );
+    if ( m_RootNode )
     {
-        LogManager::LogError( importer.GetErrorString() );
-        return false;
+        // Save the root nodes local transform
+        // so it can be restored on reload.
+        localTransform = m_RootNode->GetLocalTransform();
+        m_RootNode.reset();
+        m_TransformHierarchy.reset();
     }
-    else
-    {
-        // If we have a previously loaded scene, delete it.
-        glm::mat4 localTransform( 1 );
-        if ( m_RootNode )
-        {
-            // Save the root nodes local transform
-            // so it can be restored on reload.
-            localTransform = m_RootNode->GetLocalTransform();
-            m_RootNode.reset();
-        }
-        // Delete the previously loaded assets.
-        m_MaterialMap.clear();
-        m_Materials.clear();
-        m_Meshes.clear();
+    // Delete the previously loaded assets.
+    m_MaterialMap.clear();
+    m_Materials.clear();
+    m_Meshes.clear();
 
-        // Import scene materials.
-        for ( unsigned int i = 0; i < scene->mNumMaterials; ++i )
+    if ( sceneFile.IsOpen() )
+    {
+        if ( !LoadSceneFile( computeCommandBuffer, sceneFile, parentPath, fileName ) )
         {
-            ImportMaterial( computeCommandBuffer, *scene->mMaterials[i], parentPath );
+            return false;
         }
-        // Import meshes
-        for ( unsigned int i = 0; i < scene->mNumMeshes; ++i )
+    }
+    else
+    {
+        // Cook the imported scene so it can be loaded from the scene file next time.
+        if ( !ImportScene( computeCommandBuffer, *scene, parentPath, fileName, sceneFilePath, &dependencyTracker ) )
         {
-            ImportMesh( computeCommandBuffer, *scene->mMeshes[i] );
+            return false;
         }
-
-        m_RootNode = ImportSceneNode( computeCommandBuffer, m_RootNode, scene->mRootNode );
-        m_RootNode->SetLocalTransform( localTransform );
     }
 
+    m_RootNode->SetLocalTransform( localTransform );
+
     return true;
 }
 
@@ -175,20 +353,13 @@ bool SceneDX12::LoadFromString( std::shared_ptr<ComputeCommandBuffer> computeCom
         if ( m_RootNode )
         {
             m_RootNode.reset();
+            m_TransformHierarchy.reset();
         }
 
-        // Import scene materials.
-        for ( unsigned int i = 0; i < scene->mNumMaterials; ++i )
+        if ( !ImportScene( computeCommandBuffer, *scene, fs::current_path(), L"String", fs::path() ) )
         {
-            ImportMaterial( computeCommandBuffer, *scene->mMaterials[i], fs::current_path() );
+            return false;
         }
-        // Import meshes
-        for ( unsigned int i = 0; i < scene->mNumMeshes; ++i )
-        {
-            ImportMesh( computeCommandBuffer, *scene->mMeshes[i] );
-        }
-
-        m_RootNode = ImportSceneNode( computeCommandBuffer, m_RootNode, scene->mRootNode );
     }
 
     return true;
@@ -202,6 +373,56 @@ void SceneDX12::Render( Core::RenderEventArgs& renderEventArgs )
     }
 }
 
+void SceneDX12::SetVertexFormat( Mesh::VertexFormat vertexFormat )
+{
+    m_VertexFormat = vertexFormat;
+}
+
+Mesh::VertexFormat SceneDX12::GetVertexFormat() const
+{
+    return m_VertexFormat;
+}
+
+void SceneDX12::SetOptimizeOverdraw( bool optimizeOverdraw )
+{
+    m_OptimizeOverdraw = optimizeOverdraw;
+}
+
+bool SceneDX12::GetOptimizeOverdraw() const
+{
+    return m_OptimizeOverdraw;
+}
+
+void SceneDX12::SetTextureCompression( TextureCompression textureCompression )
+{
+    m_TextureCompression = textureCompression;
+}
+
+TextureCompression SceneDX12::GetTextureCompression() const
+{
+    return m_TextureCompression;
+}
+
+void SceneDX12::SetTextureStreamer( std::shared_ptr<TextureStreamerDX12> textureStreamer )
+{
+    m_TextureStreamer = textureStreamer;
+}
+
+std::shared_ptr<TextureStreamerDX12> SceneDX12::GetTextureStreamer() const
+{
+    return m_TextureStreamer;
+}
+
+void SceneDX12::SetSortTransparentTriangles( bool sortTransparentTriangles )
+{
+    m_SortTransparentTriangles = sortTransparentTriangles;
+}
+
+bool SceneDX12::GetSortTransparentTriangles() const
+{
+    return m_SortTransparentTriangles;
+}
+
 std::shared_ptr<SceneNode> SceneDX12::GetRootNode() const
 {
     return m_RootNode;
@@ -210,14 +431,372 @@ std::shared_ptr<SceneNode> SceneDX12::GetRootNode() const
 void SceneDX12::Accept( Core::SceneVisitor& visitor )
 {
     visitor.Visit( *this );
-    if ( m_RootNode )
+    if ( m_TransformHierarchy )
+    {
+        // Visit the flattened hierarchy instead of recursing through the nodes.
+        m_TransformHierarchy->Accept( visitor );
+    }
+    else if ( m_RootNode )
     {
         m_RootNode->Accept( visitor );
     }
 }
 
-void SceneDX12::ImportMaterial( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const aiMaterial& material, fs::path parentPath )
+bool SceneDX12::ImportScene( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const aiScene& scene, const fs::path& parentPath, const std::wstring& fileName, const fs::path& sceneFilePath,
+                             DependencyTracker* dependencyTracker )
+{
+    // Import the material parameters and gather the textures of the materials.
+    std::vector<MaterialTexture> materialTextures;
+    for ( unsigned int i = 0; i < scene.mNumMaterials; ++i )
+    {
+        m_Materials.push_back( ImportMaterial( *scene.mMaterials[i], parentPath, materialTextures ) );
+    }
+
+    uint32_t numMeshes = scene.mNumMeshes;
+    std::vector<MeshData> meshData( numMeshes );
+
+    // The meshes are converted in the same parallel pass that decodes the textures.
+    if ( !LoadTextures( computeCommandBuffer, materialTextures, fileName, numMeshes, [&]( uint32_t i )
+    {
+        ConvertMesh( *scene.mMeshes[i], m_VertexFormat, m_OptimizeOverdraw, meshData[i] );
+    } ) )
+    {
+        return false;
+    }
+
+    VertexCacheStatistics originalStatistics;
+    VertexCacheStatistics optimizedStatistics;
+    for ( const auto& mesh : meshData )
+    {
+        originalStatistics += mesh.OriginalStatistics;
+        optimizedStatistics += mesh.OptimizedStatistics;
+    }
+    LOG_INFO( "Vertex cache ACMR: ", originalStatistics.GetACMR(), " -> ", optimizedStatistics.GetACMR(),
+              ", ATVR: ", originalStatistics.GetATVR(), " -> ", optimizedStatistics.GetATVR() );
+
+    if ( !sceneFilePath.empty() && SaveSceneFile( sceneFilePath, scene, parentPath, materialTextures, meshData ) && dependencyTracker )
+    {
+        dependencyTracker->SetUpToDate();
+    }
+
+    for ( unsigned int i = 0; i < numMeshes; ++i )
+    {
+        ImportMesh( computeCommandBuffer, *scene.mMeshes[i], meshData[i] );
+        meshData[i] = MeshData();
+    }
+
+    m_RootNode = ImportSceneNode( computeCommandBuffer, m_RootNode, scene.mRootNode );
+    m_TransformHierarchy = TransformHierarchy::Create( m_RootNode );
+
+    return true;
+}
+
+bool SceneDX12::LoadTextures( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const std::vector<MaterialTexture>& materialTextures, const std::wstring& fileName,
+                              uint32_t numMeshes, const std::function<void( uint32_t )>& convertMesh )
+{
+    std::shared_ptr<DeviceDX12> deviceDX12 = m_Device.lock();
+
+    // Only load the textures that are not already in the texture cache.
+    std::vector<std::wstring> textureFileNames;
+    std::vector<TextureUsage> textureUsages;
+    std::map<std::wstring, size_t> textureIndices;
+    for ( const auto& materialTexture : materialTextures )
+    {
+        if ( deviceDX12->FindTexture( materialTexture.FileName ) )
+        {
+            continue;
+        }
+
+        TextureUsage textureUsage = GetTextureUsage( materialTexture );
+
+        auto iter = textureIndices.emplace( materialTexture.FileName, textureFileNames.size() );
+        if ( iter.second )
+        {
+            textureFileNames.push_back( materialTexture.FileName );
+            textureUsages.push_back( textureUsage );
+        }
+        else if ( textureUsages[iter.first->second] != textureUsage )
+        {
+            // Textures that are used for different purposes are cooked as color textures (which keep all channels).
+            textureUsages[iter.first->second] = TextureUsage::Color;
+        }
+    }
+
+    uint32_t numTextures = static_cast<uint32_t>( textureFileNames.size() );
+
+    std::vector<TextureImage> textureImages( numTextures );
+
+    // Streamed textures are loaded with only the smallest mip levels.
+    uint32_t maxDimension = m_TextureStreamer ? TextureStreamerDX12::MinResidentSize : 0;
+
+    ImportProgress progress( *this, fileName, numTextures + numMeshes );
+
+    // Load the textures and convert the meshes on the thread pool. The textures come
+    // first because cooking or decoding a texture takes much longer than converting a mesh.
+    Core::ThreadPool::Get().ParallelFor( 0, numTextures + numMeshes, 1, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end && !progress.IsCanceled(); ++i )
+        {
+            if ( i < numTextures )
+            {
+                if ( !TextureCookerDX12::LoadTexture2D( textureFileNames[i], textureUsages[i], m_TextureCompression, textureImages[i], maxDimension, progress.GetCancelFlag() ) )
+                {
+                    // An empty texture is created for textures that failed to load.
+                    textureImages[i] = TextureImage();
+                    textureImages[i].FileName = textureFileNames[i];
+                }
+            }
+            else
+            {
+                convertMesh( i - numTextures );
+            }
+
+            progress.ItemCompleted();
+        }
+    } );
+
+    if ( progress.IsCanceled() )
+    {
+        return false;
+    }
+
+    // Upload the textures. Command buffers can only be used by a single thread
+    // so the uploads are recorded after all of the textures are loaded.
+    for ( auto& textureImage : textureImages )
+    {
+        Application::Get().SetLoadingMessage( textureImage.FileName );
+
+        std::shared_ptr<Texture> texture = deviceDX12->CreateTexture( computeCommandBuffer, textureImage );
+        if ( m_TextureStreamer )
+        {
+            m_TextureStreamer->AddTexture( std::dynamic_pointer_cast<TextureDX12>( texture ), textureImage );
+        }
+
+        // Release the pixels (they have been copied to the upload heap).
+        textureImage = TextureImage();
+    }
+
+    for ( const auto& materialTexture : materialTextures )
+    {
+        std::shared_ptr<Texture> pTexture = deviceDX12->FindTexture( materialTexture.FileName );
+        Material::TextureType textureType = materialTexture.TextureType;
+
+        if ( materialTexture.IsBumpMap )
+        {
+            // Some materials actually store normal maps in the bump map slot. Assimp can't tell the difference between 
+            // these two texture types, so we try to make an assumption about whether the texture is a normal map or a bump
+            // map based on its pixel depth. Bump maps are usually 8 BPP (grayscale) and normal maps are usually 24 BPP or higher.
+            textureType = ( pTexture->GetBPP() >= 24 ) ? Material::TextureType::Normal : Material::TextureType::Bump;
+        }
+
+        materialTexture.TargetMaterial->SetTexture( textureType, pTexture );
+    }
+
+    return true;
+}
+
+bool SceneDX12::LoadSceneFile( std::shared_ptr<ComputeCommandBuffer> computeCommandBuffer, const SceneFile& sceneFile, const fs::path& parentPath, const std::wstring& fileName )
+{
+    std::shared_ptr<DeviceDX12> deviceDX12 = m_Device.lock();
+
+    const SceneFile::Header& header = sceneFile.GetHeader();
+
+    const SceneFile::MaterialRecord* materials = sceneFile.GetMaterials();
+    for ( uint32_t i = 0; i < header.NumMaterials; ++i )
+    {
+        const SceneFile::MaterialRecord& material = materials[i];
+
+        std::shared_ptr<Material> pMaterial = deviceDX12->CreateMaterial();
+        pMaterial->SetAmbientColor( material.AmbientColor );
+        pMaterial->SetEmissiveColor( material.EmissiveColor );
+        pMaterial->SetDiffuseColor( material.DiffuseColor );
+        pMaterial->SetSpecularColor( material.SpecularColor );
+        pMaterial->SetSpecularPower( material.SpecularPower );
+        pMaterial->SetOpacity( material.Opacity );
+        pMaterial->SetIndexOfRefraction( material.IndexOfRefraction );
+        pMaterial->SetReflectance( material.Reflectance );
+        pMaterial->SetBumpIntensity( material.BumpIntensity );
+
+        m_Materials.push_back( pMaterial );
+    }
+
+    // Texture file names are stored relative to the scene file.
+    std::vector<MaterialTexture> materialTextures;
+    const SceneFile::TextureRecord* textures = sceneFile.GetTextures();
+    for ( uint32_t i = 0; i < header.NumTextures; ++i )
+    {
+        const SceneFile::TextureRecord& texture = textures[i];
+        fs::path texturePath = fs::u8path( sceneFile.GetString( texture.FileName ) );
+
+        materialTextures.push_back( { m_Materials[texture.MaterialIndex], static_cast<Material::TextureType>( texture.TextureType ),
+                                      ( parentPath / texturePath ).wstring(), texture.IsBumpMap != 0 } );
+    }
+
+    if ( !LoadTextures( computeCommandBuffer, materialTextures, fileName ) )
+    {
+        return false;
+    }
+
+    // The vertex and index buffers are copied directly from the memory mapped file.
+    const SceneFile::MeshRecord* meshes = sceneFile.GetMeshes();
+    for ( uint32_t i = 0; i < header.NumMeshes; ++i )
+    {
+        const SceneFile::MeshRecord& mesh = meshes[i];
+
+        std::shared_ptr<Mesh> pMesh = deviceDX12->CreateMesh();
+        pMesh->SetMaterial( m_Materials[mesh.MaterialIndex] );
+
+        std::shared_ptr<VertexBuffer> vertexBuffer = deviceDX12->CreateVertexBuffer( computeCommandBuffer, mesh.NumVertices, header.VertexSize, sceneFile.GetVertices() + mesh.FirstVertex * header.VertexSize );
+        pMesh->SetVertexBuffer( 0, vertexBuffer );
+        pMesh->SetVertexFormat( static_cast<Mesh::VertexFormat>( header.VertexFormat ) );
+        pMesh->SetPositionTransform( mesh.PositionTransform );
+        pMesh->SetMeshlets( std::vector<Meshlet>( sceneFile.GetMeshlets() + mesh.FirstMeshlet, sceneFile.GetMeshlets() + mesh.FirstMeshlet + mesh.NumMeshlets ) );
+        pMesh->SetBounds( mesh.Bounds, mesh.BoundingSphere );
+
+        if ( mesh.NumIndices > 0 )
+        {
+            std::shared_ptr<IndexBuffer> indexBuffer = deviceDX12->CreateIndexBuffer( computeCommandBuffer, mesh.NumIndices, mesh.IndexSize, sceneFile.GetIndices() + mesh.FirstIndex );
+            pMesh->SetIndexBuffer( indexBuffer );
+
+            if ( m_SortTransparentTriangles && m_Materials[mesh.MaterialIndex]->IsTransparent() )
+            {
+                SetTriangles( *pMesh, sceneFile.GetVertices() + mesh.FirstVertex * header.VertexSize, sceneFile.GetIndices() + mesh.FirstIndex, mesh.NumIndices, mesh.IndexSize );
+            }
+        }
+
+        m_Meshes.push_back( pMesh );
+    }
+
+    // Parent nodes are stored before their children.
+    std::vector<std::shared_ptr<SceneNode>> nodes( header.NumNodes );
+    const SceneFile::NodeRecord* nodeRecords = sceneFile.GetNodes();
+    const uint32_t* nodeMeshes = sceneFile.GetNodeMeshes();
+    for ( uint32_t i = 0; i < header.NumNodes; ++i )
+    {
+        const SceneFile::NodeRecord& node = nodeRecords[i];
+
+        std::shared_ptr<SceneNode> pNode = std::make_shared<SceneNode>( node.LocalTransform );
+
+        std::string nodeName( sceneFile.GetString( node.Name ) );
+        if ( !nodeName.empty() )
+        {
+            pNode->SetName( nodeName );
+        }
+
+        for ( uint32_t j = 0; j < node.NumMeshes; ++j )
+        {
+            pNode->AddMesh( m_Meshes[nodeMeshes[node.FirstMesh + j]] );
+        }
+
+        if ( node.ParentIndex != SceneFile::InvalidIndex )
+        {
+            pNode->SetParent( nodes[node.ParentIndex] );
+        }
+
+        nodes[i] = pNode;
+    }
+
+    m_RootNode = nodes[0];
+    m_TransformHierarchy = TransformHierarchy::Create( m_RootNode );
+
+    return true;
+}
+
+bool SceneDX12::SaveSceneFile( const fs::path& sceneFilePath, const aiScene& scene, const fs::path& parentPath, const std::vector<MaterialTexture>& materialTextures, const std::vector<MeshData>& meshData ) const
 {
+    SceneFile::Contents contents;
+    contents.VertexFormat = m_VertexFormat;
+    contents.OverdrawOptimized = m_OptimizeOverdraw;
+
+    for ( const auto& pMaterial : m_Materials )
+    {
+        SceneFile::MaterialRecord material = {};
+        material.AmbientColor = pMaterial->GetAmbientColor();
+        material.EmissiveColor = pMaterial->GetEmissiveColor();
+        material.DiffuseColor = pMaterial->GetDiffuseColor();
+        material.SpecularColor = pMaterial->GetSpecularColor();
+        material.Reflectance = pMaterial->GetReflectance();
+        material.SpecularPower = pMaterial->GetSpecularPower();
+        material.Opacity = pMaterial->GetOpacity();
+        material.IndexOfRefraction = pMaterial->GetIndexOfRefraction();
+        material.BumpIntensity = pMaterial->GetBumpIntensity();
+
+        contents.Materials.push_back( material );
+    }
+
+    for ( const auto& materialTexture : materialTextures )
+    {
+        SceneFile::TextureRecord texture = {};
+        texture.MaterialIndex = static_cast<uint32_t>( std::find( m_Materials.begin(), m_Materials.end(), materialTexture.TargetMaterial ) - m_Materials.begin() );
+        texture.TextureType = static_cast<uint32_t>( materialTexture.TextureType );
+        texture.IsBumpMap = materialTexture.IsBumpMap ? 1 : 0;
+        texture.FileName = contents.AddString( fs::path( materialTexture.FileName ).lexically_relative( parentPath ).u8string() );
+
+        contents.Textures.push_back( texture );
+    }
+
+    const uint32_t vertexSize = SceneFile::GetVertexSize( m_VertexFormat );
+    for ( unsigned int i = 0; i < scene.mNumMeshes; ++i )
+    {
+        SceneFile::MeshRecord mesh = {};
+        mesh.MaterialIndex = scene.mMeshes[i]->mMaterialIndex;
+        mesh.FirstVertex = contents.Vertices.size() / vertexSize;
+        mesh.FirstMeshlet = static_cast<uint32_t>( contents.Meshlets.size() );
+        mesh.NumMeshlets = static_cast<uint32_t>( meshData[i].Meshlets.size() );
+        mesh.PositionTransform = meshData[i].PositionTransform;
+        mesh.Bounds = meshData[i].Bounds;
+        mesh.BoundingSphere = meshData[i].BoundingSphere;
+
+        const uint8_t* vertices;
+        if ( m_VertexFormat == Mesh::VertexFormat::Compact )
+        {
+            mesh.NumVertices = static_cast<uint32_t>( meshData[i].CompactVertices.size() );
+            vertices = reinterpret_cast<const uint8_t*>( meshData[i].CompactVertices.data() );
+        }
+        else
+        {
+            mesh.NumVertices = static_cast<uint32_t>( meshData[i].Vertices.size() );
+            vertices = reinterpret_cast<const uint8_t*>( meshData[i].Vertices.data() );
+        }
+
+        if ( !meshData[i].ShortIndices.empty() )
+        {
+            mesh.NumIndices = static_cast<uint32_t>( meshData[i].ShortIndices.size() );
+            mesh.IndexSize = sizeof( uint16_t );
+            mesh.FirstIndex = contents.AddIndices( meshData[i].ShortIndices.data(), mesh.NumIndices, mesh.IndexSize );
+        }
+        else
+        {
+            mesh.NumIndices = static_cast<uint32_t>( meshData[i].Indices.size() );
+            mesh.IndexSize = sizeof( uint32_t );
+            mesh.FirstIndex = contents.AddIndices( meshData[i].Indices.data(), mesh.NumIndices, mesh.IndexSize );
+        }
+
+        contents.Meshes.push_back( mesh );
+        contents.Meshlets.insert( contents.Meshlets.end(), meshData[i].Meshlets.begin(), meshData[i].Meshlets.end() );
+        contents.Vertices.insert( contents.Vertices.end(), vertices, vertices + mesh.NumVertices * vertexSize );
+    }
+
+    FlattenSceneNode( contents, scene.mRootNode, SceneFile::InvalidIndex );
+
+    LOG_INFO( "Saving scene ", sceneFilePath );
+
+    return SceneFile::Save( sceneFilePath.wstring(), contents );
+}
+
+std::shared_ptr<Material> SceneDX12::ImportMaterial( const aiMaterial& material, const fs::path& parentPath, std::vector<MaterialTexture>& textures )
+{
+    // The assimp texture types that are loaded into the texture slots of the material.
+    static const std::pair<aiTextureType, Material::TextureType> textureTypes[] =
+    {
+        { aiTextureType_AMBIENT, Material::TextureType::Ambient },
+        { aiTextureType_EMISSIVE, Material::TextureType::Emissive },
+        { aiTextureType_DIFFUSE, Material::TextureType::Diffuse },
+        { aiTextureType_SPECULAR, Material::TextureType::Specular },
+        { aiTextureType_SHININESS, Material::TextureType::SpecularPower },
+        { aiTextureType_OPACITY, Material::TextureType::Opacity },
+    };
+
     aiString materialName;
     aiString aiTexturePath;
     aiTextureOp aiBlendOperation;
@@ -273,58 +852,14 @@ void SceneDX12::ImportMaterial( std::shared_ptr<ComputeCommandBuffer> computeCom
         pMaterial->SetBumpIntensity( bumpIntensity );
     }
 
-    // Load ambient textures.
-    if ( material.GetTextureCount( aiTextureType_AMBIENT ) > 0 &&
-         material.GetTexture( aiTextureType_AMBIENT, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
-    {
-        fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::Ambient, pTexture );
-    }
-
-    // Load emissive textures.
-    if ( material.GetTextureCount( aiTextureType_EMISSIVE ) > 0 &&
-         material.GetTexture( aiTextureType_EMISSIVE, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
+    for ( const auto& textureType : textureTypes )
     {
-        fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::Emissive, pTexture );
-    }
-
-    // Load diffuse textures.
-    if ( material.GetTextureCount( aiTextureType_DIFFUSE ) > 0 &&
-         material.GetTexture( aiTextureType_DIFFUSE, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
-    {
-        fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::Diffuse, pTexture );
-    }
-
-    // Load specular texture.
-    if ( material.GetTextureCount( aiTextureType_SPECULAR ) > 0 &&
-         material.GetTexture( aiTextureType_SPECULAR, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
-    {
-        fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::Specular, pTexture );
-    }
-
-
-    // Load specular power texture.
-    if ( material.GetTextureCount( aiTextureType_SHININESS ) > 0 &&
-         material.GetTexture( aiTextureType_SHININESS, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
-    {
-        fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::SpecularPower, pTexture );
-    }
-
-    if ( material.GetTextureCount( aiTextureType_OPACITY ) > 0 &&
-         material.GetTexture( aiTextureType_OPACITY, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
-    {
-        fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::Opacity, pTexture );
+        if ( material.GetTextureCount( textureType.first ) > 0 &&
+             material.GetTexture( textureType.first, 0, &aiTexturePath, nullptr, nullptr, &blendFactor, &aiBlendOperation ) == aiReturn_SUCCESS )
+        {
+            fs::path texturePath( aiTexturePath.C_Str() );
+            textures.push_back( { pMaterial, textureType.second, ( parentPath / texturePath ).wstring(), false } );
+        }
     }
 
     // Load normal map texture.
@@ -332,119 +867,162 @@ void SceneDX12::ImportMaterial( std::shared_ptr<ComputeCommandBuffer> computeCom
          material.GetTexture( aiTextureType_NORMALS, 0, &aiTexturePath ) == aiReturn_SUCCESS )
     {
         fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-        pMaterial->SetTexture( Material::TextureType::Normal, pTexture );
+        textures.push_back( { pMaterial, Material::TextureType::Normal, ( parentPath / texturePath ).wstring(), false } );
     }
     // Load bump map (only if there is no normal map).
     else if ( material.GetTextureCount( aiTextureType_HEIGHT ) > 0 &&
               material.GetTexture( aiTextureType_HEIGHT, 0, &aiTexturePath, nullptr, nullptr, &blendFactor ) == aiReturn_SUCCESS )
     {
         fs::path texturePath( aiTexturePath.C_Str() );
-        std::shared_ptr<Texture> pTexture = deviceDX12->CreateTexture( computeCommandBuffer, ( parentPath / texturePath ).wstring() );
-
-        // Some materials actually store normal maps in the bump map slot. Assimp can't tell the difference between 
-        // these two texture types, so we try to make an assumption about whether the texture is a normal map or a bump
-        // map based on its pixel depth. Bump maps are usually 8 BPP (grayscale) and normal maps are usually 24 BPP or higher.
-        Material::TextureType textureType = ( pTexture->GetBPP() >= 24 ) ? Material::TextureType::Normal : Material::TextureType::Bump;
-
-        pMaterial->SetTexture( textureType, pTexture );
+        textures.push_back( { pMaterial, Material::TextureType::Bump, ( parentPath / texturePath ).wstring(), true } );
     }
 
     //m_MaterialMap.insert( MaterialMap::value_type( materialName.C_Str(), pMaterial ) );
-    m_Materials.push_back( pMaterial );
+    return pMaterial;
 }
 
-void SceneDX12::ImportMesh( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const aiMesh& mesh )
+void SceneDX12::ConvertMesh( const aiMesh& mesh, Mesh::VertexFormat vertexFormat, bool optimizeOverdraw, MeshData& meshData )
 {
-    std::shared_ptr<Device> device = m_Device.lock();
+    std::vector<Mesh::Vertex>& vertexData = meshData.Vertices;
+    vertexData.resize( mesh.mNumVertices );
 
-    std::shared_ptr<Mesh> pMesh = device->CreateMesh();
+    const bool hasPositions = mesh.HasPositions();
+    const bool hasNormals = mesh.HasNormals();
+    const bool hasTangents = mesh.HasTangentsAndBitangents();
+    const unsigned int numUVComponents = mesh.HasTextureCoords( 0 ) ? mesh.mNumUVComponents[0] : 0;
 
-    assert( mesh.mMaterialIndex < m_Materials.size() );
-    pMesh->SetMaterial( m_Materials[mesh.mMaterialIndex] );
-
-    std::vector<Mesh::Vertex> vertexData( mesh.mNumVertices );
-    unsigned int i;
-
-    if ( mesh.HasPositions() )
+    // Convert all of the vertex attributes in a single pass over the vertices.
+    for ( unsigned int i = 0; i < mesh.mNumVertices; ++i )
     {
-        for ( i = 0; i < mesh.mNumVertices; ++i )
+        Mesh::Vertex& vertex = vertexData[i];
+
+        if ( hasPositions )
         {
-            vertexData[i].Position = glm::vec3( mesh.mVertices[i].x, mesh.mVertices[i].y, mesh.mVertices[i].z );
+            vertex.Position = glm::vec3( mesh.mVertices[i].x, mesh.mVertices[i].y, mesh.mVertices[i].z );
         }
-    }
-
-    if ( mesh.HasNormals() )
-    {
-        for ( i = 0; i < mesh.mNumVertices; ++i )
+        if ( hasNormals )
         {
-            vertexData[i].Normal = glm::vec3( mesh.mNormals[i].x, mesh.mNormals[i].y, mesh.mNormals[i].z );
+            vertex.Normal = glm::vec3( mesh.mNormals[i].x, mesh.mNormals[i].y, mesh.mNormals[i].z );
         }
-    }
-
-    if ( mesh.HasTangentsAndBitangents() )
-    {
-        for ( i = 0; i < mesh.mNumVertices; ++i )
+        if ( hasTangents )
         {
-            vertexData[i].Tangent = glm::vec3( mesh.mTangents[i].x, mesh.mTangents[i].y, mesh.mTangents[i].z );
-            vertexData[i].BiTangent = glm::vec3( mesh.mBitangents[i].x, mesh.mBitangents[i].y, mesh.mBitangents[i].z );
+            vertex.Tangent = glm::vec3( mesh.mTangents[i].x, mesh.mTangents[i].y, mesh.mTangents[i].z );
+            vertex.BiTangent = glm::vec3( mesh.mBitangents[i].x, mesh.mBitangents[i].y, mesh.mBitangents[i].z );
         }
-    }
 
-    if ( mesh.HasTextureCoords( 0 ) )
-    {
-        switch ( mesh.mNumUVComponents[0] )
+        switch ( numUVComponents )
         {
         case 1: // 1-component texture coordinates (U)
-        {
-            std::vector<float> texcoods1D( mesh.mNumVertices );
-            for ( i = 0; i < mesh.mNumVertices; ++i )
-            {
-                vertexData[i].TexCoord = glm::vec3( mesh.mTextureCoords[0][i].x, 0, 0 );
-            }
-        }
-        break;
+            vertex.TexCoord = glm::vec3( mesh.mTextureCoords[0][i].x, 0, 0 );
+            break;
         case 2: // 2-component texture coordinates (U,V)
-        {
-            for ( i = 0; i < mesh.mNumVertices; ++i )
-            {
-                vertexData[i].TexCoord = glm::vec3( mesh.mTextureCoords[0][i].x, mesh.mTextureCoords[0][i].y, 0 );
-            }
-        }
-        break;
+            vertex.TexCoord = glm::vec3( mesh.mTextureCoords[0][i].x, mesh.mTextureCoords[0][i].y, 0 );
+            break;
         case 3: // 3-component texture coordinates (U,V,W)
-        {
-            for ( i = 0; i < mesh.mNumVertices; ++i )
-            {
-                vertexData[i].TexCoord = glm::vec3( mesh.mTextureCoords[0][i].x, mesh.mTextureCoords[0][i].y, mesh.mTextureCoords[0][i].z );
-            }
-        }
-        break;
+            vertex.TexCoord = glm::vec3( mesh.mTextureCoords[0][i].x, mesh.mTextureCoords[0][i].y, mesh.mTextureCoords[0][i].z );
+            break;
         }
     }
 
-    std::shared_ptr<VertexBuffer> vertexBuffer = device->CreateVertexBuffer( copyCommandBuffer, vertexData );
-    pMesh->SetVertexBuffer( 0, vertexBuffer );
-
     // Extract the index buffer.
     if ( mesh.HasFaces() )
     {
-        std::vector<unsigned int> indices;
+        std::vector<unsigned int>& indices = meshData.Indices;
+        indices.reserve( mesh.mNumFaces * 3 );
+
         for ( unsigned int i = 0; i < mesh.mNumFaces; ++i )
         {
             const aiFace& face = mesh.mFaces[i];
             // Only extract triangular faces
             if ( face.mNumIndices == 3 )
             {
-                indices.push_back( face.mIndices[0] );
-                indices.push_back( face.mIndices[1] );
-                indices.push_back( face.mIndices[2] );
+                indices.insert( indices.end(), face.mIndices, face.mIndices + 3 );
             }
         }
-        if ( indices.size() > 0 )
+
+        meshData.OriginalStatistics = IndexOptimizer::AnalyzeVertexCache( indices.data(), indices.size(), vertexData.size() );
+
+        IndexOptimizer::OptimizeVertexCache( indices.data(), indices.size(), vertexData.size() );
+        if ( optimizeOverdraw )
+        {
+            IndexOptimizer::OptimizeOverdraw( indices.data(), indices.size(), vertexData.data(), vertexData.size() );
+        }
+
+        meshData.OptimizedStatistics = IndexOptimizer::AnalyzeVertexCache( indices.data(), indices.size(), vertexData.size() );
+
+        // The meshlets follow the optimized triangle order.
+        MeshletBuilder::Build( indices.data(), indices.size(), vertexData.data(), vertexData.size(), meshData.Meshlets );
+
+        if ( IndexOptimizer::CanUse16BitIndices( vertexData.size() ) )
         {
-            std::shared_ptr<IndexBuffer> indexBuffer = device->CreateIndexBuffer( copyCommandBuffer, indices );
-            pMesh->SetIndexBuffer( indexBuffer );
+            meshData.ShortIndices.resize( indices.size() );
+            IndexOptimizer::ConvertTo16BitIndices( indices.data(), indices.size(), meshData.ShortIndices.data() );
+
+            // Only the 16-bit indices are uploaded.
+            std::vector<unsigned int>().swap( indices );
+        }
+    }
+
+    meshData.PositionTransform = glm::mat4( 1.0f );
+
+    // The bounds are computed from the uncompressed positions.
+    Mesh::ComputeBounds( vertexData.data(), vertexData.size(), meshData.Bounds, meshData.BoundingSphere );
+
+    if ( vertexFormat == Mesh::VertexFormat::Compact )
+    {
+        meshData.CompactVertices.resize( vertexData.size() );
+        VertexCompression::Encode( vertexData.data(), vertexData.size(), meshData.CompactVertices.data(), meshData.PositionTransform );
+
+        // Only the compact vertices are uploaded.
+        std::vector<Mesh::Vertex>().swap( vertexData );
+    }
+}
+
+void SceneDX12::ImportMesh( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const aiMesh& mesh, const MeshData& meshData )
+{
+    std::shared_ptr<DeviceDX12> device = m_Device.lock();
+
+    std::shared_ptr<Mesh> pMesh = device->CreateMesh();
+
+    assert( mesh.mMaterialIndex < m_Materials.size() );
+    pMesh->SetMaterial( m_Materials[mesh.mMaterialIndex] );
+
+    std::shared_ptr<VertexBuffer> vertexBuffer;
+    if ( m_VertexFormat == Mesh::VertexFormat::Compact )
+    {
+        vertexBuffer = device->CreateVertexBuffer( copyCommandBuffer, meshData.CompactVertices );
+    }
+    else
+    {
+        vertexBuffer = device->CreateVertexBuffer( copyCommandBuffer, meshData.Vertices );
+    }
+    pMesh->SetVertexBuffer( 0, vertexBuffer );
+    pMesh->SetVertexFormat( m_VertexFormat );
+    pMesh->SetPositionTransform( meshData.PositionTransform );
+    pMesh->SetMeshlets( meshData.Meshlets );
+    pMesh->SetBounds( meshData.Bounds, meshData.BoundingSphere );
+
+    if ( meshData.ShortIndices.size() > 0 )
+    {
+        std::shared_ptr<IndexBuffer> indexBuffer = device->CreateIndexBuffer( copyCommandBuffer, meshData.ShortIndices.size(), sizeof( uint16_t ), meshData.ShortIndices.data() );
+        pMesh->SetIndexBuffer( indexBuffer );
+    }
+    else if ( meshData.Indices.size() > 0 )
+    {
+        std::shared_ptr<IndexBuffer> indexBuffer = device->CreateIndexBuffer( copyCommandBuffer, meshData.Indices.size(), sizeof( uint32_t ), meshData.Indices.data() );
+        pMesh->SetIndexBuffer( indexBuffer );
+    }
+
+    if ( m_SortTransparentTriangles && pMesh->GetMaterial()->IsTransparent() )
+    {
+        const void* vertices = ( m_VertexFormat == Mesh::VertexFormat::Compact ) ? static_cast<const void*>( meshData.CompactVertices.data() ) : static_cast<const void*>( meshData.Vertices.data() );
+        if ( meshData.ShortIndices.size() > 0 )
+        {
+            SetTriangles( *pMesh, vertices, meshData.ShortIndices.data(), meshData.ShortIndices.size(), sizeof( uint16_t ) );
+        }
+        else
+        {
+            SetTriangles( *pMesh, vertices, meshData.Indices.data(), meshData.Indices.size(), sizeof( uint32_t ) );
         }
     }
 
@@ -458,15 +1036,7 @@ std::shared_ptr<SceneNode> SceneDX12::ImportSceneNode( std::shared_ptr<CopyComma
         return nullptr;
     }
 
-    // Assimp stores its matrices in row-major but GLM uses column-major.
-    // We have to transpose the matrix before using it to construct a glm matrix.
-    aiMatrix4x4 mat = aiNode->mTransformation;
-    glm::mat4 localTransform( mat.a1, mat.b1, mat.c1, mat.d1,
-                              mat.a2, mat.b2, mat.c2, mat.d2,
-                              mat.a3, mat.b3, mat.c3, mat.d3,
-                              mat.a4, mat.b4, mat.c4, mat.d4 );
-
-    std::shared_ptr<SceneNode> pNode = std::make_shared<SceneNode>( localTransform );
+    std::shared_ptr<SceneNode> pNode = std::make_shared<SceneNode>( ConvertTransform( aiNode->mTransformation ) );
     pNode->SetParent( parent );
 
     std::string nodeName( aiNode->mName.C_Str() );
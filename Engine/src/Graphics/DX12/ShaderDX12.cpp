@@ -285,8 +285,8 @@ bool ShaderDX12::LoadShaderFromFile( ShaderType type, const std::wstring& fileNa
         m_DependencyTracker = DependencyTracker( fileName );
         if ( !m_DependencyTracker.Load() )
         {
-            // Save the configuration file for the dependency tracker (if it doesn't exist 
-            // for the loaded asset).
+            // Add the shader to the dependency database (if it isn't in the 
+            // database yet).
             m_DependencyTracker.Save();
         }
 
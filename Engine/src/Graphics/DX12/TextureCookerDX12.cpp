@@ -0,0 +1,627 @@
+#include <EnginePCH.h>
+
+#include <Graphics/DX12/TextureCookerDX12.h>
+#include <Graphics/DX12/TextureDX12.h>
+#include <Graphics/DXGI/TextureFormatDXGI.h>
+#include <Graphics/BlockCompression.h>
+
+#include <DependencyTracker.h>
+#include <Hash.h>
+#include <LogManager.h>
+#include <ThreadPool.h>
+
+using namespace Core;
+using namespace Graphics;
+
+namespace
+{
+    // The extension that is appended to the file name of the source image.
+    const wchar_t* CookedFileExtension = L".dds";
+
+    // The number of rows of pixels or blocks that are processed by a single task.
+    const uint32_t RowsPerTask = 16;
+
+    constexpr uint32_t MakeFourCC( char c0, char c1, char c2, char c3 )
+    {
+        return static_cast<uint32_t>( c0 ) | ( static_cast<uint32_t>( c1 ) << 8 ) | ( static_cast<uint32_t>( c2 ) << 16 ) | ( static_cast<uint32_t>( c3 ) << 24 );
+    }
+
+    const uint32_t DDSMagic = MakeFourCC( 'D', 'D', 'S', ' ' );
+    const uint32_t DX10FourCC = MakeFourCC( 'D', 'X', '1', '0' );
+    // Identifies the DDS files that were written by the texture cooker.
+    const uint32_t CookedTextureTag = MakeFourCC( 'V', 'T', 'F', 'S' );
+
+    // DDS file structures.
+    // Source: https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+    struct DDSPixelFormat
+    {
+        uint32_t Size;
+        uint32_t Flags;
+        uint32_t FourCC;
+        uint32_t RGBBitCount;
+        uint32_t RBitMask;
+        uint32_t GBitMask;
+        uint32_t BBitMask;
+        uint32_t ABitMask;
+    };
+
+    struct DDSHeader
+    {
+        uint32_t Size;
+        uint32_t Flags;
+        uint32_t Height;
+        uint32_t Width;
+        uint32_t PitchOrLinearSize;
+        uint32_t Depth;
+        uint32_t MipMapCount;
+        // The cooker stores the properties of the source image in the reserved fields:
+        // the tag, the bits per pixel and the transparency of the source image.
+        uint32_t Reserved1[11];
+        DDSPixelFormat PixelFormat;
+        uint32_t Caps;
+        uint32_t Caps2;
+        uint32_t Caps3;
+        uint32_t Caps4;
+        uint32_t Reserved2;
+    };
+
+    struct DDSHeaderDX10
+    {
+        DXGI_FORMAT Format;
+        uint32_t ResourceDimension;
+        uint32_t MiscFlag;
+        uint32_t ArraySize;
+        uint32_t MiscFlags2;
+    };
+
+    static_assert( sizeof( DDSHeader ) == 124, "Invalid DDS header size." );
+    static_assert( sizeof( DDSHeaderDX10 ) == 20, "Invalid DDS DX10 header size." );
+
+    const uint32_t DDSD_CAPS = 0x1;
+    const uint32_t DDSD_HEIGHT = 0x2;
+    const uint32_t DDSD_WIDTH = 0x4;
+    const uint32_t DDSD_PIXELFORMAT = 0x1000;
+    const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+    const uint32_t DDSD_LINEARSIZE = 0x80000;
+    const uint32_t DDPF_FOURCC = 0x4;
+    const uint32_t DDSCAPS_COMPLEX = 0x8;
+    const uint32_t DDSCAPS_TEXTURE = 0x1000;
+    const uint32_t DDSCAPS_MIPMAP = 0x400000;
+    const uint32_t DDS_DIMENSION_TEXTURE2D = 3;
+
+    // The size in bytes of all mip levels of an image.
+    // Remove the first numMipLevels mip levels of a cooked image.
+    void SkipMipLevels( TextureImage& image, uint32_t numMipLevels )
+    {
+        if ( numMipLevels == 0 )
+        {
+            return;
+        }
+
+        size_t numBytes = TextureCookerDX12::GetImageSize( image.Width, image.Height, numMipLevels, image.Format );
+        image.Pixels.erase( image.Pixels.begin(), image.Pixels.begin() + numBytes );
+
+        image.Width >>= numMipLevels;
+        image.Height >>= numMipLevels;
+        image.MipLevels -= numMipLevels;
+        image.MostDetailedMip += numMipLevels;
+
+        size_t rowPitch;
+        GetSurfaceInfo( image.Width, image.Height, image.Format, nullptr, &rowPitch, nullptr );
+        image.Pitch = rowPitch;
+    }
+
+    // Source: https://en.wikipedia.org/wiki/SRGB
+    float SRGBToLinear( float c )
+    {
+        return ( c <= 0.04045f ) ? c / 12.92f : std::pow( ( c + 0.055f ) / 1.055f, 2.4f );
+    }
+
+    float LinearToSRGB( float c )
+    {
+        return ( c <= 0.0031308f ) ? c * 12.92f : 1.055f * std::pow( c, 1.0f / 2.4f ) - 0.055f;
+    }
+
+    inline uint8_t ToUnorm8( float c )
+    {
+        return static_cast<uint8_t>( std::round( glm::clamp( c, 0.0f, 1.0f ) * 255.0f ) );
+    }
+
+    // The mip levels are built from 8-bit RGBA images.
+    struct MipLevel
+    {
+        uint32_t Width;
+        uint32_t Height;
+        std::vector<uint8_t> RGBA;
+    };
+
+    // Convert the pixels of a decoded image to RGBA. Returns false if the format is not supported.
+    bool ConvertToRGBA( const TextureImage& image, MipLevel& level )
+    {
+        level.Width = image.Width;
+        level.Height = image.Height;
+        level.RGBA.resize( static_cast<size_t>( image.Width ) * image.Height * 4 );
+
+        for ( uint32_t y = 0; y < image.Height; ++y )
+        {
+            const uint8_t* src = image.Pixels.data() + y * image.Pitch;
+            uint8_t* dst = level.RGBA.data() + static_cast<size_t>( y ) * image.Width * 4;
+
+            for ( uint32_t x = 0; x < image.Width; ++x, dst += 4 )
+            {
+                switch ( image.Format )
+                {
+                case DXGI_FORMAT_R8_UNORM:
+                    dst[0] = dst[1] = dst[2] = src[x];
+                    dst[3] = 255;
+                    break;
+                case DXGI_FORMAT_R8G8B8A8_UNORM:
+                    std::copy( src + x * 4, src + x * 4 + 4, dst );
+                    break;
+                case DXGI_FORMAT_B8G8R8A8_UNORM:
+                    dst[0] = src[x * 4 + 2];
+                    dst[1] = src[x * 4 + 1];
+                    dst[2] = src[x * 4 + 0];
+                    dst[3] = src[x * 4 + 3];
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Downsample a mip level with a box filter. The footprint of a pixel covers 2x2 pixels
+    // of the source level (or 3 pixels in a dimension for odd dimensions).
+    void Downsample( const MipLevel& src, MipLevel& dst, TextureUsage usage, const float* srgbToLinear )
+    {
+        dst.Width = std::max( 1u, src.Width / 2 );
+        dst.Height = std::max( 1u, src.Height / 2 );
+        dst.RGBA.resize( static_cast<size_t>( dst.Width ) * dst.Height * 4 );
+
+        ThreadPool::Get().ParallelFor( 0, dst.Height, RowsPerTask, [&]( uint32_t begin, uint32_t end )
+        {
+            for ( uint32_t y = begin; y < end; ++y )
+            {
+                uint32_t y0 = y * src.Height / dst.Height;
+                uint32_t y1 = std::max( y0 + 1, ( y + 1 ) * src.Height / dst.Height );
+
+                for ( uint32_t x = 0; x < dst.Width; ++x )
+                {
+                    uint32_t x0 = x * src.Width / dst.Width;
+                    uint32_t x1 = std::max( x0 + 1, ( x + 1 ) * src.Width / dst.Width );
+
+                    float sum[4] = {};
+                    for ( uint32_t sy = y0; sy < y1; ++sy )
+                    {
+                        const uint8_t* texel = src.RGBA.data() + ( static_cast<size_t>( sy ) * src.Width + x0 ) * 4;
+                        for ( uint32_t sx = x0; sx < x1; ++sx, texel += 4 )
+                        {
+                            switch ( usage )
+                            {
+                            case TextureUsage::Color:
+                                // Colors are stored with the sRGB curve and must be averaged in linear space.
+                                sum[0] += srgbToLinear[texel[0]];
+                                sum[1] += srgbToLinear[texel[1]];
+                                sum[2] += srgbToLinear[texel[2]];
+                                sum[3] += texel[3] / 255.0f;
+                                break;
+                            case TextureUsage::NormalMap:
+                            {
+                                glm::vec3 normal = glm::vec3( texel[0], texel[1], texel[2] ) / 127.5f - 1.0f;
+                                float length = glm::length( normal );
+                                if ( length > 0.0f )
+                                {
+                                    normal /= length;
+                                }
+                                sum[0] += normal.x;
+                                sum[1] += normal.y;
+                                sum[2] += normal.z;
+                            }
+                            break;
+                            default:
+                                for ( int c = 0; c < 4; ++c )
+                                {
+                                    sum[c] += texel[c] / 255.0f;
+                                }
+                                break;
+                            }
+                        }
+                    }
+
+                    float numTexels = static_cast<float>( ( x1 - x0 ) * ( y1 - y0 ) );
+                    uint8_t* texel = dst.RGBA.data() + ( static_cast<size_t>( y ) * dst.Width + x ) * 4;
+
+                    switch ( usage )
+                    {
+                    case TextureUsage::Color:
+                        texel[0] = ToUnorm8( LinearToSRGB( sum[0] / numTexels ) );
+                        texel[1] = ToUnorm8( LinearToSRGB( sum[1] / numTexels ) );
+                        texel[2] = ToUnorm8( LinearToSRGB( sum[2] / numTexels ) );
+                        texel[3] = ToUnorm8( sum[3] / numTexels );
+                        break;
+                    case TextureUsage::NormalMap:
+                    {
+                        // The average of the normals is renormalized.
+                        glm::vec3 normal( sum[0], sum[1], sum[2] );
+                        float length = glm::length( normal );
+                        normal = ( length > 0.0f ) ? normal / length : glm::vec3( 0, 0, 1 );
+
+                        texel[0] = ToUnorm8( normal.x * 0.5f + 0.5f );
+                        texel[1] = ToUnorm8( normal.y * 0.5f + 0.5f );
+                        texel[2] = ToUnorm8( normal.z * 0.5f + 0.5f );
+                        texel[3] = 255;
+                    }
+                    break;
+                    default:
+                        for ( int c = 0; c < 4; ++c )
+                        {
+                            texel[c] = ToUnorm8( sum[c] / numTexels );
+                        }
+                        break;
+                    }
+                }
+            }
+        } );
+    }
+
+    // Compress a mip level. The blocks at the edges of mip levels that are
+    // smaller than a block are filled by repeating the last row and column.
+    void CompressMipLevel( const MipLevel& level, DXGI_FORMAT format, uint8_t* blocks )
+    {
+        size_t blockSize = ( format == DXGI_FORMAT_BC1_UNORM || format == DXGI_FORMAT_BC4_UNORM ) ? BlockCompression::BlockSize8 : BlockCompression::BlockSize16;
+        uint32_t numBlocksWide = std::max( 1u, ( level.Width + 3 ) / 4 );
+        uint32_t numBlocksHigh = std::max( 1u, ( level.Height + 3 ) / 4 );
+
+        ThreadPool::Get().ParallelFor( 0, numBlocksHigh, RowsPerTask, [&]( uint32_t begin, uint32_t end )
+        {
+            uint8_t rgba[64];
+            for ( uint32_t by = begin; by < end; ++by )
+            {
+                for ( uint32_t bx = 0; bx < numBlocksWide; ++bx )
+                {
+                    for ( uint32_t i = 0; i < 16; ++i )
+                    {
+                        uint32_t x = std::min( bx * 4 + i % 4, level.Width - 1 );
+                        uint32_t y = std::min( by * 4 + i / 4, level.Height - 1 );
+                        const uint8_t* texel = level.RGBA.data() + ( static_cast<size_t>( y ) * level.Width + x ) * 4;
+                        std::copy( texel, texel + 4, rgba + i * 4 );
+                    }
+
+                    uint8_t* block = blocks + ( static_cast<size_t>( by ) * numBlocksWide + bx ) * blockSize;
+                    switch ( format )
+                    {
+                    case DXGI_FORMAT_BC1_UNORM:
+                        BlockCompression::EncodeBC1( rgba, block );
+                        break;
+                    case DXGI_FORMAT_BC3_UNORM:
+                        BlockCompression::EncodeBC3( rgba, block );
+                        break;
+                    case DXGI_FORMAT_BC4_UNORM:
+                        BlockCompression::EncodeBC4( rgba, block, 4 );
+                        break;
+                    case DXGI_FORMAT_BC5_UNORM:
+                        BlockCompression::EncodeBC5( rgba, block );
+                        break;
+                    case DXGI_FORMAT_BC7_UNORM:
+                        BlockCompression::EncodeBC7( rgba, block );
+                        break;
+                    default:
+                        assert( false && "Unsupported block compression format." );
+                        break;
+                    }
+                }
+            }
+        } );
+    }
+
+    bool IsCanceled( const std::atomic<bool>* cancel )
+    {
+        return cancel != nullptr && cancel->load();
+    }
+
+    // Resolve the usage of bump map slots.
+    TextureUsage GetTextureUsage( TextureUsage usage, uint8_t bpp )
+    {
+        if ( usage == TextureUsage::Bump )
+        {
+            // See SceneDX12::LoadTextures.
+            return ( bpp >= 24 ) ? TextureUsage::NormalMap : TextureUsage::Grayscale;
+        }
+
+        return usage;
+    }
+
+    // Select the block compression format for a texture.
+    DXGI_FORMAT GetCookedFormat( TextureUsage usage, TextureCompression compression, bool isTransparent )
+    {
+        switch ( usage )
+        {
+        case TextureUsage::NormalMap:
+            return DXGI_FORMAT_BC5_UNORM;
+        case TextureUsage::Grayscale:
+            return DXGI_FORMAT_BC4_UNORM;
+        default:
+            if ( compression == TextureCompression::HighQuality )
+            {
+                return DXGI_FORMAT_BC7_UNORM;
+            }
+            return isTransparent ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+        }
+    }
+}
+
+bool TextureCookerDX12::LoadTexture2D( const std::wstring& fileName, TextureUsage usage, TextureCompression compression, TextureImage& image, uint32_t maxDimension, const std::atomic<bool>* cancel )
+{
+    fs::path filePath;
+    if ( compression == TextureCompression::None || !TextureDX12::FindTextureFile( fileName, filePath ) || filePath.extension() == CookedFileExtension )
+    {
+        return TextureDX12::DecodeTexture2D( fileName, image );
+    }
+
+    fs::path cookedFilePath = filePath;
+    cookedFilePath += CookedFileExtension;
+
+    // The cooked texture must be recreated if the source image changed since the texture was cooked
+    // or if the texture was cooked with a different compression. The usage is checked with the
+    // format of the cooked texture (the usage of bump maps depends on the source image).
+    uint32_t buildParameters = static_cast<uint32_t>( compression );
+
+    DependencyTracker dependencyTracker( filePath.wstring() );
+    dependencyTracker.SetBuildParameters( Core::Hasher::Hash( &buildParameters, sizeof( buildParameters ) ) );
+    if ( !dependencyTracker.Load() )
+    {
+        dependencyTracker.Save();
+    }
+
+    if ( fs::exists( cookedFilePath ) && fs::is_regular_file( cookedFilePath ) )
+    {
+        dependencyTracker.SetLastLoadTime( fs::last_write_time( cookedFilePath ) );
+        if ( !dependencyTracker.IsStale() && LoadDDS( cookedFilePath, image, maxDimension ) &&
+             image.Format == GetCookedFormat( GetTextureUsage( usage, image.BPP ), compression, image.IsTransparent ) )
+        {
+            LOG_INFO( "Loading cooked texture ", cookedFilePath );
+            image.FileName = fileName;
+            return true;
+        }
+    }
+
+    TextureImage source;
+    if ( !TextureDX12::DecodeTexture2D( fileName, source ) )
+    {
+        return false;
+    }
+
+    if ( !CookTexture2D( source, usage, compression, image, cancel ) )
+    {
+        if ( IsCanceled( cancel ) )
+        {
+            return false;
+        }
+
+        // Textures that can't be cooked are loaded without compression.
+        image = std::move( source );
+        return true;
+    }
+
+    if ( !SaveDDS( cookedFilePath, image ) )
+    {
+        // The complete mip chain is returned because the
+        // other mip levels can't be loaded from the cooked file.
+        LOG_WARNING( "Could not save cooked texture: ", cookedFilePath );
+    }
+    else
+    {
+        dependencyTracker.SetUpToDate();
+
+        image.FilePath = cookedFilePath;
+        SkipMipLevels( image, GetMostDetailedMip( image.Width, image.Height, image.MipLevels, maxDimension ) );
+    }
+
+    return true;
+}
+
+bool TextureCookerDX12::CookTexture2D( const TextureImage& source, TextureUsage usage, TextureCompression compression, TextureImage& cooked, const std::atomic<bool>* cancel )
+{
+    // The dimensions of block compressed textures must be a multiple of the block size.
+    if ( source.Width % 4 != 0 || source.Height % 4 != 0 )
+    {
+        LOG_WARNING( "Texture dimensions are not a multiple of 4: ", source.FilePath );
+        return false;
+    }
+
+    std::vector<MipLevel> mipLevels( 1 );
+    if ( !ConvertToRGBA( source, mipLevels[0] ) )
+    {
+        LOG_WARNING( "Texture format can't be block compressed: ", source.FilePath );
+        return false;
+    }
+
+    usage = GetTextureUsage( usage, source.BPP );
+    DXGI_FORMAT format = GetCookedFormat( usage, compression, source.IsTransparent );
+
+    float srgbToLinear[256];
+    for ( int i = 0; i < 256; ++i )
+    {
+        srgbToLinear[i] = SRGBToLinear( i / 255.0f );
+    }
+
+    // Build the complete mip chain (down to 1x1).
+    while ( mipLevels.back().Width > 1 || mipLevels.back().Height > 1 )
+    {
+        if ( IsCanceled( cancel ) )
+        {
+            return false;
+        }
+
+        MipLevel mipLevel;
+        Downsample( mipLevels.back(), mipLevel, usage, srgbToLinear );
+        mipLevels.push_back( std::move( mipLevel ) );
+    }
+
+    uint32_t numMipLevels = static_cast<uint32_t>( mipLevels.size() );
+
+    size_t rowPitch;
+    GetSurfaceInfo( source.Width, source.Height, format, nullptr, &rowPitch, nullptr );
+
+    cooked.FileName = source.FileName;
+    cooked.FilePath = source.FilePath;
+    cooked.Format = format;
+    cooked.Width = source.Width;
+    cooked.Height = source.Height;
+    cooked.Pitch = rowPitch;
+    cooked.BPP = source.BPP;
+    cooked.IsTransparent = source.IsTransparent;
+    cooked.MipLevels = numMipLevels;
+    cooked.Pixels.resize( GetImageSize( cooked.Width, cooked.Height, numMipLevels, format ) );
+
+    uint8_t* blocks = cooked.Pixels.data();
+    for ( const MipLevel& mipLevel : mipLevels )
+    {
+        if ( IsCanceled( cancel ) )
+        {
+            return false;
+        }
+
+        CompressMipLevel( mipLevel, format, blocks );
+
+        size_t numBytes;
+        GetSurfaceInfo( mipLevel.Width, mipLevel.Height, format, &numBytes, nullptr, nullptr );
+        blocks += numBytes;
+    }
+
+    return true;
+}
+
+bool TextureCookerDX12::SaveDDS( const fs::path& filePath, const TextureImage& image )
+{
+    DDSHeader header = {};
+    header.Size = sizeof( DDSHeader );
+    header.Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    header.Height = image.Height;
+    header.Width = image.Width;
+    header.MipMapCount = image.MipLevels;
+    header.Reserved1[0] = CookedTextureTag;
+    header.Reserved1[1] = image.BPP;
+    header.Reserved1[2] = image.IsTransparent ? 1 : 0;
+    header.PixelFormat.Size = sizeof( DDSPixelFormat );
+    header.PixelFormat.Flags = DDPF_FOURCC;
+    header.PixelFormat.FourCC = DX10FourCC;
+    header.Caps = DDSCAPS_TEXTURE | ( image.MipLevels > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0 );
+
+    size_t linearSize;
+    GetSurfaceInfo( image.Width, image.Height, image.Format, &linearSize, nullptr, nullptr );
+    header.PitchOrLinearSize = static_cast<uint32_t>( linearSize );
+
+    DDSHeaderDX10 headerDX10 = {};
+    headerDX10.Format = image.Format;
+    headerDX10.ResourceDimension = DDS_DIMENSION_TEXTURE2D;
+    headerDX10.ArraySize = 1;
+
+    std::ofstream file( filePath, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    file.write( reinterpret_cast<const char*>( &DDSMagic ), sizeof( DDSMagic ) );
+    file.write( reinterpret_cast<const char*>( &header ), sizeof( DDSHeader ) );
+    file.write( reinterpret_cast<const char*>( &headerDX10 ), sizeof( DDSHeaderDX10 ) );
+    file.write( reinterpret_cast<const char*>( image.Pixels.data() ), static_cast<std::streamsize>( image.Pixels.size() ) );
+
+    return file.good();
+}
+
+bool TextureCookerDX12::LoadDDS( const fs::path& filePath, TextureImage& image, uint32_t maxDimension )
+{
+    std::ifstream file( filePath, std::ios::in | std::ios::binary );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    uint32_t magic = 0;
+    DDSHeader header = {};
+    DDSHeaderDX10 headerDX10 = {};
+    file.read( reinterpret_cast<char*>( &magic ), sizeof( magic ) );
+    file.read( reinterpret_cast<char*>( &header ), sizeof( DDSHeader ) );
+    file.read( reinterpret_cast<char*>( &headerDX10 ), sizeof( DDSHeaderDX10 ) );
+
+    if ( !file.good() || magic != DDSMagic || header.Size != sizeof( DDSHeader ) ||
+         header.PixelFormat.FourCC != DX10FourCC || header.Reserved1[0] != CookedTextureTag ||
+         headerDX10.ResourceDimension != DDS_DIMENSION_TEXTURE2D || headerDX10.ArraySize != 1 ||
+         header.Width == 0 || header.Height == 0 || header.MipMapCount == 0 || header.MipMapCount > D3D12_REQ_MIP_LEVELS )
+    {
+        LOG_WARNING( "Invalid cooked texture: ", filePath );
+        return false;
+    }
+
+    uint32_t mostDetailedMip = GetMostDetailedMip( header.Width, header.Height, header.MipMapCount, maxDimension );
+    uint32_t width = header.Width >> mostDetailedMip;
+    uint32_t height = header.Height >> mostDetailedMip;
+    uint32_t mipLevels = header.MipMapCount - mostDetailedMip;
+
+    size_t imageSize = GetImageSize( width, height, mipLevels, headerDX10.Format );
+    size_t rowPitch;
+    GetSurfaceInfo( width, height, headerDX10.Format, nullptr, &rowPitch, nullptr );
+
+    image.FilePath = filePath;
+    image.Format = headerDX10.Format;
+    image.Width = width;
+    image.Height = height;
+    image.Pitch = rowPitch;
+    image.BPP = static_cast<uint8_t>( header.Reserved1[1] );
+    image.IsTransparent = header.Reserved1[2] != 0;
+    image.MipLevels = mipLevels;
+    image.MostDetailedMip = mostDetailedMip;
+    image.Pixels.resize( imageSize );
+
+    // Skip the mip levels that are not loaded.
+    file.seekg( static_cast<std::streamoff>( GetImageSize( header.Width, header.Height, mostDetailedMip, headerDX10.Format ) ), std::ios::cur );
+    file.read( reinterpret_cast<char*>( image.Pixels.data() ), static_cast<std::streamsize>( imageSize ) );
+    if ( !file.good() )
+    {
+        LOG_WARNING( "Invalid cooked texture: ", filePath );
+        image = TextureImage();
+        return false;
+    }
+
+    return true;
+}
+
+uint32_t TextureCookerDX12::GetMostDetailedMip( uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t maxDimension )
+{
+    if ( maxDimension == 0 )
+    {
+        return 0;
+    }
+
+    uint32_t mip = 0;
+    while ( mip + 1 < mipLevels && std::max( width >> mip, height >> mip ) > maxDimension )
+    {
+        ++mip;
+    }
+
+    // The dimensions of the first mip level of a block compressed texture must be a multiple of the block size.
+    while ( mip > 0 && ( ( width >> mip ) % 4 != 0 || ( height >> mip ) % 4 != 0 || ( width >> mip ) << mip != width || ( height >> mip ) << mip != height ) )
+    {
+        --mip;
+    }
+
+    return mip;
+}
+
+size_t TextureCookerDX12::GetImageSize( uint32_t width, uint32_t height, uint32_t mipLevels, DXGI_FORMAT format )
+{
+    size_t imageSize = 0;
+    for ( uint32_t mip = 0; mip < mipLevels; ++mip )
+    {
+        size_t numBytes;
+        GetSurfaceInfo( std::max( 1u, width >> mip ), std::max( 1u, height >> mip ), format, &numBytes, nullptr, nullptr );
+        imageSize += numBytes;
+    }
+
+    return imageSize;
+}
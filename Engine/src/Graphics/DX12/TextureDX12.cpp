@@ -216,12 +216,12 @@ uint8_t ComputeMipLevels( uint64_t size )
     return static_cast<uint8_t>( MSB + 1 );
 }
 
-bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const std::wstring& fileName )
+bool TextureDX12::FindTextureFile( const std::wstring& fileName, fs::path& filePath )
 {
     const Application& app = Application::Get();
     const auto& searchPaths = app.GetAssetSerachPaths();
 
-    fs::path filePath( fileName );
+    filePath = fileName;
     
     auto searchPathIterator = searchPaths.cbegin();
     bool fileFound = fs::exists( filePath ) && fs::is_regular_file( filePath );
@@ -232,14 +232,21 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
         ++searchPathIterator;
     } 
 
-    if ( !fileFound )
+    return fileFound;
+}
+
+bool TextureDX12::DecodeTexture2D( const std::wstring& fileName, TextureImage& image )
+{
+    fs::path filePath;
+    if ( !FindTextureFile( fileName, filePath ) )
     {
         LOG_ERROR( "Could not find texture: ", fileName );
         return false;
     }
 
     LOG_INFO( "Loading texture ", filePath );
-    m_TextureFileName = fileName;
+    image.FileName = fileName;
+    image.FilePath = filePath;
 
     // Try to determine the file type from the image file.
     FREE_IMAGE_FORMAT fif = FreeImage_GetFileTypeU( filePath.c_str() );
@@ -261,14 +268,14 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
         return false;
     }
 
-    m_BPP = FreeImage_GetBPP( dib );
+    uint8_t bpp = static_cast<uint8_t>( FreeImage_GetBPP( dib ) );
     FREE_IMAGE_TYPE imageType = FreeImage_GetImageType( dib );
 
     // Check to see if the texture has an alpha channel.
-    m_IsTransparent = ( FreeImage_IsTransparent( dib ) == TRUE );
+    image.IsTransparent = ( FreeImage_IsTransparent( dib ) == TRUE );
 
     DXGI_FORMAT dxgiFormat = DXGI_FORMAT_UNKNOWN;
-    switch ( m_BPP )
+    switch ( bpp )
     {
     case 8:
     {
@@ -279,6 +286,7 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
             break;
         default:
             LOG_ERROR( "Unknown image format." );
+            FreeImage_Unload( dib );
             return false;
         }
     }
@@ -298,6 +306,7 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
         break;
         default:
             LOG_ERROR( "Unknown image format." );
+            FreeImage_Unload( dib );
             return false;
         }
     }
@@ -324,6 +333,7 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
             break;
         default:
             LOG_ERROR( "Unknown image format." );
+            FreeImage_Unload( dib );
             return false;
         }
     }
@@ -338,7 +348,7 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
         dib = dib32;
 
         // Update pixel bit depth (should be 32 now if it wasn't before).
-        m_BPP = FreeImage_GetBPP( dib );
+        bpp = static_cast<uint8_t>( FreeImage_GetBPP( dib ) );
 
 #if FREEIMAGE_COLORORDER == FREEIMAGE_COLORORDER_BGR
         dxgiFormat = DXGI_FORMAT_B8G8R8A8_UNORM;
@@ -349,26 +359,66 @@ bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandB
     break;
     }
 
+    image.Format = dxgiFormat;
+    image.BPP = bpp;
+    image.Width = FreeImage_GetWidth( dib );
+    image.Height = FreeImage_GetHeight( dib );
+    image.Pitch = FreeImage_GetPitch( dib );
+
+    const BYTE* bits = FreeImage_GetBits( dib );
+    image.Pixels.assign( bits, bits + image.Pitch * image.Height );
+
+    FreeImage_Unload( dib );
+
+    return true;
+}
+
+bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const std::wstring& fileName )
+{
+    TextureImage image;
+    if ( !DecodeTexture2D( fileName, image ) )
+    {
+        return false;
+    }
+
+    return LoadTexture2D( copyCommandBuffer, image );
+}
+
+bool TextureDX12::LoadTexture2D( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const TextureImage& image )
+{
+    m_TextureFileName = image.FileName;
+    m_IsTransparent = image.IsTransparent;
+
     m_TextureDimension = TextureDimension::Texture2D;
-    m_TextureFormat = ConvertTextureFormat( dxgiFormat );
+    m_TextureFormat = ConvertTextureFormat( image.Format );
 
     InitFormats( m_TextureFormat );
 
-    m_Width = FreeImage_GetWidth( dib );
-    m_Height = FreeImage_GetHeight( dib );
+    // The bits per pixel of the source image (block compressed formats use less than 8 bits per pixel).
+    m_BPP = image.BPP;
+
+    m_Width = image.Width;
+    m_Height = image.Height;
     m_DepthOrArraySize = 1;
-    m_Pitch = FreeImage_GetPitch( dib );
-    m_MipLevels = ComputeMipLevels( m_Width| m_Height );
+    m_Pitch = image.Pitch;
+    // Cooked images contain the complete mip chain, otherwise
+    // the mip chain is generated after the texture is loaded.
+    m_MipLevels = ( image.MipLevels > 1 ) ? static_cast<uint8_t>( image.MipLevels ) : ComputeMipLevels( m_Width| m_Height );
 
     // Resize the internal resource to match the texture dimensions.
     Resize( m_Width, m_Height, m_DepthOrArraySize, m_MipLevels );
 
-    BYTE* textureData = FreeImage_GetBits( dib );
-    copyCommandBuffer->SetTextureSubresource( shared_from_this(), 0, 0, textureData );
+    const uint8_t* pixels = image.Pixels.data();
+    for ( uint32_t mip = 0; mip < std::min<uint32_t>( image.MipLevels, m_MipLevels ); ++mip )
+    {
+        copyCommandBuffer->SetTextureSubresource( shared_from_this(), mip, 0, pixels );
 
-    FreeImage_Unload( dib );
+        size_t numBytes;
+        GetSurfaceInfo( std::max( 1u, m_Width >> mip ), std::max( 1u, m_Height >> mip ), image.Format, &numBytes, nullptr, nullptr );
+        pixels += numBytes;
+    }
 
-    SetName( filePath.filename() );
+    SetName( image.FilePath.filename() );
 
     return true;
 }
@@ -502,12 +552,16 @@ void TextureDX12::Resize( uint32_t width, uint32_t height, uint32_t depthOrArray
 
     m_d3d12ResourceState = D3D12_RESOURCE_STATE_COMMON;
 
+    // An optimized clear value can only be specified for render targets and depth-stencil
+    // textures (formats without render target support like block compressed formats).
+    bool hasClearValue = ( d3d12ResourceDesc.Flags & ( D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL ) ) != 0;
+
     if ( FAILED( m_d3d12Device->CreateCommittedResource(
         &CD3DX12_HEAP_PROPERTIES( D3D12_HEAP_TYPE_DEFAULT ),
         D3D12_HEAP_FLAG_NONE,
         &d3d12ResourceDesc,
         m_d3d12ResourceState,
-        &d3d12ClearValue,
+        hasClearValue ? &d3d12ClearValue : nullptr,
         IID_PPV_ARGS( &m_d3d12Resource ) ) ) )
     {
         LOG_ERROR( "Failed to allocated committed resource." );
@@ -0,0 +1,387 @@
+#include <EnginePCH.h>
+
+#include <Graphics/DX12/TextureStreamerDX12.h>
+#include <Graphics/DX12/TextureCookerDX12.h>
+#include <Graphics/DX12/TextureDX12.h>
+#include <Graphics/DX12/SceneDX12.h>
+#include <Graphics/Camera.h>
+#include <Graphics/Frustum.h>
+#include <Graphics/Material.h>
+#include <Graphics/Mesh.h>
+#include <Graphics/SceneNode.h>
+
+#include <LogManager.h>
+#include <SceneVisitor.h>
+#include <ThreadPool.h>
+
+using namespace Core;
+using namespace Graphics;
+
+namespace
+{
+    // The default memory budget (in bytes) for the mip levels of the streamed textures.
+    const size_t DefaultMemoryBudget = 1024ull * 1024ull * 1024ull;
+
+    // Invokes a function for each mesh of a scene with the world transform of the scene node of the mesh.
+    class MeshVisitor : public SceneVisitor
+    {
+    public:
+        using MeshFunction = std::function<void( Mesh& mesh, const glm::mat4& worldTransform )>;
+
+        MeshVisitor( const MeshFunction& meshFunction )
+            : m_MeshFunction( meshFunction )
+            , m_WorldTransform( 1.0f )
+        {}
+
+        virtual void Visit( Graphics::Scene& scene ) override
+        {}
+
+        virtual void Visit( SceneNode& node ) override
+        {
+            m_WorldTransform = node.GetWorldTransform();
+        }
+
+        virtual void Visit( Mesh& mesh ) override
+        {
+            m_MeshFunction( mesh, m_WorldTransform );
+        }
+
+    private:
+        MeshFunction m_MeshFunction;
+        glm::mat4 m_WorldTransform;
+    };
+}
+
+TextureStreamerDX12::TextureStreamerDX12()
+    : m_MemoryBudget( DefaultMemoryBudget )
+{}
+
+TextureStreamerDX12::~TextureStreamerDX12()
+{
+    // Don't leave loads running on the thread pool.
+    for ( auto& pendingLoad : m_PendingLoads )
+    {
+        pendingLoad.Future.wait();
+    }
+}
+
+void TextureStreamerDX12::SetMemoryBudget( size_t memoryBudget )
+{
+    scoped_lock lock( m_Mutex );
+    m_MemoryBudget = memoryBudget;
+}
+
+size_t TextureStreamerDX12::GetMemoryBudget() const
+{
+    scoped_lock lock( m_Mutex );
+    return m_MemoryBudget;
+}
+
+size_t TextureStreamerDX12::GetResidentSize() const
+{
+    scoped_lock lock( m_Mutex );
+
+    size_t residentSize = 0;
+    for ( const auto& texture : m_Textures )
+    {
+        residentSize += texture.MipChainSizes[texture.ResidentMip];
+    }
+
+    return residentSize;
+}
+
+size_t TextureStreamerDX12::GetNumTextures() const
+{
+    scoped_lock lock( m_Mutex );
+    return m_Textures.size();
+}
+
+void TextureStreamerDX12::AddTexture( std::shared_ptr<TextureDX12> texture, const TextureImage& image )
+{
+    // Images that were not cooked have a single mip level (the mip chain is generated on the GPU).
+    if ( !texture || image.Pixels.empty() || image.MipLevels + image.MostDetailedMip <= 1 )
+    {
+        return;
+    }
+
+    scoped_lock lock( m_Mutex );
+
+    if ( !m_TextureIndices.emplace( texture.get(), m_Textures.size() ).second )
+    {
+        return;
+    }
+
+    StreamedTexture streamedTexture;
+    streamedTexture.Texture = texture;
+    streamedTexture.FilePath = image.FilePath;
+    streamedTexture.Width = image.Width << image.MostDetailedMip;
+    streamedTexture.Height = image.Height << image.MostDetailedMip;
+    streamedTexture.MipLevels = image.MipLevels + image.MostDetailedMip;
+    streamedTexture.TailMip = std::max( image.MostDetailedMip, TextureCookerDX12::GetMostDetailedMip( streamedTexture.Width, streamedTexture.Height, streamedTexture.MipLevels, MinResidentSize ) );
+    streamedTexture.ResidentMip = image.MostDetailedMip;
+    streamedTexture.PendingMip = image.MostDetailedMip;
+    streamedTexture.DesiredMip = streamedTexture.TailMip;
+    streamedTexture.ScreenSize = 0.0f;
+    streamedTexture.Failed = false;
+
+    // The last entry is the size of an empty mip chain.
+    streamedTexture.MipChainSizes.resize( streamedTexture.MipLevels + 1 );
+    for ( uint32_t mip = 0; mip <= streamedTexture.MipLevels; ++mip )
+    {
+        streamedTexture.MipChainSizes[mip] = TextureCookerDX12::GetImageSize( streamedTexture.Width >> mip, streamedTexture.Height >> mip, streamedTexture.MipLevels - mip, image.Format );
+    }
+
+    m_Textures.push_back( std::move( streamedTexture ) );
+}
+
+void TextureStreamerDX12::AddScene( std::shared_ptr<SceneDX12> scene )
+{
+    if ( !scene )
+    {
+        return;
+    }
+
+    scoped_lock lock( m_Mutex );
+
+    m_Scenes.push_back( scene );
+}
+
+void TextureStreamerDX12::Update( std::shared_ptr<CopyCommandBuffer> copyCommandBuffer, const Camera& camera )
+{
+    scoped_lock lock( m_Mutex );
+
+    // Replace the textures with the mip levels that finished loading.
+    for ( auto iter = m_PendingLoads.begin(); iter != m_PendingLoads.end(); )
+    {
+        if ( iter->Future.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+        {
+            ++iter;
+            continue;
+        }
+
+        StreamedTexture& texture = m_Textures[iter->TextureIndex];
+        TextureImage& image = *iter->Image;
+
+        if ( !image.Pixels.empty() && image.MostDetailedMip == texture.PendingMip && image.MipLevels + image.MostDetailedMip == texture.MipLevels )
+        {
+            // The texture keeps the file name that is used by the texture cache.
+            image.FileName = texture.Texture->GetFileName();
+            texture.Texture->LoadTexture2D( copyCommandBuffer, image );
+            texture.ResidentMip = texture.PendingMip;
+        }
+        else
+        {
+            LOG_WARNING( "Could not stream texture: ", texture.FilePath );
+            texture.PendingMip = texture.ResidentMip;
+            texture.Failed = true;
+        }
+
+        iter = m_PendingLoads.erase( iter );
+    }
+
+    UpdateDesiredMips( camera );
+
+    // Distribute the memory budget over the textures. The mip levels are added in the order
+    // of the number of screen pixels per texel until the budget is used.
+    using MipStep = std::pair<float, size_t>;
+    std::priority_queue<MipStep> mipSteps;
+    std::vector<uint32_t> targetMips( m_Textures.size() );
+    size_t budgetSize = 0;
+
+    for ( size_t i = 0; i < m_Textures.size(); ++i )
+    {
+        const StreamedTexture& texture = m_Textures[i];
+
+        targetMips[i] = texture.Failed ? texture.ResidentMip : texture.TailMip;
+        budgetSize += texture.MipChainSizes[targetMips[i]];
+
+        if ( !texture.Failed && texture.DesiredMip < targetMips[i] )
+        {
+            mipSteps.emplace( GetPriority( texture, targetMips[i] - 1 ), i );
+        }
+    }
+
+    while ( !mipSteps.empty() )
+    {
+        size_t i = mipSteps.top().second;
+        mipSteps.pop();
+
+        const StreamedTexture& texture = m_Textures[i];
+        uint32_t mip = targetMips[i] - 1;
+        size_t mipSize = texture.MipChainSizes[mip] - texture.MipChainSizes[targetMips[i]];
+
+        // The more detailed mip levels of this texture don't fit either.
+        if ( budgetSize + mipSize > m_MemoryBudget )
+        {
+            continue;
+        }
+
+        budgetSize += mipSize;
+        targetMips[i] = mip;
+
+        if ( texture.DesiredMip < mip )
+        {
+            mipSteps.emplace( GetPriority( texture, mip - 1 ), i );
+        }
+    }
+
+    // The size of the resident mip levels and the mip levels that are being loaded.
+    size_t requiredSize = 0;
+    std::vector<size_t> loads;
+    std::vector<size_t> evictions;
+
+    for ( size_t i = 0; i < m_Textures.size(); ++i )
+    {
+        const StreamedTexture& texture = m_Textures[i];
+
+        requiredSize += texture.MipChainSizes[std::min( texture.ResidentMip, texture.PendingMip )];
+
+        if ( texture.PendingMip != texture.ResidentMip )
+        {
+            continue;
+        }
+
+        if ( targetMips[i] < texture.ResidentMip )
+        {
+            loads.push_back( i );
+        }
+        else if ( targetMips[i] > texture.ResidentMip )
+        {
+            evictions.push_back( i );
+        }
+    }
+
+    // Load the textures with the highest priority first.
+    std::sort( loads.begin(), loads.end(), [&]( size_t a, size_t b )
+    {
+        return GetPriority( m_Textures[a], targetMips[a] ) > GetPriority( m_Textures[b], targetMips[b] );
+    } );
+
+    for ( size_t i : loads )
+    {
+        if ( m_PendingLoads.size() >= MaxPendingLoads )
+        {
+            break;
+        }
+
+        const StreamedTexture& texture = m_Textures[i];
+        requiredSize += texture.MipChainSizes[targetMips[i]] - texture.MipChainSizes[texture.ResidentMip];
+
+        LoadMips( i, targetMips[i] );
+    }
+
+    // Mip levels are only evicted if the memory is needed. The least useful textures are evicted first.
+    std::sort( evictions.begin(), evictions.end(), [&]( size_t a, size_t b )
+    {
+        return GetPriority( m_Textures[a], m_Textures[a].ResidentMip ) < GetPriority( m_Textures[b], m_Textures[b].ResidentMip );
+    } );
+
+    for ( size_t i : evictions )
+    {
+        if ( requiredSize <= m_MemoryBudget )
+        {
+            break;
+        }
+
+        const StreamedTexture& texture = m_Textures[i];
+        requiredSize -= texture.MipChainSizes[texture.ResidentMip] - texture.MipChainSizes[targetMips[i]];
+
+        LoadMips( i, targetMips[i] );
+    }
+}
+
+void TextureStreamerDX12::UpdateDesiredMips( const Camera& camera )
+{
+    for ( auto& texture : m_Textures )
+    {
+        texture.DesiredMip = texture.TailMip;
+        texture.ScreenSize = 0.0f;
+    }
+
+    glm::mat4 projectionMatrix = camera.GetProjectionMatrix();
+    Frustum frustum( projectionMatrix * camera.GetViewMatrix() );
+    glm::vec3 cameraPosition( camera.GetInverseViewMatrix()[3] );
+
+    // The size in pixels of an object with a size of 1 at a distance of 1 from the camera.
+    float pixelsPerUnit = projectionMatrix[1][1] * camera.GetViewport().Height * 0.5f;
+
+    MeshVisitor visitor( [&]( Mesh& mesh, const glm::mat4& worldTransform )
+    {
+        // The bounding sphere of the mesh is in object space.
+        const glm::vec4& boundingSphere = mesh.GetBoundingSphere();
+        std::shared_ptr<Material> material = mesh.GetMaterial();
+        if ( !mesh.GetBounds().IsValid() || !material )
+        {
+            return;
+        }
+
+        glm::vec3 center( worldTransform * glm::vec4( glm::vec3( boundingSphere ), 1.0f ) );
+        float scale = std::sqrt( std::max( { glm::length2( glm::vec3( worldTransform[0] ) ), glm::length2( glm::vec3( worldTransform[1] ) ), glm::length2( glm::vec3( worldTransform[2] ) ) } ) );
+        float radius = boundingSphere.w * scale;
+
+        if ( !frustum.Intersects( center, radius ) )
+        {
+            return;
+        }
+
+        // The projected diameter of the bounding sphere. If the camera is inside the
+        // bounding sphere, the most detailed mip level is needed.
+        float distance2 = glm::distance2( center, cameraPosition ) - radius * radius;
+        float screenSize = ( distance2 > 0.0f ) ? 2.0f * radius * pixelsPerUnit / std::sqrt( distance2 ) : std::numeric_limits<float>::max();
+
+        for ( uint32_t i = 0; i < static_cast<uint32_t>( Material::TextureType::NumTypes ); ++i )
+        {
+            std::shared_ptr<Texture> texture = material->GetTexture( static_cast<Material::TextureType>( i ) );
+            auto textureIter = m_TextureIndices.find( texture.get() );
+            if ( textureIter != m_TextureIndices.end() )
+            {
+                StreamedTexture& streamedTexture = m_Textures[textureIter->second];
+                streamedTexture.ScreenSize = std::max( streamedTexture.ScreenSize, screenSize );
+            }
+        }
+    } );
+
+    for ( auto& scene : m_Scenes )
+    {
+        scene->Accept( visitor );
+    }
+
+    // The texture is assumed to be mapped once over the mesh, so the mip level
+    // with about one texel per pixel is needed.
+    for ( auto& texture : m_Textures )
+    {
+        float textureSize = static_cast<float>( std::max( texture.Width, texture.Height ) );
+        if ( texture.ScreenSize > 0.0f )
+        {
+            uint32_t mip = ( texture.ScreenSize < textureSize ) ? static_cast<uint32_t>( std::log2( textureSize / texture.ScreenSize ) ) : 0;
+            texture.DesiredMip = std::min( mip, texture.TailMip );
+        }
+    }
+}
+
+void TextureStreamerDX12::LoadMips( size_t textureIndex, uint32_t mip )
+{
+    StreamedTexture& texture = m_Textures[textureIndex];
+    texture.PendingMip = mip;
+
+    fs::path filePath = texture.FilePath;
+    uint32_t maxDimension = std::max( texture.Width >> mip, texture.Height >> mip );
+
+    PendingLoad pendingLoad;
+    pendingLoad.TextureIndex = textureIndex;
+    pendingLoad.Image = std::make_shared<TextureImage>();
+
+    std::shared_ptr<TextureImage> image = pendingLoad.Image;
+    pendingLoad.Future = ThreadPool::Get().Enqueue( [filePath, maxDimension, image]()
+    {
+        TextureCookerDX12::LoadDDS( filePath, *image, maxDimension );
+    } );
+
+    m_PendingLoads.push_back( std::move( pendingLoad ) );
+}
+
+float TextureStreamerDX12::GetPriority( const StreamedTexture& texture, uint32_t mip ) const
+{
+    uint32_t mipSize = std::max( 1u, std::max( texture.Width, texture.Height ) >> mip );
+    return texture.ScreenSize / static_cast<float>( mipSize );
+}
@@ -0,0 +1,439 @@
+#include <EnginePCH.h>
+
+#include <Graphics/IndexOptimizer.h>
+
+using namespace Graphics;
+
+namespace
+{
+    const uint32_t InvalidTriangle = 0xffffffff;
+
+    // The parameters of the vertex score function (Tom Forsyth).
+    // The scores are computed for an LRU cache of 32 vertices.
+    const int32_t ForsythCacheSize = 32;
+    const float CacheDecayPower = 1.5f;
+    const float LastTriangleScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+
+    float VertexScore( int32_t cachePosition, uint32_t numActiveTriangles )
+    {
+        if ( numActiveTriangles == 0 )
+        {
+            // The vertex is not used by any of the remaining triangles.
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if ( cachePosition >= 0 )
+        {
+            if ( cachePosition < 3 )
+            {
+                // The vertex was used by the last triangle. A fixed score is used so that
+                // the order of the vertices of the last triangle doesn't matter.
+                score = LastTriangleScore;
+            }
+            else
+            {
+                const float scale = 1.0f / ( ForsythCacheSize - 3 );
+                score = std::pow( 1.0f - ( cachePosition - 3 ) * scale, CacheDecayPower );
+            }
+        }
+
+        // Boost vertices with only a few remaining triangles so that
+        // isolated triangles are not left behind.
+        score += ValenceBoostScale * std::pow( static_cast<float>( numActiveTriangles ), -ValenceBoostPower );
+
+        return score;
+    }
+
+    /**
+     * FIFO vertex cache simulation.
+     * A vertex is in the cache if less than cacheSize vertices were added
+     * to the cache since the vertex was added.
+     */
+    class VertexCache
+    {
+    public:
+        VertexCache( size_t numVertices, uint32_t cacheSize )
+            : m_Timestamps( numVertices, 0 )
+            , m_Time( cacheSize + 1 )
+            , m_CacheSize( cacheSize )
+        {}
+
+        // Returns true if the vertex was not in the cache.
+        bool Add( uint32_t vertex )
+        {
+            if ( m_Time - m_Timestamps[vertex] > m_CacheSize )
+            {
+                m_Timestamps[vertex] = m_Time++;
+                return true;
+            }
+            return false;
+        }
+
+        void Flush()
+        {
+            m_Time += m_CacheSize + 1;
+        }
+
+    private:
+        std::vector<uint32_t> m_Timestamps;
+        uint32_t m_Time;
+        uint32_t m_CacheSize;
+    };
+
+    uint32_t AddTriangle( VertexCache& cache, const uint32_t* triangle )
+    {
+        uint32_t misses = 0;
+        for ( uint32_t i = 0; i < 3; ++i )
+        {
+            misses += cache.Add( triangle[i] ) ? 1 : 0;
+        }
+        return misses;
+    }
+}
+
+float VertexCacheStatistics::GetACMR() const
+{
+    return NumTriangles > 0 ? static_cast<float>( VerticesTransformed ) / NumTriangles : 0.0f;
+}
+
+float VertexCacheStatistics::GetATVR() const
+{
+    return NumVertices > 0 ? static_cast<float>( VerticesTransformed ) / NumVertices : 0.0f;
+}
+
+VertexCacheStatistics& VertexCacheStatistics::operator+=( const VertexCacheStatistics& other )
+{
+    VerticesTransformed += other.VerticesTransformed;
+    NumTriangles += other.NumTriangles;
+    NumVertices += other.NumVertices;
+
+    return *this;
+}
+
+void IndexOptimizer::OptimizeVertexCache( uint32_t* indices, size_t numIndices, size_t numVertices )
+{
+    const size_t numTriangles = numIndices / 3;
+    if ( numTriangles == 0 )
+    {
+        return;
+    }
+
+    // The (remaining) triangles of every vertex.
+    // The active triangles of vertex v are stored in
+    // vertexTriangles[firstTriangle[v], firstTriangle[v] + numActiveTriangles[v]).
+    std::vector<uint32_t> numActiveTriangles( numVertices, 0 );
+    for ( size_t i = 0; i < numTriangles * 3; ++i )
+    {
+        assert( indices[i] < numVertices );
+        ++numActiveTriangles[indices[i]];
+    }
+
+    std::vector<uint32_t> firstTriangle( numVertices, 0 );
+    for ( size_t v = 1; v < numVertices; ++v )
+    {
+        firstTriangle[v] = firstTriangle[v - 1] + numActiveTriangles[v - 1];
+    }
+
+    std::vector<uint32_t> vertexTriangles( numTriangles * 3 );
+    {
+        std::vector<uint32_t> offsets( firstTriangle );
+        for ( size_t i = 0; i < numTriangles * 3; ++i )
+        {
+            vertexTriangles[offsets[indices[i]]++] = static_cast<uint32_t>( i / 3 );
+        }
+    }
+
+    std::vector<int32_t> cachePosition( numVertices, -1 );
+    std::vector<float> vertexScore( numVertices );
+    for ( size_t v = 0; v < numVertices; ++v )
+    {
+        vertexScore[v] = VertexScore( -1, numActiveTriangles[v] );
+    }
+
+    std::vector<float> triangleScore( numTriangles );
+    std::vector<bool> emitted( numTriangles, false );
+
+    uint32_t bestTriangle = InvalidTriangle;
+    float bestScore = -1.0f;
+    for ( size_t t = 0; t < numTriangles; ++t )
+    {
+        const uint32_t* triangle = indices + t * 3;
+        triangleScore[t] = vertexScore[triangle[0]] + vertexScore[triangle[1]] + vertexScore[triangle[2]];
+        if ( triangleScore[t] > bestScore )
+        {
+            bestScore = triangleScore[t];
+            bestTriangle = static_cast<uint32_t>( t );
+        }
+    }
+
+    std::vector<uint32_t> output;
+    output.reserve( numTriangles * 3 );
+
+    // The cache can temporarily contain 3 more vertices than the cache size.
+    uint32_t cache[ForsythCacheSize + 3];
+    uint32_t cacheCount = 0;
+
+    size_t nextTriangle = 0;
+
+    for ( size_t n = 0; n < numTriangles; ++n )
+    {
+        if ( bestTriangle == InvalidTriangle )
+        {
+            // None of the triangles of the vertices in the cache are left.
+            // Continue with the next triangle in the original order.
+            while ( emitted[nextTriangle] )
+            {
+                ++nextTriangle;
+            }
+            bestTriangle = static_cast<uint32_t>( nextTriangle );
+        }
+
+        const uint32_t* triangle = indices + bestTriangle * 3;
+        output.insert( output.end(), triangle, triangle + 3 );
+        emitted[bestTriangle] = true;
+
+        uint32_t newCache[ForsythCacheSize + 3];
+        uint32_t newCacheCount = 0;
+
+        for ( uint32_t i = 0; i < 3; ++i )
+        {
+            uint32_t v = triangle[i];
+
+            // Remove the triangle from the active triangles of the vertex.
+            uint32_t* triangles = vertexTriangles.data() + firstTriangle[v];
+            uint32_t last = --numActiveTriangles[v];
+            for ( uint32_t j = 0; j <= last; ++j )
+            {
+                if ( triangles[j] == bestTriangle )
+                {
+                    std::swap( triangles[j], triangles[last] );
+                    break;
+                }
+            }
+
+            // Move the vertices of the triangle to the front of the cache.
+            if ( std::find( newCache, newCache + newCacheCount, v ) == newCache + newCacheCount )
+            {
+                newCache[newCacheCount++] = v;
+            }
+        }
+
+        for ( uint32_t i = 0; i < cacheCount; ++i )
+        {
+            uint32_t v = cache[i];
+            if ( v != triangle[0] && v != triangle[1] && v != triangle[2] )
+            {
+                newCache[newCacheCount++] = v;
+            }
+        }
+
+        // Update the scores of the vertices in the cache (including the vertices
+        // that were just pushed out of the cache).
+        for ( uint32_t i = 0; i < newCacheCount; ++i )
+        {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < ForsythCacheSize ? static_cast<int32_t>( i ) : -1;
+            vertexScore[v] = VertexScore( cachePosition[v], numActiveTriangles[v] );
+        }
+
+        // Update the scores of the triangles of these vertices and
+        // choose the next triangle from the triangles of the cached vertices.
+        bestTriangle = InvalidTriangle;
+        bestScore = -1.0f;
+        for ( uint32_t i = 0; i < newCacheCount; ++i )
+        {
+            uint32_t v = newCache[i];
+            const uint32_t* triangles = vertexTriangles.data() + firstTriangle[v];
+            for ( uint32_t j = 0; j < numActiveTriangles[v]; ++j )
+            {
+                uint32_t t = triangles[j];
+                const uint32_t* tri = indices + t * 3;
+                triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+
+                if ( i < ForsythCacheSize && triangleScore[t] > bestScore )
+                {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheCount = std::min<uint32_t>( newCacheCount, ForsythCacheSize );
+        std::copy( newCache, newCache + cacheCount, cache );
+    }
+
+    std::copy( output.begin(), output.end(), indices );
+}
+
+void IndexOptimizer::OptimizeOverdraw( uint32_t* indices, size_t numIndices, const Mesh::Vertex* vertices, size_t numVertices, float threshold )
+{
+    const size_t numTriangles = numIndices / 3;
+    if ( numTriangles == 0 )
+    {
+        return;
+    }
+
+    // Split the index buffer at the triangles that miss all of their vertices in the cache.
+    // Reordering these clusters doesn't change the ACMR much.
+    std::vector<uint32_t> hardBoundaries;
+    {
+        VertexCache cache( numVertices, DefaultCacheSize );
+        for ( size_t t = 0; t < numTriangles; ++t )
+        {
+            uint32_t misses = AddTriangle( cache, indices + t * 3 );
+            if ( t == 0 || misses == 3 )
+            {
+                hardBoundaries.push_back( static_cast<uint32_t>( t ) );
+            }
+        }
+    }
+    hardBoundaries.push_back( static_cast<uint32_t>( numTriangles ) );
+
+    // Split the clusters further as long as the ACMR of the smaller
+    // clusters doesn't exceed the ACMR of the original cluster by more than the threshold.
+    std::vector<uint32_t> clusters;
+    {
+        VertexCache cache( numVertices, DefaultCacheSize );
+        for ( size_t c = 0; c + 1 < hardBoundaries.size(); ++c )
+        {
+            uint32_t begin = hardBoundaries[c];
+            uint32_t end = hardBoundaries[c + 1];
+
+            cache.Flush();
+            uint32_t clusterMisses = 0;
+            for ( uint32_t t = begin; t < end; ++t )
+            {
+                clusterMisses += AddTriangle( cache, indices + t * 3 );
+            }
+            float maxACMR = threshold * clusterMisses / ( end - begin );
+
+            cache.Flush();
+            clusters.push_back( begin );
+            uint32_t clusterBegin = begin;
+            uint32_t misses = 0;
+            for ( uint32_t t = begin; t < end; ++t )
+            {
+                misses += AddTriangle( cache, indices + t * 3 );
+
+                if ( t + 1 < end && static_cast<float>( misses ) / ( t + 1 - clusterBegin ) <= maxACMR )
+                {
+                    cache.Flush();
+                    clusters.push_back( t + 1 );
+                    clusterBegin = t + 1;
+                    misses = 0;
+                }
+            }
+        }
+    }
+    clusters.push_back( static_cast<uint32_t>( numTriangles ) );
+
+    const size_t numClusters = clusters.size() - 1;
+
+    // The area weighted centroid and normal of every cluster.
+    std::vector<glm::vec3> clusterCentroid( numClusters, glm::vec3( 0 ) );
+    std::vector<glm::vec3> clusterNormal( numClusters, glm::vec3( 0 ) );
+    glm::vec3 meshCentroid( 0 );
+    float meshArea = 0.0f;
+
+    for ( size_t c = 0; c < numClusters; ++c )
+    {
+        float clusterArea = 0.0f;
+        for ( uint32_t t = clusters[c]; t < clusters[c + 1]; ++t )
+        {
+            const glm::vec3& p0 = vertices[indices[t * 3 + 0]].Position;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].Position;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].Position;
+
+            // The length of the cross product is twice the area of the triangle.
+            glm::vec3 normal = glm::cross( p1 - p0, p2 - p0 );
+            float area = glm::length( normal );
+
+            clusterCentroid[c] += ( p0 + p1 + p2 ) * ( area / 3.0f );
+            clusterNormal[c] += normal;
+            clusterArea += area;
+        }
+
+        meshCentroid += clusterCentroid[c];
+        meshArea += clusterArea;
+
+        if ( clusterArea > 0.0f )
+        {
+            clusterCentroid[c] /= clusterArea;
+        }
+    }
+
+    if ( meshArea > 0.0f )
+    {
+        meshCentroid /= meshArea;
+    }
+
+    // Clusters that face away from the center of the mesh are more likely to occlude
+    // the other clusters of the mesh so they are rendered first.
+    std::vector<float> sortKey( numClusters );
+    for ( size_t c = 0; c < numClusters; ++c )
+    {
+        float length = glm::length( clusterNormal[c] );
+        sortKey[c] = length > 0.0f ? glm::dot( clusterCentroid[c] - meshCentroid, clusterNormal[c] / length ) : 0.0f;
+    }
+
+    std::vector<uint32_t> order( numClusters );
+    for ( size_t c = 0; c < numClusters; ++c )
+    {
+        order[c] = static_cast<uint32_t>( c );
+    }
+    std::stable_sort( order.begin(), order.end(), [&]( uint32_t a, uint32_t b )
+    {
+        return sortKey[a] > sortKey[b];
+    } );
+
+    std::vector<uint32_t> output;
+    output.reserve( numTriangles * 3 );
+    for ( uint32_t c : order )
+    {
+        output.insert( output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3 );
+    }
+
+    std::copy( output.begin(), output.end(), indices );
+}
+
+VertexCacheStatistics IndexOptimizer::AnalyzeVertexCache( const uint32_t* indices, size_t numIndices, size_t numVertices, uint32_t cacheSize )
+{
+    VertexCacheStatistics statistics;
+    statistics.NumTriangles = numIndices / 3;
+
+    VertexCache cache( numVertices, cacheSize );
+    std::vector<bool> referenced( numVertices, false );
+
+    for ( size_t i = 0; i < statistics.NumTriangles * 3; ++i )
+    {
+        uint32_t v = indices[i];
+        if ( cache.Add( v ) )
+        {
+            ++statistics.VerticesTransformed;
+        }
+        if ( !referenced[v] )
+        {
+            referenced[v] = true;
+            ++statistics.NumVertices;
+        }
+    }
+
+    return statistics;
+}
+
+bool IndexOptimizer::CanUse16BitIndices( size_t numVertices )
+{
+    return numVertices <= std::numeric_limits<uint16_t>::max() + size_t( 1 );
+}
+
+void IndexOptimizer::ConvertTo16BitIndices( const uint32_t* indices, size_t numIndices, uint16_t* shortIndices )
+{
+    for ( size_t i = 0; i < numIndices; ++i )
+    {
+        assert( indices[i] <= std::numeric_limits<uint16_t>::max() );
+        shortIndices[i] = static_cast<uint16_t>( indices[i] );
+    }
+}
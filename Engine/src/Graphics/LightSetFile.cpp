@@ -0,0 +1,140 @@
+#include <EnginePCH.h>
+
+#include <Graphics/LightSetFile.h>
+
+#include <Graphics/PointLight.h>
+#include <Graphics/SpotLight.h>
+#include <Graphics/DirectionalLight.h>
+
+#include <LogManager.h>
+
+using namespace Core;
+using namespace Graphics;
+
+namespace
+{
+    const char LIGHT_SET_MAGIC[4] = { 'L', 'S', 'E', 'T' };
+}
+
+LightSetFile::LightSetFile()
+{}
+
+LightSetFile::~LightSetFile()
+{
+    Close();
+}
+
+bool LightSetFile::Open( const std::wstring& fileName )
+{
+    if ( !m_File.Open( fileName, sizeof( Header ) ) )
+    {
+        LOG_ERROR( "Could not open light set file: ", fileName );
+        return false;
+    }
+
+    if ( !Validate() )
+    {
+        LOG_ERROR( "Invalid light set file (or light set file version mismatch): ", fileName );
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void LightSetFile::Close()
+{
+    m_File.Close();
+}
+
+bool LightSetFile::IsOpen() const
+{
+    return m_File.IsOpen();
+}
+
+const LightSetFile::Header& LightSetFile::GetHeader() const
+{
+    return *reinterpret_cast<const Header*>( m_File.GetData() );
+}
+
+bool LightSetFile::Validate() const
+{
+    const Header& header = GetHeader();
+
+    return memcmp( header.Magic, LIGHT_SET_MAGIC, sizeof( LIGHT_SET_MAGIC ) ) == 0 &&
+           header.Version == FileVersion &&
+           header.PointLightSize == sizeof( PointLight ) &&
+           header.SpotLightSize == sizeof( SpotLight ) &&
+           header.DirectionalLightSize == sizeof( DirectionalLight ) &&
+           m_File.ValidateArray( header.PointLightsOffset, header.NumPointLights, header.PointLightSize ) &&
+           m_File.ValidateArray( header.SpotLightsOffset, header.NumSpotLights, header.SpotLightSize ) &&
+           m_File.ValidateArray( header.DirectionalLightsOffset, header.NumDirectionalLights, header.DirectionalLightSize );
+}
+
+const PointLight* LightSetFile::GetPointLights() const
+{
+    return IsOpen() ? reinterpret_cast<const PointLight*>( m_File.GetData() + GetHeader().PointLightsOffset ) : nullptr;
+}
+
+uint32_t LightSetFile::GetNumPointLights() const
+{
+    return IsOpen() ? GetHeader().NumPointLights : 0;
+}
+
+const SpotLight* LightSetFile::GetSpotLights() const
+{
+    return IsOpen() ? reinterpret_cast<const SpotLight*>( m_File.GetData() + GetHeader().SpotLightsOffset ) : nullptr;
+}
+
+uint32_t LightSetFile::GetNumSpotLights() const
+{
+    return IsOpen() ? GetHeader().NumSpotLights : 0;
+}
+
+const DirectionalLight* LightSetFile::GetDirectionalLights() const
+{
+    return IsOpen() ? reinterpret_cast<const DirectionalLight*>( m_File.GetData() + GetHeader().DirectionalLightsOffset ) : nullptr;
+}
+
+uint32_t LightSetFile::GetNumDirectionalLights() const
+{
+    return IsOpen() ? GetHeader().NumDirectionalLights : 0;
+}
+
+bool LightSetFile::Save( const std::wstring& fileName, const PointLight* pointLights, uint32_t numPointLights,
+                         const SpotLight* spotLights, uint32_t numSpotLights,
+                         const DirectionalLight* directionalLights, uint32_t numDirectionalLights )
+{
+    Header header = {};
+    memcpy( header.Magic, LIGHT_SET_MAGIC, sizeof( LIGHT_SET_MAGIC ) );
+    header.Version = FileVersion;
+    header.PointLightSize = sizeof( PointLight );
+    header.SpotLightSize = sizeof( SpotLight );
+    header.DirectionalLightSize = sizeof( DirectionalLight );
+    header.NumPointLights = numPointLights;
+    header.NumSpotLights = numSpotLights;
+    header.NumDirectionalLights = numDirectionalLights;
+    header.PointLightsOffset = MemoryMappedFile::AlignUp( sizeof( Header ) );
+    header.SpotLightsOffset = MemoryMappedFile::AlignUp( header.PointLightsOffset + static_cast<uint64_t>( numPointLights ) * sizeof( PointLight ) );
+    header.DirectionalLightsOffset = MemoryMappedFile::AlignUp( header.SpotLightsOffset + static_cast<uint64_t>( numSpotLights ) * sizeof( SpotLight ) );
+
+    std::ofstream file( fileName, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !file.is_open() )
+    {
+        LOG_ERROR( "Could not write light set file: ", fileName );
+        return false;
+    }
+
+    file.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+
+    MemoryMappedFile::WritePadding( file, header.PointLightsOffset );
+    file.write( reinterpret_cast<const char*>( pointLights ), static_cast<std::streamsize>( numPointLights ) * sizeof( PointLight ) );
+
+    MemoryMappedFile::WritePadding( file, header.SpotLightsOffset );
+    file.write( reinterpret_cast<const char*>( spotLights ), static_cast<std::streamsize>( numSpotLights ) * sizeof( SpotLight ) );
+
+    MemoryMappedFile::WritePadding( file, header.DirectionalLightsOffset );
+    file.write( reinterpret_cast<const char*>( directionalLights ), static_cast<std::streamsize>( numDirectionalLights ) * sizeof( DirectionalLight ) );
+
+    return file.good();
+}
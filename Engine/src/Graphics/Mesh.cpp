@@ -5,6 +5,7 @@
 #include <Events.h>
 #include <SceneVisitor.h>
 
+#include <Graphics/DX12/DeviceDX12.h>
 #include <Graphics/GraphicsCommandBuffer.h>
 #include <Graphics/GraphicsPipelineState.h>
 
@@ -12,6 +13,9 @@ using namespace Graphics;
 
 Mesh::Mesh( std::shared_ptr<Device> device )
     : m_Device( device )
+    , m_VertexFormat( VertexFormat::Standard )
+    , m_PositionTransform( 1.0f )
+    , m_BoundingSphere( 0.0f )
 {}
 
 Mesh::~Mesh()
@@ -37,6 +41,100 @@ std::shared_ptr<Material> Mesh::GetMaterial() const
     return m_Material;
 }
 
+void Mesh::SetVertexFormat( VertexFormat vertexFormat )
+{
+    m_VertexFormat = vertexFormat;
+}
+
+Mesh::VertexFormat Mesh::GetVertexFormat() const
+{
+    return m_VertexFormat;
+}
+
+void Mesh::SetPositionTransform( const glm::mat4& positionTransform )
+{
+    m_PositionTransform = positionTransform;
+}
+
+const glm::mat4& Mesh::GetPositionTransform() const
+{
+    return m_PositionTransform;
+}
+
+void Mesh::SetMeshlets( std::vector<Meshlet> meshlets )
+{
+    m_Meshlets = std::move( meshlets );
+}
+
+const std::vector<Meshlet>& Mesh::GetMeshlets() const
+{
+    return m_Meshlets;
+}
+
+void Mesh::SetBounds( const BoundingBox& bounds, const glm::vec4& boundingSphere )
+{
+    m_Bounds = bounds;
+    m_BoundingSphere = boundingSphere;
+}
+
+const BoundingBox& Mesh::GetBounds() const
+{
+    return m_Bounds;
+}
+
+const glm::vec4& Mesh::GetBoundingSphere() const
+{
+    return m_BoundingSphere;
+}
+
+void Mesh::ComputeBounds( const Vertex* vertices, size_t numVertices, BoundingBox& bounds, glm::vec4& boundingSphere )
+{
+    bounds = BoundingBox();
+    for ( size_t i = 0; i < numVertices; ++i )
+    {
+        bounds.Grow( vertices[i].Position );
+    }
+
+    if ( !bounds.IsValid() )
+    {
+        boundingSphere = glm::vec4( 0.0f );
+        return;
+    }
+
+    glm::vec3 center = bounds.GetCenter();
+    float radiusSquared = 0.0f;
+    for ( size_t i = 0; i < numVertices; ++i )
+    {
+        glm::vec3 d = vertices[i].Position - center;
+        radiusSquared = std::max( radiusSquared, glm::dot( d, d ) );
+    }
+
+    boundingSphere = glm::vec4( center, std::sqrt( radiusSquared ) );
+}
+
+void Mesh::SetTriangles( std::vector<uint32_t> indices, std::vector<glm::vec3> triangleCenters )
+{
+    assert( indices.size() == triangleCenters.size() * 3 );
+
+    m_TriangleIndices = std::move( indices );
+    m_TriangleCenters = std::move( triangleCenters );
+}
+
+const std::vector<uint32_t>& Mesh::GetTriangleIndices() const
+{
+    return m_TriangleIndices;
+}
+
+const std::vector<glm::vec3>& Mesh::GetTriangleCenters() const
+{
+    return m_TriangleCenters;
+}
+
+bool Mesh::HasTriangles() const
+{
+    return !m_TriangleCenters.empty();
+}
+
 void Mesh::Render( Core::RenderEventArgs& renderArgs, uint32_t instanceCount, uint32_t firstInstance )
 {
     std::shared_ptr<Graphics::GraphicsCommandBuffer> commandBuffer = renderArgs.GraphicsCommandBuffer;
@@ -68,6 +166,85 @@ void Mesh::Render( Core::RenderEventArgs& renderArgs, uint32_t instanceCount, ui
 
 }
 
+void Mesh::RenderMeshlets( Core::RenderEventArgs& renderArgs, const uint32_t* meshletIndices, size_t numMeshlets, uint32_t instanceCount, uint32_t firstInstance )
+{
+    std::shared_ptr<Graphics::GraphicsCommandBuffer> commandBuffer = renderArgs.GraphicsCommandBuffer;
+
+    if ( commandBuffer && m_IndexBuffer && numMeshlets > 0 )
+    {
+        for ( auto vertexBuffer : m_VertexBuffers )
+        {
+            commandBuffer->BindVertexBuffer( vertexBuffer.first, vertexBuffer.second );
+        }
+
+        commandBuffer->BindIndexBuffer( m_IndexBuffer );
+
+        uint32_t firstIndex = m_Meshlets[meshletIndices[0]].FirstIndex;
+        uint32_t numIndices = 0;
+
+        for ( size_t i = 0; i < numMeshlets; ++i )
+        {
+            const Meshlet& meshlet = m_Meshlets[meshletIndices[i]];
+            if ( meshlet.FirstIndex != firstIndex + numIndices )
+            {
+                commandBuffer->DrawIndexed( numIndices, firstIndex, 0, instanceCount, firstInstance );
+                firstIndex = meshlet.FirstIndex;
+                numIndices = 0;
+            }
+            numIndices += meshlet.NumIndices;
+        }
+
+        commandBuffer->DrawIndexed( numIndices, firstIndex, 0, instanceCount, firstInstance );
+    }
+}
+
+void Mesh::RenderIndices( Core::RenderEventArgs& renderArgs, const void* indices, size_t numIndices, size_t indexSize, uint32_t instanceCount, uint32_t firstInstance )
+{
+    std::shared_ptr<Graphics::GraphicsCommandBuffer> commandBuffer = renderArgs.GraphicsCommandBuffer;
+
+    if ( commandBuffer && numIndices > 0 )
+    {
+        for ( auto vertexBuffer : m_VertexBuffers )
+        {
+            commandBuffer->BindVertexBuffer( vertexBuffer.first, vertexBuffer.second );
+        }
+
+        // The indices are copied to the upload heap of the command buffer.
+        commandBuffer->BindDynamicIndexBuffer( numIndices, indexSize, indices );
+        commandBuffer->DrawIndexed( static_cast<uint32_t>( numIndices ), 0, 0, instanceCount, firstInstance );
+    }
+}
+
+void Mesh::RenderIndices( Core::RenderEventArgs& renderArgs, std::shared_ptr<IndexBuffer> indexBuffer, uint32_t instanceCount, uint32_t firstInstance )
+{
+    std::shared_ptr<Graphics::GraphicsCommandBuffer> commandBuffer = renderArgs.GraphicsCommandBuffer;
+
+    if ( commandBuffer && indexBuffer && indexBuffer->GetNumIndices() > 0 )
+    {
+        for ( auto vertexBuffer : m_VertexBuffers )
+        {
+            commandBuffer->BindVertexBuffer( vertexBuffer.first, vertexBuffer.second );
+        }
+
+        commandBuffer->BindIndexBuffer( indexBuffer );
+        commandBuffer->DrawIndexed( static_cast<uint32_t>( indexBuffer->GetNumIndices() ), 0, 0, instanceCount, firstInstance );
+    }
+}
+
+std::shared_ptr<IndexBuffer> Mesh::CreateIndexBuffer( Core::RenderEventArgs& renderArgs, const void* indices, size_t numIndices, size_t indexSize ) const
+{
+    std::shared_ptr<Device> device = m_Device.lock();
+    std::shared_ptr<Graphics::GraphicsCommandBuffer> commandBuffer = renderArgs.GraphicsCommandBuffer;
+
+    if ( !device || !commandBuffer || numIndices == 0 )
+    {
+        return nullptr;
+    }
+
+    // The copy is recorded in the command buffer before the draws that use the index buffer.
+    return device->CreateIndexBuffer( commandBuffer, numIndices, indexSize, indices );
+}
+
 void Mesh::Accept( Core::SceneVisitor& visitor )
 {
     visitor.Visit( *this );
@@ -0,0 +1,170 @@
+#include <EnginePCH.h>
+
+#include <Graphics/MeshletBuilder.h>
+
+using namespace Graphics;
+
+namespace
+{
+    const uint32_t InvalidMeshlet = 0xffffffff;
+
+    // Compute the bounding sphere and the normal cone of a meshlet.
+    void ComputeBounds( const uint32_t* indices, const Mesh::Vertex* vertices, Meshlet& meshlet )
+    {
+        const uint32_t* meshletIndices = indices + meshlet.FirstIndex;
+
+        glm::vec3 minBounds( std::numeric_limits<float>::max() );
+        glm::vec3 maxBounds( -std::numeric_limits<float>::max() );
+        for ( uint32_t i = 0; i < meshlet.NumIndices; ++i )
+        {
+            minBounds = glm::min( minBounds, vertices[meshletIndices[i]].Position );
+            maxBounds = glm::max( maxBounds, vertices[meshletIndices[i]].Position );
+        }
+
+        // The center of the AABB is used as the center of the sphere.
+        glm::vec3 center = ( minBounds + maxBounds ) * 0.5f;
+        float radius = 0.0f;
+        for ( uint32_t i = 0; i < meshlet.NumIndices; ++i )
+        {
+            radius = std::max( radius, glm::distance( center, vertices[meshletIndices[i]].Position ) );
+        }
+
+        meshlet.BoundingSphere = glm::vec4( center, radius );
+
+        // The axis of the normal cone is the average of the triangle normals.
+        std::vector<glm::vec3> normals;
+        normals.reserve( meshlet.NumIndices / 3 );
+
+        glm::vec3 axis( 0 );
+        for ( uint32_t i = 0; i + 2 < meshlet.NumIndices; i += 3 )
+        {
+            const glm::vec3& p0 = vertices[meshletIndices[i + 0]].Position;
+            const glm::vec3& p1 = vertices[meshletIndices[i + 1]].Position;
+            const glm::vec3& p2 = vertices[meshletIndices[i + 2]].Position;
+
+            glm::vec3 normal = glm::cross( p1 - p0, p2 - p0 );
+            float length = glm::length( normal );
+            // Degenerate triangles are never rendered.
+            if ( length > 0.0f )
+            {
+                normals.push_back( normal / length );
+                axis += normals.back();
+            }
+        }
+
+        float axisLength = glm::length( axis );
+
+        // Meshlets without triangles or with triangles facing
+        // in opposite directions can't be back-face culled.
+        meshlet.NormalCone = glm::vec4( 0, 0, 0, 1 );
+        if ( !normals.empty() && axisLength > 0.0f )
+        {
+            axis /= axisLength;
+
+            float minDot = 1.0f;
+            for ( const glm::vec3& normal : normals )
+            {
+                minDot = std::min( minDot, glm::dot( axis, normal ) );
+            }
+
+            if ( minDot > 0.0f )
+            {
+                meshlet.NormalCone = glm::vec4( axis, std::sqrt( 1.0f - minDot * minDot ) );
+            }
+        }
+    }
+}
+
+void MeshletBuilder::Build( const uint32_t* indices, size_t numIndices, const Mesh::Vertex* vertices, size_t numVertices, std::vector<Meshlet>& meshlets,
+                            uint32_t maxVertices, uint32_t maxTriangles )
+{
+    assert( maxVertices >= 3 && maxTriangles >= 1 );
+
+    meshlets.clear();
+
+    const size_t numTriangles = numIndices / 3;
+    if ( numTriangles == 0 )
+    {
+        return;
+    }
+
+    // The last meshlet that references a vertex.
+    std::vector<uint32_t> vertexMeshlet( numVertices, InvalidMeshlet );
+
+    Meshlet meshlet = {};
+    uint32_t meshletIndex = 0;
+
+    for ( size_t t = 0; t < numTriangles; ++t )
+    {
+        const uint32_t* triangle = indices + t * 3;
+
+        // Count the vertices of the triangle that are not in the current meshlet yet.
+        uint32_t newVertices = 0;
+        for ( uint32_t i = 0; i < 3; ++i )
+        {
+            assert( triangle[i] < numVertices );
+            if ( vertexMeshlet[triangle[i]] != meshletIndex &&
+                 ( i < 1 || triangle[i] != triangle[0] ) &&
+                 ( i < 2 || triangle[i] != triangle[1] ) )
+            {
+                ++newVertices;
+            }
+        }
+
+        if ( meshlet.NumIndices > 0 &&
+             ( meshlet.NumVertices + newVertices > maxVertices || meshlet.NumIndices / 3 + 1 > maxTriangles ) )
+        {
+            meshlets.push_back( meshlet );
+
+            meshlet = {};
+            meshlet.FirstIndex = static_cast<uint32_t>( t * 3 );
+            ++meshletIndex;
+        }
+
+        for ( uint32_t i = 0; i < 3; ++i )
+        {
+            if ( vertexMeshlet[triangle[i]] != meshletIndex )
+            {
+                vertexMeshlet[triangle[i]] = meshletIndex;
+                ++meshlet.NumVertices;
+            }
+        }
+
+        meshlet.NumIndices += 3;
+    }
+
+    meshlets.push_back( meshlet );
+
+    for ( auto& m : meshlets )
+    {
+        ComputeBounds( indices, vertices, m );
+    }
+}
+
+bool MeshletBuilder::IsBackFacing( const Meshlet& meshlet, const glm::vec3& cameraPosition )
+{
+    // Conservative test with the bounding sphere instead of the exact positions of the triangles.
+    // Source: meshoptimizer, Arseny Kapoulkine.
+    glm::vec3 center( meshlet.BoundingSphere );
+    glm::vec3 axis( meshlet.NormalCone );
+    glm::vec3 view = center - cameraPosition;
+
+    return glm::dot( view, axis ) >= meshlet.NormalCone.w * glm::length( view ) + meshlet.BoundingSphere.w;
+}
+
+void MeshletBuilder::Cull( const Meshlet* meshlets, size_t numMeshlets, const Frustum& frustum, const glm::vec3& cameraPosition, bool cullBackFacing,
+                           std::vector<uint32_t>& visibleMeshlets )
+{
+    visibleMeshlets.clear();
+
+    for ( size_t i = 0; i < numMeshlets; ++i )
+    {
+        const Meshlet& meshlet = meshlets[i];
+
+        if ( frustum.Intersects( glm::vec3( meshlet.BoundingSphere ), meshlet.BoundingSphere.w ) &&
+             !( cullBackFacing && IsBackFacing( meshlet, cameraPosition ) ) )
+        {
+            visibleMeshlets.push_back( static_cast<uint32_t>( i ) );
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#include <EnginePCH.h>
+
+#include <Graphics/RenderQueue.h>
+#include <Graphics/CPU/RadixSortCPU.h>
+
+using namespace Graphics;
+
+namespace
+{
+    const uint32_t DEPTH_SLICE_BITS = 4;
+    // The number of bits of the depth in the FrontToBack and BackToFront keys.
+    const uint32_t FRONT_TO_BACK_DEPTH_BITS = 64 - RenderQueue::PipelineBits - DEPTH_SLICE_BITS - RenderQueue::MaterialBits - RenderQueue::MeshBits;
+    const uint32_t BACK_TO_FRONT_DEPTH_BITS = 64 - RenderQueue::PipelineBits - RenderQueue::MaterialBits - RenderQueue::MeshBits;
+
+    static_assert( ( 1u << DEPTH_SLICE_BITS ) == RenderQueue::NumDepthSlices, "The depth slices don't fit in the key." );
+
+    inline uint64_t Mask( uint32_t numBits )
+    {
+        return ( uint64_t( 1 ) << numBits ) - 1;
+    }
+}
+
+RenderQueue::RenderQueue( SortOrder sortOrder )
+    : m_SortOrder( sortOrder )
+{
+    SetDepthRange( 0.1f, 1000.0f );
+}
+
+RenderQueue::~RenderQueue()
+{}
+
+void RenderQueue::SetSortOrder( SortOrder sortOrder )
+{
+    m_SortOrder = sortOrder;
+}
+
+RenderQueue::SortOrder RenderQueue::GetSortOrder() const
+{
+    return m_SortOrder;
+}
+
+void RenderQueue::SetDepthRange( float zNear, float zFar )
+{
+    m_ZNear = std::max( zNear, std::numeric_limits<float>::min() );
+    m_ZFar = std::max( zFar, m_ZNear * ( 1.0f + std::numeric_limits<float>::epsilon() ) );
+    m_InvLogDepthRatio = 1.0f / std::log( m_ZFar / m_ZNear );
+}
+
+void RenderQueue::Clear()
+{
+    m_PipelineIDs.clear();
+    m_MaterialIDs.clear();
+    m_MeshIDs.clear();
+
+    m_Keys.clear();
+    m_DrawIndices.clear();
+}
+
+uint32_t RenderQueue::GetID( std::unordered_map<const void*, uint32_t>& ids, const void* object )
+{
+    // Only insert new objects (emplace allocates a node even if the object is already in the map).
+    auto iter = ids.find( object );
+    if ( iter == ids.end() )
+    {
+        iter = ids.insert( std::make_pair( object, static_cast<uint32_t>( ids.size() ) ) ).first;
+    }
+
+    return iter->second;
+}
+
+void RenderQueue::Push( const void* pipeline, const void* material, const void* mesh, float depth, uint32_t drawIndex )
+{
+    uint32_t pipelineID = GetID( m_PipelineIDs, pipeline );
+    uint32_t materialID = GetID( m_MaterialIDs, material );
+    uint32_t meshID = GetID( m_MeshIDs, mesh );
+
+    m_Keys.push_back( MakeKey( pipelineID, materialID, meshID, depth ) );
+    m_DrawIndices.push_back( drawIndex );
+}
+
+void RenderQueue::Sort( Core::ThreadPool& threadPool )
+{
+    RadixSortCPU::Sort( m_Keys, m_DrawIndices, m_TmpKeys, m_TmpDrawIndices, 64, threadPool );
+}
+
+void RenderQueue::Sort()
+{
+    Sort( Core::ThreadPool::Get() );
+}
+
+uint32_t RenderQueue::GetNumDraws() const
+{
+    return static_cast<uint32_t>( m_Keys.size() );
+}
+
+const uint64_t* RenderQueue::GetKeys() const
+{
+    return m_Keys.data();
+}
+
+const uint32_t* RenderQueue::GetDrawIndices() const
+{
+    return m_DrawIndices.data();
+}
+
+uint32_t RenderQueue::QuantizeDepth( float depth, uint32_t numBits ) const
+{
+    float d = glm::clamp( ( depth - m_ZNear ) / ( m_ZFar - m_ZNear ), 0.0f, 1.0f );
+    return static_cast<uint32_t>( d * static_cast<float>( Mask( numBits ) ) );
+}
+
+uint32_t RenderQueue::GetDepthSlice( float depth ) const
+{
+    // Logarithmic slices (the same distribution as the depth slices of the cluster grid).
+    float slice = std::log( std::max( depth, m_ZNear ) / m_ZNear ) * m_InvLogDepthRatio * NumDepthSlices;
+    return std::min( static_cast<uint32_t>( slice ), NumDepthSlices - 1 );
+}
+
+uint64_t RenderQueue::MakeKey( uint32_t pipelineID, uint32_t materialID, uint32_t meshID, float depth ) const
+{
+    uint64_t key = pipelineID & Mask( PipelineBits );
+
+    if ( m_SortOrder == SortOrder::FrontToBack )
+    {
+        key = ( key << DEPTH_SLICE_BITS ) | GetDepthSlice( depth );
+        key = ( key << MaterialBits ) | ( materialID & Mask( MaterialBits ) );
+        key = ( key << MeshBits ) | ( meshID & Mask( MeshBits ) );
+        key = ( key << FRONT_TO_BACK_DEPTH_BITS ) | QuantizeDepth( depth, FRONT_TO_BACK_DEPTH_BITS );
+    }
+    else
+    {
+        key = ( key << BACK_TO_FRONT_DEPTH_BITS ) | ( Mask( BACK_TO_FRONT_DEPTH_BITS ) - QuantizeDepth( depth, BACK_TO_FRONT_DEPTH_BITS ) );
+        key = ( key << MaterialBits ) | ( materialID & Mask( MaterialBits ) );
+        key = ( key << MeshBits ) | ( meshID & Mask( MeshBits ) );
+    }
+
+    return key;
+}
+
+uint32_t RenderQueue::GetPipelineID( uint64_t key ) const
+{
+    return static_cast<uint32_t>( key >> ( 64 - PipelineBits ) );
+}
+
+uint32_t RenderQueue::GetMaterialID( uint64_t key ) const
+{
+    uint32_t shift = ( m_SortOrder == SortOrder::FrontToBack ) ? MeshBits + FRONT_TO_BACK_DEPTH_BITS : MeshBits;
+    return static_cast<uint32_t>( ( key >> shift ) & Mask( MaterialBits ) );
+}
+
+uint32_t RenderQueue::GetMeshID( uint64_t key ) const
+{
+    uint32_t shift = ( m_SortOrder == SortOrder::FrontToBack ) ? FRONT_TO_BACK_DEPTH_BITS : 0;
+    return static_cast<uint32_t>( ( key >> shift ) & Mask( MeshBits ) );
+}
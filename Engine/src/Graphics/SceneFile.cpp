@@ -0,0 +1,314 @@
+#include <EnginePCH.h>
+
+#include <Graphics/SceneFile.h>
+#include <Graphics/Material.h>
+
+#include <LogManager.h>
+
+using namespace Core;
+using namespace Graphics;
+
+namespace
+{
+    const char SCENE_FILE_MAGIC[4] = { 'S', 'C', 'N', 'E' };
+
+    // Check that the range [first, first + count) is within [0, size).
+    inline bool ValidateRange( uint64_t first, uint64_t count, uint64_t size )
+    {
+        return first <= size && count <= size - first;
+    }
+
+    // Check that all indices of a mesh reference one of the vertices of the mesh.
+    template<typename T>
+    bool ValidateIndices( const uint8_t* indices, uint32_t numIndices, uint32_t numVertices )
+    {
+        const T* meshIndices = reinterpret_cast<const T*>( indices );
+        for ( uint32_t i = 0; i < numIndices; ++i )
+        {
+            if ( meshIndices[i] >= numVertices )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    void WriteArray( std::ofstream& file, uint64_t offset, const std::vector<T>& elements )
+    {
+        MemoryMappedFile::WritePadding( file, offset );
+        file.write( reinterpret_cast<const char*>( elements.data() ), static_cast<std::streamsize>( elements.size() * sizeof( T ) ) );
+    }
+}
+
+uint32_t SceneFile::Contents::AddString( const std::string& string )
+{
+    uint32_t offset = static_cast<uint32_t>( Strings.size() );
+    Strings.append( string.c_str(), string.size() + 1 );
+
+    return offset;
+}
+
+uint64_t SceneFile::Contents::AddIndices( const void* indices, uint32_t numIndices, uint32_t indexSize )
+{
+    // The indices of every mesh are aligned to the size of the indices.
+    Indices.resize( ( Indices.size() + indexSize - 1 ) & ~static_cast<size_t>( indexSize - 1 ), 0 );
+
+    uint64_t offset = Indices.size();
+    const uint8_t* data = static_cast<const uint8_t*>( indices );
+    Indices.insert( Indices.end(), data, data + static_cast<size_t>( numIndices ) * indexSize );
+
+    return offset;
+}
+
+SceneFile::SceneFile()
+{}
+
+SceneFile::~SceneFile()
+{
+    Close();
+}
+
+bool SceneFile::Open( const std::wstring& fileName )
+{
+    if ( !m_File.Open( fileName, sizeof( Header ) ) )
+    {
+        LOG_ERROR( "Could not open scene file: ", fileName );
+        return false;
+    }
+
+    if ( !Validate() )
+    {
+        LOG_ERROR( "Invalid scene file (or scene file version mismatch): ", fileName );
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void SceneFile::Close()
+{
+    m_File.Close();
+}
+
+bool SceneFile::IsOpen() const
+{
+    return m_File.IsOpen();
+}
+
+template<typename T>
+const T* SceneFile::GetArray( uint64_t offset ) const
+{
+    return IsOpen() ? reinterpret_cast<const T*>( m_File.GetData() + offset ) : nullptr;
+}
+
+bool SceneFile::Validate() const
+{
+    const Header& header = GetHeader();
+
+    if ( memcmp( header.Magic, SCENE_FILE_MAGIC, sizeof( SCENE_FILE_MAGIC ) ) != 0 ||
+         header.Version != FileVersion ||
+         header.VertexFormat > static_cast<uint32_t>( Mesh::VertexFormat::Compact ) ||
+         header.VertexSize != GetVertexSize( static_cast<Mesh::VertexFormat>( header.VertexFormat ) ) ||
+         header.NumNodes == 0 ||
+         !m_File.ValidateArray( header.MaterialsOffset, header.NumMaterials, sizeof( MaterialRecord ) ) ||
+         !m_File.ValidateArray( header.TexturesOffset, header.NumTextures, sizeof( TextureRecord ) ) ||
+         !m_File.ValidateArray( header.MeshesOffset, header.NumMeshes, sizeof( MeshRecord ) ) ||
+         !m_File.ValidateArray( header.MeshletsOffset, header.NumMeshlets, sizeof( Meshlet ) ) ||
+         !m_File.ValidateArray( header.NodesOffset, header.NumNodes, sizeof( NodeRecord ) ) ||
+         !m_File.ValidateArray( header.NodeMeshesOffset, header.NumNodeMeshes, sizeof( uint32_t ) ) ||
+         !m_File.ValidateArray( header.VerticesOffset, header.NumVertices, header.VertexSize ) ||
+         !m_File.ValidateArray( header.IndicesOffset, header.IndicesSize, sizeof( uint8_t ) ) ||
+         !m_File.ValidateArray( header.StringsOffset, header.StringsSize, sizeof( char ) ) )
+    {
+        return false;
+    }
+
+    // The string table must be null-terminated so that none of the strings can be read past the end of the file.
+    const char* strings = GetArray<char>( header.StringsOffset );
+    if ( header.StringsSize > 0 && strings[header.StringsSize - 1] != '\0' )
+    {
+        return false;
+    }
+
+    // Make sure all of the indices in the records are valid
+    // so the records can be used without further checks.
+    const TextureRecord* textures = GetTextures();
+    for ( uint32_t i = 0; i < header.NumTextures; ++i )
+    {
+        if ( textures[i].MaterialIndex >= header.NumMaterials ||
+             textures[i].TextureType >= static_cast<uint32_t>( Material::TextureType::NumTypes ) ||
+             textures[i].FileName >= header.StringsSize )
+        {
+            return false;
+        }
+    }
+
+    const MeshRecord* meshes = GetMeshes();
+    const Meshlet* meshlets = GetMeshlets();
+    for ( uint32_t i = 0; i < header.NumMeshes; ++i )
+    {
+        if ( meshes[i].MaterialIndex >= header.NumMaterials ||
+             ( meshes[i].IndexSize != sizeof( uint16_t ) && meshes[i].IndexSize != sizeof( uint32_t ) ) ||
+             ( meshes[i].FirstIndex % meshes[i].IndexSize ) != 0 ||
+             !ValidateRange( meshes[i].FirstVertex, meshes[i].NumVertices, header.NumVertices ) ||
+             !ValidateRange( meshes[i].FirstIndex, static_cast<uint64_t>( meshes[i].NumIndices ) * meshes[i].IndexSize, header.IndicesSize ) ||
+             !ValidateRange( meshes[i].FirstMeshlet, meshes[i].NumMeshlets, header.NumMeshlets ) )
+        {
+            return false;
+        }
+
+        // The indices are used to read the vertices on the CPU (see SetTriangles in SceneDX12.cpp).
+        const uint8_t* indices = GetIndices() + meshes[i].FirstIndex;
+        bool validIndices = ( meshes[i].IndexSize == sizeof( uint16_t ) ) ?
+            ValidateIndices<uint16_t>( indices, meshes[i].NumIndices, meshes[i].NumVertices ) :
+            ValidateIndices<uint32_t>( indices, meshes[i].NumIndices, meshes[i].NumVertices );
+
+        if ( !validIndices )
+        {
+            return false;
+        }
+
+        // The meshlets are rendered with the index buffer of the mesh.
+        for ( uint32_t j = 0; j < meshes[i].NumMeshlets; ++j )
+        {
+            const Meshlet& meshlet = meshlets[meshes[i].FirstMeshlet + j];
+            if ( !ValidateRange( meshlet.FirstIndex, meshlet.NumIndices, meshes[i].NumIndices ) )
+            {
+                return false;
+            }
+        }
+    }
+
+    const NodeRecord* nodes = GetNodes();
+    for ( uint32_t i = 0; i < header.NumNodes; ++i )
+    {
+        // Parent nodes must be stored before their children (only the first node is a root node).
+        if ( ( i == 0 ) != ( nodes[i].ParentIndex == InvalidIndex ) ||
+             ( i > 0 && nodes[i].ParentIndex >= i ) ||
+             nodes[i].Name >= header.StringsSize ||
+             !ValidateRange( nodes[i].FirstMesh, nodes[i].NumMeshes, header.NumNodeMeshes ) )
+        {
+            return false;
+        }
+    }
+
+    const uint32_t* nodeMeshes = GetNodeMeshes();
+    for ( uint32_t i = 0; i < header.NumNodeMeshes; ++i )
+    {
+        if ( nodeMeshes[i] >= header.NumMeshes )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+const SceneFile::Header& SceneFile::GetHeader() const
+{
+    return *reinterpret_cast<const Header*>( m_File.GetData() );
+}
+
+const SceneFile::MaterialRecord* SceneFile::GetMaterials() const
+{
+    return GetArray<MaterialRecord>( GetHeader().MaterialsOffset );
+}
+
+const SceneFile::TextureRecord* SceneFile::GetTextures() const
+{
+    return GetArray<TextureRecord>( GetHeader().TexturesOffset );
+}
+
+const SceneFile::MeshRecord* SceneFile::GetMeshes() const
+{
+    return GetArray<MeshRecord>( GetHeader().MeshesOffset );
+}
+
+const Meshlet* SceneFile::GetMeshlets() const
+{
+    return GetArray<Meshlet>( GetHeader().MeshletsOffset );
+}
+
+const SceneFile::NodeRecord* SceneFile::GetNodes() const
+{
+    return GetArray<NodeRecord>( GetHeader().NodesOffset );
+}
+
+const uint32_t* SceneFile::GetNodeMeshes() const
+{
+    return GetArray<uint32_t>( GetHeader().NodeMeshesOffset );
+}
+
+const uint8_t* SceneFile::GetVertices() const
+{
+    return GetArray<uint8_t>( GetHeader().VerticesOffset );
+}
+
+const uint8_t* SceneFile::GetIndices() const
+{
+    return GetArray<uint8_t>( GetHeader().IndicesOffset );
+}
+
+const char* SceneFile::GetString( uint32_t offset ) const
+{
+    return GetArray<char>( GetHeader().StringsOffset + offset );
+}
+
+uint32_t SceneFile::GetVertexSize( Mesh::VertexFormat vertexFormat )
+{
+    return vertexFormat == Mesh::VertexFormat::Compact ? sizeof( Mesh::CompactVertex ) : sizeof( Mesh::Vertex );
+}
+
+bool SceneFile::Save( const std::wstring& fileName, const Contents& contents )
+{
+    Header header = {};
+    memcpy( header.Magic, SCENE_FILE_MAGIC, sizeof( SCENE_FILE_MAGIC ) );
+    header.Version = FileVersion;
+    header.VertexFormat = static_cast<uint32_t>( contents.VertexFormat );
+    header.VertexSize = GetVertexSize( contents.VertexFormat );
+    header.OverdrawOptimized = contents.OverdrawOptimized ? 1 : 0;
+    header.NumMaterials = static_cast<uint32_t>( contents.Materials.size() );
+    header.NumTextures = static_cast<uint32_t>( contents.Textures.size() );
+    header.NumMeshes = static_cast<uint32_t>( contents.Meshes.size() );
+    header.NumMeshlets = static_cast<uint32_t>( contents.Meshlets.size() );
+    header.NumNodes = static_cast<uint32_t>( contents.Nodes.size() );
+    header.NumNodeMeshes = static_cast<uint32_t>( contents.NodeMeshes.size() );
+    header.NumVertices = contents.Vertices.size() / header.VertexSize;
+    header.IndicesSize = contents.Indices.size();
+    header.StringsSize = contents.Strings.size();
+    header.MaterialsOffset = MemoryMappedFile::AlignUp( sizeof( Header ) );
+    header.TexturesOffset = MemoryMappedFile::AlignUp( header.MaterialsOffset + header.NumMaterials * sizeof( MaterialRecord ) );
+    header.MeshesOffset = MemoryMappedFile::AlignUp( header.TexturesOffset + header.NumTextures * sizeof( TextureRecord ) );
+    header.MeshletsOffset = MemoryMappedFile::AlignUp( header.MeshesOffset + header.NumMeshes * sizeof( MeshRecord ) );
+    header.NodesOffset = MemoryMappedFile::AlignUp( header.MeshletsOffset + header.NumMeshlets * sizeof( Meshlet ) );
+    header.NodeMeshesOffset = MemoryMappedFile::AlignUp( header.NodesOffset + header.NumNodes * sizeof( NodeRecord ) );
+    header.VerticesOffset = MemoryMappedFile::AlignUp( header.NodeMeshesOffset + header.NumNodeMeshes * sizeof( uint32_t ) );
+    header.IndicesOffset = MemoryMappedFile::AlignUp( header.VerticesOffset + header.NumVertices * header.VertexSize );
+    header.StringsOffset = MemoryMappedFile::AlignUp( header.IndicesOffset + header.IndicesSize );
+
+    std::ofstream file( fileName, std::ios::out | std::ios::binary | std::ios::trunc );
+    if ( !file.is_open() )
+    {
+        LOG_ERROR( "Could not write scene file: ", fileName );
+        return false;
+    }
+
+    file.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) );
+
+    WriteArray( file, header.MaterialsOffset, contents.Materials );
+    WriteArray( file, header.TexturesOffset, contents.Textures );
+    WriteArray( file, header.MeshesOffset, contents.Meshes );
+    WriteArray( file, header.MeshletsOffset, contents.Meshlets );
+    WriteArray( file, header.NodesOffset, contents.Nodes );
+    WriteArray( file, header.NodeMeshesOffset, contents.NodeMeshes );
+    WriteArray( file, header.VerticesOffset, contents.Vertices );
+    WriteArray( file, header.IndicesOffset, contents.Indices );
+
+    MemoryMappedFile::WritePadding( file, header.StringsOffset );
+    file.write( contents.Strings.data(), static_cast<std::streamsize>( contents.Strings.size() ) );
+
+    return file.good();
+}
@@ -4,18 +4,23 @@
 #include <SceneVisitor.h>
 #include <Graphics/Mesh.h>
 #include <Graphics/SceneNode.h>
+#include <Graphics/TransformHierarchy.h>
 
 using namespace Graphics;
 
 SceneNode::SceneNode( const glm::mat4& localTransform )
     : m_LocalTransform( localTransform )
     , m_Name( "SceneNode" )
-{
-    m_InverseTransform = glm::inverse( m_LocalTransform );
-}
+    , m_TransformIndex( TransformHierarchy::InvalidIndex )
+{}
 
 SceneNode::~SceneNode()
 {
+    if ( m_TransformHierarchy )
+    {
+        m_TransformHierarchy->RemoveNode( m_TransformIndex );
+    }
+
     // Delete children.
     m_Children.clear();
 }
@@ -38,16 +43,30 @@ glm::mat4 SceneNode::GetLocalTransform() const
 void SceneNode::SetLocalTransform( const glm::mat4& localTransform )
 {
     m_LocalTransform = localTransform;
-    m_InverseTransform = glm::inverse( localTransform );
+
+    if ( m_TransformHierarchy )
+    {
+        m_TransformHierarchy->SetLocalTransform( m_TransformIndex, localTransform );
+    }
 }
 
 glm::mat4 SceneNode::GetInverseLocalTransform() const
 {
-    return m_InverseTransform;
+    return glm::inverse( m_LocalTransform );
 }
 
 glm::mat4 SceneNode::GetWorldTransform() const
 {
+    // Updating the hierarchy can remove this node from it.
+    if ( std::shared_ptr<TransformHierarchy> transformHierarchy = m_TransformHierarchy )
+    {
+        transformHierarchy->Update();
+        if ( m_TransformHierarchy == transformHierarchy )
+        {
+            return transformHierarchy->GetWorldTransform( m_TransformIndex );
+        }
+    }
+
     return GetParentWorldTransform() * m_LocalTransform;
 }
 
@@ -62,6 +81,48 @@ glm::mat4 SceneNode::GetInverseWorldTransform() const
     return glm::inverse( GetWorldTransform() );
 }
 
+glm::mat4 SceneNode::GetInverseTransposeWorldTransform() const
+{
+    if ( std::shared_ptr<TransformHierarchy> transformHierarchy = m_TransformHierarchy )
+    {
+        transformHierarchy->Update();
+        if ( m_TransformHierarchy == transformHierarchy )
+        {
+            return transformHierarchy->GetInverseTransposeWorldTransform( m_TransformIndex );
+        }
+    }
+
+    return glm::inverseTranspose( GetWorldTransform() );
+}
+
+std::shared_ptr<TransformHierarchy> SceneNode::GetTransformHierarchy() const
+{
+    return m_TransformHierarchy;
+}
+
+void SceneNode::InvalidateTransformHierarchy()
+{
+    if ( m_TransformHierarchy )
+    {
+        m_TransformHierarchy->Invalidate();
+    }
+}
+
+void SceneNode::DetachTransformHierarchy()
+{
+    if ( m_TransformHierarchy )
+    {
+        m_TransformHierarchy->RemoveNode( m_TransformIndex );
+        m_TransformHierarchy.reset();
+        m_TransformIndex = TransformHierarchy::InvalidIndex;
+    }
+
+    for ( auto child : m_Children )
+    {
+        child->DetachTransformHierarchy();
+    }
+}
+
 glm::mat4 SceneNode::GetParentWorldTransform() const
 {
     glm::mat4 parentTransform( 1.0f );
@@ -89,6 +150,9 @@ void SceneNode::AddChild( std::shared_ptr<SceneNode> pNode )
             {
                 m_ChildrenByName.insert( NodeNameMap::value_type( pNode->GetName(), pNode ) );
             }
+
+            // The child (and its children) are added to the hierarchy of this node.
+            InvalidateTransformHierarchy();
         }
     }
 }
@@ -100,6 +164,7 @@ void SceneNode::RemoveChild( std::shared_ptr<SceneNode> pNode )
         NodeList::iterator iter = std::find( m_Children.begin(), m_Children.end(), pNode );
         if ( iter != m_Children.end() )
         {
+            pNode->DetachTransformHierarchy();
             pNode->SetParent( std::weak_ptr<SceneNode>() );
 
             m_Children.erase( iter );
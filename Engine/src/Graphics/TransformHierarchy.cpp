@@ -0,0 +1,187 @@
+#include <EnginePCH.h>
+
+#include <Graphics/TransformHierarchy.h>
+#include <Graphics/Mesh.h>
+#include <Graphics/SceneNode.h>
+
+#include <SceneVisitor.h>
+
+using namespace Graphics;
+
+std::shared_ptr<TransformHierarchy> TransformHierarchy::Create( std::shared_ptr<SceneNode> rootNode )
+{
+    std::shared_ptr<TransformHierarchy> transformHierarchy( new TransformHierarchy( rootNode ) );
+    transformHierarchy->Update();
+
+    return transformHierarchy;
+}
+
+TransformHierarchy::TransformHierarchy( std::shared_ptr<SceneNode> rootNode )
+    : m_RootNode( rootNode )
+    , m_FirstDirtyIndex( InvalidIndex )
+    , m_IsDirtyHierarchy( true )
+    , m_IsDirtyTransform( false )
+{}
+
+TransformHierarchy::~TransformHierarchy()
+{}
+
+void TransformHierarchy::Update()
+{
+    // The flags are only cleared after the world transforms are computed
+    // so the transforms are up-to-date if both flags are clear.
+    if ( !m_IsDirtyHierarchy && !m_IsDirtyTransform )
+    {
+        return;
+    }
+
+    // Keep the hierarchy alive while the nodes are detached from it.
+    std::shared_ptr<TransformHierarchy> me = shared_from_this();
+
+    scoped_lock lock( m_Mutex );
+
+    if ( m_IsDirtyHierarchy )
+    {
+        Flatten();
+    }
+
+    // Parents are stored before their children so the world transform of
+    // the parent is always up-to-date when the child is updated.
+    const uint32_t numNodes = static_cast<uint32_t>( m_Nodes.size() );
+    for ( uint32_t i = m_FirstDirtyIndex; i < numNodes; ++i )
+    {
+        uint32_t parentIndex = m_ParentIndices[i];
+        if ( parentIndex != InvalidIndex )
+        {
+            m_IsDirty[i] |= m_IsDirty[parentIndex];
+        }
+
+        if ( m_IsDirty[i] )
+        {
+            m_WorldTransforms[i] = ( parentIndex != InvalidIndex ) ? m_WorldTransforms[parentIndex] * m_LocalTransforms[i] : m_LocalTransforms[i];
+            m_InverseTransposeWorldTransforms[i] = glm::inverseTranspose( m_WorldTransforms[i] );
+        }
+    }
+
+    if ( m_FirstDirtyIndex < numNodes )
+    {
+        std::fill( m_IsDirty.begin() + m_FirstDirtyIndex, m_IsDirty.end(), 0 );
+    }
+
+    m_FirstDirtyIndex = InvalidIndex;
+    m_IsDirtyHierarchy = false;
+    m_IsDirtyTransform = false;
+}
+
+void TransformHierarchy::Flatten()
+{
+    // Detach the nodes that are no longer in the hierarchy.
+    for ( SceneNode* pNode : m_Nodes )
+    {
+        if ( pNode )
+        {
+            pNode->m_TransformHierarchy.reset();
+            pNode->m_TransformIndex = InvalidIndex;
+        }
+    }
+
+    m_Nodes.clear();
+    m_ParentIndices.clear();
+    m_LocalTransforms.clear();
+
+    // Visit the nodes depth first in the same order as SceneNode::Accept.
+    std::vector<std::pair<SceneNode*, uint32_t>> stack;
+    if ( std::shared_ptr<SceneNode> rootNode = m_RootNode.lock() )
+    {
+        stack.emplace_back( rootNode.get(), InvalidIndex );
+    }
+
+    std::shared_ptr<TransformHierarchy> me = shared_from_this();
+    while ( !stack.empty() )
+    {
+        SceneNode* pNode = stack.back().first;
+        uint32_t parentIndex = stack.back().second;
+        stack.pop_back();
+
+        uint32_t index = static_cast<uint32_t>( m_Nodes.size() );
+        pNode->m_TransformHierarchy = me;
+        pNode->m_TransformIndex = index;
+
+        m_Nodes.push_back( pNode );
+        m_ParentIndices.push_back( parentIndex );
+        m_LocalTransforms.push_back( pNode->m_LocalTransform );
+
+        for ( auto iter = pNode->m_Children.rbegin(); iter != pNode->m_Children.rend(); ++iter )
+        {
+            stack.emplace_back( iter->get(), index );
+        }
+    }
+
+    m_WorldTransforms.resize( m_Nodes.size() );
+    m_InverseTransposeWorldTransforms.resize( m_Nodes.size() );
+    m_IsDirty.assign( m_Nodes.size(), 1 );
+    m_FirstDirtyIndex = 0;
+}
+
+uint32_t TransformHierarchy::GetNumNodes() const
+{
+    scoped_lock lock( m_Mutex );
+
+    return static_cast<uint32_t>( m_Nodes.size() );
+}
+
+void TransformHierarchy::SetLocalTransform( uint32_t index, const glm::mat4& localTransform )
+{
+    scoped_lock lock( m_Mutex );
+
+    m_LocalTransforms[index] = localTransform;
+    m_IsDirty[index] = 1;
+    m_FirstDirtyIndex = std::min( m_FirstDirtyIndex, index );
+    m_IsDirtyTransform = true;
+}
+
+glm::mat4 TransformHierarchy::GetWorldTransform( uint32_t index ) const
+{
+    scoped_lock lock( m_Mutex );
+
+    return m_WorldTransforms[index];
+}
+
+glm::mat4 TransformHierarchy::GetInverseTransposeWorldTransform( uint32_t index ) const
+{
+    scoped_lock lock( m_Mutex );
+
+    return m_InverseTransposeWorldTransforms[index];
+}
+
+void TransformHierarchy::Invalidate()
+{
+    // Wait for an Update that is in progress, otherwise the flag would be cleared when it completes.
+    scoped_lock lock( m_Mutex );
+
+    m_IsDirtyHierarchy = true;
+}
+
+void TransformHierarchy::RemoveNode( uint32_t index )
+{
+    scoped_lock lock( m_Mutex );
+
+    m_Nodes[index] = nullptr;
+    m_IsDirtyHierarchy = true;
+}
+
+void TransformHierarchy::Accept( Core::SceneVisitor& visitor )
+{
+    Update();
+
+    for ( size_t i = 0; i < m_Nodes.size(); ++i )
+    {
+        SceneNode* pNode = m_Nodes[i];
+        visitor.Visit( *pNode );
+
+        for ( auto mesh : pNode->m_Meshes )
+        {
+            mesh->Accept( visitor );
+        }
+    }
+}
@@ -0,0 +1,129 @@
+#include <EnginePCH.h>
+
+#include <Graphics/VertexCompression.h>
+
+#include <glm/gtc/packing.hpp>
+
+using namespace Graphics;
+
+namespace
+{
+    inline uint16_t PackUnorm16( float v )
+    {
+        return static_cast<uint16_t>( std::round( glm::clamp( v, 0.0f, 1.0f ) * 65535.0f ) );
+    }
+
+    inline float UnpackUnorm16( uint16_t v )
+    {
+        return v / 65535.0f;
+    }
+
+    inline int16_t PackSnorm16( float v )
+    {
+        return static_cast<int16_t>( std::round( glm::clamp( v, -1.0f, 1.0f ) * 32767.0f ) );
+    }
+
+    inline float UnpackSnorm16( int16_t v )
+    {
+        return std::max( v / 32767.0f, -1.0f );
+    }
+
+    // Returns 1 for positive values and zero and -1 for negative values.
+    inline glm::vec2 SignNotZero( const glm::vec2& v )
+    {
+        return glm::vec2( v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f );
+    }
+}
+
+glm::vec2 VertexCompression::EncodeOctahedral( const glm::vec3& v )
+{
+    float l1 = std::abs( v.x ) + std::abs( v.y ) + std::abs( v.z );
+    if ( l1 == 0.0f )
+    {
+        // Degenerate vectors (for example, meshes without tangents) are encoded as +Z.
+        return glm::vec2( 0.0f );
+    }
+
+    // Project on the octahedron and fold the lower hemisphere over the diagonals.
+    glm::vec2 e = glm::vec2( v.x, v.y ) / l1;
+    if ( v.z < 0.0f )
+    {
+        e = ( glm::vec2( 1.0f ) - glm::abs( glm::vec2( e.y, e.x ) ) ) * SignNotZero( e );
+    }
+
+    return e;
+}
+
+glm::vec3 VertexCompression::DecodeOctahedral( const glm::vec2& e )
+{
+    glm::vec3 v( e.x, e.y, 1.0f - std::abs( e.x ) - std::abs( e.y ) );
+    float t = std::max( -v.z, 0.0f );
+    v.x += v.x >= 0.0f ? -t : t;
+    v.y += v.y >= 0.0f ? -t : t;
+
+    return glm::normalize( v );
+}
+
+void VertexCompression::Encode( const Mesh::Vertex* vertices, size_t numVertices, Mesh::CompactVertex* compactVertices, glm::mat4& positionTransform )
+{
+    if ( numVertices == 0 )
+    {
+        positionTransform = glm::mat4( 1.0f );
+        return;
+    }
+
+    glm::vec3 minBounds = vertices[0].Position;
+    glm::vec3 maxBounds = vertices[0].Position;
+    for ( size_t i = 1; i < numVertices; ++i )
+    {
+        minBounds = glm::min( minBounds, vertices[i].Position );
+        maxBounds = glm::max( maxBounds, vertices[i].Position );
+    }
+
+    // The positions are quantized relative to the bounds of the mesh.
+    // Flat meshes have a zero extent on one of the axes.
+    glm::vec3 extent = maxBounds - minBounds;
+    glm::vec3 scale = glm::vec3( 1.0f ) / glm::max( extent, glm::vec3( std::numeric_limits<float>::min() ) );
+
+    positionTransform = glm::translate( minBounds ) * glm::scale( extent );
+
+    for ( size_t i = 0; i < numVertices; ++i )
+    {
+        const Mesh::Vertex& vertex = vertices[i];
+        Mesh::CompactVertex& compactVertex = compactVertices[i];
+
+        glm::vec3 position = ( vertex.Position - minBounds ) * scale;
+        glm::vec2 normal = EncodeOctahedral( vertex.Normal );
+        glm::vec2 tangent = EncodeOctahedral( vertex.Tangent );
+
+        // The bitangent is reconstructed as cross( normal, tangent ) * sign.
+        bool flipBitangent = glm::dot( glm::cross( vertex.Normal, vertex.Tangent ), vertex.BiTangent ) < 0.0f;
+
+        compactVertex.Position[0] = PackUnorm16( position.x );
+        compactVertex.Position[1] = PackUnorm16( position.y );
+        compactVertex.Position[2] = PackUnorm16( position.z );
+        compactVertex.Position[3] = flipBitangent ? 0 : 65535;
+        compactVertex.Normal[0] = PackSnorm16( normal.x );
+        compactVertex.Normal[1] = PackSnorm16( normal.y );
+        compactVertex.Tangent[0] = PackSnorm16( tangent.x );
+        compactVertex.Tangent[1] = PackSnorm16( tangent.y );
+        compactVertex.TexCoord[0] = glm::packHalf1x16( vertex.TexCoord.x );
+        compactVertex.TexCoord[1] = glm::packHalf1x16( vertex.TexCoord.y );
+    }
+}
+
+Mesh::Vertex VertexCompression::Decode( const Mesh::CompactVertex& compactVertex, const glm::mat4& positionTransform )
+{
+    Mesh::Vertex vertex;
+
+    glm::vec4 position( UnpackUnorm16( compactVertex.Position[0] ), UnpackUnorm16( compactVertex.Position[1] ), UnpackUnorm16( compactVertex.Position[2] ), 1.0f );
+    float bitangentSign = UnpackUnorm16( compactVertex.Position[3] ) * 2.0f - 1.0f;
+
+    vertex.Position = glm::vec3( positionTransform * position );
+    vertex.Normal = DecodeOctahedral( glm::vec2( UnpackSnorm16( compactVertex.Normal[0] ), UnpackSnorm16( compactVertex.Normal[1] ) ) );
+    vertex.Tangent = DecodeOctahedral( glm::vec2( UnpackSnorm16( compactVertex.Tangent[0] ), UnpackSnorm16( compactVertex.Tangent[1] ) ) );
+    vertex.BiTangent = glm::cross( vertex.Normal, vertex.Tangent ) * bitangentSign;
+    vertex.TexCoord = glm::vec3( glm::unpackHalf1x16( compactVertex.TexCoord[0] ), glm::unpackHalf1x16( compactVertex.TexCoord[1] ), 0.0f );
+
+    return vertex;
+}
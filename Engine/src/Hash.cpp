@@ -0,0 +1,192 @@
+#include <EnginePCH.h>
+
+#include <Hash.h>
+
+using namespace Core;
+
+namespace
+{
+    const uint64_t Prime1 = 11400714785074694791ull;
+    const uint64_t Prime2 = 14029467366897019727ull;
+    const uint64_t Prime3 = 1609587929392839161ull;
+    const uint64_t Prime4 = 9650029242287828579ull;
+    const uint64_t Prime5 = 2870177450012600261ull;
+
+    // Files are hashed in blocks of this size.
+    const size_t FileBlockSize = 64 * 1024;
+
+    inline uint64_t RotateLeft( uint64_t x, int r )
+    {
+        return ( x << r ) | ( x >> ( 64 - r ) );
+    }
+
+    // Unaligned little-endian reads.
+    inline uint64_t Read64( const uint8_t* p )
+    {
+        uint64_t value;
+        memcpy( &value, p, sizeof( value ) );
+        return value;
+    }
+
+    inline uint32_t Read32( const uint8_t* p )
+    {
+        uint32_t value;
+        memcpy( &value, p, sizeof( value ) );
+        return value;
+    }
+
+    inline uint64_t Round( uint64_t accumulator, uint64_t input )
+    {
+        accumulator += input * Prime2;
+        accumulator = RotateLeft( accumulator, 31 );
+        return accumulator * Prime1;
+    }
+
+    inline uint64_t MergeRound( uint64_t hash, uint64_t accumulator )
+    {
+        hash ^= Round( 0, accumulator );
+        return hash * Prime1 + Prime4;
+    }
+}
+
+Hasher::Hasher( uint64_t seed )
+    : m_Seed( seed )
+    , m_TotalSize( 0 )
+    , m_BufferSize( 0 )
+{
+    m_Accumulators[0] = seed + Prime1 + Prime2;
+    m_Accumulators[1] = seed + Prime2;
+    m_Accumulators[2] = seed;
+    m_Accumulators[3] = seed - Prime1;
+}
+
+void Hasher::ProcessStripe( const uint8_t* stripe )
+{
+    m_Accumulators[0] = Round( m_Accumulators[0], Read64( stripe + 0 ) );
+    m_Accumulators[1] = Round( m_Accumulators[1], Read64( stripe + 8 ) );
+    m_Accumulators[2] = Round( m_Accumulators[2], Read64( stripe + 16 ) );
+    m_Accumulators[3] = Round( m_Accumulators[3], Read64( stripe + 24 ) );
+}
+
+void Hasher::Update( const void* data, size_t size )
+{
+    const uint8_t* p = static_cast<const uint8_t*>( data );
+    const uint8_t* end = p + size;
+
+    m_TotalSize += size;
+
+    // Fill the partial stripe first.
+    if ( m_BufferSize > 0 )
+    {
+        size_t numBytes = std::min( size, sizeof( m_Buffer ) - m_BufferSize );
+        memcpy( m_Buffer + m_BufferSize, p, numBytes );
+        m_BufferSize += numBytes;
+        p += numBytes;
+
+        if ( m_BufferSize < sizeof( m_Buffer ) )
+        {
+            return;
+        }
+
+        ProcessStripe( m_Buffer );
+        m_BufferSize = 0;
+    }
+
+    while ( p + sizeof( m_Buffer ) <= end )
+    {
+        ProcessStripe( p );
+        p += sizeof( m_Buffer );
+    }
+
+    m_BufferSize = end - p;
+    memcpy( m_Buffer, p, m_BufferSize );
+}
+
+uint64_t Hasher::GetHash() const
+{
+    uint64_t hash;
+    if ( m_TotalSize >= sizeof( m_Buffer ) )
+    {
+        hash = RotateLeft( m_Accumulators[0], 1 ) + RotateLeft( m_Accumulators[1], 7 ) +
+               RotateLeft( m_Accumulators[2], 12 ) + RotateLeft( m_Accumulators[3], 18 );
+
+        for ( uint64_t accumulator : m_Accumulators )
+        {
+            hash = MergeRound( hash, accumulator );
+        }
+    }
+    else
+    {
+        hash = m_Seed + Prime5;
+    }
+
+    hash += m_TotalSize;
+
+    const uint8_t* p = m_Buffer;
+    const uint8_t* end = m_Buffer + m_BufferSize;
+
+    while ( p + 8 <= end )
+    {
+        hash ^= Round( 0, Read64( p ) );
+        hash = RotateLeft( hash, 27 ) * Prime1 + Prime4;
+        p += 8;
+    }
+
+    if ( p + 4 <= end )
+    {
+        hash ^= Read32( p ) * Prime1;
+        hash = RotateLeft( hash, 23 ) * Prime2 + Prime3;
+        p += 4;
+    }
+
+    while ( p < end )
+    {
+        hash ^= ( *p ) * Prime5;
+        hash = RotateLeft( hash, 11 ) * Prime1;
+        ++p;
+    }
+
+    // Avalanche.
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+uint64_t Hasher::Hash( const void* data, size_t size, uint64_t seed )
+{
+    Hasher hasher( seed );
+    hasher.Update( data, size );
+
+    return hasher.GetHash();
+}
+
+bool Hasher::HashFile( const std::filesystem::path& filePath, uint64_t& hash )
+{
+    std::ifstream file( filePath, std::ios::in | std::ios::binary );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+
+    Hasher hasher;
+    std::vector<char> block( FileBlockSize );
+
+    while ( file )
+    {
+        file.read( block.data(), block.size() );
+        hasher.Update( block.data(), static_cast<size_t>( file.gcount() ) );
+    }
+
+    if ( file.bad() )
+    {
+        return false;
+    }
+
+    hash = hasher.GetHash();
+
+    return true;
+}
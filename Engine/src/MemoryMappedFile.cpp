@@ -0,0 +1,112 @@
+#include <EnginePCH.h>
+
+#include <MemoryMappedFile.h>
+
+#include <LogManager.h>
+
+using namespace Core;
+
+MemoryMappedFile::MemoryMappedFile()
+    : m_File( INVALID_HANDLE_VALUE )
+    , m_FileMapping( nullptr )
+    , m_Data( nullptr )
+    , m_Size( 0 )
+{}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open( const std::wstring& fileName, uint64_t minSize )
+{
+    Close();
+
+    m_File = ::CreateFileW( fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if ( m_File == INVALID_HANDLE_VALUE )
+    {
+        LOG_ERROR( "Could not open file: ", fileName );
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if ( !::GetFileSizeEx( m_File, &fileSize ) || static_cast<uint64_t>( fileSize.QuadPart ) < minSize )
+    {
+        LOG_ERROR( "File is too small: ", fileName );
+        Close();
+        return false;
+    }
+
+    m_Size = static_cast<uint64_t>( fileSize.QuadPart );
+
+    m_FileMapping = ::CreateFileMappingW( m_File, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    if ( m_FileMapping )
+    {
+        m_Data = static_cast<const uint8_t*>( ::MapViewOfFile( m_FileMapping, FILE_MAP_READ, 0, 0, 0 ) );
+    }
+
+    if ( !m_Data )
+    {
+        LOG_ERROR( "Failed to map file: ", fileName );
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+    if ( m_Data )
+    {
+        ::UnmapViewOfFile( m_Data );
+        m_Data = nullptr;
+    }
+    if ( m_FileMapping )
+    {
+        ::CloseHandle( m_FileMapping );
+        m_FileMapping = nullptr;
+    }
+    if ( m_File != INVALID_HANDLE_VALUE )
+    {
+        ::CloseHandle( m_File );
+        m_File = INVALID_HANDLE_VALUE;
+    }
+
+    m_Size = 0;
+}
+
+bool MemoryMappedFile::IsOpen() const
+{
+    return m_Data != nullptr;
+}
+
+const uint8_t* MemoryMappedFile::GetData() const
+{
+    return m_Data;
+}
+
+uint64_t MemoryMappedFile::GetSize() const
+{
+    return m_Size;
+}
+
+bool MemoryMappedFile::ValidateArray( uint64_t offset, uint64_t numElements, uint64_t elementSize ) const
+{
+    return ( offset % Alignment ) == 0 &&
+             offset <= m_Size &&
+             numElements <= ( m_Size - offset ) / elementSize;
+}
+
+uint64_t MemoryMappedFile::AlignUp( uint64_t offset )
+{
+    return ( offset + Alignment - 1 ) & ~( Alignment - 1 );
+}
+
+void MemoryMappedFile::WritePadding( std::ofstream& file, uint64_t offset )
+{
+    static const char padding[Alignment] = {};
+
+    uint64_t position = static_cast<uint64_t>( file.tellp() );
+    file.write( padding, static_cast<std::streamsize>( offset - position ) );
+}
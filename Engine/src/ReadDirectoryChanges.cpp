@@ -28,6 +28,8 @@
 
 #include <EnginePCH.h>
 
+#if defined(_WIN32)
+
 #include "ReadDirectoryChanges.h"
 #include "ReadDirectoryChangesPrivate.h"
 
@@ -104,6 +106,11 @@ bool  CReadDirectoryChanges::Pop(DWORD& dwAction, std::wstring& wstrFilename)
 	return true;
 }
 
+bool CReadDirectoryChanges::Wait(DWORD dwMilliseconds)
+{
+	return ::WaitForSingleObject(m_Notifications.GetWaitHandle(), dwMilliseconds) == WAIT_OBJECT_0;
+}
+
 bool CReadDirectoryChanges::CheckOverflow()
 {
 	bool b = m_Notifications.overflow();
@@ -111,3 +118,5 @@ bool CReadDirectoryChanges::CheckOverflow()
 		m_Notifications.clear();
 	return b;
 }
+
+#endif
@@ -0,0 +1,388 @@
+#include <EnginePCH.h>
+
+#if defined(__linux__)
+
+#include "ReadDirectoryChanges.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <unordered_map>
+
+// Linux implementation of CReadDirectoryChanges.
+// The changes are read with inotify on a worker thread and pushed to the
+// same queue as the ReadDirectoryChangesW implementation.
+namespace ReadDirectoryChangesPrivate
+{
+
+///////////////////////////////////////////////////////////////////////////
+
+// All functions in CInotifyServer run in the context of the worker thread,
+// except for AddDirectory and RequestTermination.
+// One instance of this object is allocated for each instance of CReadDirectoryChanges.
+class CInotifyServer
+{
+public:
+	CInotifyServer(CReadDirectoryChanges* pParent)
+	{
+		m_pBase = pParent;
+		m_hInotify = ::inotify_init1(IN_CLOEXEC);
+		m_hWakeup = ::eventfd(0, EFD_CLOEXEC);
+	}
+
+	~CInotifyServer()
+	{
+		if (m_hInotify >= 0)
+			::close(m_hInotify);
+		if (m_hWakeup >= 0)
+			::close(m_hWakeup);
+	}
+
+	void Run();
+
+	void AddDirectory(const fs::path& directoryPath, bool bWatchSubtree, DWORD dwNotifyFilter);
+
+	void RequestTermination()
+	{
+		uint64_t value = 1;
+		ssize_t result;
+		do
+		{
+			result = ::write(m_hWakeup, &value, sizeof(value));
+		} while (result < 0 && errno == EINTR);
+	}
+
+protected:
+	struct Watch
+	{
+		fs::path DirectoryPath;
+		bool bWatchSubtree;
+		DWORD dwNotifyFilter;
+	};
+
+	// Add a watch for the directory (and its subdirectories if bWatchSubtree is true).
+	// If bReportFiles is true, the files that already exist are reported as added.
+	// This is used for directories that were created after the parent was watched,
+	// since files can be created before the watch is added.
+	void AddWatch(const fs::path& directoryPath, bool bWatchSubtree, DWORD dwNotifyFilter, bool bReportFiles);
+
+	// Remove the watches of a directory and its subdirectories.
+	// inotify keeps watching a directory that is moved, but the path of the
+	// watch is wrong after the move. Directories that are moved within a
+	// watched subtree are watched again with their new path (see ProcessNotification).
+	void RemoveWatches(const fs::path& directoryPath);
+
+	void ProcessNotification(const inotify_event& event);
+
+	CReadDirectoryChanges* m_pBase;
+
+	int m_hInotify;
+	// Signaled to terminate the worker thread.
+	int m_hWakeup;
+
+	// Watch descriptors to watched directories.
+	std::unordered_map<int, Watch> m_Watches;
+	std::mutex m_WatchesMutex;
+};
+
+namespace
+{
+	uint32_t GetInotifyMask(DWORD dwNotifyFilter, bool bWatchSubtree)
+	{
+		uint32_t mask = IN_DELETE_SELF | IN_MOVE_SELF;
+
+		if (dwNotifyFilter & FILE_NOTIFY_CHANGE_LAST_WRITE)
+		{
+			// Modifications are reported for every write. Applications should batch them.
+			mask |= IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB;
+		}
+		if (dwNotifyFilter & (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_CREATION))
+		{
+			mask |= IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+		}
+		if (bWatchSubtree)
+		{
+			// New subdirectories must be watched and moved subdirectories must be watched again.
+			mask |= IN_CREATE | IN_MOVED_FROM | IN_MOVED_TO;
+		}
+
+		return mask;
+	}
+
+	// Check to see if path is directoryPath or one of its descendants.
+	bool IsInDirectory(const fs::path& path, const fs::path& directoryPath)
+	{
+		auto result = std::mismatch(directoryPath.begin(), directoryPath.end(), path.begin(), path.end());
+		return result.first == directoryPath.end();
+	}
+}
+
+void CInotifyServer::AddDirectory(const fs::path& directoryPath, bool bWatchSubtree, DWORD dwNotifyFilter)
+{
+	AddWatch(directoryPath, bWatchSubtree, dwNotifyFilter, false);
+}
+
+void CInotifyServer::AddWatch(const fs::path& directoryPath, bool bWatchSubtree, DWORD dwNotifyFilter, bool bReportFiles)
+{
+	int wd = ::inotify_add_watch(m_hInotify, directoryPath.c_str(), GetInotifyMask(dwNotifyFilter, bWatchSubtree) | IN_ONLYDIR);
+	if (wd < 0)
+		return;
+
+	{
+		scoped_lock lock(m_WatchesMutex);
+		// Adding the same directory again returns the same watch descriptor.
+		m_Watches[wd] = { directoryPath, bWatchSubtree, dwNotifyFilter };
+	}
+
+	std::error_code ec;
+	for (fs::directory_iterator iter(directoryPath, ec), end; !ec && iter != end; iter.increment(ec))
+	{
+		bool bIsDirectory = iter->is_directory(ec);
+		if (bIsDirectory && bWatchSubtree)
+		{
+			AddWatch(iter->path(), bWatchSubtree, dwNotifyFilter, bReportFiles);
+		}
+		else if (bReportFiles && !bIsDirectory && (dwNotifyFilter & (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_CREATION)))
+		{
+			m_pBase->Push(FILE_ACTION_ADDED, iter->path().wstring());
+		}
+	}
+}
+
+void CInotifyServer::RemoveWatches(const fs::path& directoryPath)
+{
+	scoped_lock lock(m_WatchesMutex);
+
+	for (auto iter = m_Watches.begin(); iter != m_Watches.end(); )
+	{
+		if (IsInDirectory(iter->second.DirectoryPath, directoryPath))
+		{
+			// The IN_IGNORED event of the watch is ignored since the watch is no longer in m_Watches.
+			::inotify_rm_watch(m_hInotify, iter->first);
+			iter = m_Watches.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+}
+
+void CInotifyServer::Run()
+{
+	// Large enough for many events. The events are aligned in the buffer.
+	alignas(inotify_event) char buffer[16384];
+
+	pollfd fds[2] = {
+		{ m_hInotify, POLLIN, 0 },
+		{ m_hWakeup, POLLIN, 0 }
+	};
+
+	for (;;)
+	{
+		if (::poll(fds, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		if (fds[1].revents & POLLIN)
+			break;
+
+		if (fds[0].revents & POLLIN)
+		{
+			ssize_t len = ::read(m_hInotify, buffer, sizeof(buffer));
+			if (len <= 0)
+				continue;
+
+			for (char* p = buffer; p < buffer + len; )
+			{
+				const inotify_event& event = *reinterpret_cast<const inotify_event*>(p);
+				ProcessNotification(event);
+				p += sizeof(inotify_event) + event.len;
+			}
+		}
+	}
+}
+
+void CInotifyServer::ProcessNotification(const inotify_event& event)
+{
+	if (event.mask & IN_Q_OVERFLOW)
+	{
+		std::unique_lock<std::mutex> lock(m_pBase->m_NotificationsMutex);
+		m_pBase->m_bOverflow = true;
+		lock.unlock();
+		m_pBase->m_NotificationsCondition.notify_one();
+		return;
+	}
+
+	Watch watch;
+	{
+		scoped_lock lock(m_WatchesMutex);
+
+		auto iter = m_Watches.find(event.wd);
+		if (iter == m_Watches.end())
+			return;
+
+		if (event.mask & IN_IGNORED)
+		{
+			// The directory was removed or unmounted.
+			m_Watches.erase(iter);
+			return;
+		}
+
+		watch = iter->second;
+	}
+
+	if (event.mask & IN_MOVE_SELF)
+	{
+		// A watched directory was moved and the paths of its watches are no longer valid.
+		// Subdirectories of a watched subtree are already removed when they are moved
+		// (IN_MOVED_FROM), so this only happens for the directories passed to AddDirectory
+		// or if the parent directory was not watched.
+		RemoveWatches(watch.DirectoryPath);
+		return;
+	}
+
+	if (event.len == 0)
+		return;
+
+	fs::path filePath = watch.DirectoryPath / event.name;
+
+	if (event.mask & IN_ISDIR)
+	{
+		if (watch.bWatchSubtree && (event.mask & IN_MOVED_FROM))
+		{
+			RemoveWatches(filePath);
+		}
+		if (watch.bWatchSubtree && (event.mask & (IN_CREATE | IN_MOVED_TO)))
+		{
+			AddWatch(filePath, true, watch.dwNotifyFilter, true);
+		}
+		if (!(watch.dwNotifyFilter & FILE_NOTIFY_CHANGE_DIR_NAME))
+			return;
+	}
+	else if (!(watch.dwNotifyFilter & (FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_CREATION)) &&
+			 (event.mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)))
+	{
+		// Only watched for the subdirectories.
+		return;
+	}
+
+	DWORD dwAction = 0;
+	if (event.mask & IN_CREATE)
+		dwAction = FILE_ACTION_ADDED;
+	else if (event.mask & IN_DELETE)
+		dwAction = FILE_ACTION_REMOVED;
+	else if (event.mask & IN_MOVED_FROM)
+		dwAction = FILE_ACTION_RENAMED_OLD_NAME;
+	else if (event.mask & IN_MOVED_TO)
+		dwAction = FILE_ACTION_RENAMED_NEW_NAME;
+	else if (event.mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB))
+		dwAction = FILE_ACTION_MODIFIED;
+
+	if (dwAction)
+		m_pBase->Push(dwAction, filePath.wstring());
+}
+
+}
+
+using namespace ReadDirectoryChangesPrivate;
+
+///////////////////////////////////////////////////////////////////////////
+// CReadDirectoryChanges
+
+CReadDirectoryChanges::CReadDirectoryChanges(int nMaxCount)
+	: m_nMaxChanges(nMaxCount)
+	, m_bOverflow(false)
+{
+	m_pServer	= new CInotifyServer(this);
+}
+
+CReadDirectoryChanges::~CReadDirectoryChanges()
+{
+	Terminate();
+	delete m_pServer;
+}
+
+void CReadDirectoryChanges::Init()
+{
+	m_Thread = std::thread(&CInotifyServer::Run, m_pServer);
+}
+
+void CReadDirectoryChanges::Terminate()
+{
+	if (m_Thread.joinable())
+	{
+		m_pServer->RequestTermination();
+		m_Thread.join();
+	}
+}
+
+void CReadDirectoryChanges::AddDirectory( const std::wstring& szDirectory, BOOL bWatchSubtree, DWORD dwNotifyFilter, DWORD /*dwBufferSize*/ )
+{
+	if (!m_Thread.joinable())
+		Init();
+
+	// The buffer size is only used by ReadDirectoryChangesW.
+	m_pServer->AddDirectory(szDirectory, bWatchSubtree != 0, dwNotifyFilter);
+}
+
+void CReadDirectoryChanges::Push( DWORD dwAction, const std::wstring &wstrFilename )
+{
+	std::unique_lock<std::mutex> lock(m_NotificationsMutex);
+
+	if (m_Notifications.size() >= m_nMaxChanges)
+	{
+		m_bOverflow = true;
+	}
+	else
+	{
+		m_Notifications.push_back(TDirectoryChangeNotification(dwAction, wstrFilename));
+	}
+
+	lock.unlock();
+	m_NotificationsCondition.notify_one();
+}
+
+bool CReadDirectoryChanges::Pop(DWORD& dwAction, std::wstring& wstrFilename)
+{
+	scoped_lock lock(m_NotificationsMutex);
+
+	if (m_Notifications.empty())
+		return false;
+
+	dwAction = m_Notifications.front().first;
+	wstrFilename = m_Notifications.front().second;
+	m_Notifications.pop_front();
+
+	return true;
+}
+
+bool CReadDirectoryChanges::Wait(DWORD dwMilliseconds)
+{
+	std::unique_lock<std::mutex> lock(m_NotificationsMutex);
+
+	return m_NotificationsCondition.wait_for(lock, std::chrono::milliseconds(dwMilliseconds), [this]()
+	{
+		return !m_Notifications.empty() || m_bOverflow;
+	});
+}
+
+bool CReadDirectoryChanges::CheckOverflow()
+{
+	scoped_lock lock(m_NotificationsMutex);
+
+	bool b = m_bOverflow;
+	if (b)
+	{
+		m_Notifications.clear();
+		m_bOverflow = false;
+	}
+	return b;
+}
+
+#endif
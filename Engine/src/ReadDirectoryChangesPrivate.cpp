@@ -28,6 +28,8 @@
 
 #include <EnginePCH.h>
 
+#if defined(_WIN32)
+
 #include "ReadDirectoryChanges.h"
 #include "ReadDirectoryChangesPrivate.h"
 
@@ -180,3 +182,5 @@ void CReadChangesRequest::ProcessNotification()
 }
 
 }
+
+#endif
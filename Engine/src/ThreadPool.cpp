@@ -0,0 +1,201 @@
+#include <EnginePCH.h>
+
+#include <ThreadPool.h>
+
+using namespace Core;
+
+namespace
+{
+    // The shared thread pool (see ThreadPool::Get and ThreadPool::Shutdown).
+    ThreadPool* gs_ThreadPool = nullptr;
+    std::mutex gs_ThreadPoolMutex;
+
+    // State that is shared between the thread that calls ParallelFor and the
+    // helper tasks that are pushed onto the queue. Helper tasks may start after
+    // ParallelFor has already returned so the state must be reference counted.
+    struct ParallelForState
+    {
+        std::atomic<uint32_t> NextChunk;
+        std::atomic<uint32_t> CompletedChunks;
+        std::atomic<bool> Failed;
+        uint32_t NumChunks;
+        uint32_t Begin;
+        uint32_t End;
+        uint32_t GrainSize;
+        ThreadPool::RangeFunction Func;
+
+        std::mutex Mutex;
+        std::condition_variable Done;
+        // The first exception that was thrown by Func.
+        std::exception_ptr Exception;
+
+        // Process chunks until there are no more chunks left.
+        // Chunks are always counted (even if Func throws) so the thread that
+        // called ParallelFor does not wait forever.
+        void Run()
+        {
+            uint32_t chunk;
+            while ( ( chunk = NextChunk.fetch_add( 1 ) ) < NumChunks )
+            {
+                uint32_t chunkBegin = Begin + chunk * GrainSize;
+                uint32_t chunkEnd = std::min( chunkBegin + GrainSize, End );
+
+                // The remaining chunks are skipped after an exception.
+                if ( !Failed.load() )
+                {
+                    try
+                    {
+                        Func( chunkBegin, chunkEnd );
+                    }
+                    catch ( ... )
+                    {
+                        scoped_lock lock( Mutex );
+                        if ( !Exception )
+                        {
+                            Exception = std::current_exception();
+                        }
+                        Failed = true;
+                    }
+                }
+
+                if ( CompletedChunks.fetch_add( 1 ) + 1 == NumChunks )
+                {
+                    scoped_lock lock( Mutex );
+                    Done.notify_all();
+                }
+            }
+        }
+    };
+}
+
+ThreadPool::ThreadPool( uint32_t numThreads )
+    : m_Stop( false )
+{
+    if ( numThreads == 0 )
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        numThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    m_Workers.reserve( numThreads );
+    for ( uint32_t i = 0; i < numThreads; ++i )
+    {
+        m_Workers.emplace_back( &ThreadPool::WorkerThread, this );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        scoped_lock lock( m_Mutex );
+        m_Stop = true;
+    }
+    m_Condition.notify_all();
+
+    for ( auto& worker : m_Workers )
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::Get()
+{
+    scoped_lock lock( gs_ThreadPoolMutex );
+    if ( !gs_ThreadPool )
+    {
+        gs_ThreadPool = new ThreadPool();
+    }
+
+    return *gs_ThreadPool;
+}
+
+void ThreadPool::Shutdown()
+{
+    scoped_lock lock( gs_ThreadPoolMutex );
+    delete gs_ThreadPool;
+    gs_ThreadPool = nullptr;
+}
+
+uint32_t ThreadPool::GetConcurrency() const
+{
+    return static_cast<uint32_t>( m_Workers.size() ) + 1;
+}
+
+std::future<void> ThreadPool::Enqueue( Task task )
+{
+    std::packaged_task<void()> packagedTask( std::move( task ) );
+    std::future<void> future = packagedTask.get_future();
+    {
+        scoped_lock lock( m_Mutex );
+        m_Tasks.push( std::move( packagedTask ) );
+    }
+    m_Condition.notify_one();
+
+    return future;
+}
+
+void ThreadPool::ParallelFor( uint32_t begin, uint32_t end, uint32_t grainSize, const RangeFunction& func )
+{
+    if ( end <= begin ) return;
+
+    grainSize = std::max( grainSize, 1u );
+    uint32_t numChunks = ( end - begin + grainSize - 1 ) / grainSize;
+
+    // Don't bother the worker threads for a single chunk.
+    if ( numChunks == 1 )
+    {
+        func( begin, end );
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->NextChunk = 0;
+    state->CompletedChunks = 0;
+    state->Failed = false;
+    state->NumChunks = numChunks;
+    state->Begin = begin;
+    state->End = end;
+    state->GrainSize = grainSize;
+    state->Func = func;
+
+    uint32_t numHelpers = std::min( numChunks - 1, static_cast<uint32_t>( m_Workers.size() ) );
+    {
+        scoped_lock lock( m_Mutex );
+        for ( uint32_t i = 0; i < numHelpers; ++i )
+        {
+            m_Tasks.emplace( [state]() { state->Run(); } );
+        }
+    }
+    m_Condition.notify_all();
+
+    // The calling thread also processes chunks.
+    state->Run();
+
+    std::unique_lock<std::mutex> lock( state->Mutex );
+    state->Done.wait( lock, [&state]() { return state->CompletedChunks.load() == state->NumChunks; } );
+
+    // All chunks are done, so none of the helpers still reference func.
+    if ( state->Exception )
+    {
+        std::rethrow_exception( state->Exception );
+    }
+}
+
+void ThreadPool::WorkerThread()
+{
+    while ( true )
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock( m_Mutex );
+            m_Condition.wait( lock, [this]() { return m_Stop || !m_Tasks.empty(); } );
+
+            if ( m_Stop && m_Tasks.empty() ) return;
+
+            task = std::move( m_Tasks.front() );
+            m_Tasks.pop();
+        }
+
+        task();
+    }
+}
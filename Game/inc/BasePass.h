@@ -3,6 +3,10 @@
 #include "AbstractPass.h"
 #include "ConstantBuffers.h"
 
+#include <Graphics/Frustum.h>
+#include <Graphics/RenderQueue.h>
+#include <Graphics/CPU/FrustumCullingCPU.h>
+
 namespace Graphics
 {
     class Camera;
@@ -12,11 +16,23 @@ namespace Graphics
 }
 
 // Base pass provides implementations for functions used by most passes.
+// The meshes of the scene are not rendered while the scene is visited. The visible
+// meshes are added to a render queue which is sorted before the meshes are rendered.
+// Consecutive draws of the same mesh are rendered as the instances of a single draw call.
 class BasePass : public AbstractPass
 {
 public:
     typedef AbstractPass base;
 
+    // The root parameter of the world transforms of the instances that are rendered
+    // (StructuredBuffer<InstanceData> Instances : register( t43 ) in the scene vertex shaders).
+    static const uint32_t InstanceBufferSlot = 4;
+    // The maximum number of draws that are rendered as the instances of a single draw call.
+    static const uint32_t MaxInstancesPerDraw = 4096;
+    // The instance data of the draw calls of the pass is uploaded in batches that fit
+    // in a single page of the upload heap (2 MB of 128 byte instances).
+    static const uint32_t MaxInstancesPerUpload = 16384;
+
     BasePass( std::shared_ptr<Graphics::Scene> scene, std::shared_ptr<Graphics::GraphicsPipelineState> pipeline, bool bUseMaterials = true, uint32_t instanceCount = 1, uint32_t firstInstance = 0 );
     virtual ~BasePass();
 
@@ -26,13 +42,50 @@ public:
     virtual void PostRender( Core::RenderEventArgs& e ) override;
 
     // Inherited from Visitor
+    // The meshes that are rendered by this pass are added to the draws of the pass.
     virtual void Visit( Graphics::Scene& scene ) override;
     virtual void Visit( Graphics::SceneNode& node ) override;
     virtual void Visit( Graphics::Mesh& mesh ) override;
 
+    // Returns true if the mesh is rendered by this pass (before frustum culling).
+    // By default, all meshes with a material are rendered.
+    virtual bool IsRendered( const Graphics::Mesh& mesh ) const;
+
+    // Bind the per object data of a scene node.
+    void BindSceneNode( Graphics::SceneNode& node );
     void BindMaterial( std::shared_ptr<Graphics::Material> pMaterial );
+    // Render a mesh of the current scene node.
+    // Only the meshlets of the mesh that are visible to the camera are rendered.
+    void RenderMesh( Graphics::Mesh& mesh );
+
+    // Statistics of the draws of the pass (since the statistics were reset).
+    struct RenderStatistics
+    {
+        // The number of meshes that passed and failed the frustum test.
+        uint32_t NumVisibleMeshes = 0;
+        uint32_t NumCulledMeshes = 0;
+        // The number of times a material was bound (redundant binds are skipped).
+        uint32_t NumMaterialBinds = 0;
+        // The number of draw calls of the meshes and the number of those
+        // draw calls that render more than one instance.
+        uint32_t NumDrawCalls = 0;
+        uint32_t NumInstancedDraws = 0;
+        // The number of transparent triangles that were sorted again (see TransparentPass)
+        // and the number of those triangles that were sorted by an incremental sort.
+        uint32_t NumSortedTriangles = 0;
+        uint32_t NumIncrementalSortedTriangles = 0;
+
+        // Add the statistics of another pass.
+        RenderStatistics& operator+=( const RenderStatistics& other );
+    };
+
+    const RenderStatistics& GetRenderStatistics() const;
+    void ResetRenderStatistics();
 
 protected:
+    // Cull the draws that were gathered while visiting the scene against the view
+    // frustum of the camera, sort the visible draws and render them.
+    void SubmitDraws();
 
     Core::RenderEventArgs* m_pRenderEventArgs;
 
@@ -51,4 +104,60 @@ protected:
     bool m_UseMaterials;
     uint32_t m_InstanceCount;
     uint32_t m_FirstInstance;
+
+    // Set to true if the pipeline culls back faces (so back-facing meshlets can be culled too).
+    bool m_CullBackFacingMeshlets;
+    // The view frustum and the camera position in the object space of the current scene node.
+    Graphics::Frustum m_ObjectFrustum;
+    glm::vec3 m_ObjectCameraPosition;
+    bool m_ObjectBackFaceCulling;
+    // The meshlets that passed the culling tests (reused for every mesh).
+    std::vector<uint32_t> m_VisibleMeshlets;
+
+    // A mesh of a scene node that is rendered by this pass.
+    struct Draw
+    {
+        Graphics::Mesh* Mesh;
+        Graphics::SceneNode* Node;
+        // The center of the world space bounds of the mesh.
+        glm::vec3 Center;
+    };
+
+    // Render a draw after the scene node, material and instance data of the draw are bound.
+    // By default, the visible meshlets of the mesh are rendered (see RenderMesh).
+    virtual void RenderDraw( const Draw& draw );
+    // Returns true if the draw can be rendered together with the draws of the same mesh
+    // that are next to it in the render queue. Draws that are rendered as instances
+    // are not rendered with RenderDraw, so their meshlets are not culled.
+    virtual bool CanInstance( const Draw& draw ) const;
+
+    // Consecutive draws in the render queue that are rendered with a single draw call.
+    struct DrawCall
+    {
+        // The range of the sorted draw indices of the render queue.
+        uint32_t FirstDraw;
+        uint32_t NumDraws;
+        // The range of the instance data of the draw call in m_Instances.
+        uint32_t FirstInstance;
+        uint32_t NumInstances;
+    };
+
+    // Write the world transforms of the draws of a draw call to the instance data of the pass.
+    void WriteInstances( const DrawCall& drawCall );
+
+    // The draws in the order they are visited.
+    std::vector<Draw> m_Draws;
+    // The scene node that is being visited.
+    Graphics::SceneNode* m_CurrentNode;
+    // The world space bounds of the draws.
+    Graphics::FrustumCullingCPU m_FrustumCulling;
+    std::vector<uint32_t> m_VisibilityMasks;
+    // Opaque passes sort front-to-back and transparent passes back-to-front.
+    Graphics::RenderQueue m_RenderQueue;
+    // The draw calls of the sorted draws and the instance data of all draw calls.
+    // The instance data is uploaded once and bound with an offset for each draw call.
+    std::vector<DrawCall> m_DrawCalls;
+    std::vector<InstanceData> m_Instances;
+
+    RenderStatistics m_RenderStatistics;
 };
\ No newline at end of file
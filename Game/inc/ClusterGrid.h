@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ConstantBuffers.h"
+
+namespace Graphics
+{
+    class Camera;
+}
+
+// For the light index lists for clustered rendering, we need to make a guess as to the 
+// average number of overlapping lights per cluster AABB. For clustered lighting we
+// can make a more conservative estimation than was possible with Forward+ 
+// since most cluster bounding volumes will not contain any samples and therefor 
+// no lights will be assigned to the cluster. For this experiment, I will make an 
+// estimate of an average of 20 lights per cluster. This may seem too conservative
+// but considering that only about 10-15% of all clusters will contain samples, this 
+// estimate seems reasonable.
+// The total size of the light index list is determined by the cluster grid size.
+// For 1080p screen resolution, 45 deg camera field of view, and a cluster block 
+// screen size of 64x64 pixels the cluster grid will have 30x17x193 (98,430) clusters
+// * 20 light indices * 4 bytes (to store a uint) will require 7,874,400 bytes (7.874 MB).
+const uint32_t AVERAGE_OVERLAPPING_LIGHTS_PER_CLUSTER = 20u;
+
+// Compute the dimensions of the cluster grid for the camera and screen resolution.
+// The depth of the cluster grid is dependent on the number of cluster subdivisions
+// in the screen Y direction.
+// Source: Clustered Deferred and Forward Shading (2012) (Ola Olsson, Markus Billeter, Ulf Assarsson).
+ClusterDataCB ComputeClusterData( const Graphics::Camera& camera, uint32_t screenWidth, uint32_t screenHeight, uint32_t clusterGridBlockSize );
+
+// The total number of clusters in the cluster grid.
+uint32_t GetNumClusters( const ClusterDataCB& clusterData );
+
+// The number of light indices to allocate for each of the cluster light index lists.
+// With exact light index lists, the light index lists start small and are grown
+// to the number of light indices that is actually required.
+uint32_t GetNumClusterLightIndices( const ClusterDataCB& clusterData, bool exactLightIndexLists );
@@ -18,6 +18,22 @@ public:
     std::wstring SceneFileName;
     std::wstring LoadingScreenFileName;
     float       SceneScaleFactor;
+    // Use the compact vertex format (see Graphics::Mesh::CompactVertex) for the scene.
+    bool        CompactVertices;
+    // Reorder the triangles of the scene to reduce overdraw when the scene is imported.
+    bool        OptimizeOverdraw;
+    // Sort the triangles of large transparent meshes (such as merged foliage cards) back-to-front
+    // instead of only sorting the meshes (see Graphics::TriangleSorterCPU).
+    bool        SortTransparentTriangles;
+    // Cook the textures of the scene: build the mip chains on the CPU and block compress
+    // the textures. The cooked textures are cached in DDS files next to the source images.
+    bool        CompressTextures;
+    // Use BC7 instead of BC1 and BC3 for the color textures of the scene.
+    bool        HighQualityTextureCompression;
+    // Stream the mip levels of the cooked textures (see Graphics::TextureStreamerDX12).
+    bool        StreamTextures;
+    // The memory budget for the streamed textures in megabytes.
+    uint32_t    TextureMemoryBudget;
 
     // Asset search paths.
     // Search paths are expressed relative to the configuration file.
@@ -28,6 +44,12 @@ public:
     float       CameraPivotDistance;
 
     // Lights
+    // Large light sets are stored in a binary light set file (see Graphics::LightSetFile)
+    // instead of the XML configuration file. The file name is relative to the configuration file.
+    // Only light sets with at most MaxXMLLights lights are stored in the XML file.
+    static const size_t MaxXMLLights = 64;
+    std::wstring LightSetFileName;
+
     std::vector<Graphics::PointLight> PointLights;
     std::vector<Graphics::SpotLight> SpotLights;
     std::vector<Graphics::DirectionalLight> DirectionalLights;
@@ -52,6 +74,9 @@ public:
 
     std::vector<fs::path> GetAbsoluteSearchPaths() const;
 
+    // The path of the light set file (relative to the working directory).
+    std::wstring GetLightSetFilePath() const;
+
 protected:
 
 private:
@@ -60,6 +85,9 @@ private:
     template<class Archive>
     void serialize( Archive& ar, const unsigned int version );
 
+    // Load the lights from the light set file.
+    bool LoadLightSet();
+
     // The file that is used to load/save this configuration.
     std::wstring m_Filename;
 
@@ -67,4 +95,4 @@ private:
 
 #include "ConfigurationSettings.inl"
 
-BOOST_CLASS_VERSION( ConfigurationSettings, 5 );
\ No newline at end of file
+BOOST_CLASS_VERSION( ConfigurationSettings, 11 );
\ No newline at end of file
@@ -26,9 +26,35 @@ void ConfigurationSettings::serialize( Archive& ar, const unsigned int version )
     }
 
     ar & BOOST_SERIALIZATION_NVP( SceneScaleFactor );
+    if ( version > 6 )
+    {
+        ar & BOOST_SERIALIZATION_NVP( CompactVertices );
+    }
+    if ( version > 7 )
+    {
+        ar & BOOST_SERIALIZATION_NVP( OptimizeOverdraw );
+    }
+    if ( version > 8 )
+    {
+        ar & BOOST_SERIALIZATION_NVP( CompressTextures );
+        ar & BOOST_SERIALIZATION_NVP( HighQualityTextureCompression );
+    }
+    if ( version > 9 )
+    {
+        ar & BOOST_SERIALIZATION_NVP( StreamTextures );
+        ar & BOOST_SERIALIZATION_NVP( TextureMemoryBudget );
+    }
+    if ( version > 10 )
+    {
+        ar & BOOST_SERIALIZATION_NVP( SortTransparentTriangles );
+    }
     ar & BOOST_SERIALIZATION_NVP( CameraPosition );
     ar & BOOST_SERIALIZATION_NVP( CameraRotation );
     ar & BOOST_SERIALIZATION_NVP( CameraPivotDistance );
+    if ( version > 5 )
+    {
+        ar & BOOST_SERIALIZATION_NVP( LightSetFileName );
+    }
     ar & BOOST_SERIALIZATION_NVP( PointLights );
     ar & BOOST_SERIALIZATION_NVP( SpotLights );
     ar & BOOST_SERIALIZATION_NVP( DirectionalLights );
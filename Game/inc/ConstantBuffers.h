@@ -42,6 +42,15 @@ struct alignas( 16 ) PerObjectCB
     glm::mat4 InverseTransposeModelView;
 };
 
+/**
+ * The world transforms of an instance of a mesh (see BasePass::SubmitDraws).
+ */
+struct alignas( 16 ) InstanceData
+{
+    glm::mat4 Model;    // Includes the position transform of the mesh.
+    glm::mat4 InverseTransposeModel;
+};
+
 struct alignas(4) LightCountsCB
 {
     uint32_t NumPointLights;
@@ -116,3 +125,18 @@ struct alignas(4) BVHParams
     uint32_t SpotLightLevels;   // Number of levels in the BVH for spot lights.
     uint32_t ChildLevel;        // The level of the child nodes in the BVH that is being computed.
 };
+
+/**
+ * Z-bin and screen tile parameters for Z-binned rendering.
+ */
+struct alignas(4) ZBinParamsCB
+{
+    float ZNear;                    // The view space depth of the first Z-bin (the near clipping plane).
+    float InvBinDepth;              // 1.0f / ( view space depth of a single Z-bin ).
+    uint32_t NumZBins;              // The number of Z-bins between the near and far clipping planes.
+    uint32_t TileSize;              // The size of a screen tile (in pixels).
+    uint32_t NumTilesX;             // The number of screen tiles in the X direction.
+    uint32_t NumTiles;              // The total number of screen tiles.
+    uint32_t NumPointLightWords;    // The number of 32-bit words in the point light bitmask of a single tile.
+    uint32_t NumSpotLightWords;     // The number of 32-bit words in the spot light bitmask of a single tile.
+};
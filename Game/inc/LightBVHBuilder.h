@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ConstantBuffers.h"
+
+namespace Graphics
+{
+    class Device;
+    class ComputeCommandBuffer;
+    class ComputePipelineState;
+    class CopyCommandBuffer;
+    class StructuredBuffer;
+}
+
+// The number of threads per thread group (for Radix sort and Merge sort).
+const uint32_t SORT_NUM_THREADS_PER_THREAD_GROUP = 256;
+
+// The number of elements that each merge sort thread will sort.
+const uint32_t SORT_ELEMENTS_PER_THREAD = 8;
+
+// The number of threads per thread group of the BuildBVH compute shaders.
+const uint32_t BVH_NUM_THREADS = 32 * 16;
+
+/**
+ * Builds the light BVHs for the point and spot lights on the GPU:
+ * reduce the lights AABB, compute the light Morton codes, sort the Morton codes
+ * (radix sort + merge sort) and build the BVH bottom-up.
+ *
+ * The Game and ClusterBench both use this class so the shaders, the sort
+ * constants and the buffer sizes cannot get out of sync.
+ *
+ * The key buffers store the Morton codes of the lights when building the BVH
+ * but any keys (for example the light depth keys for Z-binning) can be written
+ * to the key buffers and sorted with SortKeys.
+ */
+class LightBVHBuilder
+{
+public:
+    LightBVHBuilder( std::shared_ptr<Graphics::Device> device );
+    virtual ~LightBVHBuilder();
+
+    // Load the compute shaders. The 30-bit and the 63-bit Morton code versions
+    // of the Morton code and sort shaders are both loaded so switching between
+    // them does not require the shaders to be reloaded.
+    void LoadShaders();
+
+    // Use 63-bit Morton codes (21 bits per axis) instead of 30-bit Morton codes.
+    // The key buffers are recreated if the buffers have already been created.
+    void SetUse64BitMortonCodes( bool use64BitMortonCodes );
+    bool GetUse64BitMortonCodes() const;
+
+    // (Re)create the buffers that depend on the number of lights.
+    void SetNumLights( std::shared_ptr<Graphics::CopyCommandBuffer> commandBuffer, uint32_t numPointLights, uint32_t numSpotLights );
+
+    // Build the point and spot light BVHs.
+    void Build( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                std::shared_ptr<Graphics::StructuredBuffer> pointLights, std::shared_ptr<Graphics::StructuredBuffer> spotLights );
+
+    void ReduceLightsAABB( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                           std::shared_ptr<Graphics::StructuredBuffer> pointLights, std::shared_ptr<Graphics::StructuredBuffer> spotLights );
+    void ComputeMortonCodes( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                             std::shared_ptr<Graphics::StructuredBuffer> pointLights, std::shared_ptr<Graphics::StructuredBuffer> spotLights );
+    // Sort the keys in the key buffers together with the light indices.
+    void SortKeys( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts );
+    void BuildBVH( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                   std::shared_ptr<Graphics::StructuredBuffer> pointLights, std::shared_ptr<Graphics::StructuredBuffer> spotLights );
+
+    std::shared_ptr<Graphics::StructuredBuffer> GetLightsAABB() const;
+    std::shared_ptr<Graphics::StructuredBuffer> GetPointLightKeys() const;
+    std::shared_ptr<Graphics::StructuredBuffer> GetSpotLightKeys() const;
+    std::shared_ptr<Graphics::StructuredBuffer> GetPointLightIndices() const;
+    std::shared_ptr<Graphics::StructuredBuffer> GetSpotLightIndices() const;
+    std::shared_ptr<Graphics::StructuredBuffer> GetPointLightBVH() const;
+    std::shared_ptr<Graphics::StructuredBuffer> GetSpotLightBVH() const;
+
+private:
+    void CreateKeyBuffers( std::shared_ptr<Graphics::CopyCommandBuffer> commandBuffer );
+
+    void MergeSort( std::shared_ptr<Graphics::ComputeCommandBuffer> commandBuffer,
+                    std::shared_ptr<Graphics::StructuredBuffer> srcKeys, std::shared_ptr<Graphics::StructuredBuffer> srcValues,
+                    std::shared_ptr<Graphics::StructuredBuffer> dstKeys, std::shared_ptr<Graphics::StructuredBuffer> dstValues,
+                    uint32_t totalValues, uint32_t chunkSize );
+
+    std::shared_ptr<Graphics::Device> m_Device;
+
+    bool m_Use64BitMortonCodes;
+
+    uint32_t m_NumPointLights;
+    uint32_t m_NumSpotLights;
+
+    std::shared_ptr<Graphics::StructuredBuffer> m_LightsAABB;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightKeys;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightIndices;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightKeys_OUT;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightIndices_OUT;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightKeys;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightIndices;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightKeys_OUT;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightIndices_OUT;
+    std::shared_ptr<Graphics::StructuredBuffer> m_MergePathPartitions;
+    std::shared_ptr<Graphics::StructuredBuffer> m_PointLightBVH;
+    std::shared_ptr<Graphics::StructuredBuffer> m_SpotLightBVH;
+
+    std::shared_ptr<Graphics::ComputePipelineState> m_ReduceLightsAABB1PSO;         // 1st pass of lights AABB reduction.
+    std::shared_ptr<Graphics::ComputePipelineState> m_ReduceLightsAABB2PSO;         // 2nd pass of lights AABB reduction.
+    std::shared_ptr<Graphics::ComputePipelineState> m_ComputeLightMortonCodesPSO;   // Compute Morton codes for point and spot lights.
+    std::shared_ptr<Graphics::ComputePipelineState> m_RadixSortPSO;                 // Perform a radix sort over the keys.
+    std::shared_ptr<Graphics::ComputePipelineState> m_MergePathPartitionsPSO;       // Compute merge path partitions for merge sort.
+    std::shared_ptr<Graphics::ComputePipelineState> m_MergeSortPSO;                 // Merge sort compute shader.
+    std::shared_ptr<Graphics::ComputePipelineState> m_ComputeLightMortonCodes64PSO; // 64-bit Morton code version of m_ComputeLightMortonCodesPSO.
+    std::shared_ptr<Graphics::ComputePipelineState> m_RadixSort64PSO;               // 64-bit Morton code version of m_RadixSortPSO.
+    std::shared_ptr<Graphics::ComputePipelineState> m_MergePathPartitions64PSO;     // 64-bit Morton code version of m_MergePathPartitionsPSO.
+    std::shared_ptr<Graphics::ComputePipelineState> m_MergeSort64PSO;               // 64-bit Morton code version of m_MergeSortPSO.
+    std::shared_ptr<Graphics::ComputePipelineState> m_BuildBVHBottomPSO;            // Build bottom BVH compute pipeline state.
+    std::shared_ptr<Graphics::ComputePipelineState> m_BuildBVHTopPSO;               // Build top BVH compute pipeline state.
+};
@@ -2,17 +2,52 @@
 
 #include "BasePass.h"
 
-// A pass that renders the opaque geometry in the scene.
+#include <Graphics/CPU/TriangleSorterCPU.h>
+
+namespace Graphics
+{
+    class IndexBuffer;
+}
+
+// A pass that renders the transparent geometry in the scene.
+// The meshes are rendered back-to-front. The triangles of meshes that keep a copy
+// of their triangles on the CPU (see Graphics::Mesh::SetTriangles) are sorted back-to-front too.
 class TransparentPass : public BasePass
 {
 public:
     typedef BasePass base;
 
+    // The triangles of a mesh are sorted again when the camera moved more than
+    // this fraction of the radius of the mesh since the last sort.
+    static const float TriangleSortThreshold;
+
     TransparentPass( std::shared_ptr<Graphics::Scene> scene, std::shared_ptr<Graphics::GraphicsPipelineState> pipeline, bool bUseMaterials = true, uint32_t instanceCount = 1, uint32_t firstInstance = 0 );
     virtual ~TransparentPass();
 
-    virtual void Visit( Graphics::Mesh& mesh );
+    virtual bool IsRendered( const Graphics::Mesh& mesh ) const override;
+
+    // The sorted triangles of the meshes that were not rendered in this frame are released after the pass is rendered.
+    virtual void Render( Core::RenderEventArgs& e ) override;
 protected:
+    virtual void RenderDraw( const Draw& draw ) override;
+    virtual bool CanInstance( const Draw& draw ) const override;
 
 private:
+    // The sorted triangles of a mesh of a scene node.
+    struct TriangleSorterEntry
+    {
+        // Expires if the scene node is destroyed (for example, if the scene is loaded again)
+        // so the sorted triangles are not reused by a scene node at the same address.
+        std::weak_ptr<const Graphics::SceneNode> Node;
+        Graphics::TriangleSorterCPU TriangleSorter;
+        // The sorted indices on the GPU. Created when the order of the triangles didn't change
+        // since the previous frame and released when the order changes again.
+        std::shared_ptr<Graphics::IndexBuffer> IndexBuffer;
+        // The frame in which the sorted triangles were last rendered.
+        uint64_t LastFrame = 0;
+    };
+
+    // The sorted triangles of each mesh of each scene node.
+    using TriangleSorterKey = std::pair<const Graphics::Mesh*, const Graphics::SceneNode*>;
+    std::map<TriangleSorterKey, TriangleSorterEntry> m_TriangleSorters;
 };
\ No newline at end of file
@@ -3,8 +3,10 @@
 #include <Graphics/Camera.h>
 #include <Graphics/SceneNode.h>
 #include <Graphics/Mesh.h>
+#include <Graphics/MeshletBuilder.h>
 #include <Graphics/Material.h>
 #include <Graphics/GraphicsPipelineState.h>
+#include <Graphics/RasterizerState.h>
 #include <Graphics/GraphicsCommandBuffer.h>
 #include <Graphics/ShaderParameter.h>
 #include <Graphics/Texture.h>
@@ -15,12 +17,19 @@
 
 using namespace Graphics;
 
+static_assert( BasePass::MaxInstancesPerUpload * sizeof( InstanceData ) <= 2 * 1024 * 1024, "The instances of an upload must fit in a page of the upload heap." );
+static_assert( BasePass::MaxInstancesPerDraw <= BasePass::MaxInstancesPerUpload, "The instances of a draw call must fit in a single upload." );
+
 BasePass::BasePass( std::shared_ptr<Graphics::Scene> scene, std::shared_ptr<Graphics::GraphicsPipelineState> pipeline, bool bUseMaterials, uint32_t instanceCount, uint32_t firstInstance )
     : m_Scene( scene )
     , m_Pipeline( pipeline )
     , m_UseMaterials( bUseMaterials )
     , m_InstanceCount( instanceCount )
     , m_FirstInstance( firstInstance )
+    , m_CullBackFacingMeshlets( false )
+    , m_ObjectCameraPosition( 0 )
+    , m_ObjectBackFaceCulling( false )
+    , m_CurrentNode( nullptr )
 {
 }
 
@@ -37,13 +46,23 @@ void BasePass::PreRender( Core::RenderEventArgs& e )
     {
         m_GraphicsCommandBuffer->BindGraphicsPipelineState( m_Pipeline );
     }
+
+    m_CullBackFacingMeshlets = m_Pipeline &&
+                               m_Pipeline->GetRasterizerState().GetCullMode() == CullMode::Back &&
+                               m_Pipeline->GetRasterizerState().GetFrontFacing() == FrontFace::CounterClockwise;
 }
 
 void BasePass::Render( Core::RenderEventArgs& e )
 {
     if ( m_Scene )
     {
+        m_Draws.clear();
+        m_FrustumCulling.Clear();
+        m_CurrentNode = nullptr;
+
         m_Scene->Accept( *this );
+
+        SubmitDraws();
     }
 }
 
@@ -61,6 +80,208 @@ void BasePass::Visit( Graphics::Scene& scene )
 }
 
 void BasePass::Visit( Graphics::SceneNode& node )
+{
+    m_CurrentNode = &node;
+}
+
+void BasePass::Visit( Graphics::Mesh& mesh )
+{
+    if ( IsRendered( mesh ) )
+    {
+        Draw draw = { &mesh, m_CurrentNode, glm::vec3( 0 ) };
+        BoundingBox bounds;
+        if ( m_CurrentNode )
+        {
+            const glm::mat4& worldTransform = m_CurrentNode->GetWorldTransform();
+            bounds = mesh.GetBounds().Transform( worldTransform );
+            // Meshes without bounds are sorted by the origin of the scene node.
+            draw.Center = bounds.IsValid() ? bounds.GetCenter() : glm::vec3( worldTransform[3] );
+        }
+
+        m_Draws.push_back( draw );
+        // Meshes without bounds are never culled.
+        m_FrustumCulling.AddBoundingBox( bounds );
+    }
+}
+
+bool BasePass::IsRendered( const Graphics::Mesh& mesh ) const
+{
+    return mesh.GetMaterial() != nullptr;
+}
+
+void BasePass::SubmitDraws()
+{
+    // Instances are positioned by the shaders so they can't be culled with the bounds of the mesh.
+    bool cullDraws = m_Camera && m_InstanceCount == 1;
+    if ( cullDraws )
+    {
+        Frustum frustum( m_Camera->GetProjectionMatrix() * m_Camera->GetViewMatrix() );
+        uint32_t numVisible = m_FrustumCulling.Cull( frustum, m_VisibilityMasks );
+
+        m_RenderStatistics.NumVisibleMeshes += numVisible;
+        m_RenderStatistics.NumCulledMeshes += m_FrustumCulling.GetNumBoundingBoxes() - numVisible;
+    }
+
+    glm::mat4 viewMatrix( 1.0f );
+    if ( m_Camera )
+    {
+        viewMatrix = m_Camera->GetViewMatrix();
+        m_RenderQueue.SetDepthRange( m_Camera->GetNearClipPlane(), m_Camera->GetFarClipPlane() );
+    }
+
+    m_RenderQueue.Clear();
+    for ( uint32_t i = 0; i < static_cast<uint32_t>( m_Draws.size() ); ++i )
+    {
+        if ( cullDraws && !FrustumCullingCPU::IsVisible( m_VisibilityMasks, i ) )
+        {
+            continue;
+        }
+
+        const Draw& draw = m_Draws[i];
+        // The camera looks down the negative z-axis in view space.
+        float depth = -( viewMatrix * glm::vec4( draw.Center, 1.0f ) ).z;
+
+        m_RenderQueue.Push( m_Pipeline.get(), draw.Mesh->GetMaterial().get(), draw.Mesh, depth, i );
+    }
+
+    m_RenderQueue.Sort();
+
+    const uint32_t* drawIndices = m_RenderQueue.GetDrawIndices();
+    const uint32_t numDraws = m_RenderQueue.GetNumDraws();
+
+    // The render queue sorts the draws of a mesh next to each other (within a depth slice),
+    // so consecutive draws of the same mesh are rendered with a single draw call.
+    m_DrawCalls.clear();
+    uint32_t numInstances = 0;
+    for ( uint32_t i = 0; i < numDraws; )
+    {
+        const Draw& draw = m_Draws[drawIndices[i]];
+
+        uint32_t numInstancedDraws = 1;
+        if ( CanInstance( draw ) )
+        {
+            while ( i + numInstancedDraws < numDraws && numInstancedDraws < MaxInstancesPerDraw )
+            {
+                const Draw& nextDraw = m_Draws[drawIndices[i + numInstancedDraws]];
+                if ( nextDraw.Mesh != draw.Mesh || !CanInstance( nextDraw ) )
+                {
+                    break;
+                }
+                ++numInstancedDraws;
+            }
+        }
+
+        // The shaders index the instances with SV_InstanceID which doesn't include the first instance
+        // of the draw call. The instances of the pass use the transforms of the draw.
+        DrawCall drawCall = { i, numInstancedDraws, numInstances, std::max( numInstancedDraws, m_InstanceCount ) };
+        assert( drawCall.NumInstances <= MaxInstancesPerUpload );
+
+        m_DrawCalls.push_back( drawCall );
+        numInstances += drawCall.NumInstances;
+        i += numInstancedDraws;
+    }
+
+    if ( m_GraphicsCommandBuffer )
+    {
+        m_Instances.resize( numInstances );
+        for ( const DrawCall& drawCall : m_DrawCalls )
+        {
+            WriteInstances( drawCall );
+        }
+    }
+
+    // The instance data of the draw calls is uploaded in batches instead of once per draw call.
+    // A new batch starts at the first draw call that doesn't fit in the current batch.
+    D3D12_GPU_VIRTUAL_ADDRESS instancesAddress = 0;
+    uint32_t firstUploadedInstance = 0;
+    uint32_t numUploadedInstances = 0;
+
+    // Only bind the scene nodes and materials that differ from the previous draw.
+    Graphics::SceneNode* pBoundNode = nullptr;
+    Graphics::Material* pBoundMaterial = nullptr;
+    for ( const DrawCall& drawCall : m_DrawCalls )
+    {
+        const Draw& draw = m_Draws[drawIndices[drawCall.FirstDraw]];
+
+        // The per object data of the scene node only provides the camera matrices to the
+        // vertex shaders of the instances.
+        if ( draw.Node && draw.Node != pBoundNode )
+        {
+            BindSceneNode( *draw.Node );
+            pBoundNode = draw.Node;
+        }
+
+        std::shared_ptr<Graphics::Material> pMaterial = draw.Mesh->GetMaterial();
+        if ( pMaterial.get() != pBoundMaterial )
+        {
+            BindMaterial( pMaterial );
+            pBoundMaterial = pMaterial.get();
+            ++m_RenderStatistics.NumMaterialBinds;
+        }
+
+        if ( m_GraphicsCommandBuffer )
+        {
+            if ( drawCall.FirstInstance + drawCall.NumInstances > firstUploadedInstance + numUploadedInstances )
+            {
+                firstUploadedInstance = drawCall.FirstInstance;
+                numUploadedInstances = numInstances - firstUploadedInstance;
+                if ( numUploadedInstances > MaxInstancesPerUpload )
+                {
+                    numUploadedInstances = MaxInstancesPerUpload;
+                }
+                instancesAddress = m_GraphicsCommandBuffer->UploadDynamicStructuredBuffer( numUploadedInstances, sizeof( InstanceData ), m_Instances.data() + firstUploadedInstance );
+            }
+
+            m_GraphicsCommandBuffer->BindGraphicsShaderResourceView( InstanceBufferSlot, instancesAddress + ( drawCall.FirstInstance - firstUploadedInstance ) * sizeof( InstanceData ) );
+        }
+
+        if ( drawCall.NumDraws == 1 )
+        {
+            RenderDraw( draw );
+        }
+        else
+        {
+            draw.Mesh->Render( *m_pRenderEventArgs, drawCall.NumDraws );
+            ++m_RenderStatistics.NumInstancedDraws;
+        }
+
+        ++m_RenderStatistics.NumDrawCalls;
+    }
+}
+
+void BasePass::RenderDraw( const Draw& draw )
+{
+    RenderMesh( *draw.Mesh );
+}
+
+bool BasePass::CanInstance( const Draw& draw ) const
+{
+    // Instances of the pass are positioned by the shaders, so each draw needs its own draw call.
+    return draw.Node != nullptr && m_InstanceCount == 1;
+}
+
+void BasePass::WriteInstances( const DrawCall& drawCall )
+{
+    const uint32_t* drawIndices = m_RenderQueue.GetDrawIndices() + drawCall.FirstDraw;
+
+    for ( uint32_t i = 0; i < drawCall.NumInstances; ++i )
+    {
+        const Draw& draw = m_Draws[drawIndices[std::min( i, drawCall.NumDraws - 1 )]];
+        InstanceData& instance = m_Instances[drawCall.FirstInstance + i];
+
+        instance.Model = draw.Node ? draw.Node->GetWorldTransform() : glm::mat4( 1.0f );
+        instance.InverseTransposeModel = draw.Node ? draw.Node->GetInverseTransposeWorldTransform() : glm::mat4( 1.0f );
+
+        // Compact vertex positions are relative to the bounds of the mesh. The position
+        // transform is only applied to the matrix that transforms the positions.
+        if ( draw.Mesh->GetVertexFormat() == Mesh::VertexFormat::Compact )
+        {
+            instance.Model = instance.Model * draw.Mesh->GetPositionTransform();
+        }
+    }
+}
+
+void BasePass::BindSceneNode( Graphics::SceneNode& node )
 {
     if ( m_Camera && m_GraphicsCommandBuffer )
     {
@@ -72,21 +293,16 @@ void BasePass::Visit( Graphics::SceneNode& node )
         perObjectData.Projection = m_Camera->GetProjectionMatrix();
         perObjectData.ModelView = perObjectData.View * perObjectData.Model;
         perObjectData.ModelViewProjection = perObjectData.Projection * perObjectData.ModelView;
-        perObjectData.InverseTransposeModel = glm::inverseTranspose( perObjectData.Model );
+        perObjectData.InverseTransposeModel = node.GetInverseTransposeWorldTransform();
         perObjectData.InverseTransposeModelView = perObjectData.View * perObjectData.InverseTransposeModel;
 
         m_GraphicsCommandBuffer->BindGraphicsDynamicConstantBuffer( 0, perObjectData );
-    }
-}
 
-void BasePass::Visit( Graphics::Mesh& mesh )
-{
-    std::shared_ptr<Graphics::Material> pMaterial = mesh.GetMaterial();
-
-    if ( pMaterial )
-    {
-        BindMaterial( pMaterial );
-        mesh.Render( *m_pRenderEventArgs, m_InstanceCount, m_FirstInstance );
+        // The meshlets are culled in object space.
+        m_ObjectFrustum = Frustum( perObjectData.ModelViewProjection );
+        m_ObjectCameraPosition = glm::vec3( glm::transpose( perObjectData.InverseTransposeModel ) * perObjectData.InverseView[3] );
+        // Mirrored nodes flip the winding order of the triangles.
+        m_ObjectBackFaceCulling = m_CullBackFacingMeshlets && glm::determinant( glm::mat3( perObjectData.Model ) ) > 0.0f;
     }
 }
 
@@ -108,3 +324,49 @@ void BasePass::BindMaterial( std::shared_ptr<Graphics::Material> pMaterial )
         m_GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 0, ShaderArguments( textureArguments, textureArguments + numTextures ) );
     }
 }
+
+void BasePass::RenderMesh( Graphics::Mesh& mesh )
+{
+    const std::vector<Meshlet>& meshlets = mesh.GetMeshlets();
+
+    // Instances are positioned by the shaders so they can't be culled with the bounds of the mesh.
+    if ( meshlets.empty() || m_InstanceCount != 1 || !m_Camera )
+    {
+        mesh.Render( *m_pRenderEventArgs, m_InstanceCount, m_FirstInstance );
+        return;
+    }
+
+    MeshletBuilder::Cull( meshlets.data(), meshlets.size(), m_ObjectFrustum, m_ObjectCameraPosition, m_ObjectBackFaceCulling, m_VisibleMeshlets );
+
+    if ( m_VisibleMeshlets.size() == meshlets.size() )
+    {
+        mesh.Render( *m_pRenderEventArgs, m_InstanceCount, m_FirstInstance );
+    }
+    else if ( !m_VisibleMeshlets.empty() )
+    {
+        mesh.RenderMeshlets( *m_pRenderEventArgs, m_VisibleMeshlets.data(), m_VisibleMeshlets.size(), m_InstanceCount, m_FirstInstance );
+    }
+}
+
+BasePass::RenderStatistics& BasePass::RenderStatistics::operator+=( const RenderStatistics& other )
+{
+    NumVisibleMeshes += other.NumVisibleMeshes;
+    NumCulledMeshes += other.NumCulledMeshes;
+    NumMaterialBinds += other.NumMaterialBinds;
+    NumDrawCalls += other.NumDrawCalls;
+    NumInstancedDraws += other.NumInstancedDraws;
+    NumSortedTriangles += other.NumSortedTriangles;
+    NumIncrementalSortedTriangles += other.NumIncrementalSortedTriangles;
+
+    return *this;
+}
+
+const BasePass::RenderStatistics& BasePass::GetRenderStatistics() const
+{
+    return m_RenderStatistics;
+}
+
+void BasePass::ResetRenderStatistics()
+{
+    m_RenderStatistics = RenderStatistics();
+}
@@ -0,0 +1,46 @@
+#include <GamePCH.h>
+#include <EngineIncludes.h>
+
+#include <ClusterGrid.h>
+
+using namespace Graphics;
+
+ClusterDataCB ComputeClusterData( const Camera& camera, uint32_t screenWidth, uint32_t screenHeight, uint32_t clusterGridBlockSize )
+{
+    // The half-angle of the field of view in the Y-direction.
+    float fieldOfViewY = glm::radians( camera.GetFOV() * 0.5f );
+    float zNear = camera.GetNearClipPlane();
+    float zFar = camera.GetFarClipPlane();
+
+    // Number of clusters in the screen X direction.
+    uint32_t clusterDimX = static_cast<uint32_t>( glm::ceil( screenWidth / (float)clusterGridBlockSize ) );
+    // Number of clusters in the screen Y direction.
+    uint32_t clusterDimY = static_cast<uint32_t>( glm::ceil( screenHeight / (float)clusterGridBlockSize ) );
+
+    float sD = 2.0f * glm::tan( fieldOfViewY ) / (float)clusterDimY;
+    float logDimY = 1.0f / glm::log( 1.0f + sD );
+
+    float logDepth = glm::log( zFar / zNear );
+    uint32_t clusterDimZ = static_cast<uint32_t>( glm::floor( logDepth * logDimY ) );
+
+    ClusterDataCB clusterData = {};
+    clusterData.GridDim = glm::uvec3( clusterDimX, clusterDimY, clusterDimZ );
+    clusterData.ViewNear = zNear;
+    clusterData.Size = glm::uvec2( clusterGridBlockSize, clusterGridBlockSize );
+    clusterData.NearK = 1.0f + sD;
+    clusterData.LogGridDimY = logDimY;
+
+    return clusterData;
+}
+
+uint32_t GetNumClusters( const ClusterDataCB& clusterData )
+{
+    return clusterData.GridDim.x * clusterData.GridDim.y * clusterData.GridDim.z;
+}
+
+uint32_t GetNumClusterLightIndices( const ClusterDataCB& clusterData, bool exactLightIndexLists )
+{
+    uint32_t numClusters = GetNumClusters( clusterData );
+
+    return exactLightIndexLists ? numClusters : numClusters * AVERAGE_OVERLAPPING_LIGHTS_PER_CLUSTER;
+}
@@ -2,6 +2,8 @@
 
 #include <ConfigurationSettings.h>
 
+#include <Graphics/LightSetFile.h>
+
 using boost::serialization::make_nvp;
 
 ConfigurationSettings::ConfigurationSettings()
@@ -13,6 +15,13 @@ ConfigurationSettings::ConfigurationSettings()
     , SceneFileName( L"" )
     , LoadingScreenFileName( L"" )
     , SceneScaleFactor( 1.0f )
+    , CompactVertices( false )
+    , OptimizeOverdraw( false )
+    , SortTransparentTriangles( false )
+    , CompressTextures( true )
+    , HighQualityTextureCompression( false )
+    , StreamTextures( true )
+    , TextureMemoryBudget( 1024 )
     , CameraPosition( 0.0f )
     , CameraRotation()
     // Light generation properties.
@@ -40,15 +49,40 @@ bool ConfigurationSettings::Load( const std::wstring& fileName )
     {
         m_Filename = fileName;
 
+        // Older configuration files store all of the lights in the XML file.
+        LightSetFileName.clear();
+
         boost::archive::xml_iarchive ia( configInputStream );
         ia >> make_nvp( "ConfigurationSettings", *this );
 
+        if ( !LightSetFileName.empty() )
+        {
+            return LoadLightSet();
+        }
+
         return true;
     }
 
     return false;
 }
 
+bool ConfigurationSettings::LoadLightSet()
+{
+    Graphics::LightSetFile lightSet;
+    if ( !lightSet.Open( GetLightSetFilePath() ) )
+    {
+        return false;
+    }
+
+    // The lights in the file have the same layout as the light structures
+    // so they are copied as a whole without parsing the individual lights.
+    PointLights.assign( lightSet.GetPointLights(), lightSet.GetPointLights() + lightSet.GetNumPointLights() );
+    SpotLights.assign( lightSet.GetSpotLights(), lightSet.GetSpotLights() + lightSet.GetNumSpotLights() );
+    DirectionalLights.assign( lightSet.GetDirectionalLights(), lightSet.GetDirectionalLights() + lightSet.GetNumDirectionalLights() );
+
+    return true;
+}
+
 bool ConfigurationSettings::Reload()
 {
     if ( !m_Filename.empty() )
@@ -66,16 +100,60 @@ bool ConfigurationSettings::Save( const std::wstring& fileName )
         m_Filename = fileName;
     }
 
+    size_t numLights = PointLights.size() + SpotLights.size() + DirectionalLights.size();
+    bool useLightSetFile = numLights > MaxXMLLights;
+
+    std::vector<Graphics::PointLight> pointLights;
+    std::vector<Graphics::SpotLight> spotLights;
+    std::vector<Graphics::DirectionalLight> directionalLights;
+
+    if ( useLightSetFile )
+    {
+        // Store the lights next to the configuration file.
+        LightSetFileName = fs::path( m_Filename ).filename().replace_extension( L".lights" ).wstring();
+
+        if ( !Graphics::LightSetFile::Save( GetLightSetFilePath(),
+                                            PointLights.data(), static_cast<uint32_t>( PointLights.size() ),
+                                            SpotLights.data(), static_cast<uint32_t>( SpotLights.size() ),
+                                            DirectionalLights.data(), static_cast<uint32_t>( DirectionalLights.size() ) ) )
+        {
+            return false;
+        }
+
+        // Don't write the lights to the XML file.
+        pointLights.swap( PointLights );
+        spotLights.swap( SpotLights );
+        directionalLights.swap( DirectionalLights );
+    }
+    else
+    {
+        LightSetFileName.clear();
+    }
+
+    bool result = false;
+
     std::ofstream configOutputStream( m_Filename, std::ios::out );
     if ( configOutputStream.is_open() )
     {
         boost::archive::xml_oarchive oa( configOutputStream );
         oa << make_nvp( "ConfigurationSettings", *this );
 
-        return true;
+        result = true;
     }
 
-    return false;
+    if ( useLightSetFile )
+    {
+        pointLights.swap( PointLights );
+        spotLights.swap( SpotLights );
+        directionalLights.swap( DirectionalLights );
+    }
+
+    return result;
+}
+
+std::wstring ConfigurationSettings::GetLightSetFilePath() const
+{
+    return ( fs::path( m_Filename ).parent_path() / LightSetFileName ).wstring();
 }
 
 std::vector<fs::path> ConfigurationSettings::GetAbsoluteSearchPaths() const
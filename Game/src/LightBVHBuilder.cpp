@@ -0,0 +1,551 @@
+#include <GamePCH.h>
+#include <EngineIncludes.h>
+
+#include <LightBVHBuilder.h>
+#include <Graphics/CPU/LightBVHCPU.h>
+
+using namespace Graphics;
+
+LightBVHBuilder::LightBVHBuilder( std::shared_ptr<Device> device )
+    : m_Device( device )
+    , m_Use64BitMortonCodes( false )
+    , m_NumPointLights( 0 )
+    , m_NumSpotLights( 0 )
+{
+    m_ReduceLightsAABB1PSO = m_Device->CreateComputePipelineState();
+    m_ReduceLightsAABB2PSO = m_Device->CreateComputePipelineState();
+    m_ComputeLightMortonCodesPSO = m_Device->CreateComputePipelineState();
+    m_RadixSortPSO = m_Device->CreateComputePipelineState();
+    m_MergePathPartitionsPSO = m_Device->CreateComputePipelineState();
+    m_MergeSortPSO = m_Device->CreateComputePipelineState();
+    m_ComputeLightMortonCodes64PSO = m_Device->CreateComputePipelineState();
+    m_RadixSort64PSO = m_Device->CreateComputePipelineState();
+    m_MergePathPartitions64PSO = m_Device->CreateComputePipelineState();
+    m_MergeSort64PSO = m_Device->CreateComputePipelineState();
+    m_BuildBVHBottomPSO = m_Device->CreateComputePipelineState();
+    m_BuildBVHTopPSO = m_Device->CreateComputePipelineState();
+}
+
+LightBVHBuilder::~LightBVHBuilder()
+{}
+
+void LightBVHBuilder::LoadShaders()
+{
+    // Setup a compute pipeline state object to reduce the lights AABB.
+    auto reduceLightsAABB1CS = m_Device->CreateShader();
+    reduceLightsAABB1CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ReduceLightsAABB_CS.hlsl", "reduce1" );
+    m_ReduceLightsAABB1PSO->SetShader( reduceLightsAABB1CS );
+
+    auto reduceLightsAABB2CS = m_Device->CreateShader();
+    reduceLightsAABB2CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ReduceLightsAABB_CS.hlsl", "reduce2" );
+    m_ReduceLightsAABB2PSO->SetShader( reduceLightsAABB2CS );
+
+    // Setup a compute pipeline state to compute the light Morton codes.
+    auto computeLightMortonCodesCS = m_Device->CreateShader();
+    computeLightMortonCodesCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeLightMortonCodes_CS.hlsl" );
+    m_ComputeLightMortonCodesPSO->SetShader( computeLightMortonCodesCS );
+
+    // Setup a pipeline state to sort the Morton code values.
+    ShaderMacros sortShaderMacros;
+    sortShaderMacros["NUM_THREADS"] = std::to_string( SORT_NUM_THREADS_PER_THREAD_GROUP );
+    sortShaderMacros["NUM_VALUES_PER_THREAD"] = std::to_string( SORT_ELEMENTS_PER_THREAD );
+
+    auto radixSortCS = m_Device->CreateShader();
+    radixSortCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/RadixSort_CS.hlsl", "main", sortShaderMacros );
+    m_RadixSortPSO->SetShader( radixSortCS );
+
+    // Setup compute pipeline for computing merge path partitions.
+    auto mergePathPartitionsCS = m_Device->CreateShader();
+    mergePathPartitionsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/MergeSort_CS.hlsl", "MergePathPartitions_CS", sortShaderMacros );
+    m_MergePathPartitionsPSO->SetShader( mergePathPartitionsCS );
+
+    // Setup a compute pipeline for merge sort.
+    auto mergeSortCS = m_Device->CreateShader();
+    mergeSortCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/MergeSort_CS.hlsl", "MergeSort", sortShaderMacros );
+    m_MergeSortPSO->SetShader( mergeSortCS );
+
+    // Setup the 64-bit Morton code versions of the Morton code and sort compute shaders.
+    ShaderMacros mortonCode64ShaderMacros;
+    mortonCode64ShaderMacros["MORTON_CODE_64"] = "1";
+
+    auto computeLightMortonCodes64CS = m_Device->CreateShader();
+    computeLightMortonCodes64CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeLightMortonCodes_CS.hlsl", "main", mortonCode64ShaderMacros );
+    m_ComputeLightMortonCodes64PSO->SetShader( computeLightMortonCodes64CS );
+
+    ShaderMacros sort64ShaderMacros = sortShaderMacros;
+    sort64ShaderMacros["MORTON_CODE_64"] = "1";
+
+    auto radixSort64CS = m_Device->CreateShader();
+    radixSort64CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/RadixSort_CS.hlsl", "main", sort64ShaderMacros );
+    m_RadixSort64PSO->SetShader( radixSort64CS );
+
+    auto mergePathPartitions64CS = m_Device->CreateShader();
+    mergePathPartitions64CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/MergeSort_CS.hlsl", "MergePathPartitions_CS", sort64ShaderMacros );
+    m_MergePathPartitions64PSO->SetShader( mergePathPartitions64CS );
+
+    auto mergeSort64CS = m_Device->CreateShader();
+    mergeSort64CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/MergeSort_CS.hlsl", "MergeSort", sort64ShaderMacros );
+    m_MergeSort64PSO->SetShader( mergeSort64CS );
+
+    // Setup a compute pipeline for BVH building.
+    // Compute shader to build bottom level of BVH
+    auto buildBVHBottomCS = m_Device->CreateShader();
+    buildBVHBottomCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildBVH_CS.hlsl", "BuildBottom" );
+    m_BuildBVHBottomPSO->SetShader( buildBVHBottomCS );
+
+    // Compute shader to build upper levels of the BVH.
+    auto buildBVHTopCS = m_Device->CreateShader();
+    buildBVHTopCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildBVH_CS.hlsl", "BuildTop" );
+    m_BuildBVHTopPSO->SetShader( buildBVHTopCS );
+}
+
+void LightBVHBuilder::SetUse64BitMortonCodes( bool use64BitMortonCodes )
+{
+    if ( m_Use64BitMortonCodes != use64BitMortonCodes )
+    {
+        m_Use64BitMortonCodes = use64BitMortonCodes;
+
+        // The size of the keys changed so the key buffers need to be recreated.
+        if ( m_PointLightKeys )
+        {
+            auto commandQueue = m_Device->GetCopyQueue();
+            auto commandBuffer = commandQueue->GetCopyCommandBuffer();
+
+            CreateKeyBuffers( commandBuffer );
+
+            commandQueue->Submit( commandBuffer )->WaitFor();
+        }
+    }
+}
+
+bool LightBVHBuilder::GetUse64BitMortonCodes() const
+{
+    return m_Use64BitMortonCodes;
+}
+
+void LightBVHBuilder::SetNumLights( std::shared_ptr<CopyCommandBuffer> commandBuffer, uint32_t numPointLights, uint32_t numSpotLights )
+{
+    m_NumPointLights = numPointLights;
+    m_NumSpotLights = numSpotLights;
+
+    if ( !m_LightsAABB )
+    {
+        // To compute the AABB for all of the lights in the scene, a parallel reduction algorithm is used.
+        // The reduction compute shader will be dispatched with 512 thread groups each group with 512 threads.
+        // The first pass of the reduction will compute 512 AABBs and the second pass will dispatch a single
+        // thread group that will reduce the 512 AABBs into a single AABB at index 0 of the LightsAABB structured buffer.
+        m_LightsAABB = m_Device->CreateStructuredBuffer( commandBuffer, 512, sizeof( AABB ) );
+        m_LightsAABB->SetName( L"Lights AABB" );
+    }
+
+    // Create a buffer to store the sorted indices for the point lights.
+    m_PointLightIndices = m_Device->CreateStructuredBuffer( commandBuffer, numPointLights, sizeof( uint32_t ) );
+    m_PointLightIndices->SetName( L"Point Light Indices" );
+
+    // For sorting, we need to double buffer the output.
+    m_PointLightIndices_OUT = m_Device->CreateStructuredBuffer( commandBuffer, numPointLights, sizeof( uint32_t ) );
+    m_PointLightIndices_OUT->SetName( L"Point Light Indices (OUT)" );
+
+    // Create a buffer to store the sorted indices for the spot lights.
+    m_SpotLightIndices = m_Device->CreateStructuredBuffer( commandBuffer, numSpotLights, sizeof( uint32_t ) );
+    m_SpotLightIndices->SetName( L"Spot Light Indices" );
+
+    m_SpotLightIndices_OUT = m_Device->CreateStructuredBuffer( commandBuffer, numSpotLights, sizeof( uint32_t ) );
+    m_SpotLightIndices_OUT->SetName( L"Spot Light Indices (OUT)" );
+
+    // BVH for point lights.
+    m_PointLightBVH = m_Device->CreateStructuredBuffer( commandBuffer, LightBVHCPU::GetNumNodes( numPointLights ), sizeof( AABB ) );
+    m_PointLightBVH->SetName( L"Point Light BVH" );
+
+    // BVH for spot lights.
+    m_SpotLightBVH = m_Device->CreateStructuredBuffer( commandBuffer, LightBVHCPU::GetNumNodes( numSpotLights ), sizeof( AABB ) );
+    m_SpotLightBVH->SetName( L"Spot Light BVH" );
+
+    CreateKeyBuffers( commandBuffer );
+
+    // The maximum number of elements that need to be sorted.
+    uint32_t maxElements = glm::max( numPointLights, numSpotLights );
+
+    // Radix sort will sort the keys into chunks of SORT_NUM_THREADS_PER_THREAD_GROUP size.
+    uint32_t chunkSize = SORT_NUM_THREADS_PER_THREAD_GROUP;
+    // The number of chunks that need to be merge sorted after Radix sort finishes.
+    uint32_t numChunks = static_cast<uint32_t>( glm::ceil( maxElements / (float)chunkSize ) );
+    // The number of sort groups that are needed to sort the first set of chunks.
+    // Each sort group will sort 2 chunks. So the maximum number of sort groups is 1/2 of the
+    // number of chunks.
+    uint32_t maxSortGroups = numChunks / 2;
+    // The number of merge path partitions per sort group is the total values
+    // to be sorted per sort group (2 chunks) divided by the number of elements
+    // that can be sorted per thread group. One is added to account for the
+    // merge path partition at the END of the chunk.
+    uint32_t numMergePathPartitionsPerSortGroup = static_cast<uint32_t>( glm::ceil( ( chunkSize * 2 ) / (float)( SORT_ELEMENTS_PER_THREAD * SORT_NUM_THREADS_PER_THREAD_GROUP ) ) ) + 1u;
+
+    // The maximum number of merge path partitions is the number of merge path partitions
+    // needed by a single sort group multiplied by the maximum number of sort groups.
+    uint32_t maxMergePathPartitions = numMergePathPartitionsPerSortGroup * maxSortGroups;
+
+    m_MergePathPartitions = m_Device->CreateStructuredBuffer( commandBuffer, maxMergePathPartitions, sizeof( uint32_t ) );
+    m_MergePathPartitions->SetName( L"Merge Path Partitions" );
+}
+
+void LightBVHBuilder::CreateKeyBuffers( std::shared_ptr<CopyCommandBuffer> commandBuffer )
+{
+    // The 64-bit Morton codes are stored as uint2 in the structured buffers.
+    size_t keySize = m_Use64BitMortonCodes ? sizeof( uint64_t ) : sizeof( uint32_t );
+
+    // Create a buffer to store the Morton codes for point lights.
+    m_PointLightKeys = m_Device->CreateStructuredBuffer( commandBuffer, m_NumPointLights, keySize );
+    m_PointLightKeys->SetName( L"Point Light Morton Codes" );
+
+    // For sorting, we need to double buffer the output.
+    m_PointLightKeys_OUT = m_Device->CreateStructuredBuffer( commandBuffer, m_NumPointLights, keySize );
+    m_PointLightKeys_OUT->SetName( L"Point Light Morton Codes (OUT)" );
+
+    // Create a buffer to store the Morton codes for spot lights.
+    m_SpotLightKeys = m_Device->CreateStructuredBuffer( commandBuffer, m_NumSpotLights, keySize );
+    m_SpotLightKeys->SetName( L"Spot Light Morton Codes" );
+
+    m_SpotLightKeys_OUT = m_Device->CreateStructuredBuffer( commandBuffer, m_NumSpotLights, keySize );
+    m_SpotLightKeys_OUT->SetName( L"Spot Light Morton Codes (OUT)" );
+}
+
+void LightBVHBuilder::Build( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                             std::shared_ptr<StructuredBuffer> pointLights, std::shared_ptr<StructuredBuffer> spotLights )
+{
+    ReduceLightsAABB( commandBuffer, lightCounts, pointLights, spotLights );
+    ComputeMortonCodes( commandBuffer, lightCounts, pointLights, spotLights );
+    {
+        ScopedProfileMarker sortByMortonCode( L"Sort Morton Codes", commandBuffer );
+
+        SortKeys( commandBuffer, lightCounts );
+    }
+    BuildBVH( commandBuffer, lightCounts, pointLights, spotLights );
+}
+
+void LightBVHBuilder::ReduceLightsAABB( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                                        std::shared_ptr<StructuredBuffer> pointLights, std::shared_ptr<StructuredBuffer> spotLights )
+{
+    ScopedProfileMarker computeLightsAABB( L"Reduce Lights AABB", commandBuffer );
+
+    commandBuffer->BindComputePipelineState( m_ReduceLightsAABB1PSO );
+
+    // Don't dispatch more than 512 thread groups. The reduction algorithm depends on the
+    // number of thread groups to be no more than 512. The buffer which stores the reduced AABB is sized
+    // for a maximum of 512 thread groups.
+    uint32_t numThreadGroups = glm::min<uint32_t>( static_cast<uint32_t>( glm::ceil( glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights ) / 512.0f ) ), 512 );
+
+    DispatchParamsCB dispatchParams;
+    dispatchParams.NumThreadGroups = glm::uvec3( numThreadGroups, 1, 1 );
+    dispatchParams.NumThreads = glm::uvec3( numThreadGroups * 512, 1, 1 );
+
+    // In the first pass, the number of lights determines the number of
+    // elements to be reduced.
+    // In the second pass, the number of elements to be reduced is the
+    // number of thread groups from the first pass.
+    uint32_t numElements = dispatchParams.NumThreadGroups.x;
+
+    commandBuffer->BindCompute32BitConstants( 0, lightCounts );
+    commandBuffer->BindCompute32BitConstants( 1, dispatchParams );
+    commandBuffer->BindCompute32BitConstants( 2, numElements );
+    commandBuffer->BindComputeShaderArguments( 3, 0, { pointLights, spotLights, m_LightsAABB } );
+
+    {
+        ScopedProfileMarker firstPass( L"First Pass", commandBuffer );
+
+        // Dispatch the first pass.
+        commandBuffer->Dispatch( numThreadGroups );
+    }
+
+    commandBuffer->BindComputePipelineState( m_ReduceLightsAABB2PSO );
+
+    dispatchParams.NumThreadGroups = glm::uvec3( 1, 1, 1 );
+    dispatchParams.NumThreads = glm::uvec3( 512, 1, 1 );
+
+    commandBuffer->BindCompute32BitConstants( 1, dispatchParams );
+
+    {
+        ScopedProfileMarker secondPass( L"Second Pass", commandBuffer );
+
+        // Dispatch 2nd pass.
+        commandBuffer->Dispatch( 1 );
+    }
+}
+
+void LightBVHBuilder::ComputeMortonCodes( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                                          std::shared_ptr<StructuredBuffer> pointLights, std::shared_ptr<StructuredBuffer> spotLights )
+{
+    ScopedProfileMarker computeMortonCodes( L"Compute Morton Codes", commandBuffer );
+
+    commandBuffer->BindComputePipelineState( m_Use64BitMortonCodes ? m_ComputeLightMortonCodes64PSO : m_ComputeLightMortonCodesPSO );
+
+    commandBuffer->BindCompute32BitConstants( 0, lightCounts );
+    commandBuffer->BindComputeShaderArguments( 1, 0, { pointLights, spotLights, m_LightsAABB } );
+    commandBuffer->BindComputeShaderArguments( 1, 3, { m_PointLightKeys, m_SpotLightKeys } );
+    commandBuffer->BindComputeShaderArguments( 1, 5, { m_PointLightIndices, m_SpotLightIndices } );
+
+    uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights ) / 1024.0f ) );
+
+    commandBuffer->Dispatch( numThreadGroups );
+}
+
+void LightBVHBuilder::SortKeys( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts )
+{
+    // The size of a single chunk that keys will be sorted into.
+    uint32_t chunkSize = SORT_NUM_THREADS_PER_THREAD_GROUP;
+
+    commandBuffer->BindComputePipelineState( m_Use64BitMortonCodes ? m_RadixSort64PSO : m_RadixSortPSO );
+
+    SortParams sortParams;
+    sortParams.ChunkSize = chunkSize;
+
+    // First sort the point light keys.
+    if ( lightCounts.NumPointLights > 0 )
+    {
+        sortParams.NumElements = lightCounts.NumPointLights;
+
+        commandBuffer->BindCompute32BitConstants( 0, sortParams );
+        commandBuffer->BindComputeShaderArguments( 1, 0, { m_PointLightKeys, m_PointLightIndices } );
+        commandBuffer->BindComputeShaderArguments( 1, 2, { m_PointLightKeys_OUT, m_PointLightIndices_OUT } );
+
+        {
+            ScopedProfileMarker sortPointLights( L"Radix Sort (Point Lights)", commandBuffer );
+
+            uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( sortParams.NumElements / (float)SORT_NUM_THREADS_PER_THREAD_GROUP ) );
+
+            commandBuffer->Dispatch( numThreadGroups );
+
+            // Now copy the results of the radix sort to the original buffer.
+            commandBuffer->CopyResource( m_PointLightKeys, m_PointLightKeys_OUT );
+            commandBuffer->CopyResource( m_PointLightIndices, m_PointLightIndices_OUT );
+        }
+    }
+
+    // Now sort the spot light keys.
+    if ( lightCounts.NumSpotLights > 0 )
+    {
+        sortParams.NumElements = lightCounts.NumSpotLights;
+
+        commandBuffer->BindCompute32BitConstants( 0, sortParams );
+        commandBuffer->BindComputeShaderArguments( 1, 0, { m_SpotLightKeys, m_SpotLightIndices } );
+        commandBuffer->BindComputeShaderArguments( 1, 2, { m_SpotLightKeys_OUT, m_SpotLightIndices_OUT } );
+
+        {
+            ScopedProfileMarker sortSpotLights( L"Radix Sort (Spot Lights)", commandBuffer );
+
+            uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( sortParams.NumElements / (float)SORT_NUM_THREADS_PER_THREAD_GROUP ) );
+
+            commandBuffer->Dispatch( numThreadGroups );
+
+            // Now copy the results of the radix sort to the original buffer.
+            commandBuffer->CopyResource( m_SpotLightKeys, m_SpotLightKeys_OUT );
+            commandBuffer->CopyResource( m_SpotLightIndices, m_SpotLightIndices_OUT );
+        }
+    }
+
+    // Merge sort the radix sorted blocks from the previous step.
+    if ( lightCounts.NumPointLights > 0 )
+    {
+        ScopedProfileMarker mergeSortPointLights( L"Merge Sort (Point Lights)", commandBuffer );
+
+        MergeSort( commandBuffer,
+                   m_PointLightKeys, m_PointLightIndices,
+                   m_PointLightKeys_OUT, m_PointLightIndices_OUT,
+                   lightCounts.NumPointLights, chunkSize );
+    }
+
+    if ( lightCounts.NumSpotLights > 0 )
+    {
+        ScopedProfileMarker mergeSortSpotLights( L"Merge Sort (Spot Lights)", commandBuffer );
+
+        MergeSort( commandBuffer,
+                   m_SpotLightKeys, m_SpotLightIndices,
+                   m_SpotLightKeys_OUT, m_SpotLightIndices_OUT,
+                   lightCounts.NumSpotLights, chunkSize );
+    }
+}
+
+void LightBVHBuilder::MergeSort( std::shared_ptr<ComputeCommandBuffer> commandBuffer,
+                                 std::shared_ptr<StructuredBuffer> srcKeys, std::shared_ptr<StructuredBuffer> srcValues,
+                                 std::shared_ptr<StructuredBuffer> dstKeys, std::shared_ptr<StructuredBuffer> dstValues,
+                                 uint32_t totalValues, uint32_t chunkSize )
+{
+    SortParams sortParams;
+    uint32_t numThreadGroups;
+
+    // The number of threads per thread group.
+    const uint32_t numThreadsPerThreadGroup = SORT_NUM_THREADS_PER_THREAD_GROUP;
+    // The number of values that each thread sorts.
+    const uint32_t numValuesPerThread = SORT_ELEMENTS_PER_THREAD;
+    // The number of values that each thread group will sort.
+    const uint32_t numValuesPerThreadGroup = numThreadsPerThreadGroup * numValuesPerThread;
+
+    // The total number of complete chunks to sort.
+    uint32_t numChunks = static_cast<uint32_t>( glm::ceil( totalValues / (float)chunkSize ) );
+
+    uint32_t pass = 0;
+
+    while ( numChunks > 1 )
+    {
+        ScopedProfileMarker passProfileMaker( std::wstring( L"Pass " ) + std::to_wstring( ++pass ), commandBuffer );
+
+        sortParams.NumElements = totalValues;
+        sortParams.ChunkSize = chunkSize;
+
+        // Number of sort groups required to sort all chunks.
+        // Each sort group merge sorts 2 chunks into a single chunk.
+        uint32_t numSortGroups = numChunks / 2u;
+
+        // The number of thread groups that are required per sort group.
+        uint32_t numThreadGroupsPerSortGroup = static_cast<uint32_t>( glm::ceil( ( chunkSize * 2 ) / (float)numValuesPerThreadGroup ) );
+
+        // Compute merge path partitions per thread group.
+        {
+            commandBuffer->ClearResourceUInt( m_MergePathPartitions );
+
+            commandBuffer->BindComputePipelineState( m_Use64BitMortonCodes ? m_MergePathPartitions64PSO : m_MergePathPartitionsPSO );
+
+            commandBuffer->BindCompute32BitConstants( 0, sortParams );
+            commandBuffer->BindComputeShaderArguments( 1, 0, { srcKeys, srcValues, m_MergePathPartitions } );
+            commandBuffer->BindComputeShaderArguments( 1, 3, { dstKeys, dstValues, m_MergePathPartitions } );
+
+            // The number of merge path partitions that need to be computed.
+            uint32_t numMergePathPartitionsPerSortGroup = numThreadGroupsPerSortGroup + 1u;
+            uint32_t totalMergePathPartitions = numMergePathPartitionsPerSortGroup * numSortGroups;
+
+            // The number of thread groups needed to compute all merge path partitions.
+            numThreadGroups = static_cast<uint32_t>( glm::ceil( totalMergePathPartitions / (float)numThreadsPerThreadGroup ) );
+
+            commandBuffer->Dispatch( numThreadGroups );
+
+            // Add an explicit UAV barrier for MergePathPartitions.
+            // This is required since the MergePathPartitions structured buffer is being used
+            // as a UAV in the MergePathPartions compute shader and as an SRV in the MergeSort
+            // compute shader. Because the MergePathPartions argument is not rebound between
+            // dispatches, no implicit UAV barrier will be added to the command list and MergeSort
+            // will likely not see the correct merge path partitions.
+            // To resolve this, an explicit UAV barrier is added for the resource.
+            commandBuffer->AddUAVBarrier( m_MergePathPartitions );
+        }
+
+        // Perform merge sort using merge path partitions computed from the previous step.
+        {
+            commandBuffer->BindComputePipelineState( m_Use64BitMortonCodes ? m_MergeSort64PSO : m_MergeSortPSO );
+
+            // The number of values that each sort group will sort.
+            // Each sort group merges 2 chunks into 1.
+            uint32_t numValuesPerSortGroup = glm::min( chunkSize * 2, totalValues );
+
+            // The number of thread groups required to sort all values.
+            numThreadGroupsPerSortGroup = static_cast<uint32_t>( glm::ceil( numValuesPerSortGroup / (float)numValuesPerThreadGroup ) );
+
+            commandBuffer->Dispatch( numThreadGroupsPerSortGroup * numSortGroups );
+
+            // Ping-pong the buffers
+            std::swap( srcKeys, dstKeys );
+            std::swap( srcValues, dstValues );
+        }
+
+        chunkSize *= 2;
+        numChunks = static_cast<uint32_t>( glm::ceil( totalValues / (float)chunkSize ) );
+    }
+
+    // If the number of passes was odd, then the result of the sort will
+    // be in the source buffer and results need to be copied to the
+    // destination buffer.
+    if ( pass % 2 == 1 )
+    {
+        commandBuffer->CopyResource( dstKeys, srcKeys );
+        commandBuffer->CopyResource( dstValues, srcValues );
+    }
+}
+
+void LightBVHBuilder::BuildBVH( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts,
+                                std::shared_ptr<StructuredBuffer> pointLights, std::shared_ptr<StructuredBuffer> spotLights )
+{
+    ScopedProfileMarker buildBVH( L"Build Light BVH", commandBuffer );
+
+    commandBuffer->ClearResourceFloat( m_PointLightBVH );
+    commandBuffer->ClearResourceFloat( m_SpotLightBVH );
+
+    commandBuffer->BindComputePipelineState( m_BuildBVHBottomPSO );
+
+    BVHParams bvhParams = {};
+    bvhParams.PointLightLevels = LightBVHCPU::GetNumLevels( lightCounts.NumPointLights );
+    bvhParams.SpotLightLevels = LightBVHCPU::GetNumLevels( lightCounts.NumSpotLights );
+
+    commandBuffer->BindCompute32BitConstants( 0, bvhParams );
+    commandBuffer->BindCompute32BitConstants( 1, lightCounts );
+    commandBuffer->BindComputeShaderArguments( 2, 0, { pointLights, spotLights } );
+    commandBuffer->BindComputeShaderArguments( 2, 2, { m_PointLightIndices, m_SpotLightIndices } );
+    commandBuffer->BindComputeShaderArguments( 2, 4, { m_PointLightBVH, m_SpotLightBVH } );
+
+    // Build bottom level of the BVH.
+    uint32_t maxLeaves = glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights );
+    uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( maxLeaves / (float)BVH_NUM_THREADS ) );
+
+    {
+        ScopedProfileMarker buildBottomBVH( L"Build Bottom BVH", commandBuffer );
+
+        commandBuffer->Dispatch( numThreadGroups );
+    }
+
+    commandBuffer->BindComputePipelineState( m_BuildBVHTopPSO );
+
+    // Now build upper levels of the BVH.
+    uint32_t maxLevels = static_cast<uint32_t>( glm::max( bvhParams.PointLightLevels, bvhParams.SpotLightLevels ) );
+
+    if ( maxLevels > 0 )
+    {
+        for ( uint32_t level = maxLevels - 1u; level > 0; --level )
+        {
+            commandBuffer->AddUAVBarrier( m_PointLightBVH );
+            commandBuffer->AddUAVBarrier( m_SpotLightBVH );
+
+            bvhParams.ChildLevel = level;
+            commandBuffer->BindCompute32BitConstants( 0, bvhParams );
+
+            uint32_t numChildNodes = LightBVHCPU::GetNumLevelNodes( level );
+            numThreadGroups = static_cast<uint32_t>( glm::ceil( numChildNodes / (float)BVH_NUM_THREADS ) );
+
+            {
+                ScopedProfileMarker buildBVHLevel( std::wstring( L"Build BVH Level " ) + std::to_wstring( level ), commandBuffer );
+                commandBuffer->Dispatch( numThreadGroups );
+            }
+        }
+    }
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetLightsAABB() const
+{
+    return m_LightsAABB;
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetPointLightKeys() const
+{
+    return m_PointLightKeys;
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetSpotLightKeys() const
+{
+    return m_SpotLightKeys;
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetPointLightIndices() const
+{
+    return m_PointLightIndices;
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetSpotLightIndices() const
+{
+    return m_SpotLightIndices;
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetPointLightBVH() const
+{
+    return m_PointLightBVH;
+}
+
+std::shared_ptr<StructuredBuffer> LightBVHBuilder::GetSpotLightBVH() const
+{
+    return m_SpotLightBVH;
+}
@@ -42,7 +42,7 @@ void LightsPass::Render( Core::RenderEventArgs& e )
 
 void LightsPass::Visit( Graphics::SceneNode& node )
 {
-    BasePass::Visit( node );
+    BindSceneNode( node );
 }
 
 void LightsPass::Visit( Graphics::Mesh& mesh )
@@ -12,12 +12,8 @@ OpaquePass::OpaquePass( std::shared_ptr<Graphics::Scene> scene, std::shared_ptr<
 OpaquePass::~OpaquePass()
 {}
 
-void OpaquePass::Visit( Graphics::Mesh& mesh )
+bool OpaquePass::IsRendered( const Graphics::Mesh& mesh ) const
 {
     std::shared_ptr<Graphics::Material> pMaterial = mesh.GetMaterial();
-    if ( pMaterial && !pMaterial->IsTransparent() )
-    {
-        BindMaterial( pMaterial );
-        mesh.Render( *m_pRenderEventArgs, m_InstanceCount, m_FirstInstance );
-    }
+    return pMaterial && !pMaterial->IsTransparent();
 }
@@ -5,19 +5,99 @@
 #include <Graphics/Material.h>
 #include <Graphics/Mesh.h>
 
+const float TransparentPass::TriangleSortThreshold = 0.005f;
+
 TransparentPass::TransparentPass( std::shared_ptr<Graphics::Scene> scene, std::shared_ptr<Graphics::GraphicsPipelineState> pipeline, bool bUseMaterials, uint32_t instanceCount, uint32_t firstInstance )
     : base( scene, pipeline, bUseMaterials, instanceCount, firstInstance )
-{}
+{
+    // Blending requires the transparent geometry to be rendered back-to-front.
+    m_RenderQueue.SetSortOrder( Graphics::RenderQueue::SortOrder::BackToFront );
+}
 
 TransparentPass::~TransparentPass()
 {}
 
-void TransparentPass::Visit( Graphics::Mesh& mesh )
+bool TransparentPass::IsRendered( const Graphics::Mesh& mesh ) const
 {
     std::shared_ptr<Graphics::Material> pMaterial = mesh.GetMaterial();
-    if ( pMaterial && pMaterial->IsTransparent() )
+    return pMaterial && pMaterial->IsTransparent();
+}
+
+void TransparentPass::Render( Core::RenderEventArgs& e )
+{
+    base::Render( e );
+
+    for ( auto iter = m_TriangleSorters.begin(); iter != m_TriangleSorters.end(); )
+    {
+        if ( iter->second.LastFrame != e.FrameCounter )
+        {
+            iter = m_TriangleSorters.erase( iter );
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+bool TransparentPass::CanInstance( const Draw& draw ) const
+{
+    // The triangles of each instance are sorted separately.
+    return !draw.Mesh->HasTriangles() && base::CanInstance( draw );
+}
+
+void TransparentPass::RenderDraw( const Draw& draw )
+{
+    const Graphics::Mesh& mesh = *draw.Mesh;
+
+    // Instances are positioned by the shaders so they can't be sorted on the CPU.
+    if ( !mesh.HasTriangles() || m_InstanceCount != 1 || !m_Camera || !draw.Node )
+    {
+        base::RenderDraw( draw );
+        return;
+    }
+
+    // The triangles are sorted in object space (m_ObjectCameraPosition is set when the scene node is bound).
+    TriangleSorterEntry& entry = m_TriangleSorters[TriangleSorterKey( draw.Mesh, draw.Node )];
+    if ( entry.Node.expired() )
+    {
+        entry = TriangleSorterEntry();
+        entry.Node = draw.Node->weak_from_this();
+    }
+    entry.LastFrame = m_pRenderEventArgs->FrameCounter;
+
+    Graphics::TriangleSorterCPU& triangleSorter = entry.TriangleSorter;
+
+    const std::vector<glm::vec3>& triangleCenters = mesh.GetTriangleCenters();
+    uint32_t numTriangles = static_cast<uint32_t>( triangleCenters.size() );
+    if ( triangleSorter.Sort( mesh.GetTriangleIndices().data(), triangleCenters.data(), numTriangles, mesh.GetBoundingSphere(), m_ObjectCameraPosition, TriangleSortThreshold ) )
+    {
+        m_RenderStatistics.NumSortedTriangles += numTriangles;
+        if ( triangleSorter.WasIncremental() )
+        {
+            m_RenderStatistics.NumIncrementalSortedTriangles += numTriangles;
+        }
+    }
+
+    // While the camera moves, the order changes every few frames, so the sorted indices are copied to the upload heap
+    // when they are rendered. Once the order stays the same (the camera stopped or only moved a little), the indices are
+    // copied to an index buffer once and rendered from there until the order changes again. The resource of a released
+    // index buffer stays alive until the command buffers that use it are executed.
+    if ( triangleSorter.WasOrderChanged() )
+    {
+        entry.IndexBuffer = nullptr;
+    }
+    else if ( !entry.IndexBuffer )
+    {
+        entry.IndexBuffer = mesh.CreateIndexBuffer( *m_pRenderEventArgs, triangleSorter.GetIndices(), triangleSorter.GetNumIndices(), triangleSorter.GetIndexSize() );
+    }
+
+    if ( entry.IndexBuffer )
+    {
+        draw.Mesh->RenderIndices( *m_pRenderEventArgs, entry.IndexBuffer, m_InstanceCount, m_FirstInstance );
+    }
+    else
     {
-        BindMaterial( pMaterial );
-        mesh.Render( *m_pRenderEventArgs, m_InstanceCount, m_FirstInstance );
+        draw.Mesh->RenderIndices( *m_pRenderEventArgs, triangleSorter.GetIndices(), triangleSorter.GetNumIndices(), triangleSorter.GetIndexSize(), m_InstanceCount, m_FirstInstance );
     }
 }
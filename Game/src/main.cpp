@@ -44,9 +44,19 @@
 #include <InvokeFunctionPass.h>
 #include <LightsPass.h>
 #include <PostprocessPass.h>
+#include <LightBVHBuilder.h>
+#include <ClusterGrid.h>
 #include <PrintProfileDataVisitor.h>
 
 #include <Graphics/DX12/ApplicationDX12.h>
+#include <Graphics/DX12/TextureStreamerDX12.h>
+#include <Graphics/CPU/LightBVHCPU.h>
+#include <Graphics/CPU/ClusterLightAssignmentCPU.h>
+#include <Graphics/CPU/ZBinningCPU.h>
+#include <Graphics/CPU/LightGeneratorCPU.h>
+#include <Graphics/CPU/UpdateLightsCPU.h>
+#include <DependencyDatabase.h>
+#include <ThreadPool.h>
 
 using namespace Core;
 using namespace Graphics;
@@ -58,6 +68,7 @@ enum class RenderingTechnique
     ForwardPlus,
     Clustered,
     Clustered_Optimized,
+    ZBinned,
     NumTechniques
 };
 
@@ -65,7 +76,8 @@ const char* RenderTechniqueName[] = {
     "Forward",
     "Forward+",
     "Clustered",
-    "Clustered (Optimized)"
+    "Clustered (Optimized)",
+    "Z-Binned"
 };
 
 RenderingTechnique g_RenderingTechnique = RenderingTechnique::Clustered_Optimized;
@@ -77,6 +89,8 @@ ConfigurationSettings g_Config;
 
 std::shared_ptr<Graphics::Window> g_RenderWindow;
 std::shared_ptr<Device> g_RenderDevice;
+// Streams the mip levels of the textures of the scene (if texture streaming is enabled).
+std::shared_ptr<TextureStreamerDX12> g_TextureStreamer;
 
 std::shared_ptr<Graphics::Camera> g_Camera;
 std::shared_ptr<CameraController> g_CameraController;
@@ -93,6 +107,10 @@ uint32_t g_LightGridBlockSize = 32;
 // clustered rendering.
 uint32_t g_ClusterGridBlockSize = 64;
 
+// Seed for the light generation.
+// The same seed always generates the same lights.
+uint32_t g_LightSeed = 0;
+
 
 // Cluster Grid data is used for clustered rendering.
 ClusterDataCB g_ClusterDataCB;
@@ -100,6 +118,46 @@ ClusterDataCB g_ClusterDataCB;
 // Toggle animations (lights moving).
 bool g_Animate = false;
 
+// Build the light BVH on the CPU instead of the GPU (Clustered_Optimized only).
+// The CPU BVH is only refitted while the lights move and only rebuilt when the
+// quality of the BVH degrades too much.
+bool g_BuildLightBVHOnCPU = false;
+LightBVHCPU g_PointLightBVHCPU;
+LightBVHCPU g_SpotLightBVHCPU;
+// The view matrix that was used to build the CPU light BVH.
+glm::mat4 g_LightBVHViewMatrix = glm::mat4( 1.0 );
+// Set when the lights have changed and the CPU light BVH needs to be updated.
+bool g_LightBVHDirty = true;
+// Set when the lights were animated on the GPU (UpdateLights_CS) after the CPU copy
+// of the lights (g_Config) was last synchronized with the light buffers. While the
+// light BVH is built on the CPU, the lights are only animated on the CPU and the
+// CPU copy is the authoritative copy of the lights.
+bool g_LightsAnimatedOnGPU = false;
+
+// Use 63-bit Morton codes (21 bits per axis) instead of 30-bit Morton codes
+// (10 bits per axis) to sort the lights for the light BVH. With a large number
+// of lights, 30-bit Morton codes have many duplicate keys which results in
+// loose BVH nodes.
+bool g_Use64BitMortonCodes = false;
+
+// Assign lights to clusters in two passes. The first pass only counts the
+// number of lights per cluster, a prefix sum over the light grid computes the
+// offset of each cluster in the light index lists and the second pass fills the
+// light index lists. The number of lights per cluster is not limited and the
+// light index lists only need to store the lights that are actually assigned.
+bool g_ExactLightIndexLists = false;
+
+// Only update the light lists of the clusters that are affected by lights that
+// moved since the previous frame (or that were not visible in the previous frame)
+// and keep the light lists of all other clusters. The light lists are fully
+// rebuilt if the camera moves, the lights are animated or with exact light index lists.
+bool g_IncrementalLightAssignment = false;
+// Set if the cluster light lists of the previous frame can be reused.
+bool g_ClusterLightListsValid = false;
+// The frame and view matrix of the last light assignment.
+uint64_t g_ClusterLightListsFrame = 0;
+glm::mat4 g_ClusterLightListsViewMatrix = glm::mat4( 1.0f );
+
 std::future<bool> g_LoadingTask;
 std::atomic_bool g_IsLoading = true;
 
@@ -135,6 +193,9 @@ std::shared_ptr<StructuredBuffer> g_SpotLightIndexList_Cluster;
 // Light grids for Clustered lighting.
 std::shared_ptr<StructuredBuffer> g_PointLightGrid_Cluster;
 std::shared_ptr<StructuredBuffer> g_SpotLightGrid_Cluster;
+// The sum of the light counts of each thread group of the light grid prefix sum.
+// Only used with exact light index lists.
+std::shared_ptr<StructuredBuffer> g_LightGridGroupSums;
 
 // Cluster gird buffer for storing a flag for each grid cell that contains a sample.
 // This buffer stores a single 32-bit flag (0 for no sample, 1 for a sample)
@@ -161,45 +222,58 @@ std::shared_ptr<ByteAddressBuffer> g_DebugClustersDrawIndirectArgumentBuffer;
 // (Primarily used for debugging).
 std::shared_ptr<StructuredBuffer> g_PreviousUniqueClusters;
 
+// Incremental light assignment.
+// The lights and cluster flags of the previous frame.
+std::shared_ptr<StructuredBuffer> g_PreviousPointLightsBuffer;
+std::shared_ptr<StructuredBuffer> g_PreviousSpotLightsBuffer;
+std::shared_ptr<StructuredBuffer> g_PreviousClusterFlags;
+// The previous and current bounding spheres of the lights that moved since the previous frame.
+std::shared_ptr<StructuredBuffer> g_MovedLightCounter;
+std::shared_ptr<StructuredBuffer> g_MovedLightSpheres;
+// The unique clusters whose light lists need to be updated.
+std::shared_ptr<StructuredBuffer> g_DirtyClusters;
+std::shared_ptr<ByteAddressBuffer> g_AssignLightsToDirtyClustersArgumentBuffer;
+
 // AABBs for cluster grid.
 std::shared_ptr<StructuredBuffer> g_ClusterAABBs;
 
-// AABB for all lights in the scene.
-std::shared_ptr<StructuredBuffer> g_LightsAABB;
-
-// Morton codes for point lights.
-std::shared_ptr<StructuredBuffer> g_PointLightMortonCodes;
-// When sorting, this buffer will store the indices for the point lights.
-std::shared_ptr<StructuredBuffer> g_PointLightIndices;
-
-// For sorting, we need to double buffer the output.
-std::shared_ptr<StructuredBuffer> g_PointLightMortonCodes_OUT;
-std::shared_ptr<StructuredBuffer> g_PointLightIndices_OUT;
-
-// BVH for point lights.
-std::shared_ptr<StructuredBuffer> g_PointLightBVH;
-
-// Morton codes for spot lights.
-std::shared_ptr<StructuredBuffer> g_SpotLightMortonCodes;
-std::shared_ptr<StructuredBuffer> g_SpotLightIndices;
-
-// For sorting, we need to double buffer the output.
-std::shared_ptr<StructuredBuffer> g_SpotLightMortonCodes_OUT;
-std::shared_ptr<StructuredBuffer> g_SpotLightIndices_OUT;
+// Builds the light BVHs on the GPU. Owns the lights AABB, the light Morton codes,
+// the sorted light indices and the light BVHs.
+std::shared_ptr<LightBVHBuilder> g_LightBVHBuilder;
 
-// BVH for spot lights.
-std::shared_ptr<StructuredBuffer> g_SpotLightBVH;
+// Z-bins for Z-binned rendering. For every Z-bin, the range of
+// (depth sorted) light indices of the lights that overlap the Z-bin.
+std::shared_ptr<StructuredBuffer> g_PointLightZBins;
+std::shared_ptr<StructuredBuffer> g_SpotLightZBins;
+// Light bitmasks for every screen tile for Z-binned rendering.
+std::shared_ptr<StructuredBuffer> g_PointLightTileMasks;
+std::shared_ptr<StructuredBuffer> g_SpotLightTileMasks;
 
-// Merge path partitions.
-std::shared_ptr<StructuredBuffer> g_MergePathPartitions;
+// The result of the last comparison of Z-binning with the light BVH on the CPU.
+struct ZBinningComparison
+{
+    bool Valid = false;
+    // CPU build times in milliseconds.
+    double ZBinningBuildTime = 0.0;
+    double BVHBuildTime = 0.0;
+    double BVHAssignLightsTime = 0.0;
+    // Memory footprint of the CPU light lists in bytes.
+    size_t ZBinningMemory = 0;
+    size_t BVHMemory = 0;
+};
+ZBinningComparison g_ZBinningComparison;
 
-// The number of threads per thread group (for Radix sort and Merge sort).
-const uint32_t SORT_NUM_THREADS_PER_THREAD_GROUP = 256;
+// The number of Z-bins between the near and far clipping planes for Z-binned rendering.
+// The Z-bins are 8 bytes each so 4096 Z-bins only require 32 KB per light type
+// regardless of the screen resolution.
+const uint32_t NUM_Z_BINS = 4096u;
 
-// The number of elements that each merge sort thread will sort.
-const uint32_t SORT_ELEMENTS_PER_THREAD = 8;
+// The number of bitmask words that are computed by a single thread group of the BuildTileMasks compute shader.
+const uint32_t TILE_MASK_NUM_THREADS = 64u;
 
-const uint32_t BVH_NUM_THREADS = 32 * 16;
+// The tile bitmasks grow with the number of tiles times the number of lights (see ZBinningCPU).
+// A warning is logged if the tile bitmasks of a light type need more memory than this.
+const size_t MAX_TILE_MASK_MEMORY = 256ull * 1024 * 1024;
 
 // A structured buffer to store random colors. Used to debug sample clusters.
 std::shared_ptr<StructuredBuffer> g_ClusterColors;
@@ -213,19 +287,29 @@ std::shared_ptr<StructuredBuffer> g_ClusterColors;
 // making the light index list 3,264,000 bytes (3.264 MB)
 const uint32_t AVERAGE_OVERLAPPING_LIGHTS_PER_TILE = 100u;
 
-// For the light index lists for clustered rendering, we need to make a guess as to the 
-// average number of overlapping lights per cluster AABB. For clustered lighting we
-// can make a more conservative estimation than was possible with Forward+ 
-// since most cluster bounding volumes will not contain any samples and therefor 
-// no lights will be assigned to the cluster. For this experiment, I will make an 
-// estimate of an average of 20 lights per cluster. This may seem too conservative
-// but considering that only about 10-15% of all clusters will contain samples, this 
-// estimate seems reasonable.
-// The total size of the light index list is determined by the cluster grid size.
-// For 1080p screen resolution, 45 deg camera field of view, and a cluster block 
-// screen size of 64x64 pixels the cluster grid will have 30x17x193 (98,430) clusters
-// * 20 light indices * 4 bytes (to store a uint) will require 7,874,400 bytes (7.874 MB).
-const uint32_t AVERAGE_OVERLAPPING_LIGHTS_PER_CLUSTER = 20u;
+// The number of light grid elements that are scanned by a single thread group 
+// of the PrefixSumLightGrid compute shader.
+const uint32_t PREFIX_SUM_ELEMENTS_PER_THREAD_GROUP = 2048u;
+
+// To detect light index lists that are too small, the light index counters are 
+// copied to a readback buffer every frame. The readback buffers are read a few 
+// frames later (when the GPU is guaranteed to be finished with the frame) and the light 
+// index list is grown if the light index counter exceeds the size of the light index list.
+const uint32_t LIGHT_INDEX_COUNTER_READBACK_FRAMES = 3u;
+
+struct LightIndexCounterReadback
+{
+    std::shared_ptr<ReadbackBuffer> Buffers[LIGHT_INDEX_COUNTER_READBACK_FRAMES];
+    // Set if the readback buffer contains the counter of the current light index list.
+    bool Valid[LIGHT_INDEX_COUNTER_READBACK_FRAMES] = {};
+    // The last light index counter that was read back.
+    uint32_t Count = 0;
+};
+
+LightIndexCounterReadback g_PointLightIndexCounterReadback[2];
+LightIndexCounterReadback g_SpotLightIndexCounterReadback[2];
+LightIndexCounterReadback g_PointLightIndexCounterReadback_Cluster;
+LightIndexCounterReadback g_SpotLightIndexCounterReadback_Cluster;
 
 // Textures for the light grids.
 std::shared_ptr<Texture> g_PointLightGrid[2];
@@ -240,26 +324,35 @@ std::shared_ptr<RenderTarget> g_ClusterSamplesRenderTarget;
 
 // Pipeline states
 std::shared_ptr<ComputePipelineState> g_UpdateLightsPSO;                        // Compute pipeline used to animate the lights.
-std::shared_ptr<ComputePipelineState> g_ReduceLightsAABB1PSO;                   // 1st pass of lights AABB reduction.
-std::shared_ptr<ComputePipelineState> g_ReduceLightsAABB2PSO;                   // 2nd pass of lights AABB reduction.
-std::shared_ptr<ComputePipelineState> g_ComputeLightMortonCodesPSO;             // Compute Morton codes for point and spot lights.
-std::shared_ptr<ComputePipelineState> g_RadixSortPSO;                           // Perform a radix sort over the Morton codes.
-std::shared_ptr<ComputePipelineState> g_MergePathPartitionsPSO;                 // Compute merge path partitions for merge sort.
-std::shared_ptr<ComputePipelineState> g_MergeSortPSO;                           // Merge sort compute shader.
-std::shared_ptr<ComputePipelineState> g_BuildBVHBottomPSO;                      // Build bottom BVH compute pipeline state.
-std::shared_ptr<ComputePipelineState> g_BuildBVHTopPSO;                         // Build top BVH compute pipeline state.
 std::shared_ptr<ComputePipelineState> g_ComputeGridFrustumsPSO;                 // Compute the grid frustums for Forward+ (only on screen resolution changes)
 std::shared_ptr<ComputePipelineState> g_ComputeClusterAABBsPSO;                 // Compute cluster AABBs (only if screen resolution changes)
 std::shared_ptr<ComputePipelineState> g_FindUniqueClustersPSO;                  // Convert cluster flags to a contagious list of cluster IDs
 std::shared_ptr<ComputePipelineState> g_UpdateIndirectArgumentBuffersPSO;       // Update the indirect argument buffers based on the number of activated clusters.
+std::shared_ptr<ComputePipelineState> g_FindMovedLightsPSO;                     // Find lights that moved since the previous frame.
+std::shared_ptr<ComputePipelineState> g_LimitMovedLightsPSO;                    // Rebuild all clusters if too many lights moved.
+std::shared_ptr<ComputePipelineState> g_FindDirtyClustersPSO;                   // Find clusters that need to be updated for incremental light assignment.
 std::shared_ptr<ComputePipelineState> g_AssignLightsToClustersPSO;              // Perform brute-force light assignment to clusters.
 std::shared_ptr<ComputePipelineState> g_AssignLightsToClustersBVHPSO;           // Perform light assignment using BVH acceleration structure.
+std::shared_ptr<ComputePipelineState> g_AssignLightsToClustersCountPSO;         // Count the lights per cluster (exact light index lists).
+std::shared_ptr<ComputePipelineState> g_AssignLightsToClustersFillPSO;          // Fill the light index lists (exact light index lists).
+std::shared_ptr<ComputePipelineState> g_AssignLightsToClustersBVHCountPSO;      // BVH version of g_AssignLightsToClustersCountPSO.
+std::shared_ptr<ComputePipelineState> g_AssignLightsToClustersBVHFillPSO;       // BVH version of g_AssignLightsToClustersFillPSO.
+std::shared_ptr<ComputePipelineState> g_PrefixSumLightGridScanGroupsPSO;        // 1st pass of the light grid prefix sum.
+std::shared_ptr<ComputePipelineState> g_PrefixSumLightGridScanGroupSumsPSO;     // 2nd pass of the light grid prefix sum.
+std::shared_ptr<ComputePipelineState> g_PrefixSumLightGridAddGroupOffsetsPSO;   // 3rd pass of the light grid prefix sum.
+std::shared_ptr<ComputePipelineState> g_ComputeLightDepthKeysPSO;               // Compute depth sort keys for point and spot lights (Z-binning).
+std::shared_ptr<ComputePipelineState> g_ComputeLightDepthKeys64PSO;             // 64-bit Morton code version of g_ComputeLightDepthKeysPSO.
+std::shared_ptr<ComputePipelineState> g_ClearZBinsPSO;                          // Reset the Z-bins.
+std::shared_ptr<ComputePipelineState> g_BuildZBinsPSO;                          // Compute the light index ranges of the Z-bins.
+std::shared_ptr<ComputePipelineState> g_BuildTileMasksPSO;                      // Compute the light bitmasks of the screen tiles.
 std::shared_ptr<GraphicsPipelineState> g_ForwardOpaquePSO;                      // Forward rendering opaque pass.
 std::shared_ptr<GraphicsPipelineState> g_ForwardTransparentPSO;                 // Forward rendering transparent pass.
 std::shared_ptr<GraphicsPipelineState> g_ForwardPlusOpaquePSO;                  // Forward+ rendering opaque pass.
 std::shared_ptr<GraphicsPipelineState> g_ForwardPlusTransparentPSO;             // Forward+ rendering transparent pass.
 std::shared_ptr<GraphicsPipelineState> g_ClusteredOpaquePSO;                    // Clustered rendering opaque pass.
 std::shared_ptr<GraphicsPipelineState> g_ClusteredTransparentPSO;               // Clustered rendering transparent pass.
+std::shared_ptr<GraphicsPipelineState> g_ZBinnedOpaquePSO;                      // Z-binned rendering opaque pass.
+std::shared_ptr<GraphicsPipelineState> g_ZBinnedTransparentPSO;                 // Z-binned rendering transparent pass.
 std::shared_ptr<GraphicsPipelineState> g_DepthPrepassPSO;                       // Depth pre-pass (used for all techniques).
 std::shared_ptr<GraphicsPipelineState> g_DebugPointLightsPSO;                   // Render point light volumes (used for debugging).
 std::shared_ptr<GraphicsPipelineState> g_DebugSpotLightsPSO;                    // Render spot light volumes (used for debugging).
@@ -277,6 +370,7 @@ RenderTechnique g_LoadingScreenTechnique;
 RenderTechnique g_ForwardRenderingTechnique;
 RenderTechnique g_ForwardPlusRenderingTechnique;
 RenderTechnique g_ClusteredRenderingTechnique;
+RenderTechnique g_ZBinnedRenderingTechnique;
 
 // A GPU fence object to synchronize rendering.
 std::shared_ptr<Fence> g_RenderFence;
@@ -287,6 +381,16 @@ std::shared_ptr<PostprocessPass> g_RenderDebugTexturePass;
 std::shared_ptr<CompositePass> g_DebugClustersPass;
 std::shared_ptr<CompositePass> g_DebugLightCountsPass;
 
+// The passes that render the scene (the render statistics of the passes are summed for the statistics window).
+std::vector<std::shared_ptr<BasePass>> g_ScenePasses;
+
+template<typename Pass>
+std::shared_ptr<Pass> AddScenePass( std::shared_ptr<Pass> pass )
+{
+    g_ScenePasses.push_back( pass );
+    return pass;
+}
+
 bool g_RenderLights = false;
 bool g_RenderDebugTexture = false;
 bool g_RenderDebugClusters = false;
@@ -375,23 +479,47 @@ void CreateLightBuffers();
 void ReadbackPointLights( void* dstBuffer, std::shared_ptr<CopyCommandBuffer> commandBuffer = nullptr );
 void ReadbackSpotLights( void* dstBuffer, std::shared_ptr<CopyCommandBuffer> commandBuffer = nullptr );
 void ReadbackDirLights( void* dstBuffer, std::shared_ptr<CopyCommandBuffer> commandBuffer = nullptr );
+void ReadbackLightBuffers();
+
+// Compare the light BVH that was built on the GPU with the CPU implementation.
+void ValidateLightBVH();
+// Log the quality of the light BVH for 30-bit and 63-bit Morton codes.
+void LogLightBVHStatistics();
 
 // Focus the camera on the currently selected light.
 void FocusCurrentLight();
 
-template<typename LightType>
-std::vector<LightType> GenerateLights( uint32_t numLights );
+// Create the light index lists for clustered rendering.
+void CreateClusterLightIndexLists( std::shared_ptr<CopyCommandBuffer> commandBuffer );
+// Create the Z-bins and screen tile light bitmasks for Z-binned rendering.
+void CreateZBinBuffers( std::shared_ptr<CopyCommandBuffer> commandBuffer );
+// The Z-bin parameters for the current camera, screen resolution and number of lights.
+ZBinParamsCB GetZBinParams();
+// Compare the build time and memory footprint of Z-binning with the light BVH on the CPU.
+void CompareZBinningAndLightBVH();
+// Compute the offsets into the light index lists from the light counts in the cluster light grids.
+void PrefixSumLightGrid( std::shared_ptr<ComputeCommandBuffer> commandBuffer );
+// Check if only the dirty clusters need to be updated during light assignment.
+bool UseIncrementalLightAssignment( uint64_t frame );
+// Find the unique clusters that are affected by lights that moved since the previous frame
+// and update the indirect argument buffer for the dirty clusters.
+void FindDirtyClusters( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts );
+// Create the buffers for incremental light assignment that depend on the number of lights.
+void CreateMovedLightBuffers( std::shared_ptr<CopyCommandBuffer> commandBuffer );
+// Copy a light index counter to a readback buffer.
+void CopyLightIndexCounter( std::shared_ptr<CopyCommandBuffer> commandBuffer, uint64_t frame,
+                            std::shared_ptr<StructuredBuffer> lightIndexCounter, LightIndexCounterReadback& readback );
+// Grow a light index list if the light index counter that was read back exceeds its size.
+// Returns true if the light index list was recreated.
+bool GrowLightIndexList( std::shared_ptr<CopyCommandBuffer> commandBuffer, uint64_t frame, LightIndexCounterReadback& readback,
+                         std::shared_ptr<StructuredBuffer>& lightIndexList, const std::wstring& name );
+void InvalidateLightIndexCounterReadback( LightIndexCounterReadback& readback );
+
 void GenerateLights();
 
 // A function to randomly generate colors.
 std::vector<glm::vec4> GenerateColors( uint32_t numColors );
 
-// Get the number of BVH levels given the number of leaf nodes.
-uint32_t GetNumLevels( uint32_t numLeaves );
-
-// Compute the number of (child) nodes needed to represent a BVH that consists of a number of leaf nodes.
-uint32_t GetNumNodes( uint32_t numLeaves );
-
 int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine, int iCmdShow )
 {
     ::CoInitializeEx(nullptr, COINIT_MULTITHREADED);
@@ -465,6 +593,11 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine
     g_Application.SetAssetSearchPaths( g_Config.GetAbsoluteSearchPaths() );
     g_Application.SetLoadingProgressTotal( g_Config.LoadingProgressTotal );
 
+    // Check the files of all assets in parallel before any asset is loaded
+    // so the staleness checks of the assets only compare hashes.
+    DependencyDatabase::Get().Load( L"../Assets/Dependencies.db" );
+    DependencyDatabase::Get().Refresh();
+
     g_WindowWidth = g_Config.WindowWidth;
     g_WindowHeight = g_Config.WindowHeight;
 
@@ -537,23 +670,33 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine
     g_ClusterSamplesDebugTexture = g_RenderDevice->CreateTexture2D( g_WindowWidth, g_WindowHeight, 1, clusterAssignmentDebugTextureFormat );
     g_ClusterSamplesDebugTexture->SetName( L"Cluster Samples Debug Texture" );
 
+    g_LightBVHBuilder = std::make_shared<LightBVHBuilder>( g_RenderDevice );
+    g_LightBVHBuilder->SetUse64BitMortonCodes( g_Use64BitMortonCodes );
+
     CreateLightBuffers();
 
     g_UpdateLightsPSO = g_RenderDevice->CreateComputePipelineState();
-    g_ReduceLightsAABB1PSO = g_RenderDevice->CreateComputePipelineState();
-    g_ReduceLightsAABB2PSO = g_RenderDevice->CreateComputePipelineState();
-    g_ComputeLightMortonCodesPSO = g_RenderDevice->CreateComputePipelineState();
-    g_RadixSortPSO = g_RenderDevice->CreateComputePipelineState();
-    g_MergePathPartitionsPSO = g_RenderDevice->CreateComputePipelineState();
-    g_MergeSortPSO = g_RenderDevice->CreateComputePipelineState();
-    g_BuildBVHBottomPSO = g_RenderDevice->CreateComputePipelineState();
-    g_BuildBVHTopPSO = g_RenderDevice->CreateComputePipelineState();
     g_ComputeGridFrustumsPSO = g_RenderDevice->CreateComputePipelineState();
     g_ComputeClusterAABBsPSO = g_RenderDevice->CreateComputePipelineState();
     g_FindUniqueClustersPSO = g_RenderDevice->CreateComputePipelineState();
     g_UpdateIndirectArgumentBuffersPSO = g_RenderDevice->CreateComputePipelineState();
+    g_FindMovedLightsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_LimitMovedLightsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_FindDirtyClustersPSO = g_RenderDevice->CreateComputePipelineState();
     g_AssignLightsToClustersPSO = g_RenderDevice->CreateComputePipelineState();
     g_AssignLightsToClustersBVHPSO = g_RenderDevice->CreateComputePipelineState();
+    g_AssignLightsToClustersCountPSO = g_RenderDevice->CreateComputePipelineState();
+    g_AssignLightsToClustersFillPSO = g_RenderDevice->CreateComputePipelineState();
+    g_AssignLightsToClustersBVHCountPSO = g_RenderDevice->CreateComputePipelineState();
+    g_AssignLightsToClustersBVHFillPSO = g_RenderDevice->CreateComputePipelineState();
+    g_PrefixSumLightGridScanGroupsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_PrefixSumLightGridScanGroupSumsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_PrefixSumLightGridAddGroupOffsetsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_ComputeLightDepthKeysPSO = g_RenderDevice->CreateComputePipelineState();
+    g_ComputeLightDepthKeys64PSO = g_RenderDevice->CreateComputePipelineState();
+    g_ClearZBinsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_BuildZBinsPSO = g_RenderDevice->CreateComputePipelineState();
+    g_BuildTileMasksPSO = g_RenderDevice->CreateComputePipelineState();
     g_DepthPrepassPSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_ForwardOpaquePSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_ForwardTransparentPSO = g_RenderDevice->CreateGraphicsPipelineState();
@@ -561,6 +704,8 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine
     g_ForwardPlusTransparentPSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_ClusteredOpaquePSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_ClusteredTransparentPSO = g_RenderDevice->CreateGraphicsPipelineState();
+    g_ZBinnedOpaquePSO = g_RenderDevice->CreateGraphicsPipelineState();
+    g_ZBinnedTransparentPSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_DebugPointLightsPSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_DebugSpotLightsPSO = g_RenderDevice->CreateGraphicsPipelineState();
     g_DebugDepthTexturePSO = g_RenderDevice->CreateGraphicsPipelineState();
@@ -673,6 +818,12 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR szCmdLine
     // If that happens, we need to wait for the task to complete before releasing all the resources.
     g_LoadingTask.get();
 
+    // Wait for the texture streaming loads that are still running on the thread pool.
+    g_TextureStreamer.reset();
+
+    // Store the hashes of the files that were modified at runtime.
+    DependencyDatabase::Get().Save();
+
     Profiler::Shutdown();
     GUI::Shutdown();
     LogManager::Shutdown();
@@ -716,6 +867,21 @@ bool LoadAssets()
 
     auto scene = g_RenderDevice->CreateScene();
     scene->LoadingProgress += &OnLoadingProgress;
+    scene->SetVertexFormat( g_Config.CompactVertices ? Mesh::VertexFormat::Compact : Mesh::VertexFormat::Standard );
+    scene->SetOptimizeOverdraw( g_Config.OptimizeOverdraw );
+    scene->SetSortTransparentTriangles( g_Config.SortTransparentTriangles );
+    if ( g_Config.CompressTextures )
+    {
+        scene->SetTextureCompression( g_Config.HighQualityTextureCompression ? TextureCompression::HighQuality : TextureCompression::Default );
+
+        // Only cooked textures can be streamed.
+        if ( g_Config.StreamTextures )
+        {
+            g_TextureStreamer = std::make_shared<TextureStreamerDX12>();
+            g_TextureStreamer->SetMemoryBudget( static_cast<size_t>( g_Config.TextureMemoryBudget ) * 1024 * 1024 );
+            scene->SetTextureStreamer( g_TextureStreamer );
+        }
+    }
     LogManager::LogInfo( L"Loading Scene: ", g_Config.SceneFileName );
     if ( !scene->LoadFromFile( commandBuffer, g_Config.SceneFileName ) )
     {
@@ -725,6 +891,11 @@ bool LoadAssets()
 
     scene->GetRootNode()->SetLocalTransform( glm::scale( glm::vec3( g_Config.SceneScaleFactor ) ) );
 
+    if ( g_TextureStreamer )
+    {
+        g_TextureStreamer->AddScene( scene );
+    }
+
     g_Application.IncrementLoadingProgress();
 
     // Load some scenes that are used to represent lights.
@@ -784,71 +955,41 @@ bool LoadAssets()
 
     g_Application.IncrementLoadingProgress();
 
-    // Setup a compute pipeline state object to reduce the lights AABB.
-    auto reduceLightsAABB1CS = g_RenderDevice->CreateShader();
-    reduceLightsAABB1CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ReduceLightsAABB_CS.hlsl", "reduce1" );
-
-    g_ReduceLightsAABB1PSO->SetShader( reduceLightsAABB1CS );
-
-    g_Application.IncrementLoadingProgress();
-
-    auto reduceLightsAABB2CS = g_RenderDevice->CreateShader();
-    reduceLightsAABB2CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ReduceLightsAABB_CS.hlsl", "reduce2" );
-
-    g_ReduceLightsAABB2PSO->SetShader( reduceLightsAABB2CS );
-
-    g_Application.IncrementLoadingProgress();
-
-    // Setup a compute pipeline state to compute the light Morton codes.
-    auto computeLightMortonCodesCS = g_RenderDevice->CreateShader();
-    computeLightMortonCodesCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeLightMortonCodes_CS.hlsl" );
-
-    g_ComputeLightMortonCodesPSO->SetShader( computeLightMortonCodesCS );
-
-    g_Application.IncrementLoadingProgress();
-
-    // Setup a pipeline state to sort the Morton code values.
-    ShaderMacros sortShaderMacros;
-    sortShaderMacros["NUM_THREADS"] = std::to_string( SORT_NUM_THREADS_PER_THREAD_GROUP );
-    sortShaderMacros["NUM_VALUES_PER_THREAD"] = std::to_string( SORT_ELEMENTS_PER_THREAD );
-
-    auto radixSortCS = g_RenderDevice->CreateShader();
-    radixSortCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/RadixSort_CS.hlsl", "main", sortShaderMacros );
-
-    g_RadixSortPSO->SetShader( radixSortCS );
+    // Setup the compute pipeline states to build the light BVH.
+    g_LightBVHBuilder->LoadShaders();
 
     g_Application.IncrementLoadingProgress();
 
-    // Setup compute pipeline for computing merge path partitions.
-    auto mergePathPartitionsCS = g_RenderDevice->CreateShader();
-    mergePathPartitionsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/MergeSort_CS.hlsl", "MergePathPartitions_CS", sortShaderMacros );
+    // Setup compute pipelines for Z-binning.
+    // The depth keys are written to the Morton code buffers so that the lights
+    // can be sorted by depth with the same sort passes as the Morton codes.
+    auto computeLightDepthKeysCS = g_RenderDevice->CreateShader();
+    computeLightDepthKeysCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeLightMortonCodes_CS.hlsl", "DepthKeys" );
 
-    g_MergePathPartitionsPSO->SetShader( mergePathPartitionsCS );
+    g_ComputeLightDepthKeysPSO->SetShader( computeLightDepthKeysCS );
 
-    g_Application.IncrementLoadingProgress();
+    auto computeLightDepthKeys64CS = g_RenderDevice->CreateShader();
+    computeLightDepthKeys64CS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/ComputeLightMortonCodes_CS.hlsl", "DepthKeys", mortonCode64ShaderMacros );
 
-    // Setup a compute pipeline for merge sort.
-    auto mergeSortCS = g_RenderDevice->CreateShader();
-    mergeSortCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/MergeSort_CS.hlsl", "MergeSort", sortShaderMacros );
+    g_ComputeLightDepthKeys64PSO->SetShader( computeLightDepthKeys64CS );
 
-    g_MergeSortPSO->SetShader( mergeSortCS );
+    ShaderMacros zBinningShaderMacros;
+    zBinningShaderMacros["NUM_WORD_THREADS"] = std::to_string( TILE_MASK_NUM_THREADS );
 
-    g_Application.IncrementLoadingProgress();
+    auto clearZBinsCS = g_RenderDevice->CreateShader();
+    clearZBinsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildZBins_CS.hlsl", "ClearZBins", zBinningShaderMacros );
 
-    // Setup a compute pipeline for BVH building.
-    // Compute shader to build bottom level of BVH
-    auto buildBVHBottomCS = g_RenderDevice->CreateShader();
-    buildBVHBottomCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildBVH_CS.hlsl", "BuildBottom" );
+    g_ClearZBinsPSO->SetShader( clearZBinsCS );
 
-    g_BuildBVHBottomPSO->SetShader( buildBVHBottomCS );
+    auto buildZBinsCS = g_RenderDevice->CreateShader();
+    buildZBinsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildZBins_CS.hlsl", "BuildZBins", zBinningShaderMacros );
 
-    g_Application.IncrementLoadingProgress();
+    g_BuildZBinsPSO->SetShader( buildZBinsCS );
 
-    // Compute shader to build upper levels of the BVH.
-    auto buildBVHTopCS = g_RenderDevice->CreateShader();
-    buildBVHTopCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildBVH_CS.hlsl", "BuildTop" );
+    auto buildTileMasksCS = g_RenderDevice->CreateShader();
+    buildTileMasksCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/BuildZBins_CS.hlsl", "BuildTileMasks", zBinningShaderMacros );
 
-    g_BuildBVHTopPSO->SetShader( buildBVHTopCS );
+    g_BuildTileMasksPSO->SetShader( buildTileMasksCS );
 
     g_Application.IncrementLoadingProgress();
 
@@ -873,9 +1014,16 @@ bool LoadAssets()
 
     g_Application.IncrementLoadingProgress();
 
+    // The vertex shaders that are used to render the scene must match the vertex format of the scene.
+    ShaderMacros sceneVertexShaderMacros;
+    if ( scene->GetVertexFormat() == Mesh::VertexFormat::Compact )
+    {
+        sceneVertexShaderMacros["COMPACT_VERTICES"] = "1";
+    }
+
     // Load a common vertex shader that is used for the depth prepass.
     auto simpleVS = g_RenderDevice->CreateShader();
-    simpleVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/Simple_VS.hlsl" );
+    simpleVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/Simple_VS.hlsl", "main", sceneVertexShaderMacros );
 
     g_Application.IncrementLoadingProgress();
 
@@ -922,7 +1070,7 @@ bool LoadAssets()
     auto clusterSamplesVS = g_RenderDevice->CreateShader();
     auto clusterSamplesPS = g_RenderDevice->CreateShader();
 
-    clusterSamplesVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/ClusterSamples_VS.hlsl" );
+    clusterSamplesVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/ClusterSamples_VS.hlsl", "main", sceneVertexShaderMacros );
     g_Application.IncrementLoadingProgress();
 
     clusterSamplesPS->LoadShaderFromFile( ShaderType::Pixel, L"../Assets/shaders/ClusterSamples_PS.hlsl" );
@@ -940,6 +1088,20 @@ bool LoadAssets()
 
     g_Application.IncrementLoadingProgress();
 
+    auto findMovedLightsCS = g_RenderDevice->CreateShader();
+    findMovedLightsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/FindDirtyClusters_CS.hlsl", "FindMovedLights" );
+    g_FindMovedLightsPSO->SetShader( findMovedLightsCS );
+
+    auto limitMovedLightsCS = g_RenderDevice->CreateShader();
+    limitMovedLightsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/FindDirtyClusters_CS.hlsl", "LimitMovedLights" );
+    g_LimitMovedLightsPSO->SetShader( limitMovedLightsCS );
+
+    auto findDirtyClustersCS = g_RenderDevice->CreateShader();
+    findDirtyClustersCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/FindDirtyClusters_CS.hlsl", "FindDirtyClusters" );
+    g_FindDirtyClustersPSO->SetShader( findDirtyClustersCS );
+
+    g_Application.IncrementLoadingProgress();
+
     auto assignLightsToClustersCS = g_RenderDevice->CreateShader();
     assignLightsToClustersCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClusters_CS.hlsl" );
     g_AssignLightsToClustersPSO->SetShader( assignLightsToClustersCS );
@@ -950,6 +1112,42 @@ bool LoadAssets()
     assignLightsToClustersBVHCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClustersBVH_CS.hlsl" );
     g_AssignLightsToClustersBVHPSO->SetShader( assignLightsToClustersBVHCS );
 
+    // Two pass versions of the light assignment compute shaders for exact light index lists.
+    ShaderMacros countLightsShaderMacros;
+    countLightsShaderMacros["COUNT_LIGHTS"] = "1";
+
+    ShaderMacros fillLightsShaderMacros;
+    fillLightsShaderMacros["FILL_LIGHTS"] = "1";
+
+    auto assignLightsToClustersCountCS = g_RenderDevice->CreateShader();
+    assignLightsToClustersCountCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClusters_CS.hlsl", "main", countLightsShaderMacros );
+    g_AssignLightsToClustersCountPSO->SetShader( assignLightsToClustersCountCS );
+
+    auto assignLightsToClustersFillCS = g_RenderDevice->CreateShader();
+    assignLightsToClustersFillCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClusters_CS.hlsl", "main", fillLightsShaderMacros );
+    g_AssignLightsToClustersFillPSO->SetShader( assignLightsToClustersFillCS );
+
+    auto assignLightsToClustersBVHCountCS = g_RenderDevice->CreateShader();
+    assignLightsToClustersBVHCountCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClustersBVH_CS.hlsl", "main", countLightsShaderMacros );
+    g_AssignLightsToClustersBVHCountPSO->SetShader( assignLightsToClustersBVHCountCS );
+
+    auto assignLightsToClustersBVHFillCS = g_RenderDevice->CreateShader();
+    assignLightsToClustersBVHFillCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/AssignLightsToClustersBVH_CS.hlsl", "main", fillLightsShaderMacros );
+    g_AssignLightsToClustersBVHFillPSO->SetShader( assignLightsToClustersBVHFillCS );
+
+    // Compute the offsets into the light index lists (exact light index lists).
+    auto prefixSumLightGridScanGroupsCS = g_RenderDevice->CreateShader();
+    prefixSumLightGridScanGroupsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/PrefixSumLightGrid_CS.hlsl", "ScanGroups" );
+    g_PrefixSumLightGridScanGroupsPSO->SetShader( prefixSumLightGridScanGroupsCS );
+
+    auto prefixSumLightGridScanGroupSumsCS = g_RenderDevice->CreateShader();
+    prefixSumLightGridScanGroupSumsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/PrefixSumLightGrid_CS.hlsl", "ScanGroupSums" );
+    g_PrefixSumLightGridScanGroupSumsPSO->SetShader( prefixSumLightGridScanGroupSumsCS );
+
+    auto prefixSumLightGridAddGroupOffsetsCS = g_RenderDevice->CreateShader();
+    prefixSumLightGridAddGroupOffsetsCS->LoadShaderFromFile( ShaderType::Compute, L"../Assets/shaders/PrefixSumLightGrid_CS.hlsl", "AddGroupOffsets" );
+    g_PrefixSumLightGridAddGroupOffsetsPSO->SetShader( prefixSumLightGridAddGroupOffsetsCS );
+
     g_Application.IncrementLoadingProgress();
 
     // Load a set of shaders that can be used to visualize the active clusters in the cluster grid.
@@ -984,7 +1182,7 @@ bool LoadAssets()
 
     // Load forward rendering shaders.
     auto forwardVS = g_RenderDevice->CreateShader();
-    forwardVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/Forward_VS.hlsl" );
+    forwardVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/Forward_VS.hlsl", "main", sceneVertexShaderMacros );
 
     g_Application.IncrementLoadingProgress();
 
@@ -995,7 +1193,7 @@ bool LoadAssets()
 
     // Load forward plus shaders.
     auto forwardPlusVS = g_RenderDevice->CreateShader();
-    forwardPlusVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/ForwardPlus_VS.hlsl" );
+    forwardPlusVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/ForwardPlus_VS.hlsl", "main", sceneVertexShaderMacros );
 
     g_Application.IncrementLoadingProgress();
 
@@ -1006,7 +1204,7 @@ bool LoadAssets()
 
     // Load clustered shaders.
     auto clusteredVS = g_RenderDevice->CreateShader();
-    clusteredVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/Clustered_VS.hlsl" );
+    clusteredVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/Clustered_VS.hlsl", "main", sceneVertexShaderMacros );
 
     g_Application.IncrementLoadingProgress();
 
@@ -1015,6 +1213,15 @@ bool LoadAssets()
 
     g_Application.IncrementLoadingProgress();
 
+    // Load Z-binned shaders.
+    auto zBinnedVS = g_RenderDevice->CreateShader();
+    zBinnedVS->LoadShaderFromFile( ShaderType::Vertex, L"../Assets/shaders/ZBinned_VS.hlsl", "main", sceneVertexShaderMacros );
+
+    auto zBinnedPS = g_RenderDevice->CreateShader();
+    zBinnedPS->LoadShaderFromFile( ShaderType::Pixel, L"../Assets/shaders/ZBinned_PS.hlsl" );
+
+    g_Application.IncrementLoadingProgress();
+
     // Setup depth prepass pipeline state object.
     g_DepthPrepassPSO->SetShader( ShaderType::Vertex, simpleVS );
     g_DepthPrepassPSO->SetShader( ShaderType::Pixel, depthPrePassPS );
@@ -1070,6 +1277,20 @@ bool LoadAssets()
     g_ClusteredTransparentPSO->GetBlendState().SetBlendMode( alphaBlending );
     g_ClusteredTransparentPSO->GetRasterizerState().SetCullMode( CullMode::None );
 
+    // Setup Z-binned opaque pipeline state.
+    g_ZBinnedOpaquePSO->SetShader( ShaderType::Vertex, zBinnedVS );
+    g_ZBinnedOpaquePSO->SetShader( ShaderType::Pixel, zBinnedPS );
+    g_ZBinnedOpaquePSO->SetRenderTarget( g_RenderWindow->GetRenderTarget() );
+    g_ZBinnedOpaquePSO->GetDepthStencilState().SetDepthMode( depthFuncLessEqual );
+
+    // Setup Z-binned transparent pipeline state.
+    g_ZBinnedTransparentPSO->SetShader( ShaderType::Vertex, zBinnedVS );
+    g_ZBinnedTransparentPSO->SetShader( ShaderType::Pixel, zBinnedPS );
+    g_ZBinnedTransparentPSO->SetRenderTarget( g_RenderWindow->GetRenderTarget() );
+    g_ZBinnedTransparentPSO->GetDepthStencilState().SetDepthMode( disableDepthWrite );
+    g_ZBinnedTransparentPSO->GetBlendState().SetBlendMode( alphaBlending );
+    g_ZBinnedTransparentPSO->GetRasterizerState().SetCullMode( CullMode::None );
+
     // Setup a pipeline state to debug the cluster assignments.
     g_DebugClustersPSO->SetShader( ShaderType::Vertex, debugClustersVS );
     g_DebugClustersPSO->SetShader( ShaderType::Geometry, debugClustersGS );
@@ -1123,7 +1344,7 @@ bool LoadAssets()
             }
         } ) )
         .AddPass( std::make_shared<PushProfileMarkerPass>( L"Depth Pre Pass" ) )
-        .AddPass( std::make_shared<OpaquePass>( scene, g_DepthPrepassPSO ) )
+        .AddPass( AddScenePass( std::make_shared<OpaquePass>( scene, g_DepthPrepassPSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Depth Pre Pass" marker.
         ;
 #pragma endregion
@@ -1221,10 +1442,10 @@ bool LoadAssets()
         .AddPass( depthPrepass )
         .AddPass( std::make_shared<PushProfileMarkerPass>( L"Main Render" ) )
         .AddPass( std::make_shared<PushProfileMarkerPass>( L"Opaque Pass" ) )
-        .AddPass( std::make_shared<OpaquePass>( scene, g_ForwardOpaquePSO ) )
+        .AddPass( AddScenePass( std::make_shared<OpaquePass>( scene, g_ForwardOpaquePSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Opaque Pass" marker.
         .AddPass( std::make_shared<PushProfileMarkerPass>( L"Transparent Pass" ) )
-        .AddPass( std::make_shared<TransparentPass>( scene, g_ForwardTransparentPSO ) )
+        .AddPass( AddScenePass( std::make_shared<TransparentPass>( scene, g_ForwardTransparentPSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Transparent Pass" marker.
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Main Render" marker.
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Forward Rendering" marker.
@@ -1264,6 +1485,12 @@ bool LoadAssets()
 
                 for ( uint32_t i = 0; i < 2; ++i )
                 {
+                    // Grow the light index lists if they were too small a few frames ago.
+                    GrowLightIndexList( e.GraphicsCommandBuffer, e.FrameCounter, g_PointLightIndexCounterReadback[i], g_PointLightIndexList[i],
+                                        std::wstring( L"Point Light Index List " ) + ( ( i == 0 ) ? L"(Opaque)" : L"(Transparent)" ) );
+                    GrowLightIndexList( e.GraphicsCommandBuffer, e.FrameCounter, g_SpotLightIndexCounterReadback[i], g_SpotLightIndexList[i],
+                                        std::wstring( L"Spot Light Index List " ) + ( ( i == 0 ) ? L"(Opaque)" : L"(Transparent)" ) );
+
                     e.GraphicsCommandBuffer->ClearResourceUInt( g_PointLightIndexCounter[i] );
                     e.GraphicsCommandBuffer->ClearResourceUInt( g_PointLightGrid[i] );
                     e.GraphicsCommandBuffer->ClearResourceUInt( g_SpotLightIndexCounter[i] );
@@ -1288,6 +1515,12 @@ bool LoadAssets()
                 e.GraphicsCommandBuffer->BindComputeShaderArguments( 3, 17, { g_SpotLightGrid[0], g_SpotLightGrid[1] } );
 
                 e.GraphicsCommandBuffer->Dispatch( dispatchParams.NumThreadGroups );
+
+                for ( uint32_t i = 0; i < 2; ++i )
+                {
+                    CopyLightIndexCounter( e.GraphicsCommandBuffer, e.FrameCounter, g_PointLightIndexCounter[i], g_PointLightIndexCounterReadback[i] );
+                    CopyLightIndexCounter( e.GraphicsCommandBuffer, e.FrameCounter, g_SpotLightIndexCounter[i], g_SpotLightIndexCounterReadback[i] );
+                }
             }
         } ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Light Culling" profiling marker.
@@ -1312,7 +1545,7 @@ bool LoadAssets()
                 e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 13, { g_PointLightGrid[0], g_SpotLightGrid[0] } );
             }
         } ) )
-        .AddPass( std::make_shared<OpaquePass>( scene, g_ForwardPlusOpaquePSO ) )
+        .AddPass( AddScenePass( std::make_shared<OpaquePass>( scene, g_ForwardPlusOpaquePSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Opaque Pass" profiling marker.
 #pragma endregion
 
@@ -1335,7 +1568,7 @@ bool LoadAssets()
                 e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 13, { g_PointLightGrid[1], g_SpotLightGrid[1] } );
             }
         } ) )
-        .AddPass( std::make_shared<TransparentPass>( scene, g_ForwardPlusTransparentPSO ) )
+        .AddPass( AddScenePass( std::make_shared<TransparentPass>( scene, g_ForwardPlusTransparentPSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Transparent Pass" profiling marker.
 #pragma endregion
         .AddPass( g_DebugLightsPass )
@@ -1366,7 +1599,7 @@ bool LoadAssets()
                 e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 0, { g_ClusterColors } );
             }
         } ) )
-        .AddPass( std::make_shared<BasePass>( scene, g_ClusterSamplesPSO, false ) )    // Render both opaque and transparent geometry (without materials)
+        .AddPass( AddScenePass( std::make_shared<BasePass>( scene, g_ClusterSamplesPSO, false ) ) )    // Render both opaque and transparent geometry (without materials)
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Cluster Samples" marker.
         .AddPass( std::make_shared<PushProfileMarkerPass>( L"Find Unique Clusters" ) )
         .AddPass( std::make_shared<InvokeFunctionPass>( [] ( Core::RenderEventArgs& e )
@@ -1423,52 +1656,120 @@ bool LoadAssets()
                     break;
                 }
 
-                // Clear the global light counters and light grids.
-                e.GraphicsCommandBuffer->ClearResourceUInt( g_PointLightIndexCounter_Cluster );
-                e.GraphicsCommandBuffer->ClearResourceUInt( g_SpotLightIndexCounter_Cluster );
-                e.GraphicsCommandBuffer->ClearResourceUInt( g_PointLightGrid_Cluster );
-                e.GraphicsCommandBuffer->ClearResourceUInt( g_SpotLightGrid_Cluster );
+                // Grow the light index lists if they were too small a few frames ago.
+                // The light lists of the previous frame are lost if a light index list is recreated.
+                if ( GrowLightIndexList( e.GraphicsCommandBuffer, e.FrameCounter, g_PointLightIndexCounterReadback_Cluster, g_PointLightIndexList_Cluster, L"Point Light Index List (Clustered)" ) )
+                {
+                    g_ClusterLightListsValid = false;
+                }
+                if ( GrowLightIndexList( e.GraphicsCommandBuffer, e.FrameCounter, g_SpotLightIndexCounterReadback_Cluster, g_SpotLightIndexList_Cluster, L"Spot Light Index List (Clustered)" ) )
+                {
+                    g_ClusterLightListsValid = false;
+                }
 
                 LightCountsCB lightCounts;
                 lightCounts.NumPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
                 lightCounts.NumSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
                 lightCounts.NumDirectionalLights = static_cast<uint32_t>( g_Config.DirectionalLights.size() );
 
+                bool incremental = UseIncrementalLightAssignment( e.FrameCounter );
+                if ( incremental )
+                {
+                    // Only the light lists of the dirty clusters are appended to the light index lists.
+                    // The light lists of all other clusters are kept from the previous frame.
+                    ScopedProfileMarker findDirtyClustersMarker( L"Find Dirty Clusters", e.GraphicsCommandBuffer );
+                    FindDirtyClusters( e.GraphicsCommandBuffer, lightCounts );
+                }
+                else
+                {
+                    // Clear the global light counters and light grids.
+                    e.GraphicsCommandBuffer->ClearResourceUInt( g_PointLightIndexCounter_Cluster );
+                    e.GraphicsCommandBuffer->ClearResourceUInt( g_SpotLightIndexCounter_Cluster );
+                    e.GraphicsCommandBuffer->ClearResourceUInt( g_PointLightGrid_Cluster );
+                    e.GraphicsCommandBuffer->ClearResourceUInt( g_SpotLightGrid_Cluster );
+                }
+
+                // Assign lights to all unique clusters or only to the dirty clusters.
+                auto clusters = incremental ? g_DirtyClusters : g_UniqueClusters;
+                auto argumentBuffer = incremental ? g_AssignLightsToDirtyClustersArgumentBuffer : g_AssignLightsToClustersArgumentBuffer;
+
                 BVHParams bvhParams = {};
-                bvhParams.PointLightLevels = GetNumLevels( lightCounts.NumPointLights );
-                bvhParams.SpotLightLevels = GetNumLevels( lightCounts.NumSpotLights );
+                bvhParams.PointLightLevels = LightBVHCPU::GetNumLevels( lightCounts.NumPointLights );
+                bvhParams.SpotLightLevels = LightBVHCPU::GetNumLevels( lightCounts.NumSpotLights );
 
-                // Bind Compute PSO
-                switch ( g_RenderingTechnique )
+                auto assignLights = [&]( std::shared_ptr<ComputePipelineState> assignLightsPSO, std::shared_ptr<ComputePipelineState> assignLightsBVHPSO )
                 {
-                case RenderingTechnique::Clustered:
-                    e.GraphicsCommandBuffer->BindComputePipelineState( g_AssignLightsToClustersPSO );
-                    // Bind arguments.
-                    e.GraphicsCommandBuffer->BindCompute32BitConstants( 0, lightCounts );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 2, { g_UniqueClusters, g_ClusterAABBs } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 4, { g_PointLightIndexCounter_Cluster, g_SpotLightIndexCounter_Cluster } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 6, { g_PointLightGrid_Cluster, g_SpotLightGrid_Cluster } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 8, { g_PointLightIndexList_Cluster, g_SpotLightIndexList_Cluster } );
-                    break;
-                case RenderingTechnique::Clustered_Optimized:
-                    e.GraphicsCommandBuffer->BindComputePipelineState( g_AssignLightsToClustersBVHPSO );
-                    // Bind arguments.
-                    e.GraphicsCommandBuffer->BindCompute32BitConstants( 0, bvhParams );
-                    e.GraphicsCommandBuffer->BindCompute32BitConstants( 1, lightCounts );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 2, { g_UniqueClusters, g_ClusterAABBs } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 4, { g_PointLightIndices, g_SpotLightIndices } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 6, { g_PointLightBVH, g_SpotLightBVH } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 8, { g_PointLightIndexCounter_Cluster, g_SpotLightIndexCounter_Cluster } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 10, { g_PointLightGrid_Cluster, g_SpotLightGrid_Cluster } );
-                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 12, { g_PointLightIndexList_Cluster, g_SpotLightIndexList_Cluster } );
-                    break;
+                    // Bind Compute PSO
+                    switch ( g_RenderingTechnique )
+                    {
+                    case RenderingTechnique::Clustered:
+                        e.GraphicsCommandBuffer->BindComputePipelineState( assignLightsPSO );
+                        // Bind arguments.
+                        e.GraphicsCommandBuffer->BindCompute32BitConstants( 0, lightCounts );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 2, { clusters, g_ClusterAABBs } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 4, { g_PointLightIndexCounter_Cluster, g_SpotLightIndexCounter_Cluster } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 6, { g_PointLightGrid_Cluster, g_SpotLightGrid_Cluster } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 1, 8, { g_PointLightIndexList_Cluster, g_SpotLightIndexList_Cluster } );
+                        break;
+                    case RenderingTechnique::Clustered_Optimized:
+                        e.GraphicsCommandBuffer->BindComputePipelineState( assignLightsBVHPSO );
+                        // Bind arguments.
+                        e.GraphicsCommandBuffer->BindCompute32BitConstants( 0, bvhParams );
+                        e.GraphicsCommandBuffer->BindCompute32BitConstants( 1, lightCounts );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 2, { clusters, g_ClusterAABBs } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 4, { g_LightBVHBuilder->GetPointLightIndices(), g_LightBVHBuilder->GetSpotLightIndices() } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 6, { g_LightBVHBuilder->GetPointLightBVH(), g_LightBVHBuilder->GetSpotLightBVH() } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 8, { g_PointLightIndexCounter_Cluster, g_SpotLightIndexCounter_Cluster } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 10, { g_PointLightGrid_Cluster, g_SpotLightGrid_Cluster } );
+                        e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 12, { g_PointLightIndexList_Cluster, g_SpotLightIndexList_Cluster } );
+                        break;
+                    }
+
+                    // Indirect Dispatch the AssignLightsToClusters compute shader based on the number of clusters that were counted
+                    // in the FindUniqueClusters (or FindDirtyClusters) compute shader.
+                    e.GraphicsCommandBuffer->ExecuteIndirect( g_AssignLightToClustersCommandSignature, argumentBuffer );
+                };
+
+                if ( g_ExactLightIndexLists )
+                {
+                    {
+                        ScopedProfileMarker countLightsMarker( L"Count Lights", e.GraphicsCommandBuffer );
+                        assignLights( g_AssignLightsToClustersCountPSO, g_AssignLightsToClustersBVHCountPSO );
+                    }
+                    {
+                        ScopedProfileMarker prefixSumMarker( L"Prefix Sum", e.GraphicsCommandBuffer );
+                        PrefixSumLightGrid( e.GraphicsCommandBuffer );
+                    }
+                    {
+                        ScopedProfileMarker fillLightsMarker( L"Fill Lights", e.GraphicsCommandBuffer );
+                        assignLights( g_AssignLightsToClustersFillPSO, g_AssignLightsToClustersBVHFillPSO );
+                    }
+                }
+                else
+                {
+                    assignLights( g_AssignLightsToClustersPSO, g_AssignLightsToClustersBVHPSO );
                 }
 
-                // Indirect Dispatch the AssignLightsToClusters compute shader based on the number of clusters that were counted
-                // in the FindUniqueClusters compute shader.
-                e.GraphicsCommandBuffer->ExecuteIndirect( g_AssignLightToClustersCommandSignature, g_AssignLightsToClustersArgumentBuffer );
+                CopyLightIndexCounter( e.GraphicsCommandBuffer, e.FrameCounter, g_PointLightIndexCounter_Cluster, g_PointLightIndexCounterReadback_Cluster );
+                CopyLightIndexCounter( e.GraphicsCommandBuffer, e.FrameCounter, g_SpotLightIndexCounter_Cluster, g_SpotLightIndexCounterReadback_Cluster );
+
+                if ( g_IncrementalLightAssignment )
+                {
+                    // Keep the lights and cluster flags to find the dirty clusters in the next frame.
+                    e.GraphicsCommandBuffer->CopyResource( g_PreviousPointLightsBuffer, g_PointLightsBuffer );
+                    e.GraphicsCommandBuffer->CopyResource( g_PreviousSpotLightsBuffer, g_SpotLightsBuffer );
+                    e.GraphicsCommandBuffer->CopyResource( g_PreviousClusterFlags, g_ClusterFlags );
+
+                    g_ClusterLightListsValid = true;
+                    g_ClusterLightListsFrame = e.FrameCounter;
+                    g_ClusterLightListsViewMatrix = g_Camera->GetViewMatrix();
+                }
+                else
+                {
+                    g_ClusterLightListsValid = false;
+                }
 
                 switch ( g_RenderingTechnique )
                 {
@@ -1499,14 +1800,15 @@ bool LoadAssets()
                 e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 11, { g_PointLightIndexList_Cluster, g_SpotLightIndexList_Cluster } );
                 e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 13, { g_PointLightGrid_Cluster, g_SpotLightGrid_Cluster } );
 
-                // HACK: The cluster data has to go in slot 4 because the BasePass binds the material's textures to slot 3!.
-                e.GraphicsCommandBuffer->BindGraphics32BitConstants( 4, g_ClusterDataCB );
+                // HACK: The cluster data has to go in slot 5 because the BasePass binds the material's textures to slot 3
+                // and the instances to slot 4!.
+                e.GraphicsCommandBuffer->BindGraphics32BitConstants( 5, g_ClusterDataCB );
             }
         } ) )
-        .AddPass( std::make_shared<OpaquePass>( scene, g_ClusteredOpaquePSO ) )
+        .AddPass( AddScenePass( std::make_shared<OpaquePass>( scene, g_ClusteredOpaquePSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Opaque Pass" profiling marker.
         .AddPass( std::make_shared<PushProfileMarkerPass>( L"Transparent Pass" ) )
-        .AddPass( std::make_shared<TransparentPass>( scene, g_ClusteredTransparentPSO ) )
+        .AddPass( AddScenePass( std::make_shared<TransparentPass>( scene, g_ClusteredTransparentPSO ) ) )
         .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Transparent Pass" profiling marker.
         .AddPass( g_DebugClustersPass )
         .AddPass( g_DebugLightsPass )
@@ -1515,6 +1817,112 @@ bool LoadAssets()
         ;
 #pragma endregion
 
+#pragma region Z-Binned Rendering
+    // Bind the light buffers, sorted light indices, Z-bins and tile masks for the Z-binned opaque and transparent passes.
+    auto bindZBinnedArguments = [] ( Core::RenderEventArgs& e, std::shared_ptr<GraphicsPipelineState> pipelineState )
+    {
+        e.GraphicsCommandBuffer->BindGraphicsShaderSignature( pipelineState->GetShaderSignature() );
+
+        LightCountsCB lightCounts;
+        lightCounts.NumPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
+        lightCounts.NumSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
+        lightCounts.NumDirectionalLights = static_cast<uint32_t>( g_Config.DirectionalLights.size() );
+
+        ZBinParamsCB zBinParams = GetZBinParams();
+
+        e.GraphicsCommandBuffer->BindGraphics32BitConstants( 2, lightCounts );
+        e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 8, { g_PointLightsBuffer, g_SpotLightsBuffer, g_DirectionalLightsBuffer } );
+        e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 11, { g_LightBVHBuilder->GetPointLightIndices(), g_LightBVHBuilder->GetSpotLightIndices() } );
+        e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 13, { g_PointLightZBins, g_SpotLightZBins } );
+        e.GraphicsCommandBuffer->BindGraphicsShaderArguments( 3, 15, { g_PointLightTileMasks, g_SpotLightTileMasks } );
+
+        // The Z-bin parameters go in slot 5 because the BasePass binds the material's textures to slot 3 and the instances to slot 4.
+        e.GraphicsCommandBuffer->BindGraphics32BitConstants( 5, zBinParams );
+    };
+
+    g_ZBinnedRenderingTechnique
+        .AddPass( std::make_shared<PushProfileMarkerPass>( L"Z-Binned Rendering" ) )
+        .AddPass( std::make_shared<ClearRenderTargetPass>( g_RenderWindow->GetRenderTarget(), ClearFlags::All, ClearColor::CornflowerBlue ) )
+        .AddPass( depthPrepass )
+        .AddPass( std::make_shared<PushProfileMarkerPass>( L"Build Z-Bins" ) )
+        .AddPass( std::make_shared<InvokeFunctionPass>( [] ( Core::RenderEventArgs& e )
+        {
+            if ( e.GraphicsCommandBuffer )
+            {
+                LightCountsCB lightCounts;
+                lightCounts.NumPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
+                lightCounts.NumSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
+                lightCounts.NumDirectionalLights = static_cast<uint32_t>( g_Config.DirectionalLights.size() );
+
+                ZBinParamsCB zBinParams = GetZBinParams();
+
+                auto bindArguments = [&]( std::shared_ptr<ComputePipelineState> pipelineState )
+                {
+                    e.GraphicsCommandBuffer->BindComputePipelineState( pipelineState );
+
+                    e.GraphicsCommandBuffer->BindCompute32BitConstants( 0, zBinParams );
+                    e.GraphicsCommandBuffer->BindCompute32BitConstants( 1, lightCounts );
+                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
+                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 2, { g_GridFrustums } );
+                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 3, { g_LightBVHBuilder->GetPointLightIndices(), g_LightBVHBuilder->GetSpotLightIndices() } );
+                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 5, { g_PointLightZBins, g_SpotLightZBins } );
+                    e.GraphicsCommandBuffer->BindComputeShaderArguments( 2, 7, { g_PointLightTileMasks, g_SpotLightTileMasks } );
+                };
+
+                {
+                    ScopedProfileMarker clearZBins( L"Clear Z-Bins", e.GraphicsCommandBuffer );
+
+                    bindArguments( g_ClearZBinsPSO );
+                    e.GraphicsCommandBuffer->Dispatch( static_cast<uint32_t>( glm::ceil( zBinParams.NumZBins / 1024.0f ) ) );
+                }
+
+                e.GraphicsCommandBuffer->AddUAVBarrier( g_PointLightZBins );
+                e.GraphicsCommandBuffer->AddUAVBarrier( g_SpotLightZBins );
+
+                {
+                    ScopedProfileMarker buildZBins( L"Build Z-Bins", e.GraphicsCommandBuffer );
+
+                    bindArguments( g_BuildZBinsPSO );
+                    e.GraphicsCommandBuffer->Dispatch( static_cast<uint32_t>( glm::ceil( glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights ) / 1024.0f ) ) );
+                }
+                {
+                    ScopedProfileMarker buildTileMasks( L"Build Tile Masks", e.GraphicsCommandBuffer );
+
+                    // One thread per bitmask word (X) for every tile (Y).
+                    uint32_t maxWords = glm::max( zBinParams.NumPointLightWords, zBinParams.NumSpotLightWords );
+                    uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( maxWords / (float)TILE_MASK_NUM_THREADS ) );
+
+                    bindArguments( g_BuildTileMasksPSO );
+                    e.GraphicsCommandBuffer->Dispatch( numThreadGroups, zBinParams.NumTiles );
+                }
+            }
+        } ) )
+        .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Build Z-Bins" profiling marker.
+        .AddPass( std::make_shared<PushProfileMarkerPass>( L"Opaque Pass" ) )
+        .AddPass( std::make_shared<InvokeFunctionPass>( [=] ( Core::RenderEventArgs& e )
+        {
+            if ( e.GraphicsCommandBuffer )
+            {
+                bindZBinnedArguments( e, g_ZBinnedOpaquePSO );
+            }
+        } ) )
+        .AddPass( AddScenePass( std::make_shared<OpaquePass>( scene, g_ZBinnedOpaquePSO ) ) )
+        .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Opaque Pass" profiling marker.
+        .AddPass( std::make_shared<PushProfileMarkerPass>( L"Transparent Pass" ) )
+        .AddPass( std::make_shared<InvokeFunctionPass>( [=] ( Core::RenderEventArgs& e )
+        {
+            if ( e.GraphicsCommandBuffer )
+            {
+                bindZBinnedArguments( e, g_ZBinnedTransparentPSO );
+            }
+        } ) )
+        .AddPass( AddScenePass( std::make_shared<TransparentPass>( scene, g_ZBinnedTransparentPSO ) ) )
+        .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Transparent Pass" profiling marker.
+        .AddPass( g_DebugLightsPass )
+        .AddPass( std::make_shared<PopProfileMarkerPass>() ) // Pop "Z-Binned Rendering" profiling marker.
+        ;
+#pragma endregion
+
         g_Application.IncrementLoadingProgress();
 
     auto fence = commandQueue->Submit( commandBuffer );
@@ -1524,397 +1932,741 @@ bool LoadAssets()
 
     g_Config.LoadingProgressTotal = g_Application.GetLoadingProgress();
 
+    DependencyDatabase::Get().Save();
+
     g_IsLoading = false;
 
     return true;
 }
 
-void MergeSort( std::shared_ptr<ComputeCommandBuffer> commandBuffer,
-                std::shared_ptr<StructuredBuffer> srcKeys, std::shared_ptr<StructuredBuffer> srcValues,
-                std::shared_ptr<StructuredBuffer> dstKeys, std::shared_ptr<StructuredBuffer> dstValues,
-                uint32_t totalValues, uint32_t chunkSize )
+// Compute the offsets of the clusters in the light index lists from the light counts
+// that were written to the light grids by the COUNT_LIGHTS pass of the light assignment.
+// The light index counters are set to the total number of light indices.
+void PrefixSumLightGrid( std::shared_ptr<ComputeCommandBuffer> commandBuffer )
 {
-    SortParams sortParams;
-    uint32_t numThreadGroups;
+    uint32_t numClusters = g_ClusterDataCB.GridDim.x * g_ClusterDataCB.GridDim.y * g_ClusterDataCB.GridDim.z;
+    uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( numClusters / (float)PREFIX_SUM_ELEMENTS_PER_THREAD_GROUP ) );
+
+    // The light grids were written by the light assignment compute shader.
+    commandBuffer->AddUAVBarrier( g_PointLightGrid_Cluster );
+    commandBuffer->AddUAVBarrier( g_SpotLightGrid_Cluster );
+
+    // Scan the light counts per thread group.
+    commandBuffer->BindComputePipelineState( g_PrefixSumLightGridScanGroupsPSO );
+    commandBuffer->BindCompute32BitConstants( 0, g_ClusterDataCB );
+    commandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightIndexCounter_Cluster, g_SpotLightIndexCounter_Cluster, g_PointLightGrid_Cluster, g_SpotLightGrid_Cluster } );
+    commandBuffer->BindComputeShaderArguments( 1, 4, { g_LightGridGroupSums } );
+    commandBuffer->Dispatch( numThreadGroups );
+
+    // The arguments are not rebound between the passes so explicit UAV barriers are required.
+    commandBuffer->AddUAVBarrier( g_LightGridGroupSums );
 
-    // The number of threads per thread group.
-    const uint32_t numThreadsPerThreadGroup = SORT_NUM_THREADS_PER_THREAD_GROUP;
-    // The number of values that each thread sorts.
-    const uint32_t numValuesPerThread = SORT_ELEMENTS_PER_THREAD;
-    // The number of values that each thread group will sort.
-    const uint32_t numValuesPerThreadGroup = numThreadsPerThreadGroup * numValuesPerThread;
+    // Scan the sums of the thread groups.
+    commandBuffer->BindComputePipelineState( g_PrefixSumLightGridScanGroupSumsPSO );
+    commandBuffer->Dispatch( 1 );
 
-    // The total number of complete chunks to sort.
-    uint32_t numChunks = static_cast<uint32_t>( glm::ceil( totalValues / (float)chunkSize ) );
+    commandBuffer->AddUAVBarrier( g_LightGridGroupSums );
+    commandBuffer->AddUAVBarrier( g_PointLightGrid_Cluster );
+    commandBuffer->AddUAVBarrier( g_SpotLightGrid_Cluster );
+
+    // Add the offsets of the thread groups to the light grids.
+    commandBuffer->BindComputePipelineState( g_PrefixSumLightGridAddGroupOffsetsPSO );
+    commandBuffer->Dispatch( numThreadGroups );
+
+    commandBuffer->AddUAVBarrier( g_PointLightGrid_Cluster );
+    commandBuffer->AddUAVBarrier( g_SpotLightGrid_Cluster );
+}
 
-    uint32_t pass = 0;
+bool UseIncrementalLightAssignment( uint64_t frame )
+{
+    // The offsets of exact light index lists are computed over the whole light grid.
+    // Animated lights move every frame.
+    if ( !g_IncrementalLightAssignment || g_ExactLightIndexLists || g_Animate || !g_ClusterLightListsValid )
+    {
+        return false;
+    }
 
-    while ( numChunks > 1 )
+    // The previous lights and cluster flags must be from the previous frame.
+    if ( frame != g_ClusterLightListsFrame + 1 )
     {
-        ScopedProfileMarker passProfileMaker( std::wstring( L"Pass " ) + std::to_wstring( ++pass ), commandBuffer );
+        return false;
+    }
 
-        sortParams.NumElements = totalValues;
-        sortParams.ChunkSize = chunkSize;
+    // If the camera moves, the view space positions of all lights change.
+    if ( g_Camera->GetViewMatrix() != g_ClusterLightListsViewMatrix )
+    {
+        return false;
+    }
 
-        // Number of sort groups required to sort all chunks.
-        // Each sort group merge sorts 2 chunks into a single chunk.
-        uint32_t numSortGroups = numChunks / 2u;
+    // The light index counters are not reset so the light index lists fill up over time.
+    // Rebuild the light lists to compact the light index lists before they overflow.
+    if ( g_PointLightIndexCounterReadback_Cluster.Count > g_PointLightIndexList_Cluster->GetNumElements() * 3 / 4 ||
+         g_SpotLightIndexCounterReadback_Cluster.Count > g_SpotLightIndexList_Cluster->GetNumElements() * 3 / 4 )
+    {
+        return false;
+    }
 
-        // The number of thread groups that are required per sort group.
-        uint32_t numThreadGroupsPerSortGroup = static_cast<uint32_t>( glm::ceil( ( chunkSize * 2 ) / (float)numValuesPerThreadGroup ) );
+    return true;
+}
 
-        // Compute merge path partitions per thread group.
-        {
-            commandBuffer->ClearResourceUInt( g_MergePathPartitions );
+void FindDirtyClusters( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const LightCountsCB& lightCounts )
+{
+    uint32_t numClusters = g_ClusterDataCB.GridDim.x * g_ClusterDataCB.GridDim.y * g_ClusterDataCB.GridDim.z;
+    uint32_t maxLights = glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights );
+
+    commandBuffer->ClearResourceUInt( g_MovedLightCounter );
+    commandBuffer->ClearResourceUInt( g_DirtyClusters->GetCounterBuffer() );
+
+    // Compare the lights with the lights of the previous frame.
+    commandBuffer->BindComputePipelineState( g_FindMovedLightsPSO );
+    commandBuffer->BindCompute32BitConstants( 0, lightCounts );
+    commandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
+    commandBuffer->BindComputeShaderArguments( 1, 2, { g_PreviousPointLightsBuffer, g_PreviousSpotLightsBuffer } );
+    commandBuffer->BindComputeShaderArguments( 1, 4, { g_MovedLightCounter, g_MovedLightSpheres } );
+    commandBuffer->Dispatch( static_cast<uint32_t>( glm::ceil( maxLights / 1024.0f ) ) );
+
+    commandBuffer->AddUAVBarrier( g_MovedLightCounter );
+
+    // Testing every cluster against all moved lights is too expensive if many lights moved.
+    // In that case, the light lists of all visible clusters are rebuilt and the light index counters are reset.
+    commandBuffer->BindComputePipelineState( g_LimitMovedLightsPSO );
+    commandBuffer->BindCompute32BitConstants( 0, lightCounts );
+    commandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightIndexCounter_Cluster, g_SpotLightIndexCounter_Cluster, g_MovedLightCounter } );
+    commandBuffer->Dispatch( 1 );
+
+    commandBuffer->AddUAVBarrier( g_PointLightIndexCounter_Cluster );
+    commandBuffer->AddUAVBarrier( g_SpotLightIndexCounter_Cluster );
+
+    // Find the unique clusters that are overlapped by the moved lights or that were not visible in the previous frame.
+    commandBuffer->BindComputePipelineState( g_FindDirtyClustersPSO );
+    commandBuffer->BindComputeShaderArguments( 0, 0, { g_ClusterAABBs } );
+    commandBuffer->BindComputeShaderArguments( 0, 1, { g_ClusterFlags, g_PreviousClusterFlags, g_MovedLightSpheres, g_MovedLightCounter } );
+    commandBuffer->BindComputeShaderArguments( 0, 5, { g_DirtyClusters } );
+    commandBuffer->Dispatch( static_cast<uint32_t>( glm::ceil( numClusters / 1024.0f ) ) );
+
+    // Update the indirect argument buffer for the dirty clusters (but not the debug clusters).
+    commandBuffer->BindComputePipelineState( g_UpdateIndirectArgumentBuffersPSO );
+    commandBuffer->BindCompute32BitConstants( 0, 0u );
+    commandBuffer->BindComputeShaderArguments( 1, 0, { g_DirtyClusters->GetCounterBuffer(), g_AssignLightsToDirtyClustersArgumentBuffer, g_DebugClustersDrawIndirectArgumentBuffer } );
+    commandBuffer->Dispatch( 1 );
+}
 
-            commandBuffer->BindComputePipelineState( g_MergePathPartitionsPSO );
+void CopyLightIndexCounter( std::shared_ptr<CopyCommandBuffer> commandBuffer, uint64_t frame,
+                            std::shared_ptr<StructuredBuffer> lightIndexCounter, LightIndexCounterReadback& readback )
+{
+    uint32_t index = frame % LIGHT_INDEX_COUNTER_READBACK_FRAMES;
 
-            commandBuffer->BindCompute32BitConstants( 0, sortParams );
-            commandBuffer->BindComputeShaderArguments( 1, 0, { srcKeys, srcValues, g_MergePathPartitions } );
-            commandBuffer->BindComputeShaderArguments( 1, 3, { dstKeys, dstValues, g_MergePathPartitions } );
+    if ( !readback.Buffers[index] )
+    {
+        readback.Buffers[index] = g_RenderDevice->CreateReadbackBuffer( sizeof( uint32_t ) );
+    }
 
-            // The number of merge path partitions that need to be computed.
-            uint32_t numMergePathPartitionsPerSortGroup = numThreadGroupsPerSortGroup + 1u;
-            uint32_t totalMergePathPartitions = numMergePathPartitionsPerSortGroup * numSortGroups;
+    commandBuffer->CopyResource( readback.Buffers[index], lightIndexCounter );
+    readback.Valid[index] = true;
+}
 
-            // The number of thread groups needed to compute all merge path partitions.
-            numThreadGroups = static_cast<uint32_t>( glm::ceil( totalMergePathPartitions / (float)numThreadsPerThreadGroup ) );
+bool GrowLightIndexList( std::shared_ptr<CopyCommandBuffer> commandBuffer, uint64_t frame, LightIndexCounterReadback& readback,
+                         std::shared_ptr<StructuredBuffer>& lightIndexList, const std::wstring& name )
+{
+    // The oldest readback buffer. At most WindowDX12::FrameCount frames are in flight
+    // so the GPU has finished copying the light index counter to this buffer.
+    uint32_t index = ( frame + 1 ) % LIGHT_INDEX_COUNTER_READBACK_FRAMES;
 
-            commandBuffer->Dispatch( numThreadGroups );
-            
-            // Add an explicit UAV barrier for MergePathPartitions.
-            // This is required since the MergePathPartitions structured buffer is being used
-            // as a UAV in the MergePathPartions compute shader and as an SRV in the MergeSort
-            // compute shader. Because the MergePathPartions argument is not rebound between
-            // dispatches, no implicit UAV barrier will be added to the command list and MergeSort
-            // will likely not see the correct merge path partitions.
-            // To resolve this, an explicit UAV barrier is added for the resource.
-            commandBuffer->AddUAVBarrier( g_MergePathPartitions );
-        }
+    if ( !readback.Valid[index] ) return false;
+    readback.Valid[index] = false;
 
-        // Perform merge sort using merge path partitions computed from the previous step.
-        {
-            commandBuffer->BindComputePipelineState( g_MergeSortPSO );
+    uint32_t numLightIndices = 0;
+    readback.Buffers[index]->GetData( &numLightIndices, 0, sizeof( uint32_t ) );
+    readback.Count = numLightIndices;
 
-            // The number of values that each sort group will sort.
-            // Each sort group merges 2 chunks into 1.
-            uint32_t numValuesPerSortGroup = glm::min( chunkSize * 2, totalValues );
+    size_t capacity = lightIndexList->GetNumElements();
+    if ( numLightIndices > capacity )
+    {
+        // Leave some room for the lights to move around. With incremental light assignment,
+        // the light lists of the dirty clusters are appended to the light index lists.
+        size_t newCapacity = numLightIndices + numLightIndices / ( g_IncrementalLightAssignment ? 1 : 4 );
 
-            // The number of thread groups required to sort all values.
-            numThreadGroupsPerSortGroup = static_cast<uint32_t>( glm::ceil( numValuesPerSortGroup / (float)numValuesPerThreadGroup ) );
+        LOG_WARNING( name, " overflowed (", numLightIndices, " light indices, capacity ", capacity, "). Growing to ", newCapacity, " light indices." );
 
-            commandBuffer->Dispatch( numThreadGroupsPerSortGroup * numSortGroups );
+        lightIndexList = g_RenderDevice->CreateStructuredBuffer( commandBuffer, newCapacity, sizeof( uint32_t ) );
+        lightIndexList->SetName( name );
 
-            // Ping-pong the buffers
-            std::swap( srcKeys, dstKeys );
-            std::swap( srcValues, dstValues );
-        }
+        // The other readback buffers refer to the old light index list.
+        InvalidateLightIndexCounterReadback( readback );
 
-        chunkSize *= 2;
-        numChunks = static_cast<uint32_t>( glm::ceil( totalValues / (float)chunkSize ) );
+        return true;
     }
 
-    // If the number of passes was odd, then the result of the sort will 
-    // be in the source buffer and results need to be copied to the 
-    // destination buffer.
-    if ( pass % 2 == 1 )
+    return false;
+}
+
+void InvalidateLightIndexCounterReadback( LightIndexCounterReadback& readback )
+{
+    for ( uint32_t i = 0; i < LIGHT_INDEX_COUNTER_READBACK_FRAMES; ++i )
     {
-        commandBuffer->CopyResource( dstKeys, srcKeys );
-        commandBuffer->CopyResource( dstValues, srcValues );
+        readback.Valid[i] = false;
     }
 }
 
-// The number of nodes at each level of the BVH.
-static const uint32_t gs_NumLevelNodes[] =
+void CreateClusterLightIndexLists( std::shared_ptr<CopyCommandBuffer> commandBuffer )
 {
-    1,          // 1st level (32^0)
-    32,         // 2nd level (32^1)
-    1024,       // 3rd level (32^2)
-    32768,      // 4th level (32^3)
-    1048576,    // 5th level (32^4)
-    33554432,   // 6th level (32^5)
-};
+    uint32_t numLightIndices = GetNumClusterLightIndices( g_ClusterDataCB, g_ExactLightIndexLists );
+
+    g_PointLightIndexList_Cluster = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numLightIndices, sizeof( uint32_t ) );
+    g_PointLightIndexList_Cluster->SetName( L"Point Light Index List (Clustered)" );
 
-// The number of nodes required to represent a BVH given the number of levels
-// of the BVH.
-static const uint32_t gs_NumBVHNodes[] =
+    g_SpotLightIndexList_Cluster = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numLightIndices, sizeof( uint32_t ) );
+    g_SpotLightIndexList_Cluster->SetName( L"Spot Light Index List (Clustered)" );
+
+    InvalidateLightIndexCounterReadback( g_PointLightIndexCounterReadback_Cluster );
+    InvalidateLightIndexCounterReadback( g_SpotLightIndexCounterReadback_Cluster );
+
+    g_ClusterLightListsValid = false;
+}
+
+ZBinParamsCB GetZBinParams()
 {
-    1,          // 1 level  =32^0
-    33,         // 2 levels +32^1
-    1057,       // 3 levels +32^2
-    33825,      // 4 levels +32^3
-    1082401,    // 5 levels +32^4
-    34636833,   // 6 levels +32^5
-};
+    float zNear = g_Camera->GetNearClipPlane();
+    float zFar = g_Camera->GetFarClipPlane();
 
-// Compute the number of levels needed for a BVH that consists of a number of leaf nodes.
-uint32_t GetNumLevels( uint32_t numLeaves )
+    // The screen tiles are the same as the tiles of the grid frustums.
+    uint32_t numTilesX = static_cast<uint32_t>( glm::ceil( std::max( g_WindowWidth, 1u ) / (float)g_LightGridBlockSize ) );
+    uint32_t numTilesY = static_cast<uint32_t>( glm::ceil( std::max( g_WindowHeight, 1u ) / (float)g_LightGridBlockSize ) );
+
+    ZBinParamsCB zBinParams;
+    zBinParams.ZNear = zNear;
+    zBinParams.InvBinDepth = NUM_Z_BINS / ( zFar - zNear );
+    zBinParams.NumZBins = NUM_Z_BINS;
+    zBinParams.TileSize = g_LightGridBlockSize;
+    zBinParams.NumTilesX = numTilesX;
+    zBinParams.NumTiles = numTilesX * numTilesY;
+    zBinParams.NumPointLightWords = static_cast<uint32_t>( ( g_Config.PointLights.size() + 31 ) / 32 );
+    zBinParams.NumSpotLightWords = static_cast<uint32_t>( ( g_Config.SpotLights.size() + 31 ) / 32 );
+
+    return zBinParams;
+}
+
+void CreateZBinBuffers( std::shared_ptr<CopyCommandBuffer> commandBuffer )
 {
-    static const float log32f = glm::log( 32.0f );
+    uint32_t numTilesX = static_cast<uint32_t>( glm::ceil( std::max( g_WindowWidth, 1u ) / (float)g_LightGridBlockSize ) );
+    uint32_t numTilesY = static_cast<uint32_t>( glm::ceil( std::max( g_WindowHeight, 1u ) / (float)g_LightGridBlockSize ) );
+    uint32_t numPointLightWords = static_cast<uint32_t>( ( g_Config.PointLights.size() + 31 ) / 32 );
+    uint32_t numSpotLightWords = static_cast<uint32_t>( ( g_Config.SpotLights.size() + 31 ) / 32 );
 
-    uint32_t numLevels = 0;
-    if ( numLeaves > 0 )
+    // The number of Z-bins does not depend on the screen resolution or the number of lights.
+    if ( !g_PointLightZBins )
     {
-        numLevels = static_cast<uint32_t>( glm::ceil( glm::log( numLeaves ) / log32f ) );
+        g_PointLightZBins = g_RenderDevice->CreateStructuredBuffer( commandBuffer, NUM_Z_BINS, sizeof( glm::uvec2 ) );
+        g_PointLightZBins->SetName( L"Point Light Z-Bins" );
+
+        g_SpotLightZBins = g_RenderDevice->CreateStructuredBuffer( commandBuffer, NUM_Z_BINS, sizeof( glm::uvec2 ) );
+        g_SpotLightZBins->SetName( L"Spot Light Z-Bins" );
     }
 
-    return numLevels;
+    // Each tile stores a single bit per light. For 1080p with 32x32 tiles
+    // and 10,000 lights, the bitmasks require 60x34 (2,040) tiles * 313 words * 4 bytes (2.55 MB).
+    g_PointLightTileMasks = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numTilesX * numTilesY * numPointLightWords, sizeof( uint32_t ) );
+    g_PointLightTileMasks->SetName( L"Point Light Tile Masks" );
+
+    g_SpotLightTileMasks = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numTilesX * numTilesY * numSpotLightWords, sizeof( uint32_t ) );
+    g_SpotLightTileMasks->SetName( L"Spot Light Tile Masks" );
+
+    size_t tileMaskMemory = static_cast<size_t>( numTilesX ) * numTilesY * std::max( numPointLightWords, numSpotLightWords ) * sizeof( uint32_t );
+    if ( tileMaskMemory > MAX_TILE_MASK_MEMORY )
+    {
+        LOG_WARNING( "The Z-binning tile bitmasks require ", tileMaskMemory / ( 1024 * 1024 ), " MB per light type. Use a larger light grid block size or fewer lights for Z-binned rendering." );
+    }
 }
 
-// Compute the number of (child) nodes needed to represent a BVH that consists of a number of leaf nodes.
-uint32_t GetNumNodes( uint32_t numLeaves )
+// The number of bits per axis of the Morton codes that are computed on the GPU.
+uint32_t GetMortonCodeBits()
 {
-    uint32_t numLevels = GetNumLevels( numLeaves );
-    uint32_t numNodes = 0;
-    if ( numLevels > 0 && numLevels < _countof(gs_NumBVHNodes) )
+    if ( g_Use64BitMortonCodes )
     {
-        numNodes = gs_NumBVHNodes[numLevels - 1];
+        return LightBVHCPU::MortonCodeBits64;
     }
-
-    return numNodes;
+    return LightBVHCPU::MortonCodeBits32;
 }
 
-void OnUpdate( UpdateEventArgs& e )
+// Mirror UpdateLights_CS.hlsl on the CPU copy of the lights and update the
+// light BVHs on the CPU. This replaces the UpdateLights_CS dispatch: the lights
+// are only animated on the CPU and the light buffers are updated from the CPU
+// copy. The GPU buffers are only updated if any of the lights have moved.
+void UpdateLightBVHOnCPU( std::shared_ptr<ComputeCommandBuffer> commandBuffer, const glm::mat4& worldMatrix, const glm::mat4& viewMatrix )
 {
-    CPU_MARKER( __FUNCTION__ );
-
-    // Update the camera controller.
-    g_CameraController->OnUpdate( e );
+    ScopedProfileMarker buildBVH( L"Build Light BVH (CPU)" );
 
-    if ( g_TrackSelectedLight )
+    if ( g_LightsAnimatedOnGPU )
     {
-        FocusCurrentLight();
+        // The lights were animated on the GPU before switching to the CPU light BVH.
+        // This only happens once after switching, from then on the lights are
+        // not animated on the GPU anymore.
+        ReadbackLightBuffers();
+        g_LightBVHDirty = true;
     }
 
-    glm::mat4 rotationMatrix( 1 );
-    if ( g_Animate )
+    if ( !g_LightBVHDirty && !g_Animate && viewMatrix == g_LightBVHViewMatrix )
     {
-        float fRotation = static_cast<float>( e.ElapsedTime ); // *glm::half_pi<float>();
-        rotationMatrix = glm::rotate( glm::mat4( 1 ), fRotation, glm::vec3( 0, 1, 0 ) );
+        // Nothing moved, the light BVH buffers are still valid.
+        return;
     }
 
-    // Compute view space light properties.
-    glm::mat4 viewMatrix = g_Camera->GetViewMatrix();
+    ThreadPool& threadPool = ThreadPool::Get();
 
-    // Update light buffers.
-    if ( !g_IsLoading )
-    {
-        auto commandQueue = g_RenderDevice->GetGraphicsQueue();
-        auto commandBuffer = commandQueue->GetComputeCommandBuffer();
+    uint32_t numPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
+    uint32_t numSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
 
-        LightCountsCB lightCounts;
-        lightCounts.NumPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
-        lightCounts.NumSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
-        lightCounts.NumDirectionalLights = static_cast<uint32_t>( g_Config.DirectionalLights.size() );
+    // Same as UpdateLights_CS.hlsl.
+    UpdateLightsCPU updateLights( threadPool );
+    updateLights.Update( worldMatrix, viewMatrix, g_Animate, g_Config.PointLights.data(), numPointLights );
+    updateLights.Update( worldMatrix, viewMatrix, g_Animate, g_Config.SpotLights.data(), numSpotLights );
 
+    for ( auto& directionalLight : g_Config.DirectionalLights )
+    {
+        if ( g_Animate )
         {
-            ScopedProfileMarker updateLightsProfilingMarker( L"Update Lights", commandBuffer );
+            directionalLight.m_DirectionWS = worldMatrix * directionalLight.m_DirectionWS;
+        }
+        directionalLight.m_DirectionVS = glm::normalize( viewMatrix * glm::vec4( glm::vec3( directionalLight.m_DirectionWS ), 0 ) );
+    }
 
-            commandBuffer->BindComputePipelineState( g_UpdateLightsPSO );
+    // The light buffers are updated in place (through the upload heap of the command buffer).
+    commandBuffer->UpdateStructuredBuffer( g_PointLightsBuffer, numPointLights, sizeof( PointLight ), g_Config.PointLights.data() );
+    commandBuffer->UpdateStructuredBuffer( g_SpotLightsBuffer, numSpotLights, sizeof( SpotLight ), g_Config.SpotLights.data() );
+    commandBuffer->UpdateStructuredBuffer( g_DirectionalLightsBuffer, g_Config.DirectionalLights.size(), sizeof( DirectionalLight ), g_Config.DirectionalLights.data() );
 
-            UpdateLightsCB updateLightsCB;
-            updateLightsCB.ModelMatrix = rotationMatrix;
-            updateLightsCB.ViewMatrix = viewMatrix;
+    BoundingBox lightsAABB = LightBVHCPU::ComputeLightsAABB( g_Config.PointLights.data(), numPointLights,
+                                                             g_Config.SpotLights.data(), numSpotLights, threadPool );
 
-            commandBuffer->BindComputeDynamicConstantBuffer( 0, updateLightsCB );
-            commandBuffer->BindCompute32BitConstants( 1, lightCounts );
-            commandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer, g_DirectionalLightsBuffer } );
+    g_PointLightBVHCPU.SetMortonCodeBits( GetMortonCodeBits() );
+    g_SpotLightBVHCPU.SetMortonCodeBits( GetMortonCodeBits() );
 
-            uint32_t numGroupsX = glm::max( lightCounts.NumPointLights, glm::max( lightCounts.NumSpotLights, lightCounts.NumDirectionalLights ) );
-            numGroupsX = static_cast<uint32_t>( glm::ceil( numGroupsX / 1024.0f ) );
+    // Rebuild the BVHs if the lights were changed, otherwise just refit the BVHs.
+    LightBVHCPU::BuildMode buildMode = g_LightBVHDirty ? LightBVHCPU::BuildMode::Rebuild : LightBVHCPU::BuildMode::Automatic;
 
-            commandBuffer->Dispatch( numGroupsX );
+    if ( numPointLights > 0 )
+    {
+        bool rebuilt = g_PointLightBVHCPU.Build( g_Config.PointLights.data(), numPointLights, lightsAABB, buildMode );
+
+        const auto& nodes = g_PointLightBVHCPU.GetNodes();
+        if ( !nodes.empty() )
+        {
+            commandBuffer->UpdateStructuredBuffer( g_LightBVHBuilder->GetPointLightBVH(), nodes.size(), sizeof( AABB ), nodes.data() );
         }
-        if ( g_RenderingTechnique == RenderingTechnique::Clustered_Optimized )
+        // The light indices only change when the BVH is rebuilt.
+        if ( rebuilt )
         {
-            {
-                ScopedProfileMarker computeLightsAABB( L"Reduce Lights AABB", commandBuffer );
+            const auto& lightIndices = g_PointLightBVHCPU.GetLightIndices();
+            commandBuffer->UpdateStructuredBuffer( g_LightBVHBuilder->GetPointLightIndices(), lightIndices.size(), sizeof( uint32_t ), lightIndices.data() );
+        }
+    }
 
-                commandBuffer->BindComputePipelineState( g_ReduceLightsAABB1PSO );
+    if ( numSpotLights > 0 )
+    {
+        bool rebuilt = g_SpotLightBVHCPU.Build( g_Config.SpotLights.data(), numSpotLights, lightsAABB, buildMode );
 
-                // Don't dispatch more than 512 thread groups. The reduction algorithm depends on the
-                // number of thread groups to be no more than 512. The buffer which stores the reduced AABB is sized
-                // for a maximum of 512 thread groups.
-                uint32_t numThreadGroups = glm::min<uint32_t>( static_cast<uint32_t>( glm::ceil( glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights ) / 512.0f ) ), 512 );
+        const auto& nodes = g_SpotLightBVHCPU.GetNodes();
+        if ( !nodes.empty() )
+        {
+            commandBuffer->UpdateStructuredBuffer( g_LightBVHBuilder->GetSpotLightBVH(), nodes.size(), sizeof( AABB ), nodes.data() );
+        }
+        if ( rebuilt )
+        {
+            const auto& lightIndices = g_SpotLightBVHCPU.GetLightIndices();
+            commandBuffer->UpdateStructuredBuffer( g_LightBVHBuilder->GetSpotLightIndices(), lightIndices.size(), sizeof( uint32_t ), lightIndices.data() );
+        }
+    }
 
-                DispatchParamsCB dispatchParams;
-                dispatchParams.NumThreadGroups = glm::uvec3( numThreadGroups, 1, 1 );
-                dispatchParams.NumThreads = glm::uvec3( numThreadGroups * 512, 1, 1 );
+    g_LightBVHViewMatrix = viewMatrix;
+    g_LightBVHDirty = false;
+}
 
-                // In the first pass, the number of lights determines the number of
-                // elements to be reduced.
-                // In the second pass, the number of elements to be reduced is the 
-                // number of thread groups from the first pass.
-                uint32_t numElements = dispatchParams.NumThreadGroups.x;
+// Read the contents of a structured buffer back to the CPU.
+template<typename T>
+std::vector<T> ReadbackStructuredBuffer( std::shared_ptr<StructuredBuffer> structuredBuffer, size_t numElements )
+{
+    std::vector<T> data( numElements );
+    if ( numElements > 0 )
+    {
+        auto commandQueue = g_RenderDevice->GetGraphicsQueue();
+        auto commandBuffer = commandQueue->GetCopyCommandBuffer();
+        auto readbackBuffer = g_RenderDevice->CreateReadbackBuffer( numElements * sizeof( T ) );
 
-                commandBuffer->BindCompute32BitConstants( 0, lightCounts );
-                commandBuffer->BindCompute32BitConstants( 1, dispatchParams );
-                commandBuffer->BindCompute32BitConstants( 2, numElements );
-                commandBuffer->BindComputeShaderArguments( 3, 0, { g_PointLightsBuffer, g_SpotLightsBuffer, g_LightsAABB } );
+        commandBuffer->CopyResource( readbackBuffer, structuredBuffer );
 
-                {
-                    ScopedProfileMarker firstPass( L"First Pass", commandBuffer );
+        auto fence = commandQueue->Submit( commandBuffer );
+        fence->WaitFor();
 
-                    // Dispatch the first pass.
-                    commandBuffer->Dispatch( numThreadGroups );
-                }
+        readbackBuffer->GetData( data.data() );
+    }
+    return data;
+}
 
-                commandBuffer->BindComputePipelineState( g_ReduceLightsAABB2PSO );
+// Compare the sorted Morton codes, light indices and BVH nodes that were
+// computed on the GPU for a single light type with the CPU implementation.
+// The GPU sort is not stable so lights with the same Morton code may end up in a
+// different order. Instead of comparing the light indices directly, the light indices
+// are checked to refer to a light with the same Morton code and the BVH nodes
+// are compared with a BVH that is built on the CPU using the GPU leaf order.
+template<typename LightType>
+void ValidateLightBVH( const std::string& lightType, const std::vector<LightType>& lights, const BoundingBox& lightsAABB,
+                       std::shared_ptr<StructuredBuffer> mortonCodesBuffer, std::shared_ptr<StructuredBuffer> lightIndicesBuffer,
+                       std::shared_ptr<StructuredBuffer> bvhBuffer )
+{
+    uint32_t numLights = static_cast<uint32_t>( lights.size() );
+    if ( numLights == 0 ) return;
 
-                dispatchParams.NumThreadGroups = glm::uvec3( 1, 1, 1 );
-                dispatchParams.NumThreads = glm::uvec3( 512, 1, 1 );
+    std::vector<uint64_t> gpuMortonCodes;
+    if ( g_Use64BitMortonCodes )
+    {
+        gpuMortonCodes = ReadbackStructuredBuffer<uint64_t>( mortonCodesBuffer, numLights );
+    }
+    else
+    {
+        std::vector<uint32_t> mortonCodes = ReadbackStructuredBuffer<uint32_t>( mortonCodesBuffer, numLights );
+        gpuMortonCodes.assign( mortonCodes.begin(), mortonCodes.end() );
+    }
+    std::vector<uint32_t> gpuLightIndices = ReadbackStructuredBuffer<uint32_t>( lightIndicesBuffer, numLights );
+    std::vector<BoundingBox> gpuNodes = ReadbackStructuredBuffer<BoundingBox>( bvhBuffer, LightBVHCPU::GetNumNodes( numLights ) );
 
-                commandBuffer->BindCompute32BitConstants( 1, dispatchParams );
+    LightBVHCPU bvh;
+    bvh.SetMortonCodeBits( GetMortonCodeBits() );
+    bvh.Build( lights.data(), numLights, lightsAABB, LightBVHCPU::BuildMode::Rebuild );
 
-                {
-                    ScopedProfileMarker secondPass( L"Second Pass", commandBuffer );
+    const auto& cpuMortonCodes = bvh.GetMortonCodes();
+    const auto& cpuLightIndices = bvh.GetLightIndices();
 
-                    // Dispatch 2nd pass.
-                    commandBuffer->Dispatch( 1 );
-                }
-            }
-            {
-                ScopedProfileMarker computeMortonCodes( L"Compute Morton Codes", commandBuffer );
+    // The Morton code of each light (in the original light order).
+    std::vector<uint64_t> lightMortonCodes( numLights );
+    for ( uint32_t i = 0; i < numLights; ++i )
+    {
+        lightMortonCodes[cpuLightIndices[i]] = cpuMortonCodes[i];
+    }
 
-                commandBuffer->BindComputePipelineState( g_ComputeLightMortonCodesPSO );
+    uint32_t numMortonCodeErrors = 0;
+    uint32_t numLightIndexErrors = 0;
+    for ( uint32_t i = 0; i < numLights; ++i )
+    {
+        if ( gpuMortonCodes[i] != cpuMortonCodes[i] )
+        {
+            ++numMortonCodeErrors;
+        }
+        if ( gpuLightIndices[i] >= numLights || lightMortonCodes[gpuLightIndices[i]] != gpuMortonCodes[i] )
+        {
+            ++numLightIndexErrors;
+        }
+    }
 
-                commandBuffer->BindCompute32BitConstants( 0, lightCounts );
-                commandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightsBuffer, g_SpotLightsBuffer, g_LightsAABB } );
-                commandBuffer->BindComputeShaderArguments( 1, 3, { g_PointLightMortonCodes, g_SpotLightMortonCodes } );
-                commandBuffer->BindComputeShaderArguments( 1, 5, { g_PointLightIndices, g_SpotLightIndices } );
+    if ( numLightIndexErrors > 0 )
+    {
+        LOG_ERROR( lightType, " light BVH: ", numMortonCodeErrors, " Morton code errors, ", numLightIndexErrors, " light index errors (of ", numLights, " lights)." );
+        return;
+    }
 
-                uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights ) / 1024.0f ) );
+    // Build the BVH nodes using the GPU leaf order.
+    bvh.Build( lights.data(), numLights, gpuLightIndices.data() );
 
-                commandBuffer->Dispatch( numThreadGroups );
-            }
-            {
-                ScopedProfileMarker sortByMortonCode( L"Sort Morton Codes", commandBuffer );
+    const auto& cpuNodes = bvh.GetNodes();
+    uint32_t numNodes = static_cast<uint32_t>( glm::min( cpuNodes.size(), gpuNodes.size() ) );
+    uint32_t numNodeErrors = 0;
+    for ( uint32_t i = 0; i < numNodes; ++i )
+    {
+        glm::vec3 minError = glm::abs( glm::vec3( cpuNodes[i].m_Min ) - glm::vec3( gpuNodes[i].m_Min ) );
+        glm::vec3 maxError = glm::abs( glm::vec3( cpuNodes[i].m_Max ) - glm::vec3( gpuNodes[i].m_Max ) );
+        float error = glm::max( glm::max( glm::max( minError.x, minError.y ), glm::max( minError.z, maxError.x ) ), glm::max( maxError.y, maxError.z ) );
+        if ( error > 1e-4f )
+        {
+            ++numNodeErrors;
+        }
+    }
 
-                // The size of a single chunk that keys will be sorted into.
-                uint32_t chunkSize = SORT_NUM_THREADS_PER_THREAD_GROUP;
+    // Morton code errors are reported but not treated as an error because the quantization
+    // of the light positions on the GPU may differ by one step from the CPU.
+    if ( numNodeErrors > 0 )
+    {
+        LOG_ERROR( lightType, " light BVH: ", numMortonCodeErrors, " Morton code errors, ", numNodeErrors, " node errors (of ", numNodes, " nodes)." );
+    }
+    else
+    {
+        LOG_INFO( lightType, " light BVH OK: ", numMortonCodeErrors, " Morton code errors (of ", numLights, " lights), ", numNodes, " nodes." );
+    }
+}
 
-                commandBuffer->BindComputePipelineState( g_RadixSortPSO );
+void ValidateLightBVH()
+{
+    if ( g_RenderingTechnique != RenderingTechnique::Clustered_Optimized || g_BuildLightBVHOnCPU )
+    {
+        LOG_WARNING( "The light BVH is only built on the GPU for the optimized clustered technique." );
+        return;
+    }
 
-                SortParams sortParams;
-                sortParams.ChunkSize = chunkSize;
+    if ( g_Animate )
+    {
+        LOG_WARNING( "The lights are animated. The light BVH may not match the lights that are read back." );
+    }
 
-                // First sort the point light Morton codes.
-                if ( lightCounts.NumPointLights > 0 )
-                {
-                    sortParams.NumElements = lightCounts.NumPointLights;
+    // Get the lights and the AABB of the lights that were used to build the BVH.
+    ReadbackLightBuffers();
+    BoundingBox lightsAABB = ReadbackStructuredBuffer<BoundingBox>( g_LightBVHBuilder->GetLightsAABB(), 512 )[0];
 
-                    commandBuffer->BindCompute32BitConstants( 0, sortParams );
-                    commandBuffer->BindComputeShaderArguments( 1, 0, { g_PointLightMortonCodes, g_PointLightIndices } );
-                    commandBuffer->BindComputeShaderArguments( 1, 2, { g_PointLightMortonCodes_OUT, g_PointLightIndices_OUT } );
+    ValidateLightBVH( "Point", g_Config.PointLights, lightsAABB, g_LightBVHBuilder->GetPointLightKeys(), g_LightBVHBuilder->GetPointLightIndices(), g_LightBVHBuilder->GetPointLightBVH() );
+    ValidateLightBVH( "Spot", g_Config.SpotLights, lightsAABB, g_LightBVHBuilder->GetSpotLightKeys(), g_LightBVHBuilder->GetSpotLightIndices(), g_LightBVHBuilder->GetSpotLightBVH() );
+}
 
-                    {
-                        ScopedProfileMarker sortPointLights( L"Radix Sort (Point Lights)", commandBuffer );
+void LogLightBVHStatistics()
+{
+    ThreadPool& threadPool = ThreadPool::Get();
 
-                        uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( sortParams.NumElements / (float)SORT_NUM_THREADS_PER_THREAD_GROUP ) );
+    ReadbackLightBuffers();
 
-                        commandBuffer->Dispatch( numThreadGroups );
+    uint32_t numPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
+    uint32_t numSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
 
-                        // Now copy the results of the radix sort to the original buffer.
-                        commandBuffer->CopyResource( g_PointLightMortonCodes, g_PointLightMortonCodes_OUT );
-                        commandBuffer->CopyResource( g_PointLightIndices, g_PointLightIndices_OUT );
-                    }
-                }
+    BoundingBox lightsAABB = LightBVHCPU::ComputeLightsAABB( g_Config.PointLights.data(), numPointLights,
+                                                             g_Config.SpotLights.data(), numSpotLights, threadPool );
 
-                // Now sort spot light Morton codes.
-                if ( lightCounts.NumSpotLights > 0 )
-                {
-                    sortParams.NumElements = lightCounts.NumSpotLights;
+    // The traversal cost is measured by assigning the lights to all clusters of the cluster grid.
+    uint32_t numClusters = g_ClusterDataCB.GridDim.x * g_ClusterDataCB.GridDim.y * g_ClusterDataCB.GridDim.z;
+    std::vector<BoundingBox> clusterAABBs = ReadbackStructuredBuffer<BoundingBox>( g_ClusterAABBs, numClusters );
+    std::vector<uint32_t> clusters( numClusters );
+    for ( uint32_t i = 0; i < numClusters; ++i )
+    {
+        clusters[i] = i;
+    }
 
-                    commandBuffer->BindCompute32BitConstants( 0, sortParams );
-                    commandBuffer->BindComputeShaderArguments( 1, 0, { g_SpotLightMortonCodes, g_SpotLightIndices } );
-                    commandBuffer->BindComputeShaderArguments( 1, 2, { g_SpotLightMortonCodes_OUT, g_SpotLightIndices_OUT } );
+    ClusterLightAssignmentArgs args;
+    args.PointLights = g_Config.PointLights.data();
+    args.NumPointLights = numPointLights;
+    args.SpotLights = g_Config.SpotLights.data();
+    args.NumSpotLights = numSpotLights;
+    args.ClusterAABBs = clusterAABBs.data();
+    args.NumClusters = numClusters;
+    args.UniqueClusters = clusters.data();
+    args.NumUniqueClusters = numClusters;
 
-                    {
-                        ScopedProfileMarker sortSpotLights( L"Radix Sort (Spot Lights)", commandBuffer );
+    ClusterLightAssignmentCPU lightAssignment( threadPool );
+    ClusterLightList pointLightList, spotLightList;
 
-                        uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( sortParams.NumElements / (float)SORT_NUM_THREADS_PER_THREAD_GROUP ) );
+    LOG_INFO( "Light BVH statistics for ", numPointLights, " point lights, ", numSpotLights, " spot lights and ", numClusters, " clusters." );
 
-                        commandBuffer->Dispatch( numThreadGroups );
+    const uint32_t mortonCodeBits[] = { LightBVHCPU::MortonCodeBits32, LightBVHCPU::MortonCodeBits64 };
+    for ( uint32_t bitsPerAxis : mortonCodeBits )
+    {
+        LightBVHCPU pointLightBVH( threadPool );
+        LightBVHCPU spotLightBVH( threadPool );
+        pointLightBVH.SetMortonCodeBits( bitsPerAxis );
+        spotLightBVH.SetMortonCodeBits( bitsPerAxis );
+
+        auto start = high_resolution_clock::now();
+        pointLightBVH.Build( g_Config.PointLights.data(), numPointLights, lightsAABB, LightBVHCPU::BuildMode::Rebuild );
+        spotLightBVH.Build( g_Config.SpotLights.data(), numSpotLights, lightsAABB, LightBVHCPU::BuildMode::Rebuild );
+        double buildTime = duration_cast<duration<double, std::milli>>( high_resolution_clock::now() - start ).count();
+
+        LightBVHArgs bvhArgs;
+        bvhArgs.PointLightBVH = pointLightBVH.GetNodes().data();
+        bvhArgs.PointLightIndices = pointLightBVH.GetLightIndices().data();
+        bvhArgs.PointLightLevels = pointLightBVH.GetNumLevels();
+        bvhArgs.SpotLightBVH = spotLightBVH.GetNodes().data();
+        bvhArgs.SpotLightIndices = spotLightBVH.GetLightIndices().data();
+        bvhArgs.SpotLightLevels = spotLightBVH.GetNumLevels();
+
+        lightAssignment.AssignLightsBVH( args, bvhArgs, pointLightList, spotLightList );
+
+        LightBVHCPU::Statistics pointLightStats = pointLightBVH.ComputeStatistics();
+        LightBVHCPU::Statistics spotLightStats = spotLightBVH.ComputeStatistics();
+
+        LOG_INFO( bitsPerAxis * 3, "-bit Morton codes: build time ", buildTime, " ms." );
+        LOG_INFO( "  Point lights: ", pointLightStats.NumLevels, " levels, ", pointLightStats.NumDuplicateMortonCodes, " duplicate Morton codes, overlap ", pointLightStats.NodeOverlap,
+                  ", bottom level overlap ", pointLightStats.LevelOverlap.empty() ? 0.0f : pointLightStats.LevelOverlap.back(),
+                  ", node tests ", pointLightList.NodeTests, ", light tests ", pointLightList.LightTests );
+        LOG_INFO( "  Spot lights: ", spotLightStats.NumLevels, " levels, ", spotLightStats.NumDuplicateMortonCodes, " duplicate Morton codes, overlap ", spotLightStats.NodeOverlap,
+                  ", bottom level overlap ", spotLightStats.LevelOverlap.empty() ? 0.0f : spotLightStats.LevelOverlap.back(),
+                  ", node tests ", spotLightList.NodeTests, ", light tests ", spotLightList.LightTests );
+    }
+}
 
-                        // Now copy the results of the radix sort to the original buffer.
-                        commandBuffer->CopyResource( g_SpotLightMortonCodes, g_SpotLightMortonCodes_OUT );
-                        commandBuffer->CopyResource( g_SpotLightIndices, g_SpotLightIndices_OUT );
-                    }
-                }
+// The size of a GPU buffer in bytes.
+size_t GetBufferSize( std::shared_ptr<StructuredBuffer> buffer )
+{
+    return buffer ? buffer->GetNumElements() * buffer->GetElementSize() : 0;
+}
 
-                //// Merge sort the radix sorted blocks from the previous step.
-                if ( lightCounts.NumPointLights > 0 )
-                {
-                    ScopedProfileMarker mergeSortPointLights( L"Merge Sort (Point Lights)", commandBuffer );
+void CompareZBinningAndLightBVH()
+{
+    ThreadPool& threadPool = ThreadPool::Get();
+
+    ReadbackLightBuffers();
+
+    uint32_t numPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
+    uint32_t numSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
+
+    // Z-binning uses the same screen tiles as the grid frustums.
+    std::vector<TileFrustum> tileFrustums;
+    ZBinningCPU::ComputeTileFrustums( glm::inverse( g_Camera->GetProjectionMatrix() ), g_WindowWidth, g_WindowHeight, g_LightGridBlockSize, tileFrustums );
+
+    ZBinningArgs zBinningArgs;
+    zBinningArgs.PointLights = g_Config.PointLights.data();
+    zBinningArgs.NumPointLights = numPointLights;
+    zBinningArgs.SpotLights = g_Config.SpotLights.data();
+    zBinningArgs.NumSpotLights = numSpotLights;
+    zBinningArgs.TileFrustums = tileFrustums.data();
+    zBinningArgs.NumTiles = static_cast<uint32_t>( tileFrustums.size() );
+    zBinningArgs.ZNear = g_Camera->GetNearClipPlane();
+    zBinningArgs.ZFar = g_Camera->GetFarClipPlane();
+    zBinningArgs.NumZBins = NUM_Z_BINS;
+
+    ZBinningCPU zBinning( threadPool );
+    ZBinLightList pointLightZBins, spotLightZBins;
+
+    auto start = high_resolution_clock::now();
+    zBinning.Build( zBinningArgs, pointLightZBins, spotLightZBins );
+    g_ZBinningComparison.ZBinningBuildTime = duration_cast<duration<double, std::milli>>( high_resolution_clock::now() - start ).count();
+    g_ZBinningComparison.ZBinningMemory = pointLightZBins.GetMemoryFootprint() + spotLightZBins.GetMemoryFootprint();
+
+    // The light BVH is used to assign the lights to all clusters of the cluster grid.
+    uint32_t numClusters = g_ClusterDataCB.GridDim.x * g_ClusterDataCB.GridDim.y * g_ClusterDataCB.GridDim.z;
+    std::vector<BoundingBox> clusterAABBs = ReadbackStructuredBuffer<BoundingBox>( g_ClusterAABBs, numClusters );
+    std::vector<uint32_t> clusters( numClusters );
+    for ( uint32_t i = 0; i < numClusters; ++i )
+    {
+        clusters[i] = i;
+    }
 
-                    MergeSort( commandBuffer,
-                               g_PointLightMortonCodes, g_PointLightIndices,
-                               g_PointLightMortonCodes_OUT, g_PointLightIndices_OUT,
-                               lightCounts.NumPointLights, chunkSize );
-                }
-                // Merge sort the radix sorted blocks from the previous step.
-                if ( lightCounts.NumSpotLights > 0 )
-                {
-                    ScopedProfileMarker mergeSortPointLights( L"Merge Sort (Spot Lights)", commandBuffer );
+    ClusterLightAssignmentArgs args;
+    args.PointLights = g_Config.PointLights.data();
+    args.NumPointLights = numPointLights;
+    args.SpotLights = g_Config.SpotLights.data();
+    args.NumSpotLights = numSpotLights;
+    args.ClusterAABBs = clusterAABBs.data();
+    args.NumClusters = numClusters;
+    args.UniqueClusters = clusters.data();
+    args.NumUniqueClusters = numClusters;
+
+    LightBVHCPU pointLightBVH( threadPool );
+    LightBVHCPU spotLightBVH( threadPool );
+
+    start = high_resolution_clock::now();
+    BoundingBox lightsAABB = LightBVHCPU::ComputeLightsAABB( g_Config.PointLights.data(), numPointLights,
+                                                             g_Config.SpotLights.data(), numSpotLights, threadPool );
+    pointLightBVH.Build( g_Config.PointLights.data(), numPointLights, lightsAABB, LightBVHCPU::BuildMode::Rebuild );
+    spotLightBVH.Build( g_Config.SpotLights.data(), numSpotLights, lightsAABB, LightBVHCPU::BuildMode::Rebuild );
+    g_ZBinningComparison.BVHBuildTime = duration_cast<duration<double, std::milli>>( high_resolution_clock::now() - start ).count();
+
+    LightBVHArgs bvhArgs;
+    bvhArgs.PointLightBVH = pointLightBVH.GetNodes().data();
+    bvhArgs.PointLightIndices = pointLightBVH.GetLightIndices().data();
+    bvhArgs.PointLightLevels = pointLightBVH.GetNumLevels();
+    bvhArgs.SpotLightBVH = spotLightBVH.GetNodes().data();
+    bvhArgs.SpotLightIndices = spotLightBVH.GetLightIndices().data();
+    bvhArgs.SpotLightLevels = spotLightBVH.GetNumLevels();
+
+    // Use exact light lists so the memory footprint is not determined by the maximum number of lights per cluster.
+    ClusterLightAssignmentCPU lightAssignment( threadPool );
+    lightAssignment.SetExactLightLists( true );
+    ClusterLightList pointLightList, spotLightList;
+
+    start = high_resolution_clock::now();
+    lightAssignment.AssignLightsBVH( args, bvhArgs, pointLightList, spotLightList );
+    g_ZBinningComparison.BVHAssignLightsTime = duration_cast<duration<double, std::milli>>( high_resolution_clock::now() - start ).count();
+
+    g_ZBinningComparison.BVHMemory = ( pointLightBVH.GetNodes().size() + spotLightBVH.GetNodes().size() ) * sizeof( BoundingBox ) +
+                                     ( pointLightBVH.GetLightIndices().size() + spotLightBVH.GetLightIndices().size() ) * sizeof( uint32_t ) +
+                                     ( pointLightList.Grid.size() + spotLightList.Grid.size() ) * sizeof( glm::uvec2 ) +
+                                     ( pointLightList.IndexCount + spotLightList.IndexCount ) * sizeof( uint32_t );
+
+    g_ZBinningComparison.Valid = true;
+
+    LOG_INFO( "Z-binning: ", g_ZBinningComparison.ZBinningBuildTime, " ms, ", g_ZBinningComparison.ZBinningMemory, " bytes (", tileFrustums.size(), " tiles, ", NUM_Z_BINS, " Z-bins)." );
+    LOG_INFO( "Light BVH: ", g_ZBinningComparison.BVHBuildTime, " ms build, ", g_ZBinningComparison.BVHAssignLightsTime, " ms light assignment, ",
+              g_ZBinningComparison.BVHMemory, " bytes (", numClusters, " clusters)." );
+}
 
-                    MergeSort( commandBuffer,
-                               g_SpotLightMortonCodes, g_SpotLightIndices,
-                               g_SpotLightMortonCodes_OUT, g_SpotLightIndices_OUT,
-                               lightCounts.NumSpotLights, chunkSize );
-                }
-            }
-            {
-                ScopedProfileMarker buildBVH( L"Build Light BVH", commandBuffer );
+void OnUpdate( UpdateEventArgs& e )
+{
+    CPU_MARKER( __FUNCTION__ );
 
-                commandBuffer->ClearResourceFloat( g_PointLightBVH );
-                commandBuffer->ClearResourceFloat( g_SpotLightBVH );
+    // Update the camera controller.
+    g_CameraController->OnUpdate( e );
 
-                commandBuffer->BindComputePipelineState( g_BuildBVHBottomPSO );
+    if ( g_TrackSelectedLight )
+    {
+        FocusCurrentLight();
+    }
 
-                BVHParams bvhParams = {};
-                bvhParams.PointLightLevels = GetNumLevels( lightCounts.NumPointLights );
-                bvhParams.SpotLightLevels = GetNumLevels( lightCounts.NumSpotLights );
+    glm::mat4 rotationMatrix( 1 );
+    if ( g_Animate )
+    {
+        float fRotation = static_cast<float>( e.ElapsedTime ); // *glm::half_pi<float>();
+        rotationMatrix = glm::rotate( glm::mat4( 1 ), fRotation, glm::vec3( 0, 1, 0 ) );
+    }
 
-                commandBuffer->BindCompute32BitConstants( 0, bvhParams );
-                commandBuffer->BindCompute32BitConstants( 1, lightCounts );
-                commandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
-                commandBuffer->BindComputeShaderArguments( 2, 2, { g_PointLightIndices, g_SpotLightIndices } );
-                commandBuffer->BindComputeShaderArguments( 2, 4, { g_PointLightBVH, g_SpotLightBVH } );
+    // Compute view space light properties.
+    glm::mat4 viewMatrix = g_Camera->GetViewMatrix();
 
-                // Build bottom level of the BVH.
-                uint32_t maxLeaves = glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights );
-                uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( maxLeaves / (float)BVH_NUM_THREADS ) );
+    // Update light buffers.
+    if ( !g_IsLoading )
+    {
+        auto commandQueue = g_RenderDevice->GetGraphicsQueue();
+        auto commandBuffer = commandQueue->GetComputeCommandBuffer();
 
-                {
-                    ScopedProfileMarker buildBottomBVH( L"Build Bottom BVH", commandBuffer );
+        LightCountsCB lightCounts;
+        lightCounts.NumPointLights = static_cast<uint32_t>( g_Config.PointLights.size() );
+        lightCounts.NumSpotLights = static_cast<uint32_t>( g_Config.SpotLights.size() );
+        lightCounts.NumDirectionalLights = static_cast<uint32_t>( g_Config.DirectionalLights.size() );
 
-                    commandBuffer->Dispatch( numThreadGroups );
-                }
+        if ( g_RenderingTechnique == RenderingTechnique::Clustered_Optimized && g_BuildLightBVHOnCPU )
+        {
+            // The lights are animated on the CPU.
+            UpdateLightBVHOnCPU( commandBuffer, rotationMatrix, viewMatrix );
+        }
+        else
+        {
+            ScopedProfileMarker updateLightsProfilingMarker( L"Update Lights", commandBuffer );
 
-                commandBuffer->BindComputePipelineState( g_BuildBVHTopPSO );
+            commandBuffer->BindComputePipelineState( g_UpdateLightsPSO );
 
-                // Now build upper levels of the BVH.
-                uint32_t maxLevels = static_cast<uint32_t>( glm::max( bvhParams.PointLightLevels, bvhParams.SpotLightLevels ) );
-                
-                if ( maxLevels > 0 )
-                {
-                    for ( uint32_t level = maxLevels - 1u; level > 0; --level )
-                    {
-                        commandBuffer->AddUAVBarrier( g_PointLightBVH );
-                        commandBuffer->AddUAVBarrier( g_SpotLightBVH );
+            UpdateLightsCB updateLightsCB;
+            updateLightsCB.ModelMatrix = rotationMatrix;
+            updateLightsCB.ViewMatrix = viewMatrix;
 
-                        bvhParams.ChildLevel = level;
-                        commandBuffer->BindCompute32BitConstants( 0, bvhParams );
+            commandBuffer->BindComputeDynamicConstantBuffer( 0, updateLightsCB );
+            commandBuffer->BindCompute32BitConstants( 1, lightCounts );
+            commandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer, g_DirectionalLightsBuffer } );
 
-                        uint32_t numChildNodes = gs_NumLevelNodes[level];
-                        numThreadGroups = static_cast<uint32_t>( glm::ceil( numChildNodes / (float)BVH_NUM_THREADS ) );
+            uint32_t numGroupsX = glm::max( lightCounts.NumPointLights, glm::max( lightCounts.NumSpotLights, lightCounts.NumDirectionalLights ) );
+            numGroupsX = static_cast<uint32_t>( glm::ceil( numGroupsX / 1024.0f ) );
 
-                        {
-                            ScopedProfileMarker buildBVHBottom( std::wstring( L"Build BVH Level " ) + std::to_wstring( level ), commandBuffer );
-                            commandBuffer->Dispatch( numThreadGroups );
-                        }
-                    }
-                }
+            commandBuffer->Dispatch( numGroupsX );
+
+            g_LightsAnimatedOnGPU = g_LightsAnimatedOnGPU || g_Animate;
+        }
+        if ( g_RenderingTechnique == RenderingTechnique::Clustered_Optimized && !g_BuildLightBVHOnCPU )
+        {
+            g_LightBVHBuilder->Build( commandBuffer, lightCounts, g_PointLightsBuffer, g_SpotLightsBuffer );
+        }
+        else if ( g_RenderingTechnique == RenderingTechnique::ZBinned )
+        {
+            {
+                ScopedProfileMarker computeDepthKeys( L"Compute Depth Keys", commandBuffer );
+
+                commandBuffer->BindComputePipelineState( g_Use64BitMortonCodes ? g_ComputeLightDepthKeys64PSO : g_ComputeLightDepthKeysPSO );
+
+                ZBinParamsCB zBinParams = GetZBinParams();
+
+                commandBuffer->BindCompute32BitConstants( 0, lightCounts );
+                commandBuffer->BindCompute32BitConstants( 1, zBinParams );
+                commandBuffer->BindComputeShaderArguments( 2, 0, { g_PointLightsBuffer, g_SpotLightsBuffer } );
+                commandBuffer->BindComputeShaderArguments( 2, 2, { g_LightBVHBuilder->GetPointLightKeys(), g_LightBVHBuilder->GetSpotLightKeys() } );
+                commandBuffer->BindComputeShaderArguments( 2, 4, { g_LightBVHBuilder->GetPointLightIndices(), g_LightBVHBuilder->GetSpotLightIndices() } );
+
+                uint32_t numThreadGroups = static_cast<uint32_t>( glm::ceil( glm::max( lightCounts.NumPointLights, lightCounts.NumSpotLights ) / 1024.0f ) );
+
+                commandBuffer->Dispatch( numThreadGroups );
+            }
+            {
+                ScopedProfileMarker sortByDepth( L"Sort Depth Keys", commandBuffer );
+
+                g_LightBVHBuilder->SortKeys( commandBuffer, lightCounts );
             }
         }
 
@@ -1958,6 +2710,9 @@ void ComputeGridFrustums()
 
         g_SpotLightGrid[i] = g_RenderDevice->CreateTexture2D( numThreads.x, numThreads.y, numThreads.z, lightGridTextureFormat );
         g_SpotLightGrid[i]->SetName( std::wstring( L"Spot Light Grid " ) + ( ( i == 0 ) ? L"(Opaque)" : L"(Transparent)" ) );
+
+        InvalidateLightIndexCounterReadback( g_PointLightIndexCounterReadback[i] );
+        InvalidateLightIndexCounterReadback( g_SpotLightIndexCounterReadback[i] );
     }
 
     CameraParamsCB cameraParams;
@@ -1977,6 +2732,9 @@ void ComputeGridFrustums()
     g_GridFrustums = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numThreads.x * numThreads.y * numThreads.z, sizeof( Frustum ) );
     g_GridFrustums->SetName( L"Grid Frustums" );
 
+    // The Z-binned rendering technique uses the same screen tiles as the grid frustums.
+    CreateZBinBuffers( commandBuffer );
+
     commandBuffer->BindComputePipelineState( g_ComputeGridFrustumsPSO );
 
     commandBuffer->BindComputeDynamicConstantBuffer( 0, cameraParams );
@@ -1990,30 +2748,11 @@ void ComputeGridFrustums()
 
 void UpdateClusterGrid()
 {
-    // The half-angle of the field of view in the Y-direction.
-    float fieldOfViewY = glm::radians( g_Camera->GetFOV() * 0.5f );
-    float zNear = g_Camera->GetNearClipPlane();
-    float zFar = g_Camera->GetFarClipPlane();
-
-    // Number of clusters in the screen X direction.
-    uint32_t clusterDimX = static_cast<uint32_t>( glm::ceil( g_WindowWidth / (float)g_ClusterGridBlockSize ) );
-    // Number of clusters in the screen Y direction.
-    uint32_t clusterDimY = static_cast<uint32_t>( glm::ceil( g_WindowHeight / (float)g_ClusterGridBlockSize ) );
-
-    // The depth of the cluster grid during clustered rendering is dependent on the 
-    // number of clusters subdivisions in the screen Y direction.
-    // Source: Clustered Deferred and Forward Shading (2012) (Ola Olsson, Markus Billeter, Ulf Assarsson).
-    float sD = 2.0f * glm::tan( fieldOfViewY ) / (float)clusterDimY;
-    float logDimY = 1.0f / glm::log( 1.0f + sD );
-
-    float logDepth = glm::log( zFar / zNear );
-    uint32_t clusterDimZ = static_cast<uint32_t>( glm::floor( logDepth * logDimY ) );
+    g_ClusterDataCB = ComputeClusterData( *g_Camera, g_WindowWidth, g_WindowHeight, g_ClusterGridBlockSize );
 
-    g_ClusterDataCB.GridDim = glm::uvec3( clusterDimX, clusterDimY, clusterDimZ );
-    g_ClusterDataCB.ViewNear = zNear;
-    g_ClusterDataCB.Size = glm::uvec2( g_ClusterGridBlockSize, g_ClusterGridBlockSize );
-    g_ClusterDataCB.NearK = 1.0f + sD;
-    g_ClusterDataCB.LogGridDimY = logDimY;
+    uint32_t clusterDimX = g_ClusterDataCB.GridDim.x;
+    uint32_t clusterDimY = g_ClusterDataCB.GridDim.y;
+    uint32_t clusterDimZ = g_ClusterDataCB.GridDim.z;
 
     auto commandQueue = g_RenderDevice->GetComputeQueue();
     auto commandBuffer = commandQueue->GetComputeCommandBuffer();
@@ -2032,6 +2771,18 @@ void UpdateClusterGrid()
     g_PreviousUniqueClusters = g_RenderDevice->CreateStructuredBuffer( commandBuffer, clusterDimX * clusterDimY * clusterDimZ, sizeof( uint32_t ) );
     g_PreviousUniqueClusters->SetName( L"Previous Unique Clusters" );
 
+    // The cluster flags of the previous frame are used to find newly visible clusters for incremental light assignment.
+    g_PreviousClusterFlags = g_RenderDevice->CreateStructuredBuffer( commandBuffer, clusterDimX * clusterDimY * clusterDimZ, sizeof( uint32_t ) );
+    g_PreviousClusterFlags->SetName( L"Previous Cluster Flags" );
+
+    // The unique clusters that need to be updated for incremental light assignment.
+    g_DirtyClusters = g_RenderDevice->CreateStructuredBuffer( commandBuffer, clusterDimX * clusterDimY * clusterDimZ, sizeof( uint32_t ) );
+    g_DirtyClusters->SetName( L"Dirty Clusters" );
+    g_DirtyClusters->GetCounterBuffer()->SetName( L"Dirty Clusters (Counter)" );
+
+    // The light lists of the previous cluster grid cannot be reused.
+    g_ClusterLightListsValid = false;
+
     // When recreating the unique cluster structures, then force the recreation of the 
     // unique clusters again to update the unique cluster list.
     g_UpdateUniqueClusters = true;
@@ -2041,6 +2792,9 @@ void UpdateClusterGrid()
         // Create a buffer to store the indirect dispatch arguments for the Assign Lights to Clusters compute shader.
         g_AssignLightsToClustersArgumentBuffer = g_RenderDevice->CreateByteAddressBuffer( commandBuffer, sizeof( DispatchIndirectArgument ) );
         g_AssignLightsToClustersArgumentBuffer->SetName( L"Assign Lights to Clusters Indirect Argument Buffer" );
+
+        g_AssignLightsToDirtyClustersArgumentBuffer = g_RenderDevice->CreateByteAddressBuffer( commandBuffer, sizeof( DispatchIndirectArgument ) );
+        g_AssignLightsToDirtyClustersArgumentBuffer->SetName( L"Assign Lights to Dirty Clusters Indirect Argument Buffer" );
     }
 
     if ( !g_DebugClustersDrawIndirectArgumentBuffer )
@@ -2065,12 +2819,13 @@ void UpdateClusterGrid()
     g_SpotLightGrid_Cluster = g_RenderDevice->CreateStructuredBuffer( commandBuffer, clusterDimX * clusterDimY * clusterDimZ, sizeof( glm::uvec2 ) );
     g_SpotLightGrid_Cluster->SetName( L"Spot Light Grid (Clustered)" );
 
-    // Create global light index lists for clustered rendering.
-    g_PointLightIndexList_Cluster = g_RenderDevice->CreateStructuredBuffer( commandBuffer, clusterDimX * clusterDimY * clusterDimZ * AVERAGE_OVERLAPPING_LIGHTS_PER_CLUSTER, sizeof( uint32_t ) );
-    g_PointLightIndexList_Cluster->SetName( L"Point Light Index List (Clustered)" );
+    // Create a buffer to store the sums of the thread groups of the light grid prefix sum.
+    uint32_t numPrefixSumThreadGroups = static_cast<uint32_t>( glm::ceil( ( clusterDimX * clusterDimY * clusterDimZ ) / (float)PREFIX_SUM_ELEMENTS_PER_THREAD_GROUP ) );
+    g_LightGridGroupSums = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numPrefixSumThreadGroups, sizeof( glm::uvec2 ) );
+    g_LightGridGroupSums->SetName( L"Light Grid Group Sums" );
 
-    g_SpotLightIndexList_Cluster = g_RenderDevice->CreateStructuredBuffer( commandBuffer, clusterDimX * clusterDimY * clusterDimZ * AVERAGE_OVERLAPPING_LIGHTS_PER_CLUSTER, sizeof( uint32_t ) );
-    g_SpotLightIndexList_Cluster->SetName( L"Spot Light Index List (Clustered)" );
+    // Create global light index lists for clustered rendering.
+    CreateClusterLightIndexLists( commandBuffer );
 
     // Fill the AABB structured buffer.
     // AABB's for cluster grid are defined in view space so only need to be recomputed
@@ -2108,6 +2863,8 @@ void OnResize( ResizeEventArgs& e )
     g_ForwardPlusTransparentPSO->GetRasterizerState().SetViewport( viewport );
     g_ClusteredOpaquePSO->GetRasterizerState().SetViewport( viewport );
     g_ClusteredTransparentPSO->GetRasterizerState().SetViewport( viewport );
+    g_ZBinnedOpaquePSO->GetRasterizerState().SetViewport( viewport );
+    g_ZBinnedTransparentPSO->GetRasterizerState().SetViewport( viewport );
     g_DebugPointLightsPSO->GetRasterizerState().SetViewport( viewport );
     g_DebugSpotLightsPSO->GetRasterizerState().SetViewport( viewport );
     g_DebugDepthTexturePSO->GetRasterizerState().SetViewport( viewport );
@@ -2156,11 +2913,22 @@ void OnRender( RenderEventArgs& e )
         }
         else
         {
+            // Upload the streamed mip levels before the scene is rendered.
+            if ( g_TextureStreamer )
+            {
+                g_TextureStreamer->Update( commandBuffer, *g_Camera );
+            }
+
             g_DebugLightsPass->SetEnabled( g_RenderLights );
             g_DebugLightCountsPass->SetEnabled( g_RenderDebugTexture );
             g_RenderDebugTexturePass->SetEnabled( g_RenderDebugTexture );
             g_DebugClustersPass->SetEnabled( g_RenderDebugClusters );
 
+            for ( auto& scenePass : g_ScenePasses )
+            {
+                scenePass->ResetRenderStatistics();
+            }
+
             switch ( g_RenderingTechnique )
             {
             case RenderingTechnique::Forward:
@@ -2173,6 +2941,9 @@ void OnRender( RenderEventArgs& e )
             case RenderingTechnique::Clustered_Optimized:
                 g_ClusteredRenderingTechnique.Render( e );
                 break;
+            case RenderingTechnique::ZBinned:
+                g_ZBinnedRenderingTechnique.Render( e );
+                break;
             }
         }
         Profiler::Get().PopProfilingMarker(commandBuffer);
@@ -2425,6 +3196,9 @@ void OnKeyPressed( KeyEventArgs& e )
         case KeyCode::D4:
             SetRenderingTechnique(RenderingTechnique::Clustered_Optimized);
             break;
+        case KeyCode::D5:
+            SetRenderingTechnique(RenderingTechnique::ZBinned);
+            break;
         case KeyCode::D0:
             g_Camera->SetTranslate( glm::vec3( 0 ) );
             g_CameraController->SetCameraRotation( glm::quat() );
@@ -2510,6 +3284,21 @@ void CreatePointLightsBuffer( std::shared_ptr<CopyCommandBuffer> commandBuffer =
     g_PointLightsBuffer = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.PointLights );
     g_PointLightsBuffer->SetName( L"Point Lights Buffer" );
 
+    g_LightBVHDirty = true;
+
+    // Any of the lights may have been changed (or regenerated) in the config, so the
+    // light lists of all clusters must be rebuilt.
+    g_ClusterLightListsValid = false;
+
+    // The previous lights are only recreated if the number of lights changes.
+    if ( !g_PreviousPointLightsBuffer || g_PreviousPointLightsBuffer->GetNumElements() != g_PointLightsBuffer->GetNumElements() )
+    {
+        g_PreviousPointLightsBuffer = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_PointLightsBuffer->GetNumElements(), sizeof( PointLight ) );
+        g_PreviousPointLightsBuffer->SetName( L"Previous Point Lights Buffer" );
+
+        CreateMovedLightBuffers( commandBuffer );
+    }
+
     g_PointLightsReadbackBuffer = g_RenderDevice->CreateReadbackBuffer( g_Config.PointLights.size() * sizeof( PointLight ) );
 
     if ( bSubmit )
@@ -2531,6 +3320,21 @@ void CreateSpotLightsBuffer( std::shared_ptr<CopyCommandBuffer> commandBuffer =
     g_SpotLightsBuffer = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.SpotLights );
     g_SpotLightsBuffer->SetName( L"Spot Lights Buffer" );
 
+    g_LightBVHDirty = true;
+
+    // Any of the lights may have been changed (or regenerated) in the config, so the
+    // light lists of all clusters must be rebuilt.
+    g_ClusterLightListsValid = false;
+
+    // The previous lights are only recreated if the number of lights changes.
+    if ( !g_PreviousSpotLightsBuffer || g_PreviousSpotLightsBuffer->GetNumElements() != g_SpotLightsBuffer->GetNumElements() )
+    {
+        g_PreviousSpotLightsBuffer = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_SpotLightsBuffer->GetNumElements(), sizeof( SpotLight ) );
+        g_PreviousSpotLightsBuffer->SetName( L"Previous Spot Lights Buffer" );
+
+        CreateMovedLightBuffers( commandBuffer );
+    }
+
     g_SpotLightsReadbackBuffer = g_RenderDevice->CreateReadbackBuffer( g_Config.SpotLights.size() * sizeof( SpotLight ) );
 
     if ( bSubmit )
@@ -2561,6 +3365,23 @@ void CreateDirLightsBuffer( std::shared_ptr<CopyCommandBuffer> commandBuffer = n
     }
 }
 
+void CreateMovedLightBuffers( std::shared_ptr<CopyCommandBuffer> commandBuffer )
+{
+    if ( !g_MovedLightCounter )
+    {
+        g_MovedLightCounter = g_RenderDevice->CreateStructuredBuffer( commandBuffer, 1, sizeof( uint32_t ) );
+        g_MovedLightCounter->SetName( L"Moved Light Counter" );
+    }
+
+    // The previous and current bounding sphere of every light.
+    size_t numLights = g_Config.PointLights.size() + g_Config.SpotLights.size();
+    g_MovedLightSpheres = g_RenderDevice->CreateStructuredBuffer( commandBuffer, std::max<size_t>( numLights * 2, 1 ), sizeof( glm::vec4 ) );
+    g_MovedLightSpheres->SetName( L"Moved Light Spheres" );
+
+    // The previous lights don't match the current lights.
+    g_ClusterLightListsValid = false;
+}
+
 // Create the lights structured buffers.
 void CreateLightBuffers()
 {
@@ -2572,78 +3393,11 @@ void CreateLightBuffers()
     CreateSpotLightsBuffer( commandBuffer );
     CreateDirLightsBuffer( commandBuffer );
 
-    // Create a structured buffer to store the AABB for the lights in the scene.
-    if ( !g_LightsAABB )
-    {
-        // To compute the AABB for all of the lights in the scene, a parallel reduction algorithm is used.
-        // The reduction compute shader will be dispatched with 512 thread groups each group with 512 threads.
-        // The first pass of the reduction will compute 512 AABBs and the second pass will dispatch a single 
-        // thread group that will reduce the 512 AABBs into a single AABB at index 0 of the LightsAABB structured buffer.
-        g_LightsAABB = g_RenderDevice->CreateStructuredBuffer( commandBuffer, 512, sizeof( AABB ) );
-        g_LightsAABB->SetName( L"Lights AABB" );
-    }
-
-    // Create a buffer to store the Morton codes for point lights.
-    g_PointLightMortonCodes = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumPointLights, sizeof( uint32_t ) );
-    g_PointLightMortonCodes->SetName( L"Point Light Morton Codes" );
-
-    // Create a buffer to store the sorted indices for the point lights.
-    g_PointLightIndices = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumPointLights, sizeof( uint32_t ) );
-    g_PointLightIndices->SetName( L"Point Light Indices" );
-
-    // For sorting, we need to double buffer the output.
-    g_PointLightMortonCodes_OUT = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumPointLights, sizeof( uint32_t ) );
-    g_PointLightMortonCodes_OUT->SetName( L"Point Light Morton Codes (OUT)" );
-    g_PointLightIndices_OUT = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumPointLights, sizeof( uint32_t ) );
-    g_PointLightIndices_OUT->SetName( L"Point Light Indices (OUT)" );
-
-    // BVH for point lights.
-    uint32_t numNodes = GetNumNodes( g_Config.NumPointLights );
-    g_PointLightBVH = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numNodes, sizeof( AABB ) );
-    g_PointLightBVH->SetName( L"Point Light BVH" );
-
-    // BVH for spot lights.
-    numNodes = GetNumNodes( g_Config.NumSpotLights );
-    g_SpotLightBVH = g_RenderDevice->CreateStructuredBuffer( commandBuffer, numNodes, sizeof( AABB ) );
-    g_SpotLightBVH->SetName( L"Spot Light BVH" );
-
-    // Create a buffer to store the Morton codes for spot lights.
-    g_SpotLightMortonCodes = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumSpotLights, sizeof( uint32_t ) );
-    g_SpotLightMortonCodes->SetName( L"Spot Light Morton Codes" );
-
-    // Create a buffer to store the sorted indices for the spot lights.
-    g_SpotLightIndices = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumSpotLights, sizeof( uint32_t ) );
-    g_SpotLightIndices->SetName( L"Spot Light Indices" );
-
-    // For sorting, we need to double buffer the output.
-    g_SpotLightMortonCodes_OUT = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumSpotLights, sizeof( uint32_t ) );
-    g_SpotLightMortonCodes_OUT->SetName( L"Spot Light Morton Codes (OUT)" );
-    g_SpotLightIndices_OUT = g_RenderDevice->CreateStructuredBuffer( commandBuffer, g_Config.NumSpotLights, sizeof( uint32_t ) );
-    g_SpotLightIndices_OUT->SetName( L"Spot Light Indices (OUT)" );
-
-    // The maximum number of elements that need to be sorted.
-    uint32_t maxElements = glm::max( g_Config.NumPointLights, g_Config.NumSpotLights );
-    
-    // Radix sort will sort Morton codes (keys) into chunks of SORT_NUM_THREADS_PER_THREAD_GROUP size.
-    uint32_t chunkSize = SORT_NUM_THREADS_PER_THREAD_GROUP;
-    // The number of chunks that need to be merge sorted after Radix sort finishes.
-    uint32_t numChunks = static_cast<uint32_t>( glm::ceil( maxElements / (float)chunkSize ) );
-    // The number of sort groups that are needed to sort the first set of chunks.
-    // Each sort group will sort 2 chunks. So the maximum number of sort groups is 1/2 of the 
-    // number of chunks.
-    uint32_t maxSortGroups = numChunks / 2;
-    // The number of merge path partitions per sort group is the total values
-    // to be sorted per sort group (2 chunks) divided by the number of elements 
-    // that can be sorted per thread group. One is added to account for the 
-    // merge path partition at the END of the chunk.
-    uint32_t numMergePathPartitionsPerSortGroup = static_cast<uint32_t>( glm::ceil( ( chunkSize * 2 ) / (float)( SORT_ELEMENTS_PER_THREAD * SORT_NUM_THREADS_PER_THREAD_GROUP ) ) ) + 1u;
-
-    // The maximum number of merge path partitions is the number of merge path partitions
-    // needed by a single sort group multiplied by the maximum number of sort groups.
-    uint32_t maxMergePathPartitions = numMergePathPartitionsPerSortGroup * maxSortGroups;
-
-    g_MergePathPartitions = g_RenderDevice->CreateStructuredBuffer( commandBuffer, maxMergePathPartitions, sizeof( uint32_t ) );
-    g_MergePathPartitions->SetName( L"Merge Path Partitions" );
+    // Create the buffers to sort the lights and to store the light BVHs.
+    g_LightBVHBuilder->SetNumLights( commandBuffer, g_Config.NumPointLights, g_Config.NumSpotLights );
+
+    // The size of the tile bitmasks depends on the number of lights.
+    CreateZBinBuffers( commandBuffer );
 
     auto fence = commandQueue->Submit( commandBuffer );
     fence->WaitFor();
@@ -2719,7 +3473,7 @@ void ReadbackDirLights( void* dstBuffer, std::shared_ptr<CopyCommandBuffer> comm
 }
 
 // Readback the light buffers from the GPU buffers.
-void ReadbackLightBufers()
+void ReadbackLightBuffers()
 {
     auto commandQueue = g_RenderDevice->GetGraphicsQueue();
     auto commandBuffer = commandQueue->GetCopyCommandBuffer();
@@ -2734,6 +3488,8 @@ void ReadbackLightBufers()
     g_PointLightsReadbackBuffer->GetData( g_Config.PointLights.data() );
     g_SpotLightsReadbackBuffer->GetData( g_Config.SpotLights.data() );
     g_DirectionalLightsReadbackBuffer->GetData( g_Config.DirectionalLights.data() );
+
+    g_LightsAnimatedOnGPU = false;
 }
 
 void GenerateLights()
@@ -2742,52 +3498,26 @@ void GenerateLights()
     SelectSpotLight( nullptr );
     SelectDirLight( nullptr );
 
-    g_Config.PointLights = GenerateLights<PointLight>( g_Config.NumPointLights );
-    g_Config.SpotLights = GenerateLights<SpotLight>( g_Config.NumSpotLights );
-    g_Config.DirectionalLights = GenerateLights<DirectionalLight>( g_Config.NumDirectionalLights );
-
-    CreateLightBuffers();
-}
-
-template<typename LightType>
-LightType GenerateLight( const glm::vec4& positionWS, const glm::vec4& directionWS, float spotAngle, float range, const glm::vec3& color )
-{
-    static_assert( false, "non specialized version of this function cannot be used." );
-    return LightType();
-}
+    LightGeneratorArgs args;
+    args.MinBounds = g_Config.LightsMinBounds;
+    args.MaxBounds = g_Config.LightsMaxBounds;
+    args.MinSpotAngle = g_Config.MinSpotAngle;
+    args.MaxSpotAngle = g_Config.MaxSpotAngle;
+    args.MinRange = g_Config.MinRange;
+    args.MaxRange = g_Config.MaxRange;
+    args.Seed = g_LightSeed;
 
-template<>
-PointLight GenerateLight<PointLight>( const glm::vec4& positionWS, const glm::vec4& directionWS, float spotAngle, float range, const glm::vec3& color )
-{
-    PointLight light;
-    light.m_PositionWS = positionWS;
-    light.m_Color = color;
-    light.m_Range = range;
+    auto start = high_resolution_clock::now();
 
-    return light;
-}
-
-template<>
-SpotLight GenerateLight<SpotLight>( const glm::vec4& positionWS, const glm::vec4& directionWS, float spotAngle, float range, const glm::vec3& color )
-{
-    SpotLight light;
-    light.m_PositionWS = positionWS;
-    light.m_DirectionWS = directionWS;
-    light.m_Color = color;
-    light.m_SpotlightAngle = spotAngle;
-    light.m_Range = range;
+    LightGeneratorCPU lightGenerator( ThreadPool::Get() );
+    lightGenerator.Generate( args, g_Config.NumPointLights, g_Config.PointLights );
+    lightGenerator.Generate( args, g_Config.NumSpotLights, g_Config.SpotLights );
+    lightGenerator.Generate( args, g_Config.NumDirectionalLights, g_Config.DirectionalLights );
 
-    return light;
-}
+    double generateTime = duration_cast<duration<double, std::milli>>( high_resolution_clock::now() - start ).count();
+    LOG_INFO( "Generated ", g_Config.NumPointLights + g_Config.NumSpotLights + g_Config.NumDirectionalLights, " lights (seed ", g_LightSeed, ") in ", generateTime, " ms." );
 
-template<>
-DirectionalLight GenerateLight<DirectionalLight>( const glm::vec4& positionWS, const glm::vec4& directionWS, float spotAngle, float range, const glm::vec3& color )
-{
-    DirectionalLight light;
-    light.m_DirectionWS = directionWS;
-    light.m_Color = color;
-
-    return light;
+    CreateLightBuffers();
 }
 
 /**
@@ -2805,25 +3535,6 @@ std::vector<glm::vec4> GenerateColors( uint32_t numColors )
     return colors;
 }
 
-template<typename LightType>
-std::vector<LightType> GenerateLights( uint32_t numLights )
-{
-    std::vector<LightType> lights( numLights );
-
-    for ( auto& light : lights )
-    {
-        glm::vec4 positionWS = glm::vec4( glm::linearRand( g_Config.LightsMinBounds, g_Config.LightsMaxBounds ), 1.0f );
-        glm::vec4 directionWS = glm::vec4( glm::sphericalRand( 1.0f ), 0.0f );
-        float spotAngle = glm::linearRand( g_Config.MinSpotAngle, g_Config.MaxSpotAngle );
-        float range = glm::linearRand( g_Config.MinRange, g_Config.MaxRange );
-        glm::vec3 color = HSVtoRGB( glm::linearRand( 0.0f, 360.0f ), glm::linearRand( 0.0f, 1.0f ), 1.0f );
-
-        light = GenerateLight<LightType>( positionWS, directionWS, spotAngle, range, color );
-    }
-
-    return lights;
-}
-
 // GUI related functions
 
 template<typename T>
@@ -2886,6 +3597,40 @@ void ShowStatistics( bool& bShowWindow )
             ImGui::Text( ss.str().c_str() );
             ImGui::Combo( "Render Technique", reinterpret_cast<int*>(&g_RenderingTechnique), RenderTechniqueName, static_cast<int>(RenderingTechnique::NumTechniques) );
             ImGui::Separator();
+            if ( ImGui::Button( "Compare Z-Binning / Light BVH" ) )
+            {
+                CompareZBinningAndLightBVH();
+            }
+            if ( g_ZBinningComparison.Valid )
+            {
+                ImGui::Text( "CPU Z-Binning: %.3f ms\t%.2f KB", g_ZBinningComparison.ZBinningBuildTime, g_ZBinningComparison.ZBinningMemory / 1024.0 );
+                ImGui::Text( "CPU Light BVH: %.3f ms (+ %.3f ms assign)\t%.2f KB", g_ZBinningComparison.BVHBuildTime, g_ZBinningComparison.BVHAssignLightsTime, g_ZBinningComparison.BVHMemory / 1024.0 );
+            }
+
+            // The memory of the GPU buffers that are used to find the lights during shading.
+            size_t zBinningGPUMemory = GetBufferSize( g_LightBVHBuilder->GetPointLightIndices() ) + GetBufferSize( g_LightBVHBuilder->GetSpotLightIndices() ) +
+                                       GetBufferSize( g_PointLightZBins ) + GetBufferSize( g_SpotLightZBins ) +
+                                       GetBufferSize( g_PointLightTileMasks ) + GetBufferSize( g_SpotLightTileMasks );
+            size_t bvhGPUMemory = GetBufferSize( g_LightBVHBuilder->GetPointLightIndices() ) + GetBufferSize( g_LightBVHBuilder->GetSpotLightIndices() ) +
+                                  GetBufferSize( g_LightBVHBuilder->GetPointLightBVH() ) + GetBufferSize( g_LightBVHBuilder->GetSpotLightBVH() ) +
+                                  GetBufferSize( g_PointLightGrid_Cluster ) + GetBufferSize( g_SpotLightGrid_Cluster ) +
+                                  GetBufferSize( g_PointLightIndexList_Cluster ) + GetBufferSize( g_SpotLightIndexList_Cluster );
+            ImGui::Text( "GPU Z-Binning: %.2f KB\tLight BVH: %.2f KB", zBinningGPUMemory / 1024.0, bvhGPUMemory / 1024.0 );
+            if ( g_TextureStreamer )
+            {
+                ImGui::Text( "Streamed textures: %zu\t%.2f / %.2f MB", g_TextureStreamer->GetNumTextures(),
+                             g_TextureStreamer->GetResidentSize() / ( 1024.0 * 1024.0 ), g_TextureStreamer->GetMemoryBudget() / ( 1024.0 * 1024.0 ) );
+            }
+            // Summed over all passes that render the scene (including the depth pre-pass).
+            BasePass::RenderStatistics renderStatistics;
+            for ( auto& scenePass : g_ScenePasses )
+            {
+                renderStatistics += scenePass->GetRenderStatistics();
+            }
+            ImGui::Text( "Visible meshes: %u\tCulled meshes: %u\tMaterial binds: %u", renderStatistics.NumVisibleMeshes, renderStatistics.NumCulledMeshes, renderStatistics.NumMaterialBinds );
+            ImGui::Text( "Draw calls: %u (instanced: %u)", renderStatistics.NumDrawCalls, renderStatistics.NumInstancedDraws );
+            ImGui::Text( "Sorted triangles: %u (incremental: %u)", renderStatistics.NumSortedTriangles, renderStatistics.NumIncrementalSortedTriangles );
+            ImGui::Separator();
             ImGui::Text( "CPU: %08.5f ms\tFPS: %.5f", averageTime * 1000.0, averageFPS );
             ImGui::Separator();
 
@@ -3143,6 +3888,12 @@ void ShowGenerateLightsWindow( bool& bShowWindow )
         }
 
 
+        int lightSeed = static_cast<int>( g_LightSeed );
+        if ( ImGui::InputInt( "Seed", &lightSeed ) )
+        {
+            g_LightSeed = static_cast<uint32_t>( lightSeed );
+        }
+
         if ( ImGui::Button( "Generate Lights" ) )
         {
             GenerateLights();
@@ -3178,6 +3929,41 @@ void ShowOptionsWindow( bool& bShowWindow )
         ImGui::Checkbox( "Render Debug Lights", &g_RenderLights ); ImGui::SameLine(); ImGui::TextDisabled( "L" );
         ImGui::Checkbox( "Update Clusters", &g_UpdateUniqueClusters ); ImGui::SameLine(); ImGui::TextDisabled( "Shift+F" );
         ImGui::Checkbox( "Animate Lights", &g_Animate ); ImGui::SameLine(); ImGui::TextDisabled( "Space" );
+
+        if ( ImGui::Checkbox( "Build Light BVH on CPU", &g_BuildLightBVHOnCPU ) )
+        {
+            g_LightBVHDirty = true;
+        }
+        if ( g_BuildLightBVHOnCPU )
+        {
+            ImGui::TextDisabled( "BVH Rebuilds: %u Refits: %u", g_PointLightBVHCPU.GetNumRebuilds(), g_PointLightBVHCPU.GetNumRefits() );
+        }
+        if ( ImGui::Checkbox( "64-bit Morton Codes", &g_Use64BitMortonCodes ) )
+        {
+            // Recreates the Morton code buffers.
+            g_LightBVHBuilder->SetUse64BitMortonCodes( g_Use64BitMortonCodes );
+
+            g_LightBVHDirty = true;
+        }
+        ImGui::Checkbox( "Incremental Light Assignment", &g_IncrementalLightAssignment );
+        if ( ImGui::Checkbox( "Exact Light Index Lists", &g_ExactLightIndexLists ) )
+        {
+            auto commandQueue = g_RenderDevice->GetCopyQueue();
+            auto commandBuffer = commandQueue->GetCopyCommandBuffer();
+
+            CreateClusterLightIndexLists( commandBuffer );
+
+            commandQueue->Submit( commandBuffer )->WaitFor();
+        }
+        if ( ImGui::Button( "Validate Light BVH" ) )
+        {
+            ValidateLightBVH();
+        }
+        ImGui::SameLine();
+        if ( ImGui::Button( "Light BVH Statistics" ) )
+        {
+            LogLightBVHStatistics();
+        }
     }
     ImGui::End();
 
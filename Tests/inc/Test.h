@@ -0,0 +1,91 @@
+#pragma once
+
+/*
+ *  Copyright(c) 2026 VolumeTiledForwardShading contributors
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files(the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions :
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *  IN THE SOFTWARE.
+ */
+
+/**
+ *  @file Test.h
+ *  @date October 18, 2026
+ *
+ *  @brief A minimal unit test framework for the device-free engine tests.
+ */
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Test
+{
+    using TestFunction = std::function<void()>;
+
+    struct TestCase
+    {
+        const char* Name;
+        TestFunction Function;
+        // Benchmarks are only run if the test runner is started with --benchmark.
+        bool IsBenchmark;
+    };
+
+    // All test cases that were registered with the TEST and BENCHMARK macros.
+    std::vector<TestCase>& GetTestCases();
+
+    struct Registrar
+    {
+        Registrar( const char* name, TestFunction function, bool isBenchmark )
+        {
+            GetTestCases().push_back( { name, std::move( function ), isBenchmark } );
+        }
+    };
+
+    // Report a failed check of the test that is currently running.
+    void ReportFailure( const char* file, int line, const std::string& message );
+}
+
+#define TEST( name ) \
+    static void name(); \
+    static Test::Registrar name##_Registrar( #name, &name, false ); \
+    static void name()
+
+#define BENCHMARK( name ) \
+    static void name(); \
+    static Test::Registrar name##_Registrar( #name, &name, true ); \
+    static void name()
+
+#define CHECK( expression ) \
+    do \
+    { \
+        if ( !( expression ) ) Test::ReportFailure( __FILE__, __LINE__, #expression ); \
+    } while ( false )
+
+#define CHECK_EQUAL( expected, actual ) \
+    do \
+    { \
+        if ( !( ( expected ) == ( actual ) ) ) Test::ReportFailure( __FILE__, __LINE__, #expected " == " #actual ); \
+    } while ( false )
+
+#define CHECK_THROWS( expression ) \
+    do \
+    { \
+        bool threw = false; \
+        try { expression; } catch ( ... ) { threw = true; } \
+        if ( !threw ) Test::ReportFailure( __FILE__, __LINE__, #expression " did not throw" ); \
+    } while ( false )
@@ -0,0 +1,185 @@
+#include <TestsPCH.h>
+
+#include <DependencyDatabase.h>
+
+namespace
+{
+    // A directory with a few source files that is removed when the test ends.
+    class TestDirectory
+    {
+    public:
+        TestDirectory()
+            : m_Path( fs::temp_directory_path() / "DependencyDatabaseTests" )
+        {
+            fs::remove_all( m_Path );
+            fs::create_directories( m_Path );
+
+            WriteFile( "Asset.txt", "asset" );
+            WriteFile( "Include.txt", "include" );
+        }
+
+        ~TestDirectory()
+        {
+            std::error_code error;
+            fs::remove_all( m_Path, error );
+        }
+
+        fs::path GetPath( const std::string& fileName ) const
+        {
+            return m_Path / fileName;
+        }
+
+        void WriteFile( const std::string& fileName, const std::string& contents ) const
+        {
+            std::ofstream file( GetPath( fileName ), std::ios::out | std::ios::binary | std::ios::trunc );
+            file << contents;
+        }
+
+        std::vector<char> ReadFile( const std::string& fileName ) const
+        {
+            std::ifstream file( GetPath( fileName ), std::ios::in | std::ios::binary );
+            return std::vector<char>( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+        }
+
+        void WriteFile( const std::string& fileName, const std::vector<char>& contents ) const
+        {
+            std::ofstream file( GetPath( fileName ), std::ios::out | std::ios::binary | std::ios::trunc );
+            file.write( contents.data(), static_cast<std::streamsize>( contents.size() ) );
+        }
+
+    private:
+        fs::path m_Path;
+    };
+
+    const uint64_t BuildParameters = 42;
+
+    // Save a database with a single asset that depends on Include.txt.
+    void SaveDatabase( const TestDirectory& directory )
+    {
+        DependencyDatabase database;
+        CHECK( !database.Load( directory.GetPath( "Dependencies.db" ) ) );
+
+        database.SetDependencies( directory.GetPath( "Asset.txt" ), { directory.GetPath( "Include.txt" ) } );
+        database.SetImportHash( directory.GetPath( "Asset.txt" ), 1234 );
+        database.SetBuilt( directory.GetPath( "Asset.txt" ), BuildParameters );
+
+        CHECK( database.Save() );
+    }
+
+    // The header of the database file (see DependencyDatabase.cpp).
+    struct DatabaseHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t NumFiles;
+        uint32_t NumAssets;
+    };
+
+    // Corrupt the header of a saved database and check that the database can't be loaded.
+    bool LoadCorrupted( const TestDirectory& directory, const std::function<void( DatabaseHeader& header )>& corrupt )
+    {
+        std::vector<char> bytes = directory.ReadFile( "Dependencies.db" );
+        corrupt( *reinterpret_cast<DatabaseHeader*>( bytes.data() ) );
+        directory.WriteFile( "Corrupt.db", bytes );
+
+        DependencyDatabase database;
+        bool isLoaded = database.Load( directory.GetPath( "Corrupt.db" ) );
+
+        // A database that can't be loaded is empty.
+        CHECK( isLoaded || database.GetAssets().empty() );
+
+        return isLoaded;
+    }
+}
+
+TEST( DependencyDatabase_SaveAndLoad )
+{
+    TestDirectory directory;
+    SaveDatabase( directory );
+
+    DependencyDatabase database;
+    CHECK( database.Load( directory.GetPath( "Dependencies.db" ) ) );
+
+    std::vector<fs::path> dependencies;
+    CHECK( database.GetDependencies( directory.GetPath( "Asset.txt" ), dependencies ) );
+    CHECK_EQUAL( size_t( 2 ), dependencies.size() );
+    if ( dependencies.size() == 2 )
+    {
+        CHECK( DependencyDatabase::GetKey( dependencies[0] ) == DependencyDatabase::GetKey( directory.GetPath( "Asset.txt" ) ) );
+        CHECK( DependencyDatabase::GetKey( dependencies[1] ) == DependencyDatabase::GetKey( directory.GetPath( "Include.txt" ) ) );
+    }
+
+    CHECK_EQUAL( 1234ull, database.GetImportHash( directory.GetPath( "Asset.txt" ) ) );
+    CHECK( database.IsBuilt( directory.GetPath( "Asset.txt" ) ) );
+
+    uint64_t buildParameters = BuildParameters;
+    CHECK( !database.IsStale( directory.GetPath( "Asset.txt" ), &buildParameters ) );
+
+    buildParameters = BuildParameters + 1;
+    CHECK( database.IsStale( directory.GetPath( "Asset.txt" ), &buildParameters ) );
+}
+
+TEST( DependencyDatabase_ChangedDependencyIsStale )
+{
+    TestDirectory directory;
+    SaveDatabase( directory );
+
+    // The database is loaded before the file changes, so the
+    // file is hashed again because its size changed.
+    directory.WriteFile( "Include.txt", "changed include" );
+
+    DependencyDatabase database;
+    CHECK( database.Load( directory.GetPath( "Dependencies.db" ) ) );
+    CHECK( database.IsStale( directory.GetPath( "Asset.txt" ) ) );
+
+    database.SetBuilt( directory.GetPath( "Asset.txt" ), BuildParameters );
+    CHECK( !database.IsStale( directory.GetPath( "Asset.txt" ) ) );
+
+    // Checked files are not checked again until they are invalidated.
+    directory.WriteFile( "Include.txt", "include changed again" );
+    CHECK( !database.IsStale( directory.GetPath( "Asset.txt" ) ) );
+
+    database.InvalidateFile( directory.GetPath( "Include.txt" ) );
+    CHECK( database.IsStale( directory.GetPath( "Asset.txt" ) ) );
+}
+
+TEST( DependencyDatabase_RejectsCorruptFiles )
+{
+    TestDirectory directory;
+    SaveDatabase( directory );
+
+    CHECK( LoadCorrupted( directory, []( DatabaseHeader& ) {} ) );
+
+    CHECK( !LoadCorrupted( directory, []( DatabaseHeader& header )
+    {
+        header.Magic = 0;
+    } ) );
+
+    // The counts must fit in the size of the file (the records are not allocated).
+    CHECK( !LoadCorrupted( directory, []( DatabaseHeader& header )
+    {
+        header.NumFiles = 0xffffffff;
+    } ) );
+
+    CHECK( !LoadCorrupted( directory, []( DatabaseHeader& header )
+    {
+        header.NumAssets = 0xffffffff;
+    } ) );
+
+    // The asset records reference more files than the database contains.
+    CHECK( !LoadCorrupted( directory, []( DatabaseHeader& header )
+    {
+        header.NumFiles = 1;
+    } ) );
+
+    // Truncated files.
+    std::vector<char> bytes = directory.ReadFile( "Dependencies.db" );
+    for ( size_t size : { size_t( 0 ), sizeof( DatabaseHeader ) - 1, sizeof( DatabaseHeader ) + 5, bytes.size() - 1 } )
+    {
+        directory.WriteFile( "Truncated.db", std::vector<char>( bytes.begin(), bytes.begin() + size ) );
+
+        DependencyDatabase database;
+        CHECK( !database.Load( directory.GetPath( "Truncated.db" ) ) );
+        CHECK( database.GetAssets().empty() );
+    }
+}
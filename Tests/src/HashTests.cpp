@@ -0,0 +1,85 @@
+#include <TestsPCH.h>
+
+#include <Hash.h>
+
+using namespace Core;
+
+namespace
+{
+    uint64_t Hash( const std::string& string, uint64_t seed = 0 )
+    {
+        return Hasher::Hash( string.data(), string.size(), seed );
+    }
+
+    std::vector<uint8_t> GetSequence( size_t size )
+    {
+        std::vector<uint8_t> bytes( size );
+        for ( size_t i = 0; i < size; ++i )
+        {
+            bytes[i] = static_cast<uint8_t>( i );
+        }
+
+        return bytes;
+    }
+}
+
+TEST( Hash_XXH64TestVectors )
+{
+    // The hashes are stored on disk so they must match the reference implementation.
+    CHECK_EQUAL( 0xEF46DB3751D8E999ull, Hash( "" ) );
+    CHECK_EQUAL( 0xD24EC4F1A98C6E5Bull, Hash( "a" ) );
+    CHECK_EQUAL( 0x44BC2CF5AD770999ull, Hash( "abc" ) );
+    CHECK_EQUAL( 0xFBCEA83C8A378BF1ull, Hash( "Nobody inspects the spammish repetition" ) );
+
+    // Longer than a stripe (32 bytes) with a tail of 4 bytes.
+    std::vector<uint8_t> bytes = GetSequence( 100 );
+    CHECK_EQUAL( 0x6AC1E58032166597ull, Hasher::Hash( bytes.data(), bytes.size() ) );
+    CHECK_EQUAL( 0x3B97D91EBA03E785ull, Hasher::Hash( bytes.data(), bytes.size(), 0x9E3779B97F4A7C15ull ) );
+}
+
+TEST( Hash_UpdateMatchesHash )
+{
+    std::vector<uint8_t> bytes = GetSequence( 1000 );
+    uint64_t expected = Hasher::Hash( bytes.data(), bytes.size() );
+
+    // The hash doesn't depend on how the bytes are split over the calls to Update.
+    std::mt19937 rng( 1 );
+    for ( int i = 0; i < 16; ++i )
+    {
+        Hasher hasher;
+        size_t offset = 0;
+        while ( offset < bytes.size() )
+        {
+            size_t size = std::min<size_t>( std::uniform_int_distribution<size_t>( 0, 70 )( rng ), bytes.size() - offset );
+            hasher.Update( bytes.data() + offset, size );
+            offset += size;
+        }
+
+        CHECK_EQUAL( expected, hasher.GetHash() );
+    }
+
+    uint64_t value = 0x0123456789ABCDEFull;
+    Hasher hasher( 42 );
+    hasher.Update( value );
+    CHECK_EQUAL( Hasher::Hash( &value, sizeof( value ), 42 ), hasher.GetHash() );
+}
+
+TEST( Hash_HashFile )
+{
+    fs::path filePath = fs::temp_directory_path() / "HashTests.bin";
+
+    // Larger than the block size that is used to read the file.
+    std::vector<uint8_t> bytes = GetSequence( 200 * 1024 + 17 );
+    {
+        std::ofstream file( filePath, std::ios::out | std::ios::binary | std::ios::trunc );
+        file.write( reinterpret_cast<const char*>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ) );
+    }
+
+    uint64_t hash = 0;
+    CHECK( Hasher::HashFile( filePath, hash ) );
+    CHECK_EQUAL( Hasher::Hash( bytes.data(), bytes.size() ), hash );
+
+    fs::remove( filePath );
+
+    CHECK( !Hasher::HashFile( filePath, hash ) );
+}
@@ -0,0 +1,152 @@
+#include <TestsPCH.h>
+
+#include <Graphics/IndexOptimizer.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // A regular grid of numQuads x numQuads quads (two triangles per quad).
+    std::vector<uint32_t> CreateGridIndices( uint32_t numQuads )
+    {
+        std::vector<uint32_t> indices;
+        for ( uint32_t y = 0; y < numQuads; ++y )
+        {
+            for ( uint32_t x = 0; x < numQuads; ++x )
+            {
+                uint32_t i0 = y * ( numQuads + 1 ) + x;
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = i0 + numQuads + 1;
+                uint32_t i3 = i2 + 1;
+
+                indices.insert( indices.end(), { i0, i1, i2, i2, i1, i3 } );
+            }
+        }
+
+        return indices;
+    }
+
+    // A UV sphere (the triangles on the far side are occluded by the triangles on the near side).
+    std::vector<Mesh::Vertex> CreateSphere( uint32_t numSegments, std::vector<uint32_t>& indices )
+    {
+        std::vector<Mesh::Vertex> vertices;
+        for ( uint32_t y = 0; y <= numSegments; ++y )
+        {
+            for ( uint32_t x = 0; x <= numSegments; ++x )
+            {
+                float theta = glm::pi<float>() * y / numSegments;
+                float phi = glm::two_pi<float>() * x / numSegments;
+
+                Mesh::Vertex vertex = {};
+                vertex.Normal = glm::vec3( std::sin( theta ) * std::cos( phi ), std::cos( theta ), std::sin( theta ) * std::sin( phi ) );
+                vertex.Position = vertex.Normal;
+                vertices.push_back( vertex );
+            }
+        }
+
+        indices = CreateGridIndices( numSegments );
+
+        return vertices;
+    }
+
+    void ShuffleTriangles( std::vector<uint32_t>& indices, uint32_t seed )
+    {
+        std::vector<std::array<uint32_t, 3>> triangles( indices.size() / 3 );
+        std::memcpy( triangles.data(), indices.data(), indices.size() * sizeof( uint32_t ) );
+        std::shuffle( triangles.begin(), triangles.end(), std::mt19937( seed ) );
+        std::memcpy( indices.data(), triangles.data(), indices.size() * sizeof( uint32_t ) );
+    }
+
+    // The triangles of an index buffer, rotated so that the smallest index comes first
+    // (this keeps the winding order) and sorted.
+    std::vector<std::array<uint32_t, 3>> GetTriangles( const std::vector<uint32_t>& indices )
+    {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for ( size_t i = 0; i + 2 < indices.size(); i += 3 )
+        {
+            std::array<uint32_t, 3> triangle = { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate( triangle.begin(), std::min_element( triangle.begin(), triangle.end() ), triangle.end() );
+            triangles.push_back( triangle );
+        }
+
+        std::sort( triangles.begin(), triangles.end() );
+
+        return triangles;
+    }
+
+    float GetACMR( const std::vector<uint32_t>& indices, size_t numVertices )
+    {
+        return IndexOptimizer::AnalyzeVertexCache( indices.data(), indices.size(), numVertices ).GetACMR();
+    }
+}
+
+TEST( IndexOptimizer_AnalyzeVertexCache )
+{
+    // Two triangles that share an edge transform 4 vertices.
+    std::vector<uint32_t> indices = { 0, 1, 2, 2, 1, 3 };
+    VertexCacheStatistics statistics = IndexOptimizer::AnalyzeVertexCache( indices.data(), indices.size(), 4 );
+
+    CHECK_EQUAL( 4ull, statistics.VerticesTransformed );
+    CHECK_EQUAL( 2ull, statistics.NumTriangles );
+    CHECK_EQUAL( 4ull, statistics.NumVertices );
+    CHECK( statistics.GetACMR() == 2.0f );
+    CHECK( statistics.GetATVR() == 1.0f );
+
+    // A cache with room for a single triangle misses the shared vertices of non-adjacent triangles.
+    indices = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    statistics = IndexOptimizer::AnalyzeVertexCache( indices.data(), indices.size(), 6, 3 );
+    CHECK_EQUAL( 9ull, statistics.VerticesTransformed );
+    CHECK_EQUAL( 6ull, statistics.NumVertices );
+}
+
+TEST( IndexOptimizer_OptimizeVertexCache )
+{
+    const uint32_t numQuads = 64;
+    const size_t numVertices = ( numQuads + 1 ) * ( numQuads + 1 );
+
+    std::vector<uint32_t> indices = CreateGridIndices( numQuads );
+    ShuffleTriangles( indices, 1 );
+
+    std::vector<uint32_t> optimized = indices;
+    IndexOptimizer::OptimizeVertexCache( optimized.data(), optimized.size(), numVertices );
+
+    // The same triangles (with the same winding) must be rendered.
+    CHECK( GetTriangles( indices ) == GetTriangles( optimized ) );
+
+    // A shuffled grid has an ACMR close to 3. A vertex cache optimized
+    // grid should get close to the optimum of 0.5 for large grids.
+    float acmr = GetACMR( optimized, numVertices );
+    CHECK( GetACMR( indices, numVertices ) > 2.0f );
+    CHECK( acmr < 0.8f );
+}
+
+TEST( IndexOptimizer_OptimizeOverdraw )
+{
+    std::vector<uint32_t> indices;
+    std::vector<Mesh::Vertex> vertices = CreateSphere( 32, indices );
+
+    ShuffleTriangles( indices, 2 );
+    IndexOptimizer::OptimizeVertexCache( indices.data(), indices.size(), vertices.size() );
+
+    const float threshold = 1.05f;
+    std::vector<uint32_t> optimized = indices;
+    IndexOptimizer::OptimizeOverdraw( optimized.data(), optimized.size(), vertices.data(), vertices.size(), threshold );
+
+    CHECK( GetTriangles( indices ) == GetTriangles( optimized ) );
+
+    // The clusters are split where the ACMR increases by less than the threshold
+    // (reordering the clusters may lose some more of the cache hits between clusters).
+    CHECK( GetACMR( optimized, vertices.size() ) <= GetACMR( indices, vertices.size() ) * threshold * 1.1f );
+}
+
+TEST( IndexOptimizer_16BitIndices )
+{
+    CHECK( IndexOptimizer::CanUse16BitIndices( 65536 ) );
+    CHECK( !IndexOptimizer::CanUse16BitIndices( 65537 ) );
+
+    std::vector<uint32_t> indices = { 0, 1, 65535, 1234 };
+    std::vector<uint16_t> shortIndices( indices.size() );
+    IndexOptimizer::ConvertTo16BitIndices( indices.data(), indices.size(), shortIndices.data() );
+
+    CHECK( std::equal( indices.begin(), indices.end(), shortIndices.begin() ) );
+}
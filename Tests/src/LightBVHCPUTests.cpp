@@ -0,0 +1,204 @@
+#include <TestsPCH.h>
+
+#include <Graphics/CPU/ClusterLightAssignmentCPU.h>
+#include <Graphics/CPU/LightBVHCPU.h>
+#include <Graphics/PointLight.h>
+
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    std::vector<PointLight> GenerateLights( uint32_t numLights, float extent, uint32_t seed )
+    {
+        std::mt19937 rng( seed );
+        std::uniform_real_distribution<float> position( -extent, extent );
+        std::uniform_real_distribution<float> range( 1.0f, 5.0f );
+
+        std::vector<PointLight> lights( numLights );
+        for ( PointLight& light : lights )
+        {
+            light.m_PositionWS = light.m_PositionVS = glm::vec4( position( rng ), position( rng ), position( rng ), 1.0f );
+            light.m_Range = range( rng );
+        }
+
+        return lights;
+    }
+
+    bool Contains( const BoundingBox& outer, const BoundingBox& inner )
+    {
+        return outer.m_Min.x <= inner.m_Min.x && outer.m_Min.y <= inner.m_Min.y && outer.m_Min.z <= inner.m_Min.z &&
+               outer.m_Max.x >= inner.m_Max.x && outer.m_Max.y >= inner.m_Max.y && outer.m_Max.z >= inner.m_Max.z;
+    }
+
+    BoundingBox GetLightAABB( const PointLight& light )
+    {
+        glm::vec3 position( light.m_PositionVS );
+        return BoundingBox( position - light.m_Range, position + light.m_Range );
+    }
+
+    BoundingBox ComputeLightsAABB( const std::vector<PointLight>& lights, Core::ThreadPool& threadPool )
+    {
+        return LightBVHCPU::ComputeLightsAABB( lights.data(), static_cast<uint32_t>( lights.size() ), nullptr, 0, threadPool );
+    }
+
+    // Check that every node of the BVH contains its children and the lights of its leaves.
+    bool IsValidBVH( const LightBVHCPU& bvh, const std::vector<PointLight>& lights )
+    {
+        const auto& nodes = bvh.GetNodes();
+        const auto& lightIndices = bvh.GetLightIndices();
+        uint32_t numLevels = bvh.GetNumLevels();
+
+        uint32_t bottomLevel = numLevels - 1;
+        uint32_t firstBottomNode = LightBVHCPU::GetFirstNodeIndex( bottomLevel );
+        for ( uint32_t leaf = 0; leaf < bvh.GetNumLeaves(); ++leaf )
+        {
+            const BoundingBox& node = nodes[firstBottomNode + leaf / LightBVHCPU::BranchingFactor];
+            if ( !Contains( node, GetLightAABB( lights[lightIndices[leaf]] ) ) ) return false;
+        }
+
+        for ( uint32_t level = 1; level < numLevels; ++level )
+        {
+            uint32_t firstChild = LightBVHCPU::GetFirstNodeIndex( level );
+            uint32_t firstParent = LightBVHCPU::GetFirstNodeIndex( level - 1 );
+            for ( uint32_t child = 0; child < LightBVHCPU::GetNumLevelNodes( level ); ++child )
+            {
+                const BoundingBox& childNode = nodes[firstChild + child];
+                if ( childNode.IsValid() && !Contains( nodes[firstParent + child / LightBVHCPU::BranchingFactor], childNode ) ) return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+TEST( LightBVHCPU_NumLevelsAndNodes )
+{
+    CHECK_EQUAL( 1u, LightBVHCPU::GetNumLevels( 2 ) );
+    CHECK_EQUAL( 1u, LightBVHCPU::GetNumLevels( 32 ) );
+    CHECK_EQUAL( 2u, LightBVHCPU::GetNumLevels( 33 ) );
+    CHECK_EQUAL( 2u, LightBVHCPU::GetNumLevels( 1024 ) );
+    CHECK_EQUAL( 3u, LightBVHCPU::GetNumLevels( 1025 ) );
+
+    CHECK_EQUAL( 1u, LightBVHCPU::GetNumNodes( 32 ) );
+    CHECK_EQUAL( 33u, LightBVHCPU::GetNumNodes( 1024 ) );
+    CHECK_EQUAL( 1057u, LightBVHCPU::GetNumNodes( 1025 ) );
+}
+
+TEST( LightBVHCPU_NodesContainLights )
+{
+    Core::ThreadPool threadPool( 4 );
+
+    for ( uint32_t bitsPerAxis : { LightBVHCPU::MortonCodeBits32, LightBVHCPU::MortonCodeBits64 } )
+    {
+        std::vector<PointLight> lights = GenerateLights( 40000, 100.0f, bitsPerAxis );
+
+        LightBVHCPU bvh( threadPool );
+        bvh.SetMortonCodeBits( bitsPerAxis );
+        CHECK( bvh.Build( lights.data(), static_cast<uint32_t>( lights.size() ), ComputeLightsAABB( lights, threadPool ), LightBVHCPU::BuildMode::Rebuild ) );
+
+        CHECK_EQUAL( 40000u, bvh.GetNumLeaves() );
+        CHECK_EQUAL( 4u, bvh.GetNumLevels() );
+        CHECK( IsValidBVH( bvh, lights ) );
+
+        // The leaves are sorted by Morton code.
+        const auto& mortonCodes = bvh.GetMortonCodes();
+        CHECK( std::is_sorted( mortonCodes.begin(), mortonCodes.end() ) );
+    }
+}
+
+TEST( LightBVHCPU_AutomaticRefitsSmallMovements )
+{
+    Core::ThreadPool threadPool( 4 );
+
+    std::vector<PointLight> lights = GenerateLights( 5000, 100.0f, 1 );
+
+    LightBVHCPU bvh( threadPool );
+    bvh.Build( lights.data(), static_cast<uint32_t>( lights.size() ), ComputeLightsAABB( lights, threadPool ) );
+    std::vector<uint32_t> lightIndices = bvh.GetLightIndices();
+
+    for ( PointLight& light : lights )
+    {
+        light.m_PositionVS += glm::vec4( 0.1f, -0.1f, 0.1f, 0.0f );
+    }
+
+    CHECK( !bvh.Build( lights.data(), static_cast<uint32_t>( lights.size() ), ComputeLightsAABB( lights, threadPool ) ) );
+    CHECK_EQUAL( 1u, bvh.GetNumRebuilds() );
+    CHECK_EQUAL( 1u, bvh.GetNumRefits() );
+    CHECK( lightIndices == bvh.GetLightIndices() );
+    CHECK( IsValidBVH( bvh, lights ) );
+}
+
+TEST( LightBVHCPU_AutomaticRebuildsWithoutRefit )
+{
+    Core::ThreadPool threadPool( 4 );
+
+    std::vector<PointLight> lights = GenerateLights( 5000, 100.0f, 2 );
+
+    LightBVHCPU bvh( threadPool );
+    bvh.Build( lights.data(), static_cast<uint32_t>( lights.size() ), ComputeLightsAABB( lights, threadPool ) );
+
+    // Shuffle the light positions so the leaf order of the BVH is meaningless.
+    std::vector<PointLight> shuffled = lights;
+    std::shuffle( shuffled.begin(), shuffled.end(), std::mt19937( 3 ) );
+
+    CHECK( bvh.Build( shuffled.data(), static_cast<uint32_t>( shuffled.size() ), ComputeLightsAABB( shuffled, threadPool ) ) );
+    CHECK_EQUAL( 2u, bvh.GetNumRebuilds() );
+    CHECK_EQUAL( 0u, bvh.GetNumRefits() );
+    CHECK( IsValidBVH( bvh, shuffled ) );
+}
+
+TEST( LightBVHCPU_AssignLightsBVHMatchesBruteForce )
+{
+    Core::ThreadPool threadPool( 4 );
+
+    std::vector<PointLight> lights = GenerateLights( 40000, 100.0f, 4 );
+
+    LightBVHCPU bvh( threadPool );
+    bvh.Build( lights.data(), static_cast<uint32_t>( lights.size() ), ComputeLightsAABB( lights, threadPool ) );
+
+    // A grid of 16x16x16 clusters over the volume of the lights.
+    const uint32_t gridDim = 16;
+    const float clusterSize = 200.0f / gridDim;
+    std::vector<BoundingBox> clusterAABBs;
+    std::vector<uint32_t> uniqueClusters;
+    for ( uint32_t z = 0; z < gridDim; ++z )
+    {
+        for ( uint32_t y = 0; y < gridDim; ++y )
+        {
+            for ( uint32_t x = 0; x < gridDim; ++x )
+            {
+                glm::vec3 min = glm::vec3( -100.0f ) + glm::vec3( static_cast<float>( x ), static_cast<float>( y ), static_cast<float>( z ) ) * clusterSize;
+                uniqueClusters.push_back( static_cast<uint32_t>( clusterAABBs.size() ) );
+                clusterAABBs.push_back( BoundingBox( min, min + clusterSize ) );
+            }
+        }
+    }
+
+    ClusterLightAssignmentArgs args;
+    args.PointLights = lights.data();
+    args.NumPointLights = static_cast<uint32_t>( lights.size() );
+    args.ClusterAABBs = clusterAABBs.data();
+    args.NumClusters = static_cast<uint32_t>( clusterAABBs.size() );
+    args.UniqueClusters = uniqueClusters.data();
+    args.NumUniqueClusters = static_cast<uint32_t>( uniqueClusters.size() );
+
+    LightBVHArgs bvhArgs;
+    bvhArgs.PointLightBVH = bvh.GetNodes().data();
+    bvhArgs.PointLightIndices = bvh.GetLightIndices().data();
+    bvhArgs.PointLightLevels = bvh.GetNumLevels();
+
+    ClusterLightAssignmentCPU lightAssignment( threadPool );
+    ClusterLightList pointLights, spotLights;
+    ClusterLightList pointLightsBVH, spotLightsBVH;
+
+    lightAssignment.AssignLights( args, pointLights, spotLights );
+    lightAssignment.AssignLightsBVH( args, bvhArgs, pointLightsBVH, spotLightsBVH );
+
+    CHECK_EQUAL( 0u, pointLights.NumTruncatedClusters );
+    CHECK_EQUAL( 0u, pointLightsBVH.NumTruncatedClusters );
+    CHECK( pointLights.IndexCount > 0 );
+    CHECK_EQUAL( pointLights.IndexCount, pointLightsBVH.IndexCount );
+    CHECK( ClusterLightAssignmentCPU::Compare( pointLights, pointLightsBVH, uniqueClusters.data(), args.NumUniqueClusters ) );
+}
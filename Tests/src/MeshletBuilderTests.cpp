@@ -0,0 +1,137 @@
+#include <TestsPCH.h>
+
+#include <Graphics/MeshletBuilder.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // A grid of numQuads x numQuads quads in the XY plane. The triangles
+    // are counter-clockwise when they are viewed from the +Z axis.
+    void CreateGrid( uint32_t numQuads, std::vector<Mesh::Vertex>& vertices, std::vector<uint32_t>& indices )
+    {
+        vertices.clear();
+        indices.clear();
+
+        for ( uint32_t y = 0; y <= numQuads; ++y )
+        {
+            for ( uint32_t x = 0; x <= numQuads; ++x )
+            {
+                Mesh::Vertex vertex = {};
+                vertex.Position = glm::vec3( static_cast<float>( x ), static_cast<float>( y ), 0.0f );
+                vertex.Normal = glm::vec3( 0, 0, 1 );
+                vertices.push_back( vertex );
+            }
+        }
+
+        for ( uint32_t y = 0; y < numQuads; ++y )
+        {
+            for ( uint32_t x = 0; x < numQuads; ++x )
+            {
+                uint32_t i0 = y * ( numQuads + 1 ) + x;
+                uint32_t i1 = i0 + 1;
+                uint32_t i2 = i0 + numQuads + 1;
+                uint32_t i3 = i2 + 1;
+
+                indices.insert( indices.end(), { i0, i1, i2, i2, i1, i3 } );
+            }
+        }
+    }
+
+    Meshlet CreateMeshlet( const glm::vec3& center, float radius, const glm::vec3& axis, float sinAngle )
+    {
+        Meshlet meshlet = {};
+        meshlet.BoundingSphere = glm::vec4( center, radius );
+        meshlet.NormalCone = glm::vec4( axis, sinAngle );
+
+        return meshlet;
+    }
+}
+
+TEST( MeshletBuilder_BuildCoversAllTriangles )
+{
+    std::vector<Mesh::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid( 32, vertices, indices );
+
+    const uint32_t maxVertices = 64;
+    const uint32_t maxTriangles = 124;
+
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build( indices.data(), indices.size(), vertices.data(), vertices.size(), meshlets, maxVertices, maxTriangles );
+
+    CHECK( meshlets.size() > 1 );
+
+    // The meshlets are contiguous ranges of the index buffer.
+    uint32_t firstIndex = 0;
+    for ( const Meshlet& meshlet : meshlets )
+    {
+        CHECK_EQUAL( firstIndex, meshlet.FirstIndex );
+        CHECK( meshlet.NumIndices > 0 && meshlet.NumIndices % 3 == 0 );
+        CHECK( meshlet.NumIndices / 3 <= maxTriangles );
+
+        std::vector<uint32_t> uniqueVertices( indices.begin() + meshlet.FirstIndex, indices.begin() + meshlet.FirstIndex + meshlet.NumIndices );
+        std::sort( uniqueVertices.begin(), uniqueVertices.end() );
+        uniqueVertices.erase( std::unique( uniqueVertices.begin(), uniqueVertices.end() ), uniqueVertices.end() );
+
+        CHECK_EQUAL( static_cast<uint32_t>( uniqueVertices.size() ), meshlet.NumVertices );
+        CHECK( meshlet.NumVertices <= maxVertices );
+
+        // The bounding sphere must contain all of the vertices of the meshlet.
+        glm::vec3 center( meshlet.BoundingSphere );
+        for ( uint32_t index : uniqueVertices )
+        {
+            CHECK( glm::length( vertices[index].Position - center ) <= meshlet.BoundingSphere.w * 1.0001f + 1e-5f );
+        }
+
+        firstIndex += meshlet.NumIndices;
+    }
+
+    CHECK_EQUAL( static_cast<uint32_t>( indices.size() ), firstIndex );
+}
+
+TEST( MeshletBuilder_NormalCone )
+{
+    std::vector<Mesh::Vertex> vertices;
+    std::vector<uint32_t> indices;
+    CreateGrid( 4, vertices, indices );
+
+    std::vector<Meshlet> meshlets;
+    MeshletBuilder::Build( indices.data(), indices.size(), vertices.data(), vertices.size(), meshlets );
+
+    CHECK_EQUAL( size_t( 1 ), meshlets.size() );
+
+    // All triangles of a flat grid have the same normal.
+    const Meshlet& meshlet = meshlets[0];
+    CHECK( glm::dot( glm::vec3( meshlet.NormalCone ), glm::vec3( 0, 0, 1 ) ) > 0.999f );
+    CHECK( meshlet.NormalCone.w < 0.01f );
+
+    CHECK( MeshletBuilder::IsBackFacing( meshlet, glm::vec3( 2, 2, -10 ) ) );
+    CHECK( !MeshletBuilder::IsBackFacing( meshlet, glm::vec3( 2, 2, 10 ) ) );
+    // The test is conservative: a camera in the plane of the grid doesn't cull the meshlet.
+    CHECK( !MeshletBuilder::IsBackFacing( meshlet, glm::vec3( 100, 2, 0 ) ) );
+}
+
+TEST( MeshletBuilder_Cull )
+{
+    // The frustum of the identity matrix is the clip space volume: -1 <= x, y <= 1 and 0 <= z <= 1.
+    Frustum frustum( glm::mat4( 1.0f ) );
+
+    std::vector<Meshlet> meshlets = {
+        CreateMeshlet( glm::vec3( 0.0f, 0.0f, 0.5f ), 0.1f, glm::vec3( 0, 0, -1 ), 0.0f ),   // Inside, facing the camera.
+        CreateMeshlet( glm::vec3( 5.0f, 0.0f, 0.5f ), 0.1f, glm::vec3( 0, 0, -1 ), 0.0f ),   // Outside the right plane.
+        CreateMeshlet( glm::vec3( 1.05f, 0.0f, 0.5f ), 0.1f, glm::vec3( 0, 0, -1 ), 0.0f ),  // Intersects the right plane.
+        CreateMeshlet( glm::vec3( 0.0f, 0.0f, 0.5f ), 0.1f, glm::vec3( 0, 0, 1 ), 0.0f ),    // Inside, facing away from the camera.
+        CreateMeshlet( glm::vec3( 0.0f, 0.0f, 0.5f ), 0.1f, glm::vec3( 0, 0, 1 ), 1.0f ),    // Inside, can't be back-face culled.
+        CreateMeshlet( glm::vec3( 0.0f, 0.0f, -0.5f ), 0.1f, glm::vec3( 0, 0, -1 ), 0.0f ),  // Behind the near plane.
+    };
+
+    glm::vec3 cameraPosition( 0.0f, 0.0f, -1.0f );
+
+    std::vector<uint32_t> visibleMeshlets;
+    MeshletBuilder::Cull( meshlets.data(), meshlets.size(), frustum, cameraPosition, false, visibleMeshlets );
+    CHECK( visibleMeshlets == std::vector<uint32_t>( { 0, 2, 3, 4 } ) );
+
+    MeshletBuilder::Cull( meshlets.data(), meshlets.size(), frustum, cameraPosition, true, visibleMeshlets );
+    CHECK( visibleMeshlets == std::vector<uint32_t>( { 0, 2, 4 } ) );
+}
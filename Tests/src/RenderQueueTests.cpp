@@ -0,0 +1,265 @@
+#include <TestsPCH.h>
+
+#include <Graphics/RenderQueue.h>
+
+#include <ThreadPool.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // The render queue only uses the addresses of the pipelines, materials and meshes.
+    struct Objects
+    {
+        Objects( uint32_t numMaterials, uint32_t numMeshes )
+            : Materials( numMaterials )
+            , Meshes( numMeshes )
+        {}
+
+        uint8_t Pipelines[2] = {};
+        std::vector<uint8_t> Materials;
+        std::vector<uint8_t> Meshes;
+    };
+
+    struct Draw
+    {
+        uint32_t Pipeline;
+        uint32_t Material;
+        uint32_t Mesh;
+        float Depth;
+    };
+
+    const float ZNear = 0.1f;
+    const float ZFar = 1000.0f;
+
+    std::vector<Draw> GenerateDraws( uint32_t numDraws, const Objects& objects, uint32_t seed )
+    {
+        std::mt19937 rng( seed );
+        std::uniform_int_distribution<uint32_t> pipeline( 0, 1 );
+        std::uniform_int_distribution<uint32_t> mesh( 0, static_cast<uint32_t>( objects.Meshes.size() ) - 1 );
+        std::uniform_real_distribution<float> depth( ZNear, ZFar );
+
+        std::vector<Draw> draws( numDraws );
+        for ( Draw& draw : draws )
+        {
+            draw.Pipeline = pipeline( rng );
+            draw.Mesh = mesh( rng );
+            // Meshes always use the same material.
+            draw.Material = draw.Mesh % static_cast<uint32_t>( objects.Materials.size() );
+            draw.Depth = depth( rng );
+        }
+
+        return draws;
+    }
+
+    void PushDraws( RenderQueue& renderQueue, const std::vector<Draw>& draws, const Objects& objects )
+    {
+        renderQueue.Clear();
+        renderQueue.SetDepthRange( ZNear, ZFar );
+
+        for ( uint32_t i = 0; i < static_cast<uint32_t>( draws.size() ); ++i )
+        {
+            const Draw& draw = draws[i];
+            renderQueue.Push( &objects.Pipelines[draw.Pipeline], &objects.Materials[draw.Material], &objects.Meshes[draw.Mesh], draw.Depth, i );
+        }
+    }
+
+    // The number of times the material changes if the draws are submitted in the given order.
+    uint32_t CountMaterialBinds( const std::vector<Draw>& draws, const uint32_t* drawIndices )
+    {
+        uint32_t numMaterialBinds = 0;
+        for ( size_t i = 0; i < draws.size(); ++i )
+        {
+            if ( i == 0 || draws[drawIndices[i]].Material != draws[drawIndices[i - 1]].Material )
+            {
+                ++numMaterialBinds;
+            }
+        }
+
+        return numMaterialBinds;
+    }
+
+    // Check that the keys are sorted and that the draw indices are a permutation of the pushed draws.
+    bool IsSorted( const RenderQueue& renderQueue )
+    {
+        uint32_t numDraws = renderQueue.GetNumDraws();
+        const uint64_t* keys = renderQueue.GetKeys();
+        const uint32_t* drawIndices = renderQueue.GetDrawIndices();
+
+        std::vector<bool> isSubmitted( numDraws, false );
+        for ( uint32_t i = 0; i < numDraws; ++i )
+        {
+            if ( i > 0 && keys[i - 1] > keys[i] ) return false;
+            if ( drawIndices[i] >= numDraws || isSubmitted[drawIndices[i]] ) return false;
+
+            isSubmitted[drawIndices[i]] = true;
+        }
+
+        return true;
+    }
+}
+
+TEST( RenderQueue_KeysRoundTrip )
+{
+    for ( RenderQueue::SortOrder sortOrder : { RenderQueue::SortOrder::FrontToBack, RenderQueue::SortOrder::BackToFront } )
+    {
+        RenderQueue renderQueue( sortOrder );
+        renderQueue.SetDepthRange( ZNear, ZFar );
+
+        uint64_t key = renderQueue.MakeKey( 3, 1234, 4321, 50.0f );
+        CHECK_EQUAL( 3u, renderQueue.GetPipelineID( key ) );
+        CHECK_EQUAL( 1234u, renderQueue.GetMaterialID( key ) );
+        CHECK_EQUAL( 4321u, renderQueue.GetMeshID( key ) );
+
+        // Ids that don't fit in the key wrap around.
+        key = renderQueue.MakeKey( 0, 1u << RenderQueue::MaterialBits, ( 1u << RenderQueue::MeshBits ) + 1, 50.0f );
+        CHECK_EQUAL( 0u, renderQueue.GetMaterialID( key ) );
+        CHECK_EQUAL( 1u, renderQueue.GetMeshID( key ) );
+
+        // The pipeline is the most significant field of both sort orders.
+        CHECK( renderQueue.MakeKey( 0, 100, 100, ZFar ) < renderQueue.MakeKey( 1, 0, 0, ZNear ) );
+    }
+}
+
+TEST( RenderQueue_FrontToBack )
+{
+    RenderQueue renderQueue( RenderQueue::SortOrder::FrontToBack );
+    renderQueue.SetDepthRange( ZNear, ZFar );
+
+    // Draws in the same depth slice are grouped by material before they are sorted by depth.
+    // (350 and 500 are both in the slice [316, 562) of 16 logarithmic slices between 0.1 and 1000).
+    CHECK( renderQueue.MakeKey( 0, 0, 0, 500.0f ) < renderQueue.MakeKey( 0, 1, 0, 350.0f ) );
+    CHECK( renderQueue.MakeKey( 0, 0, 0, 350.0f ) < renderQueue.MakeKey( 0, 0, 0, 500.0f ) );
+    // Draws in nearer depth slices are rendered first.
+    CHECK( renderQueue.MakeKey( 0, 1, 1, 1.0f ) < renderQueue.MakeKey( 0, 0, 0, 350.0f ) );
+    // Depths outside of the depth range are clamped.
+    CHECK_EQUAL( renderQueue.MakeKey( 0, 0, 0, ZNear ), renderQueue.MakeKey( 0, 0, 0, 0.0f ) );
+    CHECK_EQUAL( renderQueue.MakeKey( 0, 0, 0, ZFar ), renderQueue.MakeKey( 0, 0, 0, 2.0f * ZFar ) );
+
+    // 2 pipelines x 16 depth slices x 16 materials is at most 512 material binds.
+    Objects objects( 16, 256 );
+    std::vector<Draw> draws = GenerateDraws( 10000, objects, 1 );
+    PushDraws( renderQueue, draws, objects );
+    renderQueue.Sort();
+
+    CHECK( IsSorted( renderQueue ) );
+
+    std::vector<uint32_t> unsortedIndices( draws.size() );
+    std::iota( unsortedIndices.begin(), unsortedIndices.end(), 0 );
+    CHECK( CountMaterialBinds( draws, renderQueue.GetDrawIndices() ) * 10 < CountMaterialBinds( draws, unsortedIndices.data() ) );
+}
+
+TEST( RenderQueue_BackToFront )
+{
+    RenderQueue renderQueue( RenderQueue::SortOrder::BackToFront );
+
+    Objects objects( 64, 256 );
+    std::vector<Draw> draws = GenerateDraws( 10000, objects, 2 );
+    // Draws of a single pipeline are sorted strictly back-to-front.
+    for ( Draw& draw : draws )
+    {
+        draw.Pipeline = 0;
+    }
+
+    PushDraws( renderQueue, draws, objects );
+    renderQueue.Sort();
+
+    CHECK( IsSorted( renderQueue ) );
+
+    // Draws with the same quantized depth (24 bits between the near and far clipping planes)
+    // are sorted by material and mesh instead.
+    const float maxDepthError = 1e-3f;
+    const uint32_t* drawIndices = renderQueue.GetDrawIndices();
+    bool isBackToFront = true;
+    for ( uint32_t i = 1; i < renderQueue.GetNumDraws(); ++i )
+    {
+        isBackToFront = isBackToFront && draws[drawIndices[i - 1]].Depth + maxDepthError >= draws[drawIndices[i]].Depth;
+    }
+    CHECK( isBackToFront );
+}
+
+TEST( RenderQueue_SortIsStable )
+{
+    Core::ThreadPool threadPool( 4 );
+    RenderQueue renderQueue;
+
+    // Large enough to split the sort over multiple threads. There are only a few
+    // different keys, so the draw indices of equal keys must stay in push order.
+    Objects objects( 4, 8 );
+    std::vector<Draw> draws = GenerateDraws( 100000, objects, 3 );
+    for ( Draw& draw : draws )
+    {
+        draw.Depth = ( draw.Depth < 500.0f ) ? 10.0f : 900.0f;
+    }
+
+    PushDraws( renderQueue, draws, objects );
+
+    std::vector<std::pair<uint64_t, uint32_t>> expected( renderQueue.GetNumDraws() );
+    for ( uint32_t i = 0; i < renderQueue.GetNumDraws(); ++i )
+    {
+        expected[i] = std::make_pair( renderQueue.GetKeys()[i], renderQueue.GetDrawIndices()[i] );
+    }
+    std::stable_sort( expected.begin(), expected.end(), []( const auto& a, const auto& b ) { return a.first < b.first; } );
+
+    renderQueue.Sort( threadPool );
+
+    bool isStable = true;
+    for ( uint32_t i = 0; i < renderQueue.GetNumDraws(); ++i )
+    {
+        isStable = isStable && expected[i].first == renderQueue.GetKeys()[i] && expected[i].second == renderQueue.GetDrawIndices()[i];
+    }
+    CHECK( isStable );
+}
+
+TEST( RenderQueue_ClearResetsIDs )
+{
+    Objects objects( 2, 2 );
+    RenderQueue renderQueue;
+
+    renderQueue.Push( &objects.Pipelines[0], &objects.Materials[0], &objects.Meshes[0], 1.0f, 0 );
+    renderQueue.Push( &objects.Pipelines[0], &objects.Materials[1], &objects.Meshes[1], 1.0f, 1 );
+    CHECK_EQUAL( 2u, renderQueue.GetNumDraws() );
+    CHECK_EQUAL( 1u, renderQueue.GetMaterialID( renderQueue.GetKeys()[1] ) );
+
+    // The ids are assigned in the order the objects are first seen after the queue is cleared.
+    renderQueue.Clear();
+    CHECK_EQUAL( 0u, renderQueue.GetNumDraws() );
+
+    renderQueue.Push( &objects.Pipelines[0], &objects.Materials[1], &objects.Meshes[1], 1.0f, 0 );
+    CHECK_EQUAL( 0u, renderQueue.GetMaterialID( renderQueue.GetKeys()[0] ) );
+    CHECK_EQUAL( 0u, renderQueue.GetMeshID( renderQueue.GetKeys()[0] ) );
+}
+
+BENCHMARK( RenderQueue_100kDraws )
+{
+    using namespace std::chrono;
+
+    const uint32_t numDraws = 100000;
+    const int numIterations = 10;
+
+    Objects objects( 256, 4096 );
+    std::vector<Draw> draws = GenerateDraws( numDraws, objects, 4 );
+    RenderQueue renderQueue;
+
+    double keyTime = 0.0;
+    double sortTime = 0.0;
+    for ( int i = 0; i < numIterations; ++i )
+    {
+        auto start = high_resolution_clock::now();
+        PushDraws( renderQueue, draws, objects );
+        auto pushed = high_resolution_clock::now();
+        renderQueue.Sort();
+        auto sorted = high_resolution_clock::now();
+
+        keyTime += duration_cast<duration<double, std::milli>>( pushed - start ).count();
+        sortTime += duration_cast<duration<double, std::milli>>( sorted - pushed ).count();
+    }
+
+    CHECK( IsSorted( renderQueue ) );
+
+    std::vector<uint32_t> unsortedIndices( numDraws );
+    std::iota( unsortedIndices.begin(), unsortedIndices.end(), 0 );
+
+    std::cout << "Render queue: " << numDraws << " draws, " << keyTime / numIterations << " ms key generation, " << sortTime / numIterations << " ms sort, "
+              << CountMaterialBinds( draws, unsortedIndices.data() ) << " -> " << CountMaterialBinds( draws, renderQueue.GetDrawIndices() ) << " material binds." << std::endl;
+}
@@ -0,0 +1,225 @@
+#include <TestsPCH.h>
+
+#include <Graphics/Material.h>
+#include <Graphics/SceneFile.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // A scene with a single triangle mesh that is referenced by the child of the root node.
+    SceneFile::Contents CreateContents()
+    {
+        SceneFile::Contents contents;
+
+        contents.Materials.push_back( {} );
+
+        SceneFile::TextureRecord texture = {};
+        texture.MaterialIndex = 0;
+        texture.TextureType = static_cast<uint32_t>( Material::TextureType::Diffuse );
+        texture.FileName = contents.AddString( "Diffuse.png" );
+        contents.Textures.push_back( texture );
+
+        const uint16_t indices[] = { 0, 1, 2 };
+        uint32_t vertexSize = SceneFile::GetVertexSize( contents.VertexFormat );
+        contents.Vertices.resize( 3 * vertexSize );
+
+        Meshlet meshlet = {};
+        meshlet.FirstIndex = 0;
+        meshlet.NumIndices = 3;
+        meshlet.NumVertices = 3;
+        contents.Meshlets.push_back( meshlet );
+
+        SceneFile::MeshRecord mesh = {};
+        mesh.MaterialIndex = 0;
+        mesh.NumVertices = 3;
+        mesh.NumIndices = 3;
+        mesh.IndexSize = sizeof( uint16_t );
+        mesh.FirstVertex = 0;
+        mesh.FirstIndex = contents.AddIndices( indices, 3, sizeof( uint16_t ) );
+        mesh.FirstMeshlet = 0;
+        mesh.NumMeshlets = 1;
+        mesh.PositionTransform = glm::mat4( 1.0f );
+        contents.Meshes.push_back( mesh );
+
+        SceneFile::NodeRecord root = {};
+        root.LocalTransform = glm::mat4( 1.0f );
+        root.ParentIndex = SceneFile::InvalidIndex;
+        root.Name = contents.AddString( "Root" );
+        contents.Nodes.push_back( root );
+
+        SceneFile::NodeRecord child = root;
+        child.ParentIndex = 0;
+        child.Name = contents.AddString( "Triangle" );
+        child.FirstMesh = 0;
+        child.NumMeshes = 1;
+        contents.Nodes.push_back( child );
+        contents.NodeMeshes.push_back( 0 );
+
+        return contents;
+    }
+
+    std::wstring GetTestFileName()
+    {
+        return ( fs::temp_directory_path() / "SceneFileTests.scene" ).wstring();
+    }
+
+    std::vector<uint8_t> ReadBytes( const std::wstring& fileName )
+    {
+        std::ifstream file( fs::path( fileName ), std::ios::in | std::ios::binary );
+        return std::vector<uint8_t>( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    }
+
+    void WriteBytes( const std::wstring& fileName, const std::vector<uint8_t>& bytes )
+    {
+        std::ofstream file( fs::path( fileName ), std::ios::out | std::ios::binary | std::ios::trunc );
+        file.write( reinterpret_cast<const char*>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ) );
+    }
+
+    template<typename T>
+    T* GetRecord( std::vector<uint8_t>& bytes, uint64_t offset, uint32_t index = 0 )
+    {
+        return reinterpret_cast<T*>( bytes.data() + offset ) + index;
+    }
+
+    // Save a valid scene file, corrupt it and check that it can't be opened.
+    bool OpenCorrupted( const std::function<void( std::vector<uint8_t>& bytes, const SceneFile::Header& header )>& corrupt )
+    {
+        std::wstring fileName = GetTestFileName();
+        if ( !SceneFile::Save( fileName, CreateContents() ) )
+        {
+            return true;
+        }
+
+        std::vector<uint8_t> bytes = ReadBytes( fileName );
+        SceneFile::Header header = *reinterpret_cast<const SceneFile::Header*>( bytes.data() );
+        corrupt( bytes, header );
+        WriteBytes( fileName, bytes );
+
+        SceneFile sceneFile;
+        bool isOpen = sceneFile.Open( fileName );
+        sceneFile.Close();
+
+        fs::remove( fs::path( fileName ) );
+
+        return isOpen;
+    }
+}
+
+TEST( SceneFile_SaveAndOpen )
+{
+    std::wstring fileName = GetTestFileName();
+    SceneFile::Contents contents = CreateContents();
+    CHECK( SceneFile::Save( fileName, contents ) );
+
+    {
+        SceneFile sceneFile;
+        CHECK( sceneFile.Open( fileName ) );
+
+        const SceneFile::Header& header = sceneFile.GetHeader();
+        CHECK_EQUAL( 1u, header.NumMaterials );
+        CHECK_EQUAL( 1u, header.NumTextures );
+        CHECK_EQUAL( 1u, header.NumMeshes );
+        CHECK_EQUAL( 1u, header.NumMeshlets );
+        CHECK_EQUAL( 2u, header.NumNodes );
+        CHECK_EQUAL( 3ull, header.NumVertices );
+
+        CHECK_EQUAL( std::string( "Diffuse.png" ), std::string( sceneFile.GetString( sceneFile.GetTextures()[0].FileName ) ) );
+        CHECK_EQUAL( std::string( "Triangle" ), std::string( sceneFile.GetString( sceneFile.GetNodes()[1].Name ) ) );
+        CHECK_EQUAL( 0u, sceneFile.GetNodes()[1].ParentIndex );
+
+        const uint16_t* indices = reinterpret_cast<const uint16_t*>( sceneFile.GetIndices() + sceneFile.GetMeshes()[0].FirstIndex );
+        CHECK( indices[0] == 0 && indices[1] == 1 && indices[2] == 2 );
+    }
+
+    fs::remove( fs::path( fileName ) );
+}
+
+TEST( SceneFile_RejectsTruncatedFiles )
+{
+    // Too small for the header.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        bytes.resize( sizeof( SceneFile::Header ) - 1 );
+    } ) );
+
+    // The string table is stored at the end of the file.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        bytes.pop_back();
+    } ) );
+
+    // The arrays are validated against the size of the file.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        GetRecord<SceneFile::Header>( bytes, 0 )->NumVertices = bytes.size() / header.VertexSize + 1;
+    } ) );
+}
+
+TEST( SceneFile_RejectsInvalidHeaders )
+{
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        GetRecord<SceneFile::Header>( bytes, 0 )->Magic[0] = 'X';
+    } ) );
+
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        GetRecord<SceneFile::Header>( bytes, 0 )->Version = SceneFile::FileVersion + 1;
+    } ) );
+
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        GetRecord<SceneFile::Header>( bytes, 0 )->VertexSize += 4;
+    } ) );
+
+    // Arrays must be aligned.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        GetRecord<SceneFile::Header>( bytes, 0 )->MeshesOffset += 4;
+    } ) );
+}
+
+TEST( SceneFile_RejectsInvalidRecords )
+{
+    // Indices must reference the vertices of the mesh.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        *GetRecord<uint16_t>( bytes, header.IndicesOffset, 2 ) = 3;
+    } ) );
+
+    // Meshlets must be within the index range of the mesh.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        GetRecord<Meshlet>( bytes, header.MeshletsOffset )->NumIndices = 6;
+    } ) );
+
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        GetRecord<SceneFile::TextureRecord>( bytes, header.TexturesOffset )->MaterialIndex = 1;
+    } ) );
+
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        GetRecord<SceneFile::TextureRecord>( bytes, header.TexturesOffset )->FileName = static_cast<uint32_t>( header.StringsSize );
+    } ) );
+
+    // Parents must be stored before their children.
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        GetRecord<SceneFile::NodeRecord>( bytes, header.NodesOffset, 1 )->ParentIndex = 1;
+    } ) );
+
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& header )
+    {
+        *GetRecord<uint32_t>( bytes, header.NodeMeshesOffset ) = 1;
+    } ) );
+}
+
+TEST( SceneFile_RejectsUnterminatedStrings )
+{
+    CHECK( !OpenCorrupted( []( std::vector<uint8_t>& bytes, const SceneFile::Header& )
+    {
+        bytes.back() = 'X';
+    } ) );
+}
@@ -0,0 +1 @@
+#include <TestsPCH.h>
@@ -0,0 +1,76 @@
+#include <TestsPCH.h>
+
+#include <ThreadPool.h>
+
+using namespace Core;
+
+TEST( ThreadPool_ParallelForVisitsEveryElementOnce )
+{
+    ThreadPool threadPool( 4 );
+
+    std::vector<std::atomic<uint32_t>> counts( 10007 );
+    threadPool.ParallelFor( 0, static_cast<uint32_t>( counts.size() ), 64, [&]( uint32_t begin, uint32_t end )
+    {
+        for ( uint32_t i = begin; i < end; ++i )
+        {
+            counts[i].fetch_add( 1 );
+        }
+    } );
+
+    for ( const auto& count : counts )
+    {
+        CHECK_EQUAL( 1u, count.load() );
+    }
+}
+
+TEST( ThreadPool_ParallelForEmptyRange )
+{
+    ThreadPool threadPool( 2 );
+
+    bool called = false;
+    threadPool.ParallelFor( 10, 10, 1, [&]( uint32_t, uint32_t ) { called = true; } );
+
+    CHECK( !called );
+}
+
+TEST( ThreadPool_NestedParallelFor )
+{
+    ThreadPool threadPool( 2 );
+
+    std::atomic<uint32_t> sum( 0 );
+    threadPool.ParallelFor( 0, 8, 1, [&]( uint32_t, uint32_t )
+    {
+        threadPool.ParallelFor( 0, 100, 10, [&]( uint32_t begin, uint32_t end )
+        {
+            sum.fetch_add( end - begin );
+        } );
+    } );
+
+    CHECK_EQUAL( 800u, sum.load() );
+}
+
+TEST( ThreadPool_ParallelForRethrowsOnCallingThread )
+{
+    ThreadPool threadPool( 4 );
+
+    // Every chunk throws, so both the calling thread and the workers throw.
+    CHECK_THROWS( threadPool.ParallelFor( 0, 1000, 1, []( uint32_t, uint32_t )
+    {
+        throw std::runtime_error( "Chunk failed." );
+    } ) );
+
+    // The pool can still be used after an exception.
+    std::atomic<uint32_t> count( 0 );
+    threadPool.ParallelFor( 0, 1000, 10, [&]( uint32_t begin, uint32_t end ) { count.fetch_add( end - begin ); } );
+    CHECK_EQUAL( 1000u, count.load() );
+}
+
+TEST( ThreadPool_EnqueueReturnsFuture )
+{
+    ThreadPool threadPool( 1 );
+
+    std::atomic<bool> executed( false );
+    threadPool.Enqueue( [&]() { executed = true; } ).wait();
+
+    CHECK( executed.load() );
+}
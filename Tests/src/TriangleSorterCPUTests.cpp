@@ -0,0 +1,92 @@
+#include <TestsPCH.h>
+
+#include <Graphics/CPU/TriangleSorterCPU.h>
+
+using namespace Graphics;
+
+namespace
+{
+    // A stack of numTriangles triangles along the Z axis (one unit apart).
+    struct TriangleStack
+    {
+        explicit TriangleStack( uint32_t numTriangles )
+        {
+            for ( uint32_t i = 0; i < numTriangles; ++i )
+            {
+                float z = static_cast<float>( i );
+                Indices.insert( Indices.end(), { i * 3, i * 3 + 1, i * 3 + 2 } );
+                Centers.push_back( glm::vec3( 0.0f, 0.0f, z ) );
+            }
+
+            float radius = numTriangles * 0.5f;
+            BoundingSphere = glm::vec4( 0.0f, 0.0f, radius, radius );
+        }
+
+        bool Sort( TriangleSorterCPU& triangleSorter, const glm::vec3& cameraPosition, float threshold = 0.01f ) const
+        {
+            return triangleSorter.Sort( Indices.data(), Centers.data(), static_cast<uint32_t>( Centers.size() ), BoundingSphere, cameraPosition, threshold );
+        }
+
+        std::vector<uint32_t> Indices;
+        std::vector<glm::vec3> Centers;
+        glm::vec4 BoundingSphere;
+    };
+
+    // The triangles of the sorted indices in the order they are rendered.
+    std::vector<uint32_t> GetTriangleOrder( const TriangleSorterCPU& triangleSorter )
+    {
+        std::vector<uint32_t> order;
+        for ( uint32_t i = 0; i < triangleSorter.GetNumIndices(); i += 3 )
+        {
+            uint32_t index = triangleSorter.GetIndexSize() == sizeof( uint16_t ) ? static_cast<const uint16_t*>( triangleSorter.GetIndices() )[i]
+                                                                                  : static_cast<const uint32_t*>( triangleSorter.GetIndices() )[i];
+            order.push_back( index / 3 );
+        }
+
+        return order;
+    }
+}
+
+TEST( TriangleSorterCPU_SortsBackToFront )
+{
+    TriangleStack stack( 100 );
+    TriangleSorterCPU triangleSorter;
+
+    CHECK( stack.Sort( triangleSorter, glm::vec3( 0.0f, 0.0f, -10.0f ) ) );
+    CHECK( triangleSorter.WasOrderChanged() );
+    CHECK_EQUAL( uint32_t( sizeof( uint16_t ) ), triangleSorter.GetIndexSize() );
+
+    std::vector<uint32_t> order = GetTriangleOrder( triangleSorter );
+    CHECK_EQUAL( size_t( 100 ), order.size() );
+    CHECK( std::is_sorted( order.rbegin(), order.rend() ) );
+
+    // Viewed from the other side, the order is reversed.
+    CHECK( stack.Sort( triangleSorter, glm::vec3( 0.0f, 0.0f, 110.0f ) ) );
+    CHECK( triangleSorter.WasOrderChanged() );
+
+    order = GetTriangleOrder( triangleSorter );
+    CHECK( std::is_sorted( order.begin(), order.end() ) );
+}
+
+TEST( TriangleSorterCPU_OrderChanges )
+{
+    TriangleStack stack( 100 );
+    TriangleSorterCPU triangleSorter;
+
+    CHECK( stack.Sort( triangleSorter, glm::vec3( 0.0f, 0.0f, -10.0f ) ) );
+
+    // Camera movements below the threshold don't sort the triangles again.
+    CHECK( !stack.Sort( triangleSorter, glm::vec3( 0.0f, 0.0f, -10.1f ) ) );
+    CHECK( !triangleSorter.WasOrderChanged() );
+
+    // Moving sideways sorts the triangles again, but the order of the stack doesn't change.
+    CHECK( stack.Sort( triangleSorter, glm::vec3( 5.0f, 0.0f, -10.0f ) ) );
+    CHECK( triangleSorter.WasIncremental() );
+    CHECK( !triangleSorter.WasOrderChanged() );
+
+    // After invalidating, the triangles are always sorted with the radix sort.
+    triangleSorter.Invalidate();
+    CHECK( stack.Sort( triangleSorter, glm::vec3( 5.0f, 0.0f, -10.0f ) ) );
+    CHECK( !triangleSorter.WasIncremental() );
+    CHECK( triangleSorter.WasOrderChanged() );
+}
@@ -0,0 +1,125 @@
+#include <TestsPCH.h>
+
+#include <Graphics/VertexCompression.h>
+
+using namespace Graphics;
+
+namespace
+{
+    glm::vec3 RandomUnitVector( std::mt19937& rng )
+    {
+        std::uniform_real_distribution<float> coordinate( -1.0f, 1.0f );
+
+        glm::vec3 v;
+        do
+        {
+            v = glm::vec3( coordinate( rng ), coordinate( rng ), coordinate( rng ) );
+        } while ( glm::length( v ) < 0.01f );
+
+        return glm::normalize( v );
+    }
+
+    std::vector<Mesh::Vertex> GenerateVertices( uint32_t numVertices, const glm::vec3& minBounds, const glm::vec3& maxBounds, uint32_t seed )
+    {
+        std::mt19937 rng( seed );
+        std::uniform_real_distribution<float> unit( 0.0f, 1.0f );
+
+        std::vector<Mesh::Vertex> vertices( numVertices );
+        for ( uint32_t i = 0; i < numVertices; ++i )
+        {
+            Mesh::Vertex& vertex = vertices[i];
+            vertex.Position = minBounds + ( maxBounds - minBounds ) * glm::vec3( unit( rng ), unit( rng ), unit( rng ) );
+            vertex.Normal = RandomUnitVector( rng );
+            vertex.Tangent = glm::normalize( glm::cross( vertex.Normal, RandomUnitVector( rng ) ) );
+            vertex.BiTangent = glm::cross( vertex.Normal, vertex.Tangent ) * ( ( i % 2 ) ? -1.0f : 1.0f );
+            // Multiples of 1/256 in [0, 4) are exact in half precision.
+            vertex.TexCoord = glm::vec3( std::floor( unit( rng ) * 1024.0f ) / 256.0f, std::floor( unit( rng ) * 1024.0f ) / 256.0f, 0.0f );
+        }
+
+        return vertices;
+    }
+
+    bool IsFinite( const glm::vec3& v )
+    {
+        return std::isfinite( v.x ) && std::isfinite( v.y ) && std::isfinite( v.z );
+    }
+}
+
+TEST( VertexCompression_OctahedralRoundTrip )
+{
+    std::mt19937 rng( 1 );
+
+    std::vector<glm::vec3> vectors = {
+        glm::vec3( 1, 0, 0 ), glm::vec3( -1, 0, 0 ),
+        glm::vec3( 0, 1, 0 ), glm::vec3( 0, -1, 0 ),
+        glm::vec3( 0, 0, 1 ), glm::vec3( 0, 0, -1 ),
+    };
+    for ( int i = 0; i < 1000; ++i )
+    {
+        vectors.push_back( RandomUnitVector( rng ) );
+    }
+
+    for ( const glm::vec3& v : vectors )
+    {
+        glm::vec2 e = VertexCompression::EncodeOctahedral( v );
+        CHECK( std::abs( e.x ) <= 1.0f && std::abs( e.y ) <= 1.0f );
+        CHECK( glm::dot( v, VertexCompression::DecodeOctahedral( e ) ) > 0.99999f );
+    }
+
+    // Degenerate vectors are encoded as +Z.
+    CHECK( glm::dot( glm::vec3( 0, 0, 1 ), VertexCompression::DecodeOctahedral( VertexCompression::EncodeOctahedral( glm::vec3( 0.0f ) ) ) ) > 0.99999f );
+}
+
+TEST( VertexCompression_EncodeDecodeRoundTrip )
+{
+    glm::vec3 minBounds( -10.0f, 2.0f, -50.0f );
+    glm::vec3 maxBounds( 20.0f, 3.0f, 50.0f );
+    std::vector<Mesh::Vertex> vertices = GenerateVertices( 1000, minBounds, maxBounds, 2 );
+
+    std::vector<Mesh::CompactVertex> compactVertices( vertices.size() );
+    glm::mat4 positionTransform;
+    VertexCompression::Encode( vertices.data(), vertices.size(), compactVertices.data(), positionTransform );
+
+    // The positions are quantized to 16 bits per axis relative to the bounds of the mesh.
+    glm::vec3 maxPositionError = ( maxBounds - minBounds ) / 65535.0f + 1e-4f;
+
+    for ( size_t i = 0; i < vertices.size(); ++i )
+    {
+        Mesh::Vertex decoded = VertexCompression::Decode( compactVertices[i], positionTransform );
+
+        glm::vec3 positionError = glm::abs( decoded.Position - vertices[i].Position );
+        CHECK( positionError.x <= maxPositionError.x && positionError.y <= maxPositionError.y && positionError.z <= maxPositionError.z );
+
+        CHECK( glm::dot( decoded.Normal, vertices[i].Normal ) > 0.9999f );
+        CHECK( glm::dot( decoded.Tangent, vertices[i].Tangent ) > 0.9999f );
+        // The sign of the bitangent must be preserved for normal mapping.
+        CHECK( glm::dot( decoded.BiTangent, vertices[i].BiTangent ) > 0.999f );
+
+        CHECK( decoded.TexCoord.x == vertices[i].TexCoord.x && decoded.TexCoord.y == vertices[i].TexCoord.y );
+    }
+}
+
+TEST( VertexCompression_FlatAndDegenerateMeshes )
+{
+    // A mesh in the XY plane has a zero extent on the Z axis.
+    std::vector<Mesh::Vertex> vertices = GenerateVertices( 16, glm::vec3( -1.0f, -1.0f, 5.0f ), glm::vec3( 1.0f, 1.0f, 5.0f ), 3 );
+    // Meshes without tangents have zero tangents.
+    vertices[0].Tangent = vertices[0].BiTangent = glm::vec3( 0.0f );
+
+    std::vector<Mesh::CompactVertex> compactVertices( vertices.size() );
+    glm::mat4 positionTransform;
+    VertexCompression::Encode( vertices.data(), vertices.size(), compactVertices.data(), positionTransform );
+
+    for ( size_t i = 0; i < vertices.size(); ++i )
+    {
+        Mesh::Vertex decoded = VertexCompression::Decode( compactVertices[i], positionTransform );
+
+        CHECK( IsFinite( decoded.Position ) && IsFinite( decoded.Normal ) && IsFinite( decoded.Tangent ) && IsFinite( decoded.BiTangent ) );
+        CHECK( std::abs( decoded.Position.z - 5.0f ) < 1e-5f );
+    }
+
+    // Encoding an empty mesh results in an identity transform.
+    positionTransform = glm::mat4( 0.0f );
+    VertexCompression::Encode( nullptr, 0, nullptr, positionTransform );
+    CHECK( positionTransform == glm::mat4( 1.0f ) );
+}
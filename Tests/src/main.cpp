@@ -0,0 +1,84 @@
+#include <TestsPCH.h>
+
+#include <ThreadPool.h>
+
+namespace
+{
+    const Test::TestCase* gs_CurrentTest = nullptr;
+    uint32_t gs_NumFailures = 0;
+}
+
+std::vector<Test::TestCase>& Test::GetTestCases()
+{
+    static std::vector<TestCase> s_TestCases;
+    return s_TestCases;
+}
+
+void Test::ReportFailure( const char* file, int line, const std::string& message )
+{
+    std::cerr << file << "(" << line << "): " << ( gs_CurrentTest ? gs_CurrentTest->Name : "" ) << ": CHECK failed: " << message << std::endl;
+    ++gs_NumFailures;
+}
+
+// Usage: EngineTests [--benchmark] [filter]
+// Runs the tests (or the benchmarks) whose name contains the filter.
+int main( int argc, char* argv[] )
+{
+    bool runBenchmarks = false;
+    std::string filter;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string arg = argv[i];
+        if ( arg == "--benchmark" )
+        {
+            runBenchmarks = true;
+        }
+        else
+        {
+            filter = arg;
+        }
+    }
+
+    uint32_t numTests = 0;
+    uint32_t numFailedTests = 0;
+
+    for ( const Test::TestCase& testCase : Test::GetTestCases() )
+    {
+        if ( testCase.IsBenchmark != runBenchmarks || std::string( testCase.Name ).find( filter ) == std::string::npos )
+        {
+            continue;
+        }
+
+        gs_CurrentTest = &testCase;
+        uint32_t numFailures = gs_NumFailures;
+
+        try
+        {
+            testCase.Function();
+        }
+        catch ( const std::exception& e )
+        {
+            Test::ReportFailure( __FILE__, __LINE__, std::string( "Unexpected exception: " ) + e.what() );
+        }
+        catch ( ... )
+        {
+            Test::ReportFailure( __FILE__, __LINE__, "Unexpected exception." );
+        }
+
+        bool passed = gs_NumFailures == numFailures;
+        std::cout << ( passed ? "[PASSED] " : "[FAILED] " ) << testCase.Name << std::endl;
+
+        ++numTests;
+        numFailedTests += passed ? 0 : 1;
+    }
+
+    gs_CurrentTest = nullptr;
+
+    std::cout << numTests - numFailedTests << " of " << numTests << ( runBenchmarks ? " benchmarks" : " tests" ) << " passed." << std::endl;
+
+    // The shared thread pool is normally shut down by the Application.
+    Core::ThreadPool::Shutdown();
+
+    return numFailedTests == 0 ? 0 : 1;
+}